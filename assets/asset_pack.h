@@ -0,0 +1,79 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_ASSETS_ASSET_PACK_H_
+#define FLUTTER_ASSETS_ASSET_PACK_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// The layout of the asset packs written by |AssetPackWriter| and read by
+// |PackedAssetBundle|. A pack is made of:
+//
+//   - A |Header|.
+//   - |Header::entry_count| |Entry| records, sorted by name hash and then by
+//     name, so that assets are found with a binary search.
+//   - |Header::names_size| bytes of asset names, not null terminated.
+//   - The contents of the assets, each aligned to |kDataAlignment| bytes.
+//
+// Fields are stored in the byte order of the host that wrote the pack, which
+// is little endian on every host and target Flutter supports. A pack read with
+// the other byte order fails the |kMagic| check.
+namespace flutter {
+namespace asset_pack {
+
+// The name of the pack in an assets directory.
+constexpr char kFileName[] = "assets.pack";
+
+constexpr uint32_t kMagic = 0x4b415046;  // "FPAK"
+constexpr uint32_t kVersion = 1;
+constexpr size_t kDataAlignment = 16;
+// zlib inflates each compressed byte to at most this many bytes, which bounds
+// the size a compressed entry may claim.
+constexpr uint64_t kMaxCompressionRatio = 1032;
+
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entry_count;
+  uint32_t names_size;
+};
+
+enum EntryFlags : uint32_t {
+  // The contents are zlib compressed, and |Entry::size| is their size once
+  // inflated.
+  kCompressed = 1 << 0,
+  // The asset is needed at startup, and its pages are read ahead as soon as
+  // the pack is opened.
+  kPrefetch = 1 << 1,
+};
+
+struct Entry {
+  uint32_t name_hash;
+  // Relative to the start of the names.
+  uint32_t name_offset;
+  uint32_t name_size;
+  uint32_t flags;
+  // Relative to the start of the pack.
+  uint64_t data_offset;
+  uint64_t stored_size;
+  uint64_t size;
+};
+
+static_assert(sizeof(Header) == 16, "The header must not be padded.");
+static_assert(sizeof(Entry) == 40, "Entries must not be padded.");
+
+// The 32-bit FNV-1a hash of an asset name.
+constexpr uint32_t HashName(const char* name, size_t size) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(name[i])) * 16777619u;
+  }
+  return hash;
+}
+
+}  // namespace asset_pack
+}  // namespace flutter
+
+#endif  // FLUTTER_ASSETS_ASSET_PACK_H_
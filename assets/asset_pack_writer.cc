@@ -0,0 +1,124 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/assets/asset_pack_writer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+#include <utility>
+
+#include "third_party/zlib/zlib.h"
+
+namespace flutter {
+namespace {
+
+size_t AlignUp(size_t offset, size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+AssetPackWriter::AssetPackWriter() = default;
+
+AssetPackWriter::~AssetPackWriter() = default;
+
+bool AssetPackWriter::AddAsset(std::string name,
+                               std::vector<uint8_t> contents,
+                               bool compress,
+                               bool prefetch) {
+  if (!names_.insert(name).second) {
+    return false;
+  }
+
+  Asset asset;
+  asset.name = std::move(name);
+  asset.size = contents.size();
+  asset.prefetch = prefetch;
+  if (compress && !contents.empty()) {
+    uLongf compressed_size = compressBound(contents.size());
+    std::vector<uint8_t> compressed(compressed_size);
+    if (compress2(compressed.data(), &compressed_size, contents.data(),
+                  contents.size(), Z_BEST_COMPRESSION) == Z_OK &&
+        compressed_size < contents.size()) {
+      compressed.resize(compressed_size);
+      contents = std::move(compressed);
+      asset.compressed = true;
+    }
+  }
+  asset.contents = std::move(contents);
+  assets_.push_back(std::move(asset));
+  return true;
+}
+
+size_t AssetPackWriter::GetAssetCount() const {
+  return assets_.size();
+}
+
+std::vector<uint8_t> AssetPackWriter::Build() const {
+  // The pack is searched by name hash and then by name.
+  std::vector<std::pair<uint32_t, const Asset*>> sorted;
+  sorted.reserve(assets_.size());
+  for (const auto& asset : assets_) {
+    sorted.emplace_back(
+        asset_pack::HashName(asset.name.data(), asset.name.size()), &asset);
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+    return std::tie(a.first, a.second->name) <
+           std::tie(b.first, b.second->name);
+  });
+
+  size_t names_size = 0;
+  for (const auto& asset : assets_) {
+    names_size += asset.name.size();
+  }
+
+  const size_t entries_offset = sizeof(asset_pack::Header);
+  const size_t names_offset =
+      entries_offset + sorted.size() * sizeof(asset_pack::Entry);
+  size_t data_offset = names_offset + names_size;
+  std::vector<asset_pack::Entry> entries;
+  entries.reserve(sorted.size());
+  size_t name_offset = 0;
+  for (const auto& item : sorted) {
+    const Asset& asset = *item.second;
+    data_offset = AlignUp(data_offset, asset_pack::kDataAlignment);
+    asset_pack::Entry entry = {};
+    entry.name_hash = item.first;
+    entry.name_offset = name_offset;
+    entry.name_size = asset.name.size();
+    entry.flags =
+        (asset.compressed ? static_cast<uint32_t>(asset_pack::kCompressed)
+                          : 0u) |
+        (asset.prefetch ? static_cast<uint32_t>(asset_pack::kPrefetch) : 0u);
+    entry.data_offset = data_offset;
+    entry.stored_size = asset.contents.size();
+    entry.size = asset.size;
+    entries.push_back(entry);
+    name_offset += asset.name.size();
+    data_offset += asset.contents.size();
+  }
+
+  std::vector<uint8_t> pack(data_offset);
+  asset_pack::Header header = {};
+  header.magic = asset_pack::kMagic;
+  header.version = asset_pack::kVersion;
+  header.entry_count = entries.size();
+  header.names_size = names_size;
+  std::memcpy(pack.data(), &header, sizeof(header));
+  if (!entries.empty()) {
+    std::memcpy(pack.data() + entries_offset, entries.data(),
+                entries.size() * sizeof(asset_pack::Entry));
+  }
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    const Asset& asset = *sorted[i].second;
+    std::copy(asset.name.begin(), asset.name.end(),
+              pack.begin() + names_offset + entries[i].name_offset);
+    std::copy(asset.contents.begin(), asset.contents.end(),
+              pack.begin() + entries[i].data_offset);
+  }
+  return pack;
+}
+
+}  // namespace flutter
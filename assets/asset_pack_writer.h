@@ -0,0 +1,69 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_ASSETS_ASSET_PACK_WRITER_H_
+#define FLUTTER_ASSETS_ASSET_PACK_WRITER_H_
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "flutter/assets/asset_pack.h"
+#include "flutter/fml/macros.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      Builds the asset packs read by `PackedAssetBundle`.
+///
+class AssetPackWriter {
+ public:
+  AssetPackWriter();
+
+  ~AssetPackWriter();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Adds an asset to the pack.
+  ///
+  /// @param[in]  name      The name the asset is looked up by.
+  /// @param[in]  contents  The contents of the asset.
+  /// @param[in]  compress  Whether to compress the asset. It is stored as is
+  ///                       anyway if compressing does not make it smaller.
+  /// @param[in]  prefetch  Whether the asset is needed at startup, and should
+  ///                       be read ahead as soon as the pack is opened.
+  ///
+  /// @return     Returns false if an asset with the same name was already
+  ///             added.
+  ///
+  bool AddAsset(std::string name,
+                std::vector<uint8_t> contents,
+                bool compress,
+                bool prefetch);
+
+  size_t GetAssetCount() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Lays out the pack of all the assets added so far.
+  ///
+  std::vector<uint8_t> Build() const;
+
+ private:
+  struct Asset {
+    std::string name;
+    // The contents as stored, which are compressed if |compressed| is set.
+    std::vector<uint8_t> contents;
+    uint64_t size = 0;
+    bool compressed = false;
+    bool prefetch = false;
+  };
+
+  std::vector<Asset> assets_;
+  std::unordered_set<std::string> names_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(AssetPackWriter);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_ASSETS_ASSET_PACK_WRITER_H_
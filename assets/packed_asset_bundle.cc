@@ -0,0 +1,193 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/assets/packed_asset_bundle.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "flutter/fml/build_config.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/zlib/zlib.h"
+
+#if !OS_WIN
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // !OS_WIN
+
+namespace flutter {
+
+std::unique_ptr<PackedAssetBundle> PackedAssetBundle::Open(
+    const fml::UniqueFD& assets_directory) {
+  if (!assets_directory.is_valid() ||
+      !fml::FileExists(assets_directory, asset_pack::kFileName)) {
+    return nullptr;
+  }
+  TRACE_EVENT0("flutter", "PackedAssetBundle::Open");
+  auto bundle = std::make_unique<PackedAssetBundle>(
+      fml::FileMapping::CreateReadOnly(assets_directory,
+                                       asset_pack::kFileName));
+  if (!bundle->IsValid()) {
+    FML_LOG(ERROR) << "The asset pack was not valid and will be ignored.";
+    return nullptr;
+  }
+  return bundle;
+}
+
+PackedAssetBundle::PackedAssetBundle(std::unique_ptr<fml::Mapping> pack)
+    : pack_(std::move(pack)) {
+  if (!pack_ || pack_->GetMapping() == nullptr ||
+      pack_->GetSize() < sizeof(asset_pack::Header)) {
+    return;
+  }
+
+  asset_pack::Header header;
+  std::memcpy(&header, pack_->GetMapping(), sizeof(header));
+  if (header.magic != asset_pack::kMagic ||
+      header.version != asset_pack::kVersion) {
+    FML_DLOG(WARNING) << "The asset pack has an unknown format.";
+    return;
+  }
+
+  const uint8_t* entries = pack_->GetMapping() + sizeof(header);
+  if (reinterpret_cast<uintptr_t>(entries) % alignof(asset_pack::Entry) != 0) {
+    return;
+  }
+  const size_t index_size =
+      sizeof(header) +
+      static_cast<size_t>(header.entry_count) * sizeof(asset_pack::Entry) +
+      header.names_size;
+  if (index_size > pack_->GetSize()) {
+    return;
+  }
+  entries_ = reinterpret_cast<const asset_pack::Entry*>(entries);
+  entry_count_ = header.entry_count;
+  names_ = reinterpret_cast<const char*>(entries_ + entry_count_);
+
+  if (!ValidateIndex(header.names_size)) {
+    FML_DLOG(WARNING) << "The asset pack has entries outside of it.";
+    return;
+  }
+
+  is_valid_ = true;
+  PrefetchAssets();
+}
+
+PackedAssetBundle::~PackedAssetBundle() = default;
+
+size_t PackedAssetBundle::GetAssetCount() const {
+  return entry_count_;
+}
+
+bool PackedAssetBundle::ValidateIndex(size_t names_size) const {
+  const uint64_t pack_size = pack_->GetSize();
+  for (size_t i = 0; i < entry_count_; ++i) {
+    const asset_pack::Entry& entry = entries_[i];
+    if (static_cast<uint64_t>(entry.name_offset) + entry.name_size >
+            names_size ||
+        entry.data_offset > pack_size ||
+        entry.stored_size > pack_size - entry.data_offset) {
+      return false;
+    }
+    // The stored size is within the pack at this point, so this cannot
+    // overflow.
+    if ((entry.flags & asset_pack::kCompressed) == 0
+            ? entry.stored_size != entry.size
+            : entry.size >
+                  entry.stored_size * asset_pack::kMaxCompressionRatio) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PackedAssetBundle::PrefetchAssets() const {
+#if !OS_WIN
+  TRACE_EVENT0("flutter", "PackedAssetBundle::PrefetchAssets");
+  const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  const uintptr_t base = reinterpret_cast<uintptr_t>(pack_->GetMapping());
+  for (size_t i = 0; i < entry_count_; ++i) {
+    const asset_pack::Entry& entry = entries_[i];
+    if ((entry.flags & asset_pack::kPrefetch) == 0 || entry.stored_size == 0) {
+      continue;
+    }
+    // The advice must start on a page boundary.
+    const uintptr_t start = base + entry.data_offset;
+    const uintptr_t page_start = start & ~(page_size - 1);
+    // The advice is only a hint, so failing to give it is not an error.
+    madvise(reinterpret_cast<void*>(page_start),
+            start - page_start + entry.stored_size, MADV_WILLNEED);
+  }
+#endif  // !OS_WIN
+}
+
+const asset_pack::Entry* PackedAssetBundle::FindEntry(
+    const std::string& asset_name) const {
+  const uint32_t hash =
+      asset_pack::HashName(asset_name.data(), asset_name.size());
+  auto key = [this](const asset_pack::Entry& entry) {
+    return std::make_tuple(
+        entry.name_hash,
+        std::string_view(names_ + entry.name_offset, entry.name_size));
+  };
+  const auto name_key = std::make_tuple(hash, std::string_view(asset_name));
+  const asset_pack::Entry* end = entries_ + entry_count_;
+  const asset_pack::Entry* found = std::lower_bound(
+      entries_, end, name_key,
+      [&key](const asset_pack::Entry& entry, const auto& name_key) {
+        return key(entry) < name_key;
+      });
+  if (found == end || key(*found) != name_key) {
+    return nullptr;
+  }
+  return found;
+}
+
+// |AssetResolver|
+bool PackedAssetBundle::IsValid() const {
+  return is_valid_;
+}
+
+// |AssetResolver|
+std::unique_ptr<fml::Mapping> PackedAssetBundle::GetAsMapping(
+    const std::string& asset_name) const {
+  if (!is_valid_) {
+    FML_DLOG(WARNING) << "Asset pack was not valid.";
+    return nullptr;
+  }
+
+  const asset_pack::Entry* entry = FindEntry(asset_name);
+  if (entry == nullptr) {
+    return nullptr;
+  }
+
+  const uint8_t* data = pack_->GetMapping() + entry->data_offset;
+  if ((entry->flags & asset_pack::kCompressed) == 0) {
+    // The slice keeps the pack mapped for as long as it is alive.
+    return std::make_unique<fml::NonOwnedMapping>(
+        data, entry->size,
+        [pack = pack_](const uint8_t* data, size_t size) {});
+  }
+
+  TRACE_EVENT1("flutter", "PackedAssetBundle::Inflate", "name",
+               asset_name.c_str());
+  std::vector<uint8_t> contents(entry->size);
+  uLongf inflated_size = contents.size();
+  if (uncompress(contents.data(), &inflated_size, data, entry->stored_size) !=
+          Z_OK ||
+      inflated_size != contents.size()) {
+    FML_LOG(ERROR) << "Could not inflate asset: " << asset_name;
+    return nullptr;
+  }
+  return std::make_unique<fml::DataMapping>(std::move(contents));
+}
+
+}  // namespace flutter
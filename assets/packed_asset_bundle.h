@@ -0,0 +1,78 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_ASSETS_PACKED_ASSET_BUNDLE_H_
+#define FLUTTER_ASSETS_PACKED_ASSET_BUNDLE_H_
+
+#include <memory>
+
+#include "flutter/assets/asset_pack.h"
+#include "flutter/assets/asset_resolver.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/unique_fd.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      Resolves assets from a single pack built by the `asset-pack`
+///             host tool, instead of from one file per asset.
+///
+///             The pack is mapped once. Looking an asset up is a binary search
+///             of its index, and uncompressed assets are returned as slices of
+///             the mapping, so that no file is opened or mapped per asset.
+///
+/// @see        `asset_pack.h` for the layout of the pack.
+///
+class PackedAssetBundle : public AssetResolver {
+ public:
+  //----------------------------------------------------------------------------
+  /// @brief      Opens the pack in an assets directory, if there is one.
+  ///
+  /// @param[in]  assets_directory  The directory to look for the pack in.
+  ///
+  /// @return     The bundle of the pack, or nullptr if the directory has no
+  ///             valid pack.
+  ///
+  static std::unique_ptr<PackedAssetBundle> Open(
+      const fml::UniqueFD& assets_directory);
+
+  //----------------------------------------------------------------------------
+  /// @param[in]  pack  The contents of the pack. The bundle is invalid if they
+  ///                   are not a valid pack.
+  ///
+  explicit PackedAssetBundle(std::unique_ptr<fml::Mapping> pack);
+
+  ~PackedAssetBundle() override;
+
+  size_t GetAssetCount() const;
+
+ private:
+  // Shared with the mappings handed out, which may outlive the bundle.
+  std::shared_ptr<fml::Mapping> pack_;
+  const asset_pack::Entry* entries_ = nullptr;
+  size_t entry_count_ = 0;
+  const char* names_ = nullptr;
+  bool is_valid_ = false;
+
+  // Checks that every entry lies within the pack.
+  bool ValidateIndex(size_t names_size) const;
+
+  // Asks the system to read the assets marked for prefetching ahead.
+  void PrefetchAssets() const;
+
+  const asset_pack::Entry* FindEntry(const std::string& asset_name) const;
+
+  // |AssetResolver|
+  bool IsValid() const override;
+
+  // |AssetResolver|
+  std::unique_ptr<fml::Mapping> GetAsMapping(
+      const std::string& asset_name) const override;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PackedAssetBundle);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_ASSETS_PACKED_ASSET_BUNDLE_H_
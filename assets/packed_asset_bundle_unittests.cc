@@ -0,0 +1,164 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/assets/packed_asset_bundle.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "flutter/assets/asset_pack_writer.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/testing/testing.h"
+
+namespace flutter {
+namespace testing {
+
+static std::vector<uint8_t> ToBytes(const std::string& string) {
+  return std::vector<uint8_t>(string.begin(), string.end());
+}
+
+static std::string ToString(const fml::Mapping& mapping) {
+  return std::string(reinterpret_cast<const char*>(mapping.GetMapping()),
+                     mapping.GetSize());
+}
+
+static std::unique_ptr<AssetResolver> MakeBundle(
+    const AssetPackWriter& writer) {
+  return std::make_unique<PackedAssetBundle>(
+      std::make_unique<fml::DataMapping>(writer.Build()));
+}
+
+TEST(PackedAssetBundleTest, FindsEveryAsset) {
+  AssetPackWriter writer;
+  for (int i = 0; i < 1000; ++i) {
+    const std::string name = "icons/icon_" + std::to_string(i) + ".png";
+    ASSERT_TRUE(writer.AddAsset(name, ToBytes(name), false, false));
+  }
+  auto bundle = MakeBundle(writer);
+  ASSERT_TRUE(bundle->IsValid());
+
+  for (int i = 0; i < 1000; ++i) {
+    const std::string name = "icons/icon_" + std::to_string(i) + ".png";
+    auto mapping = bundle->GetAsMapping(name);
+    ASSERT_NE(mapping, nullptr) << name;
+    ASSERT_EQ(ToString(*mapping), name);
+  }
+  ASSERT_EQ(bundle->GetAsMapping("icons/icon_1000.png"), nullptr);
+  ASSERT_EQ(bundle->GetAsMapping("icons"), nullptr);
+  ASSERT_EQ(bundle->GetAsMapping(""), nullptr);
+}
+
+TEST(PackedAssetBundleTest, InflatesCompressedAssets) {
+  const std::string json = "{" + std::string(4096, ' ') + "}";
+  AssetPackWriter writer;
+  ASSERT_TRUE(writer.AddAsset("data.json", ToBytes(json), true, false));
+  // Too small to gain anything from compression, so stored as is.
+  ASSERT_TRUE(writer.AddAsset("tiny.json", ToBytes("{}"), true, false));
+  ASSERT_TRUE(writer.AddAsset("empty.json", {}, true, false));
+  const std::vector<uint8_t> pack = writer.Build();
+  ASSERT_LT(pack.size(), json.size());
+
+  PackedAssetBundle bundle(std::make_unique<fml::DataMapping>(pack));
+  AssetResolver& resolver = bundle;
+  ASSERT_EQ(ToString(*resolver.GetAsMapping("data.json")), json);
+  ASSERT_EQ(ToString(*resolver.GetAsMapping("tiny.json")), "{}");
+  ASSERT_EQ(resolver.GetAsMapping("empty.json")->GetSize(), 0u);
+}
+
+TEST(PackedAssetBundleTest, AssetsAreAlignedSlicesOfThePack) {
+  AssetPackWriter writer;
+  ASSERT_TRUE(writer.AddAsset("a", ToBytes("abc"), false, true));
+  ASSERT_TRUE(writer.AddAsset("b", ToBytes("defgh"), false, false));
+  auto pack = std::make_unique<fml::DataMapping>(writer.Build());
+  const uint8_t* pack_start = pack->GetMapping();
+  const uint8_t* pack_end = pack_start + pack->GetSize();
+  auto bundle = std::make_unique<PackedAssetBundle>(std::move(pack));
+  AssetResolver* resolver = bundle.get();
+
+  auto mapping = resolver->GetAsMapping("b");
+  ASSERT_NE(mapping, nullptr);
+  ASSERT_GE(mapping->GetMapping(), pack_start);
+  ASSERT_LE(mapping->GetMapping() + mapping->GetSize(), pack_end);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(mapping->GetMapping()) %
+                asset_pack::kDataAlignment,
+            reinterpret_cast<uintptr_t>(pack_start) %
+                asset_pack::kDataAlignment);
+
+  // The slice keeps the pack alive.
+  bundle.reset();
+  ASSERT_EQ(ToString(*mapping), "defgh");
+}
+
+TEST(PackedAssetBundleTest, DuplicateNamesAreRejected) {
+  AssetPackWriter writer;
+  ASSERT_TRUE(writer.AddAsset("a", ToBytes("1"), false, false));
+  ASSERT_FALSE(writer.AddAsset("a", ToBytes("2"), false, false));
+  ASSERT_EQ(writer.GetAssetCount(), 1u);
+}
+
+TEST(PackedAssetBundleTest, InvalidPacksAreRejected) {
+  AssetPackWriter writer;
+  ASSERT_TRUE(writer.AddAsset("a", ToBytes("abc"), false, false));
+  std::vector<uint8_t> pack = writer.Build();
+
+  std::vector<uint8_t> bad_magic = pack;
+  bad_magic[0] ^= 0xff;
+  std::unique_ptr<AssetResolver> resolver =
+      std::make_unique<PackedAssetBundle>(
+          std::make_unique<fml::DataMapping>(bad_magic));
+  ASSERT_FALSE(resolver->IsValid());
+
+  std::vector<uint8_t> truncated(pack.begin(), pack.end() - 2);
+  resolver = std::make_unique<PackedAssetBundle>(
+      std::make_unique<fml::DataMapping>(truncated));
+  ASSERT_FALSE(resolver->IsValid());
+
+  resolver = std::make_unique<PackedAssetBundle>(nullptr);
+  ASSERT_FALSE(resolver->IsValid());
+}
+
+TEST(PackedAssetBundleTest, OversizedCompressedAssetsAreRejected) {
+  AssetPackWriter writer;
+  ASSERT_TRUE(writer.AddAsset("a", std::vector<uint8_t>(4096, 'a'), true,
+                              false));
+  std::vector<uint8_t> pack = writer.Build();
+
+  asset_pack::Entry entry;
+  std::memcpy(&entry, pack.data() + sizeof(asset_pack::Header), sizeof(entry));
+  ASSERT_NE(entry.flags & asset_pack::kCompressed, 0u);
+  std::unique_ptr<AssetResolver> resolver =
+      std::make_unique<PackedAssetBundle>(
+          std::make_unique<fml::DataMapping>(pack));
+  ASSERT_TRUE(resolver->IsValid());
+
+  // More than the compressed contents could ever inflate to.
+  entry.size = entry.stored_size * asset_pack::kMaxCompressionRatio + 1;
+  std::memcpy(pack.data() + sizeof(asset_pack::Header), &entry, sizeof(entry));
+  resolver = std::make_unique<PackedAssetBundle>(
+      std::make_unique<fml::DataMapping>(pack));
+  ASSERT_FALSE(resolver->IsValid());
+}
+
+TEST(PackedAssetBundleTest, OpensThePackInAnAssetsDirectory) {
+  fml::ScopedTemporaryDirectory assets_dir;
+  ASSERT_EQ(PackedAssetBundle::Open(assets_dir.fd()), nullptr);
+
+  AssetPackWriter writer;
+  ASSERT_TRUE(
+      writer.AddAsset("fonts/Roboto.ttf", ToBytes("font"), true, true));
+  fml::DataMapping pack(writer.Build());
+  ASSERT_TRUE(
+      fml::WriteAtomically(assets_dir.fd(), asset_pack::kFileName, pack));
+
+  std::unique_ptr<AssetResolver> bundle =
+      PackedAssetBundle::Open(assets_dir.fd());
+  ASSERT_NE(bundle, nullptr);
+  ASSERT_EQ(ToString(*bundle->GetAsMapping("fonts/Roboto.ttf")), "font");
+  ASSERT_TRUE(fml::UnlinkFile(assets_dir.fd(), asset_pack::kFileName));
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -41,6 +41,7 @@ std::string Settings::ToString() const {
   stream << "dump_skp_on_shader_compilation: " << dump_skp_on_shader_compilation
          << std::endl;
   stream << "cache_sksl: " << cache_sksl << std::endl;
+  stream << "cache_shaped_runs: " << cache_shaped_runs << std::endl;
   stream << "endless_trace_buffer: " << endless_trace_buffer << std::endl;
   stream << "enable_dart_profiling: " << enable_dart_profiling << std::endl;
   stream << "disable_dart_asserts: " << disable_dart_asserts << std::endl;
@@ -58,6 +59,15 @@ std::string Settings::ToString() const {
   stream << "assets_path: " << assets_path << std::endl;
   stream << "frame_rasterized_callback set: " << !!frame_rasterized_callback
          << std::endl;
+  stream << "frame_record_callback set: " << !!frame_record_callback
+         << std::endl;
+  stream << "adaptive_pipeline_depth: " << adaptive_pipeline_depth
+         << std::endl;
+  stream << "raster_cache_max_bytes: " << raster_cache_max_bytes << std::endl;
+  stream << "raster_cache_max_unused_frames: "
+         << raster_cache_max_unused_frames << std::endl;
+  stream << "decoded_image_cache_max_bytes: " << decoded_image_cache_max_bytes
+         << std::endl;
   stream << "old_gen_heap_size: " << old_gen_heap_size << std::endl;
   return stream.str();
 }
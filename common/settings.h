@@ -31,8 +31,31 @@ class FrameTiming {
     return data_[phase] = value;
   }
 
+  // The vsync deadline the frame was built for. This is not one of the
+  // |kPhases| as it is not reported to the framework.
+  fml::TimePoint GetVsyncTarget() const { return vsync_target_; }
+  void SetVsyncTarget(fml::TimePoint value) { vsync_target_ = value; }
+
  private:
   fml::TimePoint data_[kCount];
+  fml::TimePoint vsync_target_;
+};
+
+// What happened to a frame that was scheduled by a vsync.
+struct FrameRecord {
+  enum class Status {
+    // The frame was built and rasterized. All phases of |timing| are set.
+    kRasterized,
+    // The frame was never built because the pipeline was full when the vsync
+    // arrived. Only the vsync target of |timing| is set.
+    kDropped,
+    // The frame was built but a newer frame replaced it before it could be
+    // rasterized. The raster phases of |timing| are not set.
+    kCoalesced,
+  };
+
+  Status status = Status::kRasterized;
+  FrameTiming timing;
 };
 
 using TaskObserverAdd =
@@ -50,6 +73,7 @@ using MappingsCallback =
     std::function<std::vector<std::unique_ptr<const fml::Mapping>>(void)>;
 
 using FrameRasterizedCallback = std::function<void(const FrameTiming&)>;
+using FrameRecordCallback = std::function<void(const FrameRecord&)>;
 
 struct Settings {
   Settings();
@@ -93,8 +117,18 @@ struct Settings {
   bool trace_skia = false;
   bool trace_startup = false;
   bool trace_systrace = false;
+  // Record trace events into per thread ring buffers, which the
+  // _flutter.getTraceBuffer service protocol extension exports.
+  bool trace_to_buffer = false;
+  // The comma separated names of the trace categories to record. All
+  // categories are recorded if this is empty.
+  std::string trace_categories;
   bool dump_skp_on_shader_compilation = false;
   bool cache_sksl = false;
+  // Keep the words shaped by the text layout in the persistent cache, for the
+  // layout of later launches. The cache holds the text of those words, so this
+  // is off unless an app opts in. Read-only caches never keep them.
+  bool cache_shaped_runs = false;
   bool endless_trace_buffer = false;
   bool enable_dart_profiling = false;
   bool disable_dart_asserts = false;
@@ -162,6 +196,22 @@ struct Settings {
   // blocking calls in this callback will cause applications to jank.
   UnhandledExceptionCallback unhandled_exception_callback;
   bool enable_software_rendering = false;
+  // Rasterize software frames in tiles on the concurrent workers instead of
+  // on the GPU thread alone.
+  bool enable_tiled_software_rendering = false;
+  // Populate the raster cache on the concurrent workers instead of during
+  // preroll on the GPU thread.
+  bool enable_async_raster_cache = false;
+  // The most bytes the images of the raster cache may take up before the
+  // entries that are cheapest to raster again are evicted. Zero leaves the
+  // cache unbounded.
+  size_t raster_cache_max_bytes = 0;
+  // The number of consecutive frames a raster cache entry may go unused
+  // before it is evicted.
+  size_t raster_cache_max_unused_frames = 0;
+  // The most bytes the decoded images kept for reuse by later decodes of the
+  // same content may take up. Zero disables the cache.
+  size_t decoded_image_cache_max_bytes = 16 * 1024 * 1024;
   bool skia_deterministic_rendering_on_cpu = false;
   bool verbose_logging = false;
   std::string log_tag = "flutter";
@@ -183,6 +233,23 @@ struct Settings {
   // soon as a frame is rasterized.
   FrameRasterizedCallback frame_rasterized_callback;
 
+  // Callback to handle the record of every frame scheduled by a vsync,
+  // including the ones that were dropped or coalesced. This is called on the
+  // UI thread for dropped frames and on the GPU thread otherwise.
+  FrameRecordCallback frame_record_callback;
+
+  // Whether the depth of the frame pipeline adapts to how long frames take.
+  // It starts at one frame for the lowest latency and grows, up to three
+  // frames, when a frame would otherwise be dropped because the pipeline is
+  // full.
+  bool adaptive_pipeline_depth = false;
+
+  // Whether semantics updates are sent to the platform view as the changes
+  // they make to the semantics tree, encoded on the UI thread. The platform
+  // view then gets them in |PlatformView::UpdateEncodedSemantics| instead of
+  // |PlatformView::UpdateSemantics|.
+  bool encode_semantics_updates = false;
+
   // This data will be available to the isolate immediately on launch via the
   // Window.getPersistentIsolateData callback. This is meant for information
   // that the isolate cannot request asynchronously (platform messages can be
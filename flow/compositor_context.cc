@@ -5,12 +5,20 @@
 #include "flutter/flow/compositor_context.h"
 
 #include "flutter/flow/layers/layer_tree.h"
+#include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 
 namespace flutter {
 
-CompositorContext::CompositorContext(fml::Milliseconds frame_budget)
-    : raster_time_(frame_budget), ui_time_(frame_budget) {}
+CompositorContext::CompositorContext(fml::Milliseconds frame_budget,
+                                     size_t raster_cache_max_bytes,
+                                     size_t raster_cache_max_unused_frames)
+    : raster_cache_(RasterCache::kDefaultAccessThreshold,
+                    RasterCache::kDefaultPictureCacheLimitPerFrame,
+                    raster_cache_max_bytes,
+                    raster_cache_max_unused_frames),
+      raster_time_(frame_budget),
+      ui_time_(frame_budget) {}
 
 CompositorContext::~CompositorContext() = default;
 
@@ -71,6 +79,9 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
     flutter::LayerTree& layer_tree,
     bool ignore_raster_cache) {
   bool root_needs_readback = layer_tree.Preroll(*this, ignore_raster_cache);
+  if (partial_repaint_enabled_) {
+    damage_ = ComputeDamage(layer_tree);
+  }
   bool needs_save_layer = root_needs_readback && !surface_supports_readback();
   PostPrerollResult post_preroll_result = PostPrerollResult::kSuccess;
   if (view_embedder_ && gpu_thread_merger_) {
@@ -80,9 +91,21 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
   if (post_preroll_result == PostPrerollResult::kResubmitFrame) {
     return RasterStatus::kResubmit;
   }
+  if (partial_repaint_enabled_ && damage_.isEmpty()) {
+    TRACE_EVENT_INSTANT0("flutter", "No damage, skipping paint");
+    return RasterStatus::kSuccess;
+  }
   // Clearing canvas after preroll reduces one render target switch when preroll
   // paints some raster cache.
   if (canvas()) {
+    if (partial_repaint_enabled_) {
+      // The damage is in device space, so clip with an identity matrix.
+      canvas()->save();
+      const SkMatrix matrix = canvas()->getTotalMatrix();
+      canvas()->resetMatrix();
+      canvas()->clipRect(SkRect::Make(damage_));
+      canvas()->setMatrix(matrix);
+    }
     if (needs_save_layer) {
       FML_LOG(INFO) << "Using SaveLayer to protect non-readback surface";
       SkRect bounds = SkRect::Make(layer_tree.frame_size());
@@ -96,9 +119,41 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
   if (canvas() && needs_save_layer) {
     canvas()->restore();
   }
+  if (canvas() && partial_repaint_enabled_) {
+    canvas()->restore();
+  }
   return RasterStatus::kSuccess;
 }
 
+void CompositorContext::ScopedFrame::EnablePartialRepaint(
+    const LayerTree* previous_layer_tree) {
+  partial_repaint_enabled_ = true;
+  previous_layer_tree_ = previous_layer_tree;
+}
+
+SkIRect CompositorContext::ScopedFrame::ComputeDamage(
+    const LayerTree& layer_tree) const {
+  const SkIRect full_frame = SkIRect::MakeSize(
+      canvas_ ? canvas_->getBaseLayerSize() : layer_tree.frame_size());
+
+  // Re-rastering the previous tree replaces its paint record during Preroll,
+  // so there is nothing left to diff against.
+  if (previous_layer_tree_ == nullptr || previous_layer_tree_ == &layer_tree ||
+      previous_layer_tree_->frame_size() != layer_tree.frame_size() ||
+      previous_layer_tree_->damage_context() == nullptr ||
+      layer_tree.damage_context() == nullptr) {
+    return full_frame;
+  }
+
+  SkIRect damage = layer_tree.damage_context()->ComputeDamage(
+      *previous_layer_tree_->damage_context());
+  if (!damage.intersect(full_frame)) {
+    return SkIRect::MakeEmpty();
+  }
+  TRACE_EVENT_INSTANT0("flutter", "Partial repaint");
+  return damage;
+}
+
 void CompositorContext::OnGrContextCreated() {
   texture_registry_.OnGrContextCreated();
   raster_cache_.Clear();
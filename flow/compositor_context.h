@@ -67,6 +67,19 @@ class CompositorContext {
     virtual RasterStatus Raster(LayerTree& layer_tree,
                                 bool ignore_raster_cache);
 
+    // Enables partial repaint for this frame. The layer tree records what it
+    // paints during Preroll and painting is clipped to the area that differs
+    // from |previous_layer_tree|, which must be the tree whose contents the
+    // surface still holds. If it is null, or was not rastered with partial
+    // repaint, the whole frame is repainted. Must be called before |Raster|.
+    void EnablePartialRepaint(const LayerTree* previous_layer_tree);
+
+    bool partial_repaint_enabled() const { return partial_repaint_enabled_; }
+
+    // The device space area repainted by the last call to |Raster|. Only
+    // meaningful when partial repaint is enabled.
+    const SkIRect& damage() const { return damage_; }
+
    private:
     CompositorContext& context_;
     GrContext* gr_context_;
@@ -76,11 +89,22 @@ class CompositorContext {
     const bool instrumentation_enabled_;
     const bool surface_supports_readback_;
     fml::RefPtr<fml::GpuThreadMerger> gpu_thread_merger_;
+    bool partial_repaint_enabled_ = false;
+    const LayerTree* previous_layer_tree_ = nullptr;
+    SkIRect damage_ = SkIRect::MakeEmpty();
+
+    SkIRect ComputeDamage(const LayerTree& layer_tree) const;
 
     FML_DISALLOW_COPY_AND_ASSIGN(ScopedFrame);
   };
 
-  CompositorContext(fml::Milliseconds frame_budget = fml::kDefaultFrameBudget);
+  // |raster_cache_max_bytes| and |raster_cache_max_unused_frames| are the
+  // budget of the raster cache, see |RasterCache::RasterCache|.
+  CompositorContext(
+      fml::Milliseconds frame_budget = fml::kDefaultFrameBudget,
+      size_t raster_cache_max_bytes = RasterCache::kDefaultMaxBytes,
+      size_t raster_cache_max_unused_frames =
+          RasterCache::kDefaultMaxUnusedFrames);
 
   virtual ~CompositorContext();
 
@@ -0,0 +1,244 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/damage_context.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkData.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr uint64_t kFNVOffsetBasis = 0xcbf29ce484222325ull;
+constexpr uint64_t kFNVPrime = 0x100000001b3ull;
+
+uint64_t EntryKey(uint64_t hash, const SkIRect& bounds) {
+  return DamageContext::Hash(&bounds, sizeof(bounds), hash);
+}
+
+// Returns, for the given sequence, a mask of the elements that are part of
+// one of its longest strictly increasing subsequences.
+std::vector<bool> LongestIncreasingSubsequence(
+    const std::vector<size_t>& values) {
+  std::vector<size_t> tails;  // Indices into |values|.
+  std::vector<size_t> predecessor(values.size(), values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    auto it = std::lower_bound(
+        tails.begin(), tails.end(), values[i],
+        [&values](size_t index, size_t value) { return values[index] < value; });
+    if (it != tails.begin()) {
+      predecessor[i] = *(it - 1);
+    }
+    if (it == tails.end()) {
+      tails.push_back(i);
+    } else {
+      *it = i;
+    }
+  }
+
+  std::vector<bool> in_subsequence(values.size(), false);
+  if (!tails.empty()) {
+    for (size_t i = tails.back(); i < values.size(); i = predecessor[i]) {
+      in_subsequence[i] = true;
+    }
+  }
+  return in_subsequence;
+}
+
+}  // namespace
+
+DamageContext::DamageContext() = default;
+
+DamageContext::~DamageContext() = default;
+
+void DamageContext::PushEffect(uint64_t effect_hash) {
+  const uint64_t parent = effect_stack_.empty() ? 0 : effect_stack_.back();
+  effect_stack_.push_back(HashCombine(parent, effect_hash));
+}
+
+void DamageContext::PopEffect() {
+  FML_DCHECK(!effect_stack_.empty());
+  effect_stack_.pop_back();
+}
+
+DamageContext::AutoEffect::AutoEffect(DamageContext* damage_context,
+                                      uint64_t effect_hash)
+    : damage_context_(damage_context) {
+  if (damage_context_) {
+    damage_context_->PushEffect(effect_hash);
+  }
+}
+
+DamageContext::AutoEffect::~AutoEffect() {
+  if (damage_context_) {
+    damage_context_->PopEffect();
+  }
+}
+
+void DamageContext::AddPaint(uint64_t content_hash,
+                             const SkMatrix& matrix,
+                             const SkRect& local_bounds,
+                             const SkRect& cull_rect) {
+  AddEntry(content_hash, matrix, local_bounds, cull_rect, false);
+}
+
+void DamageContext::AddVolatilePaint(const SkMatrix& matrix,
+                                     const SkRect& local_bounds,
+                                     const SkRect& cull_rect) {
+  AddEntry(0, matrix, local_bounds, cull_rect, true);
+}
+
+void DamageContext::EndGroup(size_t group,
+                             uint64_t group_hash,
+                             const SkMatrix& matrix,
+                             const SkRect& local_bounds,
+                             const SkRect& cull_rect) {
+  FML_DCHECK(group <= entries_.size());
+  bool is_volatile = false;
+  uint64_t hash = group_hash;
+  for (size_t i = group; i < entries_.size(); i++) {
+    is_volatile |= entries_[i].is_volatile;
+    hash = HashCombine(hash, EntryKey(entries_[i].hash, entries_[i].bounds));
+  }
+  entries_.resize(group);
+  AddEntry(hash, matrix, local_bounds, cull_rect, is_volatile);
+}
+
+void DamageContext::AddEntry(uint64_t content_hash,
+                             const SkMatrix& matrix,
+                             const SkRect& local_bounds,
+                             const SkRect& cull_rect,
+                             bool is_volatile) {
+  SkRect visible_bounds = local_bounds;
+  if (!visible_bounds.intersect(cull_rect)) {
+    return;
+  }
+  SkRect device_bounds;
+  matrix.mapRect(&device_bounds, visible_bounds);
+  SkIRect bounds;
+  device_bounds.roundOut(&bounds);
+  if (bounds.isEmpty()) {
+    return;
+  }
+
+  uint64_t hash = HashMatrix(matrix, content_hash);
+  if (!effect_stack_.empty()) {
+    hash = HashCombine(hash, effect_stack_.back());
+  }
+  entries_.push_back({hash, bounds, is_volatile});
+}
+
+SkIRect DamageContext::ComputeDamage(const DamageContext& previous) const {
+  TRACE_EVENT0("flutter", "DamageContext::ComputeDamage");
+  SkIRect damage = SkIRect::MakeEmpty();
+
+  // Previous entries by key, in paint order.
+  std::unordered_map<uint64_t, std::vector<size_t>> previous_by_key;
+  for (size_t i = 0; i < previous.entries_.size(); i++) {
+    const Entry& entry = previous.entries_[i];
+    if (entry.is_volatile) {
+      damage.join(entry.bounds);
+    } else {
+      previous_by_key[EntryKey(entry.hash, entry.bounds)].push_back(i);
+    }
+  }
+
+  // Match current entries against previous ones with identical content and
+  // bounds, consuming the previous entries in paint order.
+  std::unordered_map<uint64_t, size_t> next_match;
+  std::vector<bool> previous_matched(previous.entries_.size(), false);
+  std::vector<size_t> matched_current;
+  std::vector<size_t> matched_previous;
+  for (size_t i = 0; i < entries_.size(); i++) {
+    const Entry& entry = entries_[i];
+    if (entry.is_volatile) {
+      damage.join(entry.bounds);
+      continue;
+    }
+    const uint64_t key = EntryKey(entry.hash, entry.bounds);
+    auto found = previous_by_key.find(key);
+    size_t& cursor = next_match[key];
+    if (found == previous_by_key.end() || cursor >= found->second.size()) {
+      damage.join(entry.bounds);
+      continue;
+    }
+    const size_t previous_index = found->second[cursor++];
+    previous_matched[previous_index] = true;
+    matched_current.push_back(i);
+    matched_previous.push_back(previous_index);
+  }
+
+  for (size_t i = 0; i < previous.entries_.size(); i++) {
+    if (!previous_matched[i]) {
+      damage.join(previous.entries_[i].bounds);
+    }
+  }
+
+  // Matched entries whose relative paint order changed may now be painted
+  // above something they used to be painted below.
+  const std::vector<bool> in_order =
+      LongestIncreasingSubsequence(matched_previous);
+  for (size_t i = 0; i < matched_current.size(); i++) {
+    if (!in_order[i]) {
+      damage.join(entries_[matched_current[i]].bounds);
+    }
+  }
+
+  return damage;
+}
+
+uint64_t DamageContext::Hash(const void* data, size_t length, uint64_t seed) {
+  uint64_t hash = kFNVOffsetBasis ^ seed;
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < length; i++) {
+    hash ^= bytes[i];
+    hash *= kFNVPrime;
+  }
+  return hash;
+}
+
+uint64_t DamageContext::HashCombine(uint64_t seed, uint64_t value) {
+  return Hash(&value, sizeof(value), seed);
+}
+
+uint64_t DamageContext::HashMatrix(const SkMatrix& matrix, uint64_t seed) {
+  SkScalar values[9];
+  matrix.get9(values);
+  return Hash(values, sizeof(values), seed);
+}
+
+uint64_t DamageContext::HashRect(const SkRect& rect, uint64_t seed) {
+  return Hash(&rect, sizeof(rect), seed);
+}
+
+uint64_t DamageContext::HashRRect(const SkRRect& rrect, uint64_t seed) {
+  SkScalar values[SkRRect::kSizeInMemory / sizeof(SkScalar)];
+  rrect.writeToMemory(values);
+  return Hash(values, sizeof(values), seed);
+}
+
+uint64_t DamageContext::HashPath(const SkPath& path, uint64_t seed) {
+  std::vector<uint8_t> buffer(path.writeToMemory(nullptr));
+  path.writeToMemory(buffer.data());
+  return Hash(buffer.data(), buffer.size(), seed);
+}
+
+uint64_t DamageContext::HashFlattenable(const SkFlattenable* flattenable,
+                                        uint64_t seed) {
+  if (flattenable == nullptr) {
+    return HashCombine(seed, 0);
+  }
+  sk_sp<SkData> data = flattenable->serialize();
+  if (!data) {
+    return HashCombine(seed, reinterpret_cast<uintptr_t>(flattenable));
+  }
+  return Hash(data->data(), data->size(), seed);
+}
+
+}  // namespace flutter
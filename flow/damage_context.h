@@ -0,0 +1,130 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DAMAGE_CONTEXT_H_
+#define FLUTTER_FLOW_DAMAGE_CONTEXT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkFlattenable.h"
+#include "third_party/skia/include/core/SkMatrix.h"
+#include "third_party/skia/include/core/SkPath.h"
+#include "third_party/skia/include/core/SkRRect.h"
+#include "third_party/skia/include/core/SkRect.h"
+
+namespace flutter {
+
+// A device space record of everything a layer tree paints, built during
+// Preroll. Comparing the records of two consecutive frames yields the region
+// of the surface that has to be repainted (the damage) when the surface still
+// holds the contents of the previous frame.
+//
+// Every paint operation is recorded as an entry made of a fingerprint and its
+// device space bounds. The fingerprint covers the content itself (e.g. the
+// picture), the transform it is painted with and every effect applied to it
+// by its ancestors (clips, opacity, ...). Entries that appear in only one of
+// the two frames, or whose paint order relative to the other entries changed,
+// contribute their bounds to the damage.
+class DamageContext {
+ public:
+  DamageContext();
+
+  ~DamageContext();
+
+  // Mixes an effect applied by a container layer into the fingerprint of all
+  // entries added by its children. Effects must be pushed and popped in
+  // Preroll order. See |AutoEffect|.
+  void PushEffect(uint64_t effect_hash);
+
+  void PopEffect();
+
+  // Pushes an effect for the lifetime of the object. |damage_context| may be
+  // null, in which case this does nothing.
+  class AutoEffect {
+   public:
+    AutoEffect(DamageContext* damage_context, uint64_t effect_hash);
+
+    ~AutoEffect();
+
+   private:
+    DamageContext* damage_context_;
+
+    FML_DISALLOW_COPY_AND_ASSIGN(AutoEffect);
+  };
+
+  // Records a paint of |content_hash| covering |local_bounds| (clipped to
+  // |cull_rect|, both in the coordinate space of |matrix|).
+  void AddPaint(uint64_t content_hash,
+                const SkMatrix& matrix,
+                const SkRect& local_bounds,
+                const SkRect& cull_rect);
+
+  // Records a paint whose contents may change without any change to the layer
+  // tree (e.g. external textures or platform views). It is always damaged.
+  void AddVolatilePaint(const SkMatrix& matrix,
+                        const SkRect& local_bounds,
+                        const SkRect& cull_rect);
+
+  // Group entries are used by layers whose output is not bounded by the
+  // output of their children, such as image filters that blur beyond the
+  // child bounds. All entries added between |BeginGroup| and |EndGroup| are
+  // collapsed into a single entry with the bounds of the group layer, so any
+  // change within the group damages the whole group.
+  size_t BeginGroup() const { return entries_.size(); }
+
+  void EndGroup(size_t group,
+                uint64_t group_hash,
+                const SkMatrix& matrix,
+                const SkRect& local_bounds,
+                const SkRect& cull_rect);
+
+  // Returns the device space rectangle that has to be repainted to turn a
+  // surface holding the frame recorded by |previous| into this frame.
+  SkIRect ComputeDamage(const DamageContext& previous) const;
+
+  size_t entry_count() const { return entries_.size(); }
+
+  // Fingerprinting helpers for use by layers.
+  static uint64_t Hash(const void* data, size_t length, uint64_t seed = 0);
+
+  static uint64_t HashCombine(uint64_t seed, uint64_t value);
+
+  static uint64_t HashMatrix(const SkMatrix& matrix, uint64_t seed = 0);
+
+  static uint64_t HashRect(const SkRect& rect, uint64_t seed = 0);
+
+  static uint64_t HashRRect(const SkRRect& rrect, uint64_t seed = 0);
+
+  static uint64_t HashPath(const SkPath& path, uint64_t seed = 0);
+
+  // Hashes the serialized form of a shader, color filter or image filter.
+  // Layers receive new filter objects every frame, so identity is not useful.
+  static uint64_t HashFlattenable(const SkFlattenable* flattenable,
+                                  uint64_t seed = 0);
+
+ private:
+  struct Entry {
+    uint64_t hash;
+    SkIRect bounds;
+    bool is_volatile;
+  };
+
+  std::vector<Entry> entries_;
+  std::vector<uint64_t> effect_stack_;
+
+  void AddEntry(uint64_t content_hash,
+                const SkMatrix& matrix,
+                const SkRect& local_bounds,
+                const SkRect& cull_rect,
+                bool is_volatile);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DamageContext);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_DAMAGE_CONTEXT_H_
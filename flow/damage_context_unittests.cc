@@ -0,0 +1,141 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/damage_context.h"
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+static const SkRect kCullRect = SkRect::MakeWH(1000, 1000);
+
+TEST(DamageContext, IdenticalFramesHaveNoDamage) {
+  DamageContext previous;
+  previous.AddPaint(1, SkMatrix::I(), SkRect::MakeXYWH(0, 0, 10, 10),
+                    kCullRect);
+  previous.AddPaint(2, SkMatrix::I(), SkRect::MakeXYWH(20, 0, 10, 10),
+                    kCullRect);
+
+  DamageContext current;
+  current.AddPaint(1, SkMatrix::I(), SkRect::MakeXYWH(0, 0, 10, 10),
+                   kCullRect);
+  current.AddPaint(2, SkMatrix::I(), SkRect::MakeXYWH(20, 0, 10, 10),
+                   kCullRect);
+
+  EXPECT_TRUE(current.ComputeDamage(previous).isEmpty());
+}
+
+TEST(DamageContext, ChangedContentIsDamaged) {
+  DamageContext previous;
+  previous.AddPaint(1, SkMatrix::I(), SkRect::MakeXYWH(0, 0, 10, 10),
+                    kCullRect);
+  previous.AddPaint(2, SkMatrix::I(), SkRect::MakeXYWH(20, 0, 10, 10),
+                    kCullRect);
+
+  DamageContext current;
+  current.AddPaint(1, SkMatrix::I(), SkRect::MakeXYWH(0, 0, 10, 10),
+                   kCullRect);
+  current.AddPaint(3, SkMatrix::I(), SkRect::MakeXYWH(20, 0, 10, 10),
+                   kCullRect);
+
+  EXPECT_EQ(current.ComputeDamage(previous), SkIRect::MakeXYWH(20, 0, 10, 10));
+}
+
+TEST(DamageContext, MovedContentDamagesOldAndNewBounds) {
+  DamageContext previous;
+  previous.AddPaint(1, SkMatrix::I(), SkRect::MakeXYWH(0, 0, 10, 10),
+                    kCullRect);
+
+  DamageContext current;
+  current.AddPaint(1, SkMatrix::MakeTrans(5, 0),
+                   SkRect::MakeXYWH(0, 0, 10, 10), kCullRect);
+
+  EXPECT_EQ(current.ComputeDamage(previous), SkIRect::MakeXYWH(0, 0, 15, 10));
+}
+
+TEST(DamageContext, EffectChangesAreDamaged) {
+  DamageContext previous;
+  {
+    DamageContext::AutoEffect effect(&previous, 255);
+    previous.AddPaint(1, SkMatrix::I(), SkRect::MakeXYWH(0, 0, 10, 10),
+                      kCullRect);
+  }
+
+  DamageContext current;
+  {
+    DamageContext::AutoEffect effect(&current, 128);
+    current.AddPaint(1, SkMatrix::I(), SkRect::MakeXYWH(0, 0, 10, 10),
+                     kCullRect);
+  }
+
+  EXPECT_EQ(current.ComputeDamage(previous), SkIRect::MakeXYWH(0, 0, 10, 10));
+}
+
+TEST(DamageContext, ReorderedContentIsDamaged) {
+  DamageContext previous;
+  previous.AddPaint(1, SkMatrix::I(), SkRect::MakeXYWH(0, 0, 10, 10),
+                    kCullRect);
+  previous.AddPaint(2, SkMatrix::I(), SkRect::MakeXYWH(5, 0, 10, 10),
+                    kCullRect);
+  previous.AddPaint(3, SkMatrix::I(), SkRect::MakeXYWH(50, 0, 10, 10),
+                    kCullRect);
+
+  DamageContext current;
+  current.AddPaint(2, SkMatrix::I(), SkRect::MakeXYWH(5, 0, 10, 10),
+                   kCullRect);
+  current.AddPaint(1, SkMatrix::I(), SkRect::MakeXYWH(0, 0, 10, 10),
+                   kCullRect);
+  current.AddPaint(3, SkMatrix::I(), SkRect::MakeXYWH(50, 0, 10, 10),
+                   kCullRect);
+
+  const SkIRect damage = current.ComputeDamage(previous);
+  EXPECT_FALSE(damage.isEmpty());
+  EXPECT_FALSE(damage.contains(SkIRect::MakeXYWH(50, 0, 10, 10)));
+}
+
+TEST(DamageContext, VolatilePaintsAreAlwaysDamaged) {
+  DamageContext previous;
+  previous.AddVolatilePaint(SkMatrix::I(), SkRect::MakeXYWH(0, 0, 10, 10),
+                            kCullRect);
+
+  DamageContext current;
+  current.AddVolatilePaint(SkMatrix::I(), SkRect::MakeXYWH(0, 0, 10, 10),
+                           kCullRect);
+
+  EXPECT_EQ(current.ComputeDamage(previous), SkIRect::MakeXYWH(0, 0, 10, 10));
+}
+
+TEST(DamageContext, GroupsAreDamagedAsAWhole) {
+  DamageContext previous;
+  size_t group = previous.BeginGroup();
+  previous.AddPaint(1, SkMatrix::I(), SkRect::MakeXYWH(10, 10, 10, 10),
+                    kCullRect);
+  previous.EndGroup(group, 7, SkMatrix::I(), SkRect::MakeXYWH(0, 0, 30, 30),
+                    kCullRect);
+  EXPECT_EQ(previous.entry_count(), 1u);
+
+  DamageContext current;
+  group = current.BeginGroup();
+  current.AddPaint(2, SkMatrix::I(), SkRect::MakeXYWH(10, 10, 10, 10),
+                   kCullRect);
+  current.EndGroup(group, 7, SkMatrix::I(), SkRect::MakeXYWH(0, 0, 30, 30),
+                   kCullRect);
+
+  EXPECT_EQ(current.ComputeDamage(previous), SkIRect::MakeXYWH(0, 0, 30, 30));
+}
+
+TEST(DamageContext, PaintsOutsideCullRectAreIgnored) {
+  DamageContext previous;
+
+  DamageContext current;
+  current.AddPaint(1, SkMatrix::I(), SkRect::MakeXYWH(2000, 0, 10, 10),
+                   kCullRect);
+
+  EXPECT_EQ(current.entry_count(), 0u);
+  EXPECT_TRUE(current.ComputeDamage(previous).isEmpty());
+}
+
+}  // namespace testing
+}  // namespace flutter
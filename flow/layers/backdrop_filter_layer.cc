@@ -13,6 +13,14 @@ void BackdropFilterLayer::Preroll(PrerollContext* context,
                                   const SkMatrix& matrix) {
   Layer::AutoPrerollSaveLayerState save =
       Layer::AutoPrerollSaveLayerState::Create(context, true, bool(filter_));
+
+  // The filter applies to everything painted below it within the current
+  // clip. Treat that area as always damaged rather than tracking what the
+  // filter reads.
+  if (auto* damage_context = context->damage_context) {
+    damage_context->AddVolatilePaint(matrix, context->cull_rect,
+                                     context->cull_rect);
+  }
   ContainerLayer::Preroll(context, matrix);
 }
 
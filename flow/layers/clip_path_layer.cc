@@ -29,6 +29,9 @@ void ClipPathLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
     Layer::AutoPrerollSaveLayerState save =
         Layer::AutoPrerollSaveLayerState::Create(context, UsesSaveLayer());
     context->mutators_stack.PushClipPath(clip_path_);
+    DamageContext::AutoEffect damage_effect(
+        context->damage_context,
+        DamageContext::HashPath(clip_path_, clip_behavior_));
     SkRect child_paint_bounds = SkRect::MakeEmpty();
     PrerollChildren(context, matrix, &child_paint_bounds);
 
@@ -22,6 +22,9 @@ void ClipRectLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
     Layer::AutoPrerollSaveLayerState save =
         Layer::AutoPrerollSaveLayerState::Create(context, UsesSaveLayer());
     context->mutators_stack.PushClipRect(clip_rect_);
+    DamageContext::AutoEffect damage_effect(
+        context->damage_context,
+        DamageContext::HashRect(clip_rect_, clip_behavior_));
     SkRect child_paint_bounds = SkRect::MakeEmpty();
     PrerollChildren(context, matrix, &child_paint_bounds);
 
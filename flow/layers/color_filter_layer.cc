@@ -13,7 +13,18 @@ void ColorFilterLayer::Preroll(PrerollContext* context,
                                const SkMatrix& matrix) {
   Layer::AutoPrerollSaveLayerState save =
       Layer::AutoPrerollSaveLayerState::Create(context);
+
+  // A color filter may paint pixels its children left transparent, so any
+  // change to the children damages the whole layer.
+  auto* damage_context = context->damage_context;
+  const size_t damage_group =
+      damage_context ? damage_context->BeginGroup() : 0;
   ContainerLayer::Preroll(context, matrix);
+  if (damage_context) {
+    damage_context->EndGroup(damage_group,
+                             DamageContext::HashFlattenable(filter_.get()),
+                             matrix, paint_bounds(), context->cull_rect);
+  }
 }
 
 void ColorFilterLayer::Paint(PaintContext& context) const {
@@ -13,7 +13,19 @@ void ImageFilterLayer::Preroll(PrerollContext* context,
                                const SkMatrix& matrix) {
   Layer::AutoPrerollSaveLayerState save =
       Layer::AutoPrerollSaveLayerState::Create(context);
+
+  auto* damage_context = context->damage_context;
+  const size_t damage_group =
+      damage_context ? damage_context->BeginGroup() : 0;
   ContainerLayer::Preroll(context, matrix);
+  if (damage_context) {
+    // Filters like blurs reach beyond the bounds of the children.
+    const SkRect filter_bounds =
+        filter_ ? filter_->computeFastBounds(paint_bounds()) : paint_bounds();
+    damage_context->EndGroup(damage_group,
+                             DamageContext::HashFlattenable(filter_.get()),
+                             matrix, filter_bounds, context->cull_rect);
+  }
 
   if (!context->has_platform_view && context->raster_cache &&
       SkRect::Intersects(context->cull_rect, paint_bounds())) {
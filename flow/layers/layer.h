@@ -8,6 +8,7 @@
 #include <memory>
 #include <vector>
 
+#include "flutter/flow/damage_context.h"
 #include "flutter/flow/embedded_views.h"
 #include "flutter/flow/instrumentation.h"
 #include "flutter/flow/raster_cache.h"
@@ -66,6 +67,10 @@ struct PrerollContext {
   float total_elevation = 0.0f;
   bool has_platform_view = false;
   bool is_opaque = true;
+
+  // Records what each layer paints so that the frame can be diffed against
+  // the previous one. Null when partial repaint is disabled.
+  DamageContext* damage_context = nullptr;
 };
 
 // Represents a single composited layer. Created on the UI thread but then
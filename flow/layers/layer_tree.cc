@@ -21,8 +21,10 @@ LayerTree::LayerTree(const SkISize& frame_size,
       checkerboard_raster_cache_images_(false),
       checkerboard_offscreen_layers_(false) {}
 
-void LayerTree::RecordBuildTime(fml::TimePoint start) {
+void LayerTree::RecordBuildTime(fml::TimePoint start,
+                                fml::TimePoint target_time) {
   build_start_ = start;
+  target_time_ = target_time;
   build_finish_ = fml::TimePoint::Now();
 }
 
@@ -39,6 +41,12 @@ bool LayerTree::Preroll(CompositorContext::ScopedFrame& frame,
       frame.canvas() ? frame.canvas()->imageInfo().colorSpace() : nullptr;
   frame.context().raster_cache().SetCheckboardCacheImages(
       checkerboard_raster_cache_images_);
+  if (frame.partial_repaint_enabled()) {
+    damage_context_ = std::make_unique<DamageContext>();
+  } else {
+    damage_context_.reset();
+  }
+
   MutatorsStack stack;
   PrerollContext context = {
       ignore_raster_cache ? nullptr : &frame.context().raster_cache(),
@@ -54,6 +62,7 @@ bool LayerTree::Preroll(CompositorContext::ScopedFrame& frame,
       checkerboard_offscreen_layers_,
       frame_physical_depth_,
       frame_device_pixel_ratio_};
+  context.damage_context = damage_context_.get();
 
   root_layer_->Preroll(&context, frame.root_surface_transformation());
   return context.surface_needs_readback;
@@ -10,6 +10,7 @@
 #include <memory>
 
 #include "flutter/flow/compositor_context.h"
+#include "flutter/flow/damage_context.h"
 #include "flutter/flow/layers/layer.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/time/time_delta.h"
@@ -25,7 +26,9 @@ class LayerTree {
             float frame_device_pixel_ratio);
 
   // Perform a preroll pass on the tree and return information about
-  // the tree that affects rendering this frame.
+  // the tree that affects rendering this frame. When the frame has partial
+  // repaint enabled, this also records what the tree paints in its
+  // |damage_context|.
   //
   // Returns:
   // - a boolean indicating whether or not the top level of the
@@ -54,10 +57,13 @@ class LayerTree {
   float frame_physical_depth() const { return frame_physical_depth_; }
   float frame_device_pixel_ratio() const { return frame_device_pixel_ratio_; }
 
-  void RecordBuildTime(fml::TimePoint begin_start);
+  void RecordBuildTime(fml::TimePoint begin_start,
+                       fml::TimePoint target_time);
   fml::TimePoint build_start() const { return build_start_; }
   fml::TimePoint build_finish() const { return build_finish_; }
   fml::TimeDelta build_time() const { return build_finish_ - build_start_; }
+  // The vsync deadline this layer tree was built for.
+  fml::TimePoint target_time() const { return target_time_; }
 
   // The number of frame intervals missed after which the compositor must
   // trace the rasterized picture to a trace file. Specify 0 to disable all
@@ -80,10 +86,16 @@ class LayerTree {
 
   double device_pixel_ratio() const { return frame_device_pixel_ratio_; }
 
+  // The paint record of the last Preroll, or null if that Preroll was not
+  // done with partial repaint enabled.
+  const DamageContext* damage_context() const { return damage_context_.get(); }
+
  private:
   std::shared_ptr<Layer> root_layer_;
+  std::unique_ptr<DamageContext> damage_context_;
   fml::TimePoint build_start_;
   fml::TimePoint build_finish_;
+  fml::TimePoint target_time_;
   SkISize frame_size_ = SkISize::MakeEmpty();  // Physical pixels.
   float frame_physical_depth_;
   float frame_device_pixel_ratio_ = 1.0f;  // Logical / Physical pixels ratio.
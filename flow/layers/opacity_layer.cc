@@ -48,7 +48,10 @@ void OpacityLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   context->mutators_stack.PushOpacity(alpha_);
   Layer::AutoPrerollSaveLayerState save =
       Layer::AutoPrerollSaveLayerState::Create(context);
-  ContainerLayer::Preroll(context, child_matrix);
+  {
+    DamageContext::AutoEffect damage_effect(context->damage_context, alpha_);
+    ContainerLayer::Preroll(context, child_matrix);
+  }
   context->mutators_stack.Pop();
   context->mutators_stack.Pop();
   context->is_opaque = parent_is_opaque;
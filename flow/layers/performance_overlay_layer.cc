@@ -73,6 +73,15 @@ PerformanceOverlayLayer::PerformanceOverlayLayer(uint64_t options,
   }
 }
 
+void PerformanceOverlayLayer::Preroll(PrerollContext* context,
+                                      const SkMatrix& matrix) {
+  // The statistics change every frame.
+  if (auto* damage_context = context->damage_context) {
+    damage_context->AddVolatilePaint(matrix, paint_bounds(),
+                                     context->cull_rect);
+  }
+}
+
 void PerformanceOverlayLayer::Paint(PaintContext& context) const {
   const int padding = 8;
 
@@ -50,10 +50,30 @@ void PhysicalShapeLayer::Preroll(PrerollContext* context,
   Layer::AutoPrerollSaveLayerState save =
       Layer::AutoPrerollSaveLayerState::Create(context, UsesSaveLayer());
 
+  const uint64_t clip_hash = DamageContext::HashPath(path_, clip_behavior_);
+  if (auto* damage_context = context->damage_context) {
+    // The shape and its shadow are painted before the children.
+    uint64_t shape_hash = DamageContext::HashCombine(clip_hash, color_);
+    shape_hash = DamageContext::HashCombine(shape_hash, shadow_color_);
+    shape_hash = DamageContext::Hash(&elevation_, sizeof(elevation_),
+                                     shape_hash);
+    const SkRect shape_bounds =
+        elevation_ == 0
+            ? path_.getBounds()
+            : ComputeShadowBounds(path_.getBounds(), elevation_,
+                                  context->frame_device_pixel_ratio);
+    damage_context->AddPaint(shape_hash, matrix, shape_bounds,
+                             context->cull_rect);
+  }
+
   context->total_elevation += elevation_;
   total_elevation_ = context->total_elevation;
   SkRect child_paint_bounds;
-  PrerollChildren(context, matrix, &child_paint_bounds);
+  {
+    DamageContext::AutoEffect damage_effect(context->damage_context,
+                                            clip_hash);
+    PrerollChildren(context, matrix, &child_paint_bounds);
+  }
   context->total_elevation -= elevation_;
 
   if (elevation_ == 0) {
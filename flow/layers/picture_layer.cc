@@ -35,6 +35,11 @@ void PictureLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
 
   SkRect bounds = sk_picture->cullRect().makeOffset(offset_.x(), offset_.y());
   set_paint_bounds(bounds);
+
+  if (auto* damage_context = context->damage_context) {
+    damage_context->AddPaint(sk_picture->uniqueID(), matrix, bounds,
+                             context->cull_rect);
+  }
 }
 
 void PictureLayer::Paint(PaintContext& context) const {
@@ -16,6 +16,11 @@ void PlatformViewLayer::Preroll(PrerollContext* context,
   set_paint_bounds(SkRect::MakeXYWH(offset_.x(), offset_.y(), size_.width(),
                                     size_.height()));
 
+  if (auto* damage_context = context->damage_context) {
+    damage_context->AddVolatilePaint(matrix, paint_bounds(),
+                                     context->cull_rect);
+  }
+
   if (context->view_embedder == nullptr) {
     FML_LOG(ERROR) << "Trying to embed a platform view but the PrerollContext "
                       "does not support embedding";
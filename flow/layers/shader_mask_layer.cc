@@ -14,7 +14,18 @@ ShaderMaskLayer::ShaderMaskLayer(sk_sp<SkShader> shader,
 void ShaderMaskLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   Layer::AutoPrerollSaveLayerState save =
       Layer::AutoPrerollSaveLayerState::Create(context);
+
+  auto* damage_context = context->damage_context;
+  const size_t damage_group =
+      damage_context ? damage_context->BeginGroup() : 0;
   ContainerLayer::Preroll(context, matrix);
+  if (damage_context) {
+    uint64_t hash = DamageContext::HashFlattenable(shader_.get());
+    hash = DamageContext::HashRect(mask_rect_, hash);
+    hash = DamageContext::HashCombine(hash, static_cast<uint64_t>(blend_mode_));
+    damage_context->EndGroup(damage_group, hash, matrix, paint_bounds(),
+                             context->cull_rect);
+  }
 }
 
 void ShaderMaskLayer::Paint(PaintContext& context) const {
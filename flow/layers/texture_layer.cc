@@ -19,6 +19,12 @@ void TextureLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
 
   set_paint_bounds(SkRect::MakeXYWH(offset_.x(), offset_.y(), size_.width(),
                                     size_.height()));
+
+  // External textures update without any change to the layer tree.
+  if (auto* damage_context = context->damage_context) {
+    damage_context->AddVolatilePaint(matrix, paint_bounds(),
+                                     context->cull_rect);
+  }
 }
 
 void TextureLayer::Paint(PaintContext& context) const {
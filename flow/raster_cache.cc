@@ -4,11 +4,14 @@
 
 #include "flutter/flow/raster_cache.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "flutter/flow/layers/layer.h"
 #include "flutter/flow/paint_utils.h"
+#include "flutter/flow/texture_image_finder.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/time/time_point.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkImage.h"
@@ -38,9 +41,13 @@ void RasterCacheResult::draw(SkCanvas& canvas, const SkPaint* paint) const {
 }
 
 RasterCache::RasterCache(size_t access_threshold,
-                         size_t picture_cache_limit_per_frame)
+                         size_t picture_cache_limit_per_frame,
+                         size_t max_bytes,
+                         size_t max_unused_frames)
     : access_threshold_(access_threshold),
       picture_cache_limit_per_frame_(picture_cache_limit_per_frame),
+      max_bytes_(max_bytes),
+      max_unused_frames_(max_unused_frames),
       checkerboard_images_(false),
       weak_factory_(this) {}
 
@@ -158,6 +165,7 @@ void RasterCache::Prepare(PrerollContext* context,
   entry.access_count = ClampSize(entry.access_count + 1, 0, access_threshold_);
   entry.used_this_frame = true;
   if (!entry.image.is_valid()) {
+    const fml::TimePoint raster_start = fml::TimePoint::Now();
     entry.image = Rasterize(
         context->gr_context, ctm, context->dst_color_space,
         checkerboard_images_, layer->paint_bounds(),
@@ -182,6 +190,7 @@ void RasterCache::Prepare(PrerollContext* context,
             layer->Paint(paintContext);
           }
         });
+    entry.raster_time = fml::TimePoint::Now() - raster_start;
   }
 }
 
@@ -191,7 +200,8 @@ bool RasterCache::Prepare(GrContext* context,
                           SkColorSpace* dst_color_space,
                           bool is_complex,
                           bool will_change) {
-  if (picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
+  if (!worker_task_runner_ &&
+      picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
     return false;
   }
   if (!IsPictureWorthRasterizing(picture, will_change, is_complex)) {
@@ -208,6 +218,17 @@ bool RasterCache::Prepare(GrContext* context,
     return false;
   }
 
+  if (max_bytes_ > 0) {
+    const SkIRect device_bounds =
+        GetDeviceBounds(picture->cullRect(), transformation_matrix);
+    const size_t estimated_bytes =
+        static_cast<size_t>(device_bounds.width()) * device_bounds.height() * 4;
+    if (estimated_bytes > max_bytes_) {
+      // No amount of eviction would make room for this picture.
+      return false;
+    }
+  }
+
   PictureRasterCacheKey cache_key(picture->uniqueID(), transformation_matrix);
 
   Entry& entry = picture_cache_[cache_key];
@@ -219,11 +240,80 @@ bool RasterCache::Prepare(GrContext* context,
     return false;
   }
 
-  if (!entry.image.is_valid()) {
-    entry.image = RasterizePicture(picture, context, transformation_matrix,
-                                   dst_color_space, checkerboard_images_);
-    picture_cached_this_frame_++;
+  if (entry.image.is_valid()) {
+    return true;
+  }
+
+  if (entry.pending_image) {
+    return TakePendingImage(context, entry) && entry.image.is_valid();
+  }
+
+  if (worker_task_runner_) {
+    if (!entry.draws_texture_images.has_value()) {
+      entry.draws_texture_images = DrawsTextureImages(*picture);
+    }
+    if (!entry.draws_texture_images.value()) {
+      if (picture_started_this_frame_ < async_picture_cache_limit_per_frame_) {
+        PrepareAsync(entry, picture, transformation_matrix, dst_color_space);
+        picture_started_this_frame_++;
+      }
+      return false;
+    }
+    if (picture_cached_this_frame_ >= picture_cache_limit_per_frame_) {
+      return false;
+    }
+  }
+
+  const fml::TimePoint raster_start = fml::TimePoint::Now();
+  entry.image = RasterizePicture(picture, context, transformation_matrix,
+                                 dst_color_space, checkerboard_images_);
+  entry.raster_time = fml::TimePoint::Now() - raster_start;
+  entry.op_count = picture->approximateOpCount();
+  picture_cached_this_frame_++;
+  return true;
+}
+
+void RasterCache::PrepareAsync(Entry& entry,
+                               SkPicture* picture,
+                               const SkMatrix& transformation_matrix,
+                               SkColorSpace* dst_color_space) {
+  TRACE_EVENT0("flutter", "RasterCache::PrepareAsync");
+  auto pending_image = std::make_shared<PendingImage>();
+  entry.pending_image = pending_image;
+  entry.op_count = picture->approximateOpCount();
+  stats_.async_started_count++;
+  // The picture is rasterized into a raster surface, since the GrContext may
+  // only be used on this thread. Its image is uploaded once it is taken.
+  worker_task_runner_->PostTask(
+      [pending_image, picture = sk_ref_sp(picture), transformation_matrix,
+       dst_color_space = sk_ref_sp(dst_color_space),
+       checkerboard = checkerboard_images_]() {
+        const fml::TimePoint raster_start = fml::TimePoint::Now();
+        pending_image->image =
+            RasterizePicture(picture.get(), nullptr, transformation_matrix,
+                             dst_color_space.get(), checkerboard);
+        pending_image->raster_time = fml::TimePoint::Now() - raster_start;
+        pending_image->ready = true;
+      });
+}
+
+bool RasterCache::TakePendingImage(GrContext* context, Entry& entry) {
+  if (!entry.pending_image->ready) {
+    return false;
+  }
+  TRACE_EVENT0("flutter", "RasterCache::TakePendingImage");
+  RasterCacheResult image = std::move(entry.pending_image->image);
+  entry.raster_time = entry.pending_image->raster_time;
+  entry.pending_image.reset();
+  if (context && image.is_valid()) {
+    // Uploads the image now, rather than when it is first drawn.
+    sk_sp<SkImage> texture_image = image.image()->makeTextureImage(context);
+    if (texture_image) {
+      image = RasterCacheResult(std::move(texture_image), image.logical_rect());
+    }
   }
+  entry.image = std::move(image);
+  stats_.async_finished_count++;
   return true;
 }
 
@@ -231,33 +321,124 @@ RasterCacheResult RasterCache::Get(const SkPicture& picture,
                                    const SkMatrix& ctm) const {
   PictureRasterCacheKey cache_key(picture.uniqueID(), ctm);
   auto it = picture_cache_.find(cache_key);
-  return it == picture_cache_.end() ? RasterCacheResult() : it->second.image;
+  if (it == picture_cache_.end() || !it->second.image.is_valid()) {
+    stats_.miss_count++;
+    return RasterCacheResult();
+  }
+  stats_.hit_count++;
+  return it->second.image;
 }
 
 RasterCacheResult RasterCache::Get(Layer* layer, const SkMatrix& ctm) const {
   LayerRasterCacheKey cache_key(layer->unique_id(), ctm);
   auto it = layer_cache_.find(cache_key);
-  return it == layer_cache_.end() ? RasterCacheResult() : it->second.image;
+  if (it == layer_cache_.end() || !it->second.image.is_valid()) {
+    stats_.miss_count++;
+    return RasterCacheResult();
+  }
+  stats_.hit_count++;
+  return it->second.image;
+}
+
+size_t RasterCache::EntryBytes(const Entry& entry) {
+  const auto dimensions = entry.image.image_dimensions();
+  return static_cast<size_t>(dimensions.width()) * dimensions.height() * 4;
+}
+
+double RasterCache::EntryRetentionScore(const Entry& entry) {
+  // The raster time dominates when it is known. The op count keeps pictures
+  // that rasterized too quickly to measure ordered by complexity.
+  const double cost = entry.raster_time.ToMicrosecondsF() + entry.op_count;
+  const double bytes = std::max<size_t>(EntryBytes(entry), 1);
+  return cost / bytes / (entry.unused_frame_count + 1);
+}
+
+void RasterCache::RecordEviction(size_t bytes) {
+  stats_.evicted_count++;
+  stats_.evicted_bytes += bytes;
 }
 
 void RasterCache::SweepAfterFrame() {
-  using PictureCache = PictureRasterCacheKey::Map<Entry>;
-  using LayerCache = LayerRasterCacheKey::Map<Entry>;
-  SweepOneCacheAfterFrame<PictureCache, PictureCache::iterator>(picture_cache_);
-  SweepOneCacheAfterFrame<LayerCache, LayerCache::iterator>(layer_cache_);
+  size_t cached_bytes = SweepOneCacheAfterFrame(picture_cache_);
+  cached_bytes += SweepOneCacheAfterFrame(layer_cache_);
+  if (max_bytes_ > 0 && cached_bytes > max_bytes_) {
+    EvictToBudget(cached_bytes);
+  } else {
+    cached_bytes_ = cached_bytes;
+  }
   picture_cached_this_frame_ = 0;
+  picture_started_this_frame_ = 0;
   TraceStatsToTimeline();
 }
 
+void RasterCache::EvictToBudget(size_t cached_bytes) {
+  TRACE_EVENT0("flutter", "RasterCache::EvictToBudget");
+  using PictureCache = PictureRasterCacheKey::Map<Entry>;
+  using LayerCache = LayerRasterCacheKey::Map<Entry>;
+
+  struct Candidate {
+    double score;
+    size_t bytes;
+    PictureCache::iterator picture_it;
+    LayerCache::iterator layer_it;
+  };
+  std::vector<Candidate> candidates;
+
+  // Entries used in the frame that was just drawn are part of the working set
+  // and are never evicted to satisfy the budget. Evicting them would only
+  // cause them to be rasterized again on the next frame.
+  for (auto it = picture_cache_.begin(); it != picture_cache_.end(); ++it) {
+    if (it->second.unused_frame_count > 0) {
+      candidates.push_back({EntryRetentionScore(it->second),
+                            EntryBytes(it->second), it, layer_cache_.end()});
+    }
+  }
+  for (auto it = layer_cache_.begin(); it != layer_cache_.end(); ++it) {
+    if (it->second.unused_frame_count > 0) {
+      candidates.push_back({EntryRetentionScore(it->second),
+                            EntryBytes(it->second), picture_cache_.end(), it});
+    }
+  }
+
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate& a, const Candidate& b) {
+              return a.score < b.score;
+            });
+
+  for (const auto& candidate : candidates) {
+    if (cached_bytes <= max_bytes_) {
+      break;
+    }
+    if (candidate.picture_it != picture_cache_.end()) {
+      picture_cache_.erase(candidate.picture_it);
+    } else {
+      layer_cache_.erase(candidate.layer_it);
+    }
+    RecordEviction(candidate.bytes);
+    cached_bytes -= candidate.bytes;
+  }
+
+  cached_bytes_ = cached_bytes;
+}
+
 void RasterCache::Clear() {
   picture_cache_.clear();
   layer_cache_.clear();
+  cached_bytes_ = 0;
 }
 
 size_t RasterCache::GetCachedEntriesCount() const {
   return layer_cache_.size() + picture_cache_.size();
 }
 
+size_t RasterCache::GetCachedBytes() const {
+  return cached_bytes_;
+}
+
+void RasterCache::ResetStats() {
+  stats_ = Stats();
+}
+
 void RasterCache::SetCheckboardCacheImages(bool checkerboard) {
   if (checkerboard_images_ == checkerboard) {
     return;
@@ -270,6 +451,13 @@ void RasterCache::SetCheckboardCacheImages(bool checkerboard) {
   Clear();
 }
 
+void RasterCache::SetWorkerTaskRunner(
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+    size_t picture_cache_limit_per_frame) {
+  worker_task_runner_ = std::move(worker_task_runner);
+  async_picture_cache_limit_per_frame_ = picture_cache_limit_per_frame;
+}
+
 void RasterCache::TraceStatsToTimeline() const {
 #if !FLUTTER_RELEASE
 
@@ -279,15 +467,13 @@ void RasterCache::TraceStatsToTimeline() const {
   size_t picture_cache_bytes = 0;
 
   for (const auto& item : layer_cache_) {
-    const auto dimensions = item.second.image.image_dimensions();
     layer_cache_count++;
-    layer_cache_bytes += dimensions.width() * dimensions.height() * 4;
+    layer_cache_bytes += EntryBytes(item.second);
   }
 
   for (const auto& item : picture_cache_) {
-    const auto dimensions = item.second.image.image_dimensions();
     picture_cache_count++;
-    picture_cache_bytes += dimensions.width() * dimensions.height() * 4;
+    picture_cache_bytes += EntryBytes(item.second);
   }
 
   FML_TRACE_COUNTER("flutter", "RasterCache",
@@ -298,6 +484,20 @@ void RasterCache::TraceStatsToTimeline() const {
                     "PictureMBytes", picture_cache_bytes * 1e-6  //
   );
 
+  FML_TRACE_COUNTER("flutter", "RasterCacheEfficiency",
+                    reinterpret_cast<int64_t>(this),              //
+                    "Hits", stats_.hit_count,                     //
+                    "Misses", stats_.miss_count,                  //
+                    "EvictedCount", stats_.evicted_count,         //
+                    "EvictedMBytes", stats_.evicted_bytes * 1e-6  //
+  );
+
+  FML_TRACE_COUNTER("flutter", "RasterCacheAsync",
+                    reinterpret_cast<int64_t>(this),         //
+                    "Started", stats_.async_started_count,   //
+                    "Finished", stats_.async_finished_count  //
+  );
+
 #endif  // !FLUTTER_RELEASE
 }
 
@@ -5,13 +5,17 @@
 #ifndef FLUTTER_FLOW_RASTER_CACHE_H_
 #define FLUTTER_FLOW_RASTER_CACHE_H_
 
+#include <atomic>
 #include <memory>
+#include <optional>
 #include <unordered_map>
 
 #include "flutter/flow/instrumentation.h"
 #include "flutter/flow/raster_cache_key.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/fml/time/time_delta.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkSize.h"
 
@@ -37,6 +41,10 @@ class RasterCacheResult {
     return image_ ? image_->dimensions() : SkISize::Make(0, 0);
   };
 
+  const sk_sp<SkImage>& image() const { return image_; }
+
+  const SkRect& logical_rect() const { return logical_rect_; }
+
  private:
   sk_sp<SkImage> image_;
   SkRect logical_rect_;
@@ -52,9 +60,32 @@ class RasterCache {
   // multiple frames.
   static constexpr int kDefaultPictureCacheLimitPerFrame = 3;
 
+  // The default number of times a picture must be seen before it is cached.
+  static constexpr size_t kDefaultAccessThreshold = 3;
+
+  // The default max number of picture raster caches to be started per frame
+  // when they are populated on worker threads. Starting one costs the frame
+  // next to nothing, so this only bounds the work queued up at once.
+  static constexpr int kDefaultAsyncPictureCacheLimitPerFrame = 32;
+
+  // The default byte budget of the cache. Zero means the cache is unbounded
+  // and entries are only evicted when they go unused.
+  static constexpr size_t kDefaultMaxBytes = 0;
+
+  // The default number of consecutive frames an entry may go unused before it
+  // is evicted. Zero means entries are evicted as soon as a frame does not use
+  // them.
+  static constexpr size_t kDefaultMaxUnusedFrames = 0;
+
+  // The byte budget and unused frame allowance make the cache cost-aware. Once
+  // the cached images exceed |max_bytes|, the entries that were not used in
+  // the last frame are evicted in order of their estimated re-raster cost per
+  // byte (cheapest first) until the cache fits the budget again.
   explicit RasterCache(
-      size_t access_threshold = 3,
-      size_t picture_cache_limit_per_frame = kDefaultPictureCacheLimitPerFrame);
+      size_t access_threshold = kDefaultAccessThreshold,
+      size_t picture_cache_limit_per_frame = kDefaultPictureCacheLimitPerFrame,
+      size_t max_bytes = kDefaultMaxBytes,
+      size_t max_unused_frames = kDefaultMaxUnusedFrames);
 
   ~RasterCache();
 
@@ -81,6 +112,8 @@ class RasterCache {
   // 3. The picture is accessed too few times
   // 4. There are too many pictures to be cached in the current frame.
   //    (See also kDefaultPictureCacheLimitPerFrame.)
+  // 5. The rasterized picture alone would exceed the byte budget of the cache.
+  // 6. The picture is still being rasterized on a worker thread.
   bool Prepare(GrContext* context,
                SkPicture* picture,
                const SkMatrix& transformation_matrix,
@@ -100,35 +133,127 @@ class RasterCache {
 
   void SetCheckboardCacheImages(bool checkerboard);
 
+  // Rasterizes pictures on |worker_task_runner| instead of in |Prepare|. A
+  // picture keeps being drawn directly until its image is ready, and the
+  // first frame to prepare the picture after that swaps the image in. Up to
+  // |picture_cache_limit_per_frame| pictures are sent to the workers per
+  // frame. Passing a null task runner rasterizes pictures in |Prepare| again.
+  //
+  // Pictures that draw texture backed images are still rasterized in
+  // |Prepare|, since those images may only be read on this thread. Layers
+  // are always rasterized in |Prepare|, since painting them needs the rest
+  // of the frame.
+  void SetWorkerTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+      size_t picture_cache_limit_per_frame =
+          kDefaultAsyncPictureCacheLimitPerFrame);
+
   size_t GetCachedEntriesCount() const;
 
+  // The number of bytes held by the rasterized images of all entries.
+  size_t GetCachedBytes() const;
+
+  size_t max_bytes() const { return max_bytes_; }
+
+  size_t max_unused_frames() const { return max_unused_frames_; }
+
+  // Statistics accumulated since the last call to |ResetStats|. These are also
+  // reported to the timeline after every frame.
+  struct Stats {
+    size_t hit_count = 0;
+    size_t miss_count = 0;
+    size_t evicted_count = 0;
+    size_t evicted_bytes = 0;
+    // Pictures sent to the workers, and those of them that were swapped in.
+    size_t async_started_count = 0;
+    size_t async_finished_count = 0;
+  };
+
+  const Stats& stats() const { return stats_; }
+
+  void ResetStats();
+
  private:
+  // The image of an entry that is being rasterized on a worker. It is handed
+  // back to the entry once |ready| is set.
+  struct PendingImage {
+    std::atomic_bool ready = {false};
+    RasterCacheResult image;
+    fml::TimeDelta raster_time;
+  };
+
   struct Entry {
     bool used_this_frame = false;
     size_t access_count = 0;
+    size_t unused_frame_count = 0;
+    // Inputs to the estimated cost of re-rasterizing the entry once evicted.
+    // The op count is only known for pictures.
+    int op_count = 0;
+    fml::TimeDelta raster_time;
     RasterCacheResult image;
+    // Set while the image is being rasterized on a worker.
+    std::shared_ptr<PendingImage> pending_image;
+    // Whether the picture may only be rasterized on this thread. Only known
+    // once the entry is due to be rasterized.
+    std::optional<bool> draws_texture_images;
   };
 
-  template <class Cache, class Iterator>
-  static void SweepOneCacheAfterFrame(Cache& cache) {
-    std::vector<Iterator> dead;
-
-    for (auto it = cache.begin(); it != cache.end(); ++it) {
+  // Sends |picture| to the workers to be rasterized into |entry|.
+  void PrepareAsync(Entry& entry,
+                    SkPicture* picture,
+                    const SkMatrix& transformation_matrix,
+                    SkColorSpace* dst_color_space);
+
+  // Moves the image of |entry| out of its pending image if it is ready.
+  // Returns false if it is still being rasterized.
+  bool TakePendingImage(GrContext* context, Entry& entry);
+
+  static size_t EntryBytes(const Entry& entry);
+
+  // Estimated re-raster cost per byte of |entry|, discounted by the number of
+  // frames the entry has gone unused. Entries with the lowest value are
+  // evicted first when the cache is over budget.
+  static double EntryRetentionScore(const Entry& entry);
+
+  // Ages every entry in |cache| and evicts those that were unused for more
+  // than |max_unused_frames_| frames. Returns the bytes held by the remaining
+  // entries.
+  template <class Cache>
+  size_t SweepOneCacheAfterFrame(Cache& cache) {
+    size_t retained_bytes = 0;
+    for (auto it = cache.begin(); it != cache.end();) {
       Entry& entry = it->second;
-      if (!entry.used_this_frame) {
-        dead.push_back(it);
-      }
+      entry.unused_frame_count =
+          entry.used_this_frame ? 0 : entry.unused_frame_count + 1;
       entry.used_this_frame = false;
+      const size_t bytes = EntryBytes(entry);
+      if (entry.unused_frame_count > max_unused_frames_) {
+        RecordEviction(bytes);
+        it = cache.erase(it);
+      } else {
+        retained_bytes += bytes;
+        ++it;
+      }
     }
-
-    for (auto it : dead) {
-      cache.erase(it);
-    }
+    return retained_bytes;
   }
 
+  // Evicts entries that were not used in the last frame, lowest retention
+  // score first, until the cache holds no more than |max_bytes_|.
+  void EvictToBudget(size_t cached_bytes);
+
+  void RecordEviction(size_t bytes);
+
   const size_t access_threshold_;
   const size_t picture_cache_limit_per_frame_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner_;
+  size_t async_picture_cache_limit_per_frame_ = 0;
+  size_t picture_started_this_frame_ = 0;
+  const size_t max_bytes_;
+  const size_t max_unused_frames_;
   size_t picture_cached_this_frame_ = 0;
+  size_t cached_bytes_ = 0;
+  mutable Stats stats_;
   PictureRasterCacheKey::Map<Entry> picture_cache_;
   LayerRasterCacheKey::Map<Entry> layer_cache_;
   bool checkerboard_images_;
@@ -0,0 +1,148 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/flow/raster_cache.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/time/time_point.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkMaskFilter.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+
+static constexpr int kCardWidth = 300;
+static constexpr int kCardHeight = 200;
+static constexpr int kCardColumns = 6;
+static constexpr int kCardRows = 5;
+
+// The number of frames a page of cards stays on screen before the next one
+// replaces it, and all of its pictures have to be cached again.
+static constexpr int kFramesPerPage = 30;
+
+// A card with a blurred shadow and a grid of antialiased shapes, which is
+// expensive enough to be worth caching.
+static sk_sp<SkPicture> MakeCard(int seed) {
+  SkPictureRecorder recorder;
+  SkCanvas* canvas =
+      recorder.beginRecording(SkRect::MakeWH(kCardWidth, kCardHeight));
+  const SkRRect card = SkRRect::MakeRectXY(
+      SkRect::MakeXYWH(8, 8, kCardWidth - 16, kCardHeight - 16), 12, 12);
+  SkPaint shadow;
+  shadow.setColor(0x40000000);
+  shadow.setMaskFilter(SkMaskFilter::MakeBlur(kNormal_SkBlurStyle, 6));
+  canvas->drawRRect(card.makeOffset(0, 4), shadow);
+  SkPaint background;
+  background.setAntiAlias(true);
+  background.setColor(0xFFFAFAFA);
+  canvas->drawRRect(card, background);
+
+  SkPaint shape;
+  shape.setAntiAlias(true);
+  for (int y = 24; y < kCardHeight - 24; y += 12) {
+    for (int x = 24; x < kCardWidth - 24; x += 12) {
+      shape.setColor(SkColorSetARGB(0xFF, (x + seed) % 256, (y * seed) % 256,
+                                    (x * y) % 256));
+      canvas->drawCircle(x, y, 5, shape);
+    }
+  }
+  return recorder.finishRecordingAsPicture();
+}
+
+// Draws frames of a screen of cards that changes to a new page of cards
+// every |kFramesPerPage| frames. Each benchmark iteration is one frame, and
+// the worst frame is reported next to the average.
+static void BM_RasterCacheFrames(benchmark::State& state, bool async) {
+  const size_t picture_cache_limit_per_frame = state.range(0);
+  const size_t worker_count = state.range(1);
+
+  const SkISize frame_size =
+      SkISize::Make(kCardWidth * kCardColumns, kCardHeight * kCardRows);
+  const auto surface = SkSurface::MakeRaster(
+      SkImageInfo::MakeN32Premul(frame_size.width(), frame_size.height()));
+  SkCanvas* canvas = surface->getCanvas();
+  const sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+
+  std::shared_ptr<fml::ConcurrentMessageLoop> loop;
+  RasterCache cache(3, async ? RasterCache::kDefaultPictureCacheLimitPerFrame
+                             : picture_cache_limit_per_frame);
+  if (async) {
+    loop = fml::ConcurrentMessageLoop::Create(worker_count);
+    cache.SetWorkerTaskRunner(loop->GetTaskRunner(),
+                              picture_cache_limit_per_frame);
+  }
+
+  std::vector<sk_sp<SkPicture>> cards;
+  std::vector<SkMatrix> matrices;
+  int page = 0;
+  int frame = 0;
+  fml::TimeDelta worst_frame_time;
+  size_t frames_over_budget = 0;
+
+  while (state.KeepRunning()) {
+    if (frame % kFramesPerPage == 0) {
+      benchmarking::ScopedPauseTiming pause(state);
+      cards.clear();
+      matrices.clear();
+      for (int row = 0; row < kCardRows; ++row) {
+        for (int column = 0; column < kCardColumns; ++column) {
+          cards.push_back(MakeCard(page * 31 + cards.size()));
+          matrices.push_back(SkMatrix::MakeTrans(column * kCardWidth,
+                                                 row * kCardHeight));
+        }
+      }
+      page++;
+    }
+
+    const fml::TimePoint frame_start = fml::TimePoint::Now();
+    for (size_t i = 0; i < cards.size(); ++i) {
+      cache.Prepare(nullptr, cards[i].get(), matrices[i], srgb.get(), true,
+                    false);
+    }
+    for (size_t i = 0; i < cards.size(); ++i) {
+      SkAutoCanvasRestore restore(canvas, true);
+      canvas->setMatrix(matrices[i]);
+      RasterCacheResult result = cache.Get(*cards[i], matrices[i]);
+      if (result.is_valid()) {
+        result.draw(*canvas);
+      } else {
+        canvas->drawPicture(cards[i]);
+      }
+    }
+    cache.SweepAfterFrame();
+    canvas->flush();
+    const fml::TimeDelta frame_time = fml::TimePoint::Now() - frame_start;
+
+    worst_frame_time = std::max(worst_frame_time, frame_time);
+    if (frame_time > fml::TimeDelta::FromMilliseconds(16)) {
+      frames_over_budget++;
+    }
+    frame++;
+  }
+
+  state.counters["worst_frame_ms"] = worst_frame_time.ToMillisecondsF();
+  state.counters["frames_over_16ms"] = frames_over_budget;
+}
+
+BENCHMARK_CAPTURE(BM_RasterCacheFrames, sync, false)
+    ->ArgNames({"limit", "workers"})
+    ->Args({RasterCache::kDefaultPictureCacheLimitPerFrame, 0})
+    ->Args({RasterCache::kDefaultAsyncPictureCacheLimitPerFrame, 0})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_RasterCacheFrames, async, true)
+    ->ArgNames({"limit", "workers"})
+    ->Args({RasterCache::kDefaultAsyncPictureCacheLimitPerFrame, 1})
+    ->Args({RasterCache::kDefaultAsyncPictureCacheLimitPerFrame, 3})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace flutter
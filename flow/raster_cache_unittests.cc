@@ -4,9 +4,15 @@
 
 #include "flutter/flow/raster_cache.h"
 
+#include <chrono>
+#include <thread>
+
+#include "flutter/flow/texture_image_finder.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "gtest/gtest.h"
 #include "third_party/skia/include/core/SkPicture.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkSurface.h"
 
 namespace flutter {
 namespace testing {
@@ -22,6 +28,32 @@ sk_sp<SkPicture> GetSamplePicture() {
   return recorder.finishRecordingAsPicture();
 }
 
+sk_sp<SkPicture> GetSamplePicture(SkScalar width, SkScalar height) {
+  SkPictureRecorder recorder;
+  recorder.beginRecording(SkRect::MakeWH(width, height));
+  SkPaint paint;
+  paint.setColor(SK_ColorRED);
+  recorder.getRecordingCanvas()->drawRect(SkRect::MakeWH(width, height),
+                                          paint);
+  return recorder.finishRecordingAsPicture();
+}
+
+// Prepares |picture| once per frame until its cached image is ready. Returns
+// the number of frames that drew the picture directly in the meantime.
+size_t PrepareUntilCached(RasterCache& cache,
+                          SkPicture* picture,
+                          SkColorSpace* color_space) {
+  size_t frames = 0;
+  while (!cache.Prepare(NULL, picture, SkMatrix::I(), color_space, true,
+                        false)) {
+    EXPECT_FALSE(cache.Get(*picture, SkMatrix::I()).is_valid());
+    cache.SweepAfterFrame();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    frames++;
+  }
+  return frames;
+}
+
 }  // namespace
 
 TEST(RasterCache, SimpleInitialization) {
@@ -101,5 +133,204 @@ TEST(RasterCache, SweepsRemoveUnusedFrames) {
                              false));  // 5
 }
 
+TEST(RasterCache, UnusedEntriesSurviveAllowedFrames) {
+  size_t threshold = 1;
+  size_t max_unused_frames = 2;
+  flutter::RasterCache cache(threshold,
+                             RasterCache::kDefaultPictureCacheLimitPerFrame,
+                             RasterCache::kDefaultMaxBytes, max_unused_frames);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_TRUE(cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true,
+                            false));
+  cache.SweepAfterFrame();
+  cache.SweepAfterFrame();  // Unused frame 1.
+  cache.SweepAfterFrame();  // Unused frame 2.
+  ASSERT_EQ(cache.GetCachedEntriesCount(), 1u);
+  ASSERT_TRUE(cache.Get(*picture, matrix).is_valid());
+  cache.SweepAfterFrame();  // Unused frame 3.
+  ASSERT_EQ(cache.GetCachedEntriesCount(), 0u);
+  ASSERT_EQ(cache.stats().evicted_count, 1u);
+}
+
+TEST(RasterCache, ByteBudgetEvictsUnusedEntries) {
+  size_t threshold = 1;
+  // Room for exactly one 100x100 N32 image.
+  size_t max_bytes = 100 * 100 * 4;
+  size_t max_unused_frames = 10;
+  flutter::RasterCache cache(threshold,
+                             RasterCache::kDefaultPictureCacheLimitPerFrame,
+                             max_bytes, max_unused_frames);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto first = GetSamplePicture(100, 100);
+  auto second = GetSamplePicture(100, 100);
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_TRUE(
+      cache.Prepare(NULL, first.get(), matrix, srgb.get(), true, false));
+  cache.SweepAfterFrame();
+  ASSERT_EQ(cache.GetCachedBytes(), max_bytes);
+
+  // The second picture pushes the cache over budget. The first one was not
+  // used in this frame so it is evicted even though it has not exceeded the
+  // unused frame allowance.
+  ASSERT_TRUE(
+      cache.Prepare(NULL, second.get(), matrix, srgb.get(), true, false));
+  cache.SweepAfterFrame();
+  ASSERT_EQ(cache.GetCachedEntriesCount(), 1u);
+  ASSERT_EQ(cache.GetCachedBytes(), max_bytes);
+  ASSERT_FALSE(cache.Get(*first, matrix).is_valid());
+  ASSERT_TRUE(cache.Get(*second, matrix).is_valid());
+  ASSERT_EQ(cache.stats().evicted_bytes, max_bytes);
+}
+
+TEST(RasterCache, ByteBudgetKeepsEntriesUsedThisFrame) {
+  size_t threshold = 1;
+  size_t max_bytes = 100 * 100 * 4;
+  flutter::RasterCache cache(threshold,
+                             RasterCache::kDefaultPictureCacheLimitPerFrame,
+                             max_bytes);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto first = GetSamplePicture(100, 100);
+  auto second = GetSamplePicture(100, 100);
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_TRUE(
+      cache.Prepare(NULL, first.get(), matrix, srgb.get(), true, false));
+  ASSERT_TRUE(
+      cache.Prepare(NULL, second.get(), matrix, srgb.get(), true, false));
+  cache.SweepAfterFrame();
+  ASSERT_EQ(cache.GetCachedEntriesCount(), 2u);
+  ASSERT_EQ(cache.stats().evicted_count, 0u);
+}
+
+TEST(RasterCache, PictureLargerThanBudgetIsNotCached) {
+  size_t threshold = 1;
+  size_t max_bytes = 100 * 100 * 4;
+  flutter::RasterCache cache(threshold,
+                             RasterCache::kDefaultPictureCacheLimitPerFrame,
+                             max_bytes);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture(200, 200);
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(
+      cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true, false));
+}
+
+TEST(RasterCache, HitsAndMissesAreCounted) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  cache.Get(*picture, matrix);
+  ASSERT_TRUE(cache.Prepare(NULL, picture.get(), matrix, srgb.get(), true,
+                            false));
+  cache.Get(*picture, matrix);
+  cache.Get(*picture, matrix);
+  ASSERT_EQ(cache.stats().miss_count, 1u);
+  ASSERT_EQ(cache.stats().hit_count, 2u);
+  cache.ResetStats();
+  ASSERT_EQ(cache.stats().hit_count, 0u);
+}
+
+TEST(RasterCache, AsyncPictureIsSwappedInOnceReady) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  flutter::RasterCache cache(1);
+  cache.SetWorkerTaskRunner(loop->GetTaskRunner());
+
+  auto picture = GetSamplePicture();
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  // The first frame only starts rasterizing the picture.
+  ASSERT_GE(PrepareUntilCached(cache, picture.get(), srgb.get()), 1u);
+  ASSERT_TRUE(cache.Get(*picture, SkMatrix::I()).is_valid());
+  ASSERT_EQ(cache.stats().async_started_count, 1u);
+  ASSERT_EQ(cache.stats().async_finished_count, 1u);
+
+  // The cached image stays in place on later frames.
+  cache.SweepAfterFrame();
+  ASSERT_TRUE(cache.Prepare(NULL, picture.get(), SkMatrix::I(), srgb.get(),
+                            true, false));
+  ASSERT_EQ(cache.stats().async_started_count, 1u);
+}
+
+TEST(RasterCache, AsyncPictureCacheLimitPerFrameIsRespected) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  flutter::RasterCache cache(1);
+  cache.SetWorkerTaskRunner(loop->GetTaskRunner(), 2);
+
+  sk_sp<SkPicture> pictures[] = {GetSamplePicture(), GetSamplePicture(),
+                                 GetSamplePicture()};
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  for (const auto& picture : pictures) {
+    ASSERT_FALSE(cache.Prepare(NULL, picture.get(), SkMatrix::I(), srgb.get(),
+                               true, false));
+  }
+  ASSERT_EQ(cache.stats().async_started_count, 2u);
+
+  // The picture left out is started on the next frame.
+  bool all_cached = false;
+  while (!all_cached) {
+    cache.SweepAfterFrame();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    all_cached = true;
+    for (const auto& picture : pictures) {
+      all_cached &= cache.Prepare(NULL, picture.get(), SkMatrix::I(),
+                                  srgb.get(), true, false);
+    }
+  }
+  ASSERT_EQ(cache.stats().async_started_count, 3u);
+  ASSERT_EQ(cache.stats().async_finished_count, 3u);
+}
+
+TEST(RasterCache, AsyncPictureIsDroppedWhenTheCacheIsCleared) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  flutter::RasterCache cache(1);
+  cache.SetWorkerTaskRunner(loop->GetTaskRunner());
+
+  auto picture = GetSamplePicture();
+
+  sk_sp<SkColorSpace> srgb = SkColorSpace::MakeSRGB();
+  ASSERT_FALSE(cache.Prepare(NULL, picture.get(), SkMatrix::I(), srgb.get(),
+                             true, false));
+  cache.Clear();
+  ASSERT_EQ(cache.GetCachedEntriesCount(), 0u);
+
+  // The picture is started again rather than picking up the dropped image.
+  PrepareUntilCached(cache, picture.get(), srgb.get());
+  ASSERT_EQ(cache.stats().async_started_count, 2u);
+}
+
+TEST(RasterCache, RasterImagesAreNotTextureImages) {
+  auto surface = SkSurface::MakeRasterN32Premul(10, 10);
+  sk_sp<SkImage> image = surface->makeImageSnapshot();
+
+  SkPictureRecorder recorder;
+  SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(100, 100));
+  canvas->drawImage(image, 0, 0);
+  SkPaint paint;
+  paint.setShader(image->makeShader());
+  canvas->drawRect(SkRect::MakeWH(100, 100), paint);
+
+  ASSERT_FALSE(DrawsTextureImages(*recorder.finishRecordingAsPicture()));
+  ASSERT_FALSE(DrawsTextureImages(*GetSamplePicture()));
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -71,6 +71,8 @@ class SkiaGPUObject {
 
   sk_sp<SkiaObjectType> get() const { return object_; }
 
+  fml::RefPtr<SkiaUnrefQueue> unref_queue() const { return queue_; }
+
   void reset() {
     if (object_ && queue_) {
       queue_->Unref(object_.release());
@@ -0,0 +1,200 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/texture_image_finder.h"
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkShader.h"
+#include "third_party/skia/include/core/SkVertices.h"
+#include "third_party/skia/include/utils/SkNoDrawCanvas.h"
+
+namespace flutter {
+namespace {
+
+// Looks at every image and shader a picture draws, without drawing anything.
+class TextureImageFinderCanvas final : public SkNoDrawCanvas,
+                                       public SkPicture::AbortCallback {
+ public:
+  explicit TextureImageFinderCanvas(const SkIRect& bounds)
+      : SkNoDrawCanvas(bounds) {}
+
+  bool found() const { return found_; }
+
+  // |SkPicture::AbortCallback|
+  bool abort() override { return found_; }
+
+ private:
+  bool found_ = false;
+
+  void CheckImage(const SkImage* image) {
+    found_ |= image != nullptr && image->isTextureBacked();
+  }
+
+  void CheckPaint(const SkPaint* paint) {
+    if (paint == nullptr || paint->getShader() == nullptr) {
+      return;
+    }
+    CheckImage(paint->getShader()->isAImage(nullptr, nullptr));
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawPaint(const SkPaint& paint) override { CheckPaint(&paint); }
+
+  // |SkNoDrawCanvas|
+  void onDrawBehind(const SkPaint& paint) override { CheckPaint(&paint); }
+
+  // |SkNoDrawCanvas|
+  void onDrawPoints(PointMode,
+                    size_t,
+                    const SkPoint[],
+                    const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawRect(const SkRect&, const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawRegion(const SkRegion&, const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawOval(const SkRect&, const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawArc(const SkRect&,
+                 SkScalar,
+                 SkScalar,
+                 bool,
+                 const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawRRect(const SkRRect&, const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawDRRect(const SkRRect&,
+                    const SkRRect&,
+                    const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawPath(const SkPath&, const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawTextBlob(const SkTextBlob*,
+                      SkScalar,
+                      SkScalar,
+                      const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawPatch(const SkPoint[12],
+                   const SkColor[4],
+                   const SkPoint[4],
+                   SkBlendMode,
+                   const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawVerticesObject(const SkVertices*,
+                            const SkVertices::Bone[],
+                            int,
+                            SkBlendMode,
+                            const SkPaint& paint) override {
+    CheckPaint(&paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawImage(const SkImage* image,
+                   SkScalar,
+                   SkScalar,
+                   const SkPaint* paint) override {
+    CheckImage(image);
+    CheckPaint(paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawImageRect(const SkImage* image,
+                       const SkRect*,
+                       const SkRect&,
+                       const SkPaint* paint,
+                       SrcRectConstraint) override {
+    CheckImage(image);
+    CheckPaint(paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawImageNine(const SkImage* image,
+                       const SkIRect&,
+                       const SkRect&,
+                       const SkPaint* paint) override {
+    CheckImage(image);
+    CheckPaint(paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawImageLattice(const SkImage* image,
+                          const Lattice&,
+                          const SkRect&,
+                          const SkPaint* paint) override {
+    CheckImage(image);
+    CheckPaint(paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawAtlas(const SkImage* image,
+                   const SkRSXform[],
+                   const SkRect[],
+                   const SkColor[],
+                   int,
+                   SkBlendMode,
+                   const SkRect*,
+                   const SkPaint* paint) override {
+    CheckImage(image);
+    CheckPaint(paint);
+  }
+
+  // |SkNoDrawCanvas|
+  void onDrawEdgeAAImageSet(const ImageSetEntry entries[],
+                            int count,
+                            const SkPoint[],
+                            const SkMatrix[],
+                            const SkPaint* paint,
+                            SrcRectConstraint) override {
+    for (int i = 0; i < count; ++i) {
+      CheckImage(entries[i].fImage.get());
+    }
+    CheckPaint(paint);
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(TextureImageFinderCanvas);
+};
+
+}  // namespace
+
+bool DrawsTextureImages(const SkPicture& picture) {
+  TRACE_EVENT0("flutter", "DrawsTextureImages");
+  TextureImageFinderCanvas canvas(picture.cullRect().roundOut());
+  // Stops at the first texture backed image.
+  picture.playback(&canvas, &canvas);
+  return canvas.found();
+}
+
+}  // namespace flutter
@@ -0,0 +1,29 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_TEXTURE_IMAGE_FINDER_H_
+#define FLUTTER_FLOW_TEXTURE_IMAGE_FINDER_H_
+
+#include "third_party/skia/include/core/SkPicture.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      Whether |picture| draws any texture backed image, either
+///             directly or through an image shader.
+///
+///             Texture backed images may only be read on the thread of their
+///             context, so pictures that draw them must not be rasterized on
+///             any other thread, not even into a raster surface.
+///
+/// @param[in]  picture  The picture to look into. Nested pictures and
+///                      drawables are looked into as well.
+///
+/// @return     Whether the picture draws a texture backed image.
+///
+bool DrawsTextureImages(const SkPicture& picture);
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_TEXTURE_IMAGE_FINDER_H_
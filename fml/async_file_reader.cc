@@ -0,0 +1,94 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/async_file_reader.h"
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include "flutter/fml/build_config.h"
+#include "flutter/fml/make_copyable.h"
+#include "flutter/fml/trace_event.h"
+
+#if OS_LINUX
+#include "flutter/fml/platform/linux/io_uring_file_reader.h"
+#endif  // OS_LINUX
+
+namespace fml {
+
+namespace {
+
+// Reads each file on one of the workers.
+class ConcurrentFileReader final : public AsyncFileReader {
+ public:
+  explicit ConcurrentFileReader(std::shared_ptr<ConcurrentTaskRunner> workers)
+      : workers_(std::move(workers)) {}
+
+  ~ConcurrentFileReader() override { *destroyed_ = true; }
+
+  // |AsyncFileReader|
+  void Read(fml::UniqueFD file,
+            fml::RefPtr<fml::TaskRunner> reply_runner,
+            ReadCallback callback) override {
+    workers_->PostTask(fml::MakeCopyable(
+        [destroyed = destroyed_, file = std::move(file),
+         reply_runner = std::move(reply_runner),
+         callback = std::move(callback)]() mutable {
+          if (*destroyed) {
+            return;
+          }
+          TRACE_EVENT0("flutter", "ConcurrentFileReader::Read");
+          std::unique_ptr<Mapping> contents;
+          // Copying the mapping reads the file here rather than wherever its
+          // pages are first touched.
+          FileMapping mapping(file);
+          if (mapping.IsValid()) {
+            std::vector<uint8_t> data(mapping.GetSize());
+            if (!data.empty()) {
+              std::memcpy(data.data(), mapping.GetMapping(), data.size());
+            }
+            contents = std::make_unique<DataMapping>(std::move(data));
+          }
+          reply_runner->PostTask(fml::MakeCopyable(
+              [destroyed = std::move(destroyed),
+               callback = std::move(callback),
+               contents = std::move(contents)]() mutable {
+                if (!*destroyed) {
+                  callback(std::move(contents));
+                }
+              }));
+        }));
+  }
+
+ private:
+  const std::shared_ptr<ConcurrentTaskRunner> workers_;
+  // Shared with the reads and replies that have been posted already.
+  const std::shared_ptr<std::atomic_bool> destroyed_ =
+      std::make_shared<std::atomic_bool>(false);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ConcurrentFileReader);
+};
+
+}  // namespace
+
+std::unique_ptr<AsyncFileReader> AsyncFileReader::Create(
+    fml::RefPtr<fml::TaskRunner> task_runner,
+    std::shared_ptr<ConcurrentTaskRunner> workers) {
+#if OS_LINUX
+  if (task_runner) {
+    auto reader = IOUringFileReader::Create(task_runner);
+    if (reader) {
+      return reader;
+    }
+  }
+#endif  // OS_LINUX
+  return std::make_unique<ConcurrentFileReader>(std::move(workers));
+}
+
+AsyncFileReader::AsyncFileReader() = default;
+
+AsyncFileReader::~AsyncFileReader() = default;
+
+}  // namespace fml
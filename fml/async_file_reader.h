@@ -0,0 +1,72 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_ASYNC_FILE_READER_H_
+#define FLUTTER_FML_ASYNC_FILE_READER_H_
+
+#include <functional>
+#include <memory>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/memory/ref_ptr.h"
+#include "flutter/fml/task_runner.h"
+#include "flutter/fml/unique_fd.h"
+
+namespace fml {
+
+//------------------------------------------------------------------------------
+/// @brief      Reads whole files into memory without blocking the thread that
+///             asks for them, or a worker thread for each file being read.
+///
+///             On Linux kernels that allow it, the reads are handed to the
+///             kernel through io_uring and their completions are picked up by
+///             the message loop of a task runner, which only has to watch one
+///             file descriptor for all of them. Elsewhere, each file is read on
+///             a pool of workers.
+///
+class AsyncFileReader {
+ public:
+  using ReadCallback = std::function<void(std::unique_ptr<Mapping>)>;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Creates a reader.
+  ///
+  /// @param[in]  task_runner  The task runner whose message loop picks up the
+  ///                          completed reads, when the kernel reads the files.
+  ///                          Reading the files costs it almost nothing. May
+  ///                          be null, in which case |workers| read them.
+  /// @param[in]  workers      The workers that read the files otherwise.
+  ///
+  static std::unique_ptr<AsyncFileReader> Create(
+      fml::RefPtr<fml::TaskRunner> task_runner,
+      std::shared_ptr<ConcurrentTaskRunner> workers);
+
+  virtual ~AsyncFileReader();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Reads all of a file.
+  ///
+  /// @param[in]  file          The file to read, from its start.
+  /// @param[in]  reply_runner  The task runner to call |callback| on.
+  /// @param[in]  callback      Called with the contents of the file, or
+  ///                           nullptr if it could not be read. It is not
+  ///                           called for reads still in progress when the
+  ///                           reader is destroyed.
+  ///
+  virtual void Read(fml::UniqueFD file,
+                    fml::RefPtr<fml::TaskRunner> reply_runner,
+                    ReadCallback callback) = 0;
+
+ protected:
+  AsyncFileReader();
+
+ private:
+  FML_DISALLOW_COPY_AND_ASSIGN(AsyncFileReader);
+};
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_ASYNC_FILE_READER_H_
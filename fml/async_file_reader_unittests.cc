@@ -0,0 +1,166 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/async_file_reader.h"
+
+#include <string>
+#include <vector>
+
+#include "flutter/fml/file.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/fml/thread.h"
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+static std::string GetContents(const Mapping& mapping) {
+  return std::string(reinterpret_cast<const char*>(mapping.GetMapping()),
+                     mapping.GetSize());
+}
+
+// Reads |count| files of different sizes, more than the kernel is given at
+// once, and an empty one.
+static void ReadFiles(fml::RefPtr<fml::TaskRunner> task_runner, size_t count) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  std::vector<std::string> expected_contents;
+  for (size_t i = 0; i < count; ++i) {
+    const std::string name = "file" + std::to_string(i);
+    expected_contents.push_back(std::string(i * 1000 + 1, 'a' + i % 26));
+    ASSERT_TRUE(fml::WriteAtomically(temp_dir.fd(), name.c_str(),
+                                     DataMapping(expected_contents.back())));
+  }
+  ASSERT_TRUE(fml::OpenFile(temp_dir.fd(), "empty", true,
+                            fml::FilePermission::kReadWrite)
+                  .is_valid());
+
+  auto workers = fml::ConcurrentMessageLoop::Create(2);
+  fml::Thread reply_thread("reply");
+  auto reader =
+      AsyncFileReader::Create(task_runner, workers->GetTaskRunner());
+  ASSERT_NE(reader, nullptr);
+
+  fml::CountDownLatch latch(count + 1);
+  std::vector<std::string> contents(count);
+  for (size_t i = 0; i < count; ++i) {
+    const std::string name = "file" + std::to_string(i);
+    reader->Read(fml::OpenFile(temp_dir.fd(), name.c_str(), false,
+                               fml::FilePermission::kRead),
+                 reply_thread.GetTaskRunner(),
+                 [&contents, &latch, &reply_thread,
+                  i](std::unique_ptr<Mapping> mapping) {
+                   ASSERT_TRUE(reply_thread.GetTaskRunner()
+                                   ->RunsTasksOnCurrentThread());
+                   ASSERT_NE(mapping, nullptr);
+                   contents[i] = GetContents(*mapping);
+                   latch.CountDown();
+                 });
+  }
+  reader->Read(fml::OpenFile(temp_dir.fd(), "empty", false,
+                             fml::FilePermission::kRead),
+               reply_thread.GetTaskRunner(),
+               [&latch](std::unique_ptr<Mapping> mapping) {
+                 ASSERT_NE(mapping, nullptr);
+                 ASSERT_EQ(mapping->GetSize(), 0u);
+                 latch.CountDown();
+               });
+  latch.Wait();
+  ASSERT_EQ(contents, expected_contents);
+
+  for (size_t i = 0; i < count; ++i) {
+    const std::string name = "file" + std::to_string(i);
+    ASSERT_TRUE(fml::UnlinkFile(temp_dir.fd(), name.c_str()));
+  }
+  ASSERT_TRUE(fml::UnlinkFile(temp_dir.fd(), "empty"));
+}
+
+TEST(AsyncFileReaderTest, ReadsFilesOnWorkers) {
+  ReadFiles(nullptr, 10);
+}
+
+TEST(AsyncFileReaderTest, ReadsFilesOnMessageLoop) {
+  fml::Thread thread("reader");
+  ReadFiles(thread.GetTaskRunner(), 100);
+}
+
+TEST(AsyncFileReaderTest, RepliesWithNullptrForUnreadableFiles) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  fml::Thread thread("reader");
+  fml::Thread reply_thread("reply");
+  auto workers = fml::ConcurrentMessageLoop::Create(1);
+  for (auto task_runner :
+       {thread.GetTaskRunner(), fml::RefPtr<fml::TaskRunner>()}) {
+    auto reader =
+        AsyncFileReader::Create(task_runner, workers->GetTaskRunner());
+    fml::CountDownLatch latch(1);
+    // Directories can be opened but not read.
+    reader->Read(fml::OpenDirectory(temp_dir.path().c_str(), false,
+                                    fml::FilePermission::kRead),
+                 reply_thread.GetTaskRunner(),
+                 [&latch](std::unique_ptr<Mapping> mapping) {
+                   ASSERT_EQ(mapping, nullptr);
+                   latch.CountDown();
+                 });
+    latch.Wait();
+  }
+}
+
+TEST(AsyncFileReaderTest, DoesNotReplyAfterItIsDestroyed) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  ASSERT_TRUE(fml::WriteAtomically(temp_dir.fd(), "file",
+                                   DataMapping(std::string(1000, 'a'))));
+  ASSERT_TRUE(fml::OpenFile(temp_dir.fd(), "empty", true,
+                            fml::FilePermission::kReadWrite)
+                  .is_valid());
+  fml::Thread thread("reader");
+  fml::Thread reply_thread("reply");
+  auto workers = fml::ConcurrentMessageLoop::Create(1);
+  for (auto task_runner :
+       {thread.GetTaskRunner(), fml::RefPtr<fml::TaskRunner>()}) {
+    auto reader =
+        AsyncFileReader::Create(task_runner, workers->GetTaskRunner());
+
+    // Keep the thread that starts the reads busy until the reader is gone.
+    fml::RefPtr<fml::TaskRunner> read_runner = task_runner;
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_runner;
+    if (!read_runner) {
+      worker_runner = workers->GetTaskRunner();
+    }
+    auto post = [&](const fml::closure& task) {
+      if (read_runner) {
+        read_runner->PostTask(task);
+      } else {
+        worker_runner->PostTask(task);
+      }
+    };
+    fml::AutoResetWaitableEvent unblock;
+    post([&unblock]() { unblock.Wait(); });
+
+    bool replied = false;
+    for (const char* name : {"file", "empty", "missing"}) {
+      reader->Read(
+          fml::OpenFile(temp_dir.fd(), name, false, fml::FilePermission::kRead),
+          reply_thread.GetTaskRunner(),
+          [&replied](std::unique_ptr<Mapping> mapping) { replied = true; });
+    }
+    reader.reset();
+    unblock.Signal();
+
+    // Wait for the reads, then for any replies they posted.
+    fml::AutoResetWaitableEvent read_latch;
+    post([&read_latch]() { read_latch.Signal(); });
+    read_latch.Wait();
+    fml::AutoResetWaitableEvent reply_latch;
+    reply_thread.GetTaskRunner()->PostTask(
+        [&reply_latch]() { reply_latch.Signal(); });
+    reply_latch.Wait();
+    ASSERT_FALSE(replied);
+  }
+  ASSERT_TRUE(fml::UnlinkFile(temp_dir.fd(), "file"));
+  ASSERT_TRUE(fml::UnlinkFile(temp_dir.fd(), "empty"));
+}
+
+}  // namespace testing
+}  // namespace fml
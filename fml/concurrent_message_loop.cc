@@ -7,10 +7,22 @@
 #include <algorithm>
 
 #include "flutter/fml/thread.h"
+#include "flutter/fml/thread_local.h"
 #include "flutter/fml/trace_event.h"
 
 namespace fml {
 
+namespace {
+
+struct CurrentWorker {
+  const ConcurrentMessageLoop* loop;
+  size_t index;
+};
+
+}  // namespace
+
+FML_THREAD_LOCAL ThreadLocalUniquePtr<CurrentWorker> tls_concurrent_worker;
+
 std::shared_ptr<ConcurrentMessageLoop> ConcurrentMessageLoop::Create(
     size_t worker_count) {
   return std::shared_ptr<ConcurrentMessageLoop>{
@@ -19,11 +31,15 @@ std::shared_ptr<ConcurrentMessageLoop> ConcurrentMessageLoop::Create(
 
 ConcurrentMessageLoop::ConcurrentMessageLoop(size_t worker_count)
     : worker_count_(std::max<size_t>(worker_count, 1ul)) {
+  // All queues must exist before any worker starts stealing from them.
+  for (size_t i = 0; i < worker_count_; ++i) {
+    worker_queues_.emplace_back(std::make_unique<Worker>());
+  }
   for (size_t i = 0; i < worker_count_; ++i) {
     workers_.emplace_back([i, this]() {
       fml::Thread::SetCurrentThreadName(
           std::string{"io.flutter.worker." + std::to_string(i + 1)});
-      WorkerMain();
+      WorkerMain(i);
     });
   }
 }
@@ -33,6 +49,16 @@ ConcurrentMessageLoop::~ConcurrentMessageLoop() {
   for (auto& worker : workers_) {
     worker.join();
   }
+
+  // Tasks posted concurrently with termination may have been queued after
+  // the workers exited. Run them here rather than dropping them.
+  for (auto& worker : worker_queues_) {
+    for (auto& queue : worker->tasks) {
+      for (auto& task : queue) {
+        task();
+      }
+    }
+  }
 }
 
 size_t ConcurrentMessageLoop::GetWorkerCount() const {
@@ -43,62 +69,181 @@ std::shared_ptr<ConcurrentTaskRunner> ConcurrentMessageLoop::GetTaskRunner() {
   return std::make_shared<ConcurrentTaskRunner>(weak_from_this());
 }
 
-void ConcurrentMessageLoop::PostTask(const fml::closure& task) {
+bool ConcurrentMessageLoop::IsShutdown() const {
+  return shutdown_.load();
+}
+
+size_t ConcurrentMessageLoop::GetCurrentWorkerIndex() const {
+  const auto* current = tls_concurrent_worker.get();
+  if (current == nullptr || current->loop != this) {
+    return worker_count_;
+  }
+  return current->index;
+}
+
+size_t ConcurrentMessageLoop::PickWorkerForPost() {
+  const size_t current = GetCurrentWorkerIndex();
+  if (current < worker_count_) {
+    // Keep tasks posted by a worker local to it. Other workers will steal
+    // them if this one is busy.
+    return current;
+  }
+  return next_worker_.fetch_add(1, std::memory_order_relaxed) % worker_count_;
+}
+
+void ConcurrentMessageLoop::PostTask(const fml::closure& task,
+                                     ConcurrentTaskPriority priority) {
   if (!task) {
     return;
   }
 
-  std::unique_lock lock(tasks_mutex_);
-
   // Don't just drop tasks on the floor in case of shutdown.
-  if (shutdown_) {
+  if (IsShutdown()) {
     FML_DLOG(WARNING)
         << "Tried to post a task to shutdown concurrent message "
            "loop. The task will be executed on the callers thread.";
-    lock.unlock();
     task();
     return;
   }
 
-  tasks_.push(task);
+  Worker& worker = *worker_queues_[PickWorkerForPost()];
+  {
+    std::scoped_lock lock(worker.tasks_mutex);
+    worker.tasks[static_cast<size_t>(priority)].push_back(task);
+    // Counted under the queue lock so that a worker taking the task can never
+    // decrement the count before it was incremented.
+    pending_tasks_++;
+  }
+
+  WakeWorkers(1);
+}
 
-  // Unlock the mutex before notifying the condition variable because that mutex
-  // has to be acquired on the other thread anyway. Waiting in this scope till
-  // it is acquired there is a pessimization.
-  lock.unlock();
+void ConcurrentMessageLoop::PostTasks(std::vector<fml::closure> tasks,
+                                      ConcurrentTaskPriority priority) {
+  tasks.erase(std::remove_if(tasks.begin(), tasks.end(),
+                             [](const fml::closure& task) { return !task; }),
+              tasks.end());
+  if (tasks.empty()) {
+    return;
+  }
 
-  tasks_condition_.notify_one();
+  if (IsShutdown()) {
+    FML_DLOG(WARNING)
+        << "Tried to post tasks to shutdown concurrent message "
+           "loop. The tasks will be executed on the callers thread.";
+    for (const auto& task : tasks) {
+      task();
+    }
+    return;
+  }
+
+  // Spread the batch over the workers in contiguous chunks so that each queue
+  // lock is taken once.
+  const size_t task_count = tasks.size();
+  const size_t chunk_size = (task_count + worker_count_ - 1) / worker_count_;
+  size_t worker_index = PickWorkerForPost();
+  for (size_t begin = 0; begin < task_count; begin += chunk_size) {
+    const size_t end = std::min(begin + chunk_size, task_count);
+    Worker& worker = *worker_queues_[worker_index];
+    {
+      std::scoped_lock lock(worker.tasks_mutex);
+      auto& queue = worker.tasks[static_cast<size_t>(priority)];
+      for (size_t i = begin; i < end; ++i) {
+        queue.push_back(std::move(tasks[i]));
+      }
+      pending_tasks_ += end - begin;
+    }
+    worker_index = (worker_index + 1) % worker_count_;
+  }
+
+  WakeWorkers(task_count);
 }
 
-void ConcurrentMessageLoop::WorkerMain() {
-  while (true) {
-    std::unique_lock lock(tasks_mutex_);
-    tasks_condition_.wait(lock,
-                          [&]() { return tasks_.size() > 0 || shutdown_; });
+void ConcurrentMessageLoop::WakeWorkers(size_t task_count) {
+  // A worker increments |sleeping_workers_| before checking |pending_tasks_|
+  // under |sleep_mutex_|, so if no worker is counted as sleeping here, any
+  // worker about to sleep is guaranteed to see the new tasks.
+  const size_t sleeping = sleeping_workers_.load();
+  if (sleeping == 0) {
+    return;
+  }
 
-    if (tasks_.size() == 0) {
-      // This can only be caused by shutdown.
-      FML_DCHECK(shutdown_);
-      break;
+  // Take the lock so the notification cannot slip in between a worker
+  // checking for tasks and starting to wait.
+  std::scoped_lock lock(sleep_mutex_);
+  if (task_count >= sleeping) {
+    sleep_condition_.notify_all();
+  } else {
+    for (size_t i = 0; i < task_count; ++i) {
+      sleep_condition_.notify_one();
     }
+  }
+}
 
-    auto task = tasks_.front();
-    tasks_.pop();
+bool ConcurrentMessageLoop::TakeTask(size_t worker_index, fml::closure& task) {
+  if (pending_tasks_.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+  for (size_t priority = 0; priority < kPriorityCount; ++priority) {
+    for (size_t offset = 0; offset < worker_count_; ++offset) {
+      const bool is_own_queue = offset == 0;
+      Worker& worker = *worker_queues_[(worker_index + offset) % worker_count_];
+      std::scoped_lock lock(worker.tasks_mutex);
+      auto& queue = worker.tasks[priority];
+      if (queue.empty()) {
+        continue;
+      }
+      // The owner takes the oldest task. Thieves take the newest, which is
+      // the one least likely to be picked up by the owner soon.
+      if (is_own_queue) {
+        task = std::move(queue.front());
+        queue.pop_front();
+      } else {
+        task = std::move(queue.back());
+        queue.pop_back();
+      }
+      pending_tasks_--;
+      return true;
+    }
+  }
+  return false;
+}
 
-    // Don't hold onto the mutex while the task is being executed as it could
-    // itself try to post another tasks to this message loop.
-    lock.unlock();
+void ConcurrentMessageLoop::WorkerMain(size_t worker_index) {
+  tls_concurrent_worker.reset(new CurrentWorker{this, worker_index});
 
-    TRACE_EVENT0("flutter", "ConcurrentWorkerWake");
-    // Execute the one tasks we woke up for.
-    task();
+  fml::closure task;
+  while (true) {
+    if (TakeTask(worker_index, task)) {
+      TRACE_EVENT0("flutter", "ConcurrentWorkerWake");
+      // Execute the task without holding any lock as it could itself try to
+      // post another task to this message loop.
+      task();
+      task = nullptr;
+      continue;
+    }
+
+    std::unique_lock lock(sleep_mutex_);
+    if (pending_tasks_.load() > 0) {
+      // A task was posted while this worker was looking for one.
+      continue;
+    }
+    if (IsShutdown()) {
+      break;
+    }
+    sleeping_workers_++;
+    sleep_condition_.wait(
+        lock, [&]() { return pending_tasks_.load() > 0 || IsShutdown(); });
+    sleeping_workers_--;
   }
+
+  tls_concurrent_worker.reset(nullptr);
 }
 
 void ConcurrentMessageLoop::Terminate() {
-  std::scoped_lock lock(tasks_mutex_);
+  std::scoped_lock lock(sleep_mutex_);
   shutdown_ = true;
-  tasks_condition_.notify_all();
+  sleep_condition_.notify_all();
 }
 
 ConcurrentTaskRunner::ConcurrentTaskRunner(
@@ -107,13 +252,14 @@ ConcurrentTaskRunner::ConcurrentTaskRunner(
 
 ConcurrentTaskRunner::~ConcurrentTaskRunner() = default;
 
-void ConcurrentTaskRunner::PostTask(const fml::closure& task) {
+void ConcurrentTaskRunner::PostTask(const fml::closure& task,
+                                    ConcurrentTaskPriority priority) {
   if (!task) {
     return;
   }
 
   if (auto loop = weak_loop_.lock()) {
-    loop->PostTask(task);
+    loop->PostTask(task, priority);
     return;
   }
 
@@ -123,4 +269,21 @@ void ConcurrentTaskRunner::PostTask(const fml::closure& task) {
   task();
 }
 
+void ConcurrentTaskRunner::PostTasks(std::vector<fml::closure> tasks,
+                                     ConcurrentTaskPriority priority) {
+  if (auto loop = weak_loop_.lock()) {
+    loop->PostTasks(std::move(tasks), priority);
+    return;
+  }
+
+  FML_DLOG(WARNING)
+      << "Tried to post to a concurrent message loop that has already died. "
+         "Executing the tasks on the callers thread.";
+  for (const auto& task : tasks) {
+    if (task) {
+      task();
+    }
+  }
+}
+
 }  // namespace fml
@@ -5,9 +5,13 @@
 #ifndef FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 #define FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 
+#include <atomic>
 #include <condition_variable>
-#include <queue>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "flutter/fml/closure.h"
 #include "flutter/fml/macros.h"
@@ -16,6 +20,21 @@ namespace fml {
 
 class ConcurrentTaskRunner;
 
+// The order in which queued tasks are picked up by the workers. Workers always
+// run all available tasks of a higher priority before those of a lower one.
+enum class ConcurrentTaskPriority {
+  // Work that something is waiting on, like image decodes.
+  kHigh,
+  kNormal,
+  // Speculative work, like warming up shaders.
+  kBackground,
+};
+
+// A pool of worker threads. Each worker owns a queue of tasks per priority.
+// Tasks posted from a worker go to its own queues and tasks posted from other
+// threads are distributed across the workers. Workers that run out of tasks
+// steal from the other workers before going to sleep, so there is no single
+// lock that every post and every worker contends on.
 class ConcurrentMessageLoop
     : public std::enable_shared_from_this<ConcurrentMessageLoop> {
  public:
@@ -33,18 +52,48 @@ class ConcurrentMessageLoop
  private:
   friend ConcurrentTaskRunner;
 
+  static constexpr size_t kPriorityCount = 3;
+
+  struct Worker {
+    std::mutex tasks_mutex;
+    std::deque<fml::closure> tasks[kPriorityCount];
+  };
+
   size_t worker_count_ = 0;
+  std::vector<std::unique_ptr<Worker>> worker_queues_;
   std::vector<std::thread> workers_;
-  std::mutex tasks_mutex_;
-  std::condition_variable tasks_condition_;
-  std::queue<fml::closure> tasks_;
-  bool shutdown_ = false;
+  // Round robin cursor used to pick the worker for tasks posted from threads
+  // that are not part of this loop.
+  std::atomic_size_t next_worker_ = {0};
+  // The number of tasks in all worker queues.
+  std::atomic_size_t pending_tasks_ = {0};
+  std::atomic_size_t sleeping_workers_ = {0};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_condition_;
+  std::atomic_bool shutdown_ = {false};
 
   ConcurrentMessageLoop(size_t worker_count);
 
-  void WorkerMain();
+  void WorkerMain(size_t worker_index);
+
+  bool IsShutdown() const;
+
+  // Returns the index of the worker running on the current thread if it
+  // belongs to this loop, or |worker_count_| otherwise.
+  size_t GetCurrentWorkerIndex() const;
 
-  void PostTask(const fml::closure& task);
+  size_t PickWorkerForPost();
+
+  // Pops the highest priority task from the front of the worker's own queues,
+  // or steals one from the back of another worker's queues.
+  bool TakeTask(size_t worker_index, fml::closure& task);
+
+  void WakeWorkers(size_t task_count);
+
+  void PostTask(const fml::closure& task, ConcurrentTaskPriority priority);
+
+  void PostTasks(std::vector<fml::closure> tasks,
+                 ConcurrentTaskPriority priority);
 
   FML_DISALLOW_COPY_AND_ASSIGN(ConcurrentMessageLoop);
 };
@@ -55,7 +104,15 @@ class ConcurrentTaskRunner {
 
   ~ConcurrentTaskRunner();
 
-  void PostTask(const fml::closure& task);
+  void PostTask(
+      const fml::closure& task,
+      ConcurrentTaskPriority priority = ConcurrentTaskPriority::kNormal);
+
+  // Posts all |tasks| at once. This is cheaper than posting them one at a
+  // time since they are distributed across the workers in one go.
+  void PostTasks(
+      std::vector<fml::closure> tasks,
+      ConcurrentTaskPriority priority = ConcurrentTaskPriority::kNormal);
 
  private:
   friend ConcurrentMessageLoop;
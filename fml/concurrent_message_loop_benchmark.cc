@@ -0,0 +1,117 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/time/time_point.h"
+
+namespace fml {
+namespace benchmarking {
+
+static constexpr size_t kTasksPerIteration = 10000;
+
+// Reports the 50th and 99th percentile of the delay between posting a task
+// and a worker starting to run it.
+static void ReportLatencies(benchmark::State& state,
+                            std::vector<fml::TimeDelta>& latencies) {
+  if (latencies.empty()) {
+    return;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  state.counters["p50_latency_us"] =
+      latencies[latencies.size() / 2].ToMicrosecondsF();
+  state.counters["p99_latency_us"] =
+      latencies[latencies.size() * 99 / 100].ToMicrosecondsF();
+}
+
+static void BM_ConcurrentMessageLoopPostTask(benchmark::State& state) {
+  auto loop = ConcurrentMessageLoop::Create(state.range(0));
+  auto task_runner = loop->GetTaskRunner();
+  std::vector<fml::TimeDelta> latencies(kTasksPerIteration);
+  std::vector<fml::TimeDelta> all_latencies;
+
+  while (state.KeepRunning()) {
+    CountDownLatch latch(kTasksPerIteration);
+    for (size_t i = 0; i < kTasksPerIteration; i++) {
+      const auto posted = fml::TimePoint::Now();
+      task_runner->PostTask([&latch, &latencies, posted, i]() {
+        latencies[i] = fml::TimePoint::Now() - posted;
+        latch.CountDown();
+      });
+    }
+    latch.Wait();
+    all_latencies.insert(all_latencies.end(), latencies.begin(),
+                         latencies.end());
+  }
+
+  state.SetItemsProcessed(state.iterations() * kTasksPerIteration);
+  ReportLatencies(state, all_latencies);
+}
+
+static void BM_ConcurrentMessageLoopPostTasks(benchmark::State& state) {
+  auto loop = ConcurrentMessageLoop::Create(state.range(0));
+  auto task_runner = loop->GetTaskRunner();
+  std::vector<fml::TimeDelta> latencies(kTasksPerIteration);
+  std::vector<fml::TimeDelta> all_latencies;
+
+  while (state.KeepRunning()) {
+    CountDownLatch latch(kTasksPerIteration);
+    const auto posted = fml::TimePoint::Now();
+    std::vector<fml::closure> tasks;
+    tasks.reserve(kTasksPerIteration);
+    for (size_t i = 0; i < kTasksPerIteration; i++) {
+      tasks.push_back([&latch, &latencies, posted, i]() {
+        latencies[i] = fml::TimePoint::Now() - posted;
+        latch.CountDown();
+      });
+    }
+    task_runner->PostTasks(std::move(tasks));
+    latch.Wait();
+    all_latencies.insert(all_latencies.end(), latencies.begin(),
+                         latencies.end());
+  }
+
+  state.SetItemsProcessed(state.iterations() * kTasksPerIteration);
+  ReportLatencies(state, all_latencies);
+}
+
+// Each task posts a follow up task from the worker it runs on, which stays in
+// that worker's queue unless another worker steals it.
+static void BM_ConcurrentMessageLoopPostFromWorkers(benchmark::State& state) {
+  auto loop = ConcurrentMessageLoop::Create(state.range(0));
+  auto task_runner = loop->GetTaskRunner();
+
+  while (state.KeepRunning()) {
+    CountDownLatch latch(kTasksPerIteration);
+    for (size_t i = 0; i < kTasksPerIteration / 2; i++) {
+      task_runner->PostTask([&latch, task_runner]() {
+        task_runner->PostTask([&latch]() { latch.CountDown(); });
+        latch.CountDown();
+      });
+    }
+    latch.Wait();
+  }
+
+  state.SetItemsProcessed(state.iterations() * kTasksPerIteration);
+}
+
+BENCHMARK(BM_ConcurrentMessageLoopPostTask)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime();
+BENCHMARK(BM_ConcurrentMessageLoopPostTasks)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime();
+BENCHMARK(BM_ConcurrentMessageLoopPostFromWorkers)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime();
+
+}  // namespace benchmarking
+}  // namespace fml
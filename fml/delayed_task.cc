@@ -6,21 +6,35 @@
 
 #include "flutter/fml/delayed_task.h"
 
+#include <algorithm>
+
+#include "flutter/fml/logging.h"
+
 namespace fml {
 
 DelayedTask::DelayedTask(size_t order,
-                         const fml::closure& task,
+                         fml::closure task,
                          fml::TimePoint target_time)
-    : order_(order), task_(task), target_time_(target_time) {}
+    : order_(order), task_(std::move(task)), target_time_(target_time) {}
 
 DelayedTask::DelayedTask(const DelayedTask& other) = default;
 
+DelayedTask::DelayedTask(DelayedTask&& other) = default;
+
 DelayedTask::~DelayedTask() = default;
 
+DelayedTask& DelayedTask::operator=(const DelayedTask& other) = default;
+
+DelayedTask& DelayedTask::operator=(DelayedTask&& other) = default;
+
 const fml::closure& DelayedTask::GetTask() const {
   return task_;
 }
 
+fml::closure DelayedTask::ReleaseTask() {
+  return std::move(task_);
+}
+
 fml::TimePoint DelayedTask::GetTargetTime() const {
   return target_time_;
 }
@@ -32,4 +46,71 @@ bool DelayedTask::operator>(const DelayedTask& other) const {
   return target_time_ > other.target_time_;
 }
 
+DelayedTaskQueue::DelayedTaskQueue() = default;
+
+DelayedTaskQueue::~DelayedTaskQueue() = default;
+
+const DelayedTask& DelayedTaskQueue::top() const {
+  FML_DCHECK(!heap_.empty());
+  return heap_.front();
+}
+
+void DelayedTaskQueue::push(DelayedTask task) {
+  heap_.push_back(std::move(task));
+  std::push_heap(heap_.begin(), heap_.end(), std::greater<DelayedTask>());
+}
+
+DelayedTask DelayedTaskQueue::pop() {
+  FML_DCHECK(!heap_.empty());
+  std::pop_heap(heap_.begin(), heap_.end(), std::greater<DelayedTask>());
+  DelayedTask task = std::move(heap_.back());
+  heap_.pop_back();
+  return task;
+}
+
+void DelayedTaskQueue::clear() {
+  heap_.clear();
+}
+
+ImmediateTaskQueue::ImmediateTaskQueue() = default;
+
+ImmediateTaskQueue::~ImmediateTaskQueue() = default;
+
+const DelayedTask& ImmediateTaskQueue::front() const {
+  FML_DCHECK(!empty());
+  return tasks_[head_];
+}
+
+const DelayedTask& ImmediateTaskQueue::back() const {
+  FML_DCHECK(!empty());
+  return tasks_.back();
+}
+
+void ImmediateTaskQueue::push(DelayedTask task) {
+  // Reclaim the slots of tasks that were already popped once they make up
+  // most of the storage, so a queue that never fully drains doesn't grow
+  // without bound.
+  if (head_ > 0 && head_ >= tasks_.size() / 2 &&
+      tasks_.size() == tasks_.capacity()) {
+    tasks_.erase(tasks_.begin(), tasks_.begin() + head_);
+    head_ = 0;
+  }
+  tasks_.push_back(std::move(task));
+}
+
+DelayedTask ImmediateTaskQueue::pop() {
+  FML_DCHECK(!empty());
+  DelayedTask task = std::move(tasks_[head_]);
+  head_++;
+  if (head_ == tasks_.size()) {
+    clear();
+  }
+  return task;
+}
+
+void ImmediateTaskQueue::clear() {
+  tasks_.clear();
+  head_ = 0;
+}
+
 }  // namespace fml
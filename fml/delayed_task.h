@@ -5,25 +5,33 @@
 #ifndef FLUTTER_FML_DELAYED_TASK_H_
 #define FLUTTER_FML_DELAYED_TASK_H_
 
+#include <vector>
+
 #include "flutter/fml/closure.h"
+#include "flutter/fml/macros.h"
 #include "flutter/fml/time/time_point.h"
 
-#include <queue>
-
 namespace fml {
 
 class DelayedTask {
  public:
-  DelayedTask(size_t order,
-              const fml::closure& task,
-              fml::TimePoint target_time);
+  DelayedTask(size_t order, fml::closure task, fml::TimePoint target_time);
 
   DelayedTask(const DelayedTask& other);
 
+  DelayedTask(DelayedTask&& other);
+
   ~DelayedTask();
 
+  DelayedTask& operator=(const DelayedTask& other);
+
+  DelayedTask& operator=(DelayedTask&& other);
+
   const fml::closure& GetTask() const;
 
+  // Moves the closure out of this task, leaving it empty.
+  fml::closure ReleaseTask();
+
   fml::TimePoint GetTargetTime() const;
 
   bool operator>(const DelayedTask& other) const;
@@ -34,9 +42,63 @@ class DelayedTask {
   fml::TimePoint target_time_;
 };
 
-using DelayedTaskQueue = std::priority_queue<DelayedTask,
-                                             std::deque<DelayedTask>,
-                                             std::greater<DelayedTask>>;
+// A min-heap of tasks ordered by target time and then by registration order.
+// Unlike |std::priority_queue|, the top task can be moved out when popped, and
+// the backing storage is retained once the queue has been drained.
+class DelayedTaskQueue {
+ public:
+  DelayedTaskQueue();
+
+  ~DelayedTaskQueue();
+
+  bool empty() const { return heap_.empty(); }
+
+  size_t size() const { return heap_.size(); }
+
+  const DelayedTask& top() const;
+
+  void push(DelayedTask task);
+
+  DelayedTask pop();
+
+  void clear();
+
+ private:
+  std::vector<DelayedTask> heap_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DelayedTaskQueue);
+};
+
+// A FIFO of tasks that were already runnable when they were registered. Such
+// tasks arrive in order, so they don't need to go through the heap. The
+// backing storage is reused, so a queue that is regularly drained stops
+// allocating once it has grown to its steady state size.
+class ImmediateTaskQueue {
+ public:
+  ImmediateTaskQueue();
+
+  ~ImmediateTaskQueue();
+
+  bool empty() const { return head_ == tasks_.size(); }
+
+  size_t size() const { return tasks_.size() - head_; }
+
+  const DelayedTask& front() const;
+
+  const DelayedTask& back() const;
+
+  void push(DelayedTask task);
+
+  DelayedTask pop();
+
+  void clear();
+
+ private:
+  std::vector<DelayedTask> tasks_;
+  size_t head_ = 0;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ImmediateTaskQueue);
+};
 
 }  // namespace fml
 
@@ -28,6 +28,9 @@ class Mapping {
 
   virtual const uint8_t* GetMapping() const = 0;
 
+  // The contents, if the mapping may be written to. Null otherwise.
+  virtual uint8_t* GetMutableMapping();
+
  private:
   FML_DISALLOW_COPY_AND_ASSIGN(Mapping);
 };
@@ -65,7 +68,8 @@ class FileMapping final : public Mapping {
   // |Mapping|
   const uint8_t* GetMapping() const override;
 
-  uint8_t* GetMutableMapping();
+  // |Mapping|
+  uint8_t* GetMutableMapping() override;
 
   bool IsValid() const;
 
@@ -96,6 +100,9 @@ class DataMapping final : public Mapping {
   // |Mapping|
   const uint8_t* GetMapping() const override;
 
+  // |Mapping|
+  uint8_t* GetMutableMapping() override;
+
  private:
   std::vector<uint8_t> data_;
 
@@ -69,6 +69,16 @@ void MessageLoop::RemoveTaskObserver(intptr_t key) {
   loop_->RemoveTaskObserver(key);
 }
 
+bool MessageLoop::AddFileDescriptorWatch(int fd,
+                                         uint32_t events,
+                                         const FileDescriptorHandler& handler) {
+  return loop_->AddFileDescriptorWatch(fd, events, handler);
+}
+
+bool MessageLoop::RemoveFileDescriptorWatch(int fd) {
+  return loop_->RemoveFileDescriptorWatch(fd);
+}
+
 void MessageLoop::RunExpiredTasksNow() {
   loop_->RunExpiredTasksNow();
 }
@@ -28,6 +28,13 @@ class MessageLoop {
 
   void RemoveTaskObserver(intptr_t key);
 
+  // See |TaskRunner::AddFileDescriptorWatch|.
+  bool AddFileDescriptorWatch(int fd,
+                              uint32_t events,
+                              const FileDescriptorHandler& handler);
+
+  bool RemoveFileDescriptorWatch(int fd);
+
   fml::RefPtr<fml::TaskRunner> GetTaskRunner() const;
 
   // Exposed for the embedder shell which allows clients to poll for events
@@ -7,6 +7,7 @@
 #include "flutter/fml/message_loop_impl.h"
 
 #include <algorithm>
+#include <array>
 #include <vector>
 
 #include "flutter/fml/build_config.h"
@@ -27,6 +28,8 @@
 
 namespace fml {
 
+static constexpr size_t kFlushBatchSize = 16;
+
 fml::RefPtr<MessageLoopImpl> MessageLoopImpl::Create() {
 #if OS_MACOSX
   return fml::MakeRefCounted<MessageLoopDarwin>();
@@ -119,16 +122,29 @@ void MessageLoopImpl::DoTerminate() {
 
 void MessageLoopImpl::FlushTasks(FlushType type) {
   TRACE_EVENT0("fml", "MessageLoop::FlushTasks");
-  std::vector<fml::closure> invocations;
-
-  task_queue_->GetTasksToRunNow(queue_id_, type, invocations);
+  // Tasks are taken in fixed size batches so that flushing doesn't allocate.
+  // Only tasks that were due when the flush started are run, tasks posted by
+  // them are left for the next flush.
+  const auto now = fml::TimePoint::Now();
+  std::array<fml::closure, kFlushBatchSize> invocations;
+  std::vector<fml::closure> observers;
+
+  while (true) {
+    const size_t count = task_queue_->GetTasksToRunNow(
+        queue_id_, type, now, invocations.data(), invocations.size());
+
+    for (size_t i = 0; i < count; i++) {
+      invocations[i]();
+      invocations[i] = nullptr;
+      observers.clear();
+      task_queue_->GetObserversToNotify(queue_id_, observers);
+      for (const auto& observer : observers) {
+        observer();
+      }
+    }
 
-  for (const auto& invocation : invocations) {
-    invocation();
-    std::vector<fml::closure> observers =
-        task_queue_->GetObserversToNotify(queue_id_);
-    for (const auto& observer : observers) {
-      observer();
+    if (type == FlushType::kSingle || count < invocations.size()) {
+      break;
     }
   }
 }
@@ -145,4 +161,15 @@ TaskQueueId MessageLoopImpl::GetTaskQueueId() const {
   return queue_id_;
 }
 
+bool MessageLoopImpl::AddFileDescriptorWatch(
+    int fd,
+    uint32_t events,
+    const FileDescriptorHandler& handler) {
+  return false;
+}
+
+bool MessageLoopImpl::RemoveFileDescriptorWatch(int fd) {
+  return false;
+}
+
 }  // namespace fml
@@ -46,6 +46,14 @@ class MessageLoopImpl : public Wakeable,
 
   virtual TaskQueueId GetTaskQueueId() const;
 
+  // See |TaskRunner::AddFileDescriptorWatch|. Loops that cannot watch file
+  // descriptors keep this default, which returns false.
+  virtual bool AddFileDescriptorWatch(int fd,
+                                      uint32_t events,
+                                      const FileDescriptorHandler& handler);
+
+  virtual bool RemoveFileDescriptorWatch(int fd);
+
  protected:
   // Exposed for the embedder shell which allows clients to poll for events
   // instead of dedicating a thread to the message loop.
@@ -5,6 +5,10 @@
 #define FML_USED_ON_EMBEDDER
 
 #include "flutter/fml/message_loop_task_queues.h"
+
+#include <algorithm>
+#include <climits>
+
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/message_loop_impl.h"
 
@@ -20,7 +24,43 @@ TaskQueueEntry::TaskQueueEntry()
     : owner_of(_kUnmerged), subsumed_by(_kUnmerged) {
   wakeable = NULL;
   task_observers = TaskObservers();
-  delayed_tasks = DelayedTaskQueue();
+}
+
+bool TaskQueueEntry::HasTasks() const {
+  return !immediate_tasks.empty() || !delayed_tasks.empty();
+}
+
+size_t TaskQueueEntry::GetNumTasks() const {
+  return immediate_tasks.size() + delayed_tasks.size();
+}
+
+const DelayedTask& TaskQueueEntry::PeekTask() const {
+  FML_DCHECK(HasTasks());
+  if (immediate_tasks.empty()) {
+    return delayed_tasks.top();
+  }
+  if (delayed_tasks.empty()) {
+    return immediate_tasks.front();
+  }
+  const auto& immediate_task = immediate_tasks.front();
+  const auto& delayed_task = delayed_tasks.top();
+  return immediate_task > delayed_task ? delayed_task : immediate_task;
+}
+
+DelayedTask TaskQueueEntry::PopTask() {
+  FML_DCHECK(HasTasks());
+  if (immediate_tasks.empty()) {
+    return delayed_tasks.pop();
+  }
+  if (delayed_tasks.empty() || delayed_tasks.top() > immediate_tasks.front()) {
+    return immediate_tasks.pop();
+  }
+  return delayed_tasks.pop();
+}
+
+void TaskQueueEntry::ClearTasks() {
+  immediate_tasks.clear();
+  delayed_tasks.clear();
 }
 
 fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::GetInstance() {
@@ -32,62 +72,85 @@ fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::GetInstance() {
 }
 
 TaskQueueId MessageLoopTaskQueues::CreateTaskQueue() {
-  fml::UniqueLock lock(*queue_meta_mutex_);
+  std::scoped_lock table_lock(queue_table_mutex_);
   TaskQueueId loop_id = TaskQueueId(task_queue_id_counter_);
+  const size_t chunk_index = task_queue_id_counter_ / kQueueChunkSize;
+  FML_CHECK(chunk_index < kMaxQueueChunks) << "Too many task queues.";
   ++task_queue_id_counter_;
 
-  queue_entries_[loop_id] = std::make_unique<TaskQueueEntry>();
-  queue_locks_[loop_id] = std::make_unique<std::mutex>();
+  if (queue_chunks_[chunk_index].load(std::memory_order_relaxed) == nullptr) {
+    queue_chunks_[chunk_index].store(new QueueSlot[kQueueChunkSize],
+                                     std::memory_order_release);
+  }
+
+  QueueSlot& slot = GetSlot(loop_id);
+  std::scoped_lock queue_lock(slot.mutex);
+  slot.entry = std::make_unique<TaskQueueEntry>();
 
   return loop_id;
 }
 
 MessageLoopTaskQueues::MessageLoopTaskQueues()
-    : queue_meta_mutex_(fml::SharedMutex::Create()),
-      task_queue_id_counter_(0),
-      order_(0) {}
+    : task_queue_id_counter_(0), order_(0) {
+  for (auto& chunk : queue_chunks_) {
+    chunk.store(nullptr, std::memory_order_relaxed);
+  }
+}
 
-MessageLoopTaskQueues::~MessageLoopTaskQueues() = default;
+MessageLoopTaskQueues::~MessageLoopTaskQueues() {
+  for (auto& chunk : queue_chunks_) {
+    delete[] chunk.load(std::memory_order_relaxed);
+  }
+}
 
 void MessageLoopTaskQueues::Dispose(TaskQueueId queue_id) {
-  std::scoped_lock queue_lock(GetMutex(queue_id));
+  QueueSlot& slot = GetSlot(queue_id);
+  std::scoped_lock queue_lock(slot.mutex);
 
-  const auto& queue_entry = queue_entries_.at(queue_id);
-  FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
-  TaskQueueId subsumed = queue_entry->owner_of;
-  queue_entries_.erase(queue_id);
+  FML_DCHECK(slot.entry->subsumed_by == _kUnmerged);
+  TaskQueueId subsumed = slot.entry->owner_of;
+  slot.entry.reset();
   if (subsumed != _kUnmerged) {
-    std::scoped_lock subsumed_lock(*queue_locks_.at(subsumed));
-    queue_entries_.erase(subsumed);
+    QueueSlot& subsumed_slot = GetSlot(subsumed);
+    std::scoped_lock subsumed_lock(subsumed_slot.mutex);
+    subsumed_slot.entry.reset();
   }
 }
 
 void MessageLoopTaskQueues::DisposeTasks(TaskQueueId queue_id) {
   std::scoped_lock queue_lock(GetMutex(queue_id));
-  const auto& queue_entry = queue_entries_.at(queue_id);
-  FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
-  TaskQueueId subsumed = queue_entry->owner_of;
-  queue_entry->delayed_tasks = {};
+  auto& queue_entry = GetEntryUnlocked(queue_id);
+  FML_DCHECK(queue_entry.subsumed_by == _kUnmerged);
+  TaskQueueId subsumed = queue_entry.owner_of;
+  queue_entry.ClearTasks();
   if (subsumed != _kUnmerged) {
-    std::scoped_lock subsumed_lock(*queue_locks_.at(subsumed));
-    queue_entries_.at(subsumed)->delayed_tasks = {};
+    std::scoped_lock subsumed_lock(GetMutex(subsumed));
+    GetEntryUnlocked(subsumed).ClearTasks();
   }
 }
 
 void MessageLoopTaskQueues::RegisterTask(TaskQueueId queue_id,
-                                         const fml::closure& task,
+                                         fml::closure task,
                                          fml::TimePoint target_time) {
   std::scoped_lock queue_lock(GetMutex(queue_id));
 
   size_t order = order_++;
-  const auto& queue_entry = queue_entries_[queue_id];
-  queue_entry->delayed_tasks.push({order, task, target_time});
+  auto& queue_entry = GetEntryUnlocked(queue_id);
+  // Orders only increase under the queue lock, so the immediate tasks stay
+  // sorted as long as their target times don't go backwards.
+  auto& immediate_tasks = queue_entry.immediate_tasks;
+  if (target_time <= fml::TimePoint::Now() &&
+      (immediate_tasks.empty() ||
+       target_time >= immediate_tasks.back().GetTargetTime())) {
+    immediate_tasks.push({order, std::move(task), target_time});
+  } else {
+    queue_entry.delayed_tasks.push({order, std::move(task), target_time});
+  }
   TaskQueueId loop_to_wake = queue_id;
-  if (queue_entry->subsumed_by != _kUnmerged) {
-    loop_to_wake = queue_entry->subsumed_by;
+  if (queue_entry.subsumed_by != _kUnmerged) {
+    loop_to_wake = queue_entry.subsumed_by;
   }
-  WakeUpUnlocked(loop_to_wake,
-                 queue_entry->delayed_tasks.top().GetTargetTime());
+  WakeUpUnlocked(loop_to_wake, queue_entry.PeekTask().GetTargetTime());
 }
 
 bool MessageLoopTaskQueues::HasPendingTasks(TaskQueueId queue_id) const {
@@ -108,49 +171,77 @@ void MessageLoopTaskQueues::GetTasksToRunNow(
 
   const auto now = fml::TimePoint::Now();
 
-  while (HasPendingTasksUnlocked(queue_id)) {
-    TaskQueueId top_queue = _kUnmerged;
-    const auto& top = PeekNextTaskUnlocked(queue_id, top_queue);
-    if (top.GetTargetTime() > now) {
-      break;
-    }
-    invocations.emplace_back(std::move(top.GetTask()));
-    queue_entries_[top_queue]->delayed_tasks.pop();
+  fml::closure task;
+  while (PopTaskToRunNowUnlocked(queue_id, now, task)) {
+    invocations.emplace_back(std::move(task));
     if (type == FlushType::kSingle) {
       break;
     }
   }
 
+  WakeUpForNextTaskUnlocked(queue_id);
+}
+
+size_t MessageLoopTaskQueues::GetTasksToRunNow(TaskQueueId queue_id,
+                                               FlushType type,
+                                               fml::TimePoint now,
+                                               fml::closure* invocations,
+                                               size_t max_invocations) {
+  std::scoped_lock queue_lock(GetMutex(queue_id));
+
   if (!HasPendingTasksUnlocked(queue_id)) {
-    WakeUpUnlocked(queue_id, fml::TimePoint::Max());
-  } else {
-    WakeUpUnlocked(queue_id, GetNextWakeTimeUnlocked(queue_id));
+    // The queue may still be set to wake up for tasks that are gone, like
+    // those of a queue that was merged into another one since.
+    WakeUpForNextTaskUnlocked(queue_id);
+    return 0;
+  }
+
+  if (type == FlushType::kSingle) {
+    max_invocations = std::min<size_t>(max_invocations, 1);
   }
+
+  size_t count = 0;
+  while (count < max_invocations &&
+         PopTaskToRunNowUnlocked(queue_id, now, invocations[count])) {
+    count++;
+  }
+
+  WakeUpForNextTaskUnlocked(queue_id);
+  return count;
 }
 
 void MessageLoopTaskQueues::WakeUpUnlocked(TaskQueueId queue_id,
                                            fml::TimePoint time) const {
-  if (queue_entries_.at(queue_id)->wakeable) {
-    queue_entries_.at(queue_id)->wakeable->WakeUp(time);
+  const auto& queue_entry = GetEntryUnlocked(queue_id);
+  if (queue_entry.wakeable) {
+    queue_entry.wakeable->WakeUp(time);
+  }
+}
+
+void MessageLoopTaskQueues::WakeUpForNextTaskUnlocked(
+    TaskQueueId queue_id) const {
+  if (!HasPendingTasksUnlocked(queue_id)) {
+    WakeUpUnlocked(queue_id, fml::TimePoint::Max());
+  } else {
+    WakeUpUnlocked(queue_id, GetNextWakeTimeUnlocked(queue_id));
   }
 }
 
 size_t MessageLoopTaskQueues::GetNumPendingTasks(TaskQueueId queue_id) const {
   std::scoped_lock queue_lock(GetMutex(queue_id));
 
-  const auto& queue_entry = queue_entries_.at(queue_id);
-  if (queue_entry->subsumed_by != _kUnmerged) {
+  const auto& queue_entry = GetEntryUnlocked(queue_id);
+  if (queue_entry.subsumed_by != _kUnmerged) {
     return 0;
   }
 
   size_t total_tasks = 0;
-  total_tasks += queue_entry->delayed_tasks.size();
+  total_tasks += queue_entry.GetNumTasks();
 
-  TaskQueueId subsumed = queue_entry->owner_of;
+  TaskQueueId subsumed = queue_entry.owner_of;
   if (subsumed != _kUnmerged) {
-    std::scoped_lock subsumed_lock(*queue_locks_.at(subsumed));
-    const auto& subsumed_entry = queue_entries_.at(subsumed);
-    total_tasks += subsumed_entry->delayed_tasks.size();
+    std::scoped_lock subsumed_lock(GetMutex(subsumed));
+    total_tasks += GetEntryUnlocked(subsumed).GetNumTasks();
   }
   return total_tasks;
 }
@@ -161,47 +252,53 @@ void MessageLoopTaskQueues::AddTaskObserver(TaskQueueId queue_id,
   std::scoped_lock queue_lock(GetMutex(queue_id));
 
   FML_DCHECK(callback != nullptr) << "Observer callback must be non-null.";
-  queue_entries_[queue_id]->task_observers[key] = std::move(callback);
+  GetEntryUnlocked(queue_id).task_observers[key] = std::move(callback);
 }
 
 void MessageLoopTaskQueues::RemoveTaskObserver(TaskQueueId queue_id,
                                                intptr_t key) {
   std::scoped_lock queue_lock(GetMutex(queue_id));
 
-  queue_entries_[queue_id]->task_observers.erase(key);
+  GetEntryUnlocked(queue_id).task_observers.erase(key);
 }
 
 std::vector<fml::closure> MessageLoopTaskQueues::GetObserversToNotify(
     TaskQueueId queue_id) const {
-  std::scoped_lock queue_lock(GetMutex(queue_id));
   std::vector<fml::closure> observers;
+  GetObserversToNotify(queue_id, observers);
+  return observers;
+}
 
-  if (queue_entries_.at(queue_id)->subsumed_by != _kUnmerged) {
-    return observers;
+void MessageLoopTaskQueues::GetObserversToNotify(
+    TaskQueueId queue_id,
+    std::vector<fml::closure>& observers) const {
+  std::scoped_lock queue_lock(GetMutex(queue_id));
+
+  const auto& queue_entry = GetEntryUnlocked(queue_id);
+  if (queue_entry.subsumed_by != _kUnmerged) {
+    return;
   }
 
-  for (const auto& observer : queue_entries_.at(queue_id)->task_observers) {
+  for (const auto& observer : queue_entry.task_observers) {
     observers.push_back(observer.second);
   }
 
-  TaskQueueId subsumed = queue_entries_.at(queue_id)->owner_of;
+  TaskQueueId subsumed = queue_entry.owner_of;
   if (subsumed != _kUnmerged) {
-    std::scoped_lock subsumed_lock(*queue_locks_.at(subsumed));
-    for (const auto& observer : queue_entries_.at(subsumed)->task_observers) {
+    std::scoped_lock subsumed_lock(GetMutex(subsumed));
+    for (const auto& observer : GetEntryUnlocked(subsumed).task_observers) {
       observers.push_back(observer.second);
     }
   }
-
-  return observers;
 }
 
 void MessageLoopTaskQueues::SetWakeable(TaskQueueId queue_id,
                                         fml::Wakeable* wakeable) {
   std::scoped_lock queue_lock(GetMutex(queue_id));
 
-  FML_CHECK(!queue_entries_[queue_id]->wakeable)
-      << "Wakeable can only be set once.";
-  queue_entries_.at(queue_id)->wakeable = wakeable;
+  auto& queue_entry = GetEntryUnlocked(queue_id);
+  FML_CHECK(!queue_entry.wakeable) << "Wakeable can only be set once.";
+  queue_entry.wakeable = wakeable;
 }
 
 bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
@@ -214,16 +311,16 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
 
   std::scoped_lock lock(owner_mutex, subsumed_mutex);
 
-  auto& owner_entry = queue_entries_.at(owner);
-  auto& subsumed_entry = queue_entries_.at(subsumed);
+  auto& owner_entry = GetEntryUnlocked(owner);
+  auto& subsumed_entry = GetEntryUnlocked(subsumed);
 
-  if (owner_entry->owner_of == subsumed) {
+  if (owner_entry.owner_of == subsumed) {
     return true;
   }
 
   std::vector<TaskQueueId> owner_subsumed_keys = {
-      owner_entry->owner_of, owner_entry->subsumed_by, subsumed_entry->owner_of,
-      subsumed_entry->subsumed_by};
+      owner_entry.owner_of, owner_entry.subsumed_by, subsumed_entry.owner_of,
+      subsumed_entry.subsumed_by};
 
   for (auto key : owner_subsumed_keys) {
     if (key != _kUnmerged) {
@@ -231,8 +328,8 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
     }
   }
 
-  owner_entry->owner_of = subsumed;
-  subsumed_entry->subsumed_by = owner;
+  owner_entry.owner_of = subsumed;
+  subsumed_entry.subsumed_by = owner;
 
   if (HasPendingTasksUnlocked(owner)) {
     WakeUpUnlocked(owner, GetNextWakeTimeUnlocked(owner));
@@ -244,14 +341,14 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
 bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner) {
   std::scoped_lock owner_lock(GetMutex(owner));
 
-  auto& owner_entry = queue_entries_[owner];
-  const TaskQueueId subsumed = owner_entry->owner_of;
+  auto& owner_entry = GetEntryUnlocked(owner);
+  const TaskQueueId subsumed = owner_entry.owner_of;
   if (subsumed == _kUnmerged) {
     return false;
   }
 
-  queue_entries_[subsumed]->subsumed_by = _kUnmerged;
-  owner_entry->owner_of = _kUnmerged;
+  GetEntryUnlocked(subsumed).subsumed_by = _kUnmerged;
+  owner_entry.owner_of = _kUnmerged;
 
   if (HasPendingTasksUnlocked(owner)) {
     WakeUpUnlocked(owner, GetNextWakeTimeUnlocked(owner));
@@ -267,36 +364,53 @@ bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner) {
 bool MessageLoopTaskQueues::Owns(TaskQueueId owner,
                                  TaskQueueId subsumed) const {
   std::scoped_lock owner_lock(GetMutex(owner));
-  return subsumed == queue_entries_.at(owner)->owner_of || owner == subsumed;
+  return subsumed == GetEntryUnlocked(owner).owner_of || owner == subsumed;
 }
 
-std::mutex& MessageLoopTaskQueues::GetMutex(TaskQueueId queue_id) const {
-  fml::SharedLock queue_reader(*queue_meta_mutex_);
-  FML_DCHECK(queue_locks_.count(queue_id) && queue_entries_.count(queue_id))
+MessageLoopTaskQueues::QueueSlot& MessageLoopTaskQueues::GetSlot(
+    TaskQueueId queue_id) const {
+  const size_t index = static_cast<size_t>(static_cast<int>(queue_id));
+  const size_t chunk_index = index / kQueueChunkSize;
+  QueueSlot* chunk = chunk_index < kMaxQueueChunks
+                         ? queue_chunks_[chunk_index].load(
+                               std::memory_order_acquire)
+                         : nullptr;
+  FML_CHECK(chunk != nullptr)
       << "Trying to acquire a lock on an invalid queue_id: " << queue_id;
-  return *queue_locks_.at(queue_id);
+  return chunk[index % kQueueChunkSize];
+}
+
+std::mutex& MessageLoopTaskQueues::GetMutex(TaskQueueId queue_id) const {
+  return GetSlot(queue_id).mutex;
+}
+
+TaskQueueEntry& MessageLoopTaskQueues::GetEntryUnlocked(
+    TaskQueueId queue_id) const {
+  const auto& entry = GetSlot(queue_id).entry;
+  FML_DCHECK(entry) << "Trying to access a disposed queue_id: " << queue_id;
+  return *entry;
 }
 
 // Subsumed queues will never have pending tasks.
 // Owning queues will consider both their and their subsumed tasks.
 bool MessageLoopTaskQueues::HasPendingTasksUnlocked(
     TaskQueueId queue_id) const {
-  const auto& entry = queue_entries_.at(queue_id);
-  bool is_subsumed = entry->subsumed_by != _kUnmerged;
+  const auto& entry = GetEntryUnlocked(queue_id);
+  bool is_subsumed = entry.subsumed_by != _kUnmerged;
   if (is_subsumed) {
     return false;
   }
 
-  if (!entry->delayed_tasks.empty()) {
+  if (entry.HasTasks()) {
     return true;
   }
 
-  const TaskQueueId subsumed = entry->owner_of;
+  const TaskQueueId subsumed = entry.owner_of;
   if (subsumed == _kUnmerged) {
     // this is not an owner and queue is empty.
     return false;
   } else {
-    return !queue_entries_.at(subsumed)->delayed_tasks.empty();
+    return GetEntryUnlocked(subsumed).HasTasks();
   }
 }
 
@@ -306,37 +420,54 @@ fml::TimePoint MessageLoopTaskQueues::GetNextWakeTimeUnlocked(
   return PeekNextTaskUnlocked(queue_id, tmp).GetTargetTime();
 }
 
+bool MessageLoopTaskQueues::PopTaskToRunNowUnlocked(TaskQueueId queue_id,
+                                                    fml::TimePoint now,
+                                                    fml::closure& task) {
+  if (!HasPendingTasksUnlocked(queue_id)) {
+    return false;
+  }
+  TaskQueueId top_queue = _kUnmerged;
+  const auto& top = PeekNextTaskUnlocked(queue_id, top_queue);
+  if (top.GetTargetTime() > now) {
+    return false;
+  }
+  task = GetEntryUnlocked(top_queue).PopTask().ReleaseTask();
+  return true;
+}
+
 const DelayedTask& MessageLoopTaskQueues::PeekNextTaskUnlocked(
     TaskQueueId owner,
     TaskQueueId& top_queue_id) const {
   FML_DCHECK(HasPendingTasksUnlocked(owner));
-  const auto& entry = queue_entries_.at(owner);
-  const TaskQueueId subsumed = entry->owner_of;
+  const auto& entry = GetEntryUnlocked(owner);
+  const TaskQueueId subsumed = entry.owner_of;
   if (subsumed == _kUnmerged) {
     top_queue_id = owner;
-    return entry->delayed_tasks.top();
+    return entry.PeekTask();
   }
 
-  const auto& owner_tasks = entry->delayed_tasks;
-  const auto& subsumed_tasks = queue_entries_.at(subsumed)->delayed_tasks;
+  const auto& subsumed_entry = GetEntryUnlocked(subsumed);
 
   // we are owning another task queue
-  const bool subsumed_has_task = !subsumed_tasks.empty();
-  const bool owner_has_task = !owner_tasks.empty();
+  const bool subsumed_has_task = subsumed_entry.HasTasks();
+  const bool owner_has_task = entry.HasTasks();
   if (owner_has_task && subsumed_has_task) {
-    const auto owner_task = owner_tasks.top();
-    const auto subsumed_task = subsumed_tasks.top();
+    const auto& owner_task = entry.PeekTask();
+    const auto& subsumed_task = subsumed_entry.PeekTask();
     if (owner_task > subsumed_task) {
       top_queue_id = subsumed;
+      return subsumed_task;
     } else {
       top_queue_id = owner;
+      return owner_task;
     }
   } else if (owner_has_task) {
     top_queue_id = owner;
+    return entry.PeekTask();
   } else {
     top_queue_id = subsumed;
+    return subsumed_entry.PeekTask();
   }
-  return queue_entries_.at(top_queue_id)->delayed_tasks.top();
 }
 
 }  // namespace fml
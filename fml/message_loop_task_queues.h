@@ -5,7 +5,9 @@
 #ifndef FLUTTER_FML_MESSAGE_LOOP_TASK_QUEUES_H_
 #define FLUTTER_FML_MESSAGE_LOOP_TASK_QUEUES_H_
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -13,7 +15,6 @@
 #include "flutter/fml/delayed_task.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_counted.h"
-#include "flutter/fml/synchronization/shared_mutex.h"
 #include "flutter/fml/wakeable.h"
 
 namespace fml {
@@ -40,6 +41,9 @@ class TaskQueueEntry {
   Wakeable* wakeable;
   TaskObservers task_observers;
   DelayedTaskQueue delayed_tasks;
+  // Tasks that were already runnable when they were registered. They skip
+  // |delayed_tasks| and are merged back in target time order when popped.
+  ImmediateTaskQueue immediate_tasks;
 
   // Note: Both of these can be _kUnmerged, which indicates that
   // this queue has not been merged or subsumed. OR exactly one
@@ -50,6 +54,17 @@ class TaskQueueEntry {
 
   TaskQueueEntry();
 
+  bool HasTasks() const;
+
+  size_t GetNumTasks() const;
+
+  // The next task of this queue alone, ignoring any merged queue.
+  const DelayedTask& PeekTask() const;
+
+  DelayedTask PopTask();
+
+  void ClearTasks();
+
  private:
   FML_DISALLOW_COPY_ASSIGN_AND_MOVE(TaskQueueEntry);
 };
@@ -78,7 +93,7 @@ class MessageLoopTaskQueues
   // Tasks methods.
 
   void RegisterTask(TaskQueueId queue_id,
-                    const fml::closure& task,
+                    fml::closure task,
                     fml::TimePoint target_time);
 
   bool HasPendingTasks(TaskQueueId queue_id) const;
@@ -87,6 +102,16 @@ class MessageLoopTaskQueues
                         FlushType type,
                         std::vector<fml::closure>& invocations);
 
+  // Moves up to |max_invocations| tasks whose target time is not after |now|
+  // into |invocations| and returns how many were moved. Unlike the overload
+  // above, this never allocates, so the message loop can flush its tasks in
+  // fixed size batches.
+  size_t GetTasksToRunNow(TaskQueueId queue_id,
+                          FlushType type,
+                          fml::TimePoint now,
+                          fml::closure* invocations,
+                          size_t max_invocations);
+
   size_t GetNumPendingTasks(TaskQueueId queue_id) const;
 
   // Observers methods.
@@ -99,6 +124,11 @@ class MessageLoopTaskQueues
 
   std::vector<fml::closure> GetObserversToNotify(TaskQueueId queue_id) const;
 
+  // Appends the observers to |observers|, so that callers can reuse its
+  // storage across tasks.
+  void GetObserversToNotify(TaskQueueId queue_id,
+                            std::vector<fml::closure>& observers) const;
+
   // Misc.
 
   void SetWakeable(TaskQueueId queue_id, fml::Wakeable* wakeable);
@@ -127,7 +157,16 @@ class MessageLoopTaskQueues
  private:
   class MergedQueuesRunner;
 
-  using Mutexes = std::vector<std::unique_ptr<std::mutex>>;
+  // Queues are stored in a table indexed by their id. The table is made of
+  // fixed size chunks that are allocated as queues are created and never move,
+  // so finding a queue only needs the lock of that queue.
+  static constexpr size_t kQueueChunkSize = 256;
+  static constexpr size_t kMaxQueueChunks = 4096;
+
+  struct QueueSlot {
+    std::mutex mutex;
+    std::unique_ptr<TaskQueueEntry> entry;
+  };
 
   MessageLoopTaskQueues();
 
@@ -135,8 +174,12 @@ class MessageLoopTaskQueues
 
   void WakeUpUnlocked(TaskQueueId queue_id, fml::TimePoint time) const;
 
+  QueueSlot& GetSlot(TaskQueueId queue_id) const;
+
   std::mutex& GetMutex(TaskQueueId queue_id) const;
 
+  TaskQueueEntry& GetEntryUnlocked(TaskQueueId queue_id) const;
+
   bool HasPendingTasksUnlocked(TaskQueueId queue_id) const;
 
   const DelayedTask& PeekNextTaskUnlocked(TaskQueueId queue_id,
@@ -144,12 +187,20 @@ class MessageLoopTaskQueues
 
   fml::TimePoint GetNextWakeTimeUnlocked(TaskQueueId queue_id) const;
 
+  // Pops the next task of |queue_id| (or the queue it owns) into |task| if its
+  // target time is not after |now|.
+  bool PopTaskToRunNowUnlocked(TaskQueueId queue_id,
+                               fml::TimePoint now,
+                               fml::closure& task);
+
+  void WakeUpForNextTaskUnlocked(TaskQueueId queue_id) const;
+
   static std::mutex creation_mutex_;
   static fml::RefPtr<MessageLoopTaskQueues> instance_;
 
-  std::unique_ptr<fml::SharedMutex> queue_meta_mutex_;
-  std::map<TaskQueueId, std::unique_ptr<TaskQueueEntry>> queue_entries_;
-  std::map<TaskQueueId, std::unique_ptr<std::mutex>> queue_locks_;
+  // Guards |task_queue_id_counter_| and the allocation of chunks.
+  std::mutex queue_table_mutex_;
+  std::atomic<QueueSlot*> queue_chunks_[kMaxQueueChunks];
 
   size_t task_queue_id_counter_;
 
@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <array>
 #include <cassert>
 #include <string>
 #include <thread>
@@ -13,36 +14,48 @@
 namespace fml {
 namespace benchmarking {
 
-static void BM_RegisterAndGetTasks(benchmark::State& state) {
-  while (state.KeepRunning()) {
-    auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+static constexpr int kNumTaskQueues = 10;
 
-    const int num_task_queues = 10;
-    const int num_tasks_per_queue = 100;
-    const fml::TimePoint past = fml::TimePoint::Now();
+static std::vector<TaskQueueId> CreateTaskQueues(
+    const fml::RefPtr<MessageLoopTaskQueues>& task_queue) {
+  std::vector<TaskQueueId> queue_ids;
+  for (int i = 0; i < kNumTaskQueues; i++) {
+    queue_ids.push_back(task_queue->CreateTaskQueue());
+  }
+  return queue_ids;
+}
 
-    for (int i = 0; i < num_task_queues; i++) {
-      task_queue->CreateTaskQueue();
-    }
+// Each of the threads registers |num_tasks_per_queue| tasks on its own queue
+// and then flushes them, which is what the message loops do.
+template <typename Flush>
+static void RegisterAndGetTasks(benchmark::State& state,
+                                fml::TimeDelta delay,
+                                Flush flush) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  const auto queue_ids = CreateTaskQueues(task_queue);
+  const int num_tasks_per_queue = state.range(0);
+
+  while (state.KeepRunning()) {
+    const fml::TimePoint target_time = fml::TimePoint::Now() + delay;
 
     std::vector<std::thread> threads;
 
-    CountDownLatch tasks_registered(num_task_queues);
-    CountDownLatch tasks_done(num_task_queues);
+    CountDownLatch tasks_registered(kNumTaskQueues);
+    CountDownLatch tasks_done(kNumTaskQueues);
 
-    for (int i = 0; i < num_task_queues; i++) {
-      threads.emplace_back([task_runner_id = i, &task_queue, past, &tasks_done,
-                            &tasks_registered]() {
+    for (int i = 0; i < kNumTaskQueues; i++) {
+      threads.emplace_back([queue_id = queue_ids[i], &task_queue, target_time,
+                            num_tasks_per_queue, &tasks_done, &tasks_registered,
+                            &flush]() {
         for (int j = 0; j < num_tasks_per_queue; j++) {
           task_queue->RegisterTask(
-              TaskQueueId(task_runner_id), [] {}, past);
+              queue_id, [] {}, target_time);
         }
         tasks_registered.CountDown();
         tasks_registered.Wait();
-        std::vector<fml::closure> invocations;
-        task_queue->GetTasksToRunNow(TaskQueueId(task_runner_id),
-                                     fml::FlushType::kAll, invocations);
-        assert(invocations.size() == num_tasks_per_queue);
+        const size_t flushed = flush(task_queue, queue_id, target_time);
+        assert(flushed == static_cast<size_t>(num_tasks_per_queue));
+        (void)flushed;
         tasks_done.CountDown();
       });
     }
@@ -53,9 +66,65 @@ static void BM_RegisterAndGetTasks(benchmark::State& state) {
       thread.join();
     }
   }
+  state.SetItemsProcessed(state.iterations() * kNumTaskQueues *
+                          num_tasks_per_queue);
+}
+
+static size_t FlushIntoVector(const fml::RefPtr<MessageLoopTaskQueues>& queues,
+                              TaskQueueId queue_id,
+                              fml::TimePoint now) {
+  std::vector<fml::closure> invocations;
+  queues->GetTasksToRunNow(queue_id, fml::FlushType::kAll, invocations);
+  return invocations.size();
+}
+
+static size_t FlushInBatches(const fml::RefPtr<MessageLoopTaskQueues>& queues,
+                             TaskQueueId queue_id,
+                             fml::TimePoint now) {
+  std::array<fml::closure, 16> invocations;
+  size_t total = 0;
+  while (true) {
+    const size_t count =
+        queues->GetTasksToRunNow(queue_id, fml::FlushType::kAll, now,
+                                 invocations.data(), invocations.size());
+    for (size_t i = 0; i < count; i++) {
+      invocations[i] = nullptr;
+    }
+    total += count;
+    if (count < invocations.size()) {
+      return total;
+    }
+  }
+}
+
+// Tasks that are runnable when registered go through the immediate queue.
+static void BM_RegisterAndGetTasks(benchmark::State& state) {
+  RegisterAndGetTasks(state, fml::TimeDelta::Zero(), FlushIntoVector);
+}
+
+static void BM_RegisterAndGetTasksInBatches(benchmark::State& state) {
+  RegisterAndGetTasks(state, fml::TimeDelta::Zero(), FlushInBatches);
+}
+
+// Tasks registered for the future go through the delayed task heap. They are
+// flushed as if the flush happened once they were due.
+static void BM_RegisterAndGetDelayedTasksInBatches(benchmark::State& state) {
+  RegisterAndGetTasks(state, fml::TimeDelta::FromSeconds(1), FlushInBatches);
 }
 
-BENCHMARK(BM_RegisterAndGetTasks);
+// The work happens on the spawned threads, so measure wall time.
+BENCHMARK(BM_RegisterAndGetTasks)
+    ->RangeMultiplier(10)
+    ->Range(10, 1000)
+    ->UseRealTime();
+BENCHMARK(BM_RegisterAndGetTasksInBatches)
+    ->RangeMultiplier(10)
+    ->Range(10, 1000)
+    ->UseRealTime();
+BENCHMARK(BM_RegisterAndGetDelayedTasksInBatches)
+    ->RangeMultiplier(10)
+    ->Range(10, 1000)
+    ->UseRealTime();
 
 }  // namespace benchmarking
 }  // namespace fml
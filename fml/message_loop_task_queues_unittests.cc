@@ -81,6 +81,110 @@ TEST(MessageLoopTaskQueue, PreserveTaskOrdering) {
   }
 }
 
+TEST(MessageLoopTaskQueue, RunnableTasksRunInTargetTimeOrder) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  const auto now = fml::TimePoint::Now();
+  std::vector<int> order;
+
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(2); },
+      now - fml::TimeDelta::FromMilliseconds(10));
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(1); },
+      now - fml::TimeDelta::FromMilliseconds(20));
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(3); }, now);
+  task_queue->RegisterTask(
+      queue_id, [&order]() { order.push_back(4); },
+      now - fml::TimeDelta::FromMilliseconds(10));
+
+  std::vector<fml::closure> invocations;
+  task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll, invocations);
+  for (auto& invocation : invocations) {
+    invocation();
+  }
+
+  // Tasks with the same target time run in the order they were registered.
+  ASSERT_EQ(order, (std::vector<int>{1, 2, 4, 3}));
+}
+
+TEST(MessageLoopTaskQueue, GetTasksToRunNowInBatches) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  const auto now = fml::TimePoint::Now();
+  int test_val = 0;
+
+  for (int i = 0; i < 3; i++) {
+    task_queue->RegisterTask(
+        queue_id, [&test_val, i]() { test_val = test_val * 10 + i + 1; },
+        now);
+  }
+  task_queue->RegisterTask(
+      queue_id, [] {}, now + fml::TimeDelta::FromSeconds(10));
+
+  fml::closure invocations[2];
+  ASSERT_EQ(task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll, now,
+                                         invocations, 2),
+            2u);
+  invocations[0]();
+  invocations[1]();
+  ASSERT_EQ(task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll, now,
+                                         invocations, 2),
+            1u);
+  invocations[0]();
+  ASSERT_EQ(test_val, 123);
+
+  // The delayed task is not runnable yet.
+  ASSERT_EQ(task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kAll, now,
+                                         invocations, 2),
+            0u);
+  ASSERT_EQ(task_queue->GetNumPendingTasks(queue_id), 1u);
+}
+
+TEST(MessageLoopTaskQueue, GetSingleTaskToRunNow) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  const auto now = fml::TimePoint::Now();
+
+  task_queue->RegisterTask(
+      queue_id, [] {}, now);
+  task_queue->RegisterTask(
+      queue_id, [] {}, now);
+
+  fml::closure invocations[4];
+  ASSERT_EQ(task_queue->GetTasksToRunNow(queue_id, fml::FlushType::kSingle,
+                                         now, invocations, 4),
+            1u);
+  ASSERT_EQ(task_queue->GetNumPendingTasks(queue_id), 1u);
+}
+
+TEST(MessageLoopTaskQueue, GetTasksToRunNowClearsStaleWakeUps) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto owner = task_queue->CreateTaskQueue();
+  auto subsumed = task_queue->CreateTaskQueue();
+  const auto now = fml::TimePoint::Now();
+  fml::TimePoint wake_time;
+  task_queue->SetWakeable(subsumed,
+                          new TestWakeable([&wake_time](fml::TimePoint time) {
+                            wake_time = time;
+                          }));
+
+  task_queue->RegisterTask(
+      subsumed, [] {}, now);
+  ASSERT_TRUE(wake_time == now);
+
+  // The task now runs on the owner, so the subsumed queue has nothing to wake
+  // up for.
+  ASSERT_TRUE(task_queue->Merge(owner, subsumed));
+  fml::closure invocations[1];
+  ASSERT_EQ(task_queue->GetTasksToRunNow(subsumed, fml::FlushType::kAll, now,
+                                         invocations, 1),
+            0u);
+  ASSERT_TRUE(wake_time == fml::TimePoint::Max());
+  ASSERT_TRUE(task_queue->Unmerge(owner));
+}
+
 void TestNotifyObservers(fml::TaskQueueId queue_id) {
   auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
   std::vector<fml::closure> observers =
@@ -4,8 +4,11 @@
 
 #define FML_USED_ON_EMBEDDER
 
+#include <atomic>
 #include <iostream>
+#include <set>
 #include <thread>
+#include <vector>
 
 #include "flutter/fml/build_config.h"
 #include "flutter/fml/concurrent_message_loop.h"
@@ -15,6 +18,12 @@
 #include "flutter/fml/task_runner.h"
 #include "gtest/gtest.h"
 
+#if OS_LINUX
+#include <unistd.h>
+
+#include "flutter/fml/unique_fd.h"
+#endif  // OS_LINUX
+
 #define TIME_SENSITIVE(x) TimeSensitiveTest_##x
 #if OS_WIN
 #define PLATFORM_SPECIFIC_CAPTURE(...) [ __VA_ARGS__, count ]
@@ -283,6 +292,109 @@ TEST(MessageLoop, TaskObserverFire) {
   ASSERT_TRUE(terminated);
 }
 
+#if OS_LINUX
+
+struct Pipe {
+  fml::UniqueFD read_end;
+  fml::UniqueFD write_end;
+
+  Pipe() {
+    int fds[2] = {};
+    FML_CHECK(::pipe(fds) == 0);
+    read_end.reset(fds[0]);
+    write_end.reset(fds[1]);
+  }
+};
+
+TEST(MessageLoop, CanWatchFileDescriptors) {
+  Pipe pipe;
+  std::thread thread([&pipe]() {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    auto& loop = fml::MessageLoop::GetCurrent();
+    auto task_runner = loop.GetTaskRunner();
+    std::string received;
+    ASSERT_TRUE(task_runner->AddFileDescriptorWatch(
+        pipe.read_end.get(), fml::kFileDescriptorReadable,
+        [&](int fd, uint32_t events) {
+          ASSERT_EQ(fd, pipe.read_end.get());
+          ASSERT_TRUE(events & fml::kFileDescriptorReadable);
+          char buffer[16] = {};
+          const auto size = ::read(fd, buffer, sizeof(buffer));
+          ASSERT_GT(size, 0);
+          received.append(buffer, size);
+          if (received == "hello") {
+            ASSERT_TRUE(task_runner->RemoveFileDescriptorWatch(fd));
+            loop.Terminate();
+          }
+        }));
+    // The same file descriptor may not be watched twice.
+    ASSERT_FALSE(task_runner->AddFileDescriptorWatch(
+        pipe.read_end.get(), fml::kFileDescriptorReadable,
+        [](int fd, uint32_t events) {}));
+    task_runner->PostTask(
+        [&pipe]() { ASSERT_EQ(::write(pipe.write_end.get(), "hel", 3), 3); });
+    task_runner->PostDelayedTask(
+        [&pipe]() { ASSERT_EQ(::write(pipe.write_end.get(), "lo", 2), 2); },
+        fml::TimeDelta::FromMilliseconds(10));
+    loop.Run();
+    ASSERT_EQ(received, "hello");
+  });
+  thread.join();
+}
+
+TEST(MessageLoop, HandlesAllFileDescriptorsReadyAtOnce) {
+  const size_t kCount = 40;
+  std::vector<Pipe> pipes(kCount);
+  for (auto& pipe : pipes) {
+    ASSERT_EQ(::write(pipe.write_end.get(), "x", 1), 1);
+  }
+  std::thread thread([&pipes]() {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    auto& loop = fml::MessageLoop::GetCurrent();
+    std::set<int> handled;
+    for (auto& pipe : pipes) {
+      ASSERT_TRUE(loop.AddFileDescriptorWatch(
+          pipe.read_end.get(), fml::kFileDescriptorReadable,
+          [&](int fd, uint32_t events) {
+            char buffer = 0;
+            ASSERT_EQ(::read(fd, &buffer, 1), 1);
+            // Watches removed by an earlier handler are not reported.
+            ASSERT_EQ(handled.count(fd), 0u);
+            handled.insert(fd);
+            ASSERT_TRUE(loop.RemoveFileDescriptorWatch(fd));
+            if (handled.size() == pipes.size()) {
+              loop.Terminate();
+            }
+          }));
+    }
+    loop.Run();
+    ASSERT_EQ(handled.size(), pipes.size());
+  });
+  thread.join();
+}
+
+TEST(MessageLoop, ReportsErrorsOnWatchedFileDescriptors) {
+  Pipe pipe;
+  pipe.write_end.reset();
+  std::thread thread([&pipe]() {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    auto& loop = fml::MessageLoop::GetCurrent();
+    uint32_t reported_events = 0;
+    ASSERT_TRUE(loop.AddFileDescriptorWatch(
+        pipe.read_end.get(), fml::kFileDescriptorReadable,
+        [&](int fd, uint32_t events) {
+          reported_events = events;
+          loop.RemoveFileDescriptorWatch(fd);
+          loop.Terminate();
+        }));
+    loop.Run();
+    ASSERT_TRUE(reported_events & fml::kFileDescriptorError);
+  });
+  thread.join();
+}
+
+#endif  // OS_LINUX
+
 TEST(MessageLoop, CanCreateAndShutdownConcurrentMessageLoopsOverAndOver) {
   for (size_t i = 0; i < 10; ++i) {
     auto loop = fml::ConcurrentMessageLoop::Create(i + 1);
@@ -290,6 +402,68 @@ TEST(MessageLoop, CanCreateAndShutdownConcurrentMessageLoopsOverAndOver) {
   }
 }
 
+TEST(MessageLoop, ConcurrentMessageLoopRunsBatchedTasks) {
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  auto task_runner = loop->GetTaskRunner();
+  const size_t kCount = 1000;
+  fml::CountDownLatch latch(kCount);
+  std::atomic_size_t runs = 0;
+  std::vector<fml::closure> tasks;
+  for (size_t i = 0; i < kCount; ++i) {
+    tasks.push_back([&]() {
+      runs++;
+      latch.CountDown();
+    });
+  }
+  task_runner->PostTasks(std::move(tasks));
+  latch.Wait();
+  ASSERT_EQ(runs.load(), kCount);
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopRunsTasksPostedFromWorkers) {
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  auto task_runner = loop->GetTaskRunner();
+  const size_t kCount = 100;
+  fml::CountDownLatch latch(kCount);
+  for (size_t i = 0; i < kCount; ++i) {
+    task_runner->PostTask([&latch, task_runner]() {
+      task_runner->PostTask([&latch]() { latch.CountDown(); },
+                            fml::ConcurrentTaskPriority::kBackground);
+    });
+  }
+  latch.Wait();
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopPrefersHigherPriorityTasks) {
+  auto loop = fml::ConcurrentMessageLoop::Create(1);
+  auto task_runner = loop->GetTaskRunner();
+  fml::AutoResetWaitableEvent blocker;
+  fml::CountDownLatch latch(3);
+  std::mutex order_mutex;
+  std::vector<fml::ConcurrentTaskPriority> order;
+  auto record = [&](fml::ConcurrentTaskPriority priority) {
+    return [&, priority]() {
+      std::scoped_lock lock(order_mutex);
+      order.push_back(priority);
+      latch.CountDown();
+    };
+  };
+  // Keep the only worker busy until all tasks are queued.
+  task_runner->PostTask([&blocker]() { blocker.Wait(); });
+  task_runner->PostTask(record(fml::ConcurrentTaskPriority::kBackground),
+                        fml::ConcurrentTaskPriority::kBackground);
+  task_runner->PostTask(record(fml::ConcurrentTaskPriority::kNormal),
+                        fml::ConcurrentTaskPriority::kNormal);
+  task_runner->PostTask(record(fml::ConcurrentTaskPriority::kHigh),
+                        fml::ConcurrentTaskPriority::kHigh);
+  blocker.Signal();
+  latch.Wait();
+  ASSERT_EQ(order.size(), 3u);
+  ASSERT_EQ(order[0], fml::ConcurrentTaskPriority::kHigh);
+  ASSERT_EQ(order[1], fml::ConcurrentTaskPriority::kNormal);
+  ASSERT_EQ(order[2], fml::ConcurrentTaskPriority::kBackground);
+}
+
 TEST(MessageLoop, CanCreateConcurrentMessageLoop) {
   auto loop = fml::ConcurrentMessageLoop::Create();
   auto task_runner = loop->GetTaskRunner();
@@ -0,0 +1,375 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/platform/linux/io_uring_file_reader.h"
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "flutter/fml/eintr_wrapper.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/make_copyable.h"
+#include "flutter/fml/trace_event.h"
+
+// Older sysroots have neither the header nor the system calls.
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define FML_HAS_IO_URING 1
+#endif
+
+namespace fml {
+
+#if FML_HAS_IO_URING
+
+// The most reads the kernel works on at once. Any others wait for a slot.
+static constexpr unsigned kRingEntries = 64;
+
+namespace {
+
+struct PendingRead {
+  fml::UniqueFD file;
+  std::vector<uint8_t> data;
+  size_t offset = 0;
+  struct iovec iov = {};
+  fml::RefPtr<fml::TaskRunner> reply_runner;
+  AsyncFileReader::ReadCallback callback;
+};
+
+}  // namespace
+
+class IOUringFileReader::Ring {
+ public:
+  static std::shared_ptr<Ring> Create() {
+    struct io_uring_params params = {};
+    fml::UniqueFD ring_fd(static_cast<int>(
+        ::syscall(__NR_io_uring_setup, kRingEntries, &params)));
+    if (!ring_fd.is_valid()) {
+      return nullptr;
+    }
+    auto ring = std::shared_ptr<Ring>(new Ring(std::move(ring_fd)));
+    if (!ring->Map(params)) {
+      return nullptr;
+    }
+    return ring;
+  }
+
+  // Waits for the reads the kernel is still working on, since it writes into
+  // their buffers.
+  ~Ring() {
+    shutting_down_ = true;
+    while (!in_flight_.empty()) {
+      if (Enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+        FML_LOG(ERROR) << "Could not wait for the reads in flight.";
+        // Leak the buffers rather than let the kernel write into freed memory.
+        for (auto& read : in_flight_) {
+          read.second.release();
+        }
+        break;
+      }
+      Reap();
+    }
+    if (sqes_ != MAP_FAILED) {
+      ::munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != MAP_FAILED) {
+      ::munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) {
+      ::munmap(sq_ring_, sq_ring_size_);
+    }
+  }
+
+  int GetFD() const { return ring_fd_.get(); }
+
+  // May be called on any thread. Reads that have not been handed to the kernel
+  // yet are dropped, and no more callbacks are called.
+  void OnReaderDestroyed() { *reader_destroyed_ = true; }
+
+  void Read(std::unique_ptr<PendingRead> read) {
+    if (*reader_destroyed_) {
+      return;
+    }
+    struct stat stat_buffer = {};
+    if (::fstat(read->file.get(), &stat_buffer) != 0) {
+      Reply(std::move(read), false);
+      return;
+    }
+    read->data.resize(stat_buffer.st_size);
+    if (read->data.empty()) {
+      Reply(std::move(read), true);
+      return;
+    }
+    if (in_flight_.size() < sq_entries_) {
+      Submit(std::move(read));
+      Flush();
+    } else {
+      waiting_.push_back(std::move(read));
+    }
+  }
+
+  // Handles the completed reads.
+  void Reap() {
+    unsigned head = *cq_head_;
+    const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    std::vector<std::pair<uint64_t, int32_t>> completions;
+    while (head != tail) {
+      const struct io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+      completions.emplace_back(cqe.user_data, cqe.res);
+      head++;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+    for (const auto& completion : completions) {
+      OnReadCompleted(completion.first, completion.second);
+    }
+
+    if (*reader_destroyed_) {
+      waiting_.clear();
+    }
+    while (!shutting_down_ && !waiting_.empty() &&
+           in_flight_.size() < sq_entries_) {
+      Submit(std::move(waiting_.front()));
+      waiting_.pop_front();
+    }
+    Flush();
+  }
+
+ private:
+  fml::UniqueFD ring_fd_;
+  void* sq_ring_ = MAP_FAILED;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = MAP_FAILED;
+  size_t cq_ring_size_ = 0;
+  struct io_uring_sqe* sqes_ = static_cast<struct io_uring_sqe*>(MAP_FAILED);
+  size_t sqes_size_ = 0;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_mask_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_entries_ = 0;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned* cq_mask_ = nullptr;
+  struct io_uring_cqe* cqes_ = nullptr;
+  // Entries added to the submission queue that the kernel has not taken yet.
+  unsigned unsubmitted_ = 0;
+  uint64_t last_read_id_ = 0;
+  std::map<uint64_t, std::unique_ptr<PendingRead>> in_flight_;
+  std::deque<std::unique_ptr<PendingRead>> waiting_;
+  bool shutting_down_ = false;
+  // Shared with the replies that have been posted already.
+  const std::shared_ptr<std::atomic_bool> reader_destroyed_ =
+      std::make_shared<std::atomic_bool>(false);
+
+  explicit Ring(fml::UniqueFD ring_fd) : ring_fd_(std::move(ring_fd)) {}
+
+  bool Map(const struct io_uring_params& params) {
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_.get(),
+                      IORING_OFF_SQ_RING);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    cq_ring_ = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_.get(),
+                      IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = static_cast<struct io_uring_sqe*>(
+        ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, ring_fd_.get(), IORING_OFF_SQES));
+    if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED ||
+        sqes_ == MAP_FAILED) {
+      return false;
+    }
+
+    auto* sq_ring = static_cast<uint8_t*>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.array);
+    sq_entries_ = params.sq_entries;
+
+    auto* cq_ring = static_cast<uint8_t*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq_ring +
+                                                   params.cq_off.cqes);
+    return true;
+  }
+
+  int Enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd_.get(),
+                                      to_submit, min_complete, flags, nullptr,
+                                      0));
+  }
+
+  // Adds a read of the rest of the file to the submission queue. Only the
+  // kernel reads the head of the queue, and only this thread writes its tail.
+  void Submit(std::unique_ptr<PendingRead> read) {
+    const uint64_t id = ++last_read_id_;
+    read->iov.iov_base = read->data.data() + read->offset;
+    read->iov.iov_len = read->data.size() - read->offset;
+
+    const unsigned tail = *sq_tail_;
+    const unsigned index = tail & *sq_mask_;
+    struct io_uring_sqe& sqe = sqes_[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READV;
+    sqe.fd = read->file.get();
+    sqe.addr = reinterpret_cast<uint64_t>(&read->iov);
+    sqe.len = 1;
+    sqe.off = read->offset;
+    sqe.user_data = id;
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+    unsubmitted_++;
+    in_flight_[id] = std::move(read);
+  }
+
+  // Hands the submission queue to the kernel. Entries it does not take now
+  // are handed again with the next ones.
+  void Flush() {
+    while (unsubmitted_ > 0) {
+      const int submitted = Enter(unsubmitted_, 0, 0);
+      if (submitted < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        FML_DLOG(ERROR) << "Could not submit reads: " << strerror(errno);
+        return;
+      }
+      unsubmitted_ -= submitted;
+    }
+  }
+
+  void OnReadCompleted(uint64_t id, int32_t result) {
+    auto found = in_flight_.find(id);
+    if (found == in_flight_.end()) {
+      return;
+    }
+    std::unique_ptr<PendingRead> read = std::move(found->second);
+    in_flight_.erase(found);
+
+    if (shutting_down_ || *reader_destroyed_) {
+      return;
+    }
+
+    if (result == -EINTR || result == -EAGAIN) {
+      Submit(std::move(read));
+      return;
+    }
+    if (result < 0) {
+      Reply(std::move(read), false);
+      return;
+    }
+    read->offset += result;
+    if (result == 0) {
+      // The file got shorter since it was opened.
+      read->data.resize(read->offset);
+    }
+    if (read->offset < read->data.size()) {
+      Submit(std::move(read));
+      return;
+    }
+    Reply(std::move(read), true);
+  }
+
+  void Reply(std::unique_ptr<PendingRead> read, bool success) {
+    std::unique_ptr<Mapping> contents;
+    if (success) {
+      contents = std::make_unique<DataMapping>(std::move(read->data));
+    }
+    read->reply_runner->PostTask(fml::MakeCopyable(
+        [reader_destroyed = reader_destroyed_,
+         callback = std::move(read->callback),
+         contents = std::move(contents)]() mutable {
+          if (!*reader_destroyed) {
+            callback(std::move(contents));
+          }
+        }));
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(Ring);
+};
+
+// static
+std::unique_ptr<IOUringFileReader> IOUringFileReader::Create(
+    fml::RefPtr<fml::TaskRunner> task_runner) {
+  TRACE_EVENT0("flutter", "IOUringFileReader::Create");
+  auto ring = Ring::Create();
+  if (!ring) {
+    return nullptr;
+  }
+  std::weak_ptr<Ring> weak_ring = ring;
+  if (!task_runner->AddFileDescriptorWatch(
+          ring->GetFD(), kFileDescriptorReadable,
+          [weak_ring](int fd, uint32_t events) {
+            if (auto ring = weak_ring.lock()) {
+              ring->Reap();
+            }
+          })) {
+    return nullptr;
+  }
+  return std::unique_ptr<IOUringFileReader>(
+      new IOUringFileReader(std::move(task_runner), std::move(ring)));
+}
+
+IOUringFileReader::IOUringFileReader(fml::RefPtr<fml::TaskRunner> task_runner,
+                                     std::shared_ptr<Ring> ring)
+    : task_runner_(std::move(task_runner)), ring_(std::move(ring)) {}
+
+IOUringFileReader::~IOUringFileReader() {
+  task_runner_->RemoveFileDescriptorWatch(ring_->GetFD());
+  ring_->OnReaderDestroyed();
+  // The last of the tasks posted by |Read| destroys the ring.
+}
+
+void IOUringFileReader::Read(fml::UniqueFD file,
+                             fml::RefPtr<fml::TaskRunner> reply_runner,
+                             ReadCallback callback) {
+  auto read = std::make_unique<PendingRead>();
+  read->file = std::move(file);
+  read->reply_runner = std::move(reply_runner);
+  read->callback = std::move(callback);
+  task_runner_->PostTask(fml::MakeCopyable(
+      [ring = ring_, read = std::move(read)]() mutable {
+        ring->Read(std::move(read));
+      }));
+}
+
+#else  // FML_HAS_IO_URING
+
+class IOUringFileReader::Ring {};
+
+// static
+std::unique_ptr<IOUringFileReader> IOUringFileReader::Create(
+    fml::RefPtr<fml::TaskRunner> task_runner) {
+  return nullptr;
+}
+
+IOUringFileReader::IOUringFileReader(fml::RefPtr<fml::TaskRunner> task_runner,
+                                     std::shared_ptr<Ring> ring)
+    : task_runner_(std::move(task_runner)), ring_(std::move(ring)) {}
+
+IOUringFileReader::~IOUringFileReader() = default;
+
+void IOUringFileReader::Read(fml::UniqueFD file,
+                             fml::RefPtr<fml::TaskRunner> reply_runner,
+                             ReadCallback callback) {
+  FML_DCHECK(false);
+}
+
+#endif  // FML_HAS_IO_URING
+
+}  // namespace fml
@@ -0,0 +1,47 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_PLATFORM_LINUX_IO_URING_FILE_READER_H_
+#define FLUTTER_FML_PLATFORM_LINUX_IO_URING_FILE_READER_H_
+
+#include <memory>
+
+#include "flutter/fml/async_file_reader.h"
+#include "flutter/fml/macros.h"
+
+namespace fml {
+
+// Hands the reads to the kernel through an io_uring, whose completions are
+// picked up on the message loop of a task runner. The ring is only touched on
+// the thread of that task runner.
+class IOUringFileReader final : public AsyncFileReader {
+ public:
+  // Returns nullptr if the kernel does not allow io_uring, like those older
+  // than 5.1 or sandboxes that filter it out, or if the message loop of
+  // |task_runner| cannot watch file descriptors.
+  static std::unique_ptr<IOUringFileReader> Create(
+      fml::RefPtr<fml::TaskRunner> task_runner);
+
+  ~IOUringFileReader() override;
+
+  // |AsyncFileReader|
+  void Read(fml::UniqueFD file,
+            fml::RefPtr<fml::TaskRunner> reply_runner,
+            ReadCallback callback) override;
+
+ private:
+  class Ring;
+
+  const fml::RefPtr<fml::TaskRunner> task_runner_;
+  std::shared_ptr<Ring> ring_;
+
+  IOUringFileReader(fml::RefPtr<fml::TaskRunner> task_runner,
+                    std::shared_ptr<Ring> ring);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(IOUringFileReader);
+};
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_PLATFORM_LINUX_IO_URING_FILE_READER_H_
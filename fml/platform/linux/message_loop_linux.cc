@@ -14,6 +14,10 @@ namespace fml {
 
 static constexpr int kClockType = CLOCK_MONOTONIC;
 
+// The most events handled for each wait. Any others are picked up by the next
+// wait.
+static constexpr int kMaxEvents = 16;
+
 MessageLoopLinux::MessageLoopLinux()
     : epoll_fd_(FML_HANDLE_EINTR(::epoll_create(1 /* unused */))),
       timer_fd_(::timerfd_create(kClockType, TFD_NONBLOCK | TFD_CLOEXEC)),
@@ -48,26 +52,29 @@ void MessageLoopLinux::Run() {
   running_ = true;
 
   while (running_) {
-    struct epoll_event event = {};
+    struct epoll_event events[kMaxEvents] = {};
 
     int epoll_result = FML_HANDLE_EINTR(
-        ::epoll_wait(epoll_fd_.get(), &event, 1, -1 /* timeout */));
-
-    // Errors are fatal.
-    if (event.events & (EPOLLERR | EPOLLHUP)) {
-      running_ = false;
-      continue;
-    }
+        ::epoll_wait(epoll_fd_.get(), events, kMaxEvents, -1 /* timeout */));
 
     // Timeouts are fatal since we specified an infinite timeout already.
-    // Likewise, > 1 is not possible since we waited for one result.
-    if (epoll_result != 1) {
+    if (epoll_result <= 0) {
       running_ = false;
       continue;
     }
 
-    if (event.data.fd == timer_fd_.get()) {
-      OnEventFired();
+    for (int i = 0; i < epoll_result && running_; i++) {
+      const struct epoll_event& event = events[i];
+      if (event.data.fd == timer_fd_.get()) {
+        // Errors on the timer are fatal.
+        if (event.events & (EPOLLERR | EPOLLHUP)) {
+          running_ = false;
+          continue;
+        }
+        OnEventFired();
+      } else {
+        OnFileDescriptorReady(event.data.fd, event.events);
+      }
     }
   }
 }
@@ -84,6 +91,74 @@ void MessageLoopLinux::WakeUp(fml::TimePoint time_point) {
   FML_DCHECK(result);
 }
 
+// |fml::MessageLoopImpl|
+bool MessageLoopLinux::AddFileDescriptorWatch(
+    int fd,
+    uint32_t events,
+    const FileDescriptorHandler& handler) {
+  if (fd < 0 || fd == timer_fd_.get() || !handler) {
+    return false;
+  }
+
+  struct epoll_event event = {};
+  if (events & kFileDescriptorReadable) {
+    event.events |= EPOLLIN;
+  }
+  if (events & kFileDescriptorWritable) {
+    event.events |= EPOLLOUT;
+  }
+  event.data.fd = fd;
+
+  std::scoped_lock lock(watches_mutex_);
+  if (watches_.count(fd) != 0) {
+    return false;
+  }
+  if (::epoll_ctl(epoll_fd_.get(), EPOLL_CTL_ADD, fd, &event) != 0) {
+    return false;
+  }
+  watches_[fd] = std::make_shared<FileDescriptorHandler>(handler);
+  return true;
+}
+
+// |fml::MessageLoopImpl|
+bool MessageLoopLinux::RemoveFileDescriptorWatch(int fd) {
+  std::scoped_lock lock(watches_mutex_);
+  auto found = watches_.find(fd);
+  if (found == watches_.end()) {
+    return false;
+  }
+  watches_.erase(found);
+  // The file descriptor may already be closed, in which case epoll has
+  // already forgotten about it.
+  ::epoll_ctl(epoll_fd_.get(), EPOLL_CTL_DEL, fd, nullptr);
+  return true;
+}
+
+void MessageLoopLinux::OnFileDescriptorReady(int fd, uint32_t epoll_events) {
+  std::shared_ptr<FileDescriptorHandler> handler;
+  {
+    std::scoped_lock lock(watches_mutex_);
+    auto found = watches_.find(fd);
+    if (found == watches_.end()) {
+      // Removed by a handler that ran earlier for the same wait.
+      return;
+    }
+    handler = found->second;
+  }
+
+  uint32_t events = 0;
+  if (epoll_events & EPOLLIN) {
+    events |= kFileDescriptorReadable;
+  }
+  if (epoll_events & EPOLLOUT) {
+    events |= kFileDescriptorWritable;
+  }
+  if (epoll_events & (EPOLLERR | EPOLLHUP)) {
+    events |= kFileDescriptorError;
+  }
+  (*handler)(fd, events);
+}
+
 void MessageLoopLinux::OnEventFired() {
   if (TimerDrain(timer_fd_.get())) {
     RunExpiredTasksNow();
@@ -6,6 +6,9 @@
 #define FLUTTER_FML_PLATFORM_LINUX_MESSAGE_LOOP_LINUX_H_
 
 #include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
 
 #include "flutter/fml/macros.h"
 #include "flutter/fml/message_loop_impl.h"
@@ -18,6 +21,10 @@ class MessageLoopLinux : public MessageLoopImpl {
   fml::UniqueFD epoll_fd_;
   fml::UniqueFD timer_fd_;
   bool running_;
+  std::mutex watches_mutex_;
+  // Shared with the handlers that are running, so that a handler may remove
+  // its own watch.
+  std::map<int, std::shared_ptr<FileDescriptorHandler>> watches_;
 
   MessageLoopLinux();
 
@@ -32,8 +39,18 @@ class MessageLoopLinux : public MessageLoopImpl {
   // |fml::MessageLoopImpl|
   void WakeUp(fml::TimePoint time_point) override;
 
+  // |fml::MessageLoopImpl|
+  bool AddFileDescriptorWatch(int fd,
+                              uint32_t events,
+                              const FileDescriptorHandler& handler) override;
+
+  // |fml::MessageLoopImpl|
+  bool RemoveFileDescriptorWatch(int fd) override;
+
   void OnEventFired();
 
+  void OnFileDescriptorReady(int fd, uint32_t epoll_events);
+
   bool AddOrRemoveTimerSource(bool add);
 
   FML_FRIEND_MAKE_REF_COUNTED(MessageLoopLinux);
@@ -39,6 +39,22 @@ TaskQueueId TaskRunner::GetTaskQueueId() {
   return loop_->GetTaskQueueId();
 }
 
+bool TaskRunner::AddFileDescriptorWatch(int fd,
+                                        uint32_t events,
+                                        const FileDescriptorHandler& handler) {
+  if (!loop_) {
+    return false;
+  }
+  return loop_->AddFileDescriptorWatch(fd, events, handler);
+}
+
+bool TaskRunner::RemoveFileDescriptorWatch(int fd) {
+  if (!loop_) {
+    return false;
+  }
+  return loop_->RemoveFileDescriptorWatch(fd);
+}
+
 bool TaskRunner::RunsTasksOnCurrentThread() {
   if (!fml::MessageLoop::IsInitializedForCurrentThread()) {
     return false;
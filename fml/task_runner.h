@@ -5,6 +5,8 @@
 #ifndef FLUTTER_FML_TASK_RUNNER_H_
 #define FLUTTER_FML_TASK_RUNNER_H_
 
+#include <functional>
+
 #include "flutter/fml/closure.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_counted.h"
@@ -16,6 +18,18 @@ namespace fml {
 
 class MessageLoopImpl;
 
+// What a watched file descriptor is ready for. These are bit flags.
+enum FileDescriptorEvent : uint32_t {
+  kFileDescriptorReadable = 1 << 0,
+  kFileDescriptorWritable = 1 << 1,
+  // Reported whether or not it was asked for.
+  kFileDescriptorError = 1 << 2,
+};
+
+// Called on the thread of the message loop with the |FileDescriptorEvent|s the
+// file descriptor is ready for.
+using FileDescriptorHandler = std::function<void(int fd, uint32_t events)>;
+
 class TaskRunner : public fml::RefCountedThreadSafe<TaskRunner> {
  public:
   virtual ~TaskRunner();
@@ -31,6 +45,21 @@ class TaskRunner : public fml::RefCountedThreadSafe<TaskRunner> {
 
   virtual TaskQueueId GetTaskQueueId();
 
+  // Calls |handler| on the thread this task runner runs tasks on whenever |fd|
+  // is ready for any of the |FileDescriptorEvent|s in |events|, until the
+  // watch is removed. The handler must make progress on the file descriptor,
+  // or it will be called again right away. Returns false if the message loop
+  // cannot watch file descriptors, which so far only the one on Linux does, or
+  // if |fd| is already watched.
+  virtual bool AddFileDescriptorWatch(int fd,
+                                      uint32_t events,
+                                      const FileDescriptorHandler& handler);
+
+  // Stops watching |fd|. Once this returns on the thread of the task runner,
+  // the handler of the watch is not called again. It may still be running
+  // when this returns on other threads.
+  virtual bool RemoveFileDescriptorWatch(int fd);
+
   static void RunNowOrPostTask(fml::RefPtr<fml::TaskRunner> runner,
                                const fml::closure& task);
 
@@ -0,0 +1,660 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/trace_buffer.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_set>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/thread_local.h"
+
+namespace fml {
+namespace tracing {
+
+namespace internal {
+
+std::atomic_bool gTraceBufferRecording = {false};
+
+}  // namespace internal
+
+static_assert(std::is_trivially_copyable<TraceRecord>::value,
+              "Trace records are copied out of the buffers byte by byte.");
+
+namespace {
+
+// The ring buffer of one thread. Only that thread writes records, any thread
+// may copy them. Every slot has a sequence number that is odd while the
+// record in it is written, so that copies can tell that a record was
+// overwritten while it was copied.
+class ThreadTraceBuffer {
+ public:
+  ThreadTraceBuffer(int64_t thread_id,
+                    std::string thread_name,
+                    size_t capacity,
+                    uint64_t generation)
+      : thread_id_(thread_id),
+        capacity_(capacity),
+        generation_(generation),
+        slots_(std::make_unique<Slot[]>(capacity)),
+        thread_name_(std::move(thread_name)) {}
+
+  int64_t thread_id() const { return thread_id_; }
+
+  uint64_t generation() const { return generation_; }
+
+  // Only called on the thread that owns the buffer, and followed by
+  // |EndWrite|.
+  TraceRecord& BeginWrite() {
+    const uint64_t index = next_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[index % capacity_];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return slot.record;
+  }
+
+  void EndWrite() {
+    const uint64_t index = next_.load(std::memory_order_relaxed);
+    slots_[index % capacity_].sequence.store(2 * index + 2,
+                                             std::memory_order_release);
+    next_.store(index + 1, std::memory_order_release);
+  }
+
+  std::vector<TraceRecord> CopyRecords() const {
+    const uint64_t end = next_.load(std::memory_order_acquire);
+    const uint64_t begin = end > capacity_ ? end - capacity_ : 0;
+    std::vector<TraceRecord> records;
+    records.reserve(end - begin);
+    for (uint64_t index = begin; index < end; index++) {
+      const Slot& slot = slots_[index % capacity_];
+      const uint64_t written = 2 * index + 2;
+      if (slot.sequence.load(std::memory_order_acquire) != written) {
+        continue;
+      }
+      TraceRecord record;
+      std::memcpy(&record, &slot.record, sizeof(TraceRecord));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) != written) {
+        continue;
+      }
+      records.push_back(record);
+    }
+    return records;
+  }
+
+  // Guarded by |gBuffersMutex|.
+  const std::string& thread_name() const { return thread_name_; }
+
+  void set_thread_name(std::string name) { thread_name_ = std::move(name); }
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> sequence = {0};
+    TraceRecord record;
+  };
+
+  const int64_t thread_id_;
+  const size_t capacity_;
+  const uint64_t generation_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> next_ = {0};
+  std::string thread_name_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ThreadTraceBuffer);
+};
+
+struct ThreadTraceState {
+  std::string thread_name;
+  // The buffer of the most recent recording this thread recorded events in.
+  std::shared_ptr<ThreadTraceBuffer> buffer;
+};
+
+}  // namespace
+
+FML_THREAD_LOCAL ThreadLocalUniquePtr<ThreadTraceState> tls_trace_state;
+
+static std::mutex gBuffersMutex;
+// The buffers of the current recording. Buffers are kept after their thread
+// exits so that its events can still be exported.
+static std::vector<std::shared_ptr<ThreadTraceBuffer>> gBuffers;
+static size_t gBufferCapacity = kDefaultTraceBufferCapacity;
+static int64_t gNextThreadId = 1;
+// Incremented by every recording, so that threads notice that their buffer
+// belongs to a previous recording.
+static std::atomic<uint64_t> gBufferGeneration = {0};
+
+static ThreadTraceState& GetThreadTraceState() {
+  if (tls_trace_state.get() == nullptr) {
+    tls_trace_state.reset(new ThreadTraceState());
+  }
+  return *tls_trace_state.get();
+}
+
+static std::shared_ptr<ThreadTraceBuffer> CreateThreadTraceBuffer(
+    const std::string& thread_name) {
+  std::scoped_lock lock(gBuffersMutex);
+  if (!internal::gTraceBufferRecording.load(std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  auto buffer = std::make_shared<ThreadTraceBuffer>(
+      gNextThreadId++, thread_name, gBufferCapacity,
+      gBufferGeneration.load(std::memory_order_relaxed));
+  gBuffers.push_back(buffer);
+  return buffer;
+}
+
+static void CopyTruncated(char* destination, size_t size, const char* source) {
+  if (source == nullptr) {
+    destination[0] = '\0';
+    return;
+  }
+  const size_t length = strnlen(source, size - 1);
+  std::memcpy(destination, source, length);
+  destination[length] = '\0';
+}
+
+void internal::AppendToTraceBuffer(TraceCategory category,
+                                   TraceArg name,
+                                   int64_t timestamp_micros,
+                                   TraceIDArg id,
+                                   Dart_Timeline_Event_Type type,
+                                   size_t argument_count,
+                                   const char* const* argument_names,
+                                   const char* const* argument_values) {
+  ThreadTraceState& state = GetThreadTraceState();
+  if (!state.buffer || state.buffer->generation() !=
+                           gBufferGeneration.load(std::memory_order_acquire)) {
+    state.buffer = CreateThreadTraceBuffer(state.thread_name);
+    if (!state.buffer) {
+      return;
+    }
+  }
+
+  TraceRecord& record = state.buffer->BeginWrite();
+  record.timestamp_micros = timestamp_micros;
+  record.id = id;
+  record.type = type;
+  record.category = category;
+  record.argument_count = std::min(argument_count, kTraceMaxArguments);
+  CopyTruncated(record.name, kTraceRecordNameSize, name);
+  for (size_t i = 0; i < record.argument_count; i++) {
+    record.argument_names[i] = argument_names[i];
+    CopyTruncated(record.argument_values[i], kTraceArgumentValueSize,
+                  argument_values[i]);
+  }
+  state.buffer->EndWrite();
+}
+
+void StartTraceBuffer(size_t records_per_thread) {
+  FML_DCHECK(records_per_thread > 0);
+  {
+    std::scoped_lock lock(gBuffersMutex);
+    gBuffers.clear();
+    gBufferCapacity = std::max<size_t>(records_per_thread, 1);
+    gNextThreadId = 1;
+    gBufferGeneration.fetch_add(1, std::memory_order_release);
+    internal::gTraceBufferRecording.store(true);
+  }
+  internal::UpdateRecordedTraceCategories();
+}
+
+void StopTraceBuffer() {
+  {
+    std::scoped_lock lock(gBuffersMutex);
+    internal::gTraceBufferRecording.store(false);
+  }
+  internal::UpdateRecordedTraceCategories();
+}
+
+bool IsTraceBufferRecording() {
+  return internal::gTraceBufferRecording.load();
+}
+
+std::vector<TraceThreadRecords> GetTraceBufferRecords() {
+  std::vector<std::shared_ptr<ThreadTraceBuffer>> buffers;
+  std::vector<TraceThreadRecords> threads;
+  {
+    std::scoped_lock lock(gBuffersMutex);
+    buffers = gBuffers;
+    for (const auto& buffer : buffers) {
+      threads.push_back({buffer->thread_id(), buffer->thread_name(), {}});
+    }
+  }
+  for (size_t i = 0; i < buffers.size(); i++) {
+    threads[i].records = buffers[i]->CopyRecords();
+  }
+  return threads;
+}
+
+void SetTraceBufferThreadName(const std::string& name) {
+  ThreadTraceState& state = GetThreadTraceState();
+  state.thread_name = name;
+  if (state.buffer) {
+    std::scoped_lock lock(gBuffersMutex);
+    state.buffer->set_thread_name(name);
+  }
+}
+
+TraceCategoryMask TraceCategoriesFromNames(const std::string& names) {
+  TraceCategoryMask categories = 0;
+  size_t begin = 0;
+  while (begin <= names.size()) {
+    size_t end = names.find(',', begin);
+    if (end == std::string::npos) {
+      end = names.size();
+    }
+    const std::string name = names.substr(begin, end - begin);
+    for (uint32_t i = 0; i < static_cast<uint32_t>(TraceCategory::kCount);
+         i++) {
+      if (name == kTraceCategoryNames[i]) {
+        categories |= TraceCategoryBit(static_cast<TraceCategory>(i));
+      }
+    }
+    begin = end + 1;
+  }
+  return categories;
+}
+
+static const char* TraceCategoryName(TraceCategory category) {
+  return kTraceCategoryNames[static_cast<uint32_t>(category)];
+}
+
+// Chrome JSON export.
+
+static void AppendJSONString(std::string& json, const char* string) {
+  json += '"';
+  for (const char* c = string; *c != '\0'; c++) {
+    switch (*c) {
+      case '"':
+        json += "\\\"";
+        break;
+      case '\\':
+        json += "\\\\";
+        break;
+      case '\n':
+        json += "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(*c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+          json += escaped;
+        } else {
+          json += *c;
+        }
+    }
+  }
+  json += '"';
+}
+
+// Returns null for events that have no equivalent in the format.
+static const char* ChromeTracePhase(Dart_Timeline_Event_Type type) {
+  switch (type) {
+    case Dart_Timeline_Event_Begin:
+      return "B";
+    case Dart_Timeline_Event_End:
+      return "E";
+    case Dart_Timeline_Event_Instant:
+      return "i";
+    case Dart_Timeline_Event_Async_Begin:
+      return "b";
+    case Dart_Timeline_Event_Async_End:
+      return "e";
+    case Dart_Timeline_Event_Counter:
+      return "C";
+    case Dart_Timeline_Event_Flow_Begin:
+      return "s";
+    case Dart_Timeline_Event_Flow_Step:
+      return "t";
+    case Dart_Timeline_Event_Flow_End:
+      return "f";
+    default:
+      return nullptr;
+  }
+}
+
+// Counter values must be numbers, other arguments are kept as strings.
+static void AppendJSONArgumentValue(std::string& json,
+                                    Dart_Timeline_Event_Type type,
+                                    const char* value) {
+  if (type == Dart_Timeline_Event_Counter) {
+    char* end = nullptr;
+    const double number = std::strtod(value, &end);
+    if (end != value && *end == '\0') {
+      char formatted[32];
+      std::snprintf(formatted, sizeof(formatted), "%.17g", number);
+      json += formatted;
+      return;
+    }
+  }
+  AppendJSONString(json, value);
+}
+
+std::string ExportTraceBufferAsChromeJSON() {
+  std::string json = "{\"traceEvents\":[";
+  bool first_event = true;
+  char number[128];
+
+  for (const auto& thread : GetTraceBufferRecords()) {
+    if (!thread.thread_name.empty()) {
+      json += first_event ? "" : ",";
+      first_event = false;
+      std::snprintf(number, sizeof(number), "%" PRId64, thread.thread_id);
+      json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":";
+      json += number;
+      json += ",\"args\":{\"name\":";
+      AppendJSONString(json, thread.thread_name.c_str());
+      json += "}}";
+    }
+
+    for (const auto& record : thread.records) {
+      const char* phase = ChromeTracePhase(record.type);
+      if (phase == nullptr) {
+        continue;
+      }
+      json += first_event ? "{" : ",{";
+      first_event = false;
+
+      json += "\"name\":";
+      AppendJSONString(json, record.name);
+      json += ",\"cat\":";
+      AppendJSONString(json, TraceCategoryName(record.category));
+      json += ",\"ph\":\"";
+      json += phase;
+      std::snprintf(number, sizeof(number),
+                    "\",\"ts\":%" PRId64 ",\"pid\":0,\"tid\":%" PRId64,
+                    record.timestamp_micros, thread.thread_id);
+      json += number;
+      if (record.id != 0) {
+        std::snprintf(number, sizeof(number), ",\"id\":\"0x%" PRIx64 "\"",
+                      static_cast<uint64_t>(record.id));
+        json += number;
+      }
+      if (record.type == Dart_Timeline_Event_Instant) {
+        json += ",\"s\":\"t\"";
+      } else if (record.type == Dart_Timeline_Event_Flow_End) {
+        json += ",\"bp\":\"e\"";
+      }
+      json += ",\"args\":{";
+      for (uint32_t i = 0; i < record.argument_count; i++) {
+        json += i == 0 ? "" : ",";
+        AppendJSONString(json, record.argument_names[i]);
+        json += ':';
+        AppendJSONArgumentValue(json, record.type, record.argument_values[i]);
+      }
+      json += "}}";
+    }
+  }
+
+  json += "]}";
+  return json;
+}
+
+// Perfetto export. The trace is written by hand, with the field numbers of
+// protos/perfetto/trace, so that fml does not depend on protobuf.
+
+namespace {
+
+class ProtoWriter {
+ public:
+  void WriteVarint(uint32_t field, uint64_t value) {
+    AppendVarint(static_cast<uint64_t>(field) << 3 | kVarint);
+    AppendVarint(value);
+  }
+
+  void WriteDouble(uint32_t field, double value) {
+    AppendVarint(static_cast<uint64_t>(field) << 3 | kFixed64);
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; i++) {
+      data_ += static_cast<char>(bits >> (8 * i));
+    }
+  }
+
+  void WriteBytes(uint32_t field, const std::string& bytes) {
+    AppendVarint(static_cast<uint64_t>(field) << 3 | kLengthDelimited);
+    AppendVarint(bytes.size());
+    data_ += bytes;
+  }
+
+  void WriteMessage(uint32_t field, const ProtoWriter& message) {
+    WriteBytes(field, message.data_);
+  }
+
+  const std::string& data() const { return data_; }
+
+ private:
+  static constexpr uint64_t kVarint = 0;
+  static constexpr uint64_t kFixed64 = 1;
+  static constexpr uint64_t kLengthDelimited = 2;
+
+  std::string data_;
+
+  void AppendVarint(uint64_t value) {
+    while (value >= 0x80) {
+      data_ += static_cast<char>(value | 0x80);
+      value >>= 7;
+    }
+    data_ += static_cast<char>(value);
+  }
+};
+
+// Field numbers.
+constexpr uint32_t kTracePacket = 1;
+constexpr uint32_t kPacketTimestamp = 8;
+constexpr uint32_t kPacketSequenceId = 10;
+constexpr uint32_t kPacketTrackEvent = 11;
+constexpr uint32_t kPacketTimestampClockId = 58;
+constexpr uint32_t kPacketTrackDescriptor = 60;
+constexpr uint32_t kTrackDescriptorUuid = 1;
+constexpr uint32_t kTrackDescriptorName = 2;
+constexpr uint32_t kTrackDescriptorThread = 4;
+constexpr uint32_t kTrackDescriptorParentUuid = 5;
+constexpr uint32_t kTrackDescriptorCounter = 8;
+constexpr uint32_t kThreadDescriptorPid = 1;
+constexpr uint32_t kThreadDescriptorTid = 2;
+constexpr uint32_t kThreadDescriptorName = 5;
+constexpr uint32_t kTrackEventDebugAnnotation = 4;
+constexpr uint32_t kTrackEventType = 9;
+constexpr uint32_t kTrackEventTrackUuid = 11;
+constexpr uint32_t kTrackEventCategory = 22;
+constexpr uint32_t kTrackEventName = 23;
+constexpr uint32_t kTrackEventDoubleCounterValue = 44;
+constexpr uint32_t kDebugAnnotationStringValue = 6;
+constexpr uint32_t kDebugAnnotationName = 10;
+
+// TrackEvent.Type values.
+constexpr uint64_t kSliceBegin = 1;
+constexpr uint64_t kSliceEnd = 2;
+constexpr uint64_t kInstant = 3;
+constexpr uint64_t kCounter = 4;
+
+// BuiltinClock.BUILTIN_CLOCK_MONOTONIC, which Dart timeline timestamps use.
+constexpr uint64_t kMonotonicClock = 3;
+constexpr uint64_t kSequenceId = 1;
+constexpr int64_t kProcessId = 0;
+
+class PerfettoTraceWriter {
+ public:
+  void WriteThreadTrack(const TraceThreadRecords& thread) {
+    ProtoWriter thread_descriptor;
+    thread_descriptor.WriteVarint(kThreadDescriptorPid, kProcessId);
+    thread_descriptor.WriteVarint(kThreadDescriptorTid, thread.thread_id);
+    if (!thread.thread_name.empty()) {
+      thread_descriptor.WriteBytes(kThreadDescriptorName, thread.thread_name);
+    }
+    ProtoWriter track;
+    track.WriteVarint(kTrackDescriptorUuid, thread.thread_id);
+    track.WriteMessage(kTrackDescriptorThread, thread_descriptor);
+    WriteTrackDescriptor(track);
+  }
+
+  void WriteRecord(const TraceThreadRecords& thread,
+                   const TraceRecord& record) {
+    switch (record.type) {
+      case Dart_Timeline_Event_Begin:
+        WriteEvent(record, kSliceBegin, thread.thread_id);
+        break;
+      case Dart_Timeline_Event_End:
+        WriteEvent(record, kSliceEnd, thread.thread_id);
+        break;
+      case Dart_Timeline_Event_Instant:
+      case Dart_Timeline_Event_Flow_Begin:
+      case Dart_Timeline_Event_Flow_Step:
+      case Dart_Timeline_Event_Flow_End:
+        WriteEvent(record, kInstant, thread.thread_id);
+        break;
+      case Dart_Timeline_Event_Async_Begin:
+        WriteEvent(record, kSliceBegin, AsyncTrack(thread, record));
+        break;
+      case Dart_Timeline_Event_Async_End:
+        WriteEvent(record, kSliceEnd, AsyncTrack(thread, record));
+        break;
+      case Dart_Timeline_Event_Counter:
+        WriteCounter(thread, record);
+        break;
+      default:
+        break;
+    }
+  }
+
+  std::string TakeTrace() { return std::move(trace_); }
+
+ private:
+  std::string trace_;
+  std::unordered_set<uint64_t> described_tracks_;
+
+  void WritePacket(const ProtoWriter& packet) {
+    ProtoWriter trace;
+    trace.WriteMessage(kTracePacket, packet);
+    trace_ += trace.data();
+  }
+
+  void WriteTrackDescriptor(const ProtoWriter& track) {
+    ProtoWriter packet;
+    packet.WriteVarint(kPacketSequenceId, kSequenceId);
+    packet.WriteMessage(kPacketTrackDescriptor, track);
+    WritePacket(packet);
+  }
+
+  // Tracks other than those of threads get uuids derived from their name,
+  // with the top bit set so that they do not collide with thread ids.
+  static uint64_t NamedTrackUuid(const std::string& name) {
+    return std::hash<std::string>()(name) | (1ull << 63);
+  }
+
+  uint64_t NamedTrack(const TraceThreadRecords& thread,
+                      const std::string& name,
+                      bool counter) {
+    const uint64_t uuid = NamedTrackUuid(name);
+    if (described_tracks_.insert(uuid).second) {
+      ProtoWriter track;
+      track.WriteVarint(kTrackDescriptorUuid, uuid);
+      track.WriteBytes(kTrackDescriptorName, name);
+      track.WriteVarint(kTrackDescriptorParentUuid, thread.thread_id);
+      if (counter) {
+        track.WriteMessage(kTrackDescriptorCounter, ProtoWriter());
+      }
+      WriteTrackDescriptor(track);
+    }
+    return uuid;
+  }
+
+  // Async events with the same name and id are slices on their own track.
+  uint64_t AsyncTrack(const TraceThreadRecords& thread,
+                      const TraceRecord& record) {
+    char id[32];
+    std::snprintf(id, sizeof(id), " 0x%" PRIx64,
+                  static_cast<uint64_t>(record.id));
+    return NamedTrack(thread, std::string(record.name) + id, false);
+  }
+
+  ProtoWriter MakePacket(const TraceRecord& record) {
+    ProtoWriter packet;
+    packet.WriteVarint(kPacketTimestamp, record.timestamp_micros * 1000);
+    packet.WriteVarint(kPacketTimestampClockId, kMonotonicClock);
+    packet.WriteVarint(kPacketSequenceId, kSequenceId);
+    return packet;
+  }
+
+  void WriteEvent(const TraceRecord& record, uint64_t type, uint64_t track) {
+    ProtoWriter event;
+    event.WriteVarint(kTrackEventType, type);
+    event.WriteVarint(kTrackEventTrackUuid, track);
+    event.WriteBytes(kTrackEventCategory, TraceCategoryName(record.category));
+    if (type != kSliceEnd) {
+      event.WriteBytes(kTrackEventName, record.name);
+    }
+    for (uint32_t i = 0; i < record.argument_count; i++) {
+      ProtoWriter annotation;
+      annotation.WriteBytes(kDebugAnnotationName, record.argument_names[i]);
+      annotation.WriteBytes(kDebugAnnotationStringValue,
+                            record.argument_values[i]);
+      event.WriteMessage(kTrackEventDebugAnnotation, annotation);
+    }
+    if (record.type == Dart_Timeline_Event_Flow_Begin ||
+        record.type == Dart_Timeline_Event_Flow_Step ||
+        record.type == Dart_Timeline_Event_Flow_End) {
+      char id[32];
+      std::snprintf(id, sizeof(id), "0x%" PRIx64,
+                    static_cast<uint64_t>(record.id));
+      ProtoWriter annotation;
+      annotation.WriteBytes(kDebugAnnotationName, "flow_id");
+      annotation.WriteBytes(kDebugAnnotationStringValue, id);
+      event.WriteMessage(kTrackEventDebugAnnotation, annotation);
+    }
+
+    ProtoWriter packet = MakePacket(record);
+    packet.WriteMessage(kPacketTrackEvent, event);
+    WritePacket(packet);
+  }
+
+  // Every argument of a counter event is a series with its own track.
+  void WriteCounter(const TraceThreadRecords& thread,
+                    const TraceRecord& record) {
+    for (uint32_t i = 0; i < record.argument_count; i++) {
+      const uint64_t track =
+          NamedTrack(thread,
+                     std::string(record.name) + " " + record.argument_names[i],
+                     true);
+      ProtoWriter event;
+      event.WriteVarint(kTrackEventType, kCounter);
+      event.WriteVarint(kTrackEventTrackUuid, track);
+      event.WriteDouble(kTrackEventDoubleCounterValue,
+                        std::strtod(record.argument_values[i], nullptr));
+
+      ProtoWriter packet = MakePacket(record);
+      packet.WriteMessage(kPacketTrackEvent, event);
+      WritePacket(packet);
+    }
+  }
+};
+
+}  // namespace
+
+std::string ExportTraceBufferAsPerfetto() {
+  const auto threads = GetTraceBufferRecords();
+  PerfettoTraceWriter writer;
+  for (const auto& thread : threads) {
+    writer.WriteThreadTrack(thread);
+  }
+  for (const auto& thread : threads) {
+    for (const auto& record : thread.records) {
+      writer.WriteRecord(thread, record);
+    }
+  }
+  return writer.TakeTrace();
+}
+
+}  // namespace tracing
+}  // namespace fml
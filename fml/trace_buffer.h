@@ -0,0 +1,96 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_TRACE_BUFFER_H_
+#define FLUTTER_FML_TRACE_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "flutter/fml/trace_event.h"
+
+namespace fml {
+namespace tracing {
+
+// The trace buffer keeps the most recent trace events of each thread in a
+// ring buffer that only that thread writes to, so recording an event takes
+// no lock and does not allocate. The events can be exported on demand, in
+// the Chrome JSON trace format or as a Perfetto trace.
+
+constexpr size_t kDefaultTraceBufferCapacity = 2048;
+
+// Event names are copied since they are not always literals. Argument names
+// are not, they must outlive the recording.
+constexpr size_t kTraceRecordNameSize = 64;
+
+struct TraceRecord {
+  int64_t timestamp_micros;
+  int64_t id;
+  Dart_Timeline_Event_Type type;
+  TraceCategory category;
+  uint32_t argument_count;
+  char name[kTraceRecordNameSize];
+  const char* argument_names[kTraceMaxArguments];
+  char argument_values[kTraceMaxArguments][kTraceArgumentValueSize];
+};
+
+struct TraceThreadRecords {
+  // Identifies the thread within the trace, in the order threads first
+  // recorded an event.
+  int64_t thread_id;
+  std::string thread_name;
+  // Oldest first.
+  std::vector<TraceRecord> records;
+};
+
+// Starts recording events of the enabled categories into buffers of
+// |records_per_thread| records, discarding everything recorded before.
+void StartTraceBuffer(size_t records_per_thread = kDefaultTraceBufferCapacity);
+
+// Stops recording. What was recorded can still be exported.
+void StopTraceBuffer();
+
+bool IsTraceBufferRecording();
+
+// Copies the records of every thread that recorded events. Records that are
+// overwritten while they are copied are left out.
+std::vector<TraceThreadRecords> GetTraceBufferRecords();
+
+std::string ExportTraceBufferAsChromeJSON();
+
+// A serialized perfetto.protos.Trace.
+std::string ExportTraceBufferAsPerfetto();
+
+// Names the current thread in exported traces.
+void SetTraceBufferThreadName(const std::string& name);
+
+// Parses a comma separated list of category names, like "flutter,skia".
+// Unknown names are ignored.
+TraceCategoryMask TraceCategoriesFromNames(const std::string& names);
+
+namespace internal {
+
+extern std::atomic_bool gTraceBufferRecording;
+
+void AppendToTraceBuffer(TraceCategory category,
+                         TraceArg name,
+                         int64_t timestamp_micros,
+                         TraceIDArg id,
+                         Dart_Timeline_Event_Type type,
+                         size_t argument_count,
+                         const char* const* argument_names,
+                         const char* const* argument_values);
+
+// Recomputes which categories are recorded after a sink was turned on or off.
+void UpdateRecordedTraceCategories();
+
+}  // namespace internal
+
+}  // namespace tracing
+}  // namespace fml
+
+#endif  // FLUTTER_FML_TRACE_BUFFER_H_
@@ -0,0 +1,217 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/trace_buffer.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "flutter/fml/thread.h"
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace tracing {
+namespace testing {
+
+static_assert(TraceCategoryFromName("flutter") == TraceCategory::kFlutter,
+              "Category names are resolved at compile time.");
+static_assert(TraceCategoryFromName("skia") == TraceCategory::kSkia, "");
+static_assert(TraceCategoryFromName("flutterx") == TraceCategory::kOther, "");
+static_assert(TraceCategoryFromName(nullptr) == TraceCategory::kOther, "");
+
+class TraceBufferTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SetTraceTimelineForwarding(false);
+    SetEnabledTraceCategories(kAllTraceCategories);
+  }
+
+  void TearDown() override {
+    StopTraceBuffer();
+    SetEnabledTraceCategories(kAllTraceCategories);
+    SetTraceTimelineForwarding(true);
+  }
+
+  // The records of the only thread that recorded events.
+  static std::vector<TraceRecord> GetRecords() {
+    auto threads = GetTraceBufferRecords();
+    EXPECT_EQ(threads.size(), 1u);
+    return threads.empty() ? std::vector<TraceRecord>{} : threads[0].records;
+  }
+};
+
+TEST_F(TraceBufferTest, ParsesCategoryNames) {
+  EXPECT_EQ(TraceCategoriesFromNames(""), 0u);
+  EXPECT_EQ(TraceCategoriesFromNames("flutter"),
+            TraceCategoryBit(TraceCategory::kFlutter));
+  EXPECT_EQ(TraceCategoriesFromNames("skia,,dart,unknown"),
+            TraceCategoryBit(TraceCategory::kSkia) |
+                TraceCategoryBit(TraceCategory::kDart));
+}
+
+TEST_F(TraceBufferTest, NothingIsRecordedWithoutASink) {
+  EXPECT_FALSE(TraceCategoryEnabled(TraceCategory::kFlutter));
+  StartTraceBuffer();
+  EXPECT_TRUE(TraceCategoryEnabled(TraceCategory::kFlutter));
+  StopTraceBuffer();
+  EXPECT_FALSE(TraceCategoryEnabled(TraceCategory::kFlutter));
+}
+
+TEST_F(TraceBufferTest, RecordsEventsWithArguments) {
+  StartTraceBuffer();
+  {
+    TRACE_EVENT1("flutter", "Outer", "key", "value");
+    FML_TRACE_COUNTER("gfx", "Counter", 7, "count", 42, "ratio", 0.5);
+  }
+  std::thread([]() {
+    // Events of other threads are kept apart.
+    TRACE_EVENT0("flutter", "Other");
+  }).join();
+
+  auto threads = GetTraceBufferRecords();
+  ASSERT_EQ(threads.size(), 2u);
+  const auto& records = threads[0].records;
+  ASSERT_EQ(records.size(), 3u);
+
+  EXPECT_EQ(records[0].type, Dart_Timeline_Event_Begin);
+  EXPECT_EQ(records[0].category, TraceCategory::kFlutter);
+  EXPECT_STREQ(records[0].name, "Outer");
+  ASSERT_EQ(records[0].argument_count, 1u);
+  EXPECT_STREQ(records[0].argument_names[0], "key");
+  EXPECT_STREQ(records[0].argument_values[0], "value");
+
+  EXPECT_EQ(records[1].type, Dart_Timeline_Event_Counter);
+  EXPECT_EQ(records[1].category, TraceCategory::kGfx);
+  EXPECT_EQ(records[1].id, 7);
+  ASSERT_EQ(records[1].argument_count, 2u);
+  EXPECT_STREQ(records[1].argument_values[0], "42");
+  EXPECT_STREQ(records[1].argument_values[1], "0.500000");
+
+  EXPECT_EQ(records[2].type, Dart_Timeline_Event_End);
+  EXPECT_STREQ(records[2].name, "Outer");
+  EXPECT_LE(records[0].timestamp_micros, records[2].timestamp_micros);
+
+  ASSERT_EQ(threads[1].records.size(), 2u);
+  EXPECT_STREQ(threads[1].records[0].name, "Other");
+}
+
+TEST_F(TraceBufferTest, CopiesAndTruncatesNames) {
+  StartTraceBuffer();
+  std::string name(kTraceRecordNameSize * 2, 'a');
+  std::string value(kTraceArgumentValueSize * 2, 'b');
+  TraceEventInstant0("flutter", name.c_str());
+  FML_TRACE_COUNTER("flutter", "Counter", 0, "value", value);
+  name.assign(name.size(), 'c');
+
+  auto records = GetRecords();
+  ASSERT_EQ(records.size(), 2u);
+  EXPECT_EQ(std::string(records[0].name),
+            std::string(kTraceRecordNameSize - 1, 'a'));
+  EXPECT_EQ(std::string(records[1].argument_values[0]),
+            std::string(kTraceArgumentValueSize - 1, 'b'));
+}
+
+TEST_F(TraceBufferTest, SkipsDisabledCategories) {
+  StartTraceBuffer();
+  SetEnabledTraceCategories(TraceCategoryBit(TraceCategory::kSkia));
+  EXPECT_FALSE(TraceCategoryEnabled(TraceCategory::kFlutter));
+  EXPECT_TRUE(TraceCategoryEnabled(TraceCategory::kSkia));
+
+  TraceEventInstant0("flutter", "Flutter");
+  TraceEventInstant0("skia", "Skia");
+  TraceEventInstant0("somewhere", "Other");
+  {
+    TRACE_EVENT0("skia", "Scoped");
+    // Disabling the category of an open event still ends it.
+    SetEnabledTraceCategories(0);
+  }
+
+  auto records = GetRecords();
+  ASSERT_EQ(records.size(), 3u);
+  EXPECT_STREQ(records[0].name, "Skia");
+  EXPECT_EQ(records[1].type, Dart_Timeline_Event_Begin);
+  EXPECT_EQ(records[2].type, Dart_Timeline_Event_End);
+}
+
+TEST_F(TraceBufferTest, KeepsTheMostRecentRecords) {
+  StartTraceBuffer(4);
+  const char* names[] = {"0", "1", "2", "3", "4", "5"};
+  for (const char* name : names) {
+    TraceEventInstant0("flutter", name);
+  }
+
+  auto records = GetRecords();
+  ASSERT_EQ(records.size(), 4u);
+  EXPECT_STREQ(records[0].name, "2");
+  EXPECT_STREQ(records[3].name, "5");
+
+  // A new recording starts empty.
+  StartTraceBuffer(4);
+  EXPECT_TRUE(GetTraceBufferRecords().empty());
+}
+
+TEST_F(TraceBufferTest, CopiesConsistentRecordsWhileRecording) {
+  StartTraceBuffer(16);
+  std::atomic_bool done = {false};
+  std::thread writer([&done]() {
+    char name[16];
+    for (int i = 0; !done; i++) {
+      std::snprintf(name, sizeof(name), "%d", i);
+      FML_TRACE_COUNTER("flutter", name, i, "index", i);
+    }
+  });
+
+  for (int i = 0; i < 1000; i++) {
+    for (const auto& thread : GetTraceBufferRecords()) {
+      for (const auto& record : thread.records) {
+        ASSERT_EQ(std::to_string(record.id), record.name);
+        ASSERT_STREQ(record.name, record.argument_values[0]);
+      }
+    }
+  }
+
+  done = true;
+  writer.join();
+}
+
+TEST_F(TraceBufferTest, ExportsChromeJSON) {
+  StartTraceBuffer();
+  std::thread([]() {
+    Thread::SetCurrentThreadName("io.flutter.test");
+    TRACE_EVENT1("flutter", "Quoted \"name\"", "arg", "value");
+    FML_TRACE_COUNTER("flutter", "Counter", 1, "count", 3);
+  }).join();
+
+  const std::string json = ExportTraceBufferAsChromeJSON();
+  EXPECT_EQ(json.find("{\"traceEvents\":["), 0u);
+  EXPECT_NE(json.find("\"args\":{\"name\":\"io.flutter.test\"}"),
+            std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"Quoted \\\"name\\\"\",\"cat\":\"flutter\","
+                      "\"ph\":\"B\""),
+            std::string::npos);
+  EXPECT_NE(json.find("\"args\":{\"arg\":\"value\"}"), std::string::npos);
+  EXPECT_NE(json.find("\"ph\":\"E\""), std::string::npos);
+  EXPECT_NE(json.find("\"args\":{\"count\":3}"), std::string::npos);
+}
+
+TEST_F(TraceBufferTest, ExportsPerfetto) {
+  StartTraceBuffer();
+  EXPECT_TRUE(ExportTraceBufferAsPerfetto().empty());
+
+  TRACE_EVENT0("flutter", "Event");
+  FML_TRACE_COUNTER("flutter", "Counter", 1, "count", 3);
+
+  const std::string trace = ExportTraceBufferAsPerfetto();
+  // Every packet is field 1 of the trace.
+  ASSERT_FALSE(trace.empty());
+  EXPECT_EQ(trace[0], 0x0a);
+  EXPECT_NE(trace.find("Event"), std::string::npos);
+  EXPECT_NE(trace.find("Counter count"), std::string::npos);
+}
+
+}  // namespace testing
+}  // namespace tracing
+}  // namespace fml
@@ -4,237 +4,117 @@
 
 #include "flutter/fml/trace_event.h"
 
-#include <algorithm>
 #include <atomic>
+#include <mutex>
 #include <utility>
 
-#include "flutter/fml/build_config.h"
-#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_buffer.h"
 
 namespace fml {
 namespace tracing {
 
-size_t TraceNonce() {
-  static std::atomic_size_t gLastItem;
-  return ++gLastItem;
-}
+namespace internal {
 
-void TraceTimelineEvent(TraceArg category_group,
-                        TraceArg name,
-                        TraceIDArg identifier,
-                        Dart_Timeline_Event_Type type,
-                        const std::vector<const char*>& c_names,
-                        const std::vector<std::string>& values) {
-  const auto argument_count = std::min(c_names.size(), values.size());
+std::atomic<TraceCategoryMask> gRecordedTraceCategories = {
+    kAllTraceCategories};
 
-  std::vector<const char*> c_values;
-  c_values.resize(argument_count, nullptr);
+}  // namespace internal
 
-  for (size_t i = 0; i < argument_count; i++) {
-    c_values[i] = values[i].c_str();
+static std::mutex gTraceCategoriesMutex;
+static TraceCategoryMask gEnabledTraceCategories = kAllTraceCategories;
+static std::atomic_bool gForwardToTimeline = {true};
+
+void internal::UpdateRecordedTraceCategories() {
+  std::scoped_lock lock(gTraceCategoriesMutex);
+  const bool recorded = gForwardToTimeline || IsTraceBufferRecording();
+  gRecordedTraceCategories.store(recorded ? gEnabledTraceCategories : 0,
+                                 std::memory_order_relaxed);
+}
+
+void SetEnabledTraceCategories(TraceCategoryMask categories) {
+  {
+    std::scoped_lock lock(gTraceCategoriesMutex);
+    gEnabledTraceCategories = categories & kAllTraceCategories;
   }
+  internal::UpdateRecordedTraceCategories();
+}
 
-  Dart_TimelineEvent(
-      name,                                      // label
-      Dart_TimelineGetMicros(),                  // timestamp0
-      identifier,                                // timestamp1_or_async_id
-      type,                                      // event type
-      argument_count,                            // argument_count
-      const_cast<const char**>(c_names.data()),  // argument_names
-      c_values.data()                            // argument_values
-  );
+TraceCategoryMask GetEnabledTraceCategories() {
+  std::scoped_lock lock(gTraceCategoriesMutex);
+  return gEnabledTraceCategories;
 }
 
-void TraceEvent0(TraceArg category_group, TraceArg name) {
-  Dart_TimelineEvent(name,                       // label
-                     Dart_TimelineGetMicros(),   // timestamp0
-                     0,                          // timestamp1_or_async_id
-                     Dart_Timeline_Event_Begin,  // event type
-                     0,                          // argument_count
-                     nullptr,                    // argument_names
-                     nullptr                     // argument_values
-  );
+void SetTraceTimelineForwarding(bool forward) {
+  {
+    std::scoped_lock lock(gTraceCategoriesMutex);
+    gForwardToTimeline = forward;
+  }
+  internal::UpdateRecordedTraceCategories();
 }
 
-void TraceEvent1(TraceArg category_group,
-                 TraceArg name,
-                 TraceArg arg1_name,
-                 TraceArg arg1_val) {
-  const char* arg_names[] = {arg1_name};
-  const char* arg_values[] = {arg1_val};
-  Dart_TimelineEvent(name,                       // label
-                     Dart_TimelineGetMicros(),   // timestamp0
-                     0,                          // timestamp1_or_async_id
-                     Dart_Timeline_Event_Begin,  // event type
-                     1,                          // argument_count
-                     arg_names,                  // argument_names
-                     arg_values                  // argument_values
-  );
+size_t TraceNonce() {
+  static std::atomic_size_t gLastItem;
+  return ++gLastItem;
 }
 
-void TraceEvent2(TraceArg category_group,
-                 TraceArg name,
-                 TraceArg arg1_name,
-                 TraceArg arg1_val,
-                 TraceArg arg2_name,
-                 TraceArg arg2_val) {
-  const char* arg_names[] = {arg1_name, arg2_name};
-  const char* arg_values[] = {arg1_val, arg2_val};
-  Dart_TimelineEvent(name,                       // label
-                     Dart_TimelineGetMicros(),   // timestamp0
-                     0,                          // timestamp1_or_async_id
-                     Dart_Timeline_Event_Begin,  // event type
-                     2,                          // argument_count
-                     arg_names,                  // argument_names
-                     arg_values                  // argument_values
-  );
+static void RecordTraceEventAt(int64_t timestamp_micros,
+                               TraceCategory category,
+                               TraceArg name,
+                               TraceIDArg id,
+                               Dart_Timeline_Event_Type type,
+                               size_t argument_count,
+                               const char* const* argument_names,
+                               const char* const* argument_values) {
+  if (gForwardToTimeline.load(std::memory_order_relaxed)) {
+    Dart_TimelineEvent(
+        name,                                      // label
+        timestamp_micros,                          // timestamp0
+        id,                                        // timestamp1_or_async_id
+        type,                                      // event type
+        argument_count,                            // argument_count
+        const_cast<const char**>(argument_names),  // argument_names
+        const_cast<const char**>(argument_values)  // argument_values
+    );
+  }
+  if (internal::gTraceBufferRecording.load(std::memory_order_relaxed)) {
+    internal::AppendToTraceBuffer(category, name, timestamp_micros, id, type,
+                                  argument_count, argument_names,
+                                  argument_values);
+  }
 }
 
-void TraceEventEnd(TraceArg name) {
-  Dart_TimelineEvent(name,                      // label
-                     Dart_TimelineGetMicros(),  // timestamp0
-                     0,                         // timestamp1_or_async_id
-                     Dart_Timeline_Event_End,   // event type
-                     0,                         // argument_count
-                     nullptr,                   // argument_names
-                     nullptr                    // argument_values
-  );
+void internal::RecordTraceEvent(TraceCategory category,
+                                TraceArg name,
+                                TraceIDArg id,
+                                Dart_Timeline_Event_Type type,
+                                size_t argument_count,
+                                const char* const* argument_names,
+                                const char* const* argument_values) {
+  RecordTraceEventAt(Dart_TimelineGetMicros(), category, name, id, type,
+                     argument_count, argument_names, argument_values);
 }
 
-void TraceEventAsyncComplete(TraceArg category_group,
+void TraceEventAsyncComplete(TraceCategoryGroup category_group,
                              TraceArg name,
                              TimePoint begin,
                              TimePoint end) {
+  const TraceCategory category = category_group.category();
+  if (!TraceCategoryEnabled(category)) {
+    return;
+  }
+
   auto identifier = TraceNonce();
 
   if (begin > end) {
     std::swap(begin, end);
   }
 
-  Dart_TimelineEvent(name,                                   // label
-                     begin.ToEpochDelta().ToMicroseconds(),  // timestamp0
-                     identifier,                       // timestamp1_or_async_id
-                     Dart_Timeline_Event_Async_Begin,  // event type
-                     0,                                // argument_count
-                     nullptr,                          // argument_names
-                     nullptr                           // argument_values
-  );
-  Dart_TimelineEvent(name,                                 // label
-                     end.ToEpochDelta().ToMicroseconds(),  // timestamp0
-                     identifier,                     // timestamp1_or_async_id
-                     Dart_Timeline_Event_Async_End,  // event type
-                     0,                              // argument_count
-                     nullptr,                        // argument_names
-                     nullptr                         // argument_values
-  );
-}
-
-void TraceEventAsyncBegin0(TraceArg category_group,
-                           TraceArg name,
-                           TraceIDArg id) {
-  Dart_TimelineEvent(name,                             // label
-                     Dart_TimelineGetMicros(),         // timestamp0
-                     id,                               // timestamp1_or_async_id
-                     Dart_Timeline_Event_Async_Begin,  // event type
-                     0,                                // argument_count
-                     nullptr,                          // argument_names
-                     nullptr                           // argument_values
-  );
-}
-
-void TraceEventAsyncEnd0(TraceArg category_group,
-                         TraceArg name,
-                         TraceIDArg id) {
-  Dart_TimelineEvent(name,                           // label
-                     Dart_TimelineGetMicros(),       // timestamp0
-                     id,                             // timestamp1_or_async_id
-                     Dart_Timeline_Event_Async_End,  // event type
-                     0,                              // argument_count
-                     nullptr,                        // argument_names
-                     nullptr                         // argument_values
-  );
-}
-
-void TraceEventAsyncBegin1(TraceArg category_group,
-                           TraceArg name,
-                           TraceIDArg id,
-                           TraceArg arg1_name,
-                           TraceArg arg1_val) {
-  const char* arg_names[] = {arg1_name};
-  const char* arg_values[] = {arg1_val};
-  Dart_TimelineEvent(name,                             // label
-                     Dart_TimelineGetMicros(),         // timestamp0
-                     id,                               // timestamp1_or_async_id
-                     Dart_Timeline_Event_Async_Begin,  // event type
-                     1,                                // argument_count
-                     arg_names,                        // argument_names
-                     arg_values                        // argument_values
-  );
-}
-
-void TraceEventAsyncEnd1(TraceArg category_group,
-                         TraceArg name,
-                         TraceIDArg id,
-                         TraceArg arg1_name,
-                         TraceArg arg1_val) {
-  const char* arg_names[] = {arg1_name};
-  const char* arg_values[] = {arg1_val};
-  Dart_TimelineEvent(name,                           // label
-                     Dart_TimelineGetMicros(),       // timestamp0
-                     id,                             // timestamp1_or_async_id
-                     Dart_Timeline_Event_Async_End,  // event type
-                     1,                              // argument_count
-                     arg_names,                      // argument_names
-                     arg_values                      // argument_values
-  );
-}
-
-void TraceEventInstant0(TraceArg category_group, TraceArg name) {
-  Dart_TimelineEvent(name,                         // label
-                     Dart_TimelineGetMicros(),     // timestamp0
-                     0,                            // timestamp1_or_async_id
-                     Dart_Timeline_Event_Instant,  // event type
-                     0,                            // argument_count
-                     nullptr,                      // argument_names
-                     nullptr                       // argument_values
-  );
-}
-
-void TraceEventFlowBegin0(TraceArg category_group,
-                          TraceArg name,
-                          TraceIDArg id) {
-  Dart_TimelineEvent(name,                            // label
-                     Dart_TimelineGetMicros(),        // timestamp0
-                     id,                              // timestamp1_or_async_id
-                     Dart_Timeline_Event_Flow_Begin,  // event type
-                     0,                               // argument_count
-                     nullptr,                         // argument_names
-                     nullptr                          // argument_values
-  );
-}
-
-void TraceEventFlowStep0(TraceArg category_group,
-                         TraceArg name,
-                         TraceIDArg id) {
-  Dart_TimelineEvent(name,                           // label
-                     Dart_TimelineGetMicros(),       // timestamp0
-                     id,                             // timestamp1_or_async_id
-                     Dart_Timeline_Event_Flow_Step,  // event type
-                     0,                              // argument_count
-                     nullptr,                        // argument_names
-                     nullptr                         // argument_values
-  );
-}
-
-void TraceEventFlowEnd0(TraceArg category_group, TraceArg name, TraceIDArg id) {
-  Dart_TimelineEvent(name,                          // label
-                     Dart_TimelineGetMicros(),      // timestamp0
-                     id,                            // timestamp1_or_async_id
-                     Dart_Timeline_Event_Flow_End,  // event type
-                     0,                             // argument_count
-                     nullptr,                       // argument_names
-                     nullptr                        // argument_values
-  );
+  RecordTraceEventAt(begin.ToEpochDelta().ToMicroseconds(), category, name,
+                     identifier, Dart_Timeline_Event_Async_Begin, 0, nullptr,
+                     nullptr);
+  RecordTraceEventAt(end.ToEpochDelta().ToMicroseconds(), category, name,
+                     identifier, Dart_Timeline_Event_Async_End, 0, nullptr,
+                     nullptr);
 }
 
 }  // namespace tracing
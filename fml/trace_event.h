@@ -31,8 +31,10 @@
 
 #endif  //  defined(OS_FUCHSIA)
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -46,62 +48,76 @@
 
 #define __FML__TOKEN_CAT__(x, y) x##y
 #define __FML__TOKEN_CAT__2(x, y) __FML__TOKEN_CAT__(x, y)
-#define __FML__AUTO_TRACE_END(name)                                  \
-  ::fml::tracing::ScopedInstantEnd __FML__TOKEN_CAT__2(__trace_end_, \
-                                                       __LINE__)(name);
+#define __FML__AUTO_TRACE_END(category_group, name)     \
+  ::fml::tracing::ScopedInstantEnd __FML__TOKEN_CAT__2( \
+      __trace_end_, __LINE__)(__FML__TRACE_CATEGORY(category_group), name);
+
+// Category groups are resolved in a constant expression, so that the events
+// of disabled categories cost no more than checking the enabled categories.
+#define __FML__TRACE_CATEGORY(category_group)                   \
+  std::integral_constant<::fml::tracing::TraceCategory,         \
+                         ::fml::tracing::TraceCategoryFromName( \
+                             category_group)>::value
 
 // This macro has the FML_ prefix so that it does not collide with the macros
 // from lib/trace/event.h on Fuchsia.
 //
 // TODO(chinmaygarde): All macros here should have the FML prefix.
-#define FML_TRACE_COUNTER(category_group, name, counter_id, arg1, ...)         \
-  ::fml::tracing::TraceCounter((category_group), (name), (counter_id), (arg1), \
-                               __VA_ARGS__);
+#define FML_TRACE_COUNTER(category_group, name, counter_id, arg1, ...) \
+  ::fml::tracing::TraceCounter(__FML__TRACE_CATEGORY(category_group),  \
+                               (name), (counter_id), (arg1), __VA_ARGS__);
 
-#define FML_TRACE_EVENT(category_group, name, ...)                   \
-  ::fml::tracing::TraceEvent((category_group), (name), __VA_ARGS__); \
-  __FML__AUTO_TRACE_END(name)
+#define FML_TRACE_EVENT(category_group, name, ...)                          \
+  ::fml::tracing::TraceEvent(__FML__TRACE_CATEGORY(category_group), (name), \
+                             __VA_ARGS__);                                  \
+  __FML__AUTO_TRACE_END(category_group, name)
 
-#define TRACE_EVENT0(category_group, name)           \
-  ::fml::tracing::TraceEvent0(category_group, name); \
-  __FML__AUTO_TRACE_END(name)
+#define TRACE_EVENT0(category_group, name)                                  \
+  ::fml::tracing::TraceEvent0(__FML__TRACE_CATEGORY(category_group), name); \
+  __FML__AUTO_TRACE_END(category_group, name)
 
-#define TRACE_EVENT1(category_group, name, arg1_name, arg1_val)           \
-  ::fml::tracing::TraceEvent1(category_group, name, arg1_name, arg1_val); \
-  __FML__AUTO_TRACE_END(name)
+#define TRACE_EVENT1(category_group, name, arg1_name, arg1_val)            \
+  ::fml::tracing::TraceEvent1(__FML__TRACE_CATEGORY(category_group), name, \
+                              arg1_name, arg1_val);                        \
+  __FML__AUTO_TRACE_END(category_group, name)
 
 #define TRACE_EVENT2(category_group, name, arg1_name, arg1_val, arg2_name, \
                      arg2_val)                                             \
-  ::fml::tracing::TraceEvent2(category_group, name, arg1_name, arg1_val,   \
-                              arg2_name, arg2_val);                        \
-  __FML__AUTO_TRACE_END(name)
+  ::fml::tracing::TraceEvent2(__FML__TRACE_CATEGORY(category_group), name, \
+                              arg1_name, arg1_val, arg2_name, arg2_val);   \
+  __FML__AUTO_TRACE_END(category_group, name)
 
-#define TRACE_EVENT_ASYNC_BEGIN0(category_group, name, id) \
-  ::fml::tracing::TraceEventAsyncBegin0(category_group, name, id);
+#define TRACE_EVENT_ASYNC_BEGIN0(category_group, name, id)                     \
+  ::fml::tracing::TraceEventAsyncBegin0(__FML__TRACE_CATEGORY(category_group), \
+                                        name, id);
 
-#define TRACE_EVENT_ASYNC_END0(category_group, name, id) \
-  ::fml::tracing::TraceEventAsyncEnd0(category_group, name, id);
+#define TRACE_EVENT_ASYNC_END0(category_group, name, id)                     \
+  ::fml::tracing::TraceEventAsyncEnd0(__FML__TRACE_CATEGORY(category_group), \
+                                      name, id);
 
-#define TRACE_EVENT_ASYNC_BEGIN1(category_group, name, id, arg1_name,        \
-                                 arg1_val)                                   \
-  ::fml::tracing::TraceEventAsyncBegin1(category_group, name, id, arg1_name, \
-                                        arg1_val);
+#define TRACE_EVENT_ASYNC_BEGIN1(category_group, name, id, arg1_name,          \
+                                 arg1_val)                                     \
+  ::fml::tracing::TraceEventAsyncBegin1(__FML__TRACE_CATEGORY(category_group), \
+                                        name, id, arg1_name, arg1_val);
 
 #define TRACE_EVENT_ASYNC_END1(category_group, name, id, arg1_name, arg1_val) \
-  ::fml::tracing::TraceEventAsyncEnd1(category_group, name, id, arg1_name,    \
-                                      arg1_val);
+  ::fml::tracing::TraceEventAsyncEnd1(__FML__TRACE_CATEGORY(category_group),  \
+                                      name, id, arg1_name, arg1_val);
 
-#define TRACE_EVENT_INSTANT0(category_group, name) \
-  ::fml::tracing::TraceEventInstant0(category_group, name);
+#define TRACE_EVENT_INSTANT0(category_group, name)                          \
+  ::fml::tracing::TraceEventInstant0(__FML__TRACE_CATEGORY(category_group), \
+                                     name);
 
-#define TRACE_FLOW_BEGIN(category, name, id) \
-  ::fml::tracing::TraceEventFlowBegin0(category, name, id);
+#define TRACE_FLOW_BEGIN(category, name, id)                                  \
+  ::fml::tracing::TraceEventFlowBegin0(__FML__TRACE_CATEGORY(category), name, \
+                                       id);
 
-#define TRACE_FLOW_STEP(category, name, id) \
-  ::fml::tracing::TraceEventFlowStep0(category, name, id);
+#define TRACE_FLOW_STEP(category, name, id)                                  \
+  ::fml::tracing::TraceEventFlowStep0(__FML__TRACE_CATEGORY(category), name, \
+                                      id);
 
 #define TRACE_FLOW_END(category, name, id) \
-  ::fml::tracing::TraceEventFlowEnd0(category, name, id);
+  ::fml::tracing::TraceEventFlowEnd0(__FML__TRACE_CATEGORY(category), name, id);
 
 #endif  // TRACE_EVENT_HIDE_MACROS
 #endif  // !defined(OS_FUCHSIA)
@@ -112,68 +128,194 @@ namespace tracing {
 using TraceArg = const char*;
 using TraceIDArg = int64_t;
 
-void TraceTimelineEvent(TraceArg category_group,
-                        TraceArg name,
-                        TraceIDArg id,
-                        Dart_Timeline_Event_Type type,
-                        const std::vector<const char*>& names,
-                        const std::vector<std::string>& values);
+// The categories that trace events can be enabled and disabled by. Events
+// name their category group with a string, which is looked up in
+// |kTraceCategoryNames|. Groups that are not listed there are |kOther|.
+enum class TraceCategory : uint32_t {
+  kFlutter,
+  kSkia,
+  kDart,
+  kGfx,
+  kInput,
+  kFml,
+  kOther,
+  kCount,
+};
 
-inline std::string TraceToString(const char* string) {
-  return std::string{string};
-}
+inline constexpr const char* kTraceCategoryNames[] = {
+    "flutter", "skia", "dart", "gfx", "input", "fml", "other",
+};
 
-inline std::string TraceToString(std::string string) {
-  return string;
-}
+static_assert(sizeof(kTraceCategoryNames) / sizeof(kTraceCategoryNames[0]) ==
+                  static_cast<size_t>(TraceCategory::kCount),
+              "Every trace category must have a name.");
 
-inline std::string TraceToString(TimePoint point) {
-  return std::to_string(point.ToEpochDelta().ToNanoseconds());
-}
+using TraceCategoryMask = uint32_t;
 
-template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
-std::string TraceToString(T string) {
-  return std::to_string(string);
+constexpr TraceCategoryMask TraceCategoryBit(TraceCategory category) {
+  return 1u << static_cast<uint32_t>(category);
 }
 
-inline void SplitArgumentsCollect(std::vector<const char*>& keys,
-                                  std::vector<std::string>& values) {}
-
-template <typename Key, typename Value, typename... Args>
-void SplitArgumentsCollect(std::vector<const char*>& keys,
-                           std::vector<std::string>& values,
-                           Key key,
-                           Value value,
-                           Args... args) {
-  keys.emplace_back(key);
-  values.emplace_back(TraceToString(value));
-  SplitArgumentsCollect(keys, values, args...);
+constexpr TraceCategoryMask kAllTraceCategories =
+    TraceCategoryBit(TraceCategory::kCount) - 1;
+
+constexpr bool TraceNamesEqual(const char* a, const char* b) {
+  while (*a != '\0' && *a == *b) {
+    a++;
+    b++;
+  }
+  return *a == *b;
 }
 
-inline std::pair<std::vector<const char*>, std::vector<std::string>>
-SplitArguments() {
-  return {};
+// Category groups are almost always string literals, for which this is
+// folded into a constant.
+constexpr TraceCategory TraceCategoryFromName(const char* name) {
+  if (name == nullptr) {
+    return TraceCategory::kOther;
+  }
+  for (uint32_t i = 0; i < static_cast<uint32_t>(TraceCategory::kOther); i++) {
+    if (TraceNamesEqual(name, kTraceCategoryNames[i])) {
+      return static_cast<TraceCategory>(i);
+    }
+  }
+  return TraceCategory::kOther;
 }
 
-template <typename Key, typename Value, typename... Args>
-std::pair<std::vector<const char*>, std::vector<std::string>>
-SplitArguments(Key key, Value value, Args... args) {
-  std::vector<const char*> keys;
-  std::vector<std::string> values;
-  SplitArgumentsCollect(keys, values, key, value, args...);
-  return std::make_pair(std::move(keys), std::move(values));
+// The category group of an event, resolved to its category. The macros
+// resolve category groups at compile time, other callers may pass the name
+// of the group, which is then looked up with every event.
+class TraceCategoryGroup {
+ public:
+  constexpr TraceCategoryGroup(TraceCategory category) : category_(category) {}
+
+  constexpr TraceCategoryGroup(const char* name)
+      : category_(TraceCategoryFromName(name)) {}
+
+  constexpr TraceCategory category() const { return category_; }
+
+ private:
+  TraceCategory category_;
+};
+
+namespace internal {
+
+// The enabled categories, or none if there is nothing that records events.
+extern std::atomic<TraceCategoryMask> gRecordedTraceCategories;
+
+void RecordTraceEvent(TraceCategory category,
+                      TraceArg name,
+                      TraceIDArg id,
+                      Dart_Timeline_Event_Type type,
+                      size_t argument_count,
+                      const char* const* argument_names,
+                      const char* const* argument_values);
+
+}  // namespace internal
+
+// Whether events of |category| are recorded. This is a single atomic load,
+// which is all that tracing costs for events of disabled categories.
+inline bool TraceCategoryEnabled(TraceCategory category) {
+  return internal::gRecordedTraceCategories.load(std::memory_order_relaxed) &
+         TraceCategoryBit(category);
 }
 
+// All categories are enabled by default.
+void SetEnabledTraceCategories(TraceCategoryMask categories);
+
+TraceCategoryMask GetEnabledTraceCategories();
+
+// Whether events are forwarded to the Dart timeline, which keeps them if the
+// embedder stream is recorded, for example because an observatory client
+// asked for it. This is on by default.
+void SetTraceTimelineForwarding(bool forward);
+
+// Trace events record at most this many arguments. The values are formatted
+// into fixed size buffers, longer values are truncated.
+constexpr size_t kTraceMaxArguments = 4;
+constexpr size_t kTraceArgumentValueSize = 32;
+
+// The arguments of a trace event, formatted without allocating.
+class TraceArguments {
+ public:
+  template <typename... Args>
+  explicit TraceArguments(Args... args) {
+    static_assert(sizeof...(Args) % 2 == 0,
+                  "Arguments must be pairs of names and values.");
+    static_assert(sizeof...(Args) / 2 <= kTraceMaxArguments,
+                  "Too many trace event arguments.");
+    Collect(args...);
+  }
+
+  size_t count() const { return count_; }
+
+  const char* const* names() const { return names_; }
+
+  const char* const* values() const { return values_; }
+
+ private:
+  size_t count_ = 0;
+  const char* names_[kTraceMaxArguments];
+  const char* values_[kTraceMaxArguments];
+  char storage_[kTraceMaxArguments][kTraceArgumentValueSize];
+
+  void Collect() {}
+
+  template <typename Key, typename Value, typename... Args>
+  void Collect(Key key, Value value, Args... args) {
+    names_[count_] = key;
+    values_[count_] = Format(storage_[count_], value);
+    count_++;
+    Collect(args...);
+  }
+
+  static const char* Format(char* storage, const char* value) {
+    return value;
+  }
+
+  static const char* Format(char* storage, const std::string& value) {
+    std::snprintf(storage, kTraceArgumentValueSize, "%s", value.c_str());
+    return storage;
+  }
+
+  static const char* Format(char* storage, TimePoint point) {
+    std::snprintf(storage, kTraceArgumentValueSize, "%lld",
+                  static_cast<long long>(
+                      point.ToEpochDelta().ToNanoseconds()));
+    return storage;
+  }
+
+  template <typename T,
+            typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+  static const char* Format(char* storage, T value) {
+    if constexpr (std::is_floating_point<T>::value) {
+      std::snprintf(storage, kTraceArgumentValueSize, "%f",
+                    static_cast<double>(value));
+    } else if constexpr (std::is_signed<T>::value) {
+      std::snprintf(storage, kTraceArgumentValueSize, "%lld",
+                    static_cast<long long>(value));
+    } else {
+      std::snprintf(storage, kTraceArgumentValueSize, "%llu",
+                    static_cast<unsigned long long>(value));
+    }
+    return storage;
+  }
+};
+
 size_t TraceNonce();
 
 template <typename... Args>
-void TraceCounter(TraceArg category,
+void TraceCounter(TraceCategoryGroup category,
                   TraceArg name,
                   TraceIDArg identifier,
                   Args... args) {
-  auto split = SplitArguments(args...);
-  TraceTimelineEvent(category, name, identifier, Dart_Timeline_Event_Counter,
-                     split.first, split.second);
+  const TraceCategory trace_category = category.category();
+  if (!TraceCategoryEnabled(trace_category)) {
+    return;
+  }
+  TraceArguments arguments(args...);
+  internal::RecordTraceEvent(trace_category, name, identifier,
+                             Dart_Timeline_Event_Counter, arguments.count(),
+                             arguments.names(), arguments.values());
 }
 
 // HACK: Used to NOP FML_TRACE_COUNTER macro without triggering unused var
@@ -185,68 +327,156 @@ void TraceCounterNopHACK(TraceArg category,
                          Args... args) {}
 
 template <typename... Args>
-void TraceEvent(TraceArg category, TraceArg name, Args... args) {
-  auto split = SplitArguments(args...);
-  TraceTimelineEvent(category, name, 0, Dart_Timeline_Event_Begin, split.first,
-                     split.second);
+void TraceEvent(TraceCategoryGroup category, TraceArg name, Args... args) {
+  const TraceCategory trace_category = category.category();
+  if (!TraceCategoryEnabled(trace_category)) {
+    return;
+  }
+  TraceArguments arguments(args...);
+  internal::RecordTraceEvent(trace_category, name, 0,
+                             Dart_Timeline_Event_Begin, arguments.count(),
+                             arguments.names(), arguments.values());
 }
 
-void TraceEvent0(TraceArg category_group, TraceArg name);
+// Records an event with |type| and no arguments if its category is enabled.
+inline void TraceEventOfType(TraceCategoryGroup category_group,
+                             TraceArg name,
+                             TraceIDArg id,
+                             Dart_Timeline_Event_Type type) {
+  const TraceCategory category = category_group.category();
+  if (TraceCategoryEnabled(category)) {
+    internal::RecordTraceEvent(category, name, id, type, 0, nullptr, nullptr);
+  }
+}
 
-void TraceEvent1(TraceArg category_group,
-                 TraceArg name,
-                 TraceArg arg1_name,
-                 TraceArg arg1_val);
+inline void TraceEvent0(TraceCategoryGroup category_group, TraceArg name) {
+  TraceEventOfType(category_group, name, 0, Dart_Timeline_Event_Begin);
+}
 
-void TraceEvent2(TraceArg category_group,
-                 TraceArg name,
-                 TraceArg arg1_name,
-                 TraceArg arg1_val,
-                 TraceArg arg2_name,
-                 TraceArg arg2_val);
+inline void TraceEvent1(TraceCategoryGroup category_group,
+                        TraceArg name,
+                        TraceArg arg1_name,
+                        TraceArg arg1_val) {
+  const TraceCategory category = category_group.category();
+  if (TraceCategoryEnabled(category)) {
+    const char* arg_names[] = {arg1_name};
+    const char* arg_values[] = {arg1_val};
+    internal::RecordTraceEvent(category, name, 0, Dart_Timeline_Event_Begin, 1,
+                               arg_names, arg_values);
+  }
+}
 
-void TraceEventEnd(TraceArg name);
+inline void TraceEvent2(TraceCategoryGroup category_group,
+                        TraceArg name,
+                        TraceArg arg1_name,
+                        TraceArg arg1_val,
+                        TraceArg arg2_name,
+                        TraceArg arg2_val) {
+  const TraceCategory category = category_group.category();
+  if (TraceCategoryEnabled(category)) {
+    const char* arg_names[] = {arg1_name, arg2_name};
+    const char* arg_values[] = {arg1_val, arg2_val};
+    internal::RecordTraceEvent(category, name, 0, Dart_Timeline_Event_Begin, 2,
+                               arg_names, arg_values);
+  }
+}
 
-void TraceEventAsyncComplete(TraceArg category_group,
+inline void TraceEventEnd(TraceCategoryGroup category_group,
+                          TraceArg name) {
+  TraceEventOfType(category_group, name, 0, Dart_Timeline_Event_End);
+}
+
+void TraceEventAsyncComplete(TraceCategoryGroup category_group,
                              TraceArg name,
                              TimePoint begin,
                              TimePoint end);
 
-void TraceEventAsyncBegin0(TraceArg category_group,
-                           TraceArg name,
-                           TraceIDArg id);
+inline void TraceEventAsyncBegin0(TraceCategoryGroup category_group,
+                                  TraceArg name,
+                                  TraceIDArg id) {
+  TraceEventOfType(category_group, name, id, Dart_Timeline_Event_Async_Begin);
+}
 
-void TraceEventAsyncEnd0(TraceArg category_group, TraceArg name, TraceIDArg id);
+inline void TraceEventAsyncEnd0(TraceCategoryGroup category_group,
+                                TraceArg name,
+                                TraceIDArg id) {
+  TraceEventOfType(category_group, name, id, Dart_Timeline_Event_Async_End);
+}
 
-void TraceEventAsyncBegin1(TraceArg category_group,
-                           TraceArg name,
-                           TraceIDArg id,
-                           TraceArg arg1_name,
-                           TraceArg arg1_val);
+inline void TraceEventAsyncBegin1(TraceCategoryGroup category_group,
+                                  TraceArg name,
+                                  TraceIDArg id,
+                                  TraceArg arg1_name,
+                                  TraceArg arg1_val) {
+  const TraceCategory category = category_group.category();
+  if (TraceCategoryEnabled(category)) {
+    const char* arg_names[] = {arg1_name};
+    const char* arg_values[] = {arg1_val};
+    internal::RecordTraceEvent(category, name, id,
+                               Dart_Timeline_Event_Async_Begin, 1, arg_names,
+                               arg_values);
+  }
+}
 
-void TraceEventAsyncEnd1(TraceArg category_group,
-                         TraceArg name,
-                         TraceIDArg id,
-                         TraceArg arg1_name,
-                         TraceArg arg1_val);
+inline void TraceEventAsyncEnd1(TraceCategoryGroup category_group,
+                                TraceArg name,
+                                TraceIDArg id,
+                                TraceArg arg1_name,
+                                TraceArg arg1_val) {
+  const TraceCategory category = category_group.category();
+  if (TraceCategoryEnabled(category)) {
+    const char* arg_names[] = {arg1_name};
+    const char* arg_values[] = {arg1_val};
+    internal::RecordTraceEvent(category, name, id,
+                               Dart_Timeline_Event_Async_End, 1, arg_names,
+                               arg_values);
+  }
+}
 
-void TraceEventInstant0(TraceArg category_group, TraceArg name);
+inline void TraceEventInstant0(TraceCategoryGroup category_group,
+                               TraceArg name) {
+  TraceEventOfType(category_group, name, 0, Dart_Timeline_Event_Instant);
+}
 
-void TraceEventFlowBegin0(TraceArg category_group,
-                          TraceArg name,
-                          TraceIDArg id);
+inline void TraceEventFlowBegin0(TraceCategoryGroup category_group,
+                                 TraceArg name,
+                                 TraceIDArg id) {
+  TraceEventOfType(category_group, name, id, Dart_Timeline_Event_Flow_Begin);
+}
 
-void TraceEventFlowStep0(TraceArg category_group, TraceArg name, TraceIDArg id);
+inline void TraceEventFlowStep0(TraceCategoryGroup category_group,
+                                TraceArg name,
+                                TraceIDArg id) {
+  TraceEventOfType(category_group, name, id, Dart_Timeline_Event_Flow_Step);
+}
 
-void TraceEventFlowEnd0(TraceArg category_group, TraceArg name, TraceIDArg id);
+inline void TraceEventFlowEnd0(TraceCategoryGroup category_group,
+                               TraceArg name,
+                               TraceIDArg id) {
+  TraceEventOfType(category_group, name, id, Dart_Timeline_Event_Flow_End);
+}
 
+// Ends the event that the enclosing scope began. Whether the category is
+// enabled is sampled once so that the begin and end of the event stay paired
+// when categories are toggled in between.
 class ScopedInstantEnd {
  public:
-  ScopedInstantEnd(const char* str) : label_(str) {}
-
-  ~ScopedInstantEnd() { TraceEventEnd(label_); }
+  ScopedInstantEnd(TraceCategoryGroup category_group, const char* str)
+      : category_(category_group.category()),
+        enabled_(TraceCategoryEnabled(category_)),
+        label_(str) {}
+
+  ~ScopedInstantEnd() {
+    if (enabled_) {
+      internal::RecordTraceEvent(category_, label_, 0,
+                                 Dart_Timeline_Event_End, 0, nullptr,
+                                 nullptr);
+    }
+  }
 
  private:
+  const TraceCategory category_;
+  const bool enabled_;
   const char* label_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(ScopedInstantEnd);
@@ -260,7 +490,7 @@ class ScopedInstantEnd {
 class TraceFlow {
  public:
   TraceFlow(const char* label) : label_(label), nonce_(TraceNonce()) {
-    TraceEventFlowBegin0("flutter", label_, nonce_);
+    TraceEventFlowBegin0(TraceCategory::kFlutter, label_, nonce_);
   }
 
   ~TraceFlow() { End(label_); }
@@ -270,12 +500,13 @@ class TraceFlow {
   }
 
   void Step(const char* label) const {
-    TraceEventFlowStep0("flutter", label, nonce_);
+    TraceEventFlowStep0(TraceCategory::kFlutter, label, nonce_);
   }
 
   void End(const char* label = nullptr) {
     if (nonce_ != 0) {
-      TraceEventFlowEnd0("flutter", label == nullptr ? label_ : label, nonce_);
+      TraceEventFlowEnd0(TraceCategory::kFlutter,
+                         label == nullptr ? label_ : label, nonce_);
       nonce_ = 0;
     }
   }
@@ -0,0 +1,80 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/trace_buffer.h"
+#include "flutter/fml/trace_event.h"
+
+namespace fml {
+namespace benchmarking {
+
+// Records into the trace buffer only, so that the cost of the Dart timeline
+// is not part of the measurements.
+class ScopedTraceBuffer {
+ public:
+  explicit ScopedTraceBuffer(tracing::TraceCategoryMask categories) {
+    tracing::SetTraceTimelineForwarding(false);
+    tracing::SetEnabledTraceCategories(categories);
+    tracing::StartTraceBuffer();
+  }
+
+  ~ScopedTraceBuffer() {
+    tracing::StopTraceBuffer();
+    tracing::SetEnabledTraceCategories(tracing::kAllTraceCategories);
+    tracing::SetTraceTimelineForwarding(true);
+  }
+};
+
+static void BM_TraceEventDisabledCategory(benchmark::State& state) {
+  ScopedTraceBuffer buffer(
+      tracing::TraceCategoryBit(tracing::TraceCategory::kSkia));
+  while (state.KeepRunning()) {
+    TRACE_EVENT0("flutter", "BM_TraceEventDisabledCategory");
+  }
+}
+BENCHMARK(BM_TraceEventDisabledCategory);
+
+static void BM_TraceEventDisabledCategoryWithArguments(
+    benchmark::State& state) {
+  ScopedTraceBuffer buffer(
+      tracing::TraceCategoryBit(tracing::TraceCategory::kSkia));
+  int64_t count = 0;
+  while (state.KeepRunning()) {
+    FML_TRACE_EVENT("flutter", "BM_TraceEventDisabledCategoryWithArguments",
+                    "count", count++, "time", 1.5);
+  }
+}
+BENCHMARK(BM_TraceEventDisabledCategoryWithArguments);
+
+static void BM_TraceEventRecorded(benchmark::State& state) {
+  ScopedTraceBuffer buffer(tracing::kAllTraceCategories);
+  while (state.KeepRunning()) {
+    TRACE_EVENT0("flutter", "BM_TraceEventRecorded");
+  }
+}
+BENCHMARK(BM_TraceEventRecorded);
+
+static void BM_TraceEventRecordedWithArguments(benchmark::State& state) {
+  ScopedTraceBuffer buffer(tracing::kAllTraceCategories);
+  int64_t count = 0;
+  while (state.KeepRunning()) {
+    FML_TRACE_EVENT("flutter", "BM_TraceEventRecordedWithArguments", "count",
+                    count++, "time", 1.5);
+  }
+}
+BENCHMARK(BM_TraceEventRecordedWithArguments);
+
+static void BM_TraceEventExportChromeJSON(benchmark::State& state) {
+  ScopedTraceBuffer buffer(tracing::kAllTraceCategories);
+  for (size_t i = 0; i < tracing::kDefaultTraceBufferCapacity / 2; i++) {
+    TRACE_EVENT1("flutter", "BM_TraceEventExportChromeJSON", "key", "value");
+  }
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(tracing::ExportTraceBufferAsChromeJSON());
+  }
+}
+BENCHMARK(BM_TraceEventExportChromeJSON)->Unit(benchmark::kMicrosecond);
+
+}  // namespace benchmarking
+}  // namespace fml
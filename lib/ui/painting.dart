@@ -1607,18 +1607,58 @@ class Image extends NativeFieldWrapperClass2 {
   /// The [format] argument specifies the format in which the bytes will be
   /// returned.
   ///
+  /// If [fastCompression] is true, compressed formats like
+  /// [ImageByteFormat.png] trade a larger output for encoding faster.
+  ///
   /// Returns a future that completes with the binary image data or an error
   /// if encoding fails.
-  Future<ByteData> toByteData({ImageByteFormat format = ImageByteFormat.rawRgba}) {
+  ///
+  /// See also:
+  ///
+  ///  * [toByteDataChunks], which delivers the bytes as they are encoded.
+  Future<ByteData> toByteData({
+    ImageByteFormat format = ImageByteFormat.rawRgba,
+    bool fastCompression = false,
+  }) {
     return _futurize((_Callback<ByteData> callback) {
-      return _toByteData(format.index, (Uint8List encoded) {
+      return _toByteData(format.index, fastCompression, null, (Uint8List encoded) {
         callback(encoded?.buffer?.asByteData());
       });
     });
   }
 
+  /// Converts the [Image] object into a byte array like [toByteData], but
+  /// delivers the bytes in chunks as soon as they are encoded.
+  ///
+  /// Concatenating the chunks in order gives the same kind of data
+  /// [toByteData] returns. Large images are encoded in several pieces, so the
+  /// first chunks are available well before the whole image is encoded, which
+  /// allows writing or uploading them while the rest is still being encoded.
+  ///
+  /// The stream closes once the whole image is delivered, or with an error if
+  /// encoding fails.
+  Stream<Uint8List> toByteDataChunks({
+    ImageByteFormat format = ImageByteFormat.rawRgba,
+    bool fastCompression = false,
+  }) {
+    final StreamController<Uint8List> controller = StreamController<Uint8List>();
+    final String error = _toByteData(format.index, fastCompression, controller.add, (Uint8List encoded) {
+      if (encoded == null)
+        controller.addError(Exception('operation failed'));
+      controller.close();
+    });
+    if (error != null) {
+      controller.addError(Exception(error));
+      controller.close();
+    }
+    return controller.stream;
+  }
+
   /// Returns an error message on failure, null on success.
-  String _toByteData(int format, _Callback<Uint8List> callback) native 'Image_toByteData';
+  ///
+  /// If [onChunk] is not null, it receives the encoded bytes in chunks, and
+  /// [callback] receives an empty list once all chunks are delivered.
+  String _toByteData(int format, bool fastCompression, _Callback<Uint8List> onChunk, _Callback<Uint8List> callback) native 'Image_toByteData';
 
   /// Release the resources used by this object. The object is no longer usable
   /// after this method is called.
@@ -2158,6 +2198,24 @@ class Path extends NativeFieldWrapperClass2 {
   }
   bool _contains(double x, double y) native 'Path_contains';
 
+  /// Tests to see which of the given points are within the path, as
+  /// [contains] would for each of them.
+  ///
+  /// The `points` argument is a list of interleaved x and y coordinates.
+  ///
+  /// Returns a list with one entry per point, which is 1 if the point is in
+  /// the path and 0 otherwise.
+  ///
+  /// Testing many points at once is faster than calling [contains] for each
+  /// of them. A path that is tested many times without changing is also
+  /// indexed to find the parts of it near a point faster.
+  Uint8List containsPoints(Float32List points) {
+    assert(points != null);
+    assert(points.length.isEven, '"points" must have an even number of values.');
+    return _containsPoints(points);
+  }
+  Uint8List _containsPoints(Float32List points) native 'Path_containsPoints';
+
   /// Returns a copy of the path with all the segments of every
   /// sub-path translated by the given offset.
   Path shift(Offset offset) {
@@ -2405,6 +2463,20 @@ class PathMetric {
     return _measure.getTangentForOffset(contourIndex, distance);
   }
 
+  /// Computes the positions and the vectors of the tangents of the current
+  /// contour at each of the given offsets, as [getTangentForOffset] would.
+  ///
+  /// Returns a list with four values per offset: the x and y coordinates of
+  /// the position, followed by the x and y coordinates of the vector of the
+  /// tangent. The values are all NaN if the contour has zero [length].
+  ///
+  /// Computing many tangents at once is faster than calling
+  /// [getTangentForOffset] for each of them.
+  Float32List getTangentsForOffsets(Float32List distances) {
+    assert(distances != null);
+    return _measure.getTangentsForOffsets(contourIndex, distances);
+  }
+
   /// Given a start and stop distance, return the intervening segment(s).
   ///
   /// `start` and `end` are pinned to legal values (0..[length])
@@ -2446,6 +2518,12 @@ class _PathMeasure extends NativeFieldWrapperClass2 {
   }
   Float32List _getPosTan(int contourIndex, double distance) native 'PathMeasure_getPosTan';
 
+  Float32List getTangentsForOffsets(int contourIndex, Float32List distances) {
+    assert(contourIndex <= currentContourIndex, 'Iterator must be advanced before index $contourIndex can be used.');
+    return _getPosTans(contourIndex, distances);
+  }
+  Float32List _getPosTans(int contourIndex, Float32List distances) native 'PathMeasure_getPosTans';
+
   Path extractPath(int contourIndex, double start, double end, {bool startWithMoveTo = true}) {
     assert(contourIndex <= currentContourIndex, 'Iterator must be advanced before index $contourIndex can be used.');
     return _extractPath(contourIndex, start, end, startWithMoveTo: startWithMoveTo);
@@ -3360,11 +3438,12 @@ class Canvas extends NativeFieldWrapperClass2 {
   /// To end the recording, call [PictureRecorder.endRecording] on the
   /// given recorder.
   @pragma('vm:entry-point')
-  Canvas(PictureRecorder recorder, [ Rect cullRect ]) : assert(recorder != null) {
+  Canvas(PictureRecorder recorder, [ Rect cullRect ]) : assert(recorder != null), _recorder = recorder {
     if (recorder.isRecording)
       throw ArgumentError('"recorder" must not already be associated with another Canvas.');
     cullRect ??= Rect.largest;
     _constructor(recorder, cullRect.left, cullRect.top, cullRect.right, cullRect.bottom);
+    recorder._canvas = this;
   }
   void _constructor(PictureRecorder recorder,
                     double left,
@@ -3372,6 +3451,173 @@ class Canvas extends NativeFieldWrapperClass2 {
                     double right,
                     double bottom) native 'Canvas_constructor';
 
+  // The recorder owns the SkCanvas the operations of this canvas are replayed
+  // into. Keeping it alive keeps that SkCanvas alive while this canvas has
+  // operations in the buffers, even if the recording is abandoned.
+  final PictureRecorder _recorder; // ignore: unused_field
+
+  // Most operations are not sent to the engine one at a time. They are
+  // encoded into these buffers, which are shared by all canvases, and replayed
+  // by a single call to _replay when the buffers fill up, before any
+  // operation that is sent to the engine directly, before another canvas
+  // records into the buffers, and when the recording ends.
+  //
+  // * _ops holds the opcode of each operation followed by its integer
+  //   arguments. Operations that take a paint refer to it by its index in
+  //   _paintData.
+  // * _opArgs holds the floating point arguments of the operations.
+  // * _paintData and _paintObjects hold copies of the Paint._data and
+  //   Paint._objects of the paints used by the operations. Operations that
+  //   use the same paint state share one copy.
+  //
+  // The encoding must match CanvasOp in canvas_ops.h.
+  static const int _kSaveOp = 0;
+  static const int _kSaveLayerWithoutBoundsOp = 1;
+  static const int _kSaveLayerOp = 2;
+  static const int _kRestoreOp = 3;
+  static const int _kTranslateOp = 4;
+  static const int _kScaleOp = 5;
+  static const int _kRotateOp = 6;
+  static const int _kSkewOp = 7;
+  static const int _kTransformOp = 8;
+  static const int _kClipRectOp = 9;
+  static const int _kClipRRectOp = 10;
+  static const int _kDrawColorOp = 11;
+  static const int _kDrawLineOp = 12;
+  static const int _kDrawPaintOp = 13;
+  static const int _kDrawRectOp = 14;
+  static const int _kDrawRRectOp = 15;
+  static const int _kDrawDRRectOp = 16;
+  static const int _kDrawOvalOp = 17;
+  static const int _kDrawCircleOp = 18;
+  static const int _kDrawArcOp = 19;
+
+  static const int _kOpCapacity = 2048;
+  static const int _kOpArgCapacity = 8192;
+  static const int _kPaintCapacity = 128;
+  static const int _kPaintDataWordCount = Paint._kDataByteCount ~/ 4;
+  // How many of the most recently recorded paints are compared to a paint
+  // before recording another copy of it.
+  static const int _kRecentPaintCount = 4;
+
+  // The indices of the values of an SkMatrix in a 4x4 matrix.
+  static const List<int> _kMatrix4Indices = <int>[0, 4, 12, 1, 5, 13, 3, 7, 15];
+
+  static Canvas _opsOwner;
+  static Uint32List _ops;
+  static int _opCount = 0;
+  static Float32List _opArgs;
+  static int _opArgCount = 0;
+  static Uint32List _paintData;
+  static int _paintCount = 0;
+  static final List<dynamic> _paintObjects = <dynamic>[];
+
+  // Starts recording an operation with the given number of integer and
+  // floating point arguments, which the caller adds right after.
+  void _beginOp(int op, int wordCount, int argCount) {
+    if (!identical(_opsOwner, this)) {
+      _opsOwner?._replayOps();
+      _opsOwner = this;
+    }
+    if (_ops == null) {
+      _ops = Uint32List(_kOpCapacity);
+      _opArgs = Float32List(_kOpArgCapacity);
+      _paintData = Uint32List(_kPaintCapacity * _kPaintDataWordCount);
+    } else if (_opCount + 1 + wordCount > _kOpCapacity ||
+               _opArgCount + argCount > _kOpArgCapacity ||
+               _paintCount == _kPaintCapacity) {
+      _replayOps();
+      _opsOwner = this;
+    }
+    _ops[_opCount++] = op;
+  }
+
+  void _addWord(int word) {
+    _ops[_opCount++] = word;
+  }
+
+  void _addBool(bool value) {
+    _ops[_opCount++] = value ? 1 : 0;
+  }
+
+  void _addArg(double arg) {
+    _opArgs[_opArgCount++] = arg;
+  }
+
+  void _addRect(Rect rect) {
+    _opArgs[_opArgCount++] = rect.left;
+    _opArgs[_opArgCount++] = rect.top;
+    _opArgs[_opArgCount++] = rect.right;
+    _opArgs[_opArgCount++] = rect.bottom;
+  }
+
+  void _addRRect(RRect rrect) {
+    final Float32List value = rrect._value32;
+    for (int i = 0; i < 12; i += 1)
+      _opArgs[_opArgCount++] = value[i];
+  }
+
+  void _addPaint(Paint paint) {
+    _ops[_opCount++] = _recordPaint(paint);
+  }
+
+  // Returns the index of a copy of the state of the paint, recording one if
+  // none of the recent paints match.
+  static int _recordPaint(Paint paint) {
+    final ByteData data = paint._data;
+    final List<dynamic> objects = paint._objects;
+    final int oldest = math.max(0, _paintCount - _kRecentPaintCount);
+    for (int index = _paintCount - 1; index >= oldest; index -= 1) {
+      if (_recordedPaintMatches(index, data, objects))
+        return index;
+    }
+
+    final int index = _paintCount++;
+    final int dataOffset = index * _kPaintDataWordCount;
+    for (int i = 0; i < _kPaintDataWordCount; i += 1)
+      _paintData[dataOffset + i] = data.getUint32(i << 2, _kFakeHostEndian);
+    for (int i = 0; i < Paint._kObjectCount; i += 1)
+      _paintObjects.add(objects == null ? null : objects[i]);
+    return index;
+  }
+
+  static bool _recordedPaintMatches(int index, ByteData data, List<dynamic> objects) {
+    final int objectOffset = index * Paint._kObjectCount;
+    for (int i = 0; i < Paint._kObjectCount; i += 1) {
+      if (!identical(_paintObjects[objectOffset + i], objects == null ? null : objects[i]))
+        return false;
+    }
+    final int dataOffset = index * _kPaintDataWordCount;
+    for (int i = 0; i < _kPaintDataWordCount; i += 1) {
+      if (_paintData[dataOffset + i] != data.getUint32(i << 2, _kFakeHostEndian))
+        return false;
+    }
+    return true;
+  }
+
+  // Sends the operations this canvas recorded into the buffers to the engine.
+  void _replayOps() {
+    if (!identical(_opsOwner, this))
+      return;
+    _opsOwner = null;
+    if (_opCount == 0)
+      return;
+    _replay(
+      _paintObjects,
+      _paintData.buffer.asByteData(0, _paintCount * Paint._kDataByteCount),
+      _ops.buffer.asUint32List(0, _opCount),
+      _opArgs.buffer.asFloat32List(0, _opArgCount),
+    );
+    _opCount = 0;
+    _opArgCount = 0;
+    _paintCount = 0;
+    _paintObjects.clear();
+  }
+  void _replay(List<dynamic> paintObjects,
+               ByteData paintData,
+               Uint32List ops,
+               Float32List args) native 'Canvas_replay';
+
   /// Saves a copy of the current transform and clip on the save stack.
   ///
   /// Call [restore] to pop the save stack.
@@ -3380,7 +3626,9 @@ class Canvas extends NativeFieldWrapperClass2 {
   ///
   ///  * [saveLayer], which does the same thing but additionally also groups the
   ///    commands done until the matching [restore].
-  void save() native 'Canvas_save';
+  void save() {
+    _beginOp(_kSaveOp, 0, 0);
+  }
 
   /// Saves a copy of the current transform and clip on the save stack, and then
   /// creates a new group which subsequent calls will become a part of. When the
@@ -3494,21 +3742,15 @@ class Canvas extends NativeFieldWrapperClass2 {
   void saveLayer(Rect bounds, Paint paint) {
     assert(paint != null);
     if (bounds == null) {
-      _saveLayerWithoutBounds(paint._objects, paint._data);
+      _beginOp(_kSaveLayerWithoutBoundsOp, 1, 0);
+      _addPaint(paint);
     } else {
       assert(_rectIsValid(bounds));
-      _saveLayer(bounds.left, bounds.top, bounds.right, bounds.bottom,
-                 paint._objects, paint._data);
+      _beginOp(_kSaveLayerOp, 1, 4);
+      _addPaint(paint);
+      _addRect(bounds);
     }
   }
-  void _saveLayerWithoutBounds(List<dynamic> paintObjects, ByteData paintData)
-      native 'Canvas_saveLayerWithoutBounds';
-  void _saveLayer(double left,
-                  double top,
-                  double right,
-                  double bottom,
-                  List<dynamic> paintObjects,
-                  ByteData paintData) native 'Canvas_saveLayer';
 
   /// Pops the current save stack, if there is anything to pop.
   /// Otherwise, does nothing.
@@ -3517,7 +3759,9 @@ class Canvas extends NativeFieldWrapperClass2 {
   ///
   /// If the state was pushed with with [saveLayer], then this call will also
   /// cause the new layer to be composited into the previous layer.
-  void restore() native 'Canvas_restore';
+  void restore() {
+    _beginOp(_kRestoreOp, 0, 0);
+  }
 
   /// Returns the number of items on the save stack, including the
   /// initial state. This means it returns 1 for a clean canvas, and
@@ -3525,11 +3769,19 @@ class Canvas extends NativeFieldWrapperClass2 {
   /// each matching call to [restore] decrements it.
   ///
   /// This number cannot go below 1.
-  int getSaveCount() native 'Canvas_getSaveCount';
+  int getSaveCount() {
+    _replayOps();
+    return _getSaveCount();
+  }
+  int _getSaveCount() native 'Canvas_getSaveCount';
 
   /// Add a translation to the current transform, shifting the coordinate space
   /// horizontally by the first argument and vertically by the second argument.
-  void translate(double dx, double dy) native 'Canvas_translate';
+  void translate(double dx, double dy) {
+    _beginOp(_kTranslateOp, 0, 2);
+    _addArg(dx);
+    _addArg(dy);
+  }
 
   /// Add an axis-aligned scale to the current transform, scaling by the first
   /// argument in the horizontal direction and the second in the vertical
@@ -3537,18 +3789,27 @@ class Canvas extends NativeFieldWrapperClass2 {
   ///
   /// If [sy] is unspecified, [sx] will be used for the scale in both
   /// directions.
-  void scale(double sx, [double sy]) => _scale(sx, sy ?? sx);
-
-  void _scale(double sx, double sy) native 'Canvas_scale';
+  void scale(double sx, [double sy]) {
+    _beginOp(_kScaleOp, 0, 2);
+    _addArg(sx);
+    _addArg(sy ?? sx);
+  }
 
   /// Add a rotation to the current transform. The argument is in radians clockwise.
-  void rotate(double radians) native 'Canvas_rotate';
+  void rotate(double radians) {
+    _beginOp(_kRotateOp, 0, 1);
+    _addArg(radians);
+  }
 
   /// Add an axis-aligned skew to the current transform, with the first argument
   /// being the horizontal skew in rise over run units clockwise around the
   /// origin, and the second argument being the vertical skew in rise over run
   /// units clockwise around the origin.
-  void skew(double sx, double sy) native 'Canvas_skew';
+  void skew(double sx, double sy) {
+    _beginOp(_kSkewOp, 0, 2);
+    _addArg(sx);
+    _addArg(sy);
+  }
 
   /// Multiply the current transform by the specified 4⨉4 transformation matrix
   /// specified as a list of values in column-major order.
@@ -3556,9 +3817,10 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(matrix4 != null);
     if (matrix4.length != 16)
       throw ArgumentError('"matrix4" must have 16 entries.');
-    _transform(matrix4);
+    _beginOp(_kTransformOp, 0, _kMatrix4Indices.length);
+    for (final int index in _kMatrix4Indices)
+      _addArg(matrix4[index]);
   }
-  void _transform(Float64List matrix4) native 'Canvas_transform';
 
   /// Reduces the clip region to the intersection of the current clip and the
   /// given rectangle.
@@ -3575,14 +3837,11 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(_rectIsValid(rect));
     assert(clipOp != null);
     assert(doAntiAlias != null);
-    _clipRect(rect.left, rect.top, rect.right, rect.bottom, clipOp.index, doAntiAlias);
+    _beginOp(_kClipRectOp, 2, 4);
+    _addWord(clipOp.index);
+    _addBool(doAntiAlias);
+    _addRect(rect);
   }
-  void _clipRect(double left,
-                 double top,
-                 double right,
-                 double bottom,
-                 int clipOp,
-                 bool doAntiAlias) native 'Canvas_clipRect';
 
   /// Reduces the clip region to the intersection of the current clip and the
   /// given rounded rectangle.
@@ -3595,9 +3854,10 @@ class Canvas extends NativeFieldWrapperClass2 {
   void clipRRect(RRect rrect, {bool doAntiAlias = true}) {
     assert(_rrectIsValid(rrect));
     assert(doAntiAlias != null);
-    _clipRRect(rrect._value32, doAntiAlias);
+    _beginOp(_kClipRRectOp, 1, 12);
+    _addBool(doAntiAlias);
+    _addRRect(rrect);
   }
-  void _clipRRect(Float32List rrect, bool doAntiAlias) native 'Canvas_clipRRect';
 
   /// Reduces the clip region to the intersection of the current clip and the
   /// given [Path].
@@ -3611,6 +3871,7 @@ class Canvas extends NativeFieldWrapperClass2 {
   void clipPath(Path path, {bool doAntiAlias = true}) {
     assert(path != null); // path is checked on the engine side
     assert(doAntiAlias != null);
+    _replayOps();
     _clipPath(path, doAntiAlias);
   }
   void _clipPath(Path path, bool doAntiAlias) native 'Canvas_clipPath';
@@ -3621,9 +3882,10 @@ class Canvas extends NativeFieldWrapperClass2 {
   void drawColor(Color color, BlendMode blendMode) {
     assert(color != null);
     assert(blendMode != null);
-    _drawColor(color.value, blendMode.index);
+    _beginOp(_kDrawColorOp, 2, 0);
+    _addWord(color.value);
+    _addWord(blendMode.index);
   }
-  void _drawColor(int color, int blendMode) native 'Canvas_drawColor';
 
   /// Draws a line between the given points using the given paint. The line is
   /// stroked, the value of the [Paint.style] is ignored for this call.
@@ -3633,14 +3895,13 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(_offsetIsValid(p1));
     assert(_offsetIsValid(p2));
     assert(paint != null);
-    _drawLine(p1.dx, p1.dy, p2.dx, p2.dy, paint._objects, paint._data);
+    _beginOp(_kDrawLineOp, 1, 4);
+    _addPaint(paint);
+    _addArg(p1.dx);
+    _addArg(p1.dy);
+    _addArg(p2.dx);
+    _addArg(p2.dy);
   }
-  void _drawLine(double x1,
-                 double y1,
-                 double x2,
-                 double y2,
-                 List<dynamic> paintObjects,
-                 ByteData paintData) native 'Canvas_drawLine';
 
   /// Fills the canvas with the given [Paint].
   ///
@@ -3648,35 +3909,29 @@ class Canvas extends NativeFieldWrapperClass2 {
   /// [drawColor] instead.
   void drawPaint(Paint paint) {
     assert(paint != null);
-    _drawPaint(paint._objects, paint._data);
+    _beginOp(_kDrawPaintOp, 1, 0);
+    _addPaint(paint);
   }
-  void _drawPaint(List<dynamic> paintObjects, ByteData paintData) native 'Canvas_drawPaint';
 
   /// Draws a rectangle with the given [Paint]. Whether the rectangle is filled
   /// or stroked (or both) is controlled by [Paint.style].
   void drawRect(Rect rect, Paint paint) {
     assert(_rectIsValid(rect));
     assert(paint != null);
-    _drawRect(rect.left, rect.top, rect.right, rect.bottom,
-              paint._objects, paint._data);
+    _beginOp(_kDrawRectOp, 1, 4);
+    _addPaint(paint);
+    _addRect(rect);
   }
-  void _drawRect(double left,
-                 double top,
-                 double right,
-                 double bottom,
-                 List<dynamic> paintObjects,
-                 ByteData paintData) native 'Canvas_drawRect';
 
   /// Draws a rounded rectangle with the given [Paint]. Whether the rectangle is
   /// filled or stroked (or both) is controlled by [Paint.style].
   void drawRRect(RRect rrect, Paint paint) {
     assert(_rrectIsValid(rrect));
     assert(paint != null);
-    _drawRRect(rrect._value32, paint._objects, paint._data);
+    _beginOp(_kDrawRRectOp, 1, 12);
+    _addPaint(paint);
+    _addRRect(rrect);
   }
-  void _drawRRect(Float32List rrect,
-                  List<dynamic> paintObjects,
-                  ByteData paintData) native 'Canvas_drawRRect';
 
   /// Draws a shape consisting of the difference between two rounded rectangles
   /// with the given [Paint]. Whether this shape is filled or stroked (or both)
@@ -3687,12 +3942,11 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(_rrectIsValid(outer));
     assert(_rrectIsValid(inner));
     assert(paint != null);
-    _drawDRRect(outer._value32, inner._value32, paint._objects, paint._data);
+    _beginOp(_kDrawDRRectOp, 1, 24);
+    _addPaint(paint);
+    _addRRect(outer);
+    _addRRect(inner);
   }
-  void _drawDRRect(Float32List outer,
-                   Float32List inner,
-                   List<dynamic> paintObjects,
-                   ByteData paintData) native 'Canvas_drawDRRect';
 
   /// Draws an axis-aligned oval that fills the given axis-aligned rectangle
   /// with the given [Paint]. Whether the oval is filled or stroked (or both) is
@@ -3700,15 +3954,10 @@ class Canvas extends NativeFieldWrapperClass2 {
   void drawOval(Rect rect, Paint paint) {
     assert(_rectIsValid(rect));
     assert(paint != null);
-    _drawOval(rect.left, rect.top, rect.right, rect.bottom,
-              paint._objects, paint._data);
+    _beginOp(_kDrawOvalOp, 1, 4);
+    _addPaint(paint);
+    _addRect(rect);
   }
-  void _drawOval(double left,
-                 double top,
-                 double right,
-                 double bottom,
-                 List<dynamic> paintObjects,
-                 ByteData paintData) native 'Canvas_drawOval';
 
   /// Draws a circle centered at the point given by the first argument and
   /// that has the radius given by the second argument, with the [Paint] given in
@@ -3717,13 +3966,12 @@ class Canvas extends NativeFieldWrapperClass2 {
   void drawCircle(Offset c, double radius, Paint paint) {
     assert(_offsetIsValid(c));
     assert(paint != null);
-    _drawCircle(c.dx, c.dy, radius, paint._objects, paint._data);
+    _beginOp(_kDrawCircleOp, 1, 3);
+    _addPaint(paint);
+    _addArg(c.dx);
+    _addArg(c.dy);
+    _addArg(radius);
   }
-  void _drawCircle(double x,
-                   double y,
-                   double radius,
-                   List<dynamic> paintObjects,
-                   ByteData paintData) native 'Canvas_drawCircle';
 
   /// Draw an arc scaled to fit inside the given rectangle. It starts from
   /// startAngle radians around the oval up to startAngle + sweepAngle
@@ -3738,18 +3986,13 @@ class Canvas extends NativeFieldWrapperClass2 {
   void drawArc(Rect rect, double startAngle, double sweepAngle, bool useCenter, Paint paint) {
     assert(_rectIsValid(rect));
     assert(paint != null);
-    _drawArc(rect.left, rect.top, rect.right, rect.bottom, startAngle,
-             sweepAngle, useCenter, paint._objects, paint._data);
-  }
-  void _drawArc(double left,
-                double top,
-                double right,
-                double bottom,
-                double startAngle,
-                double sweepAngle,
-                bool useCenter,
-                List<dynamic> paintObjects,
-                ByteData paintData) native 'Canvas_drawArc';
+    _beginOp(_kDrawArcOp, 2, 6);
+    _addPaint(paint);
+    _addBool(useCenter);
+    _addRect(rect);
+    _addArg(startAngle);
+    _addArg(sweepAngle);
+  }
 
   /// Draws the given [Path] with the given [Paint]. Whether this shape is
   /// filled or stroked (or both) is controlled by [Paint.style]. If the path is
@@ -3757,6 +4000,7 @@ class Canvas extends NativeFieldWrapperClass2 {
   void drawPath(Path path, Paint paint) {
     assert(path != null); // path is checked on the engine side
     assert(paint != null);
+    _replayOps();
     _drawPath(path, paint._objects, paint._data);
   }
   void _drawPath(Path path,
@@ -3769,6 +4013,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(image != null); // image is checked on the engine side
     assert(_offsetIsValid(p));
     assert(paint != null);
+    _replayOps();
     _drawImage(image, p.dx, p.dy, paint._objects, paint._data);
   }
   void _drawImage(Image image,
@@ -3791,6 +4036,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(_rectIsValid(src));
     assert(_rectIsValid(dst));
     assert(paint != null);
+    _replayOps();
     _drawImageRect(image,
                    src.left,
                    src.top,
@@ -3833,6 +4079,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(_rectIsValid(center));
     assert(_rectIsValid(dst));
     assert(paint != null);
+    _replayOps();
     _drawImageNine(image,
                    center.left,
                    center.top,
@@ -3861,6 +4108,7 @@ class Canvas extends NativeFieldWrapperClass2 {
   /// [PictureRecorder].
   void drawPicture(Picture picture) {
     assert(picture != null); // picture is checked on the engine side
+    _replayOps();
     _drawPicture(picture);
   }
   void _drawPicture(Picture picture) native 'Canvas_drawPicture';
@@ -3888,6 +4136,7 @@ class Canvas extends NativeFieldWrapperClass2 {
   void drawParagraph(Paragraph paragraph, Offset offset) {
     assert(paragraph != null);
     assert(_offsetIsValid(offset));
+    _replayOps();
     paragraph._paint(this, offset.dx, offset.dy);
   }
 
@@ -3903,6 +4152,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(pointMode != null);
     assert(points != null);
     assert(paint != null);
+    _replayOps();
     _drawPoints(paint._objects, paint._data, pointMode.index, _encodePointList(points));
   }
 
@@ -3921,6 +4171,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(paint != null);
     if (points.length % 2 != 0)
       throw ArgumentError('"points" must have an even number of values.');
+    _replayOps();
     _drawPoints(paint._objects, paint._data, pointMode.index, points);
   }
 
@@ -3941,6 +4192,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(vertices != null); // vertices is checked on the engine side
     assert(paint != null);
     assert(blendMode != null);
+    _replayOps();
     _drawVertices(vertices, blendMode.index, paint._objects, paint._data);
   }
   void _drawVertices(Vertices vertices,
@@ -4004,6 +4256,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     final Int32List colorBuffer = colors.isEmpty ? null : _encodeColorList(colors);
     final Float32List cullRectBuffer = cullRect?._value32;
 
+    _replayOps();
     _drawAtlas(
       paint._objects, paint._data, atlas, rstTransformBuffer, rectBuffer,
       colorBuffer, blendMode.index, cullRectBuffer
@@ -4052,6 +4305,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     if (colors != null && colors.length * 4 != rectCount)
       throw ArgumentError('If non-null, "colors" length must be one fourth the length of "rstTransforms" and "rects".');
 
+    _replayOps();
     _drawAtlas(
       paint._objects, paint._data, atlas, rstTransforms, rects,
       colors, blendMode.index, cullRect?._value32
@@ -4077,6 +4331,7 @@ class Canvas extends NativeFieldWrapperClass2 {
     assert(path != null); // path is checked on the engine side
     assert(color != null);
     assert(transparentOccluder != null);
+    _replayOps();
     _drawShadow(path, color.value, elevation, transparentOccluder);
   }
   void _drawShadow(Path path,
@@ -4151,6 +4406,8 @@ class PictureRecorder extends NativeFieldWrapperClass2 {
   /// or the [endRecording] method has already been called.
   bool get isRecording native 'PictureRecorder_isRecording';
 
+  Canvas _canvas;
+
   /// Finishes recording graphical operations.
   ///
   /// Returns a picture containing the graphical operations that have been
@@ -4158,7 +4415,12 @@ class PictureRecorder extends NativeFieldWrapperClass2 {
   /// and the canvas objects are invalid and cannot be used further.
   ///
   /// Returns null if the PictureRecorder is not associated with a canvas.
-  Picture endRecording() native 'PictureRecorder_endRecording';
+  Picture endRecording() {
+    _canvas?._replayOps();
+    _canvas = null;
+    return _endRecording();
+  }
+  Picture _endRecording() native 'PictureRecorder_endRecording';
 }
 
 /// A single shadow.
@@ -0,0 +1,267 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/animated_frame_decoder.h"
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkMallocPixelRef.h"
+
+namespace flutter {
+
+static SkImageInfo FrameInfoForCodec(const SkCodec& codec) {
+  SkImageInfo info = codec.getInfo().makeColorType(kN32_SkColorType);
+  if (info.alphaType() == kUnpremul_SkAlphaType) {
+    info = info.makeAlphaType(kPremul_SkAlphaType);
+  }
+  return info;
+}
+
+static bool FramesFitInCache(const SkImageInfo& info,
+                             int frame_count,
+                             size_t max_bytes) {
+  if (frame_count <= 0) {
+    return false;
+  }
+  const size_t frame_bytes = info.computeMinByteSize();
+  return frame_bytes <= max_bytes / frame_count;
+}
+
+// Returns a frame's buffer to the pool once the image using it is gone.
+static void ReleaseBuffer(const void* pixels, SkImage::ReleaseContext context) {
+  static_cast<SkPixelRef*>(context)->unref();
+}
+
+std::shared_ptr<AnimatedFrameDecoder> AnimatedFrameDecoder::Create(
+    std::unique_ptr<SkCodec> codec,
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+    Options options) {
+  if (!codec) {
+    return nullptr;
+  }
+  return std::shared_ptr<AnimatedFrameDecoder>(new AnimatedFrameDecoder(
+      std::move(codec), std::move(worker_task_runner), options));
+}
+
+AnimatedFrameDecoder::AnimatedFrameDecoder(
+    std::unique_ptr<SkCodec> codec,
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+    Options options)
+    : codec_(std::move(codec)),
+      worker_task_runner_(std::move(worker_task_runner)),
+      options_(options),
+      info_(FrameInfoForCodec(*codec_)),
+      frame_count_(codec_->getFrameCount()),
+      repetition_count_(codec_->getRepetitionCount()),
+      caching_frames_(FramesFitInCache(info_,
+                                       frame_count_,
+                                       options.frame_cache_max_bytes)) {
+  if (caching_frames_) {
+    cached_frames_.resize(frame_count_);
+  }
+}
+
+AnimatedFrameDecoder::~AnimatedFrameDecoder() = default;
+
+int AnimatedFrameDecoder::GetFrameCount() const {
+  return frame_count_;
+}
+
+int AnimatedFrameDecoder::GetRepetitionCount() const {
+  return repetition_count_;
+}
+
+bool AnimatedFrameDecoder::IsCachingFrames() const {
+  return caching_frames_;
+}
+
+size_t AnimatedFrameDecoder::GetBufferAllocationCount() const {
+  std::scoped_lock lock(decode_mutex_);
+  return buffer_allocation_count_;
+}
+
+AnimatedFrameDecoder::Frame AnimatedFrameDecoder::GetNextFrame() {
+  Frame frame;
+  bool found = false;
+  {
+    std::scoped_lock lock(ready_mutex_);
+    if (!ready_frames_.empty()) {
+      frame = std::move(ready_frames_.front());
+      ready_frames_.pop_front();
+      found = true;
+    }
+  }
+
+  if (!found) {
+    std::scoped_lock decode_lock(decode_mutex_);
+    // A prefetch may have decoded the frame while this waited for it to finish.
+    std::unique_lock ready_lock(ready_mutex_);
+    if (!ready_frames_.empty()) {
+      frame = std::move(ready_frames_.front());
+      ready_frames_.pop_front();
+    } else {
+      ready_lock.unlock();
+      frame = DecodeNextFrameLocked();
+    }
+  }
+
+  SchedulePrefetch();
+  return frame;
+}
+
+void AnimatedFrameDecoder::SchedulePrefetch() {
+  if (!worker_task_runner_ || options_.prefetch_count == 0) {
+    return;
+  }
+
+  {
+    std::scoped_lock lock(ready_mutex_);
+    if (prefetch_pending_ ||
+        ready_frames_.size() >= options_.prefetch_count) {
+      return;
+    }
+    prefetch_pending_ = true;
+  }
+
+  worker_task_runner_->PostTask([weak_decoder = weak_from_this()]() {
+    if (auto decoder = weak_decoder.lock()) {
+      decoder->Prefetch();
+    }
+  });
+}
+
+void AnimatedFrameDecoder::Prefetch() {
+  TRACE_EVENT0("flutter", "AnimatedFrameDecoder::Prefetch");
+  while (true) {
+    // The decode lock is dropped between frames so that a caller that ran
+    // out of prefetched frames does not wait for all of them.
+    std::scoped_lock decode_lock(decode_mutex_);
+    {
+      std::scoped_lock lock(ready_mutex_);
+      if (ready_frames_.size() >= options_.prefetch_count) {
+        prefetch_pending_ = false;
+        return;
+      }
+    }
+    Frame frame = DecodeNextFrameLocked();
+    std::scoped_lock lock(ready_mutex_);
+    ready_frames_.push_back(std::move(frame));
+  }
+}
+
+sk_sp<SkPixelRef> AnimatedFrameDecoder::AcquireBufferLocked() {
+  sk_sp<SkPixelRef> free_buffer;
+  size_t spare_count = 0;
+  for (auto it = buffers_.begin(); it != buffers_.end();) {
+    if (!(*it)->unique()) {
+      ++it;
+      continue;
+    }
+    if (!free_buffer) {
+      free_buffer = *it;
+      ++it;
+      continue;
+    }
+    // Frames held on to for a while (for example, by a framework that draws
+    // them without a resource context) may have grown the pool. Only keep
+    // enough spare buffers for the frames being prefetched.
+    if (++spare_count > options_.prefetch_count) {
+      it = buffers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  if (free_buffer) {
+    return free_buffer;
+  }
+
+  auto buffer = SkMallocPixelRef::MakeAllocate(info_, info_.minRowBytes());
+  if (!buffer) {
+    return nullptr;
+  }
+  buffer_allocation_count_++;
+  buffers_.push_back(buffer);
+  return buffer;
+}
+
+AnimatedFrameDecoder::Frame AnimatedFrameDecoder::DecodeNextFrameLocked() {
+  Frame frame;
+  frame.index = next_decode_index_;
+  next_decode_index_ = (next_decode_index_ + 1) % frame_count_;
+
+  SkCodec::FrameInfo frame_info;
+  codec_->getFrameInfo(frame.index, &frame_info);
+  frame.duration = frame_info.fDuration;
+
+  if (caching_frames_ && cached_frames_[frame.index]) {
+    frame.image = cached_frames_[frame.index];
+    return frame;
+  }
+
+  TRACE_EVENT0("flutter", "AnimatedFrameDecoder::DecodeFrame");
+
+  sk_sp<SkPixelRef> buffer = AcquireBufferLocked();
+  if (!buffer) {
+    FML_LOG(ERROR) << "Could not allocate pixels for frame " << frame.index;
+    return frame;
+  }
+
+  SkBitmap bitmap;
+  bitmap.setInfo(info_, buffer->rowBytes());
+  bitmap.setPixelRef(buffer, 0, 0);
+
+  SkCodec::Options options;
+  options.fFrameIndex = frame.index;
+  const int required_frame_index = frame_info.fRequiredFrame;
+  if (required_frame_index != SkCodec::kNoFrame) {
+    if (required_frame_.isNull()) {
+      FML_LOG(ERROR) << "Frame " << frame.index << " depends on frame "
+                     << required_frame_index
+                     << " and no required frames are cached.";
+      return frame;
+    } else if (required_frame_index_ != required_frame_index) {
+      FML_DLOG(INFO) << "Required frame " << required_frame_index
+                     << " is not cached. Using " << required_frame_index_
+                     << " instead";
+    }
+
+    // The required frame holds on to its own buffer, so this never copies a
+    // buffer onto itself.
+    if (required_frame_.readPixels(bitmap.pixmap())) {
+      options.fPriorFrame = required_frame_index;
+    }
+  }
+
+  if (SkCodec::kSuccess != codec_->getPixels(info_, bitmap.getPixels(),
+                                             bitmap.rowBytes(), &options)) {
+    FML_LOG(ERROR) << "Could not getPixels for frame " << frame.index;
+    return frame;
+  }
+
+  // Hold onto this if we need it to decode future frames.
+  if (frame_info.fDisposalMethod == SkCodecAnimation::DisposalMethod::kKeep) {
+    required_frame_ = bitmap;
+    required_frame_index_ = frame.index;
+  }
+
+  // The image shares the buffer instead of copying it. The buffer goes back
+  // to the pool when the image is collected.
+  SkPixelRef* image_buffer = SkRef(buffer.get());
+  frame.image =
+      SkImage::MakeFromRaster(bitmap.pixmap(), &ReleaseBuffer, image_buffer);
+  if (!frame.image) {
+    image_buffer->unref();
+    FML_LOG(ERROR) << "Could not create an image for frame " << frame.index;
+    return frame;
+  }
+
+  if (caching_frames_) {
+    cached_frames_[frame.index] = frame.image;
+  }
+
+  return frame;
+}
+
+}  // namespace flutter
@@ -0,0 +1,126 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_ANIMATED_FRAME_DECODER_H_
+#define FLUTTER_LIB_UI_PAINTING_ANIMATED_FRAME_DECODER_H_
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/codec/SkCodec.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkPixelRef.h"
+
+namespace flutter {
+
+// Decodes the frames of an animated image in order, looping back to the first
+// frame after the last one.
+//
+// Frames are decoded into pixel buffers that are reused once no decoded frame
+// refers to them anymore, and frames that depend on an earlier frame are
+// decoded on top of a copy of it in place. When given a worker task runner,
+// the next few frames are decoded on it ahead of the caller. Animations whose
+// frames all fit in the frame cache are only decoded once.
+//
+// |GetNextFrame| must only be called on one thread at a time. The images it
+// returns are raster images that may be used on any thread.
+class AnimatedFrameDecoder
+    : public std::enable_shared_from_this<AnimatedFrameDecoder> {
+ public:
+  static constexpr size_t kDefaultPrefetchCount = 2;
+
+  // Fifty frames of a 280x280 sticker.
+  static constexpr size_t kDefaultFrameCacheMaxBytes = 16 * 1024 * 1024;
+
+  struct Options {
+    // The number of frames decoded ahead of the caller on the worker task
+    // runner.
+    size_t prefetch_count = kDefaultPrefetchCount;
+    // Animations whose decoded frames take up no more than this are decoded
+    // once and replayed from memory.
+    size_t frame_cache_max_bytes = kDefaultFrameCacheMaxBytes;
+  };
+
+  struct Frame {
+    // Null if the frame could not be decoded.
+    sk_sp<SkImage> image;
+    int index = 0;
+    int duration = 0;
+  };
+
+  // |worker_task_runner| may be null, in which case every frame is decoded
+  // when it is asked for.
+  static std::shared_ptr<AnimatedFrameDecoder> Create(
+      std::unique_ptr<SkCodec> codec,
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+      Options options);
+
+  ~AnimatedFrameDecoder();
+
+  int GetFrameCount() const;
+
+  int GetRepetitionCount() const;
+
+  // Returns the frame after the one returned by the previous call, waiting
+  // for it to be decoded if it has not been prefetched.
+  Frame GetNextFrame();
+
+  // Whether all frames fit in the frame cache.
+  bool IsCachingFrames() const;
+
+  // The number of pixel buffers allocated so far.
+  size_t GetBufferAllocationCount() const;
+
+ private:
+  const std::unique_ptr<SkCodec> codec_;
+  const std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner_;
+  const Options options_;
+  const SkImageInfo info_;
+  const int frame_count_;
+  const int repetition_count_;
+  const bool caching_frames_;
+
+  // Guards the decoding state below. Frames are decoded one at a time and in
+  // order because each may depend on the ones before it.
+  mutable std::mutex decode_mutex_;
+  int next_decode_index_ = 0;
+  // The last decoded frame that's required to decode any subsequent frames.
+  SkBitmap required_frame_;
+  // The index of the last decoded required frame.
+  int required_frame_index_ = -1;
+  // Buffers are free for reuse while the pool holds the only reference.
+  std::vector<sk_sp<SkPixelRef>> buffers_;
+  size_t buffer_allocation_count_ = 0;
+  // Indexed by frame when |caching_frames_|.
+  std::vector<sk_sp<SkImage>> cached_frames_;
+
+  // Guards the decoded frames waiting to be returned.
+  std::mutex ready_mutex_;
+  std::deque<Frame> ready_frames_;
+  bool prefetch_pending_ = false;
+
+  AnimatedFrameDecoder(
+      std::unique_ptr<SkCodec> codec,
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+      Options options);
+
+  Frame DecodeNextFrameLocked();
+
+  sk_sp<SkPixelRef> AcquireBufferLocked();
+
+  void SchedulePrefetch();
+
+  void Prefetch();
+
+  FML_DISALLOW_COPY_AND_ASSIGN(AnimatedFrameDecoder);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_ANIMATED_FRAME_DECODER_H_
@@ -0,0 +1,107 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <chrono>
+#include <thread>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/lib/ui/painting/animated_frame_decoder.h"
+#include "flutter/testing/testing.h"
+
+namespace flutter {
+
+static constexpr char kFixture[] = "hello_loop_2.gif";
+
+static sk_sp<SkData> OpenFixture() {
+  auto fixtures_directory = fml::OpenDirectory(
+      testing::GetFixturesPath(), false, fml::FilePermission::kRead);
+  auto mapping = fml::FileMapping::CreateReadOnly(fixtures_directory, kFixture);
+  FML_CHECK(mapping) << "Could not open " << kFixture;
+  return SkData::MakeWithCopy(mapping->GetMapping(), mapping->GetSize());
+}
+
+static void ReportFrames(benchmark::State& state,
+                         size_t frames,
+                         size_t allocations) {
+  state.SetItemsProcessed(frames);
+  state.counters["allocations_per_frame"] =
+      frames == 0 ? 0.0 : static_cast<double>(allocations) / frames;
+}
+
+// What decoding looked like before |AnimatedFrameDecoder|: a new bitmap for
+// every frame and another one for each copy of a required frame.
+static void BM_DecodeFramesIntoNewBitmaps(benchmark::State& state) {
+  auto codec = SkCodec::MakeFromData(OpenFixture());
+  const SkImageInfo info = codec->getInfo()
+                               .makeColorType(kN32_SkColorType)
+                               .makeAlphaType(kPremul_SkAlphaType);
+  const int frame_count = codec->getFrameCount();
+  std::unique_ptr<SkBitmap> required_frame;
+  int index = 0;
+  size_t frames = 0;
+  size_t allocations = 0;
+
+  while (state.KeepRunning()) {
+    SkBitmap bitmap;
+    bitmap.allocPixels(info);
+    allocations++;
+    SkCodec::FrameInfo frame_info;
+    codec->getFrameInfo(index, &frame_info);
+    SkCodec::Options options;
+    options.fFrameIndex = index;
+    if (frame_info.fRequiredFrame != SkCodec::kNoFrame && required_frame) {
+      SkBitmap copy;
+      copy.allocPixels(info);
+      allocations++;
+      required_frame->readPixels(copy.pixmap());
+      bitmap.swap(copy);
+      options.fPriorFrame = frame_info.fRequiredFrame;
+    }
+    codec->getPixels(info, bitmap.getPixels(), bitmap.rowBytes(), &options);
+    if (frame_info.fDisposalMethod == SkCodecAnimation::DisposalMethod::kKeep) {
+      required_frame = std::make_unique<SkBitmap>(bitmap);
+    }
+    benchmark::DoNotOptimize(SkImage::MakeFromBitmap(bitmap));
+    index = (index + 1) % frame_count;
+    frames++;
+  }
+
+  ReportFrames(state, frames, allocations);
+}
+BENCHMARK(BM_DecodeFramesIntoNewBitmaps);
+
+// Measures the time spent waiting for each frame by a caller that does 4ms of
+// other work between frames, as the framework does while a frame is shown.
+// The arguments are the number of prefetched frames and whether all frames
+// fit in the frame cache.
+static void BM_AnimatedFrameDecoder(benchmark::State& state) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  AnimatedFrameDecoder::Options options;
+  options.prefetch_count = state.range(0);
+  options.frame_cache_max_bytes =
+      state.range(1) ? AnimatedFrameDecoder::kDefaultFrameCacheMaxBytes : 0;
+  auto decoder = AnimatedFrameDecoder::Create(
+      SkCodec::MakeFromData(OpenFixture()), loop->GetTaskRunner(), options);
+  size_t frames = 0;
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(decoder->GetNextFrame());
+    frames++;
+    benchmarking::ScopedPauseTiming pause(state);
+    std::this_thread::sleep_for(std::chrono::milliseconds(4));
+  }
+
+  ReportFrames(state, frames, decoder->GetBufferAllocationCount());
+  decoder.reset();
+  loop->Terminate();
+}
+BENCHMARK(BM_AnimatedFrameDecoder)
+    ->Args({0, 0})
+    ->Args({0, 1})
+    ->Args({2, 0})
+    ->Args({2, 1});
+
+}  // namespace flutter
@@ -0,0 +1,141 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/animated_frame_decoder.h"
+
+#include <cstring>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/testing/testing.h"
+
+namespace flutter {
+namespace testing {
+
+static std::unique_ptr<SkCodec> OpenFixtureAsCodec(const char* name) {
+  auto fixtures_directory =
+      fml::OpenDirectory(GetFixturesPath(), false, fml::FilePermission::kRead);
+  auto mapping = fml::FileMapping::CreateReadOnly(fixtures_directory, name);
+  if (!mapping) {
+    return nullptr;
+  }
+  return SkCodec::MakeFromData(
+      SkData::MakeWithCopy(mapping->GetMapping(), mapping->GetSize()));
+}
+
+static bool FramesHaveSamePixels(const sk_sp<SkImage>& a,
+                                 const sk_sp<SkImage>& b) {
+  SkPixmap a_pixmap, b_pixmap;
+  if (!a || !b || !a->peekPixels(&a_pixmap) || !b->peekPixels(&b_pixmap)) {
+    return false;
+  }
+  return a_pixmap.info() == b_pixmap.info() &&
+         a_pixmap.computeByteSize() == b_pixmap.computeByteSize() &&
+         std::memcmp(a_pixmap.addr(), b_pixmap.addr(),
+                     a_pixmap.computeByteSize()) == 0;
+}
+
+static AnimatedFrameDecoder::Options OnDemandOptions() {
+  AnimatedFrameDecoder::Options options;
+  options.prefetch_count = 0;
+  options.frame_cache_max_bytes = 0;
+  return options;
+}
+
+TEST(AnimatedFrameDecoderTest, ReusesBuffersOfReleasedFrames) {
+  for (auto fixture : {"hello_loop_2.gif", "hello_loop_2.webp"}) {
+    auto decoder = AnimatedFrameDecoder::Create(OpenFixtureAsCodec(fixture),
+                                                nullptr, OnDemandOptions());
+    ASSERT_TRUE(decoder);
+    ASSERT_GT(decoder->GetFrameCount(), 1);
+    ASSERT_FALSE(decoder->IsCachingFrames());
+
+    for (int i = 0; i < decoder->GetFrameCount() * 3; i++) {
+      auto frame = decoder->GetNextFrame();
+      ASSERT_TRUE(frame.image);
+      ASSERT_EQ(frame.index, i % decoder->GetFrameCount());
+    }
+
+    // One buffer for the frame being decoded and at most one for the frame
+    // it depends on.
+    ASSERT_LE(decoder->GetBufferAllocationCount(), 2u);
+  }
+}
+
+TEST(AnimatedFrameDecoderTest, BuffersOfHeldFramesAreNotReused) {
+  auto decoder = AnimatedFrameDecoder::Create(
+      OpenFixtureAsCodec("hello_loop_2.gif"), nullptr, OnDemandOptions());
+  ASSERT_TRUE(decoder);
+
+  auto first = decoder->GetNextFrame();
+  ASSERT_TRUE(first.image);
+  SkBitmap first_copy;
+  ASSERT_TRUE(first_copy.tryAllocPixels(first.image->imageInfo()));
+  ASSERT_TRUE(first.image->readPixels(first_copy.pixmap(), 0, 0));
+
+  for (int i = 1; i < decoder->GetFrameCount() * 2; i++) {
+    ASSERT_TRUE(decoder->GetNextFrame().image);
+  }
+
+  ASSERT_TRUE(
+      FramesHaveSamePixels(first.image, SkImage::MakeFromBitmap(first_copy)));
+}
+
+TEST(AnimatedFrameDecoderTest, FrameCacheReplaysTheSameFrames) {
+  AnimatedFrameDecoder::Options cached_options = OnDemandOptions();
+  cached_options.frame_cache_max_bytes = 64 * 1024 * 1024;
+  auto cached = AnimatedFrameDecoder::Create(
+      OpenFixtureAsCodec("hello_loop_2.gif"), nullptr, cached_options);
+  auto on_demand = AnimatedFrameDecoder::Create(
+      OpenFixtureAsCodec("hello_loop_2.gif"), nullptr, OnDemandOptions());
+  ASSERT_TRUE(cached);
+  ASSERT_TRUE(on_demand);
+  ASSERT_TRUE(cached->IsCachingFrames());
+
+  const int frame_count = cached->GetFrameCount();
+  std::vector<sk_sp<SkImage>> first_loop;
+  for (int i = 0; i < frame_count * 3; i++) {
+    auto cached_frame = cached->GetNextFrame();
+    auto on_demand_frame = on_demand->GetNextFrame();
+    ASSERT_EQ(cached_frame.duration, on_demand_frame.duration);
+    ASSERT_TRUE(
+        FramesHaveSamePixels(cached_frame.image, on_demand_frame.image));
+    if (i < frame_count) {
+      first_loop.push_back(cached_frame.image);
+    } else {
+      // Later loops are not decoded again.
+      ASSERT_EQ(cached_frame.image, first_loop[i % frame_count]);
+    }
+  }
+
+  ASSERT_EQ(cached->GetBufferAllocationCount(),
+            static_cast<size_t>(frame_count));
+}
+
+TEST(AnimatedFrameDecoderTest, PrefetchedFramesAreReturnedInOrder) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  AnimatedFrameDecoder::Options options = OnDemandOptions();
+  options.prefetch_count = 3;
+  auto prefetching = AnimatedFrameDecoder::Create(
+      OpenFixtureAsCodec("hello_loop_2.webp"), loop->GetTaskRunner(), options);
+  auto on_demand = AnimatedFrameDecoder::Create(
+      OpenFixtureAsCodec("hello_loop_2.webp"), nullptr, OnDemandOptions());
+  ASSERT_TRUE(prefetching);
+  ASSERT_TRUE(on_demand);
+
+  for (int i = 0; i < prefetching->GetFrameCount() * 4; i++) {
+    auto prefetched_frame = prefetching->GetNextFrame();
+    auto on_demand_frame = on_demand->GetNextFrame();
+    ASSERT_EQ(prefetched_frame.index, on_demand_frame.index);
+    ASSERT_TRUE(
+        FramesHaveSamePixels(prefetched_frame.image, on_demand_frame.image));
+  }
+
+  // The decoder may be collected with prefetches in flight.
+  prefetching.reset();
+  loop->Terminate();
+}
+
+}  // namespace testing
+}  // namespace flutter
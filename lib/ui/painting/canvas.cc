@@ -4,12 +4,9 @@
 
 #include "flutter/lib/ui/painting/canvas.h"
 
-#define _USE_MATH_DEFINES
-#include <math.h>
-
 #include "flutter/flow/layers/physical_shape_layer.h"
+#include "flutter/lib/ui/painting/canvas_ops.h"
 #include "flutter/lib/ui/painting/image.h"
-#include "flutter/lib/ui/painting/matrix.h"
 #include "flutter/lib/ui/ui_dart_state.h"
 #include "flutter/lib/ui/window/window.h"
 #include "third_party/skia/include/core/SkBitmap.h"
@@ -30,37 +27,18 @@ static void Canvas_constructor(Dart_NativeArguments args) {
 
 IMPLEMENT_WRAPPERTYPEINFO(ui, Canvas);
 
-#define FOR_EACH_BINDING(V)         \
-  V(Canvas, save)                   \
-  V(Canvas, saveLayerWithoutBounds) \
-  V(Canvas, saveLayer)              \
-  V(Canvas, restore)                \
-  V(Canvas, getSaveCount)           \
-  V(Canvas, translate)              \
-  V(Canvas, scale)                  \
-  V(Canvas, rotate)                 \
-  V(Canvas, skew)                   \
-  V(Canvas, transform)              \
-  V(Canvas, clipRect)               \
-  V(Canvas, clipRRect)              \
-  V(Canvas, clipPath)               \
-  V(Canvas, drawColor)              \
-  V(Canvas, drawLine)               \
-  V(Canvas, drawPaint)              \
-  V(Canvas, drawRect)               \
-  V(Canvas, drawRRect)              \
-  V(Canvas, drawDRRect)             \
-  V(Canvas, drawOval)               \
-  V(Canvas, drawCircle)             \
-  V(Canvas, drawArc)                \
-  V(Canvas, drawPath)               \
-  V(Canvas, drawImage)              \
-  V(Canvas, drawImageRect)          \
-  V(Canvas, drawImageNine)          \
-  V(Canvas, drawPicture)            \
-  V(Canvas, drawPoints)             \
-  V(Canvas, drawVertices)           \
-  V(Canvas, drawAtlas)              \
+#define FOR_EACH_BINDING(V) \
+  V(Canvas, replay)         \
+  V(Canvas, getSaveCount)   \
+  V(Canvas, clipPath)       \
+  V(Canvas, drawPath)       \
+  V(Canvas, drawImage)      \
+  V(Canvas, drawImageRect)  \
+  V(Canvas, drawImageNine)  \
+  V(Canvas, drawPicture)    \
+  V(Canvas, drawPoints)     \
+  V(Canvas, drawVertices)   \
+  V(Canvas, drawAtlas)      \
   V(Canvas, drawShadow)
 
 FOR_EACH_BINDING(DART_NATIVE_CALLBACK)
@@ -89,35 +67,16 @@ Canvas::Canvas(SkCanvas* canvas) : canvas_(canvas) {}
 
 Canvas::~Canvas() {}
 
-void Canvas::save() {
-  if (!canvas_)
-    return;
-  canvas_->save();
-}
-
-void Canvas::saveLayerWithoutBounds(const Paint& paint,
-                                    const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->saveLayer(nullptr, paint.paint());
-}
-
-void Canvas::saveLayer(double left,
-                       double top,
-                       double right,
-                       double bottom,
-                       const Paint& paint,
-                       const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  SkRect bounds = SkRect::MakeLTRB(left, top, right, bottom);
-  canvas_->saveLayer(&bounds, paint.paint());
-}
-
-void Canvas::restore() {
+void Canvas::replay(const PaintBatch& paints,
+                    const PaintData& paint_data,
+                    const tonic::Uint32List& ops,
+                    const tonic::Float32List& args) {
   if (!canvas_)
     return;
-  canvas_->restore();
+  if (!ReplayCanvasOps(canvas_, ops.data(), ops.num_elements(), args.data(),
+                       args.num_elements(), paints.paints())) {
+    FML_LOG(ERROR) << "Could not replay malformed canvas operations.";
+  }
 }
 
 int Canvas::getSaveCount() {
@@ -126,54 +85,6 @@ int Canvas::getSaveCount() {
   return canvas_->getSaveCount();
 }
 
-void Canvas::translate(double dx, double dy) {
-  if (!canvas_)
-    return;
-  canvas_->translate(dx, dy);
-}
-
-void Canvas::scale(double sx, double sy) {
-  if (!canvas_)
-    return;
-  canvas_->scale(sx, sy);
-}
-
-void Canvas::rotate(double radians) {
-  if (!canvas_)
-    return;
-  canvas_->rotate(radians * 180.0 / M_PI);
-}
-
-void Canvas::skew(double sx, double sy) {
-  if (!canvas_)
-    return;
-  canvas_->skew(sx, sy);
-}
-
-void Canvas::transform(const tonic::Float64List& matrix4) {
-  if (!canvas_)
-    return;
-  canvas_->concat(ToSkMatrix(matrix4));
-}
-
-void Canvas::clipRect(double left,
-                      double top,
-                      double right,
-                      double bottom,
-                      SkClipOp clipOp,
-                      bool doAntiAlias) {
-  if (!canvas_)
-    return;
-  canvas_->clipRect(SkRect::MakeLTRB(left, top, right, bottom), clipOp,
-                    doAntiAlias);
-}
-
-void Canvas::clipRRect(const RRect& rrect, bool doAntiAlias) {
-  if (!canvas_)
-    return;
-  canvas_->clipRRect(rrect.sk_rrect, doAntiAlias);
-}
-
 void Canvas::clipPath(const CanvasPath* path, bool doAntiAlias) {
   if (!canvas_)
     return;
@@ -183,94 +94,6 @@ void Canvas::clipPath(const CanvasPath* path, bool doAntiAlias) {
   canvas_->clipPath(path->path(), doAntiAlias);
 }
 
-void Canvas::drawColor(SkColor color, SkBlendMode blend_mode) {
-  if (!canvas_)
-    return;
-  canvas_->drawColor(color, blend_mode);
-}
-
-void Canvas::drawLine(double x1,
-                      double y1,
-                      double x2,
-                      double y2,
-                      const Paint& paint,
-                      const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawLine(x1, y1, x2, y2, *paint.paint());
-}
-
-void Canvas::drawPaint(const Paint& paint, const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawPaint(*paint.paint());
-}
-
-void Canvas::drawRect(double left,
-                      double top,
-                      double right,
-                      double bottom,
-                      const Paint& paint,
-                      const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawRect(SkRect::MakeLTRB(left, top, right, bottom), *paint.paint());
-}
-
-void Canvas::drawRRect(const RRect& rrect,
-                       const Paint& paint,
-                       const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawRRect(rrect.sk_rrect, *paint.paint());
-}
-
-void Canvas::drawDRRect(const RRect& outer,
-                        const RRect& inner,
-                        const Paint& paint,
-                        const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawDRRect(outer.sk_rrect, inner.sk_rrect, *paint.paint());
-}
-
-void Canvas::drawOval(double left,
-                      double top,
-                      double right,
-                      double bottom,
-                      const Paint& paint,
-                      const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawOval(SkRect::MakeLTRB(left, top, right, bottom), *paint.paint());
-}
-
-void Canvas::drawCircle(double x,
-                        double y,
-                        double radius,
-                        const Paint& paint,
-                        const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawCircle(x, y, radius, *paint.paint());
-}
-
-void Canvas::drawArc(double left,
-                     double top,
-                     double right,
-                     double bottom,
-                     double startAngle,
-                     double sweepAngle,
-                     bool useCenter,
-                     const Paint& paint,
-                     const PaintData& paint_data) {
-  if (!canvas_)
-    return;
-  canvas_->drawArc(SkRect::MakeLTRB(left, top, right, bottom),
-                   startAngle * 180.0 / M_PI, sweepAngle * 180.0 / M_PI,
-                   useCenter, *paint.paint());
-}
-
 void Canvas::drawPath(const CanvasPath* path,
                       const Paint& paint,
                       const PaintData& paint_data) {
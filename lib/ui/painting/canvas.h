@@ -10,7 +10,6 @@
 #include "flutter/lib/ui/painting/path.h"
 #include "flutter/lib/ui/painting/picture.h"
 #include "flutter/lib/ui/painting/picture_recorder.h"
-#include "flutter/lib/ui/painting/rrect.h"
 #include "flutter/lib/ui/painting/vertices.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/utils/SkShadowUtils.h"
@@ -36,73 +35,18 @@ class Canvas : public RefCountedDartWrappable<Canvas> {
 
   ~Canvas() override;
 
-  void save();
-  void saveLayerWithoutBounds(const Paint& paint, const PaintData& paint_data);
-  void saveLayer(double left,
-                 double top,
-                 double right,
-                 double bottom,
-                 const Paint& paint,
-                 const PaintData& paint_data);
-  void restore();
+  // Replays a batch of operations that were recorded in Dart, encoded as
+  // described in canvas_ops.h. The paints are first because Paint unwraps
+  // C++ objects, which cannot be done once the typed lists are acquired.
+  void replay(const PaintBatch& paints,
+              const PaintData& paint_data,
+              const tonic::Uint32List& ops,
+              const tonic::Float32List& args);
+
   int getSaveCount();
 
-  void translate(double dx, double dy);
-  void scale(double sx, double sy);
-  void rotate(double radians);
-  void skew(double sx, double sy);
-  void transform(const tonic::Float64List& matrix4);
-
-  void clipRect(double left,
-                double top,
-                double right,
-                double bottom,
-                SkClipOp clipOp,
-                bool doAntiAlias = true);
-  void clipRRect(const RRect& rrect, bool doAntiAlias = true);
   void clipPath(const CanvasPath* path, bool doAntiAlias = true);
 
-  void drawColor(SkColor color, SkBlendMode blend_mode);
-  void drawLine(double x1,
-                double y1,
-                double x2,
-                double y2,
-                const Paint& paint,
-                const PaintData& paint_data);
-  void drawPaint(const Paint& paint, const PaintData& paint_data);
-  void drawRect(double left,
-                double top,
-                double right,
-                double bottom,
-                const Paint& paint,
-                const PaintData& paint_data);
-  void drawRRect(const RRect& rrect,
-                 const Paint& paint,
-                 const PaintData& paint_data);
-  void drawDRRect(const RRect& outer,
-                  const RRect& inner,
-                  const Paint& paint,
-                  const PaintData& paint_data);
-  void drawOval(double left,
-                double top,
-                double right,
-                double bottom,
-                const Paint& paint,
-                const PaintData& paint_data);
-  void drawCircle(double x,
-                  double y,
-                  double radius,
-                  const Paint& paint,
-                  const PaintData& paint_data);
-  void drawArc(double left,
-               double top,
-               double right,
-               double bottom,
-               double startAngle,
-               double sweepAngle,
-               bool useCenter,
-               const Paint& paint,
-               const PaintData& paint_data);
   void drawPath(const CanvasPath* path,
                 const Paint& paint,
                 const PaintData& paint_data);
@@ -0,0 +1,332 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/canvas_ops.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include "third_party/skia/include/core/SkRRect.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr size_t kRectArgCount = 4;
+constexpr size_t kRRectArgCount = 12;
+constexpr size_t kMatrixArgCount = 9;
+
+// Reads the words and arguments of a batch of operations, failing instead of
+// reading past the end of either.
+class CanvasOpReader {
+ public:
+  CanvasOpReader(const uint32_t* ops,
+                 size_t op_count,
+                 const float* args,
+                 size_t arg_count,
+                 const std::vector<SkPaint>& paints)
+      : ops_(ops),
+        op_count_(op_count),
+        args_(args),
+        arg_count_(arg_count),
+        paints_(paints) {}
+
+  bool HasMoreOps() const { return op_index_ < op_count_; }
+
+  bool UsedAllArgs() const { return arg_index_ == arg_count_; }
+
+  bool ReadWord(uint32_t* word) {
+    if (op_index_ >= op_count_) {
+      return false;
+    }
+    *word = ops_[op_index_++];
+    return true;
+  }
+
+  // Returns the next |count| arguments or null.
+  const float* ReadArgs(size_t count) {
+    if (arg_count_ - arg_index_ < count) {
+      return nullptr;
+    }
+    const float* args = args_ + arg_index_;
+    arg_index_ += count;
+    return args;
+  }
+
+  const SkPaint* ReadPaint() {
+    uint32_t index;
+    if (!ReadWord(&index) || index >= paints_.size()) {
+      return nullptr;
+    }
+    return &paints_[index];
+  }
+
+  bool ReadRect(SkRect* rect) {
+    const float* args = ReadArgs(kRectArgCount);
+    if (!args) {
+      return false;
+    }
+    *rect = SkRect::MakeLTRB(args[0], args[1], args[2], args[3]);
+    return true;
+  }
+
+  // Rounded rectangles are laid out like the Dart RRect, see rrect.cc.
+  bool ReadRRect(SkRRect* rrect) {
+    const float* args = ReadArgs(kRRectArgCount);
+    if (!args) {
+      return false;
+    }
+    SkVector radii[4] = {{args[4], args[5]},
+                         {args[6], args[7]},
+                         {args[8], args[9]},
+                         {args[10], args[11]}};
+    rrect->setRectRadii(SkRect::MakeLTRB(args[0], args[1], args[2], args[3]),
+                        radii);
+    return true;
+  }
+
+  bool ReadBool(bool* value) {
+    uint32_t word;
+    if (!ReadWord(&word) || word > 1) {
+      return false;
+    }
+    *value = word != 0;
+    return true;
+  }
+
+  bool ReadClipOp(SkClipOp* clip_op) {
+    uint32_t word;
+    if (!ReadWord(&word) ||
+        word > static_cast<uint32_t>(SkClipOp::kIntersect)) {
+      return false;
+    }
+    *clip_op = static_cast<SkClipOp>(word);
+    return true;
+  }
+
+  bool ReadBlendMode(SkBlendMode* blend_mode) {
+    uint32_t word;
+    if (!ReadWord(&word) ||
+        word > static_cast<uint32_t>(SkBlendMode::kLastMode)) {
+      return false;
+    }
+    *blend_mode = static_cast<SkBlendMode>(word);
+    return true;
+  }
+
+ private:
+  const uint32_t* const ops_;
+  const size_t op_count_;
+  const float* const args_;
+  const size_t arg_count_;
+  const std::vector<SkPaint>& paints_;
+  size_t op_index_ = 0;
+  size_t arg_index_ = 0;
+};
+
+// Replays the next operation. Returns false if it is malformed.
+bool ReplayNextOp(SkCanvas* canvas, CanvasOpReader& reader) {
+  uint32_t op;
+  if (!reader.ReadWord(&op)) {
+    return false;
+  }
+
+  switch (static_cast<CanvasOp>(op)) {
+    case CanvasOp::kSave: {
+      canvas->save();
+      return true;
+    }
+    case CanvasOp::kSaveLayerWithoutBounds: {
+      const SkPaint* paint = reader.ReadPaint();
+      if (!paint) {
+        return false;
+      }
+      canvas->saveLayer(nullptr, paint);
+      return true;
+    }
+    case CanvasOp::kSaveLayer: {
+      const SkPaint* paint = reader.ReadPaint();
+      SkRect bounds;
+      if (!paint || !reader.ReadRect(&bounds)) {
+        return false;
+      }
+      canvas->saveLayer(&bounds, paint);
+      return true;
+    }
+    case CanvasOp::kRestore: {
+      canvas->restore();
+      return true;
+    }
+    case CanvasOp::kTranslate: {
+      const float* args = reader.ReadArgs(2);
+      if (!args) {
+        return false;
+      }
+      canvas->translate(args[0], args[1]);
+      return true;
+    }
+    case CanvasOp::kScale: {
+      const float* args = reader.ReadArgs(2);
+      if (!args) {
+        return false;
+      }
+      canvas->scale(args[0], args[1]);
+      return true;
+    }
+    case CanvasOp::kRotate: {
+      const float* args = reader.ReadArgs(1);
+      if (!args) {
+        return false;
+      }
+      canvas->rotate(args[0] * 180.0 / M_PI);
+      return true;
+    }
+    case CanvasOp::kSkew: {
+      const float* args = reader.ReadArgs(2);
+      if (!args) {
+        return false;
+      }
+      canvas->skew(args[0], args[1]);
+      return true;
+    }
+    case CanvasOp::kTransform: {
+      const float* args = reader.ReadArgs(kMatrixArgCount);
+      if (!args) {
+        return false;
+      }
+      SkMatrix matrix;
+      matrix.set9(args);
+      canvas->concat(matrix);
+      return true;
+    }
+    case CanvasOp::kClipRect: {
+      SkClipOp clip_op;
+      bool anti_alias;
+      SkRect rect;
+      if (!reader.ReadClipOp(&clip_op) || !reader.ReadBool(&anti_alias) ||
+          !reader.ReadRect(&rect)) {
+        return false;
+      }
+      canvas->clipRect(rect, clip_op, anti_alias);
+      return true;
+    }
+    case CanvasOp::kClipRRect: {
+      bool anti_alias;
+      SkRRect rrect;
+      if (!reader.ReadBool(&anti_alias) || !reader.ReadRRect(&rrect)) {
+        return false;
+      }
+      canvas->clipRRect(rrect, anti_alias);
+      return true;
+    }
+    case CanvasOp::kDrawColor: {
+      uint32_t color;
+      SkBlendMode blend_mode;
+      if (!reader.ReadWord(&color) || !reader.ReadBlendMode(&blend_mode)) {
+        return false;
+      }
+      canvas->drawColor(color, blend_mode);
+      return true;
+    }
+    case CanvasOp::kDrawLine: {
+      const SkPaint* paint = reader.ReadPaint();
+      const float* args = reader.ReadArgs(4);
+      if (!paint || !args) {
+        return false;
+      }
+      canvas->drawLine(args[0], args[1], args[2], args[3], *paint);
+      return true;
+    }
+    case CanvasOp::kDrawPaint: {
+      const SkPaint* paint = reader.ReadPaint();
+      if (!paint) {
+        return false;
+      }
+      canvas->drawPaint(*paint);
+      return true;
+    }
+    case CanvasOp::kDrawRect: {
+      const SkPaint* paint = reader.ReadPaint();
+      SkRect rect;
+      if (!paint || !reader.ReadRect(&rect)) {
+        return false;
+      }
+      canvas->drawRect(rect, *paint);
+      return true;
+    }
+    case CanvasOp::kDrawRRect: {
+      const SkPaint* paint = reader.ReadPaint();
+      SkRRect rrect;
+      if (!paint || !reader.ReadRRect(&rrect)) {
+        return false;
+      }
+      canvas->drawRRect(rrect, *paint);
+      return true;
+    }
+    case CanvasOp::kDrawDRRect: {
+      const SkPaint* paint = reader.ReadPaint();
+      SkRRect outer;
+      SkRRect inner;
+      if (!paint || !reader.ReadRRect(&outer) || !reader.ReadRRect(&inner)) {
+        return false;
+      }
+      canvas->drawDRRect(outer, inner, *paint);
+      return true;
+    }
+    case CanvasOp::kDrawOval: {
+      const SkPaint* paint = reader.ReadPaint();
+      SkRect rect;
+      if (!paint || !reader.ReadRect(&rect)) {
+        return false;
+      }
+      canvas->drawOval(rect, *paint);
+      return true;
+    }
+    case CanvasOp::kDrawCircle: {
+      const SkPaint* paint = reader.ReadPaint();
+      const float* args = reader.ReadArgs(3);
+      if (!paint || !args) {
+        return false;
+      }
+      canvas->drawCircle(args[0], args[1], args[2], *paint);
+      return true;
+    }
+    case CanvasOp::kDrawArc: {
+      const SkPaint* paint = reader.ReadPaint();
+      bool use_center;
+      SkRect rect;
+      if (!paint || !reader.ReadBool(&use_center) || !reader.ReadRect(&rect)) {
+        return false;
+      }
+      const float* angles = reader.ReadArgs(2);
+      if (!angles) {
+        return false;
+      }
+      canvas->drawArc(rect, angles[0] * 180.0 / M_PI, angles[1] * 180.0 / M_PI,
+                      use_center, *paint);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+}  // namespace
+
+bool ReplayCanvasOps(SkCanvas* canvas,
+                     const uint32_t* ops,
+                     size_t op_count,
+                     const float* args,
+                     size_t arg_count,
+                     const std::vector<SkPaint>& paints) {
+  CanvasOpReader reader(ops, op_count, args, arg_count, paints);
+  while (reader.HasMoreOps()) {
+    if (!ReplayNextOp(canvas, reader)) {
+      return false;
+    }
+  }
+  return reader.UsedAllArgs();
+}
+
+}  // namespace flutter
@@ -0,0 +1,69 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_CANVAS_OPS_H_
+#define FLUTTER_LIB_UI_PAINTING_CANVAS_OPS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPaint.h"
+
+namespace flutter {
+
+// The operations that a Canvas records in Dart and replays in batches.
+//
+// Each operation is encoded as its opcode followed by its integer arguments.
+// Its floating point arguments are encoded separately. The arguments of each
+// operation are those of the SkCanvas method it stands for, except that:
+//
+//  * Operations that take a paint start with the index of the paint in the
+//    batch.
+//  * Rectangles are encoded as left, top, right and bottom.
+//  * Rounded rectangles are encoded as the 12 values of a Dart RRect.
+//  * Angles are in radians.
+//  * Transforms are encoded as the 9 values of an SkMatrix.
+//  * Clip ops, blend modes and flags like anti-alias are integers.
+//
+// Must be kept in sync with the opcodes of Canvas in painting.dart.
+enum class CanvasOp : uint32_t {
+  kSave,
+  kSaveLayerWithoutBounds,
+  kSaveLayer,
+  kRestore,
+  kTranslate,
+  kScale,
+  kRotate,
+  kSkew,
+  kTransform,
+  kClipRect,
+  kClipRRect,
+  kDrawColor,
+  kDrawLine,
+  kDrawPaint,
+  kDrawRect,
+  kDrawRRect,
+  kDrawDRRect,
+  kDrawOval,
+  kDrawCircle,
+  kDrawArc,
+};
+
+// Replays the |op_count| words of encoded operations in |ops| into |canvas|.
+//
+// Returns false if the operations are malformed or do not use exactly the
+// |arg_count| arguments in |args|. The operations before the malformed one
+// have been replayed when it does.
+bool ReplayCanvasOps(SkCanvas* canvas,
+                     const uint32_t* ops,
+                     size_t op_count,
+                     const float* args,
+                     size_t arg_count,
+                     const std::vector<SkPaint>& paints);
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_CANVAS_OPS_H_
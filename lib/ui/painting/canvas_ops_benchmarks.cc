@@ -0,0 +1,98 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/logging.h"
+#include "flutter/lib/ui/painting/canvas_ops.h"
+#include "flutter/lib/ui/painting/paint.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkRRect.h"
+
+namespace flutter {
+
+// The number of times each benchmark records the same few operations into a
+// picture, which is about what a busy frame records.
+static constexpr int kOpGroupCount = 500;
+static constexpr int kOpsPerGroup = 6;
+
+// The encoded data of a paint with nothing but a color, as painting.dart
+// encodes it.
+static std::vector<uint32_t> EncodePaintData(SkColor color) {
+  std::vector<uint32_t> data(kPaintDataByteCount / sizeof(uint32_t));
+  // The color is encoded as its difference from the default, opaque black.
+  data[1] = color ^ 0xFF000000;
+  return data;
+}
+
+// Records what a Canvas did when every operation was its own call: each call
+// that took a paint decoded the paint again.
+static void BM_RecordOpsPerCall(benchmark::State& state) {
+  const std::vector<std::vector<uint32_t>> paint_data = {
+      EncodePaintData(SK_ColorRED), EncodePaintData(SK_ColorBLUE)};
+  SkRRect rrect;
+  rrect.setRectXY(SkRect::MakeLTRB(0, 0, 20, 20), 4, 4);
+
+  while (state.KeepRunning()) {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(1000, 1000);
+    for (int i = 0; i < kOpGroupCount; i++) {
+      canvas->save();
+      canvas->translate(i, i);
+      canvas->clipRect(SkRect::MakeLTRB(0, 0, 100, 100),
+                       SkClipOp::kIntersect, true);
+      SkPaint rect_paint;
+      DecodePaintData(paint_data[0].data(), &rect_paint);
+      canvas->drawRect(SkRect::MakeLTRB(0, 0, 10, 10), rect_paint);
+      SkPaint rrect_paint;
+      DecodePaintData(paint_data[1].data(), &rrect_paint);
+      canvas->drawRRect(rrect, rrect_paint);
+      canvas->restore();
+    }
+    benchmark::DoNotOptimize(recorder.finishRecordingAsPicture());
+  }
+
+  state.SetItemsProcessed(state.iterations() * kOpGroupCount * kOpsPerGroup);
+}
+BENCHMARK(BM_RecordOpsPerCall);
+
+// Records the same operations from a batch, decoding each paint once.
+static void BM_RecordOpsBatched(benchmark::State& state) {
+  const std::vector<std::vector<uint32_t>> paint_data = {
+      EncodePaintData(SK_ColorRED), EncodePaintData(SK_ColorBLUE)};
+
+  std::vector<uint32_t> ops;
+  std::vector<float> args;
+  for (int i = 0; i < kOpGroupCount; i++) {
+    ops.push_back(static_cast<uint32_t>(CanvasOp::kSave));
+    ops.push_back(static_cast<uint32_t>(CanvasOp::kTranslate));
+    args.insert(args.end(), {static_cast<float>(i), static_cast<float>(i)});
+    ops.insert(ops.end(), {static_cast<uint32_t>(CanvasOp::kClipRect),
+                           static_cast<uint32_t>(SkClipOp::kIntersect), 1});
+    args.insert(args.end(), {0, 0, 100, 100});
+    ops.insert(ops.end(), {static_cast<uint32_t>(CanvasOp::kDrawRect), 0});
+    args.insert(args.end(), {0, 0, 10, 10});
+    ops.insert(ops.end(), {static_cast<uint32_t>(CanvasOp::kDrawRRect), 1});
+    args.insert(args.end(), {0, 0, 20, 20, 4, 4, 4, 4, 4, 4, 4, 4});
+    ops.push_back(static_cast<uint32_t>(CanvasOp::kRestore));
+  }
+
+  while (state.KeepRunning()) {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(1000, 1000);
+    std::vector<SkPaint> paints(paint_data.size());
+    for (size_t i = 0; i < paint_data.size(); i++) {
+      DecodePaintData(paint_data[i].data(), &paints[i]);
+    }
+    FML_CHECK(ReplayCanvasOps(canvas, ops.data(), ops.size(), args.data(),
+                              args.size(), paints));
+    benchmark::DoNotOptimize(recorder.finishRecordingAsPicture());
+  }
+
+  state.SetItemsProcessed(state.iterations() * kOpGroupCount * kOpsPerGroup);
+}
+BENCHMARK(BM_RecordOpsBatched);
+
+}  // namespace flutter
@@ -0,0 +1,224 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/canvas_ops.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include <cstring>
+
+#include "flutter/testing/mock_canvas.h"
+#include "flutter/testing/testing.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+namespace testing {
+
+// Encodes operations the way Canvas does in painting.dart.
+class CanvasOpsBuilder {
+ public:
+  CanvasOpsBuilder& Op(CanvasOp op) {
+    ops_.push_back(static_cast<uint32_t>(op));
+    return *this;
+  }
+
+  CanvasOpsBuilder& Word(uint32_t word) {
+    ops_.push_back(word);
+    return *this;
+  }
+
+  CanvasOpsBuilder& Args(std::initializer_list<float> args) {
+    args_.insert(args_.end(), args);
+    return *this;
+  }
+
+  bool Replay(SkCanvas* canvas, const std::vector<SkPaint>& paints) const {
+    return ReplayCanvasOps(canvas, ops_.data(), ops_.size(), args_.data(),
+                           args_.size(), paints);
+  }
+
+ private:
+  std::vector<uint32_t> ops_;
+  std::vector<float> args_;
+};
+
+static SkPaint MakePaint(SkColor color) {
+  SkPaint paint;
+  paint.setColor(color);
+  return paint;
+}
+
+TEST(CanvasOpsTest, ReplaysTrackedOperations) {
+  const std::vector<SkPaint> paints = {MakePaint(SK_ColorRED),
+                                       MakePaint(SK_ColorBLUE)};
+  const SkMatrix matrix = SkMatrix::MakeScale(2.0f, 3.0f);
+  SkScalar matrix_values[9];
+  matrix.get9(matrix_values);
+
+  CanvasOpsBuilder builder;
+  builder.Op(CanvasOp::kSave)
+      .Op(CanvasOp::kTransform)
+      .Args({matrix_values[0], matrix_values[1], matrix_values[2],
+             matrix_values[3], matrix_values[4], matrix_values[5],
+             matrix_values[6], matrix_values[7], matrix_values[8]})
+      .Op(CanvasOp::kClipRect)
+      .Word(static_cast<uint32_t>(SkClipOp::kIntersect))
+      .Word(1)
+      .Args({0.0f, 0.0f, 10.0f, 10.0f})
+      .Op(CanvasOp::kDrawRect)
+      .Word(0)
+      .Args({1.0f, 2.0f, 3.0f, 4.0f})
+      .Op(CanvasOp::kDrawRect)
+      .Word(1)
+      .Args({5.0f, 6.0f, 7.0f, 8.0f})
+      .Op(CanvasOp::kDrawRect)
+      .Word(0)
+      .Args({1.0f, 2.0f, 3.0f, 4.0f})
+      .Op(CanvasOp::kRestore);
+
+  MockCanvas canvas;
+  ASSERT_TRUE(builder.Replay(&canvas, paints));
+
+  const SkRect rect = SkRect::MakeLTRB(1.0f, 2.0f, 3.0f, 4.0f);
+  EXPECT_EQ(
+      canvas.draw_calls(),
+      std::vector(
+          {MockCanvas::DrawCall{0, MockCanvas::SaveData{1}},
+           MockCanvas::DrawCall{1, MockCanvas::ConcatMatrixData{matrix}},
+           MockCanvas::DrawCall{
+               1, MockCanvas::ClipRectData{SkRect::MakeLTRB(0, 0, 10, 10),
+                                           SkClipOp::kIntersect,
+                                           MockCanvas::kSoft_ClipEdgeStyle}},
+           MockCanvas::DrawCall{1, MockCanvas::DrawRectData{rect, paints[0]}},
+           MockCanvas::DrawCall{
+               1, MockCanvas::DrawRectData{SkRect::MakeLTRB(5, 6, 7, 8),
+                                           paints[1]}},
+           MockCanvas::DrawCall{1, MockCanvas::DrawRectData{rect, paints[0]}},
+           MockCanvas::DrawCall{1, MockCanvas::RestoreData{0}}}));
+}
+
+TEST(CanvasOpsTest, DrawsLikeDirectCalls) {
+  const std::vector<SkPaint> paints = {MakePaint(SK_ColorRED),
+                                       MakePaint(SK_ColorGREEN)};
+  // Rounded rectangles are encoded as their rect and the radii of each
+  // corner, like the Dart RRect.
+  const SkVector radii[4] = {{1, 1}, {2, 2}, {3, 3}, {4, 4}};
+  SkRRect rrect;
+  rrect.setRectRadii(SkRect::MakeLTRB(4, 4, 40, 40), radii);
+  SkRRect inner_rrect;
+  inner_rrect.setRectXY(SkRect::MakeLTRB(10, 10, 30, 30), 2, 2);
+
+  CanvasOpsBuilder builder;
+  builder.Op(CanvasOp::kDrawColor)
+      .Word(SK_ColorWHITE)
+      .Word(static_cast<uint32_t>(SkBlendMode::kSrc))
+      .Op(CanvasOp::kTranslate)
+      .Args({2, 3})
+      .Op(CanvasOp::kScale)
+      .Args({1.5f, 1.25f})
+      .Op(CanvasOp::kRotate)
+      .Args({0.1f})
+      .Op(CanvasOp::kSkew)
+      .Args({0.05f, 0.0f})
+      .Op(CanvasOp::kDrawRRect)
+      .Word(0)
+      .Args({4, 4, 40, 40, 1, 1, 2, 2, 3, 3, 4, 4})
+      .Op(CanvasOp::kDrawDRRect)
+      .Word(1)
+      .Args({4, 4, 40, 40, 1, 1, 2, 2, 3, 3, 4, 4})
+      .Args({10, 10, 30, 30, 2, 2, 2, 2, 2, 2, 2, 2})
+      .Op(CanvasOp::kDrawOval)
+      .Word(0)
+      .Args({50, 4, 90, 30})
+      .Op(CanvasOp::kDrawCircle)
+      .Word(1)
+      .Args({70, 60, 12})
+      .Op(CanvasOp::kDrawArc)
+      .Word(0)
+      .Word(1)
+      .Args({4, 50, 40, 90, 0.5f, 2.0f})
+      .Op(CanvasOp::kDrawLine)
+      .Word(1)
+      .Args({0, 0, 100, 100});
+
+  auto replayed = SkSurface::MakeRasterN32Premul(100, 100);
+  ASSERT_TRUE(builder.Replay(replayed->getCanvas(), paints));
+
+  auto direct = SkSurface::MakeRasterN32Premul(100, 100);
+  SkCanvas* canvas = direct->getCanvas();
+  canvas->drawColor(SK_ColorWHITE, SkBlendMode::kSrc);
+  canvas->translate(2, 3);
+  canvas->scale(1.5f, 1.25f);
+  canvas->rotate(0.1f * 180.0 / M_PI);
+  canvas->skew(0.05f, 0.0f);
+  canvas->drawRRect(rrect, paints[0]);
+  canvas->drawDRRect(rrect, inner_rrect, paints[1]);
+  canvas->drawOval(SkRect::MakeLTRB(50, 4, 90, 30), paints[0]);
+  canvas->drawCircle(70, 60, 12, paints[1]);
+  canvas->drawArc(SkRect::MakeLTRB(4, 50, 40, 90), 0.5f * 180.0 / M_PI,
+                  2.0f * 180.0 / M_PI, true, paints[0]);
+  canvas->drawLine(0, 0, 100, 100, paints[1]);
+
+  SkPixmap replayed_pixels, direct_pixels;
+  ASSERT_TRUE(replayed->peekPixels(&replayed_pixels));
+  ASSERT_TRUE(direct->peekPixels(&direct_pixels));
+  ASSERT_EQ(replayed_pixels.computeByteSize(),
+            direct_pixels.computeByteSize());
+  ASSERT_EQ(std::memcmp(replayed_pixels.addr(), direct_pixels.addr(),
+                        direct_pixels.computeByteSize()),
+            0);
+}
+
+TEST(CanvasOpsTest, RejectsMalformedOperations) {
+  const std::vector<SkPaint> paints = {MakePaint(SK_ColorRED)};
+  auto surface = SkSurface::MakeRasterN32Premul(10, 10);
+  SkCanvas* canvas = surface->getCanvas();
+
+  // Unknown opcode.
+  EXPECT_FALSE(CanvasOpsBuilder().Word(1000).Replay(canvas, paints));
+  // Paint that is not in the batch.
+  EXPECT_FALSE(CanvasOpsBuilder()
+                   .Op(CanvasOp::kDrawRect)
+                   .Word(1)
+                   .Args({0, 0, 1, 1})
+                   .Replay(canvas, paints));
+  // Missing integer argument.
+  EXPECT_FALSE(CanvasOpsBuilder().Op(CanvasOp::kDrawPaint).Replay(canvas,
+                                                                  paints));
+  // Missing floating point arguments.
+  EXPECT_FALSE(CanvasOpsBuilder()
+                   .Op(CanvasOp::kDrawRect)
+                   .Word(0)
+                   .Args({0, 0, 1})
+                   .Replay(canvas, paints));
+  // Arguments that no operation uses.
+  EXPECT_FALSE(CanvasOpsBuilder()
+                   .Op(CanvasOp::kSave)
+                   .Args({0})
+                   .Replay(canvas, paints));
+  // Invalid clip op, flag and blend mode.
+  EXPECT_FALSE(CanvasOpsBuilder()
+                   .Op(CanvasOp::kClipRect)
+                   .Word(7)
+                   .Word(1)
+                   .Args({0, 0, 1, 1})
+                   .Replay(canvas, paints));
+  EXPECT_FALSE(CanvasOpsBuilder()
+                   .Op(CanvasOp::kClipRect)
+                   .Word(0)
+                   .Word(2)
+                   .Args({0, 0, 1, 1})
+                   .Replay(canvas, paints));
+  EXPECT_FALSE(CanvasOpsBuilder()
+                   .Op(CanvasOp::kDrawColor)
+                   .Word(SK_ColorRED)
+                   .Word(1000)
+                   .Replay(canvas, paints));
+
+  EXPECT_TRUE(CanvasOpsBuilder().Replay(canvas, paints));
+}
+
+}  // namespace testing
+}  // namespace flutter
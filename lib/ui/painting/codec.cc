@@ -11,8 +11,10 @@
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/painting/frame_info.h"
+#include "flutter/lib/ui/painting/image_decoder.h"
 #include "flutter/lib/ui/painting/multi_frame_codec.h"
 #include "flutter/lib/ui/painting/single_frame_codec.h"
+#include "flutter/lib/ui/ui_dart_state.h"
 #include "third_party/skia/include/codec/SkCodec.h"
 #include "third_party/skia/include/core/SkPixelRef.h"
 #include "third_party/tonic/dart_binding_macros.h"
@@ -224,7 +226,13 @@ static void InstantiateImageCodec(Dart_NativeArguments args) {
 
     ui_codec = fml::MakeRefCounted<SingleFrameCodec>(std::move(descriptor));
   } else {
-    ui_codec = fml::MakeRefCounted<MultiFrameCodec>(std::move(codec));
+    // Animations are decoded ahead of time on the same workers as images.
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner;
+    if (auto image_decoder = UIDartState::Current()->GetImageDecoder()) {
+      worker_task_runner = image_decoder->GetConcurrentTaskRunner();
+    }
+    ui_codec = fml::MakeRefCounted<MultiFrameCodec>(
+        std::move(codec), std::move(worker_task_runner));
   }
 
   tonic::DartInvoke(callback_handle, {ToDart(ui_codec)});
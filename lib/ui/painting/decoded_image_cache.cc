@@ -0,0 +1,186 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
+
+#include <string_view>
+
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+bool DecodedImageCache::Key::operator==(const Key& other) const {
+  return content_hash == other.content_hash &&
+         content_size == other.content_size &&
+         target_width == other.target_width &&
+         target_height == other.target_height &&
+         color_type == other.color_type && alpha_type == other.alpha_type &&
+         width == other.width && height == other.height &&
+         row_bytes == other.row_bytes &&
+         (content == other.content ||
+          (content && other.content && content->equals(other.content.get())));
+}
+
+size_t DecodedImageCache::Key::Hash::operator()(const Key& key) const {
+  size_t hash = key.content_hash;
+  auto combine = [&hash](size_t value) {
+    hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  };
+  combine(key.content_size);
+  combine(key.target_width);
+  combine(key.target_height);
+  combine(key.color_type);
+  combine(key.alpha_type);
+  combine(key.width);
+  combine(key.height);
+  combine(key.row_bytes);
+  return hash;
+}
+
+DecodedImageCache::Key DecodedImageCache::MakeKey(sk_sp<SkData> data,
+                                                  uint32_t target_width,
+                                                  uint32_t target_height) {
+  Key key;
+  key.content_hash = HashContent(*data);
+  key.content_size = data->size();
+  key.content = std::move(data);
+  key.target_width = target_width;
+  key.target_height = target_height;
+  return key;
+}
+
+size_t DecodedImageCache::HashContent(const SkData& data) {
+  TRACE_EVENT0("flutter", "DecodedImageCache::HashContent");
+  return std::hash<std::string_view>{}(std::string_view(
+      reinterpret_cast<const char*>(data.data()), data.size()));
+}
+
+DecodedImageCache::DecodedImageCache(size_t max_bytes)
+    : max_bytes_(max_bytes) {}
+
+DecodedImageCache::~DecodedImageCache() {
+  // Waiters are dropped along with the cache. Callers keep the cache alive
+  // until their decodes complete, so there should not be any.
+  std::scoped_lock lock(mutex_);
+  EvictLocked(0);
+}
+
+SkiaGPUObject<SkImage> DecodedImageCache::MakeResult(const Entry& entry) {
+  if (!entry.image) {
+    return {};
+  }
+  return {entry.image, entry.unref_queue};
+}
+
+DecodedImageCache::LookupResult DecodedImageCache::Lookup(
+    const Key& key,
+    const Callback& callback) {
+  std::unique_lock lock(mutex_);
+  auto found = entries_.find(key);
+  if (found == entries_.end()) {
+    entries_.emplace(key, Entry{});
+    return LookupResult::kMiss;
+  }
+
+  Entry& entry = found->second;
+  if (entry.pending) {
+    entry.waiters.push_back(callback);
+    return LookupResult::kPending;
+  }
+
+  lru_.splice(lru_.begin(), lru_, entry.lru_position);
+  auto result = MakeResult(entry);
+  lock.unlock();
+
+  callback(std::move(result));
+  return LookupResult::kHit;
+}
+
+void DecodedImageCache::Complete(const Key& key,
+                                 sk_sp<SkImage> image,
+                                 fml::RefPtr<SkiaUnrefQueue> unref_queue) {
+  std::vector<Callback> waiters;
+  Entry result;
+  result.image = image;
+  result.unref_queue = unref_queue;
+
+  {
+    std::scoped_lock lock(mutex_);
+    auto found = entries_.find(key);
+    if (found == entries_.end() || !found->second.pending) {
+      FML_DLOG(ERROR) << "Completed a decode that was not started.";
+    } else {
+      Entry& entry = found->second;
+      waiters = std::move(entry.waiters);
+      const size_t bytes =
+          image ? image->imageInfo().computeMinByteSize() + key.content_size
+                : 0;
+      if (!image || bytes > max_bytes_) {
+        // Failures are retried by the next decode and images that could never
+        // fit are not worth evicting everything else for.
+        entries_.erase(found);
+      } else {
+        entry.image = std::move(image);
+        entry.unref_queue = std::move(unref_queue);
+        entry.bytes = bytes;
+        entry.pending = false;
+        entry.lru_position = lru_.insert(lru_.begin(), key);
+        cached_bytes_ += bytes;
+        EvictLocked(max_bytes_);
+      }
+    }
+  }
+
+  for (const auto& waiter : waiters) {
+    waiter(MakeResult(result));
+  }
+
+  // The reference held by |result| must be released on the queue as well.
+  if (result.image && result.unref_queue) {
+    result.unref_queue->Unref(result.image.release());
+  }
+}
+
+void DecodedImageCache::EvictLocked(size_t max_bytes) {
+  while (cached_bytes_ > max_bytes && !lru_.empty()) {
+    auto found = entries_.find(lru_.back());
+    lru_.pop_back();
+    FML_DCHECK(found != entries_.end());
+    Entry& entry = found->second;
+    cached_bytes_ -= entry.bytes;
+    if (entry.unref_queue) {
+      entry.unref_queue->Unref(entry.image.release());
+    }
+    entries_.erase(found);
+  }
+}
+
+void DecodedImageCache::Purge() {
+  TRACE_EVENT0("flutter", "DecodedImageCache::Purge");
+  std::scoped_lock lock(mutex_);
+  EvictLocked(0);
+}
+
+size_t DecodedImageCache::GetMaxBytes() const {
+  std::scoped_lock lock(mutex_);
+  return max_bytes_;
+}
+
+void DecodedImageCache::SetMaxBytes(size_t max_bytes) {
+  std::scoped_lock lock(mutex_);
+  max_bytes_ = max_bytes;
+  EvictLocked(max_bytes_);
+}
+
+size_t DecodedImageCache::GetCachedBytes() const {
+  std::scoped_lock lock(mutex_);
+  return cached_bytes_;
+}
+
+size_t DecodedImageCache::GetCachedImageCount() const {
+  std::scoped_lock lock(mutex_);
+  return lru_.size();
+}
+
+}  // namespace flutter
@@ -0,0 +1,132 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_DECODED_IMAGE_CACHE_H_
+#define FLUTTER_LIB_UI_PAINTING_DECODED_IMAGE_CACHE_H_
+
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/flow/skia_gpu_object.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkImageInfo.h"
+
+namespace flutter {
+
+// A cache of decoded (and usually uploaded) images shared by all decodes of
+// the same content to the same size. Decodes of a key that is already being
+// decoded wait for that decode instead of starting their own. The cache may be
+// accessed from any thread.
+class DecodedImageCache {
+ public:
+  struct Key {
+    // The encoded or decompressed bytes along with their hash and size. The
+    // bytes themselves are compared when the hashes match so that colliding
+    // contents never share an image.
+    sk_sp<SkData> content;
+    size_t content_hash = 0;
+    size_t content_size = 0;
+    // Zero when the dimension was not specified.
+    uint32_t target_width = 0;
+    uint32_t target_height = 0;
+    // For decompressed bytes, how the bytes are laid out. Encoded bytes use
+    // |kUnknown_SkColorType| and leave the rest zero.
+    SkColorType color_type = kUnknown_SkColorType;
+    SkAlphaType alpha_type = kUnknown_SkAlphaType;
+    int width = 0;
+    int height = 0;
+    size_t row_bytes = 0;
+
+    bool operator==(const Key& other) const;
+
+    struct Hash {
+      size_t operator()(const Key& key) const;
+    };
+  };
+
+  // Makes the key for |data| decoded to the given target size.
+  static Key MakeKey(sk_sp<SkData> data,
+                     uint32_t target_width,
+                     uint32_t target_height);
+
+  // Computes the hash of the contents of |data| for use in a |Key|.
+  static size_t HashContent(const SkData& data);
+
+  // A couple of decoded 1080p images. Matches the default of
+  // |Settings::decoded_image_cache_max_bytes|.
+  static constexpr size_t kDefaultMaxBytes = 16 * 1024 * 1024;
+
+  explicit DecodedImageCache(size_t max_bytes = kDefaultMaxBytes);
+
+  ~DecodedImageCache();
+
+  using Callback = std::function<void(SkiaGPUObject<SkImage>)>;
+
+  enum class LookupResult {
+    // The image was cached and |callback| has already been called with it.
+    kHit,
+    // The image is being decoded. |callback| is called when that is done.
+    kPending,
+    // The image is neither cached nor being decoded. |callback| was not
+    // called. The caller must decode the image and then call |Complete|.
+    kMiss,
+  };
+
+  LookupResult Lookup(const Key& key, const Callback& callback);
+
+  // Resolves a decode started after |Lookup| returned |kMiss|. A null
+  // |image| signals a failed decode, which is passed on to the waiting
+  // callbacks but not cached. Images are released on |unref_queue| when they
+  // are evicted.
+  void Complete(const Key& key,
+                sk_sp<SkImage> image,
+                fml::RefPtr<SkiaUnrefQueue> unref_queue);
+
+  // Evicts all cached images. Decodes in progress are not affected.
+  void Purge();
+
+  size_t GetMaxBytes() const;
+
+  void SetMaxBytes(size_t max_bytes);
+
+  size_t GetCachedBytes() const;
+
+  size_t GetCachedImageCount() const;
+
+ private:
+  struct Entry {
+    sk_sp<SkImage> image;
+    fml::RefPtr<SkiaUnrefQueue> unref_queue;
+    // The decoded image plus the content its key keeps alive.
+    size_t bytes = 0;
+    // Position in |lru_| once the image has been decoded.
+    std::list<Key>::iterator lru_position;
+    bool pending = true;
+    std::vector<Callback> waiters;
+  };
+
+  mutable std::mutex mutex_;
+  size_t max_bytes_;
+  size_t cached_bytes_ = 0;
+  std::unordered_map<Key, Entry, Key::Hash> entries_;
+  // Keys of decoded entries, most recently used first.
+  std::list<Key> lru_;
+
+  // Evicts least recently used entries until the cached bytes fit in
+  // |max_bytes|.
+  void EvictLocked(size_t max_bytes);
+
+  static SkiaGPUObject<SkImage> MakeResult(const Entry& entry);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DecodedImageCache);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_DECODED_IMAGE_CACHE_H_
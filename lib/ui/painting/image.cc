@@ -32,8 +32,11 @@ CanvasImage::CanvasImage() = default;
 
 CanvasImage::~CanvasImage() = default;
 
-Dart_Handle CanvasImage::toByteData(int format, Dart_Handle callback) {
-  return EncodeImage(this, format, callback);
+Dart_Handle CanvasImage::toByteData(int format,
+                                    bool fast_compression,
+                                    Dart_Handle chunk_callback,
+                                    Dart_Handle callback) {
+  return EncodeImage(this, format, fast_compression, chunk_callback, callback);
 }
 
 void CanvasImage::dispose() {
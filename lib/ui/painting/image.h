@@ -30,7 +30,10 @@ class CanvasImage final : public RefCountedDartWrappable<CanvasImage> {
 
   int height() { return image_.get()->height(); }
 
-  Dart_Handle toByteData(int format, Dart_Handle callback);
+  Dart_Handle toByteData(int format,
+                         bool fast_compression,
+                         Dart_Handle chunk_callback,
+                         Dart_Handle callback);
 
   void dispose();
 
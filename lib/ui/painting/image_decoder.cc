@@ -20,10 +20,12 @@ constexpr double kAspectRatioChangedThreshold = 0.01;
 ImageDecoder::ImageDecoder(
     TaskRunners runners,
     std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
-    fml::WeakPtr<IOManager> io_manager)
+    fml::WeakPtr<IOManager> io_manager,
+    size_t cache_max_bytes)
     : runners_(std::move(runners)),
       concurrent_task_runner_(std::move(concurrent_task_runner)),
       io_manager_(std::move(io_manager)),
+      cache_(std::make_shared<DecodedImageCache>(cache_max_bytes)),
       weak_factory_(this) {
   FML_DCHECK(runners_.IsValid());
   FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread())
@@ -244,6 +246,23 @@ sk_sp<SkImage> ImageFromCompressedData(sk_sp<SkData> data,
   return ResizeRasterImage(std::move(image), resized_dimensions, flow);
 }
 
+static DecodedImageCache::Key CacheKeyForDescriptor(
+    const ImageDecoder::ImageDescriptor& descriptor) {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  auto key = DecodedImageCache::MakeKey(descriptor.data,
+                                        descriptor.target_width.value_or(0),
+                                        descriptor.target_height.value_or(0));
+  if (descriptor.decompressed_image_info) {
+    const auto& info = descriptor.decompressed_image_info.value();
+    key.color_type = info.sk_info.colorType();
+    key.alpha_type = info.sk_info.alphaType();
+    key.width = info.sk_info.width();
+    key.height = info.sk_info.height();
+    key.row_bytes = info.row_bytes;
+  }
+  return key;
+}
+
 static SkiaGPUObject<SkImage> UploadRasterImage(
     sk_sp<SkImage> image,
     fml::WeakPtr<IOManager> io_manager,
@@ -330,9 +349,34 @@ void ImageDecoder::Decode(ImageDescriptor descriptor,
       fml::MakeCopyable([descriptor,                              //
                          io_manager = io_manager_,                //
                          io_runner = runners_.GetIOTaskRunner(),  //
+                         cache = cache_,                          //
                          result,                                  //
                          flow = std::move(flow)                   //
   ]() mutable {
+        // Step 0: Reuse the image if the same content was already decoded to
+        // the same size, or wait for it if it is being decoded right now.
+        // On Worker.
+
+        const auto key = CacheKeyForDescriptor(descriptor);
+        auto shared_flow =
+            std::make_shared<fml::tracing::TraceFlow>(std::move(flow));
+        const auto lookup = cache->Lookup(
+            key, [result, shared_flow](SkiaGPUObject<SkImage> image) {
+              shared_flow->Step("DecodedImageCache");
+              result(std::move(image), std::move(*shared_flow));
+            });
+        if (lookup != DecodedImageCache::LookupResult::kMiss) {
+          return;
+        }
+
+        // This decode must resolve the cache entry it started, even on
+        // failure, or the decodes waiting on it would never complete.
+        auto complete = [result, cache, key](SkiaGPUObject<SkImage> image,
+                                             fml::tracing::TraceFlow flow) {
+          cache->Complete(key, image.get(), image.unref_queue());
+          result(std::move(image), std::move(flow));
+        };
+
         // Step 1: Decompress the image.
         // On Worker.
 
@@ -343,36 +387,37 @@ void ImageDecoder::Decode(ImageDescriptor descriptor,
                       descriptor.decompressed_image_info.value(),  //
                       descriptor.target_width,                     //
                       descriptor.target_height,                    //
-                      flow                                         //
+                      *shared_flow                                 //
                       )
                 : ImageFromCompressedData(std::move(descriptor.data),  //
                                           descriptor.target_width,     //
                                           descriptor.target_height,    //
-                                          flow);
+                                          *shared_flow);
 
         if (!decompressed) {
           FML_LOG(ERROR) << "Could not decompress image.";
-          result({}, std::move(flow));
+          complete({}, std::move(*shared_flow));
           return;
         }
 
         // Step 2: Update the image to the GPU.
         // On IO Thread.
 
-        io_runner->PostTask(fml::MakeCopyable([io_manager, decompressed, result,
-                                               flow =
-                                                   std::move(flow)]() mutable {
+        io_runner->PostTask(fml::MakeCopyable([io_manager, decompressed,
+                                               complete,
+                                               flow = std::move(
+                                                   *shared_flow)]() mutable {
           if (!io_manager) {
             FML_LOG(ERROR) << "Could not acquire IO manager.";
-            return result({}, std::move(flow));
+            return complete({}, std::move(flow));
           }
 
           // If the IO manager does not have a resource context, the caller
           // might not have set one or a software backend could be in use.
           // Either way, just return the image as-is.
           if (!io_manager->GetResourceContext()) {
-            result({std::move(decompressed), io_manager->GetSkiaUnrefQueue()},
-                   std::move(flow));
+            complete({std::move(decompressed), io_manager->GetSkiaUnrefQueue()},
+                     std::move(flow));
             return;
           }
 
@@ -381,14 +426,31 @@ void ImageDecoder::Decode(ImageDescriptor descriptor,
 
           if (!uploaded.get()) {
             FML_LOG(ERROR) << "Could not upload image to the GPU.";
-            result({}, std::move(flow));
+            complete({}, std::move(flow));
             return;
           }
 
           // Finally, all done.
-          result(std::move(uploaded), std::move(flow));
+          complete(std::move(uploaded), std::move(flow));
         }));
-      }));
+      }),
+      // Someone is waiting on the image, so decodes go ahead of speculative
+      // work like shader warm-up on the worker pool.
+      fml::ConcurrentTaskPriority::kHigh);
+}
+
+void ImageDecoder::PurgeCache() {
+  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+  cache_->Purge();
+}
+
+const DecodedImageCache& ImageDecoder::GetCache() const {
+  return *cache_;
+}
+
+const std::shared_ptr<fml::ConcurrentTaskRunner>&
+ImageDecoder::GetConcurrentTaskRunner() const {
+  return concurrent_task_runner_;
 }
 
 fml::WeakPtr<ImageDecoder> ImageDecoder::GetWeakPtr() const {
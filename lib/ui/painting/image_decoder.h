@@ -15,6 +15,7 @@
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/io_manager.h"
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
 #include "third_party/skia/include/core/SkData.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkImageInfo.h"
@@ -28,12 +29,16 @@ namespace flutter {
 // accessed and collected on the UI thread (typically the engine or its runtime
 // controller). None of the expensive operations performed by this component
 // occur in a frame pipeline.
+//
+// Decoded images are kept in a cache of |cache_max_bytes| and shared by all
+// decodes of the same content to the same size.
 class ImageDecoder {
  public:
   ImageDecoder(
       TaskRunners runners,
       std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner,
-      fml::WeakPtr<IOManager> io_manager);
+      fml::WeakPtr<IOManager> io_manager,
+      size_t cache_max_bytes = DecodedImageCache::kDefaultMaxBytes);
 
   ~ImageDecoder();
 
@@ -58,12 +63,23 @@ class ImageDecoder {
   // callback is guaranteed to return on the UI thread.
   void Decode(ImageDescriptor descriptor, const ImageResult& result);
 
+  // Releases all cached decoded images. Images still in use elsewhere stay
+  // alive until they are no longer referenced.
+  void PurgeCache();
+
+  const DecodedImageCache& GetCache() const;
+
+  const std::shared_ptr<fml::ConcurrentTaskRunner>& GetConcurrentTaskRunner()
+      const;
+
   fml::WeakPtr<ImageDecoder> GetWeakPtr() const;
 
  private:
   TaskRunners runners_;
   std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
   fml::WeakPtr<IOManager> io_manager_;
+  // Shared with the decodes in flight, which may outlive the decoder.
+  std::shared_ptr<DecodedImageCache> cache_;
   fml::WeakPtrFactory<ImageDecoder> weak_factory_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(ImageDecoder);
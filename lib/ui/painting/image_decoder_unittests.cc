@@ -4,12 +4,14 @@
 
 #include "flutter/common/task_runners.h"
 #include "flutter/fml/mapping.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
 #include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/lib/ui/painting/image_decoder.h"
 #include "flutter/testing/test_gl_surface.h"
 #include "flutter/testing/testing.h"
 #include "flutter/testing/thread_test.h"
 #include "third_party/skia/include/codec/SkCodec.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 
 namespace flutter {
 namespace testing {
@@ -382,16 +384,17 @@ TEST_F(ImageDecoderFixtureTest, CanDecodeWithResizes) {
   ASSERT_EQ(decoded_size({}, 100), SkISize::Make(75, 100));
   ASSERT_EQ(decoded_size(100, 100), SkISize::Make(100, 100));
 
-  // Destroy the IO manager
-  runners.GetIOTaskRunner()->PostTask([&]() {
-    io_manager.reset();
+  // Destroy the image decoder. It holds on to the decoded images, so it must
+  // go before the IO manager.
+  runners.GetUITaskRunner()->PostTask([&]() {
+    image_decoder.reset();
     latch.Signal();
   });
   latch.Wait();
 
-  // Destroy the image decoder
-  runners.GetUITaskRunner()->PostTask([&]() {
-    image_decoder.reset();
+  // Destroy the IO manager
+  runners.GetIOTaskRunner()->PostTask([&]() {
+    io_manager.reset();
     latch.Signal();
   });
   latch.Wait();
@@ -482,19 +485,255 @@ TEST_F(ImageDecoderFixtureTest, CanResizeWithoutDecode) {
   ASSERT_EQ(decoded_size({}, 100), SkISize::Make(75, 100));
   ASSERT_EQ(decoded_size(100, 100), SkISize::Make(100, 100));
 
+  // Destroy the image decoder. It holds on to the decoded images, so it must
+  // go before the IO manager.
+  runners.GetUITaskRunner()->PostTask([&]() {
+    image_decoder.reset();
+    latch.Signal();
+  });
+  latch.Wait();
+
   // Destroy the IO manager
   runners.GetIOTaskRunner()->PostTask([&]() {
     io_manager.reset();
     latch.Signal();
   });
   latch.Wait();
+}
+
+TEST_F(ImageDecoderFixtureTest, DecodesOfTheSameImageShareTheResult) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  TaskRunners runners(GetCurrentTestName(),         // label
+                      CreateNewThread("platform"),  // platform
+                      CreateNewThread("gpu"),       // gpu
+                      CreateNewThread("ui"),        // ui
+                      CreateNewThread("io")         // io
+  );
+
+  fml::AutoResetWaitableEvent latch;
+  std::unique_ptr<IOManager> io_manager;
+  std::unique_ptr<ImageDecoder> image_decoder;
+
+  runners.GetIOTaskRunner()->PostTask([&]() {
+    io_manager = std::make_unique<TestIOManager>(runners.GetIOTaskRunner());
+    latch.Signal();
+  });
+  latch.Wait();
 
-  // Destroy the image decoder
   runners.GetUITaskRunner()->PostTask([&]() {
+    image_decoder = std::make_unique<ImageDecoder>(
+        runners, loop->GetTaskRunner(), io_manager->GetWeakIOManager());
+    latch.Signal();
+  });
+  latch.Wait();
+
+  // Each decode gets its own copy of the bytes like separate loads of the
+  // same asset would.
+  std::vector<SkiaGPUObject<SkImage>> images;
+  auto decode = [&](size_t count) {
+    fml::CountDownLatch decoded(count);
+    runners.GetUITaskRunner()->PostTask([&]() {
+      for (size_t i = 0; i < count; i++) {
+        ImageDecoder::ImageDescriptor image_descriptor;
+        image_descriptor.target_width = 100;
+        image_descriptor.data = OpenFixtureAsSkData("DashInNooglerHat.jpg");
+        ASSERT_TRUE(image_descriptor.data);
+
+        ImageDecoder::ImageResult callback =
+            [&](SkiaGPUObject<SkImage> image) {
+              ASSERT_TRUE(
+                  runners.GetUITaskRunner()->RunsTasksOnCurrentThread());
+              ASSERT_TRUE(image.get());
+              images.emplace_back(std::move(image));
+              decoded.CountDown();
+            };
+        image_decoder->Decode(std::move(image_descriptor), callback);
+      }
+    });
+    decoded.Wait();
+  };
+
+  // Concurrent decodes wait for the first one.
+  decode(3);
+  // Later decodes are served from the cache.
+  decode(1);
+
+  ASSERT_EQ(images.size(), 4u);
+  for (const auto& image : images) {
+    ASSERT_EQ(image.get(), images[0].get());
+  }
+
+  runners.GetUITaskRunner()->PostTask([&]() {
+    EXPECT_EQ(image_decoder->GetCache().GetCachedImageCount(), 1u);
+    EXPECT_GT(image_decoder->GetCache().GetCachedBytes(), 0u);
+    image_decoder->PurgeCache();
+    EXPECT_EQ(image_decoder->GetCache().GetCachedImageCount(), 0u);
+    EXPECT_EQ(image_decoder->GetCache().GetCachedBytes(), 0u);
+    images.clear();
     image_decoder.reset();
     latch.Signal();
   });
   latch.Wait();
+
+  runners.GetIOTaskRunner()->PostTask([&]() {
+    io_manager.reset();
+    latch.Signal();
+  });
+  latch.Wait();
+}
+
+static sk_sp<SkImage> MakeTestImage(int size) {
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(size, size);
+  bitmap.eraseColor(SK_ColorRED);
+  bitmap.setImmutable();
+  return SkImage::MakeFromBitmap(bitmap);
+}
+
+// Makes a key for a single byte of content, which is |content_hash| unless
+// given otherwise.
+static DecodedImageCache::Key MakeTestKey(size_t content_hash,
+                                          std::optional<uint8_t> byte = {}) {
+  const uint8_t content = byte.value_or(content_hash);
+  DecodedImageCache::Key key;
+  key.content = SkData::MakeWithCopy(&content, 1);
+  key.content_hash = content_hash;
+  key.content_size = 1;
+  return key;
+}
+
+TEST_F(ImageDecoderFixtureTest, DecodedImageCacheCoalescesPendingDecodes) {
+  auto unref_queue = fml::MakeRefCounted<SkiaUnrefQueue>(
+      CreateNewThread(), fml::TimeDelta::FromNanoseconds(0));
+  {
+    DecodedImageCache cache;
+    auto image = MakeTestImage(10);
+
+    std::vector<sk_sp<SkImage>> results;
+    DecodedImageCache::Callback callback =
+        [&results](SkiaGPUObject<SkImage> result) {
+          results.push_back(result.get());
+        };
+
+    ASSERT_EQ(cache.Lookup(MakeTestKey(1), callback),
+              DecodedImageCache::LookupResult::kMiss);
+    ASSERT_EQ(cache.Lookup(MakeTestKey(1), callback),
+              DecodedImageCache::LookupResult::kPending);
+    ASSERT_EQ(cache.Lookup(MakeTestKey(1), callback),
+              DecodedImageCache::LookupResult::kPending);
+    ASSERT_TRUE(results.empty());
+
+    cache.Complete(MakeTestKey(1), image, unref_queue);
+    ASSERT_EQ(results.size(), 2u);
+    ASSERT_EQ(results[0], image);
+    ASSERT_EQ(results[1], image);
+
+    ASSERT_EQ(cache.Lookup(MakeTestKey(1), callback),
+              DecodedImageCache::LookupResult::kHit);
+    ASSERT_EQ(results.size(), 3u);
+    ASSERT_EQ(results[2], image);
+
+    // Failed decodes are passed on but not cached.
+    results.clear();
+    ASSERT_EQ(cache.Lookup(MakeTestKey(2), callback),
+              DecodedImageCache::LookupResult::kMiss);
+    ASSERT_EQ(cache.Lookup(MakeTestKey(2), callback),
+              DecodedImageCache::LookupResult::kPending);
+    cache.Complete(MakeTestKey(2), nullptr, unref_queue);
+    ASSERT_EQ(results.size(), 1u);
+    ASSERT_EQ(results[0], nullptr);
+    ASSERT_EQ(cache.Lookup(MakeTestKey(2), callback),
+              DecodedImageCache::LookupResult::kMiss);
+    cache.Complete(MakeTestKey(2), nullptr, unref_queue);
+
+    ASSERT_EQ(cache.GetCachedImageCount(), 1u);
+  }
+  unref_queue->Drain();
+}
+
+TEST_F(ImageDecoderFixtureTest, DecodedImageCacheSeparatesHashCollisions) {
+  auto unref_queue = fml::MakeRefCounted<SkiaUnrefQueue>(
+      CreateNewThread(), fml::TimeDelta::FromNanoseconds(0));
+  {
+    DecodedImageCache cache;
+    auto image = MakeTestImage(10);
+    auto other_image = MakeTestImage(10);
+
+    std::vector<sk_sp<SkImage>> results;
+    DecodedImageCache::Callback callback =
+        [&results](SkiaGPUObject<SkImage> result) {
+          results.push_back(result.get());
+        };
+
+    // Same hash and size, different bytes.
+    ASSERT_EQ(cache.Lookup(MakeTestKey(1, 1), callback),
+              DecodedImageCache::LookupResult::kMiss);
+    ASSERT_EQ(cache.Lookup(MakeTestKey(1, 2), callback),
+              DecodedImageCache::LookupResult::kMiss);
+    cache.Complete(MakeTestKey(1, 1), image, unref_queue);
+    cache.Complete(MakeTestKey(1, 2), other_image, unref_queue);
+    ASSERT_TRUE(results.empty());
+    ASSERT_EQ(cache.GetCachedImageCount(), 2u);
+
+    ASSERT_EQ(cache.Lookup(MakeTestKey(1, 1), callback),
+              DecodedImageCache::LookupResult::kHit);
+    ASSERT_EQ(cache.Lookup(MakeTestKey(1, 2), callback),
+              DecodedImageCache::LookupResult::kHit);
+    ASSERT_EQ(results.size(), 2u);
+    ASSERT_EQ(results[0], image);
+    ASSERT_EQ(results[1], other_image);
+  }
+  unref_queue->Drain();
+}
+
+TEST_F(ImageDecoderFixtureTest, DecodedImageCacheEvictsLeastRecentlyUsed) {
+  auto unref_queue = fml::MakeRefCounted<SkiaUnrefQueue>(
+      CreateNewThread(), fml::TimeDelta::FromNanoseconds(0));
+  {
+    // Room for two 10x10 N32 images.
+    DecodedImageCache cache(1000);
+    DecodedImageCache::Callback ignore = [](SkiaGPUObject<SkImage> result) {};
+
+    for (size_t hash = 1; hash <= 2; hash++) {
+      ASSERT_EQ(cache.Lookup(MakeTestKey(hash), ignore),
+                DecodedImageCache::LookupResult::kMiss);
+      cache.Complete(MakeTestKey(hash), MakeTestImage(10), unref_queue);
+    }
+    ASSERT_EQ(cache.GetCachedImageCount(), 2u);
+    ASSERT_EQ(cache.GetCachedBytes(), 802u);
+
+    // Touch the first image so that the second one is the least recently
+    // used.
+    ASSERT_EQ(cache.Lookup(MakeTestKey(1), ignore),
+              DecodedImageCache::LookupResult::kHit);
+
+    ASSERT_EQ(cache.Lookup(MakeTestKey(3), ignore),
+              DecodedImageCache::LookupResult::kMiss);
+    cache.Complete(MakeTestKey(3), MakeTestImage(10), unref_queue);
+    ASSERT_EQ(cache.GetCachedImageCount(), 2u);
+    ASSERT_EQ(cache.GetCachedBytes(), 802u);
+
+    ASSERT_EQ(cache.Lookup(MakeTestKey(1), ignore),
+              DecodedImageCache::LookupResult::kHit);
+    ASSERT_EQ(cache.Lookup(MakeTestKey(3), ignore),
+              DecodedImageCache::LookupResult::kHit);
+    ASSERT_EQ(cache.Lookup(MakeTestKey(2), ignore),
+              DecodedImageCache::LookupResult::kMiss);
+    cache.Complete(MakeTestKey(2), nullptr, unref_queue);
+
+    // Images that could never fit are not cached.
+    ASSERT_EQ(cache.Lookup(MakeTestKey(4), ignore),
+              DecodedImageCache::LookupResult::kMiss);
+    cache.Complete(MakeTestKey(4), MakeTestImage(20), unref_queue);
+    ASSERT_EQ(cache.Lookup(MakeTestKey(4), ignore),
+              DecodedImageCache::LookupResult::kMiss);
+    cache.Complete(MakeTestKey(4), nullptr, unref_queue);
+
+    cache.Purge();
+    ASSERT_EQ(cache.GetCachedImageCount(), 0u);
+    ASSERT_EQ(cache.GetCachedBytes(), 0u);
+  }
+  unref_queue->Drain();
 }
 
 // Verifies https://skia-review.googlesource.com/c/skia/+/259161 is present in
@@ -4,19 +4,27 @@
 
 #include "flutter/lib/ui/painting/image_encoding.h"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "flutter/common/task_runners.h"
 #include "flutter/fml/build_config.h"
 #include "flutter/fml/make_copyable.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/painting/image.h"
+#include "flutter/lib/ui/painting/striped_png_encoder.h"
 #include "flutter/lib/ui/ui_dart_state.h"
 #include "third_party/skia/include/core/SkCanvas.h"
-#include "third_party/skia/include/core/SkEncodedImageFormat.h"
 #include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkStream.h"
 #include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/encode/SkPngEncoder.h"
 #include "third_party/tonic/dart_persistent_value.h"
 #include "third_party/tonic/logging/dart_invoke.h"
 #include "third_party/tonic/typed_data/typed_list.h"
@@ -28,12 +36,16 @@ using tonic::ToDart;
 namespace flutter {
 namespace {
 
-// This must be kept in sync with the enum in painting.dart
-enum ImageByteFormat {
-  kRawRGBA,
-  kRawUnmodified,
-  kPNG,
-};
+// Stripes hold about this many bytes of pixels. That is enough to make the
+// setup of each stripe cheap, while a 4K image still has a few stripes for
+// every worker.
+constexpr size_t kStripeBytes = 512 * 1024;
+
+// The zlib compression levels for PNGs. The default matches Skia's encoder.
+constexpr int kDefaultCompressionLevel = 6;
+constexpr int kFastCompressionLevel = 1;
+
+using ChunkCallback = std::function<void(sk_sp<SkData>)>;
 
 void InvokeDataCallback(std::unique_ptr<DartPersistentValue> callback,
                         sk_sp<SkData> buffer) {
@@ -51,6 +63,17 @@ void InvokeDataCallback(std::unique_ptr<DartPersistentValue> callback,
   }
 }
 
+void InvokeChunkCallback(DartPersistentValue* callback, sk_sp<SkData> chunk) {
+  std::shared_ptr<tonic::DartState> dart_state = callback->dart_state().lock();
+  if (!dart_state || callback->is_empty()) {
+    return;
+  }
+  tonic::DartState::Scope scope(dart_state);
+  Dart_Handle dart_data = tonic::DartConverter<tonic::Uint8List>::ToDart(
+      chunk->bytes(), chunk->size());
+  DartInvoke(callback->value(), {dart_data});
+}
+
 sk_sp<SkImage> ConvertToRasterUsingResourceContext(
     sk_sp<SkImage> image,
     GrContext* resource_context) {
@@ -139,102 +162,302 @@ void ConvertImageToRaster(sk_sp<SkImage> image,
   });
 }
 
-sk_sp<SkData> CopyImageByteData(sk_sp<SkImage> raster_image,
-                                SkColorType color_type) {
-  FML_DCHECK(raster_image);
-
-  SkPixmap pixmap;
+// The stripes of an image being encoded. They are taken in order by whichever
+// thread gets to them first, and handed on in order as soon as they and all
+// the stripes above them are encoded.
+class StripedEncoding {
+ public:
+  using EncodeStripeCallback = std::function<sk_sp<SkData>(int stripe)>;
+
+  StripedEncoding(int stripe_count,
+                  EncodeStripeCallback encode_stripe,
+                  ChunkCallback on_stripe)
+      : stripe_count_(stripe_count),
+        encode_stripe_(std::move(encode_stripe)),
+        on_stripe_(std::move(on_stripe)),
+        stripes_(stripe_count),
+        latch_(stripe_count) {}
+
+  // Encodes stripes until there are none left.
+  void EncodeStripes() {
+    for (int stripe = next_stripe_++; stripe < stripe_count_;
+         stripe = next_stripe_++) {
+      // Once a stripe has failed, the rest are only counted down.
+      sk_sp<SkData> encoded = failed_ ? nullptr : encode_stripe_(stripe);
+      OnStripeEncoded(stripe, std::move(encoded));
+      latch_.CountDown();
+    }
+  }
 
-  if (!raster_image->peekPixels(&pixmap)) {
-    FML_LOG(ERROR) << "Could not copy pixels from the raster image.";
-    return nullptr;
+  // Blocks until every stripe is encoded. Returns false if any of them could
+  // not be.
+  bool Wait() {
+    latch_.Wait();
+    return !failed_;
   }
 
-  // The color types already match. No need to swizzle. Return early.
-  if (pixmap.colorType() == color_type) {
-    return SkData::MakeWithCopy(pixmap.addr(), pixmap.computeByteSize());
+ private:
+  const int stripe_count_;
+  const EncodeStripeCallback encode_stripe_;
+  const ChunkCallback on_stripe_;
+  std::atomic_int next_stripe_ = {0};
+  std::atomic_bool failed_ = {false};
+  std::mutex stripes_mutex_;
+  std::vector<sk_sp<SkData>> stripes_;
+  size_t next_handed_on_ = 0;
+  fml::CountDownLatch latch_;
+
+  void OnStripeEncoded(int stripe, sk_sp<SkData> encoded) {
+    std::scoped_lock lock(stripes_mutex_);
+    if (!encoded) {
+      failed_ = true;
+      return;
+    }
+    stripes_[stripe] = std::move(encoded);
+    while (!failed_ && next_handed_on_ < stripes_.size() &&
+           stripes_[next_handed_on_]) {
+      on_stripe_(std::move(stripes_[next_handed_on_++]));
+    }
   }
 
-  // Perform swizzle if the type doesnt match the specification.
-  auto surface = SkSurface::MakeRaster(
-      SkImageInfo::Make(raster_image->width(), raster_image->height(),
-                        color_type, kPremul_SkAlphaType, nullptr));
+  FML_DISALLOW_COPY_AND_ASSIGN(StripedEncoding);
+};
 
-  if (!surface) {
-    FML_LOG(ERROR) << "Could not setup the surface for swizzle.";
-    return nullptr;
+// Encodes |stripe_count| stripes with |encode_stripe|, on the workers if there
+// are any as well as on this thread. Returns false if any stripe failed.
+bool EncodeStripes(
+    int stripe_count,
+    StripedEncoding::EncodeStripeCallback encode_stripe,
+    ChunkCallback on_stripe,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& worker_task_runner) {
+  auto encoding = std::make_shared<StripedEncoding>(
+      stripe_count, std::move(encode_stripe), std::move(on_stripe));
+  if (worker_task_runner && stripe_count > 1) {
+    // This thread encodes stripes as well, and there is no point in more
+    // helpers than there are cores.
+    const size_t helper_count = std::min<size_t>(
+        stripe_count - 1, std::max(std::thread::hardware_concurrency(), 1u));
+    std::vector<fml::closure> tasks(
+        helper_count, [encoding]() { encoding->EncodeStripes(); });
+    worker_task_runner->PostTasks(std::move(tasks));
   }
+  encoding->EncodeStripes();
+  return encoding->Wait();
+}
 
-  surface->writePixels(pixmap, 0, 0);
+int GetStripeHeight(size_t row_bytes) {
+  return std::max<int>(kStripeBytes / std::max<size_t>(row_bytes, 1), 1);
+}
+
+int GetStripeCount(int height, int stripe_height) {
+  return (height + stripe_height - 1) / stripe_height;
+}
 
-  if (!surface->peekPixels(&pixmap)) {
-    FML_LOG(ERROR) << "Pixel address is not available.";
+sk_sp<SkData> MakeDataFromVector(std::vector<uint8_t> bytes) {
+  auto vector = new std::vector<uint8_t>(std::move(bytes));
+  return SkData::MakeWithProc(
+      vector->data(), vector->size(),
+      [](const void* ptr, void* context) {
+        delete static_cast<std::vector<uint8_t>*>(context);
+      },
+      vector);
+}
+
+// Copies the pixels of |pixmap| into |info|, in stripes that each convert
+// their own rows.
+sk_sp<SkData> CopyPixels(
+    const SkPixmap& pixmap,
+    const SkImageInfo& info,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& worker_task_runner,
+    const ChunkCallback& on_chunk) {
+  const size_t row_bytes = info.minRowBytes();
+  const int stripe_height = GetStripeHeight(row_bytes);
+  sk_sp<SkData> pixels = SkData::MakeUninitialized(info.computeMinByteSize());
+  auto encode_stripe = [&](int stripe) -> sk_sp<SkData> {
+    TRACE_EVENT0("flutter", "CopyPixelsStripe");
+    const int first_row = stripe * stripe_height;
+    const int row_count = std::min(stripe_height, info.height() - first_row);
+    const size_t offset = first_row * row_bytes;
+    if (!pixmap.readPixels(info.makeWH(info.width(), row_count),
+                           pixels->writable_data() + offset, row_bytes, 0,
+                           first_row)) {
+      FML_LOG(ERROR) << "Could not copy pixels from the raster image.";
+      return nullptr;
+    }
+    return SkData::MakeSubset(pixels.get(), offset, row_count * row_bytes);
+  };
+  if (!EncodeStripes(GetStripeCount(info.height(), stripe_height),
+                     encode_stripe, on_chunk ? on_chunk : [](sk_sp<SkData>) {},
+                     worker_task_runner)) {
     return nullptr;
   }
+  return on_chunk ? SkData::MakeEmpty() : pixels;
+}
 
-  return SkData::MakeWithCopy(pixmap.addr(), pixmap.computeByteSize());
+sk_sp<SkData> CopyImageByteData(
+    const SkPixmap& pixmap,
+    SkColorType color_type,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& worker_task_runner,
+    const ChunkCallback& on_chunk) {
+  // The color types already match. No need to swizzle.
+  if (pixmap.colorType() == color_type) {
+    return CopyPixels(pixmap, pixmap.info(), worker_task_runner, on_chunk);
+  }
+
+  // Perform swizzle if the type doesnt match the specification.
+  return CopyPixels(pixmap,
+                    SkImageInfo::Make(pixmap.width(), pixmap.height(),
+                                      color_type, kPremul_SkAlphaType, nullptr),
+                    worker_task_runner, on_chunk);
 }
 
-sk_sp<SkData> EncodeImage(sk_sp<SkImage> raster_image, ImageByteFormat format) {
-  TRACE_EVENT0("flutter", __FUNCTION__);
+sk_sp<SkData> EncodePNG(
+    const SkPixmap& pixmap,
+    bool fast_compression,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& worker_task_runner,
+    const ChunkCallback& on_chunk) {
+  const int compression_level =
+      fast_compression ? kFastCompressionLevel : kDefaultCompressionLevel;
+  const size_t row_bytes = pixmap.width() * 4;
+  const int stripe_height = GetStripeHeight(row_bytes);
+
+  // Images that fit into a single stripe are left to Skia's encoder, set up
+  // to compress the way the striped encoder would.
+  if (GetStripeCount(pixmap.height(), stripe_height) < 2) {
+    SkDynamicMemoryWStream stream;
+    SkPngEncoder::Options options;
+    options.fZLibLevel = compression_level;
+    if (compression_level == kFastCompressionLevel) {
+      // Trying every filter on each row costs more than the fastest zlib
+      // level saves.
+      options.fFilterFlags = SkPngEncoder::FilterFlag::kSub;
+    }
+    if (!SkPngEncoder::Encode(&stream, pixmap, options)) {
+      FML_LOG(ERROR) << "Could not convert raster image to PNG.";
+      return nullptr;
+    }
+    sk_sp<SkData> png_image = stream.detachAsData();
+    if (on_chunk) {
+      on_chunk(std::move(png_image));
+      return SkData::MakeEmpty();
+    }
+    return png_image;
+  }
 
-  if (!raster_image) {
+  StripedPNGEncoder encoder(pixmap.width(), pixmap.height(), stripe_height,
+                            compression_level);
+  const SkImageInfo rows_info =
+      SkImageInfo::Make(pixmap.width(), stripe_height, kRGBA_8888_SkColorType,
+                        kUnpremul_SkAlphaType, nullptr);
+  StripedPNGEncoder::RowReader row_reader = [&](int first_row, int row_count,
+                                                uint8_t* rows) {
+    return pixmap.readPixels(rows_info.makeWH(pixmap.width(), row_count), rows,
+                             row_bytes, 0, first_row);
+  };
+  auto encode_stripe = [&](int stripe) -> sk_sp<SkData> {
+    std::vector<uint8_t> encoded;
+    if (!encoder.EncodeStripe(stripe, row_reader, &encoded)) {
+      return nullptr;
+    }
+    return MakeDataFromVector(std::move(encoded));
+  };
+
+  std::vector<sk_sp<SkData>> stripes;
+  ChunkCallback on_stripe = on_chunk;
+  if (!on_stripe) {
+    on_stripe = [&stripes](sk_sp<SkData> stripe) {
+      stripes.push_back(std::move(stripe));
+    };
+  }
+  if (!EncodeStripes(encoder.GetStripeCount(), encode_stripe, on_stripe,
+                     worker_task_runner)) {
+    FML_LOG(ERROR) << "Could not convert raster image to PNG.";
     return nullptr;
   }
 
-  switch (format) {
-    case kPNG: {
-      auto png_image =
-          raster_image->encodeToData(SkEncodedImageFormat::kPNG, 0);
-
-      if (png_image == nullptr) {
-        FML_LOG(ERROR) << "Could not convert raster image to PNG.";
-        return nullptr;
-      };
-      return png_image;
-    } break;
-    case kRawRGBA: {
-      return CopyImageByteData(raster_image, kRGBA_8888_SkColorType);
-    } break;
-    case kRawUnmodified: {
-      return CopyImageByteData(raster_image, raster_image->colorType());
-    } break;
+  std::vector<uint8_t> trailer = encoder.EncodeTrailer();
+  if (on_chunk) {
+    on_chunk(MakeDataFromVector(std::move(trailer)));
+    return SkData::MakeEmpty();
   }
 
-  FML_LOG(ERROR) << "Unknown error encoding image.";
-  return nullptr;
+  size_t size = trailer.size();
+  for (const auto& stripe : stripes) {
+    size += stripe->size();
+  }
+  sk_sp<SkData> png_image = SkData::MakeUninitialized(size);
+  uint8_t* out = static_cast<uint8_t*>(png_image->writable_data());
+  for (const auto& stripe : stripes) {
+    out = std::copy(stripe->bytes(), stripe->bytes() + stripe->size(), out);
+  }
+  std::copy(trailer.begin(), trailer.end(), out);
+  return png_image;
 }
 
 void EncodeImageAndInvokeDataCallback(
     sk_sp<SkImage> image,
     std::unique_ptr<DartPersistentValue> callback,
+    std::shared_ptr<DartPersistentValue> chunk_callback,
     ImageByteFormat format,
+    bool fast_compression,
     fml::RefPtr<fml::TaskRunner> ui_task_runner,
     fml::RefPtr<fml::TaskRunner> gpu_task_runner,
     fml::RefPtr<fml::TaskRunner> io_task_runner,
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
     GrContext* resource_context,
     fml::WeakPtr<SnapshotDelegate> snapshot_delegate) {
   auto callback_task = fml::MakeCopyable(
-      [callback = std::move(callback)](sk_sp<SkData> encoded) mutable {
+      [callback = std::move(callback),
+       chunk_callback](sk_sp<SkData> encoded) mutable {
         InvokeDataCallback(std::move(callback), std::move(encoded));
+        // Chunks are all delivered by now. Releasing the chunk callback here
+        // keeps its handle from being released off the UI thread.
+        if (chunk_callback) {
+          chunk_callback->Clear();
+        }
+      });
+
+  ChunkCallback on_chunk;
+  if (chunk_callback) {
+    on_chunk = [chunk_callback, ui_task_runner](sk_sp<SkData> chunk) {
+      ui_task_runner->PostTask([chunk_callback, chunk = std::move(chunk)]() {
+        InvokeChunkCallback(chunk_callback.get(), chunk);
       });
+    };
+  }
 
-  auto encode_task = [callback_task = std::move(callback_task), format,
-                      ui_task_runner](sk_sp<SkImage> raster_image) {
-    sk_sp<SkData> encoded = EncodeImage(std::move(raster_image), format);
-    ui_task_runner->PostTask(
-        [callback_task = std::move(callback_task),
-         encoded = std::move(encoded)] { callback_task(encoded); });
+  // Encoding happens on the workers, so that large images do not hold up
+  // the IO thread.
+  auto encode_task = [callback_task = std::move(callback_task),
+                      on_chunk = std::move(on_chunk), format,
+                      fast_compression, ui_task_runner,
+                      worker_task_runner](sk_sp<SkImage> raster_image) {
+    auto encode = [callback_task, on_chunk, format, fast_compression,
+                   ui_task_runner, worker_task_runner, raster_image]() {
+      sk_sp<SkData> encoded =
+          EncodeRasterImage(raster_image, format, fast_compression,
+                            worker_task_runner, on_chunk);
+      ui_task_runner->PostTask(
+          [callback_task, encoded = std::move(encoded)]() mutable {
+            callback_task(std::move(encoded));
+          });
+    };
+    if (worker_task_runner) {
+      worker_task_runner->PostTask(encode);
+    } else {
+      encode();
+    }
   };
 
   ConvertImageToRaster(std::move(image), encode_task, gpu_task_runner,
                        io_task_runner, resource_context, snapshot_delegate);
 }
-
 }  // namespace
 
 Dart_Handle EncodeImage(CanvasImage* canvas_image,
                         int format,
+                        bool fast_compression,
+                        Dart_Handle chunk_callback_handle,
                         Dart_Handle callback_handle) {
   if (!canvas_image)
     return ToDart("encode called with non-genuine Image.");
@@ -242,29 +465,83 @@ Dart_Handle EncodeImage(CanvasImage* canvas_image,
   if (!Dart_IsClosure(callback_handle))
     return ToDart("Callback must be a function.");
 
+  if (!Dart_IsNull(chunk_callback_handle) &&
+      !Dart_IsClosure(chunk_callback_handle))
+    return ToDart("Chunk callback must be a function.");
+
   ImageByteFormat image_format = static_cast<ImageByteFormat>(format);
 
   auto callback = std::make_unique<DartPersistentValue>(
       tonic::DartState::Current(), callback_handle);
 
+  std::shared_ptr<DartPersistentValue> chunk_callback;
+  if (!Dart_IsNull(chunk_callback_handle)) {
+    chunk_callback = std::make_shared<DartPersistentValue>(
+        tonic::DartState::Current(), chunk_callback_handle);
+  }
+
+  // Images are encoded on the same workers as they are decoded on.
+  std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner;
+  if (auto image_decoder = UIDartState::Current()->GetImageDecoder()) {
+    worker_task_runner = image_decoder->GetConcurrentTaskRunner();
+  }
+
   const auto& task_runners = UIDartState::Current()->GetTaskRunners();
 
   task_runners.GetIOTaskRunner()->PostTask(fml::MakeCopyable(
-      [callback = std::move(callback), image = canvas_image->image(),
-       image_format, ui_task_runner = task_runners.GetUITaskRunner(),
+      [callback = std::move(callback),
+       chunk_callback = std::move(chunk_callback),
+       image = canvas_image->image(), image_format, fast_compression,
+       ui_task_runner = task_runners.GetUITaskRunner(),
        gpu_task_runner = task_runners.GetGPUTaskRunner(),
        io_task_runner = task_runners.GetIOTaskRunner(),
+       worker_task_runner = std::move(worker_task_runner),
        io_manager = UIDartState::Current()->GetIOManager(),
        snapshot_delegate =
            UIDartState::Current()->GetSnapshotDelegate()]() mutable {
         EncodeImageAndInvokeDataCallback(
-            std::move(image), std::move(callback), image_format,
-            std::move(ui_task_runner), std::move(gpu_task_runner),
-            std::move(io_task_runner), io_manager->GetResourceContext().get(),
+            std::move(image), std::move(callback), std::move(chunk_callback),
+            image_format, fast_compression, std::move(ui_task_runner),
+            std::move(gpu_task_runner), std::move(io_task_runner),
+            std::move(worker_task_runner),
+            io_manager->GetResourceContext().get(),
             std::move(snapshot_delegate));
       }));
 
   return Dart_Null();
 }
 
+sk_sp<SkData> EncodeRasterImage(
+    sk_sp<SkImage> raster_image,
+    ImageByteFormat format,
+    bool fast_compression,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& worker_task_runner,
+    const std::function<void(sk_sp<SkData>)>& on_chunk) {
+  TRACE_EVENT0("flutter", "EncodeRasterImage");
+
+  if (!raster_image) {
+    return nullptr;
+  }
+
+  SkPixmap pixmap;
+  if (!raster_image->peekPixels(&pixmap)) {
+    FML_LOG(ERROR) << "Could not copy pixels from the raster image.";
+    return nullptr;
+  }
+
+  switch (format) {
+    case kPNG:
+      return EncodePNG(pixmap, fast_compression, worker_task_runner, on_chunk);
+    case kRawRGBA:
+      return CopyImageByteData(pixmap, kRGBA_8888_SkColorType,
+                               worker_task_runner, on_chunk);
+    case kRawUnmodified:
+      return CopyImageByteData(pixmap, pixmap.colorType(), worker_task_runner,
+                               on_chunk);
+  }
+
+  FML_LOG(ERROR) << "Unknown error encoding image.";
+  return nullptr;
+}
+
 }  // namespace flutter
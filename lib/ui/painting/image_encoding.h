@@ -5,16 +5,59 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_IMAGE_ENCODING_H_
 #define FLUTTER_LIB_UI_PAINTING_IMAGE_ENCODING_H_
 
+#include <functional>
+#include <memory>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
 #include "third_party/tonic/dart_library_natives.h"
 
 namespace flutter {
 
 class CanvasImage;
 
+// This must be kept in sync with the enum in painting.dart
+enum ImageByteFormat {
+  kRawRGBA,
+  kRawUnmodified,
+  kPNG,
+};
+
 Dart_Handle EncodeImage(CanvasImage* canvas_image,
                         int format,
+                        bool fast_compression,
+                        Dart_Handle chunk_callback_handle,
                         Dart_Handle callback_handle);
 
+//------------------------------------------------------------------------------
+/// @brief      Encodes a raster image into |format|. Images large enough are
+///             encoded in horizontal stripes, concurrently if there is a
+///             |worker_task_runner|, with the calling thread encoding stripes
+///             as well.
+///
+/// @param[in]  raster_image        The image to encode. Its pixels must be
+///                                 accessible.
+/// @param[in]  format              The format to encode the image into.
+/// @param[in]  fast_compression    Whether to trade size for speed when
+///                                 compressing, which only affects PNGs.
+/// @param[in]  worker_task_runner  The pool to encode stripes on, if any.
+/// @param[in]  on_chunk            If given, receives the encoded bytes in
+///                                 order as soon as they are ready instead
+///                                 of them being returned. It is called on
+///                                 whichever thread finished the chunk, but
+///                                 never concurrently.
+///
+/// @return     The encoded image, an empty SkData if all of it went to
+///             |on_chunk|, or nullptr if the image could not be encoded.
+///
+sk_sp<SkData> EncodeRasterImage(
+    sk_sp<SkImage> raster_image,
+    ImageByteFormat format,
+    bool fast_compression,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& worker_task_runner,
+    const std::function<void(sk_sp<SkData>)>& on_chunk = nullptr);
+
 }  // namespace flutter
 
 #endif  // FLUTTER_LIB_UI_PAINTING_IMAGE_ENCODING_H_
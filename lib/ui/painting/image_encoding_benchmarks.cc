@@ -0,0 +1,116 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/logging.h"
+#include "flutter/lib/ui/painting/image_encoding.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkStream.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/effects/SkGradientShader.h"
+#include "third_party/skia/include/encode/SkPngEncoder.h"
+
+namespace flutter {
+
+// Something like a screenshot: a gradient background with rows of cards.
+static sk_sp<SkImage> MakeScreenshot(const SkISize& size) {
+  auto surface = SkSurface::MakeRasterN32Premul(size.width(), size.height());
+  FML_CHECK(surface);
+  SkCanvas* canvas = surface->getCanvas();
+
+  const SkPoint points[] = {SkPoint::Make(0, 0),
+                            SkPoint::Make(size.width(), size.height())};
+  const SkColor colors[] = {SK_ColorBLUE, SK_ColorWHITE};
+  SkPaint background;
+  background.setShader(SkGradientShader::MakeLinear(
+      points, colors, nullptr, 2, SkTileMode::kClamp));
+  canvas->drawPaint(background);
+
+  SkPaint card;
+  card.setAntiAlias(true);
+  const SkScalar card_height = size.height() / 12.0f;
+  for (int i = 0; i < 12; ++i) {
+    card.setColor(SkColorSetARGB(0xE0, 0x20 * (i % 8), 0x80, 0xFF - 0x10 * i));
+    canvas->drawRRect(
+        SkRRect::MakeRectXY(
+            SkRect::MakeXYWH(16, i * card_height + 4, size.width() - 32,
+                             card_height - 8),
+            12, 12),
+        card);
+  }
+  return surface->makeImageSnapshot();
+}
+
+// Encodes a screenshot on a number of workers, in addition to the calling
+// thread. Without workers, the stripes are encoded one after the other.
+static void BM_EncodeImage(benchmark::State& state,
+                           ImageByteFormat format,
+                           bool fast_compression) {
+  const SkISize size = SkISize::Make(state.range(0), state.range(1));
+  const size_t worker_count = state.range(2);
+  const sk_sp<SkImage> image = MakeScreenshot(size);
+
+  std::shared_ptr<fml::ConcurrentMessageLoop> loop;
+  std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner;
+  if (worker_count > 0) {
+    loop = fml::ConcurrentMessageLoop::Create(worker_count);
+    worker_task_runner = loop->GetTaskRunner();
+  }
+
+  size_t encoded_size = 0;
+  while (state.KeepRunning()) {
+    sk_sp<SkData> encoded =
+        EncodeRasterImage(image, format, fast_compression, worker_task_runner);
+    FML_CHECK(encoded);
+    encoded_size = encoded->size();
+  }
+  state.counters["encoded_bytes"] = encoded_size;
+}
+
+// What encoding a PNG cost before it was striped: a single call into Skia's
+// encoder, on the IO thread.
+static void BM_EncodePNGWithSkia(benchmark::State& state) {
+  const SkISize size = SkISize::Make(state.range(0), state.range(1));
+  const sk_sp<SkImage> image = MakeScreenshot(size);
+  SkPixmap pixmap;
+  FML_CHECK(image->peekPixels(&pixmap));
+
+  size_t encoded_size = 0;
+  while (state.KeepRunning()) {
+    SkDynamicMemoryWStream stream;
+    FML_CHECK(SkPngEncoder::Encode(&stream, pixmap, {}));
+    encoded_size = stream.bytesWritten();
+  }
+  state.counters["encoded_bytes"] = encoded_size;
+}
+
+static void EncodeArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"width", "height", "workers"});
+  for (const auto& size : {SkISize::Make(1280, 720), SkISize::Make(1920, 1080),
+                           SkISize::Make(3840, 2160)}) {
+    for (int workers : {0, 1, 3, 7}) {
+      benchmark->Args({size.width(), size.height(), workers});
+    }
+  }
+  benchmark->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_CAPTURE(BM_EncodeImage, png, kPNG, false)->Apply(EncodeArguments);
+BENCHMARK_CAPTURE(BM_EncodeImage, png_fast, kPNG, true)
+    ->Apply(EncodeArguments);
+BENCHMARK_CAPTURE(BM_EncodeImage, raw_rgba, kRawRGBA, false)
+    ->Apply(EncodeArguments);
+
+BENCHMARK(BM_EncodePNGWithSkia)
+    ->ArgNames({"width", "height"})
+    ->Args({1280, 720})
+    ->Args({1920, 1080})
+    ->Args({3840, 2160})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace flutter
@@ -6,16 +6,17 @@
 
 #include "flutter/fml/make_copyable.h"
 #include "third_party/dart/runtime/include/dart_api.h"
-#include "third_party/skia/include/core/SkPixelRef.h"
 #include "third_party/tonic/logging/dart_invoke.h"
 
 namespace flutter {
 
-MultiFrameCodec::MultiFrameCodec(std::unique_ptr<SkCodec> codec)
-    : codec_(std::move(codec)),
-      frameCount_(codec_->getFrameCount()),
-      repetitionCount_(codec_->getRepetitionCount()),
-      nextFrameIndex_(0) {}
+MultiFrameCodec::MultiFrameCodec(
+    std::unique_ptr<SkCodec> codec,
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+    AnimatedFrameDecoder::Options options)
+    : decoder_(AnimatedFrameDecoder::Create(std::move(codec),
+                                            std::move(worker_task_runner),
+                                            options)) {}
 
 MultiFrameCodec::~MultiFrameCodec() = default;
 
@@ -37,95 +38,23 @@ static void InvokeNextFrameCallback(
   }
 }
 
-// Copied the source bitmap to the destination. If this cannot occur due to
-// running out of memory or the image info not being compatible, returns false.
-static bool CopyToBitmap(SkBitmap* dst,
-                         SkColorType dstColorType,
-                         const SkBitmap& src) {
-  SkPixmap srcPM;
-  if (!src.peekPixels(&srcPM)) {
-    return false;
-  }
-
-  SkBitmap tmpDst;
-  SkImageInfo dstInfo = srcPM.info().makeColorType(dstColorType);
-  if (!tmpDst.setInfo(dstInfo)) {
-    return false;
-  }
-
-  if (!tmpDst.tryAllocPixels()) {
-    return false;
-  }
-
-  SkPixmap dstPM;
-  if (!tmpDst.peekPixels(&dstPM)) {
-    return false;
-  }
-
-  if (!srcPM.readPixels(dstPM)) {
-    return false;
-  }
-
-  dst->swap(tmpDst);
-  return true;
-}
-
-sk_sp<SkImage> MultiFrameCodec::GetNextFrameImage(
+// Uploads a decoded frame to the GPU if possible.
+static sk_sp<SkImage> UploadFrameImage(
+    sk_sp<SkImage> frame_image,
     fml::WeakPtr<GrContext> resourceContext) {
-  SkBitmap bitmap = SkBitmap();
-  SkImageInfo info = codec_->getInfo().makeColorType(kN32_SkColorType);
-  if (info.alphaType() == kUnpremul_SkAlphaType) {
-    info = info.makeAlphaType(kPremul_SkAlphaType);
-  }
-  bitmap.allocPixels(info);
-
-  SkCodec::Options options;
-  options.fFrameIndex = nextFrameIndex_;
-  SkCodec::FrameInfo frameInfo;
-  codec_->getFrameInfo(nextFrameIndex_, &frameInfo);
-  const int requiredFrameIndex = frameInfo.fRequiredFrame;
-  if (requiredFrameIndex != SkCodec::kNoFrame) {
-    if (lastRequiredFrame_ == nullptr) {
-      FML_LOG(ERROR) << "Frame " << nextFrameIndex_ << " depends on frame "
-                     << requiredFrameIndex
-                     << " and no required frames are cached.";
-      return nullptr;
-    } else if (lastRequiredFrameIndex_ != requiredFrameIndex) {
-      FML_DLOG(INFO) << "Required frame " << requiredFrameIndex
-                     << " is not cached. Using " << lastRequiredFrameIndex_
-                     << " instead";
-    }
-
-    if (lastRequiredFrame_->getPixels() &&
-        CopyToBitmap(&bitmap, lastRequiredFrame_->colorType(),
-                     *lastRequiredFrame_)) {
-      options.fPriorFrame = requiredFrameIndex;
-    }
+  if (!frame_image || !resourceContext) {
+    // Defer uploading until time of draw later on the GPU thread. Can happen
+    // when GL operations are currently forbidden such as in the background
+    // on iOS.
+    return frame_image;
   }
 
-  if (SkCodec::kSuccess != codec_->getPixels(info, bitmap.getPixels(),
-                                             bitmap.rowBytes(), &options)) {
-    FML_LOG(ERROR) << "Could not getPixels for frame " << nextFrameIndex_;
+  SkPixmap pixmap;
+  if (!frame_image->peekPixels(&pixmap)) {
     return nullptr;
   }
-
-  // Hold onto this if we need it to decode future frames.
-  if (frameInfo.fDisposalMethod == SkCodecAnimation::DisposalMethod::kKeep) {
-    lastRequiredFrame_ = std::make_unique<SkBitmap>(bitmap);
-    lastRequiredFrameIndex_ = nextFrameIndex_;
-  }
-
-  if (resourceContext) {
-    SkPixmap pixmap(bitmap.info(), bitmap.pixelRef()->pixels(),
-                    bitmap.pixelRef()->rowBytes());
-    return SkImage::MakeCrossContextFromPixmap(resourceContext.get(), pixmap,
-                                               true);
-  } else {
-    // Defer decoding until time of draw later on the GPU thread. Can happen
-    // when GL operations are currently forbidden such as in the background
-    // on iOS.
-    return SkImage::MakeFromBitmap(bitmap);
-  }
+  return SkImage::MakeCrossContextFromPixmap(resourceContext.get(), pixmap,
+                                             true);
 }
 
 void MultiFrameCodec::GetNextFrameAndInvokeCallback(
@@ -135,16 +64,15 @@ void MultiFrameCodec::GetNextFrameAndInvokeCallback(
     fml::RefPtr<flutter::SkiaUnrefQueue> unref_queue,
     size_t trace_id) {
   fml::RefPtr<FrameInfo> frameInfo = NULL;
-  sk_sp<SkImage> skImage = GetNextFrameImage(resourceContext);
+  AnimatedFrameDecoder::Frame frame = decoder_->GetNextFrame();
+  sk_sp<SkImage> skImage =
+      UploadFrameImage(std::move(frame.image), resourceContext);
   if (skImage) {
     fml::RefPtr<CanvasImage> image = CanvasImage::Create();
     image->set_image({skImage, std::move(unref_queue)});
-    SkCodec::FrameInfo skFrameInfo;
-    codec_->getFrameInfo(nextFrameIndex_, &skFrameInfo);
     frameInfo =
-        fml::MakeRefCounted<FrameInfo>(std::move(image), skFrameInfo.fDuration);
+        fml::MakeRefCounted<FrameInfo>(std::move(image), frame.duration);
   }
-  nextFrameIndex_ = (nextFrameIndex_ + 1) % frameCount_;
 
   ui_task_runner->PostTask(fml::MakeCopyable(
       [callback = std::move(callback), frameInfo, trace_id]() mutable {
@@ -179,11 +107,11 @@ Dart_Handle MultiFrameCodec::getNextFrame(Dart_Handle callback_handle) {
 }
 
 int MultiFrameCodec::frameCount() const {
-  return frameCount_;
+  return decoder_->GetFrameCount();
 }
 
 int MultiFrameCodec::repetitionCount() const {
-  return repetitionCount_;
+  return decoder_->GetRepetitionCount();
 }
 
 }  // namespace flutter
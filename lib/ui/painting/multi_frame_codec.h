@@ -5,14 +5,20 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_MUTLI_FRAME_CODEC_H_
 #define FLUTTER_LIB_UI_PAINTING_MUTLI_FRAME_CODEC_H_
 
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
+#include "flutter/lib/ui/painting/animated_frame_decoder.h"
 #include "flutter/lib/ui/painting/codec.h"
 
 namespace flutter {
 
+// Frames are decoded ahead of |getNextFrame| on |worker_task_runner| if one
+// is given. See |AnimatedFrameDecoder|.
 class MultiFrameCodec : public Codec {
  public:
-  MultiFrameCodec(std::unique_ptr<SkCodec> codec);
+  MultiFrameCodec(std::unique_ptr<SkCodec> codec,
+                  std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+                  AnimatedFrameDecoder::Options options = {});
 
   ~MultiFrameCodec() override;
 
@@ -26,17 +32,8 @@ class MultiFrameCodec : public Codec {
   Dart_Handle getNextFrame(Dart_Handle args) override;
 
  private:
-  const std::unique_ptr<SkCodec> codec_;
-  const int frameCount_;
-  const int repetitionCount_;
-  int nextFrameIndex_;
-
-  // The last decoded frame that's required to decode any subsequent frames.
-  std::unique_ptr<SkBitmap> lastRequiredFrame_;
-  // The index of the last decoded required frame.
-  int lastRequiredFrameIndex_ = -1;
-
-  sk_sp<SkImage> GetNextFrameImage(fml::WeakPtr<GrContext> resourceContext);
+  // Shared with the prefetches in flight, which may outlive the codec.
+  const std::shared_ptr<AnimatedFrameDecoder> decoder_;
 
   void GetNextFrameAndInvokeCallback(
       std::unique_ptr<DartPersistentValue> callback,
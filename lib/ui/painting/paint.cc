@@ -33,7 +33,8 @@ constexpr int kMaskFilterBlurStyleIndex = 10;
 constexpr int kMaskFilterSigmaIndex = 11;
 constexpr int kInvertColorIndex = 12;
 constexpr int kDitherIndex = 13;
-constexpr size_t kDataByteCount = 56;  // 4 * (last index + 1)
+static_assert(kPaintDataByteCount == 4 * (kDitherIndex + 1),
+              "kPaintDataByteCount must match the last index");
 
 // Indices for objects.
 constexpr int kShaderIndex = 0;
@@ -65,98 +66,84 @@ constexpr float invert_colors[20] = {
 // Must be kept in sync with the MaskFilter private constants in painting.dart.
 enum MaskFilterType { Null, Blur };
 
-Paint::Paint(Dart_Handle paint_objects, Dart_Handle paint_data) {
-  is_null_ = Dart_IsNull(paint_data);
-  if (is_null_)
-    return;
-
-  Dart_Handle values[kObjectCount];
-  if (!Dart_IsNull(paint_objects)) {
-    FML_DCHECK(Dart_IsList(paint_objects));
-    intptr_t length = 0;
-    Dart_ListLength(paint_objects, &length);
-
-    FML_CHECK(length == kObjectCount);
-    if (Dart_IsError(Dart_ListGetRange(paint_objects, 0, kObjectCount, values)))
-      return;
-
-    Dart_Handle shader = values[kShaderIndex];
-    if (!Dart_IsNull(shader)) {
-      Shader* decoded = tonic::DartConverter<Shader*>::FromDart(shader);
-      paint_.setShader(decoded->shader());
-    }
-
-    Dart_Handle color_filter = values[kColorFilterIndex];
-    if (!Dart_IsNull(color_filter)) {
-      ColorFilter* decoded_color_filter =
-          tonic::DartConverter<ColorFilter*>::FromDart(color_filter);
-      paint_.setColorFilter(decoded_color_filter->filter());
-    }
+// Applies the objects of an encoded paint, which are the |kObjectCount|
+// handles at |values|.
+static void DecodePaintObjects(const Dart_Handle* values, SkPaint* paint) {
+  Dart_Handle shader = values[kShaderIndex];
+  if (!Dart_IsNull(shader)) {
+    Shader* decoded = tonic::DartConverter<Shader*>::FromDart(shader);
+    paint->setShader(decoded->shader());
+  }
 
-    Dart_Handle image_filter = values[kImageFilterIndex];
-    if (!Dart_IsNull(image_filter)) {
-      ImageFilter* decoded =
-          tonic::DartConverter<ImageFilter*>::FromDart(image_filter);
-      paint_.setImageFilter(decoded->filter());
-    }
+  Dart_Handle color_filter = values[kColorFilterIndex];
+  if (!Dart_IsNull(color_filter)) {
+    ColorFilter* decoded_color_filter =
+        tonic::DartConverter<ColorFilter*>::FromDart(color_filter);
+    paint->setColorFilter(decoded_color_filter->filter());
   }
 
-  tonic::DartByteData byte_data(paint_data);
-  FML_CHECK(byte_data.length_in_bytes() == kDataByteCount);
+  Dart_Handle image_filter = values[kImageFilterIndex];
+  if (!Dart_IsNull(image_filter)) {
+    ImageFilter* decoded =
+        tonic::DartConverter<ImageFilter*>::FromDart(image_filter);
+    paint->setImageFilter(decoded->filter());
+  }
+}
 
-  const uint32_t* uint_data = static_cast<const uint32_t*>(byte_data.data());
-  const float* float_data = static_cast<const float*>(byte_data.data());
+void DecodePaintData(const void* data, SkPaint* paint) {
+  const uint32_t* uint_data = static_cast<const uint32_t*>(data);
+  const float* float_data = static_cast<const float*>(data);
 
-  paint_.setAntiAlias(uint_data[kIsAntiAliasIndex] == 0);
+  paint->setAntiAlias(uint_data[kIsAntiAliasIndex] == 0);
 
   uint32_t encoded_color = uint_data[kColorIndex];
   if (encoded_color) {
     SkColor color = encoded_color ^ kColorDefault;
-    paint_.setColor(color);
+    paint->setColor(color);
   }
 
   uint32_t encoded_blend_mode = uint_data[kBlendModeIndex];
   if (encoded_blend_mode) {
     uint32_t blend_mode = encoded_blend_mode ^ kBlendModeDefault;
-    paint_.setBlendMode(static_cast<SkBlendMode>(blend_mode));
+    paint->setBlendMode(static_cast<SkBlendMode>(blend_mode));
   }
 
   uint32_t style = uint_data[kStyleIndex];
   if (style)
-    paint_.setStyle(static_cast<SkPaint::Style>(style));
+    paint->setStyle(static_cast<SkPaint::Style>(style));
 
   float stroke_width = float_data[kStrokeWidthIndex];
   if (stroke_width != 0.0)
-    paint_.setStrokeWidth(stroke_width);
+    paint->setStrokeWidth(stroke_width);
 
   uint32_t stroke_cap = uint_data[kStrokeCapIndex];
   if (stroke_cap)
-    paint_.setStrokeCap(static_cast<SkPaint::Cap>(stroke_cap));
+    paint->setStrokeCap(static_cast<SkPaint::Cap>(stroke_cap));
 
   uint32_t stroke_join = uint_data[kStrokeJoinIndex];
   if (stroke_join)
-    paint_.setStrokeJoin(static_cast<SkPaint::Join>(stroke_join));
+    paint->setStrokeJoin(static_cast<SkPaint::Join>(stroke_join));
 
   float stroke_miter_limit = float_data[kStrokeMiterLimitIndex];
   if (stroke_miter_limit != 0.0)
-    paint_.setStrokeMiter(stroke_miter_limit + kStrokeMiterLimitDefault);
+    paint->setStrokeMiter(stroke_miter_limit + kStrokeMiterLimitDefault);
 
   uint32_t filter_quality = uint_data[kFilterQualityIndex];
   if (filter_quality)
-    paint_.setFilterQuality(static_cast<SkFilterQuality>(filter_quality));
+    paint->setFilterQuality(static_cast<SkFilterQuality>(filter_quality));
 
   if (uint_data[kInvertColorIndex]) {
     sk_sp<SkColorFilter> invert_filter =
         ColorFilter::MakeColorMatrixFilter255(invert_colors);
-    sk_sp<SkColorFilter> current_filter = paint_.refColorFilter();
+    sk_sp<SkColorFilter> current_filter = paint->refColorFilter();
     if (current_filter) {
       invert_filter = invert_filter->makeComposed(current_filter);
     }
-    paint_.setColorFilter(invert_filter);
+    paint->setColorFilter(invert_filter);
   }
 
   if (uint_data[kDitherIndex]) {
-    paint_.setDither(true);
+    paint->setDither(true);
   }
 
   switch (uint_data[kMaskFilterIndex]) {
@@ -166,11 +153,60 @@ Paint::Paint(Dart_Handle paint_objects, Dart_Handle paint_data) {
       SkBlurStyle blur_style =
           static_cast<SkBlurStyle>(uint_data[kMaskFilterBlurStyleIndex]);
       double sigma = float_data[kMaskFilterSigmaIndex];
-      paint_.setMaskFilter(SkMaskFilter::MakeBlur(blur_style, sigma));
+      paint->setMaskFilter(SkMaskFilter::MakeBlur(blur_style, sigma));
       break;
   }
 }
 
+Paint::Paint(Dart_Handle paint_objects, Dart_Handle paint_data) {
+  is_null_ = Dart_IsNull(paint_data);
+  if (is_null_)
+    return;
+
+  if (!Dart_IsNull(paint_objects)) {
+    FML_DCHECK(Dart_IsList(paint_objects));
+    intptr_t length = 0;
+    Dart_ListLength(paint_objects, &length);
+
+    FML_CHECK(length == kObjectCount);
+    Dart_Handle values[kObjectCount];
+    if (Dart_IsError(Dart_ListGetRange(paint_objects, 0, kObjectCount, values)))
+      return;
+
+    DecodePaintObjects(values, &paint_);
+  }
+
+  tonic::DartByteData byte_data(paint_data);
+  FML_CHECK(byte_data.length_in_bytes() == kPaintDataByteCount);
+
+  DecodePaintData(byte_data.data(), &paint_);
+}
+
+PaintBatch::PaintBatch(Dart_Handle paint_objects, Dart_Handle paint_data) {
+  // The objects of all the paints are unwrapped before the data is acquired,
+  // since the VM cannot be entered while a byte data is acquired.
+  intptr_t length = 0;
+  Dart_ListLength(paint_objects, &length);
+  std::vector<Dart_Handle> values(length);
+  if (length > 0 &&
+      Dart_IsError(Dart_ListGetRange(paint_objects, 0, length, values.data())))
+    return;
+
+  const size_t count = length / kObjectCount;
+  paints_.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    DecodePaintObjects(&values[i * kObjectCount], &paints_[i]);
+  }
+
+  tonic::DartByteData byte_data(paint_data);
+  FML_CHECK(byte_data.length_in_bytes() == count * kPaintDataByteCount);
+
+  const uint8_t* data = static_cast<const uint8_t*>(byte_data.data());
+  for (size_t i = 0; i < count; i++) {
+    DecodePaintData(data + i * kPaintDataByteCount, &paints_[i]);
+  }
+}
+
 }  // namespace flutter
 
 namespace tonic {
@@ -188,6 +224,19 @@ flutter::Paint DartConverter<flutter::Paint>::FromArguments(
   return flutter::Paint(paint_objects, paint_data);
 }
 
+flutter::PaintBatch DartConverter<flutter::PaintBatch>::FromArguments(
+    Dart_NativeArguments args,
+    int index,
+    Dart_Handle& exception) {
+  Dart_Handle paint_objects = Dart_GetNativeArgument(args, index);
+  FML_DCHECK(!LogIfError(paint_objects));
+
+  Dart_Handle paint_data = Dart_GetNativeArgument(args, index + 1);
+  FML_DCHECK(!LogIfError(paint_data));
+
+  return flutter::PaintBatch(paint_objects, paint_data);
+}
+
 flutter::PaintData DartConverter<flutter::PaintData>::FromArguments(
     Dart_NativeArguments args,
     int index,
@@ -5,11 +5,21 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_PAINT_H_
 #define FLUTTER_LIB_UI_PAINTING_PAINT_H_
 
+#include <vector>
+
 #include "third_party/skia/include/core/SkPaint.h"
 #include "third_party/tonic/converter/dart_converter.h"
 
 namespace flutter {
 
+// The size of the data of an encoded paint. Must be kept in sync with
+// painting.dart.
+constexpr size_t kPaintDataByteCount = 56;
+
+// Applies the data of an encoded paint, which is |kPaintDataByteCount| bytes
+// long, to |paint|. Its objects must have been applied already.
+void DecodePaintData(const void* data, SkPaint* paint);
+
 class Paint {
  public:
   Paint() = default;
@@ -30,6 +40,20 @@ class Paint {
 // data for a Paint object).
 class PaintData {};
 
+// The paints used by a batch of operations that a Canvas recorded. They are
+// encoded like Paint, with the objects of all the paints in one list and
+// their data in one byte data.
+class PaintBatch {
+ public:
+  PaintBatch() = default;
+  PaintBatch(Dart_Handle paint_objects, Dart_Handle paint_data);
+
+  const std::vector<SkPaint>& paints() const { return paints_; }
+
+ private:
+  std::vector<SkPaint> paints_;
+};
+
 }  // namespace flutter
 
 namespace tonic {
@@ -41,6 +65,13 @@ struct DartConverter<flutter::Paint> {
                                       Dart_Handle& exception);
 };
 
+template <>
+struct DartConverter<flutter::PaintBatch> {
+  static flutter::PaintBatch FromArguments(Dart_NativeArguments args,
+                                           int index,
+                                           Dart_Handle& exception);
+};
+
 template <>
 struct DartConverter<flutter::PaintData> {
   static flutter::PaintData FromArguments(Dart_NativeArguments args,
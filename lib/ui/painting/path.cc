@@ -17,6 +17,10 @@ using tonic::ToDart;
 
 namespace flutter {
 
+// How many points are tested against an unchanged path before its contours
+// are indexed.
+static constexpr size_t kContainsPointsBeforeIndexing = 256;
+
 typedef CanvasPath Path;
 
 static void Path_constructor(Dart_NativeArguments args) {
@@ -37,6 +41,7 @@ IMPLEMENT_WRAPPERTYPEINFO(ui, Path);
   V(Path, close)                     \
   V(Path, conicTo)                   \
   V(Path, contains)                  \
+  V(Path, containsPoints)            \
   V(Path, cubicTo)                   \
   V(Path, extendWithPath)            \
   V(Path, extendWithPathAndMatrix)   \
@@ -76,6 +81,8 @@ int CanvasPath::getFillType() {
 
 void CanvasPath::setFillType(int fill_type) {
   path_.setFillType(static_cast<SkPathFillType>(fill_type));
+  // The fill type is not part of the generation ID of the path.
+  contains_generation_id_ = 0;
 }
 
 void CanvasPath::moveTo(float x, float y) {
@@ -259,9 +266,43 @@ void CanvasPath::reset() {
 }
 
 bool CanvasPath::contains(double x, double y) {
+  UpdateContainsIndex(1);
+  if (contains_index_) {
+    return contains_index_->Contains(x, y);
+  }
   return path_.contains(x, y);
 }
 
+tonic::Uint8List CanvasPath::containsPoints(const tonic::Float32List& points) {
+  const size_t point_count = points.num_elements() / 2;
+  const SkPoint* point_data = reinterpret_cast<const SkPoint*>(points.data());
+  tonic::Uint8List result(
+      Dart_NewTypedData(Dart_TypedData_kUint8, point_count));
+  UpdateContainsIndex(point_count);
+  for (size_t i = 0; i < point_count; i++) {
+    const SkPoint& point = point_data[i];
+    result[i] = contains_index_
+                    ? contains_index_->Contains(point.x(), point.y())
+                    : path_.contains(point.x(), point.y());
+  }
+  return result;
+}
+
+void CanvasPath::UpdateContainsIndex(size_t point_count) {
+  const uint32_t generation_id = path_.getGenerationID();
+  if (generation_id != contains_generation_id_) {
+    contains_generation_id_ = generation_id;
+    contains_point_count_ = 0;
+    contains_index_.reset();
+  }
+  const size_t previous_point_count = contains_point_count_;
+  contains_point_count_ += point_count;
+  if (previous_point_count < kContainsPointsBeforeIndexing &&
+      contains_point_count_ >= kContainsPointsBeforeIndexing) {
+    contains_index_ = PathContainsIndex::Make(path_);
+  }
+}
+
 fml::RefPtr<CanvasPath> CanvasPath::shift(double dx, double dy) {
   fml::RefPtr<CanvasPath> path = CanvasPath::Create();
   path_.offset(dx, dy, &path->path_);
@@ -5,7 +5,10 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_PATH_H_
 #define FLUTTER_LIB_UI_PAINTING_PATH_H_
 
+#include <memory>
+
 #include "flutter/lib/ui/dart_wrapper.h"
+#include "flutter/lib/ui/painting/path_contains_index.h"
 #include "flutter/lib/ui/painting/rrect.h"
 #include "third_party/skia/include/core/SkPath.h"
 #include "third_party/skia/include/pathops/SkPathOps.h"
@@ -95,6 +98,7 @@ class CanvasPath : public RefCountedDartWrappable<CanvasPath> {
   void close();
   void reset();
   bool contains(double x, double y);
+  tonic::Uint8List containsPoints(const tonic::Float32List& points);
   fml::RefPtr<CanvasPath> shift(double dx, double dy);
   fml::RefPtr<CanvasPath> transform(tonic::Float64List& matrix4);
   tonic::Float32List getBounds();
@@ -109,6 +113,14 @@ class CanvasPath : public RefCountedDartWrappable<CanvasPath> {
   CanvasPath();
 
   SkPath path_;
+
+  // Hit testing the same path many times indexes its contours. The index is
+  // dropped once the path changes.
+  uint32_t contains_generation_id_ = 0;
+  size_t contains_point_count_ = 0;
+  std::unique_ptr<PathContainsIndex> contains_index_;
+
+  void UpdateContainsIndex(size_t point_count);
 };
 
 }  // namespace flutter
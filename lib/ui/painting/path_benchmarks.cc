@@ -0,0 +1,100 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/lib/ui/painting/path_contains_index.h"
+
+namespace flutter {
+
+// The number of points hit tested in each iteration, about what dragging
+// over a map tests in a frame.
+static constexpr int kPointCount = 1000;
+
+// A map of |block_count| blocks, each an irregular polygon of eight points,
+// laid out on a square grid.
+static SkPath MakeMap(int64_t block_count) {
+  SkPath path;
+  int columns = 1;
+  while (columns * columns < block_count) {
+    columns++;
+  }
+  for (int64_t i = 0; i < block_count; i++) {
+    const SkScalar x = (i % columns) * 20;
+    const SkScalar y = (i / columns) * 20;
+    path.moveTo(x + 2, y + 1);
+    path.lineTo(x + 9, y + 3);
+    path.lineTo(x + 17, y + 2);
+    path.lineTo(x + 18, y + 10);
+    path.lineTo(x + 16, y + 18);
+    path.lineTo(x + 8, y + 17);
+    path.lineTo(x + 1, y + 16);
+    path.lineTo(x + 3, y + 8);
+    path.close();
+  }
+  return path;
+}
+
+// Points spread over |bounds|, the same ones every run.
+static std::vector<SkPoint> MakePoints(const SkRect& bounds) {
+  std::vector<SkPoint> points;
+  uint32_t seed = 1;
+  auto next_fraction = [&seed]() {
+    seed = seed * 1664525 + 1013904223;
+    return static_cast<SkScalar>((seed >> 16) % 1000) / 1000;
+  };
+  for (int i = 0; i < kPointCount; i++) {
+    const SkScalar x = bounds.fLeft + next_fraction() * bounds.width();
+    const SkScalar y = bounds.fTop + next_fraction() * bounds.height();
+    points.push_back(SkPoint::Make(x, y));
+  }
+  return points;
+}
+
+// What every call to Path.contains does: walk all the contours of the path.
+static void BM_PathContains(benchmark::State& state) {
+  const SkPath path = MakeMap(state.range(0));
+  const std::vector<SkPoint> points = MakePoints(path.getBounds());
+  while (state.KeepRunning()) {
+    int contained = 0;
+    for (const SkPoint& point : points) {
+      contained += path.contains(point.x(), point.y());
+    }
+    benchmark::DoNotOptimize(contained);
+  }
+  state.SetItemsProcessed(state.iterations() * kPointCount);
+}
+BENCHMARK(BM_PathContains)->Arg(100)->Arg(1000)->Arg(10000);
+
+// What Path.containsPoints does once the path is indexed.
+static void BM_PathContainsIndexed(benchmark::State& state) {
+  const SkPath path = MakeMap(state.range(0));
+  const std::vector<SkPoint> points = MakePoints(path.getBounds());
+  const auto index = PathContainsIndex::Make(path);
+  while (state.KeepRunning()) {
+    int contained = 0;
+    for (const SkPoint& point : points) {
+      contained += index->Contains(point.x(), point.y());
+    }
+    benchmark::DoNotOptimize(contained);
+  }
+  state.SetItemsProcessed(state.iterations() * kPointCount);
+}
+BENCHMARK(BM_PathContainsIndexed)->Arg(100)->Arg(1000)->Arg(10000);
+
+// What indexing a path costs, which is paid once until the path changes.
+static void BM_PathContainsIndexMake(benchmark::State& state) {
+  const SkPath path = MakeMap(state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(PathContainsIndex::Make(path));
+  }
+}
+BENCHMARK(BM_PathContainsIndexMake)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace flutter
@@ -0,0 +1,134 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/path_contains_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+// Below this many contours, walking them all is about as fast as finding the
+// cell of a point.
+static constexpr size_t kMinContourCount = 16;
+
+static constexpr int kMaxGridSize = 64;
+
+// How many times over the cells may copy the points of the path. Contours
+// that span many cells are copied into each of them.
+static constexpr int kMaxPointCopies = 8;
+
+static std::vector<SkPath> SplitContours(const SkPath& path) {
+  std::vector<SkPath> contours;
+  SkPath::RawIter iter(path);
+  SkPoint points[4];
+  SkPath::Verb verb;
+  while ((verb = iter.next(points)) != SkPath::kDone_Verb) {
+    if (verb == SkPath::kMove_Verb || contours.empty()) {
+      contours.emplace_back();
+    }
+    SkPath& contour = contours.back();
+    switch (verb) {
+      case SkPath::kMove_Verb:
+        contour.moveTo(points[0]);
+        break;
+      case SkPath::kLine_Verb:
+        contour.lineTo(points[1]);
+        break;
+      case SkPath::kQuad_Verb:
+        contour.quadTo(points[1], points[2]);
+        break;
+      case SkPath::kConic_Verb:
+        contour.conicTo(points[1], points[2], iter.conicWeight());
+        break;
+      case SkPath::kCubic_Verb:
+        contour.cubicTo(points[1], points[2], points[3]);
+        break;
+      case SkPath::kClose_Verb:
+        contour.close();
+        break;
+      case SkPath::kDone_Verb:
+        break;
+    }
+  }
+  return contours;
+}
+
+std::unique_ptr<PathContainsIndex> PathContainsIndex::Make(
+    const SkPath& path) {
+  TRACE_EVENT0("flutter", "PathContainsIndex::Make");
+  std::vector<SkPath> contours = SplitContours(path);
+  if (contours.size() < kMinContourCount) {
+    return nullptr;
+  }
+
+  const int size = std::min(
+      kMaxGridSize, static_cast<int>(std::ceil(std::sqrt(contours.size()))));
+  std::unique_ptr<PathContainsIndex> index(
+      new PathContainsIndex(path, size, size));
+
+  int point_copies = 0;
+  const int max_point_copies = path.countPoints() * kMaxPointCopies;
+  for (const SkPath& contour : contours) {
+    const SkRect& bounds = contour.getBounds();
+    const int first_column = index->GetColumn(bounds.fLeft);
+    const int last_column = index->GetColumn(bounds.fRight);
+    const int first_row = index->GetRow(bounds.fTop);
+    const int last_row = index->GetRow(bounds.fBottom);
+    point_copies += contour.countPoints() * (last_column - first_column + 1) *
+                    (last_row - first_row + 1);
+    if (point_copies > max_point_copies) {
+      return nullptr;
+    }
+    for (int row = first_row; row <= last_row; ++row) {
+      for (int column = first_column; column <= last_column; ++column) {
+        index->cells_[row * index->columns_ + column].addPath(contour);
+      }
+    }
+  }
+  return index;
+}
+
+PathContainsIndex::PathContainsIndex(const SkPath& path, int columns, int rows)
+    : bounds_(path.getBounds()),
+      is_inverse_(path.isInverseFillType()),
+      columns_(columns),
+      rows_(rows),
+      column_scale_(bounds_.width() > 0 ? columns / bounds_.width() : 0),
+      row_scale_(bounds_.height() > 0 ? rows / bounds_.height() : 0),
+      cells_(columns * rows) {
+  for (SkPath& cell : cells_) {
+    cell.setFillType(path.getFillType());
+  }
+}
+
+PathContainsIndex::~PathContainsIndex() = default;
+
+bool PathContainsIndex::Contains(SkScalar x, SkScalar y) const {
+  // Written so that NaNs are outside, as they are for |SkPath::contains|.
+  if (!(x >= bounds_.fLeft && x <= bounds_.fRight && y >= bounds_.fTop &&
+        y <= bounds_.fBottom)) {
+    return is_inverse_;
+  }
+  return cells_[GetRow(y) * columns_ + GetColumn(x)].contains(x, y);
+}
+
+int PathContainsIndex::GetCellCount() const {
+  return static_cast<int>(cells_.size());
+}
+
+// Points and the bounds of contours are mapped to cells the same way, so a
+// point on the edge of the bounds of a contour lands in a cell that holds it.
+int PathContainsIndex::GetColumn(SkScalar x) const {
+  return std::min(columns_ - 1,
+                  static_cast<int>((x - bounds_.fLeft) * column_scale_));
+}
+
+int PathContainsIndex::GetRow(SkScalar y) const {
+  return std::min(rows_ - 1, static_cast<int>((y - bounds_.fTop) * row_scale_));
+}
+
+}  // namespace flutter
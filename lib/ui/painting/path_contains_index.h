@@ -0,0 +1,71 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_PATH_CONTAINS_INDEX_H_
+#define FLUTTER_LIB_UI_PAINTING_PATH_CONTAINS_INDEX_H_
+
+#include <memory>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkPath.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      A grid over the bounds of a path with many contours, where each
+///             cell holds only the contours whose bounds touch it.
+///
+///             `SkPath::contains` walks every contour of the path, which for
+///             a map of thousands of shapes is thousands of contours for
+///             every point. A contour adds nothing to the winding of a point
+///             outside its bounds, so testing a point against the contours of
+///             its cell gives the same answer as testing it against the whole
+///             path.
+///
+///             The index is a snapshot of the path and has to be made again
+///             once the path changes.
+///
+class PathContainsIndex {
+ public:
+  //----------------------------------------------------------------------------
+  /// @brief      Indexes the contours of |path|.
+  ///
+  /// @return     The index, or nullptr if |path| has too few contours for the
+  ///             index to be faster, or if its contours overlap so much that
+  ///             the index would take too much memory.
+  ///
+  static std::unique_ptr<PathContainsIndex> Make(const SkPath& path);
+
+  ~PathContainsIndex();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Whether the point is in the path the index was made from, as
+  ///             `SkPath::contains` answers it.
+  ///
+  bool Contains(SkScalar x, SkScalar y) const;
+
+  int GetCellCount() const;
+
+ private:
+  const SkRect bounds_;
+  const bool is_inverse_;
+  const int columns_;
+  const int rows_;
+  const SkScalar column_scale_;
+  const SkScalar row_scale_;
+  std::vector<SkPath> cells_;
+
+  PathContainsIndex(const SkPath& path, int columns, int rows);
+
+  int GetColumn(SkScalar x) const;
+
+  int GetRow(SkScalar y) const;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PathContainsIndex);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_PATH_CONTAINS_INDEX_H_
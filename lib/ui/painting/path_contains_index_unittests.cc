@@ -0,0 +1,94 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/path_contains_index.h"
+
+#include <cmath>
+
+#include "flutter/testing/testing.h"
+
+namespace flutter {
+namespace testing {
+
+// A grid of shapes of every kind of verb, some of them open.
+static SkPath MakeShapes(int count) {
+  SkPath path;
+  for (int i = 0; i < count; ++i) {
+    const SkScalar x = (i % 10) * 30;
+    const SkScalar y = (i / 10) * 30;
+    switch (i % 4) {
+      case 0:
+        path.addRect(SkRect::MakeXYWH(x, y, 20, 20));
+        break;
+      case 1:
+        path.addOval(SkRect::MakeXYWH(x, y, 25, 15));
+        break;
+      case 2:
+        path.moveTo(x, y);
+        path.quadTo(x + 25, y, x + 20, y + 20);
+        path.cubicTo(x + 10, y + 25, x, y + 10, x + 5, y + 5);
+        break;
+      case 3:
+        path.moveTo(x, y + 20);
+        path.conicTo(x + 10, y, x + 20, y + 20, 0.5f);
+        path.close();
+        break;
+    }
+  }
+  return path;
+}
+
+static void ExpectSameAsPath(const SkPath& path,
+                             const PathContainsIndex& index) {
+  const SkRect bounds = path.getBounds().makeOutset(10, 10);
+  for (SkScalar y = bounds.fTop; y <= bounds.fBottom; y += 2.5f) {
+    for (SkScalar x = bounds.fLeft; x <= bounds.fRight; x += 2.5f) {
+      ASSERT_EQ(index.Contains(x, y), path.contains(x, y))
+          << "x: " << x << " y: " << y;
+    }
+  }
+  // Points on the edges of the bounds of the path and of its contours.
+  const SkRect& path_bounds = path.getBounds();
+  ASSERT_EQ(index.Contains(path_bounds.fRight, path_bounds.fBottom),
+            path.contains(path_bounds.fRight, path_bounds.fBottom));
+  ASSERT_EQ(index.Contains(30, 30), path.contains(30, 30));
+  ASSERT_EQ(index.Contains(50, 50), path.contains(50, 50));
+}
+
+TEST(PathContainsIndexTest, AnswersAsThePathDoes) {
+  SkPath path = MakeShapes(100);
+  for (SkPathFillType fill_type :
+       {SkPathFillType::kWinding, SkPathFillType::kEvenOdd,
+        SkPathFillType::kInverseWinding, SkPathFillType::kInverseEvenOdd}) {
+    path.setFillType(fill_type);
+    auto index = PathContainsIndex::Make(path);
+    ASSERT_NE(index, nullptr);
+    ASSERT_EQ(index->GetCellCount(), 100);
+    ExpectSameAsPath(path, *index);
+  }
+}
+
+TEST(PathContainsIndexTest, NaNsAreOutside) {
+  auto index = PathContainsIndex::Make(MakeShapes(100));
+  ASSERT_NE(index, nullptr);
+  ASSERT_FALSE(index->Contains(NAN, 10));
+  ASSERT_FALSE(index->Contains(10, NAN));
+}
+
+TEST(PathContainsIndexTest, SmallPathsAreNotIndexed) {
+  ASSERT_EQ(PathContainsIndex::Make(SkPath()), nullptr);
+  ASSERT_EQ(PathContainsIndex::Make(MakeShapes(4)), nullptr);
+}
+
+TEST(PathContainsIndexTest, ContoursSpanningTheGridAreNotCopiedTooOften) {
+  // Every contour of this path covers the whole grid.
+  SkPath path;
+  for (int i = 0; i < 100; ++i) {
+    path.addRect(SkRect::MakeXYWH(i, i, 1000, 1000));
+  }
+  ASSERT_EQ(PathContainsIndex::Make(path), nullptr);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -7,6 +7,8 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 
+#include <algorithm>
+
 #include "flutter/lib/ui/painting/matrix.h"
 #include "third_party/tonic/converter/dart_converter.h"
 #include "third_party/tonic/dart_args.h"
@@ -29,6 +31,7 @@ IMPLEMENT_WRAPPERTYPEINFO(ui, PathMeasure);
   V(PathMeasure, setPath)    \
   V(PathMeasure, getLength)  \
   V(PathMeasure, getPosTan)  \
+  V(PathMeasure, getPosTans) \
   V(PathMeasure, getSegment) \
   V(PathMeasure, isClosed)   \
   V(PathMeasure, nextContour)
@@ -97,6 +100,39 @@ tonic::Float32List CanvasPathMeasure::getPosTan(int contourIndex,
   return posTan;
 }
 
+tonic::Float32List CanvasPathMeasure::getPosTans(
+    int contourIndex,
+    const tonic::Float32List& distances) {
+  const size_t count = distances.num_elements();
+  tonic::Float32List posTans(
+      Dart_NewTypedData(Dart_TypedData_kFloat32, count * 4));
+  const SkContourMeasure* measure = nullptr;
+  if (static_cast<std::vector<sk_sp<SkContourMeasure>>::size_type>(
+          contourIndex) < measures_.size()) {
+    measure = measures_[contourIndex].get();
+  }
+
+  // The contour measure keeps the lengths of its segments, so each distance
+  // is a binary search over them.
+  const float* distance_data = distances.data();
+  for (size_t i = 0; i < count; i++) {
+    SkPoint pos;
+    SkVector tan;
+    float* posTan = &posTans[i * 4];
+    if (measure && measure->getPosTan(distance_data[i], &pos, &tan)) {
+      posTan[0] = pos.x();
+      posTan[1] = pos.y();
+      posTan[2] = tan.x();
+      posTan[3] = tan.y();
+    } else {
+      // dart code will check for this for failure
+      std::fill(posTan, posTan + 4, NAN);
+    }
+  }
+
+  return posTans;
+}
+
 fml::RefPtr<CanvasPath> CanvasPathMeasure::getSegment(int contourIndex,
                                                       float startD,
                                                       float stopD,
@@ -34,6 +34,8 @@ class CanvasPathMeasure : public RefCountedDartWrappable<CanvasPathMeasure> {
   void setPath(const CanvasPath* path, bool isClosed);
   float getLength(int contourIndex);
   tonic::Float32List getPosTan(int contourIndex, float distance);
+  tonic::Float32List getPosTans(int contourIndex,
+                                const tonic::Float32List& distances);
   fml::RefPtr<CanvasPath> getSegment(int contourIndex,
                                      float startD,
                                      float stopD,
@@ -37,7 +37,13 @@ fml::RefPtr<PictureRecorder> PictureRecorder::Create() {
 
 PictureRecorder::PictureRecorder() {}
 
-PictureRecorder::~PictureRecorder() {}
+PictureRecorder::~PictureRecorder() {
+  // The canvas may outlive an abandoned recording, but the SkCanvas it draws
+  // into is owned by |picture_recorder_|.
+  if (canvas_) {
+    canvas_->Clear();
+  }
+}
 
 bool PictureRecorder::isRecording() {
   return canvas_ && canvas_->IsRecording();
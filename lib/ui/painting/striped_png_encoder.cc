@@ -0,0 +1,290 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/striped_png_encoder.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/zlib/zlib.h"
+
+namespace flutter {
+namespace {
+
+constexpr size_t kBytesPerPixel = 4;
+
+// How far back deflate can refer, and so how much of the rows above a stripe
+// can help compress it.
+constexpr size_t kWindowSize = 32 * 1024;
+
+constexpr uint8_t kSignature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+// The filters PNG applies to each row before compressing it.
+enum class Filter : uint8_t {
+  kNone = 0,
+  kSub = 1,
+  kUp = 2,
+  kAverage = 3,
+  kPaeth = 4,
+};
+
+void AppendUint32(std::vector<uint8_t>* bytes, uint32_t value) {
+  bytes->push_back(static_cast<uint8_t>(value >> 24));
+  bytes->push_back(static_cast<uint8_t>(value >> 16));
+  bytes->push_back(static_cast<uint8_t>(value >> 8));
+  bytes->push_back(static_cast<uint8_t>(value));
+}
+
+void WriteUint32(uint8_t* bytes, uint32_t value) {
+  bytes[0] = static_cast<uint8_t>(value >> 24);
+  bytes[1] = static_cast<uint8_t>(value >> 16);
+  bytes[2] = static_cast<uint8_t>(value >> 8);
+  bytes[3] = static_cast<uint8_t>(value);
+}
+
+// Appends the checksum of the chunk that starts at |chunk_start|, which must
+// be followed by its length, type and data.
+void FinishChunk(std::vector<uint8_t>* bytes, size_t chunk_start) {
+  const size_t type_start = chunk_start + 4;
+  WriteUint32(&(*bytes)[chunk_start], bytes->size() - type_start - 4);
+  AppendUint32(bytes, crc32(crc32(0, nullptr, 0), &(*bytes)[type_start],
+                            bytes->size() - type_start));
+}
+
+void AppendChunk(std::vector<uint8_t>* bytes,
+                 const char type[4],
+                 const uint8_t* data,
+                 size_t length) {
+  const size_t chunk_start = bytes->size();
+  AppendUint32(bytes, 0);
+  bytes->insert(bytes->end(), type, type + 4);
+  bytes->insert(bytes->end(), data, data + length);
+  FinishChunk(bytes, chunk_start);
+}
+
+uint8_t PaethPredictor(int left, int up, int up_left) {
+  const int estimate = left + up - up_left;
+  const int left_distance = std::abs(estimate - left);
+  const int up_distance = std::abs(estimate - up);
+  const int up_left_distance = std::abs(estimate - up_left);
+  if (left_distance <= up_distance && left_distance <= up_left_distance) {
+    return left;
+  }
+  return up_distance <= up_left_distance ? up : up_left;
+}
+
+// Filters |row| into |filtered|, prefixed with the filter type. Returns the
+// sum of the filtered bytes as signed values, which is the usual estimate of
+// how well a filter will compress: the smaller, the better.
+uint32_t FilterRow(Filter filter,
+                   const uint8_t* row,
+                   const uint8_t* previous_row,
+                   size_t row_bytes,
+                   uint8_t* filtered) {
+  filtered[0] = static_cast<uint8_t>(filter);
+  uint8_t* out = filtered + 1;
+  uint32_t cost = 0;
+  for (size_t i = 0; i < row_bytes; ++i) {
+    const int left = i >= kBytesPerPixel ? row[i - kBytesPerPixel] : 0;
+    const int up = previous_row[i];
+    const int up_left =
+        i >= kBytesPerPixel ? previous_row[i - kBytesPerPixel] : 0;
+    uint8_t prediction = 0;
+    switch (filter) {
+      case Filter::kNone:
+        break;
+      case Filter::kSub:
+        prediction = left;
+        break;
+      case Filter::kUp:
+        prediction = up;
+        break;
+      case Filter::kAverage:
+        prediction = (left + up) / 2;
+        break;
+      case Filter::kPaeth:
+        prediction = PaethPredictor(left, up, up_left);
+        break;
+    }
+    out[i] = row[i] - prediction;
+    cost += std::abs(static_cast<int8_t>(out[i]));
+  }
+  return cost;
+}
+
+}  // namespace
+
+StripedPNGEncoder::StripedPNGEncoder(int width,
+                                     int height,
+                                     int stripe_height,
+                                     int compression_level)
+    : width_(width),
+      height_(height),
+      stripe_height_(std::max(stripe_height, 1)),
+      compression_level_(std::clamp(compression_level, 1, 9)),
+      stripe_checksums_(GetStripeCount()),
+      stripe_lengths_(GetStripeCount()) {
+  FML_DCHECK(width_ > 0 && height_ > 0);
+}
+
+StripedPNGEncoder::~StripedPNGEncoder() = default;
+
+int StripedPNGEncoder::GetStripeCount() const {
+  return (height_ + stripe_height_ - 1) / stripe_height_;
+}
+
+bool StripedPNGEncoder::EncodeStripe(int stripe,
+                                     const RowReader& row_reader,
+                                     std::vector<uint8_t>* encoded) {
+  TRACE_EVENT0("flutter", "StripedPNGEncoder::EncodeStripe");
+  FML_DCHECK(stripe >= 0 && stripe < GetStripeCount());
+
+  const size_t row_bytes = width_ * kBytesPerPixel;
+  const size_t filtered_row_bytes = row_bytes + 1;
+  const int first_row = stripe * stripe_height_;
+  const int end_row = std::min(first_row + stripe_height_, height_);
+  // The rows above the stripe that fill the window of its compressor. They
+  // are filtered again here exactly as the stripe above filtered them.
+  const int window_rows = std::min<int>(
+      first_row, (kWindowSize + filtered_row_bytes - 1) / filtered_row_bytes);
+  const int filtered_first_row = first_row - window_rows;
+  // Filters look at the row above the one being filtered.
+  const int read_first_row = std::max(filtered_first_row - 1, 0);
+
+  std::vector<uint8_t> rows((end_row - read_first_row) * row_bytes);
+  if (!row_reader(read_first_row, end_row - read_first_row, rows.data())) {
+    FML_LOG(ERROR) << "Could not read the rows of a PNG stripe.";
+    return false;
+  }
+
+  // The fastest level only uses the cheapest filter that still predicts from
+  // the neighboring pixel. Other levels pick the best filter for each row.
+  const bool adaptive_filtering = compression_level_ > 1;
+  std::vector<uint8_t> filtered((end_row - filtered_first_row) *
+                                filtered_row_bytes);
+  std::vector<uint8_t> candidate(adaptive_filtering ? filtered_row_bytes : 0);
+  const std::vector<uint8_t> zero_row(filtered_first_row == 0 ? row_bytes : 0);
+  for (int row = filtered_first_row; row < end_row; ++row) {
+    const uint8_t* pixels = &rows[(row - read_first_row) * row_bytes];
+    const uint8_t* previous_row =
+        row == 0 ? zero_row.data() : pixels - row_bytes;
+    uint8_t* out = &filtered[(row - filtered_first_row) * filtered_row_bytes];
+    if (!adaptive_filtering) {
+      FilterRow(Filter::kSub, pixels, previous_row, row_bytes, out);
+      continue;
+    }
+    uint32_t best_cost =
+        FilterRow(Filter::kNone, pixels, previous_row, row_bytes, out);
+    for (Filter filter : {Filter::kSub, Filter::kUp, Filter::kAverage,
+                          Filter::kPaeth}) {
+      uint32_t cost = FilterRow(filter, pixels, previous_row, row_bytes,
+                                candidate.data());
+      if (cost < best_cost) {
+        best_cost = cost;
+        std::copy(candidate.begin(), candidate.end(), out);
+      }
+    }
+  }
+
+  const size_t window_bytes = window_rows * filtered_row_bytes;
+  const uint8_t* stripe_data = filtered.data() + window_bytes;
+  const size_t stripe_length = filtered.size() - window_bytes;
+  stripe_checksums_[stripe] =
+      adler32(adler32(0, nullptr, 0), stripe_data, stripe_length);
+  stripe_lengths_[stripe] = stripe_length;
+
+  encoded->clear();
+  if (stripe == 0) {
+    encoded->insert(encoded->end(), std::begin(kSignature),
+                    std::end(kSignature));
+    std::vector<uint8_t> header;
+    AppendUint32(&header, width_);
+    AppendUint32(&header, height_);
+    header.push_back(8);  // Bits per channel.
+    header.push_back(6);  // RGBA.
+    header.push_back(0);  // Deflate compression.
+    header.push_back(0);  // Adaptive filtering.
+    header.push_back(0);  // No interlacing.
+    AppendChunk(encoded, "IHDR", header.data(), header.size());
+  }
+
+  const size_t chunk_start = encoded->size();
+  AppendUint32(encoded, 0);
+  encoded->insert(encoded->end(), {'I', 'D', 'A', 'T'});
+
+  // Every stripe is raw deflate data, so the first stripe starts the zlib
+  // stream with its header, and the trailer ends it with the checksum.
+  if (stripe == 0) {
+    const uint8_t level_bits = compression_level_ < 2   ? 0
+                               : compression_level_ < 6 ? 1
+                               : compression_level_ < 7 ? 2
+                                                        : 3;
+    const uint8_t method = 0x78;  // Deflate with a 32K window.
+    uint8_t flags = level_bits << 6;
+    flags += 31 - ((method << 8) + flags) % 31;
+    encoded->push_back(method);
+    encoded->push_back(flags);
+  }
+
+  z_stream stream = {};
+  if (deflateInit2(&stream, compression_level_, Z_DEFLATED, -MAX_WBITS, 8,
+                   Z_FILTERED) != Z_OK) {
+    FML_LOG(ERROR) << "Could not initialize the compressor of a PNG stripe.";
+    return false;
+  }
+  if (window_bytes > 0) {
+    const size_t dictionary_length = std::min(window_bytes, kWindowSize);
+    deflateSetDictionary(&stream, stripe_data - dictionary_length,
+                         dictionary_length);
+  }
+
+  // Stripes other than the last end on a byte boundary without ending the
+  // stream, so that the next stripe carries on from there.
+  const bool last_stripe = stripe == GetStripeCount() - 1;
+  const int flush = last_stripe ? Z_FINISH : Z_SYNC_FLUSH;
+  stream.next_in = const_cast<uint8_t*>(stripe_data);
+  stream.avail_in = stripe_length;
+  size_t written = encoded->size();
+  encoded->resize(written + deflateBound(&stream, stripe_length) + 16);
+  while (true) {
+    if (written == encoded->size()) {
+      encoded->resize(written + kWindowSize);
+    }
+    stream.next_out = encoded->data() + written;
+    stream.avail_out = encoded->size() - written;
+    const int result = deflate(&stream, flush);
+    written = encoded->size() - stream.avail_out;
+    if (result == Z_STREAM_END || (!last_stripe && stream.avail_out > 0)) {
+      break;
+    }
+    if (result != Z_OK && result != Z_BUF_ERROR) {
+      FML_LOG(ERROR) << "Could not compress a PNG stripe.";
+      deflateEnd(&stream);
+      return false;
+    }
+  }
+  deflateEnd(&stream);
+  encoded->resize(written);
+  FinishChunk(encoded, chunk_start);
+  return true;
+}
+
+std::vector<uint8_t> StripedPNGEncoder::EncodeTrailer() const {
+  uint32_t checksum = stripe_checksums_[0];
+  for (size_t i = 1; i < stripe_checksums_.size(); ++i) {
+    checksum = adler32_combine(checksum, stripe_checksums_[i],
+                               stripe_lengths_[i]);
+  }
+  uint8_t checksum_bytes[4];
+  WriteUint32(checksum_bytes, checksum);
+
+  std::vector<uint8_t> trailer;
+  AppendChunk(&trailer, "IDAT", checksum_bytes, sizeof(checksum_bytes));
+  AppendChunk(&trailer, "IEND", nullptr, 0);
+  return trailer;
+}
+
+}  // namespace flutter
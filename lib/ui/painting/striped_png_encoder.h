@@ -0,0 +1,88 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_STRIPED_PNG_ENCODER_H_
+#define FLUTTER_LIB_UI_PAINTING_STRIPED_PNG_ENCODER_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      Encodes RGBA images into PNGs in horizontal stripes that can be
+///             compressed independently of each other, and so concurrently.
+///
+///             Each stripe is compressed into its own IDAT chunk, ending on a
+///             byte boundary so that the chunks join into the single zlib
+///             stream PNG decoders expect. The rows just above a stripe
+///             prime its compressor, so that striping costs little in size.
+///             Concatenating the encoded stripes in order, followed by the
+///             trailer, gives the PNG.
+///
+class StripedPNGEncoder {
+ public:
+  //----------------------------------------------------------------------------
+  /// @brief      Reads |row_count| rows of the image, starting at
+  ///             |first_row|, into |rows| as tightly packed unpremultiplied
+  ///             RGBA8888 pixels. Returns false if the rows could not be read.
+  ///
+  using RowReader =
+      std::function<bool(int first_row, int row_count, uint8_t* rows)>;
+
+  //----------------------------------------------------------------------------
+  /// @param[in]  width              The width of the image in pixels.
+  /// @param[in]  height             The height of the image in pixels.
+  /// @param[in]  stripe_height      The number of rows in each stripe. The
+  ///                                last stripe may have fewer.
+  /// @param[in]  compression_level  The zlib compression level, from 1 for
+  ///                                the fastest to 9 for the smallest output.
+  ///
+  StripedPNGEncoder(int width,
+                    int height,
+                    int stripe_height,
+                    int compression_level);
+
+  ~StripedPNGEncoder();
+
+  int GetStripeCount() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Encodes one stripe of the image into |encoded|. The first
+  ///             stripe also carries the PNG signature and header.
+  ///
+  ///             Different stripes may be encoded concurrently, but each
+  ///             stripe must be encoded exactly once.
+  ///
+  /// @return     Returns false if the rows could not be read or compressed.
+  ///
+  bool EncodeStripe(int stripe,
+                    const RowReader& row_reader,
+                    std::vector<uint8_t>* encoded);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Returns the bytes that end the PNG. Every stripe must have
+  ///             been encoded successfully first.
+  ///
+  std::vector<uint8_t> EncodeTrailer() const;
+
+ private:
+  const int width_;
+  const int height_;
+  const int stripe_height_;
+  const int compression_level_;
+  // The checksum and length of the filtered rows of each stripe, which are
+  // combined into the checksum of the whole zlib stream.
+  std::vector<uint32_t> stripe_checksums_;
+  std::vector<size_t> stripe_lengths_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(StripedPNGEncoder);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_STRIPED_PNG_ENCODER_H_
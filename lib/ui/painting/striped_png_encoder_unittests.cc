@@ -0,0 +1,118 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/striped_png_encoder.h"
+
+#include <cstring>
+
+#include "flutter/testing/testing.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
+
+namespace flutter {
+namespace testing {
+
+static constexpr int kWidth = 67;
+static constexpr int kHeight = 153;
+
+// Unpremultiplied RGBA pixels with some structure for the filters to find,
+// and some noise that they cannot predict.
+static std::vector<uint8_t> MakePixels() {
+  std::vector<uint8_t> pixels(kWidth * kHeight * 4);
+  uint32_t noise = 1;
+  for (size_t i = 0; i < pixels.size(); ++i) {
+    noise = noise * 1103515245 + 12345;
+    const size_t x = (i / 4) % kWidth;
+    const size_t y = (i / 4) / kWidth;
+    pixels[i] = static_cast<uint8_t>(x * 3 + y * (i % 4) + (noise >> 28));
+  }
+  return pixels;
+}
+
+// Encodes |pixels| with stripes taken in the order of |stripe_order|, which
+// defaults to top to bottom.
+static std::vector<uint8_t> Encode(const std::vector<uint8_t>& pixels,
+                                   int stripe_height,
+                                   int compression_level,
+                                   std::vector<int> stripe_order = {}) {
+  StripedPNGEncoder encoder(kWidth, kHeight, stripe_height, compression_level);
+  StripedPNGEncoder::RowReader row_reader = [&](int first_row, int row_count,
+                                                uint8_t* rows) {
+    std::memcpy(rows, &pixels[first_row * kWidth * 4],
+                row_count * kWidth * 4);
+    return true;
+  };
+  if (stripe_order.empty()) {
+    for (int stripe = 0; stripe < encoder.GetStripeCount(); ++stripe) {
+      stripe_order.push_back(stripe);
+    }
+  }
+  std::vector<std::vector<uint8_t>> stripes(encoder.GetStripeCount());
+  for (int stripe : stripe_order) {
+    EXPECT_TRUE(encoder.EncodeStripe(stripe, row_reader, &stripes[stripe]));
+  }
+  std::vector<uint8_t> png;
+  for (const auto& stripe : stripes) {
+    png.insert(png.end(), stripe.begin(), stripe.end());
+  }
+  std::vector<uint8_t> trailer = encoder.EncodeTrailer();
+  png.insert(png.end(), trailer.begin(), trailer.end());
+  return png;
+}
+
+static std::vector<uint8_t> Decode(const std::vector<uint8_t>& png) {
+  sk_sp<SkImage> image = SkImage::MakeFromEncoded(
+      SkData::MakeWithoutCopy(png.data(), png.size()));
+  if (!image) {
+    return {};
+  }
+  std::vector<uint8_t> pixels(kWidth * kHeight * 4);
+  if (!image->readPixels(
+          SkImageInfo::Make(kWidth, kHeight, kRGBA_8888_SkColorType,
+                            kUnpremul_SkAlphaType),
+          pixels.data(), kWidth * 4, 0, 0)) {
+    return {};
+  }
+  return pixels;
+}
+
+TEST(StripedPNGEncoderTest, DecodesToTheEncodedPixels) {
+  const std::vector<uint8_t> pixels = MakePixels();
+  for (int stripe_height : {1, 10, kHeight, kHeight * 2}) {
+    for (int compression_level : {1, 6, 9}) {
+      EXPECT_EQ(Decode(Encode(pixels, stripe_height, compression_level)),
+                pixels)
+          << "stripe height " << stripe_height << ", compression level "
+          << compression_level;
+    }
+  }
+}
+
+TEST(StripedPNGEncoderTest, StripesCanBeEncodedInAnyOrder) {
+  const std::vector<uint8_t> pixels = MakePixels();
+  StripedPNGEncoder encoder(kWidth, kHeight, 10, 6);
+  ASSERT_EQ(encoder.GetStripeCount(), 16);
+  std::vector<int> reversed;
+  for (int stripe = encoder.GetStripeCount() - 1; stripe >= 0; --stripe) {
+    reversed.push_back(stripe);
+  }
+  EXPECT_EQ(Encode(pixels, 10, 6, reversed), Encode(pixels, 10, 6));
+}
+
+TEST(StripedPNGEncoderTest, StripingBarelyAffectsTheSize) {
+  const std::vector<uint8_t> pixels = MakePixels();
+  const size_t unstriped_size = Encode(pixels, kHeight, 6).size();
+  const size_t striped_size = Encode(pixels, 40, 6).size();
+  EXPECT_LT(striped_size, unstriped_size * 102 / 100);
+}
+
+TEST(StripedPNGEncoderTest, FailsIfRowsCannotBeRead) {
+  StripedPNGEncoder encoder(kWidth, kHeight, 10, 6);
+  std::vector<uint8_t> encoded;
+  EXPECT_FALSE(encoder.EncodeStripe(
+      3, [](int, int, uint8_t*) { return false; }, &encoded));
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -84,8 +84,14 @@ struct SemanticsNode {
 
   SemanticsNode(const SemanticsNode& other);
 
+  SemanticsNode(SemanticsNode&& other);
+
   ~SemanticsNode();
 
+  SemanticsNode& operator=(const SemanticsNode& other);
+
+  SemanticsNode& operator=(SemanticsNode&& other);
+
   bool HasAction(SemanticsAction action) const;
   bool HasFlag(SemanticsFlags flag) const;
 
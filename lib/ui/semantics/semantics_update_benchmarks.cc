@@ -0,0 +1,198 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/lib/ui/semantics/semantics_update_encoder.h"
+
+namespace flutter {
+
+namespace {
+
+// Stands in for the copy of the tree a platform keeps for its accessibility
+// services, which it updates with every node it is sent.
+struct PlatformNode {
+  int32_t flags = 0;
+  double scroll_position = 0.0;
+  std::string label;
+  std::string value;
+  SkRect rect = SkRect::MakeEmpty();
+  double transform[9] = {};
+  std::vector<int32_t> children;
+};
+
+using PlatformTree = std::unordered_map<int32_t, PlatformNode>;
+
+}  // namespace
+
+// A data table of |node_count| nodes: a root with rows of four cells each.
+static SemanticsNodeUpdates MakeTable(int64_t node_count) {
+  SemanticsNodeUpdates update;
+  const int32_t row_count = (node_count - 1) / 5;
+  SemanticsNode root;
+  root.id = 0;
+  root.scrollChildren = row_count;
+  root.scrollPosition = 0.0;
+  for (int32_t row = 0; row < row_count; ++row) {
+    SemanticsNode row_node;
+    row_node.id = 1 + row * 5;
+    row_node.rect = SkRect::MakeXYWH(0, row * 48, 800, 48);
+    for (int32_t cell = 1; cell <= 4; ++cell) {
+      SemanticsNode cell_node;
+      cell_node.id = row_node.id + cell;
+      cell_node.label = "Column " + std::to_string(cell);
+      cell_node.value = std::to_string(row * cell);
+      cell_node.rect = SkRect::MakeXYWH(cell * 200 - 200, 0, 200, 48);
+      row_node.childrenInTraversalOrder.push_back(cell_node.id);
+      update[cell_node.id] = std::move(cell_node);
+    }
+    row_node.childrenInHitTestOrder = row_node.childrenInTraversalOrder;
+    root.childrenInTraversalOrder.push_back(row_node.id);
+    update[row_node.id] = std::move(row_node);
+  }
+  root.childrenInHitTestOrder = root.childrenInTraversalOrder;
+  update[root.id] = std::move(root);
+  return update;
+}
+
+// Changes the value of one in a hundred cells, as a live table would between
+// two updates.
+static void ChangeValues(SemanticsNodeUpdates& update, int64_t iteration) {
+  for (auto& item : update) {
+    SemanticsNode& node = item.second;
+    if (!node.value.empty() && node.id % 100 == iteration % 100) {
+      node.value = std::to_string(iteration);
+    }
+  }
+}
+
+static void DeliverNode(PlatformTree& tree, const SemanticsNode& node) {
+  PlatformNode& platform_node = tree[node.id];
+  platform_node.flags = node.flags;
+  platform_node.scroll_position = node.scrollPosition;
+  platform_node.label = node.label;
+  platform_node.value = node.value;
+  platform_node.rect = node.rect;
+  for (int i = 0; i < 9; ++i) {
+    platform_node.transform[i] = node.transform.get(i / 3, i % 3);
+  }
+  platform_node.children = node.childrenInTraversalOrder;
+}
+
+static void DeliverDelta(PlatformTree& tree,
+                         const EncodedSemanticsUpdate& encoded,
+                         const SemanticsNodeDelta& delta) {
+  PlatformNode& platform_node = tree[delta.id];
+  if (delta.HasField(SemanticsNodeField::kFlags)) {
+    platform_node.flags = delta.flags;
+  }
+  if (delta.HasField(SemanticsNodeField::kScroll)) {
+    platform_node.scroll_position = delta.scrollPosition;
+  }
+  if (delta.HasField(SemanticsNodeField::kLabel)) {
+    platform_node.label = encoded.strings[delta.label];
+  }
+  if (delta.HasField(SemanticsNodeField::kValue)) {
+    platform_node.value = encoded.strings[delta.value];
+  }
+  if (delta.HasField(SemanticsNodeField::kRect)) {
+    platform_node.rect = delta.rect;
+  }
+  if (delta.HasField(SemanticsNodeField::kTransform)) {
+    for (int i = 0; i < 9; ++i) {
+      platform_node.transform[i] = delta.transform.get(i / 3, i % 3);
+    }
+  }
+  if (delta.HasField(SemanticsNodeField::kChildren)) {
+    const int32_t* children = encoded.ids.data() + delta.childrenOffset;
+    platform_node.children.assign(children, children + delta.childCount);
+  }
+}
+
+// Every node the framework marked dirty is sent to the platform in full,
+// which applies it on the platform thread.
+static void BM_SemanticsUpdateFull(benchmark::State& state) {
+  SemanticsNodeUpdates table = MakeTable(state.range(0));
+  PlatformTree tree;
+  for (const auto& item : table) {
+    DeliverNode(tree, item.second);
+  }
+  int64_t iteration = 0;
+  size_t nodes_sent = 0;
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    ChangeValues(table, ++iteration);
+    SemanticsNodeUpdates update = table;
+    state.ResumeTiming();
+
+    for (const auto& item : update) {
+      DeliverNode(tree, item.second);
+    }
+    nodes_sent += update.size();
+  }
+  state.counters["nodes_sent"] =
+      static_cast<double>(nodes_sent) / state.iterations();
+}
+BENCHMARK(BM_SemanticsUpdateFull)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMicrosecond);
+
+// Working out the changes, which the shell does on the UI thread.
+static void BM_SemanticsUpdateEncode(benchmark::State& state) {
+  SemanticsNodeUpdates table = MakeTable(state.range(0));
+  SemanticsUpdateEncoder encoder;
+  encoder.Encode(table);
+  int64_t iteration = 0;
+  size_t nodes_sent = 0;
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    ChangeValues(table, ++iteration);
+    SemanticsNodeUpdates update = table;
+    state.ResumeTiming();
+
+    const EncodedSemanticsUpdate encoded = encoder.Encode(std::move(update));
+    nodes_sent += encoded.nodes.size();
+  }
+  state.counters["nodes_sent"] =
+      static_cast<double>(nodes_sent) / state.iterations();
+}
+BENCHMARK(BM_SemanticsUpdateEncode)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMicrosecond);
+
+// Only the fields that changed since the last update are sent to the
+// platform.
+static void BM_SemanticsUpdateEncodedApply(benchmark::State& state) {
+  SemanticsNodeUpdates table = MakeTable(state.range(0));
+  SemanticsUpdateEncoder encoder;
+  PlatformTree tree;
+  const EncodedSemanticsUpdate initial = encoder.Encode(table);
+  for (const auto& delta : initial.nodes) {
+    DeliverDelta(tree, initial, delta);
+  }
+  int64_t iteration = 0;
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    ChangeValues(table, ++iteration);
+    EncodedSemanticsUpdate encoded = encoder.Encode(table);
+    state.ResumeTiming();
+
+    for (const auto& delta : encoded.nodes) {
+      DeliverDelta(tree, encoded, delta);
+    }
+    // Destroyed on the platform thread too.
+    EncodedSemanticsUpdate applied = std::move(encoded);
+  }
+}
+BENCHMARK(BM_SemanticsUpdateEncodedApply)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace flutter
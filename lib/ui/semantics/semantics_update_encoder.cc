@@ -0,0 +1,238 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/semantics/semantics_update_encoder.h"
+
+#include <utility>
+
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+namespace {
+
+// Unset scroll positions are NaN, which would otherwise never compare equal.
+bool IsSameDouble(double a, double b) {
+  return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+uint32_t GetChangedFields(const SemanticsNode& previous,
+                          const SemanticsNode& node) {
+  uint32_t fields = 0;
+  auto add_if = [&fields](bool changed, SemanticsNodeField field) {
+    if (changed) {
+      fields |= static_cast<uint32_t>(field);
+    }
+  };
+  add_if(previous.flags != node.flags, SemanticsNodeField::kFlags);
+  add_if(previous.actions != node.actions, SemanticsNodeField::kActions);
+  add_if(previous.textSelectionBase != node.textSelectionBase ||
+             previous.textSelectionExtent != node.textSelectionExtent,
+         SemanticsNodeField::kTextSelection);
+  add_if(previous.scrollChildren != node.scrollChildren ||
+             previous.scrollIndex != node.scrollIndex ||
+             !IsSameDouble(previous.scrollPosition, node.scrollPosition) ||
+             !IsSameDouble(previous.scrollExtentMax, node.scrollExtentMax) ||
+             !IsSameDouble(previous.scrollExtentMin, node.scrollExtentMin),
+         SemanticsNodeField::kScroll);
+  add_if(previous.elevation != node.elevation ||
+             previous.thickness != node.thickness,
+         SemanticsNodeField::kElevation);
+  add_if(previous.label != node.label, SemanticsNodeField::kLabel);
+  add_if(previous.hint != node.hint, SemanticsNodeField::kHint);
+  add_if(previous.value != node.value, SemanticsNodeField::kValue);
+  add_if(previous.increasedValue != node.increasedValue,
+         SemanticsNodeField::kIncreasedValue);
+  add_if(previous.decreasedValue != node.decreasedValue,
+         SemanticsNodeField::kDecreasedValue);
+  add_if(previous.textDirection != node.textDirection,
+         SemanticsNodeField::kTextDirection);
+  add_if(previous.rect != node.rect, SemanticsNodeField::kRect);
+  add_if(previous.transform != node.transform, SemanticsNodeField::kTransform);
+  add_if(previous.childrenInTraversalOrder != node.childrenInTraversalOrder ||
+             previous.childrenInHitTestOrder != node.childrenInHitTestOrder,
+         SemanticsNodeField::kChildren);
+  add_if(previous.customAccessibilityActions !=
+             node.customAccessibilityActions,
+         SemanticsNodeField::kCustomAccessibilityActions);
+  add_if(previous.platformViewId != node.platformViewId,
+         SemanticsNodeField::kPlatformViewId);
+  add_if(previous.maxValueLength != node.maxValueLength ||
+             previous.currentValueLength != node.currentValueLength,
+         SemanticsNodeField::kValueLength);
+  return fields;
+}
+
+// Builds the deltas of an update, storing every distinct string once.
+class DeltaBuilder {
+ public:
+  explicit DeltaBuilder(EncodedSemanticsUpdate& encoded) : encoded_(encoded) {}
+
+  void AddNode(const SemanticsNode& node, uint32_t changed_fields) {
+    SemanticsNodeDelta& delta = encoded_.nodes.emplace_back();
+    delta.id = node.id;
+    delta.changedFields = changed_fields;
+    if (delta.HasField(SemanticsNodeField::kFlags)) {
+      delta.flags = node.flags;
+    }
+    if (delta.HasField(SemanticsNodeField::kActions)) {
+      delta.actions = node.actions;
+    }
+    if (delta.HasField(SemanticsNodeField::kTextSelection)) {
+      delta.textSelectionBase = node.textSelectionBase;
+      delta.textSelectionExtent = node.textSelectionExtent;
+    }
+    if (delta.HasField(SemanticsNodeField::kScroll)) {
+      delta.scrollChildren = node.scrollChildren;
+      delta.scrollIndex = node.scrollIndex;
+      delta.scrollPosition = node.scrollPosition;
+      delta.scrollExtentMax = node.scrollExtentMax;
+      delta.scrollExtentMin = node.scrollExtentMin;
+    }
+    if (delta.HasField(SemanticsNodeField::kElevation)) {
+      delta.elevation = node.elevation;
+      delta.thickness = node.thickness;
+    }
+    if (delta.HasField(SemanticsNodeField::kLabel)) {
+      delta.label = Intern(node.label);
+    }
+    if (delta.HasField(SemanticsNodeField::kHint)) {
+      delta.hint = Intern(node.hint);
+    }
+    if (delta.HasField(SemanticsNodeField::kValue)) {
+      delta.value = Intern(node.value);
+    }
+    if (delta.HasField(SemanticsNodeField::kIncreasedValue)) {
+      delta.increasedValue = Intern(node.increasedValue);
+    }
+    if (delta.HasField(SemanticsNodeField::kDecreasedValue)) {
+      delta.decreasedValue = Intern(node.decreasedValue);
+    }
+    if (delta.HasField(SemanticsNodeField::kTextDirection)) {
+      delta.textDirection = node.textDirection;
+    }
+    if (delta.HasField(SemanticsNodeField::kRect)) {
+      delta.rect = node.rect;
+    }
+    if (delta.HasField(SemanticsNodeField::kTransform)) {
+      delta.transform = node.transform;
+    }
+    if (delta.HasField(SemanticsNodeField::kChildren)) {
+      delta.childrenOffset = encoded_.ids.size();
+      delta.childCount = node.childrenInTraversalOrder.size();
+      AddIds(node.childrenInTraversalOrder);
+      AddIds(node.childrenInHitTestOrder);
+    }
+    if (delta.HasField(SemanticsNodeField::kCustomAccessibilityActions)) {
+      delta.customAccessibilityActionsOffset = encoded_.ids.size();
+      delta.customAccessibilityActionCount =
+          node.customAccessibilityActions.size();
+      AddIds(node.customAccessibilityActions);
+    }
+    if (delta.HasField(SemanticsNodeField::kPlatformViewId)) {
+      delta.platformViewId = node.platformViewId;
+    }
+    if (delta.HasField(SemanticsNodeField::kValueLength)) {
+      delta.maxValueLength = node.maxValueLength;
+      delta.currentValueLength = node.currentValueLength;
+    }
+  }
+
+ private:
+  EncodedSemanticsUpdate& encoded_;
+  std::unordered_map<std::string, uint32_t> string_indices_;
+
+  uint32_t Intern(const std::string& string) {
+    auto result = string_indices_.try_emplace(string, encoded_.strings.size());
+    if (result.second) {
+      encoded_.strings.push_back(string);
+    }
+    return result.first->second;
+  }
+
+  void AddIds(const std::vector<int32_t>& ids) {
+    encoded_.ids.insert(encoded_.ids.end(), ids.begin(), ids.end());
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DeltaBuilder);
+};
+
+}  // namespace
+
+EncodedSemanticsUpdate::EncodedSemanticsUpdate() = default;
+
+EncodedSemanticsUpdate::~EncodedSemanticsUpdate() = default;
+
+SemanticsUpdateEncoder::SemanticsUpdateEncoder() = default;
+
+SemanticsUpdateEncoder::~SemanticsUpdateEncoder() = default;
+
+EncodedSemanticsUpdate SemanticsUpdateEncoder::Encode(
+    SemanticsNodeUpdates update) {
+  TRACE_EVENT0("flutter", "SemanticsUpdateEncoder::Encode");
+  EncodedSemanticsUpdate encoded;
+  DeltaBuilder builder(encoded);
+
+  // Children dropped from a node may have moved to another node in the same
+  // update, so they are only removed once the whole update is known.
+  std::vector<int32_t> detached;
+  std::unordered_set<int32_t> attached;
+  for (auto& item : update) {
+    SemanticsNode& node = item.second;
+    auto result = nodes_.try_emplace(item.first);
+    SemanticsNode& previous = result.first->second;
+    const uint32_t changed_fields = result.second
+                                        ? kAllSemanticsNodeFields
+                                        : GetChangedFields(previous, node);
+    if (changed_fields == 0) {
+      continue;
+    }
+    if (changed_fields & static_cast<uint32_t>(SemanticsNodeField::kChildren)) {
+      detached.insert(detached.end(), previous.childrenInTraversalOrder.begin(),
+                      previous.childrenInTraversalOrder.end());
+      attached.insert(node.childrenInTraversalOrder.begin(),
+                      node.childrenInTraversalOrder.end());
+    }
+    previous = std::move(node);
+    builder.AddNode(previous, changed_fields);
+  }
+
+  for (int32_t id : detached) {
+    if (attached.count(id) == 0) {
+      RemoveSubtree(id, attached, encoded.removedNodes);
+    }
+  }
+  return encoded;
+}
+
+void SemanticsUpdateEncoder::RemoveSubtree(
+    int32_t id,
+    const std::unordered_set<int32_t>& attached,
+    std::vector<int32_t>& removed) {
+  std::vector<int32_t> pending = {id};
+  while (!pending.empty()) {
+    const int32_t node_id = pending.back();
+    pending.pop_back();
+    auto found = nodes_.find(node_id);
+    if (found == nodes_.end()) {
+      continue;
+    }
+    for (int32_t child : found->second.childrenInTraversalOrder) {
+      if (attached.count(child) == 0) {
+        pending.push_back(child);
+      }
+    }
+    nodes_.erase(found);
+    removed.push_back(node_id);
+  }
+}
+
+void SemanticsUpdateEncoder::Reset() {
+  nodes_.clear();
+}
+
+size_t SemanticsUpdateEncoder::GetNodeCount() const {
+  return nodes_.size();
+}
+
+}  // namespace flutter
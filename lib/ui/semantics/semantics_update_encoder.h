@@ -0,0 +1,151 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_SEMANTICS_SEMANTICS_UPDATE_ENCODER_H_
+#define FLUTTER_LIB_UI_SEMANTICS_SEMANTICS_UPDATE_ENCODER_H_
+
+#include <stdint.h>
+
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/lib/ui/semantics/semantics_node.h"
+
+namespace flutter {
+
+// The groups of `SemanticsNode` fields a `SemanticsNodeDelta` can carry.
+enum class SemanticsNodeField : uint32_t {
+  kFlags = 1 << 0,
+  kActions = 1 << 1,
+  // The text selection base and extent.
+  kTextSelection = 1 << 2,
+  // The scroll children, index, position and extents.
+  kScroll = 1 << 3,
+  // The elevation and thickness.
+  kElevation = 1 << 4,
+  kLabel = 1 << 5,
+  kHint = 1 << 6,
+  kValue = 1 << 7,
+  kIncreasedValue = 1 << 8,
+  kDecreasedValue = 1 << 9,
+  kTextDirection = 1 << 10,
+  kRect = 1 << 11,
+  kTransform = 1 << 12,
+  // The children in both traversal and hit test order.
+  kChildren = 1 << 13,
+  kCustomAccessibilityActions = 1 << 14,
+  kPlatformViewId = 1 << 15,
+  // The maximum and current value lengths.
+  kValueLength = 1 << 16,
+};
+
+constexpr uint32_t kAllSemanticsNodeFields = (1 << 17) - 1;
+
+// The fields of a node that changed since it was last encoded. Only the
+// fields in `changedFields` are set, and a node that was not encoded before
+// has them all set.
+struct SemanticsNodeDelta {
+  bool HasField(SemanticsNodeField field) const {
+    return (changedFields & static_cast<uint32_t>(field)) != 0;
+  }
+
+  int32_t id = 0;
+  uint32_t changedFields = 0;
+
+  int32_t flags = 0;
+  int32_t actions = 0;
+  int32_t maxValueLength = -1;
+  int32_t currentValueLength = -1;
+  int32_t textSelectionBase = -1;
+  int32_t textSelectionExtent = -1;
+  int32_t platformViewId = -1;
+  int32_t scrollChildren = 0;
+  int32_t scrollIndex = 0;
+  double scrollPosition = std::nan("");
+  double scrollExtentMax = std::nan("");
+  double scrollExtentMin = std::nan("");
+  double elevation = 0.0;
+  double thickness = 0.0;
+  // Indices into `EncodedSemanticsUpdate::strings`.
+  uint32_t label = 0;
+  uint32_t hint = 0;
+  uint32_t value = 0;
+  uint32_t increasedValue = 0;
+  uint32_t decreasedValue = 0;
+  int32_t textDirection = 0;
+
+  SkRect rect = SkRect::MakeEmpty();
+  SkMatrix44 transform = SkMatrix44(SkMatrix44::kIdentity_Constructor);
+  // Ranges of `EncodedSemanticsUpdate::ids`. The children in hit test order
+  // follow the `childCount` children in traversal order.
+  uint32_t childrenOffset = 0;
+  uint32_t childCount = 0;
+  uint32_t customAccessibilityActionsOffset = 0;
+  uint32_t customAccessibilityActionCount = 0;
+};
+
+// A flat encoding of the changes a `SemanticsNodeUpdates` makes to the
+// semantics tree.
+struct EncodedSemanticsUpdate {
+  EncodedSemanticsUpdate();
+
+  ~EncodedSemanticsUpdate();
+
+  std::vector<SemanticsNodeDelta> nodes;
+  // Every distinct string in the update, once.
+  std::vector<std::string> strings;
+  // The children and custom accessibility actions of all the nodes.
+  std::vector<int32_t> ids;
+  // The nodes that are no longer in the tree. They are removed after the
+  // changes in |nodes| are applied.
+  std::vector<int32_t> removedNodes;
+};
+
+//------------------------------------------------------------------------------
+/// @brief      Encodes semantics updates as the changes they make to the tree
+///             sent so far.
+///
+///             The framework sends every node it marked dirty in full, which
+///             for large trees is thousands of nodes where only a few fields
+///             changed. Platforms that keep their own copy of the tree only
+///             need those fields.
+///
+class SemanticsUpdateEncoder {
+ public:
+  SemanticsUpdateEncoder();
+
+  ~SemanticsUpdateEncoder();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Encodes the changes |update| makes to the tree and applies
+  ///             them. Nodes that did not change are left out.
+  ///
+  EncodedSemanticsUpdate Encode(SemanticsNodeUpdates update);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Forgets the tree, so that every node is encoded in full the
+  ///             next time it is updated. Used when the framework starts over
+  ///             with a new tree, like when semantics are enabled again.
+  ///
+  void Reset();
+
+  size_t GetNodeCount() const;
+
+ private:
+  std::unordered_map<int32_t, SemanticsNode> nodes_;
+
+  void RemoveSubtree(int32_t id,
+                     const std::unordered_set<int32_t>& attached,
+                     std::vector<int32_t>& removed);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(SemanticsUpdateEncoder);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_SEMANTICS_SEMANTICS_UPDATE_ENCODER_H_
@@ -0,0 +1,177 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/semantics/semantics_update_encoder.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "flutter/testing/testing.h"
+
+namespace flutter {
+namespace testing {
+
+static SemanticsNode MakeNode(int32_t id,
+                              std::string label,
+                              std::vector<int32_t> children = {}) {
+  SemanticsNode node;
+  node.id = id;
+  node.label = std::move(label);
+  node.rect = SkRect::MakeLTRB(0, id * 10, 100, id * 10 + 10);
+  node.childrenInTraversalOrder = children;
+  node.childrenInHitTestOrder = std::move(children);
+  return node;
+}
+
+static void AddNode(SemanticsNodeUpdates& update, SemanticsNode node) {
+  update[node.id] = std::move(node);
+}
+
+// A root with |row_count| rows, each with a label and a value cell. The ids of
+// the cells of row `n` are `n * 100` and `n * 100 + 1`, so there can be up to
+// 99 rows.
+static SemanticsNodeUpdates MakeTable(int32_t row_count) {
+  SemanticsNodeUpdates update;
+  std::vector<int32_t> rows;
+  for (int32_t row = 1; row <= row_count; ++row) {
+    const int32_t label_cell = row * 100;
+    const int32_t value_cell = row * 100 + 1;
+    AddNode(update, MakeNode(row, "", {label_cell, value_cell}));
+    AddNode(update, MakeNode(label_cell, "Row " + std::to_string(row)));
+    AddNode(update, MakeNode(value_cell, "0"));
+    rows.push_back(row);
+  }
+  AddNode(update, MakeNode(0, "", rows));
+  return update;
+}
+
+static const SemanticsNodeDelta* FindDelta(
+    const EncodedSemanticsUpdate& encoded,
+    int32_t id) {
+  for (const auto& delta : encoded.nodes) {
+    if (delta.id == id) {
+      return &delta;
+    }
+  }
+  return nullptr;
+}
+
+TEST(SemanticsUpdateEncoderTest, NewNodesAreEncodedInFull) {
+  SemanticsUpdateEncoder encoder;
+  SemanticsNodeUpdates update;
+  SemanticsNode root = MakeNode(0, "root", {1});
+  root.childrenInHitTestOrder = {1};
+  root.customAccessibilityActions = {21, 22};
+  root.transform.set(0, 3, 5.0);
+  AddNode(update, std::move(root));
+  AddNode(update, MakeNode(1, "leaf"));
+
+  const EncodedSemanticsUpdate encoded = encoder.Encode(std::move(update));
+  ASSERT_EQ(encoded.nodes.size(), 2u);
+  ASSERT_TRUE(encoded.removedNodes.empty());
+  ASSERT_EQ(encoder.GetNodeCount(), 2u);
+
+  const SemanticsNodeDelta* delta = FindDelta(encoded, 0);
+  ASSERT_NE(delta, nullptr);
+  ASSERT_EQ(delta->changedFields, kAllSemanticsNodeFields);
+  ASSERT_EQ(encoded.strings[delta->label], "root");
+  ASSERT_EQ(encoded.strings[delta->hint], "");
+  ASSERT_EQ(delta->transform.get(0, 3), 5.0);
+  ASSERT_EQ(delta->childCount, 1u);
+  ASSERT_EQ(encoded.ids[delta->childrenOffset], 1);
+  ASSERT_EQ(encoded.ids[delta->childrenOffset + delta->childCount], 1);
+  ASSERT_EQ(delta->customAccessibilityActionCount, 2u);
+  ASSERT_EQ(encoded.ids[delta->customAccessibilityActionsOffset], 21);
+  ASSERT_EQ(encoded.ids[delta->customAccessibilityActionsOffset + 1], 22);
+}
+
+TEST(SemanticsUpdateEncoderTest, OnlyChangedFieldsAreEncoded) {
+  SemanticsUpdateEncoder encoder;
+  encoder.Encode(MakeTable(99));
+
+  // The framework sends every row again, but only one value changed.
+  SemanticsNodeUpdates update = MakeTable(99);
+  update[4201].value = "42%";
+  const EncodedSemanticsUpdate encoded = encoder.Encode(std::move(update));
+  ASSERT_EQ(encoded.nodes.size(), 1u);
+  const SemanticsNodeDelta& delta = encoded.nodes[0];
+  ASSERT_EQ(delta.id, 4201);
+  ASSERT_EQ(delta.changedFields,
+            static_cast<uint32_t>(SemanticsNodeField::kValue));
+  ASSERT_EQ(encoded.strings, std::vector<std::string>({"42%"}));
+  ASSERT_TRUE(encoded.ids.empty());
+
+  // Sending the same update again changes nothing.
+  update = MakeTable(99);
+  update[4201].value = "42%";
+  ASSERT_TRUE(encoder.Encode(std::move(update)).nodes.empty());
+}
+
+TEST(SemanticsUpdateEncoderTest, UnsetScrollPositionsAreUnchanged) {
+  SemanticsUpdateEncoder encoder;
+  SemanticsNodeUpdates update;
+  AddNode(update, MakeNode(0, "root"));
+  encoder.Encode(update);
+  ASSERT_TRUE(encoder.Encode(update).nodes.empty());
+
+  update[0].scrollPosition = 10.0;
+  const EncodedSemanticsUpdate encoded = encoder.Encode(update);
+  ASSERT_EQ(encoded.nodes.size(), 1u);
+  ASSERT_EQ(encoded.nodes[0].changedFields,
+            static_cast<uint32_t>(SemanticsNodeField::kScroll));
+  ASSERT_EQ(encoded.nodes[0].scrollPosition, 10.0);
+}
+
+TEST(SemanticsUpdateEncoderTest, StringsAreStoredOnce) {
+  SemanticsUpdateEncoder encoder;
+  const EncodedSemanticsUpdate encoded = encoder.Encode(MakeTable(99));
+  ASSERT_EQ(encoded.nodes.size(), 298u);
+  // The row labels, "0" and "".
+  ASSERT_EQ(encoded.strings.size(), 101u);
+  const SemanticsNodeDelta* first = FindDelta(encoded, 101);
+  const SemanticsNodeDelta* second = FindDelta(encoded, 201);
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  ASSERT_EQ(first->label, second->label);
+  ASSERT_EQ(encoded.strings[first->label], "0");
+}
+
+TEST(SemanticsUpdateEncoderTest, DroppedSubtreesAreRemoved) {
+  SemanticsUpdateEncoder encoder;
+  encoder.Encode(MakeTable(3));
+  ASSERT_EQ(encoder.GetNodeCount(), 10u);
+
+  // Row 3 is dropped, and the value cell of row 2 moves to row 1.
+  SemanticsNodeUpdates update;
+  AddNode(update, MakeNode(0, "", {1, 2}));
+  AddNode(update, MakeNode(1, "", {100, 101, 201}));
+  AddNode(update, MakeNode(2, "", {200}));
+  const EncodedSemanticsUpdate encoded = encoder.Encode(std::move(update));
+  ASSERT_EQ(encoded.nodes.size(), 3u);
+  for (const auto& delta : encoded.nodes) {
+    ASSERT_EQ(delta.changedFields,
+              static_cast<uint32_t>(SemanticsNodeField::kChildren));
+  }
+  std::vector<int32_t> removed = encoded.removedNodes;
+  std::sort(removed.begin(), removed.end());
+  ASSERT_EQ(removed, std::vector<int32_t>({3, 300, 301}));
+  ASSERT_EQ(encoder.GetNodeCount(), 7u);
+}
+
+TEST(SemanticsUpdateEncoderTest, ResetEncodesNodesInFullAgain) {
+  SemanticsUpdateEncoder encoder;
+  encoder.Encode(MakeTable(10));
+  encoder.Reset();
+  ASSERT_EQ(encoder.GetNodeCount(), 0u);
+
+  const EncodedSemanticsUpdate encoded = encoder.Encode(MakeTable(10));
+  ASSERT_EQ(encoded.nodes.size(), 31u);
+  for (const auto& delta : encoded.nodes) {
+    ASSERT_EQ(delta.changedFields, kAllSemanticsNodeFields);
+  }
+}
+
+}  // namespace testing
+}  // namespace flutter
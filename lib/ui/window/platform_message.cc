@@ -6,22 +6,39 @@
 
 #include <utility>
 
+#include "flutter/fml/logging.h"
+
 namespace flutter {
 
 PlatformMessage::PlatformMessage(std::string channel,
                                  std::vector<uint8_t> data,
                                  fml::RefPtr<PlatformMessageResponse> response)
     : channel_(std::move(channel)),
-      data_(std::move(data)),
+      data_(std::make_unique<fml::DataMapping>(std::move(data))),
       hasData_(true),
       response_(std::move(response)) {}
+PlatformMessage::PlatformMessage(std::string channel,
+                                 std::unique_ptr<fml::Mapping> data,
+                                 fml::RefPtr<PlatformMessageResponse> response)
+    : channel_(std::move(channel)),
+      data_(std::move(data)),
+      hasData_(true),
+      response_(std::move(response)) {
+  FML_DCHECK(data_);
+}
 PlatformMessage::PlatformMessage(std::string channel,
                                  fml::RefPtr<PlatformMessageResponse> response)
     : channel_(std::move(channel)),
-      data_(),
+      data_(std::make_unique<fml::NonOwnedMapping>(nullptr, 0u)),
       hasData_(false),
       response_(std::move(response)) {}
 
 PlatformMessage::~PlatformMessage() = default;
 
+std::unique_ptr<fml::Mapping> PlatformMessage::releaseData() {
+  auto data = std::move(data_);
+  data_ = std::make_unique<fml::NonOwnedMapping>(nullptr, 0u);
+  return data;
+}
+
 }  // namespace flutter
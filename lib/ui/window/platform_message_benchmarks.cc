@@ -0,0 +1,115 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/lib/ui/window/platform_message.h"
+
+namespace flutter {
+
+// The buffer an embedder sends, which it keeps ownership of unless it hands
+// it over with a release callback.
+static std::vector<uint8_t> MakeEmbedderBuffer(benchmark::State& state) {
+  return std::vector<uint8_t>(state.range(0), 0xAB);
+}
+
+// Hands the embedder's buffer over without copying it, the way the embedder
+// API wraps buffers sent with a release callback. The buffer stays writable,
+// which is what allows it to be handed to Dart as external typed data.
+class EmbedderBufferMapping final : public fml::Mapping {
+ public:
+  explicit EmbedderBufferMapping(std::vector<uint8_t>& buffer)
+      : buffer_(buffer) {}
+
+  // |fml::Mapping|
+  size_t GetSize() const override { return buffer_.size(); }
+
+  // |fml::Mapping|
+  const uint8_t* GetMapping() const override { return buffer_.data(); }
+
+  // |fml::Mapping|
+  uint8_t* GetMutableMapping() override { return buffer_.data(); }
+
+ private:
+  std::vector<uint8_t>& buffer_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(EmbedderBufferMapping);
+};
+
+// Stands in for the ByteData a message is delivered to Dart as. Both variants
+// end once Dart could read the payload and the ByteData has been collected.
+class FakeByteData {
+ public:
+  // A ByteData allocated in the Dart heap with a copy of |data|.
+  static std::unique_ptr<FakeByteData> Copy(const fml::Mapping& data) {
+    auto byte_data = std::make_unique<FakeByteData>();
+    byte_data->heap_data_ = std::make_unique<uint8_t[]>(data.GetSize());
+    std::memcpy(byte_data->heap_data_.get(), data.GetMapping(),
+                data.GetSize());
+    byte_data->data_ = byte_data->heap_data_.get();
+    return byte_data;
+  }
+
+  // External typed data pointing into |mapping|, whose finalizer releases
+  // |mapping| once the ByteData is collected.
+  static std::unique_ptr<FakeByteData> External(
+      std::unique_ptr<fml::Mapping> mapping) {
+    auto byte_data = std::make_unique<FakeByteData>();
+    byte_data->data_ = mapping->GetMutableMapping();
+    byte_data->peer_ = std::move(mapping);
+    return byte_data;
+  }
+
+  const uint8_t* data() const { return data_; }
+
+ private:
+  std::unique_ptr<uint8_t[]> heap_data_;
+  std::unique_ptr<fml::Mapping> peer_;
+  const uint8_t* data_ = nullptr;
+};
+
+// What delivering a message looked like before payloads were mappings: a copy
+// out of the embedder's buffer, and another into the Dart heap.
+static void BM_PlatformMessageCopied(benchmark::State& state) {
+  const std::vector<uint8_t> embedder_buffer = MakeEmbedderBuffer(state);
+
+  while (state.KeepRunning()) {
+    auto message = fml::MakeRefCounted<PlatformMessage>(
+        "flutter/test",
+        std::vector<uint8_t>(embedder_buffer.begin(), embedder_buffer.end()),
+        nullptr);
+    auto byte_data = FakeByteData::Copy(message->data());
+    benchmark::DoNotOptimize(byte_data->data());
+  }
+
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PlatformMessageCopied)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 16 << 20);
+
+// A buffer handed over by the embedder goes to Dart as external typed data.
+static void BM_PlatformMessageHandedOver(benchmark::State& state) {
+  std::vector<uint8_t> embedder_buffer = MakeEmbedderBuffer(state);
+
+  while (state.KeepRunning()) {
+    auto message = fml::MakeRefCounted<PlatformMessage>(
+        "flutter/test",
+        std::make_unique<EmbedderBufferMapping>(embedder_buffer), nullptr);
+    auto byte_data = FakeByteData::External(message->releaseData());
+    benchmark::DoNotOptimize(byte_data->data());
+  }
+
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PlatformMessageHandedOver)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 16 << 20);
+
+}  // namespace flutter
@@ -17,6 +17,15 @@
 namespace flutter {
 namespace {
 
+// Avoid copying the contents of messages beyond a certain size.
+constexpr size_t kMessageCopyThreshold = 1000;
+
+void MappingFinalizer(void* isolate_callback_data,
+                      Dart_WeakPersistentHandle handle,
+                      void* peer) {
+  delete reinterpret_cast<fml::Mapping*>(peer);
+}
+
 void DefaultRouteName(Dart_NativeArguments args) {
   std::string routeName =
       UIDartState::Current()->window()->client()->DefaultRouteName();
@@ -175,6 +184,24 @@ Dart_Handle ToByteData(const std::vector<uint8_t>& buffer) {
   return data_handle;
 }
 
+Dart_Handle ToByteData(std::unique_ptr<fml::Mapping> mapping) {
+  const size_t size = mapping->GetSize();
+  uint8_t* data = mapping->GetMutableMapping();
+  // Dart code may write to the typed data, so read-only mappings are copied.
+  if (size < kMessageCopyThreshold || data == nullptr) {
+    return tonic::DartByteData::Create(mapping->GetMapping(), size);
+  }
+
+  fml::Mapping* peer = mapping.release();
+  Dart_Handle data_handle = Dart_NewExternalTypedDataWithFinalizer(
+      Dart_TypedData_kByteData, data, size, peer, size, MappingFinalizer);
+  if (Dart_IsError(data_handle)) {
+    // The finalizer is only attached on success.
+    delete peer;
+  }
+  return data_handle;
+}
+
 WindowClient::~WindowClient() {}
 
 Window::Window(WindowClient* client) : client_(client) {}
@@ -283,7 +310,7 @@ void Window::DispatchPlatformMessage(fml::RefPtr<PlatformMessage> message) {
   }
   tonic::DartState::Scope scope(dart_state);
   Dart_Handle data_handle =
-      (message->hasData()) ? ToByteData(message->data()) : Dart_Null();
+      (message->hasData()) ? ToByteData(message->releaseData()) : Dart_Null();
   if (Dart_IsError(data_handle)) {
     FML_DLOG(WARNING)
         << "Dropping platform message because of a Dart error on channel: "
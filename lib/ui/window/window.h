@@ -5,6 +5,7 @@
 #ifndef FLUTTER_LIB_UI_WINDOW_WINDOW_H_
 #define FLUTTER_LIB_UI_WINDOW_WINDOW_H_
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -37,6 +38,10 @@ class Scene;
 
 Dart_Handle ToByteData(const std::vector<uint8_t>& buffer);
 
+// Small payloads and read-only mappings are copied into the Dart heap. Larger
+// writable mappings are handed to Dart as external typed data that owns them.
+Dart_Handle ToByteData(std::unique_ptr<fml::Mapping> mapping);
+
 // Must match the AccessibilityFeatureFlag enum in window.dart.
 enum class AccessibilityFeatureFlag : int32_t {
   kAccessibleNavigation = 1 << 0,
@@ -48,8 +48,18 @@ class SkAnimatedImage implements ui.Image {
   int get height => _skAnimatedImage.callMethod('height');
 
   @override
-  Future<ByteData> toByteData(
-      {ui.ImageByteFormat format = ui.ImageByteFormat.rawRgba}) {
+  Future<ByteData> toByteData({
+    ui.ImageByteFormat format = ui.ImageByteFormat.rawRgba,
+    bool fastCompression = false,
+  }) {
+    throw 'unimplemented';
+  }
+
+  @override
+  Stream<Uint8List> toByteDataChunks({
+    ui.ImageByteFormat format = ui.ImageByteFormat.rawRgba,
+    bool fastCompression = false,
+  }) {
     throw 'unimplemented';
   }
 }
@@ -73,8 +83,18 @@ class SkImage implements ui.Image {
   int get height => skImage.callMethod('height');
 
   @override
-  Future<ByteData> toByteData(
-      {ui.ImageByteFormat format = ui.ImageByteFormat.rawRgba}) {
+  Future<ByteData> toByteData({
+    ui.ImageByteFormat format = ui.ImageByteFormat.rawRgba,
+    bool fastCompression = false,
+  }) {
+    throw 'unimplemented';
+  }
+
+  @override
+  Stream<Uint8List> toByteDataChunks({
+    ui.ImageByteFormat format = ui.ImageByteFormat.rawRgba,
+    bool fastCompression = false,
+  }) {
     throw 'unimplemented';
   }
 }
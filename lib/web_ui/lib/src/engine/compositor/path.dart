@@ -164,6 +164,17 @@ class SkPath implements ui.Path {
     return _skPath.callMethod('contains', <double>[point.dx, point.dy]);
   }
 
+  @override
+  Uint8List containsPoints(Float32List points) {
+    final Uint8List result = Uint8List(points.length ~/ 2);
+    for (int i = 0; i < result.length; i++) {
+      if (contains(ui.Offset(points[i * 2], points[i * 2 + 1]))) {
+        result[i] = 1;
+      }
+    }
+    return result;
+  }
+
   @override
   void cubicTo(
       double x1, double y1, double x2, double y2, double x3, double y3) {
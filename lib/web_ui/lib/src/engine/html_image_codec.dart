@@ -115,8 +115,10 @@ class HtmlImage implements ui.Image {
   final int height;
 
   @override
-  Future<ByteData> toByteData(
-      {ui.ImageByteFormat format = ui.ImageByteFormat.rawRgba}) {
+  Future<ByteData> toByteData({
+    ui.ImageByteFormat format = ui.ImageByteFormat.rawRgba,
+    bool fastCompression = false,
+  }) {
     return futurize((Callback<ByteData> callback) {
       return _toByteData(format.index, (Uint8List encoded) {
         callback(encoded?.buffer?.asByteData());
@@ -124,6 +126,15 @@ class HtmlImage implements ui.Image {
     });
   }
 
+  @override
+  Stream<Uint8List> toByteDataChunks({
+    ui.ImageByteFormat format = ui.ImageByteFormat.rawRgba,
+    bool fastCompression = false,
+  }) {
+    return Stream<Uint8List>.fromFuture(toByteData(format: format)
+        .then((ByteData data) => data.buffer.asUint8List()));
+  }
+
   // Returns absolutely positioned actual image element on first call and
   // clones on subsequent calls.
   html.ImageElement cloneImageElement() {
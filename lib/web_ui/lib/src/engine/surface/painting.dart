@@ -933,6 +933,17 @@ class SurfacePath implements ui.Path {
     return result;
   }
 
+  @override
+  Uint8List containsPoints(Float32List points) {
+    final Uint8List result = Uint8List(points.length ~/ 2);
+    for (int i = 0; i < result.length; i++) {
+      if (contains(ui.Offset(points[i * 2], points[i * 2 + 1]))) {
+        result[i] = 1;
+      }
+    }
+    return result;
+  }
+
   /// Returns a copy of the path with all the segments of every
   /// subpath translated by the given offset.
   @override
@@ -121,6 +121,23 @@ class SurfacePathMetric implements ui.PathMetric {
 
   Float32List _getPosTan(double distance) => throw UnimplementedError();
 
+  @override
+  Float32List getTangentsForOffsets(Float32List distances) {
+    final Float32List posTans = Float32List(distances.length * 4);
+    for (int i = 0; i < distances.length; i++) {
+      final ui.Tangent tangent = getTangentForOffset(distances[i]);
+      if (tangent == null) {
+        posTans.fillRange(i * 4, i * 4 + 4, double.nan);
+      } else {
+        posTans[i * 4] = tangent.position.dx;
+        posTans[i * 4 + 1] = tangent.position.dy;
+        posTans[i * 4 + 2] = tangent.vector.dx;
+        posTans[i * 4 + 3] = tangent.vector.dy;
+      }
+    }
+    return posTans;
+  }
+
   /// Given a start and stop distance, return the intervening segment(s).
   ///
   /// `start` and `end` are pinned to legal values (0..[length])
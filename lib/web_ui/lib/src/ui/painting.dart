@@ -1206,10 +1206,25 @@ abstract class Image {
   /// The [format] argument specifies the format in which the bytes will be
   /// returned.
   ///
+  /// If [fastCompression] is true, compressed formats like
+  /// [ImageByteFormat.png] trade a larger output for encoding faster.
+  ///
   /// Returns a future that completes with the binary image data or an error
   /// if encoding fails.
-  Future<ByteData> toByteData(
-      {ImageByteFormat format = ImageByteFormat.rawRgba});
+  Future<ByteData> toByteData({
+    ImageByteFormat format = ImageByteFormat.rawRgba,
+    bool fastCompression = false,
+  });
+
+  /// Converts the [Image] object into a byte array like [toByteData], but
+  /// delivers the bytes in chunks as soon as they are encoded.
+  ///
+  /// The stream closes once the whole image is delivered, or with an error if
+  /// encoding fails.
+  Stream<Uint8List> toByteDataChunks({
+    ImageByteFormat format = ImageByteFormat.rawRgba,
+    bool fastCompression = false,
+  });
 
   /// Release the resources used by this object. The object is no longer usable
   /// after this method is called.
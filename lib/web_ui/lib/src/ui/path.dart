@@ -240,6 +240,15 @@ abstract class Path {
   /// RawRecordingCanvas can remove create/remove rootElement cost.
   bool contains(Offset point);
 
+  /// Tests to see which of the given points are within the path, as
+  /// [contains] would for each of them.
+  ///
+  /// The `points` argument is a list of interleaved x and y coordinates.
+  ///
+  /// Returns a list with one entry per point, which is 1 if the point is in
+  /// the path and 0 otherwise.
+  Uint8List containsPoints(Float32List points);
+
   /// Returns a copy of the path with all the segments of every
   /// subpath translated by the given offset.
   Path shift(Offset offset);
@@ -81,6 +81,14 @@ abstract class PathMetric {
   /// The distance is clamped to the [length] of the current contour.
   Tangent getTangentForOffset(double distance);
 
+  /// Computes the positions and the vectors of the tangents of the current
+  /// contour at each of the given offsets, as [getTangentForOffset] would.
+  ///
+  /// Returns a list with four values per offset: the x and y coordinates of
+  /// the position, followed by the x and y coordinates of the vector of the
+  /// tangent. The values are all NaN if the contour has zero [length].
+  Float32List getTangentsForOffsets(Float32List distances);
+
   /// Given a start and stop distance, return the intervening segment(s).
   ///
   /// `start` and `end` are pinned to legal values (0..[length])
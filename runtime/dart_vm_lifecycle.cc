@@ -29,6 +29,8 @@ DartVMRef::DartVMRef(std::shared_ptr<DartVM> vm) : vm_(vm) {}
 
 DartVMRef::DartVMRef(DartVMRef&& other) = default;
 
+DartVMRef::DartVMRef(const DartVMRef& other) = default;
+
 DartVMRef::~DartVMRef() {
   if (!vm_) {
     // If there is no valid VM (possible via a move), there is no way that the
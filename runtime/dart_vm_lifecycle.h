@@ -33,6 +33,9 @@ class DartVMRef {
 
   DartVMRef(DartVMRef&&);
 
+  // Another strong reference to the same VM, for shells that share it.
+  DartVMRef(const DartVMRef&);
+
   ~DartVMRef();
 
   // This is an inherently racy way to check if a VM instance is running and
@@ -73,7 +76,7 @@ class DartVMRef {
   // Only used by Dart Isolate to register itself with the VM.
   static DartVM* GetRunningVM();
 
-  FML_DISALLOW_COPY_AND_ASSIGN(DartVMRef);
+  FML_DISALLOW_ASSIGN(DartVMRef);
 };
 
 }  // namespace flutter
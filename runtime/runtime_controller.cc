@@ -128,6 +128,29 @@ std::unique_ptr<RuntimeController> RuntimeController::Clone() const {
       ));
 }
 
+std::unique_ptr<RuntimeController> RuntimeController::Spawn(
+    RuntimeDelegate& client,
+    fml::WeakPtr<SnapshotDelegate> snapshot_delegate,
+    const WindowData& window_data) const {
+  return std::unique_ptr<RuntimeController>(new RuntimeController(
+      client,                        //
+      vm_,                           //
+      isolate_snapshot_,             //
+      task_runners_,                 //
+      std::move(snapshot_delegate),  //
+      io_manager_,                   //
+      unref_queue_,                  //
+      image_decoder_,                //
+      advisory_script_uri_,          //
+      advisory_script_entrypoint_,   //
+      idle_notification_callback_,   //
+      window_data,                   //
+      isolate_create_callback_,      //
+      isolate_shutdown_callback_,    //
+      persistent_isolate_data_       //
+      ));
+}
+
 bool RuntimeController::FlushRuntimeStateToIsolate() {
   return SetViewportMetrics(window_data_.viewport_metrics) &&
          SetLocales(window_data_.locale_data) &&
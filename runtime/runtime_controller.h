@@ -50,6 +50,14 @@ class RuntimeController final : public WindowClient {
 
   std::unique_ptr<RuntimeController> Clone() const;
 
+  // Creates a runtime controller with a new root isolate for another view.
+  // It shares the VM, the isolate snapshot, the IO manager and the image
+  // decoder of this one.
+  std::unique_ptr<RuntimeController> Spawn(
+      RuntimeDelegate& client,
+      fml::WeakPtr<SnapshotDelegate> snapshot_delegate,
+      const WindowData& window_data) const;
+
   bool SetViewportMetrics(const ViewportMetrics& metrics);
 
   bool SetLocales(const std::vector<std::string>& locale_data);
@@ -32,6 +32,10 @@ const std::string_view ServiceProtocol::kSetAssetBundlePathExtensionName =
     "_flutter.setAssetBundlePath";
 const std::string_view ServiceProtocol::kGetDisplayRefreshRateExtensionName =
     "_flutter.getDisplayRefreshRate";
+const std::string_view ServiceProtocol::kGetFrameRecordsExtensionName =
+    "_flutter.getFrameRecords";
+const std::string_view ServiceProtocol::kGetTraceBufferExtensionName =
+    "_flutter.getTraceBuffer";
 
 static constexpr std::string_view kViewIdPrefx = "_flutterView/";
 static constexpr std::string_view kListViewsExtensionName =
@@ -49,6 +53,8 @@ ServiceProtocol::ServiceProtocol()
           kFlushUIThreadTasksExtensionName,
           kSetAssetBundlePathExtensionName,
           kGetDisplayRefreshRateExtensionName,
+          kGetFrameRecordsExtensionName,
+          kGetTraceBufferExtensionName,
       }),
       handlers_mutex_(fml::SharedMutex::Create()) {}
 
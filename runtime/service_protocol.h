@@ -27,6 +27,8 @@ class ServiceProtocol {
   static const std::string_view kFlushUIThreadTasksExtensionName;
   static const std::string_view kSetAssetBundlePathExtensionName;
   static const std::string_view kGetDisplayRefreshRateExtensionName;
+  static const std::string_view kGetFrameRecordsExtensionName;
+  static const std::string_view kGetTraceBufferExtensionName;
 
   class Handler {
    public:
@@ -4,6 +4,7 @@
 
 #include "flutter/shell/common/animator.h"
 
+#include "flutter/fml/message_loop_task_queues.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/dart/runtime/include/dart_tools_api.h"
 
@@ -17,27 +18,42 @@ namespace {
 constexpr fml::TimeDelta kNotifyIdleTaskWaitTime =
     fml::TimeDelta::FromMilliseconds(51);
 
+// The deepest an adaptive pipeline gets. Beyond this, buffering more frames
+// only adds latency.
+constexpr uint32_t kMaxAdaptivePipelineDepth = 3;
+
+// The number of consecutive frames produced into an empty pipeline (about a
+// second at 60hz) after which an adaptive pipeline gets shallower again.
+constexpr int kUncontendedFramesBeforeShrinking = 60;
+
 }  // namespace
 
 Animator::Animator(Delegate& delegate,
                    TaskRunners task_runners,
-                   std::unique_ptr<VsyncWaiter> waiter)
+                   std::unique_ptr<VsyncWaiter> waiter,
+                   bool adaptive_pipeline_depth)
     : delegate_(delegate),
       task_runners_(std::move(task_runners)),
       waiter_(std::move(waiter)),
       last_begin_frame_time_(),
       dart_frame_deadline_(0),
 #if FLUTTER_SHELL_ENABLE_METAL
-      layer_tree_pipeline_(fml::MakeRefCounted<LayerTreePipeline>(2)),
+      layer_tree_pipeline_(fml::MakeRefCounted<LayerTreePipeline>(
+          adaptive_pipeline_depth ? 1 : 2,
+          kMaxAdaptivePipelineDepth)),
 #else   // FLUTTER_SHELL_ENABLE_METAL
       // TODO(dnfield): We should remove this logic and set the pipeline depth
       // back to 2 in this case. See
       // https://github.com/flutter/engine/pull/9132 for discussion.
       layer_tree_pipeline_(fml::MakeRefCounted<LayerTreePipeline>(
+          adaptive_pipeline_depth || task_runners.GetPlatformTaskRunner() ==
+                                         task_runners.GetGPUTaskRunner()
+              ? 1
+              : 2,
           task_runners.GetPlatformTaskRunner() ==
                   task_runners.GetGPUTaskRunner()
               ? 1
-              : 2)),
+              : kMaxAdaptivePipelineDepth)),
 #endif  // FLUTTER_SHELL_ENABLE_METAL
       pending_frame_semaphore_(1),
       frame_number_(1),
@@ -46,6 +62,8 @@ Animator::Animator(Delegate& delegate,
       frame_scheduled_(false),
       notify_idle_task_id_(0),
       dimension_change_pending_(false),
+      adaptive_pipeline_depth_(adaptive_pipeline_depth),
+      uncontended_frame_count_(0),
       weak_factory_(this) {
 }
 
@@ -97,6 +115,60 @@ static int64_t FxlToDartOrEarlier(fml::TimePoint time) {
   return (time - fxl_now).ToMicroseconds() + dart_now;
 }
 
+bool Animator::RasterizesOnPlatformThread() const {
+#if FLUTTER_SHELL_ENABLE_METAL
+  return false;
+#else   // FLUTTER_SHELL_ENABLE_METAL
+  // TODO(dnfield): Like the initial depth of the pipeline, this should go
+  // away. See https://github.com/flutter/engine/pull/9132 for discussion.
+  const auto& platform = task_runners_.GetPlatformTaskRunner();
+  const auto& gpu = task_runners_.GetGPUTaskRunner();
+  return platform == gpu ||
+         fml::MessageLoopTaskQueues::GetInstance()->Owns(
+             platform->GetTaskQueueId(), gpu->GetTaskQueueId());
+#endif  // FLUTTER_SHELL_ENABLE_METAL
+}
+
+Animator::LayerTreePipeline::ProducerContinuation
+Animator::ProduceFromPipeline() {
+  if (!adaptive_pipeline_depth_) {
+    return layer_tree_pipeline_->Produce();
+  }
+
+  const uint32_t max_depth = RasterizesOnPlatformThread()
+                                 ? 1
+                                 : layer_tree_pipeline_->GetMaxDepth();
+  uint32_t depth = layer_tree_pipeline_->GetDepth();
+  if (depth > max_depth) {
+    // The GPU task runner was merged into the platform one since the
+    // pipeline grew.
+    uncontended_frame_count_ = 0;
+    depth = max_depth;
+    layer_tree_pipeline_->SetDepth(depth);
+  }
+
+  auto continuation = layer_tree_pipeline_->Produce();
+  if (!continuation) {
+    uncontended_frame_count_ = 0;
+    if (depth < max_depth) {
+      // The rasterizer is falling behind. Trade a frame of latency for not
+      // dropping this one.
+      layer_tree_pipeline_->SetDepth(depth + 1);
+      continuation = layer_tree_pipeline_->Produce();
+    }
+    return continuation;
+  }
+
+  if (layer_tree_pipeline_->GetInFlightCount() > 1) {
+    uncontended_frame_count_ = 0;
+  } else if (++uncontended_frame_count_ >= kUncontendedFramesBeforeShrinking &&
+             depth > 1) {
+    uncontended_frame_count_ = 0;
+    layer_tree_pipeline_->SetDepth(depth - 1);
+  }
+  return continuation;
+}
+
 void Animator::BeginFrame(fml::TimePoint frame_start_time,
                           fml::TimePoint frame_target_time) {
   TRACE_EVENT_ASYNC_END0("flutter", "Frame Request Pending", frame_number_++);
@@ -117,12 +189,13 @@ void Animator::BeginFrame(fml::TimePoint frame_start_time,
     // We may already have a valid pipeline continuation in case a previous
     // begin frame did not result in an Animation::Render. Simply reuse that
     // instead of asking the pipeline for a fresh continuation.
-    producer_continuation_ = layer_tree_pipeline_->Produce();
+    producer_continuation_ = ProduceFromPipeline();
 
     if (!producer_continuation_) {
       // If we still don't have valid continuation, the pipeline is currently
       // full because the consumer is being too slow. Try again at the next
       // frame interval.
+      delegate_.OnAnimatorFrameDropped(frame_target_time);
       RequestFrame();
       return;
     }
@@ -133,6 +206,7 @@ void Animator::BeginFrame(fml::TimePoint frame_start_time,
   FML_DCHECK(producer_continuation_);
 
   last_begin_frame_time_ = frame_start_time;
+  last_frame_target_time_ = frame_target_time;
   dart_frame_deadline_ = FxlToDartOrEarlier(frame_target_time);
   {
     TRACE_EVENT2("flutter", "Framework Workload", "mode", "basic", "frame",
@@ -178,7 +252,8 @@ void Animator::Render(std::unique_ptr<flutter::LayerTree> layer_tree) {
 
   if (layer_tree) {
     // Note the frame time for instrumentation.
-    layer_tree->RecordBuildTime(last_begin_frame_time_);
+    layer_tree->RecordBuildTime(last_begin_frame_time_,
+                                last_frame_target_time_);
   }
 
   // Commit the pending continuation.
@@ -38,11 +38,19 @@ class Animator final {
         fml::RefPtr<Pipeline<flutter::LayerTree>> pipeline) = 0;
 
     virtual void OnAnimatorDrawLastLayerTree() = 0;
+
+    // Called when no frame could be built for a vsync because the pipeline
+    // was full.
+    virtual void OnAnimatorFrameDropped(fml::TimePoint frame_target_time) = 0;
   };
 
+  // With |adaptive_pipeline_depth|, the pipeline starts one frame deep and
+  // only grows when a frame would otherwise be dropped. It shrinks again once
+  // the rasterizer has kept up for a while.
   Animator(Delegate& delegate,
            TaskRunners task_runners,
-           std::unique_ptr<VsyncWaiter> waiter);
+           std::unique_ptr<VsyncWaiter> waiter,
+           bool adaptive_pipeline_depth = false);
 
   ~Animator();
 
@@ -92,11 +100,21 @@ class Animator final {
 
   const char* FrameParity();
 
+  // Returns a continuation from the pipeline, adjusting the depth of the
+  // pipeline first if it is adaptive.
+  LayerTreePipeline::ProducerContinuation ProduceFromPipeline();
+
+  // Whether frames are rasterized on the platform thread, either because the
+  // platform and GPU task runners are the same or because they are merged.
+  // The pipeline is then kept one frame deep.
+  bool RasterizesOnPlatformThread() const;
+
   Delegate& delegate_;
   TaskRunners task_runners_;
   std::shared_ptr<VsyncWaiter> waiter_;
 
   fml::TimePoint last_begin_frame_time_;
+  fml::TimePoint last_frame_target_time_;
   int64_t dart_frame_deadline_;
   fml::RefPtr<LayerTreePipeline> layer_tree_pipeline_;
   fml::Semaphore pending_frame_semaphore_;
@@ -109,6 +127,10 @@ class Animator final {
   bool dimension_change_pending_;
   SkISize last_layer_tree_size_;
   std::deque<uint64_t> trace_flow_ids_;
+  const bool adaptive_pipeline_depth_;
+  // The number of consecutive frames produced into an otherwise empty
+  // pipeline.
+  int uncontended_frame_count_;
 
   fml::WeakPtrFactory<Animator> weak_factory_;
 
@@ -35,6 +35,22 @@ static constexpr char kLocalizationChannel[] = "flutter/localization";
 static constexpr char kSettingsChannel[] = "flutter/settings";
 static constexpr char kIsolateChannel[] = "flutter/isolate";
 
+Engine::Engine(Delegate& delegate,
+               TaskRunners task_runners,
+               Settings settings,
+               std::unique_ptr<Animator> animator,
+               std::shared_ptr<FontCollection> font_collection,
+               std::shared_ptr<ImageDecoder> image_decoder)
+    : delegate_(delegate),
+      settings_(std::move(settings)),
+      animator_(std::move(animator)),
+      activity_running_(true),
+      have_surface_(false),
+      font_collection_(std::move(font_collection)),
+      image_decoder_(std::move(image_decoder)),
+      task_runners_(std::move(task_runners)),
+      weak_factory_(this) {}
+
 Engine::Engine(Delegate& delegate,
                const PointerDataDispatcherMaker& dispatcher_maker,
                DartVM& vm,
@@ -46,16 +62,17 @@ Engine::Engine(Delegate& delegate,
                fml::WeakPtr<IOManager> io_manager,
                fml::RefPtr<SkiaUnrefQueue> unref_queue,
                fml::WeakPtr<SnapshotDelegate> snapshot_delegate)
-    : delegate_(delegate),
-      settings_(std::move(settings)),
-      animator_(std::move(animator)),
-      activity_running_(true),
-      have_surface_(false),
-      image_decoder_(task_runners,
-                     vm.GetConcurrentWorkerTaskRunner(),
-                     io_manager),
-      task_runners_(std::move(task_runners)),
-      weak_factory_(this) {
+    : Engine(delegate,
+             task_runners,
+             std::move(settings),
+             std::move(animator),
+             std::make_shared<FontCollection>(),
+             std::make_shared<ImageDecoder>(
+                 task_runners,
+                 vm.GetConcurrentWorkerTaskRunner(),
+                 io_manager,
+                 // Scalars are left intact by moving |settings| above.
+                 settings.decoded_image_cache_max_bytes)) {
   // Runtime controller is initialized here because it takes a reference to this
   // object as its delegate. The delegate may be called in the constructor and
   // we want to be fully initilazed by that point.
@@ -67,7 +84,7 @@ Engine::Engine(Delegate& delegate,
       std::move(snapshot_delegate),
       std::move(io_manager),                 // io manager
       std::move(unref_queue),                // Skia unref queue
-      image_decoder_.GetWeakPtr(),           // image decoder
+      image_decoder_->GetWeakPtr(),          // image decoder
       settings_.advisory_script_uri,         // advisory script uri
       settings_.advisory_script_entrypoint,  // advisory script entrypoint
       settings_.idle_notification_callback,  // idle notification callback
@@ -80,6 +97,26 @@ Engine::Engine(Delegate& delegate,
   pointer_data_dispatcher_ = dispatcher_maker(*this);
 }
 
+std::unique_ptr<Engine> Engine::Spawn(
+    Delegate& delegate,
+    const PointerDataDispatcherMaker& dispatcher_maker,
+    const WindowData window_data,
+    Settings settings,
+    std::unique_ptr<Animator> animator,
+    fml::WeakPtr<SnapshotDelegate> snapshot_delegate) const {
+  TRACE_EVENT0("flutter", "Engine::Spawn");
+  auto engine = std::unique_ptr<Engine>(
+      new Engine(delegate, task_runners_, std::move(settings),
+                 std::move(animator), font_collection_, image_decoder_));
+  engine->runtime_controller_ = runtime_controller_->Spawn(
+      *engine, std::move(snapshot_delegate), window_data);
+  engine->pointer_data_dispatcher_ = dispatcher_maker(*engine);
+  engine->asset_manager_ = asset_manager_;
+  engine->font_collection_is_inherited_ = true;
+  engine->spawner_asset_manager_ = asset_manager_;
+  return engine;
+}
+
 Engine::~Engine() = default;
 
 float Engine::GetDisplayRefreshRate() const {
@@ -102,11 +139,21 @@ bool Engine::UpdateAssetManager(
     return false;
   }
 
+  if (font_collection_is_inherited_) {
+    if (asset_manager_ == spawner_asset_manager_) {
+      // Its fonts are already in the collection.
+      return true;
+    }
+    font_collection_ = std::make_shared<FontCollection>();
+    font_collection_is_inherited_ = false;
+    spawner_asset_manager_ = nullptr;
+  }
+
   // Using libTXT as the text engine.
-  font_collection_.RegisterFonts(asset_manager_);
+  font_collection_->RegisterFonts(asset_manager_);
 
   if (settings_.use_test_fonts) {
-    font_collection_.RegisterTestFonts();
+    font_collection_->RegisterTestFonts();
   }
 
   return true;
@@ -236,6 +283,11 @@ void Engine::NotifyIdle(int64_t deadline) {
   runtime_controller_->NotifyIdle(deadline);
 }
 
+void Engine::NotifyLowMemoryWarning() {
+  TRACE_EVENT0("flutter", "Engine::NotifyLowMemoryWarning");
+  image_decoder_->PurgeCache();
+}
+
 std::pair<bool, uint32_t> Engine::GetUIIsolateReturnCode() {
   return runtime_controller_->GetRootIsolateReturnCode();
 }
@@ -311,7 +363,8 @@ void Engine::DispatchPlatformMessage(fml::RefPtr<PlatformMessage> message) {
 
 bool Engine::HandleLifecyclePlatformMessage(PlatformMessage* message) {
   const auto& data = message->data();
-  std::string state(reinterpret_cast<const char*>(data.data()), data.size());
+  std::string state(reinterpret_cast<const char*>(data.GetMapping()),
+                    data.GetSize());
   if (state == "AppLifecycleState.paused" ||
       state == "AppLifecycleState.detached") {
     activity_running_ = false;
@@ -338,7 +391,8 @@ bool Engine::HandleNavigationPlatformMessage(
   const auto& data = message->data();
 
   rapidjson::Document document;
-  document.Parse(reinterpret_cast<const char*>(data.data()), data.size());
+  document.Parse(reinterpret_cast<const char*>(data.GetMapping()),
+                 data.GetSize());
   if (document.HasParseError() || !document.IsObject())
     return false;
   auto root = document.GetObject();
@@ -354,7 +408,8 @@ bool Engine::HandleLocalizationPlatformMessage(PlatformMessage* message) {
   const auto& data = message->data();
 
   rapidjson::Document document;
-  document.Parse(reinterpret_cast<const char*>(data.data()), data.size());
+  document.Parse(reinterpret_cast<const char*>(data.GetMapping()),
+                 data.GetSize());
   if (document.HasParseError() || !document.IsObject())
     return false;
   auto root = document.GetObject();
@@ -386,7 +441,8 @@ bool Engine::HandleLocalizationPlatformMessage(PlatformMessage* message) {
 
 void Engine::HandleSettingsPlatformMessage(PlatformMessage* message) {
   const auto& data = message->data();
-  std::string jsonData(reinterpret_cast<const char*>(data.data()), data.size());
+  std::string jsonData(reinterpret_cast<const char*>(data.GetMapping()),
+                       data.GetSize());
   if (runtime_controller_->SetUserSettingsData(std::move(jsonData)) &&
       have_surface_) {
     ScheduleFrame();
@@ -471,7 +527,7 @@ void Engine::SetNeedsReportTimings(bool needs_reporting) {
 }
 
 FontCollection& Engine::GetFontCollection() {
-  return font_collection_;
+  return *font_collection_;
 }
 
 void Engine::DoDispatchPacket(std::unique_ptr<PointerDataPacket> packet,
@@ -492,8 +548,8 @@ void Engine::HandleAssetPlatformMessage(fml::RefPtr<PlatformMessage> message) {
     return;
   }
   const auto& data = message->data();
-  std::string asset_name(reinterpret_cast<const char*>(data.data()),
-                         data.size());
+  std::string asset_name(reinterpret_cast<const char*>(data.GetMapping()),
+                         data.GetSize());
 
   if (asset_manager_) {
     std::unique_ptr<fml::Mapping> asset_mapping =
@@ -283,6 +283,39 @@ class Engine final : public RuntimeDelegate, PointerDataDispatcher::Delegate {
          fml::RefPtr<SkiaUnrefQueue> unref_queue,
          fml::WeakPtr<SnapshotDelegate> snapshot_delegate);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Creates an engine for another view that shares the VM, the
+  ///             isolate snapshot, the IO manager, the font collection and the
+  ///             image decoder of this one. It has its own root isolate, which
+  ///             is created but not yet launched. Called by the shell on the UI
+  ///             task runner, which both engines share.
+  ///
+  ///             The fonts of the asset manager of this engine are already in
+  ///             the shared font collection, so running the spawned engine
+  ///             with a configuration that uses the same asset manager does
+  ///             not register them again. Running it with another asset
+  ///             manager gives it a font collection of its own, so that its
+  ///             fonts are not added to the collection of this engine.
+  ///
+  /// @param[in]  delegate           The delegate of the spawned engine.
+  /// @param[in]  dispatcher_maker   The callback that creates the pointer
+  ///                                data dispatcher of the spawned engine.
+  /// @param[in]  window_data        The window data of the new view.
+  /// @param[in]  settings           The settings of the spawned engine.
+  /// @param[in]  animator           The animator of the spawned engine.
+  /// @param[in]  snapshot_delegate  The delegate used to snapshot scenes of
+  ///                                the new view.
+  ///
+  /// @return     The spawned engine.
+  ///
+  std::unique_ptr<Engine> Spawn(
+      Delegate& delegate,
+      const PointerDataDispatcherMaker& dispatcher_maker,
+      const WindowData window_data,
+      Settings settings,
+      std::unique_ptr<Animator> animator,
+      fml::WeakPtr<SnapshotDelegate> snapshot_delegate) const;
+
   //----------------------------------------------------------------------------
   /// @brief      Destroys the engine engine. Called by the shell on the UI task
   ///             runner. The running root isolate is terminated and will no
@@ -472,6 +505,15 @@ class Engine final : public RuntimeDelegate, PointerDataDispatcher::Delegate {
   ///
   void NotifyIdle(int64_t deadline);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Notifies the engine that the platform is running low on
+  ///             memory. The engine releases the caches it can rebuild, like
+  ///             the decoded images kept by the image decoder.
+  ///
+  /// @attention  This method must be called on the UI task runner.
+  ///
+  void NotifyLowMemoryWarning();
+
   //----------------------------------------------------------------------------
   /// @brief      Dart code cannot fully measure the time it takes for a
   ///             specific frame to be rendered. This is because Dart code only
@@ -747,11 +789,25 @@ class Engine final : public RuntimeDelegate, PointerDataDispatcher::Delegate {
   std::shared_ptr<AssetManager> asset_manager_;
   bool activity_running_;
   bool have_surface_;
-  FontCollection font_collection_;
-  ImageDecoder image_decoder_;
+  // Shared with the engines spawned from this one.
+  std::shared_ptr<FontCollection> font_collection_;
+  // Whether |font_collection_| is that of the engine this one was spawned
+  // from, which holds the fonts of |spawner_asset_manager_|.
+  bool font_collection_is_inherited_ = false;
+  std::shared_ptr<AssetManager> spawner_asset_manager_;
+  std::shared_ptr<ImageDecoder> image_decoder_;
   TaskRunners task_runners_;
   fml::WeakPtrFactory<Engine> weak_factory_;
 
+  // Sets up everything but the runtime controller and the pointer data
+  // dispatcher, which take a reference to the engine.
+  Engine(Delegate& delegate,
+         TaskRunners task_runners,
+         Settings settings,
+         std::unique_ptr<Animator> animator,
+         std::shared_ptr<FontCollection> font_collection,
+         std::shared_ptr<ImageDecoder> image_decoder);
+
   // |RuntimeDelegate|
   std::string DefaultRouteName() override;
 
@@ -16,6 +16,7 @@
 #include "flutter/fml/paths.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/shell/version/version.h"
+#include "minikin/Layout.h"
 
 namespace flutter {
 
@@ -45,6 +46,7 @@ bool PersistentCache::gIsReadOnly = false;
 
 std::atomic<bool> PersistentCache::cache_sksl_ = false;
 std::atomic<bool> PersistentCache::strategy_set_ = false;
+std::atomic<bool> PersistentCache::cache_shaped_runs_ = false;
 
 void PersistentCache::SetCacheSkSL(bool value) {
   if (strategy_set_ && value != cache_sksl_) {
@@ -65,6 +67,9 @@ PersistentCache* PersistentCache::GetCacheForProcess() {
 
 void PersistentCache::ResetCacheForProcess() {
   std::scoped_lock lock(instance_mutex_);
+  // The old cache goes first so that it does not remove the layout store of
+  // the new one.
+  gPersistentCache.reset();
   gPersistentCache.reset(new PersistentCache(gIsReadOnly));
   strategy_set_ = false;
 }
@@ -102,79 +107,92 @@ static std::shared_ptr<fml::UniqueFD> MakeCacheDirectory(
 }
 }  // namespace
 
+// Enough for the words of the first screens an app shows, which are the ones
+// whose layout delays a launch.
+static constexpr size_t kShapedRunCacheMaxBytes = 1024 * 1024;
+
+// Words are shaped in bursts as screens of text are laid out, so they are
+// written once a burst is likely over rather than for every word.
+static constexpr fml::TimeDelta kShapedRunFlushDelay =
+    fml::TimeDelta::FromSeconds(2);
+
+std::shared_ptr<txt::ShapedRunCache> PersistentCache::OpenShapedRunCache(
+    std::shared_ptr<fml::UniqueFD> directory) {
+  TRACE_EVENT0("flutter", "PersistentCache::OpenShapedRunCache");
+  // The scheduler only refers to the cache weakly, since the text layout may
+  // still hold the cache after the persistent cache that opened it is gone.
+  auto weak_shaped_runs =
+      std::make_shared<std::weak_ptr<txt::ShapedRunCache>>();
+  auto shaped_runs = txt::ShapedRunCache::Open(
+      std::move(directory), kShapedRunCacheMaxBytes, false,
+      [weak_shaped_runs]() {
+        auto worker = GetCacheForProcess()->GetWorkerTaskRunner();
+        if (!worker) {
+          return false;
+        }
+        worker->PostDelayedTask(
+            [weak_shaped_runs = *weak_shaped_runs]() {
+              if (auto shaped_runs = weak_shaped_runs.lock()) {
+                if (!shaped_runs->Flush()) {
+                  FML_DLOG(WARNING) << "Could not write the shaped runs.";
+                }
+              }
+            },
+            kShapedRunFlushDelay);
+        return true;
+      });
+  *weak_shaped_runs = shaped_runs;
+  return shaped_runs;
+}
+
 std::vector<PersistentCache::SkSLCache> PersistentCache::LoadSkSLs() {
   TRACE_EVENT0("flutter", "PersistentCache::LoadSkSLs");
-  std::vector<PersistentCache::SkSLCache> result;
-  if (!IsValid()) {
-    return result;
+  if (!IsValid() || !sksl_pack_) {
+    return {};
   }
-  fml::FileVisitor visitor = [&result](const fml::UniqueFD& directory,
-                                       const std::string& filename) {
-    std::pair<bool, std::string> decode_result = fml::Base32Decode(filename);
-    if (!decode_result.first) {
-      FML_LOG(ERROR) << "Base32 can't decode: " << filename;
-      return true;  // continue to visit other files
-    }
-    const std::string& data_string = decode_result.second;
-    sk_sp<SkData> key =
-        SkData::MakeWithCopy(data_string.data(), data_string.length());
-    sk_sp<SkData> data = LoadFile(directory, filename);
-    if (data != nullptr) {
-      result.push_back({key, data});
-    } else {
-      FML_LOG(ERROR) << "Failed to load: " << filename;
-    }
-    return true;
-  };
-  fml::VisitFiles(*sksl_cache_directory_, visitor);
-  return result;
+  return sksl_pack_->GetEntries();
 }
 
 PersistentCache::PersistentCache(bool read_only)
     : is_read_only_(read_only),
       cache_directory_(MakeCacheDirectory(cache_base_path_, read_only, false)),
       sksl_cache_directory_(
-          MakeCacheDirectory(cache_base_path_, read_only, true)) {
+          MakeCacheDirectory(cache_base_path_, read_only, true)),
+      pack_(PersistentCachePack::Open(cache_directory_, read_only)),
+      sksl_pack_(PersistentCachePack::Open(sksl_cache_directory_, read_only)),
+      shaped_runs_(cache_shaped_runs_ && !read_only
+                       ? OpenShapedRunCache(cache_directory_)
+                       : nullptr) {
   if (!IsValid()) {
     FML_LOG(WARNING) << "Could not acquire the persistent cache directory. "
                         "Caching of GPU resources on disk is disabled.";
   }
+  if (shaped_runs_) {
+    minikin::Layout::setLayoutStore(shaped_runs_);
+  }
 }
 
-PersistentCache::~PersistentCache() = default;
+PersistentCache::~PersistentCache() {
+  if (shaped_runs_) {
+    minikin::Layout::setLayoutStore(nullptr);
+  }
+}
 
 bool PersistentCache::IsValid() const {
   return cache_directory_ && cache_directory_->is_valid();
 }
 
-sk_sp<SkData> PersistentCache::LoadFile(const fml::UniqueFD& dir,
-                                        const std::string& file_name) {
-  auto file = fml::OpenFileReadOnly(dir, file_name.c_str());
-  if (!file.is_valid()) {
-    return nullptr;
-  }
-  auto mapping = std::make_unique<fml::FileMapping>(file);
-  if (mapping->GetSize() == 0) {
-    return nullptr;
-  }
-  return SkData::MakeWithCopy(mapping->GetMapping(), mapping->GetSize());
-}
-
 // |GrContextOptions::PersistentCache|
 sk_sp<SkData> PersistentCache::load(const SkData& key) {
   TRACE_EVENT0("flutter", "PersistentCacheLoad");
-  if (!IsValid()) {
+  if (!IsValid() || !pack_) {
     return nullptr;
   }
-  auto file_name = SkKeyToFilePath(key);
-  if (file_name.size() == 0) {
-    return nullptr;
-  }
-  auto result = PersistentCache::LoadFile(*cache_directory_, file_name);
+  auto result = pack_->Load(key);
   if (result != nullptr) {
     TRACE_EVENT0("flutter", "PersistentCacheLoadHit");
   } else {
-    FML_LOG(INFO) << "PersistentCache::load failed: " << file_name;
+    FML_LOG(INFO) << "PersistentCache::load failed: " << SkKeyToFilePath(key);
   }
   return result;
 }
@@ -209,6 +227,32 @@ static void PersistentCacheStore(fml::RefPtr<fml::TaskRunner> worker,
   }
 }
 
+// Appends the entries stored in |pack| to its file and compacts the file if
+// it has grown too much.
+static void PersistentCacheFlush(fml::RefPtr<fml::TaskRunner> worker,
+                                 std::shared_ptr<PersistentCachePack> pack) {
+  auto task = [pack]() {
+    TRACE_EVENT0("flutter", "PersistentCacheStore");
+    if (!pack->Flush()) {
+      FML_DLOG(WARNING)
+          << "Could not write cache contents to persistent store.";
+    }
+    if (pack->NeedsCompaction() && !pack->Compact()) {
+      FML_DLOG(WARNING) << "Could not compact the persistent store.";
+    }
+  };
+
+  if (!worker) {
+    FML_LOG(WARNING)
+        << "The persistent cache has no available workers. Performing the task "
+           "on the current thread. This slow operation is going to occur on a "
+           "frame workload.";
+    task();
+  } else {
+    worker->PostTask(std::move(task));
+  }
+}
+
 // |GrContextOptions::PersistentCache|
 void PersistentCache::store(const SkData& key, const SkData& data) {
   stored_new_shaders_ = true;
@@ -221,22 +265,15 @@ void PersistentCache::store(const SkData& key, const SkData& data) {
     return;
   }
 
-  auto file_name = SkKeyToFilePath(key);
-
-  if (file_name.size() == 0) {
+  const auto& pack = cache_sksl_ ? sksl_pack_ : pack_;
+  if (!pack || key.size() == 0 || data.size() == 0) {
     return;
   }
 
-  auto mapping = std::make_unique<fml::DataMapping>(
-      std::vector<uint8_t>{data.bytes(), data.bytes() + data.size()});
-
-  if (mapping == nullptr || mapping->GetSize() == 0) {
-    return;
+  // Stores made while a flush is already scheduled are written by that flush.
+  if (pack->Store(key, SkData::MakeWithCopy(data.data(), data.size()))) {
+    PersistentCacheFlush(GetWorkerTaskRunner(), pack);
   }
-
-  PersistentCacheStore(GetWorkerTaskRunner(),
-                       cache_sksl_ ? sksl_cache_directory_ : cache_directory_,
-                       std::move(file_name), std::move(mapping));
 }
 
 void PersistentCache::DumpSkp(const SkData& data) {
@@ -259,8 +296,26 @@ void PersistentCache::DumpSkp(const SkData& data) {
 
 void PersistentCache::AddWorkerTaskRunner(
     fml::RefPtr<fml::TaskRunner> task_runner) {
-  std::scoped_lock lock(worker_task_runners_mutex_);
-  worker_task_runners_.insert(task_runner);
+  {
+    std::scoped_lock lock(worker_task_runners_mutex_);
+    worker_task_runners_.insert(task_runner);
+  }
+
+  // Entries imported from the old layout when the packs were opened are
+  // written as soon as there is a worker to do it.
+  for (const auto& pack : {pack_, sksl_pack_}) {
+    if (pack && task_runner && !is_read_only_ && pack->HasPendingWrites()) {
+      PersistentCacheFlush(task_runner, pack);
+    }
+  }
+  if (shaped_runs_ && task_runner && !is_read_only_ &&
+      shaped_runs_->HasPendingWrites()) {
+    task_runner->PostTask([shaped_runs = shaped_runs_]() {
+      if (!shaped_runs->Flush()) {
+        FML_DLOG(WARNING) << "Could not write the shaped runs.";
+      }
+    });
+  }
 }
 
 void PersistentCache::RemoveWorkerTaskRunner(
@@ -12,7 +12,9 @@
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_runner.h"
 #include "flutter/fml/unique_fd.h"
+#include "flutter/shell/common/persistent_cache_pack.h"
 #include "third_party/skia/include/gpu/GrContextOptions.h"
+#include "txt/shaped_run_cache.h"
 
 namespace flutter {
 
@@ -20,6 +22,12 @@ namespace flutter {
 ///
 /// This is mainly used for Shaders but is also written to by Dart.  It is
 /// thread-safe for reading and writing from multiple threads.
+///
+/// Entries are kept in a |PersistentCachePack| per directory, which is
+/// written to on the worker task runners. When enabled with
+/// |SetCacheShapedRuns|, the cache directory also holds the words shaped by
+/// the text layout of earlier launches, which the layout of this process reads
+/// through |txt::ShapedRunCache|.
 class PersistentCache : public GrContextOptions::PersistentCache {
  public:
   // Mutable static switch that can be set before GetCacheForProcess. If true,
@@ -61,6 +69,15 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   static void SetCacheSkSL(bool value);
   static void MarkStrategySet() { strategy_set_ = true; }
 
+  // Whether caches created after this is set by |GetCacheForProcess| or
+  // |ResetCacheForProcess| keep the words shaped by the text layout. Read-only
+  // caches never do.
+  static bool cache_shaped_runs() { return cache_shaped_runs_; }
+  static void SetCacheShapedRuns(bool value) { cache_shaped_runs_ = value; }
+
+  // Whether this cache keeps the words shaped by the text layout.
+  bool IsCachingShapedRuns() const { return shaped_runs_ != nullptr; }
+
  private:
   static std::string cache_base_path_;
 
@@ -77,18 +94,20 @@ class PersistentCache : public GrContextOptions::PersistentCache {
   // strategy_set_ becomes true.
   static std::atomic<bool> strategy_set_;
 
+  static std::atomic<bool> cache_shaped_runs_;
+
   const bool is_read_only_;
   const std::shared_ptr<fml::UniqueFD> cache_directory_;
   const std::shared_ptr<fml::UniqueFD> sksl_cache_directory_;
+  const std::shared_ptr<PersistentCachePack> pack_;
+  const std::shared_ptr<PersistentCachePack> sksl_pack_;
+  const std::shared_ptr<txt::ShapedRunCache> shaped_runs_;
   mutable std::mutex worker_task_runners_mutex_;
   std::multiset<fml::RefPtr<fml::TaskRunner>> worker_task_runners_;
 
   bool stored_new_shaders_ = false;
   bool is_dumping_skp_ = false;
 
-  static sk_sp<SkData> LoadFile(const fml::UniqueFD& dir,
-                                const std::string& filen_ame);
-
   bool IsValid() const;
 
   PersistentCache(bool read_only = false);
@@ -98,6 +117,11 @@ class PersistentCache : public GrContextOptions::PersistentCache {
 
   fml::RefPtr<fml::TaskRunner> GetWorkerTaskRunner() const;
 
+  // Opens the shaped words in |directory|, which are flushed on the workers of
+  // the cache for the process some time after they are stored.
+  static std::shared_ptr<txt::ShapedRunCache> OpenShapedRunCache(
+      std::shared_ptr<fml::UniqueFD> directory);
+
   FML_DISALLOW_COPY_AND_ASSIGN(PersistentCache);
 };
 
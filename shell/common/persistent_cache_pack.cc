@@ -0,0 +1,440 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/persistent_cache_pack.h"
+
+#include <cstring>
+
+#include "flutter/fml/base32.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+namespace {
+
+constexpr char kPackMagic[8] = {'F', 'L', 'T', 'R', 'P', 'A', 'C', 'K'};
+constexpr uint32_t kPackVersion = 1;
+
+struct PackHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+};
+
+// Followed by the key and then the value.
+struct RecordHeader {
+  uint32_t key_size;
+  uint32_t value_size;
+  // Of the key and the value, to tell records that were only partially
+  // written.
+  uint32_t checksum;
+};
+
+// FNV-1a.
+uint32_t Checksum(const uint8_t* key,
+                  size_t key_size,
+                  const uint8_t* value,
+                  size_t value_size) {
+  uint32_t hash = 2166136261u;
+  auto add = [&hash](const uint8_t* bytes, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      hash = (hash ^ bytes[i]) * 16777619u;
+    }
+  };
+  add(key, key_size);
+  add(value, value_size);
+  return hash;
+}
+
+void AppendBytes(std::vector<uint8_t>& buffer,
+                 const void* bytes,
+                 size_t size) {
+  const auto* begin = static_cast<const uint8_t*>(bytes);
+  buffer.insert(buffer.end(), begin, begin + size);
+}
+
+void AppendPackHeader(std::vector<uint8_t>& buffer) {
+  PackHeader header = {};
+  std::memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+  header.version = kPackVersion;
+  AppendBytes(buffer, &header, sizeof(header));
+}
+
+void ReleaseMapping(const void* data, void* context) {
+  delete static_cast<std::shared_ptr<fml::FileMapping>*>(context);
+}
+
+}  // namespace
+
+std::shared_ptr<PersistentCachePack> PersistentCachePack::Open(
+    std::shared_ptr<fml::UniqueFD> directory,
+    bool read_only) {
+  if (!directory || !directory->is_valid()) {
+    return nullptr;
+  }
+  TRACE_EVENT0("flutter", "PersistentCachePack::Open");
+  return std::shared_ptr<PersistentCachePack>(
+      new PersistentCachePack(std::move(directory), read_only));
+}
+
+PersistentCachePack::PersistentCachePack(
+    std::shared_ptr<fml::UniqueFD> directory,
+    bool read_only)
+    : directory_(std::move(directory)), read_only_(read_only) {
+  ReadFile();
+  ImportFiles();
+}
+
+PersistentCachePack::~PersistentCachePack() = default;
+
+void PersistentCachePack::ReadFile() {
+  auto file = fml::OpenFileReadOnly(*directory_, kFileName);
+  if (!file.is_valid()) {
+    return;
+  }
+
+  auto mapping = std::make_shared<fml::FileMapping>(file);
+  const size_t size = mapping->GetSize();
+  if (!mapping->IsValid() || size < sizeof(PackHeader)) {
+    return;
+  }
+
+  const uint8_t* base = mapping->GetMapping();
+  PackHeader header;
+  std::memcpy(&header, base, sizeof(header));
+  if (std::memcmp(header.magic, kPackMagic, sizeof(kPackMagic)) != 0 ||
+      header.version != kPackVersion) {
+    FML_LOG(WARNING) << "Ignoring a persistent cache pack of an unknown "
+                        "format. It will be replaced.";
+    return;
+  }
+
+  size_t offset = sizeof(PackHeader);
+  while (size - offset >= sizeof(RecordHeader)) {
+    RecordHeader record;
+    std::memcpy(&record, base + offset, sizeof(record));
+    const size_t record_size = sizeof(RecordHeader) +
+                               static_cast<size_t>(record.key_size) +
+                               static_cast<size_t>(record.value_size);
+    if (record.key_size == 0 || size - offset < record_size) {
+      break;
+    }
+
+    const uint8_t* key = base + offset + sizeof(RecordHeader);
+    const uint8_t* value = key + record.key_size;
+    if (Checksum(key, record.key_size, value, record.value_size) !=
+        record.checksum) {
+      break;
+    }
+
+    Location location;
+    location.offset = value - base;
+    location.size = record.value_size;
+    location.record_size = record_size;
+    auto& indexed = index_[std::string(reinterpret_cast<const char*>(key),
+                                       record.key_size)];
+    replaced_bytes_ += indexed.record_size;
+    indexed = location;
+
+    offset += record_size;
+  }
+
+  if (offset < size) {
+    FML_LOG(WARNING) << "Ignoring " << size - offset
+                     << " bytes at the end of the persistent cache pack.";
+  }
+
+  file_size_ = offset;
+  mapping_ = std::move(mapping);
+}
+
+void PersistentCachePack::ImportFiles() {
+  fml::VisitFiles(*directory_, [this](const fml::UniqueFD& directory,
+                                      const std::string& filename) {
+    // Other files, like SKP dumps and the pack itself, are not base32 names.
+    std::pair<bool, std::string> decode_result = fml::Base32Decode(filename);
+    if (!decode_result.first || decode_result.second.empty() ||
+        fml::IsDirectory(directory, filename.c_str())) {
+      return true;
+    }
+
+    std::string& key = decode_result.second;
+    if (index_.count(key) == 0 && unmapped_.count(key) == 0) {
+      auto mapping = fml::FileMapping::CreateReadOnly(directory, filename);
+      if (!mapping || mapping->GetSize() == 0) {
+        FML_LOG(ERROR) << "Failed to load: " << filename;
+        return true;
+      }
+      unmapped_[key] =
+          SkData::MakeWithCopy(mapping->GetMapping(), mapping->GetSize());
+      if (!read_only_) {
+        pending_.insert(key);
+      }
+    }
+
+    if (!read_only_) {
+      imported_files_.push_back(filename);
+    }
+    return true;
+  });
+}
+
+sk_sp<SkData> PersistentCachePack::LoadFromMappingLocked(
+    const Location& location) const {
+  // The data keeps the mapping alive, even if the pack is compacted or
+  // collected in the meantime.
+  auto* context = new std::shared_ptr<fml::FileMapping>(mapping_);
+  return SkData::MakeWithProc(mapping_->GetMapping() + location.offset,
+                              location.size, &ReleaseMapping, context);
+}
+
+sk_sp<SkData> PersistentCachePack::Load(const SkData& key) const {
+  std::string key_string(static_cast<const char*>(key.data()), key.size());
+  std::scoped_lock lock(mutex_);
+  auto unmapped = unmapped_.find(key_string);
+  if (unmapped != unmapped_.end()) {
+    return unmapped->second;
+  }
+  auto found = index_.find(key_string);
+  if (found == index_.end()) {
+    return nullptr;
+  }
+  return LoadFromMappingLocked(found->second);
+}
+
+bool PersistentCachePack::Store(const SkData& key, sk_sp<SkData> value) {
+  if (key.size() == 0 || !value) {
+    return false;
+  }
+  std::string key_string(static_cast<const char*>(key.data()), key.size());
+  std::scoped_lock lock(mutex_);
+  unmapped_[key_string] = std::move(value);
+  if (read_only_) {
+    return false;
+  }
+  pending_.insert(std::move(key_string));
+  const bool schedule_flush = !flush_scheduled_;
+  flush_scheduled_ = true;
+  return schedule_flush;
+}
+
+std::vector<PersistentCachePack::Entry> PersistentCachePack::GetEntries()
+    const {
+  std::scoped_lock lock(mutex_);
+  std::vector<Entry> entries;
+  entries.reserve(index_.size() + unmapped_.size());
+  for (const auto& [key, location] : index_) {
+    if (unmapped_.count(key) == 0) {
+      entries.emplace_back(SkData::MakeWithCopy(key.data(), key.size()),
+                           LoadFromMappingLocked(location));
+    }
+  }
+  for (const auto& [key, value] : unmapped_) {
+    entries.emplace_back(SkData::MakeWithCopy(key.data(), key.size()), value);
+  }
+  return entries;
+}
+
+size_t PersistentCachePack::GetEntryCount() const {
+  std::scoped_lock lock(mutex_);
+  size_t count = index_.size();
+  for (const auto& entry : unmapped_) {
+    if (index_.count(entry.first) == 0) {
+      count++;
+    }
+  }
+  return count;
+}
+
+bool PersistentCachePack::HasPendingWrites() const {
+  std::scoped_lock lock(mutex_);
+  return !pending_.empty() || !imported_files_.empty();
+}
+
+void PersistentCachePack::RemapLocked(
+    std::shared_ptr<fml::FileMapping> mapping,
+    std::unordered_map<std::string, Location> locations,
+    const std::vector<std::pair<std::string, sk_sp<SkData>>>& written) {
+  mapping_ = std::move(mapping);
+  for (auto& [key, location] : locations) {
+    auto& indexed = index_[key];
+    replaced_bytes_ += indexed.record_size;
+    indexed = location;
+  }
+  // Entries stored again while they were being written stay unmapped until
+  // the next flush.
+  for (const auto& [key, value] : written) {
+    auto found = unmapped_.find(key);
+    if (found != unmapped_.end() && found->second == value) {
+      unmapped_.erase(found);
+    }
+  }
+}
+
+bool PersistentCachePack::Flush() {
+  if (read_only_) {
+    return false;
+  }
+
+  std::scoped_lock file_lock(file_mutex_);
+
+  std::vector<std::pair<std::string, sk_sp<SkData>>> written;
+  std::vector<std::string> imported_files;
+  size_t base = 0;
+  {
+    std::scoped_lock lock(mutex_);
+    flush_scheduled_ = false;
+    written.reserve(pending_.size());
+    for (const auto& key : pending_) {
+      written.emplace_back(key, unmapped_[key]);
+    }
+    pending_.clear();
+    imported_files.swap(imported_files_);
+    base = file_size_;
+  }
+
+  if (!written.empty()) {
+    TRACE_EVENT0("flutter", "PersistentCachePack::Flush");
+
+    std::vector<uint8_t> buffer;
+    if (base == 0) {
+      AppendPackHeader(buffer);
+    }
+    std::unordered_map<std::string, Location> locations;
+    for (const auto& [key, value] : written) {
+      RecordHeader record;
+      record.key_size = key.size();
+      record.value_size = value->size();
+      record.checksum = Checksum(reinterpret_cast<const uint8_t*>(key.data()),
+                                 key.size(), value->bytes(), value->size());
+      Location location;
+      location.offset = base + buffer.size() + sizeof(record) + key.size();
+      location.size = value->size();
+      location.record_size = sizeof(record) + key.size() + value->size();
+      AppendBytes(buffer, &record, sizeof(record));
+      AppendBytes(buffer, key.data(), key.size());
+      AppendBytes(buffer, value->data(), value->size());
+      locations[key] = location;
+    }
+
+    const size_t new_size = base + buffer.size();
+    auto file = fml::OpenFile(*directory_, kFileName, true,
+                              fml::FilePermission::kReadWrite);
+    bool appended = file.is_valid() && fml::TruncateFile(file, new_size);
+    if (appended) {
+      fml::FileMapping writable(file, {fml::FileMapping::Protection::kRead,
+                                       fml::FileMapping::Protection::kWrite});
+      appended = writable.GetMutableMapping() != nullptr &&
+                 writable.GetSize() == new_size;
+      if (appended) {
+        std::memcpy(writable.GetMutableMapping() + base, buffer.data(),
+                    buffer.size());
+      }
+    }
+    auto mapping =
+        appended ? std::make_shared<fml::FileMapping>(file) : nullptr;
+
+    std::scoped_lock lock(mutex_);
+    if (!mapping || mapping->GetSize() != new_size) {
+      // Try again with the next flush.
+      for (const auto& entry : written) {
+        pending_.insert(entry.first);
+      }
+      imported_files_.insert(imported_files_.end(), imported_files.begin(),
+                             imported_files.end());
+      return false;
+    }
+    RemapLocked(std::move(mapping), std::move(locations), written);
+    file_size_ = new_size;
+  }
+
+  // The imported entries are in the pack now.
+  for (const auto& file_name : imported_files) {
+    fml::UnlinkFile(*directory_, file_name.c_str());
+  }
+  return true;
+}
+
+bool PersistentCachePack::NeedsCompaction() const {
+  std::scoped_lock lock(mutex_);
+  return replaced_bytes_ >= kMinCompactionBytes &&
+         replaced_bytes_ > file_size_ / 2;
+}
+
+bool PersistentCachePack::Compact() {
+  if (read_only_) {
+    return false;
+  }
+
+  std::scoped_lock file_lock(file_mutex_);
+  TRACE_EVENT0("flutter", "PersistentCachePack::Compact");
+
+  std::shared_ptr<fml::FileMapping> mapping;
+  std::unordered_map<std::string, Location> index;
+  {
+    std::scoped_lock lock(mutex_);
+    mapping = mapping_;
+    index = index_;
+  }
+  if (!mapping) {
+    return true;
+  }
+
+  std::vector<uint8_t> buffer;
+  AppendPackHeader(buffer);
+  std::unordered_map<std::string, Location> locations;
+  for (const auto& [key, old_location] : index) {
+    const uint8_t* value = mapping->GetMapping() + old_location.offset;
+    RecordHeader record;
+    record.key_size = key.size();
+    record.value_size = old_location.size;
+    record.checksum = Checksum(reinterpret_cast<const uint8_t*>(key.data()),
+                               key.size(), value, old_location.size);
+    Location location;
+    location.offset = buffer.size() + sizeof(record) + key.size();
+    location.size = old_location.size;
+    location.record_size = sizeof(record) + key.size() + old_location.size;
+    AppendBytes(buffer, &record, sizeof(record));
+    AppendBytes(buffer, key.data(), key.size());
+    AppendBytes(buffer, value, old_location.size);
+    locations[key] = location;
+  }
+
+  const size_t compacted_size = buffer.size();
+  // The file is replaced rather than rewritten in place, so loaded data that
+  // still points into the old mapping stays valid.
+  if (!fml::WriteAtomically(*directory_, kFileName,
+                            fml::DataMapping(std::move(buffer)))) {
+    FML_LOG(ERROR) << "Could not write the compacted persistent cache pack.";
+    return false;
+  }
+
+  std::shared_ptr<fml::FileMapping> compacted =
+      fml::FileMapping::CreateReadOnly(*directory_, kFileName);
+
+  std::scoped_lock lock(mutex_);
+  file_size_ = compacted_size;
+  replaced_bytes_ = 0;
+  if (!compacted || compacted->GetSize() != compacted_size) {
+    // The compacted file is in place but could not be mapped. Keep the
+    // entries in memory and write them to it again with the next flush.
+    FML_LOG(ERROR) << "Could not map the compacted persistent cache pack.";
+    for (const auto& [key, location] : index_) {
+      if (unmapped_.count(key) == 0) {
+        unmapped_[key] = LoadFromMappingLocked(location);
+        pending_.insert(key);
+      }
+    }
+    index_.clear();
+    mapping_ = nullptr;
+    return false;
+  }
+  index_.clear();
+  RemapLocked(std::move(compacted), std::move(locations), {});
+  return true;
+}
+
+}  // namespace flutter
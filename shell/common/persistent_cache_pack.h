@@ -0,0 +1,140 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_PERSISTENT_CACHE_PACK_H_
+#define FLUTTER_SHELL_COMMON_PERSISTENT_CACHE_PACK_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/unique_fd.h"
+#include "third_party/skia/include/core/SkData.h"
+
+namespace flutter {
+
+/// All the entries of a |PersistentCache| directory packed into a single
+/// memory mapped file.
+///
+/// The pack is a header followed by a log of key/value records. Opening it
+/// maps the file once and indexes the records by key, so loads neither open
+/// nor read any files and the values they return point into the mapping.
+/// Stored entries are visible to loads right away and are appended to the
+/// file by |Flush|. Records replaced by later ones stay in the file until
+/// |Compact| rewrites it.
+///
+/// Entries in the older layout of one file per entry are imported when the
+/// pack is opened. Unless the pack is read-only, the next |Flush| writes them
+/// to the pack and removes their files.
+///
+/// The pack is thread-safe. |Flush| and |Compact| do file IO and are meant to
+/// be called on worker threads.
+class PersistentCachePack {
+ public:
+  static constexpr char kFileName[] = "persistent_cache.pack";
+
+  /// Packs are compacted once replaced records take up more than half of the
+  /// file and at least this many bytes.
+  static constexpr size_t kMinCompactionBytes = 64 * 1024;
+
+  using Entry = std::pair<sk_sp<SkData>, sk_sp<SkData>>;
+
+  /// Opens the pack in |directory|, which need not exist yet. Returns null if
+  /// the directory is not valid.
+  static std::shared_ptr<PersistentCachePack> Open(
+      std::shared_ptr<fml::UniqueFD> directory,
+      bool read_only);
+
+  ~PersistentCachePack();
+
+  /// Returns the value most recently stored for |key| or null.
+  sk_sp<SkData> Load(const SkData& key) const;
+
+  /// Stores |value| for |key| in memory until the next |Flush|. Returns true
+  /// if no flush has been asked for since the last one started, in which case
+  /// the caller should arrange for |Flush| to be called. Entries a failed
+  /// flush could not write are retried by the flush the next store asks for.
+  bool Store(const SkData& key, sk_sp<SkData> value);
+
+  /// Returns all entries in no particular order.
+  std::vector<Entry> GetEntries() const;
+
+  size_t GetEntryCount() const;
+
+  /// Whether there are stored or imported entries that |Flush| would write.
+  bool HasPendingWrites() const;
+
+  /// Appends the entries stored since the last flush to the file.
+  bool Flush();
+
+  /// Whether enough of the file is taken up by replaced records to be worth
+  /// calling |Compact|.
+  bool NeedsCompaction() const;
+
+  /// Rewrites the file without the replaced records.
+  bool Compact();
+
+ private:
+  struct Location {
+    size_t offset = 0;
+    size_t size = 0;
+    // The size of the whole record, for keeping track of replaced records.
+    size_t record_size = 0;
+  };
+
+  const std::shared_ptr<fml::UniqueFD> directory_;
+  const bool read_only_;
+
+  // Serializes |Flush| and |Compact|, which both write the file and replace
+  // the mapping. Always acquired before |mutex_|.
+  std::mutex file_mutex_;
+
+  mutable std::mutex mutex_;
+  std::shared_ptr<fml::FileMapping> mapping_;
+  // Where the values of the records in |mapping_| are, by key.
+  std::unordered_map<std::string, Location> index_;
+  // Entries that are not in |mapping_|, either because they have not been
+  // written yet or because they were imported into a read-only pack.
+  std::unordered_map<std::string, sk_sp<SkData>> unmapped_;
+  // Keys in |unmapped_| that the next flush should write.
+  std::unordered_set<std::string> pending_;
+  // Whether a store has asked for a flush that has not started yet.
+  bool flush_scheduled_ = false;
+  // Files of the old layout that were imported but not written yet.
+  std::vector<std::string> imported_files_;
+  // The size of the valid part of the file. Anything past it, like a record
+  // that was only partially written, is overwritten by the next flush.
+  size_t file_size_ = 0;
+  size_t replaced_bytes_ = 0;
+
+  PersistentCachePack(std::shared_ptr<fml::UniqueFD> directory,
+                      bool read_only);
+
+  // Maps the file and indexes its records.
+  void ReadFile();
+
+  // Reads the entries of the one-file-per-entry layout.
+  void ImportFiles();
+
+  sk_sp<SkData> LoadFromMappingLocked(const Location& location) const;
+
+  // Maps the file again after it has been written and moves the entries
+  // written to it from |unmapped_| to |index_|.
+  void RemapLocked(std::shared_ptr<fml::FileMapping> mapping,
+                   std::unordered_map<std::string, Location> locations,
+                   const std::vector<std::pair<std::string, sk_sp<SkData>>>&
+                       written);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PersistentCachePack);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_COMMON_PERSISTENT_CACHE_PACK_H_
@@ -8,10 +8,13 @@
 #include "flutter/flow/layers/layer.h"
 #include "flutter/flow/layers/physical_shape_layer.h"
 #include "flutter/flow/layers/picture_layer.h"
+#include "flutter/fml/base32.h"
 #include "flutter/fml/command_line.h"
 #include "flutter/fml/file.h"
+#include "flutter/fml/mapping.h"
 #include "flutter/fml/unique_fd.h"
 #include "flutter/shell/common/persistent_cache.h"
+#include "flutter/shell/common/persistent_cache_pack.h"
 #include "flutter/shell/common/shell_test.h"
 #include "flutter/shell/common/switches.h"
 #include "flutter/testing/testing.h"
@@ -27,6 +30,26 @@ static void WaitForIO(Shell* shell) {
   io_task_finished.get_future().wait();
 }
 
+// Removes the files and directories the caches created in |dir|.
+static void RemoveAllFiles(const fml::ScopedTemporaryDirectory& dir) {
+  fml::FileVisitor remove_visitor = [&remove_visitor](
+                                        const fml::UniqueFD& directory,
+                                        const std::string& filename) {
+    if (fml::IsDirectory(directory, filename.c_str())) {
+      {  // To trigger fml::~UniqueFD before fml::UnlinkDirectory
+        fml::UniqueFD sub_dir =
+            fml::OpenDirectoryReadOnly(directory, filename.c_str());
+        fml::VisitFiles(sub_dir, remove_visitor);
+      }
+      fml::UnlinkDirectory(directory, filename.c_str());
+    } else {
+      fml::UnlinkFile(directory, filename.c_str());
+    }
+    return true;
+  };
+  fml::VisitFiles(dir.fd(), remove_visitor);
+}
+
 TEST_F(ShellTest, CacheSkSLWorks) {
   // Create a temp dir to store the persistent cache
   fml::ScopedTemporaryDirectory dir;
@@ -104,24 +127,229 @@ TEST_F(ShellTest, CacheSkSLWorks) {
   ASSERT_EQ(skp_count, old_skp_count);
 
   // Remove all files generated
-  fml::FileVisitor remove_visitor = [&remove_visitor](
-                                        const fml::UniqueFD& directory,
-                                        const std::string& filename) {
-    if (fml::IsDirectory(directory, filename.c_str())) {
-      {  // To trigger fml::~UniqueFD before fml::UnlinkDirectory
-        fml::UniqueFD sub_dir =
-            fml::OpenDirectoryReadOnly(directory, filename.c_str());
-        fml::VisitFiles(sub_dir, remove_visitor);
-      }
-      fml::UnlinkDirectory(directory, filename.c_str());
-    } else {
-      fml::UnlinkFile(directory, filename.c_str());
-    }
-    return true;
-  };
-  fml::VisitFiles(dir.fd(), remove_visitor);
+  RemoveAllFiles(dir);
   DestroyShell(std::move(shell));
 }
 
+TEST_F(ShellTest, ShapedRunsAreOnlyCachedWhenEnabled) {
+  const std::vector<fml::CommandLine::Option> options = {
+      fml::CommandLine::Option("cache-shaped-runs", "")};
+  fml::CommandLine command_line("", options, std::vector<std::string>());
+  ASSERT_TRUE(flutter::SettingsFromCommandLine(command_line).cache_shaped_runs);
+  ASSERT_FALSE(
+      flutter::SettingsFromCommandLine(fml::CommandLine()).cache_shaped_runs);
+
+  fml::ScopedTemporaryDirectory dir;
+  PersistentCache::SetCacheDirectoryPath(dir.path());
+  auto settings = CreateSettingsForFixture();
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+  PersistentCache::ResetCacheForProcess();
+  // The words of the text laid out in tests are not kept.
+  ASSERT_FALSE(PersistentCache::GetCacheForProcess()->IsCachingShapedRuns());
+  DestroyShell(std::move(shell));
+
+  settings.cache_shaped_runs = true;
+  shell = CreateShell(settings);
+  PersistentCache::ResetCacheForProcess();
+  ASSERT_TRUE(PersistentCache::GetCacheForProcess()->IsCachingShapedRuns());
+
+  // Read-only caches never keep them.
+  PersistentCache::gIsReadOnly = true;
+  PersistentCache::ResetCacheForProcess();
+  ASSERT_FALSE(PersistentCache::GetCacheForProcess()->IsCachingShapedRuns());
+  PersistentCache::gIsReadOnly = false;
+  DestroyShell(std::move(shell));
+
+  PersistentCache::SetCacheShapedRuns(false);
+  PersistentCache::ResetCacheForProcess();
+  ASSERT_FALSE(PersistentCache::GetCacheForProcess()->IsCachingShapedRuns());
+  RemoveAllFiles(dir);
+}
+
+static std::shared_ptr<fml::UniqueFD> OpenPackDirectory(
+    const fml::ScopedTemporaryDirectory& dir) {
+  return std::make_shared<fml::UniqueFD>(fml::OpenDirectory(
+      dir.path().c_str(), false, fml::FilePermission::kReadWrite));
+}
+
+static sk_sp<SkData> MakeData(const std::string& string) {
+  return SkData::MakeWithCopy(string.data(), string.size());
+}
+
+static sk_sp<SkData> MakeData(size_t size, char fill) {
+  return MakeData(std::string(size, fill));
+}
+
+// Removes the pack so that |dir| can be removed.
+static void RemovePackFile(fml::ScopedTemporaryDirectory& dir) {
+  fml::UnlinkFile(dir.fd(), PersistentCachePack::kFileName);
+}
+
+static size_t PackFileSize(const fml::ScopedTemporaryDirectory& dir) {
+  auto directory = OpenPackDirectory(dir);
+  auto mapping = fml::FileMapping::CreateReadOnly(
+      *directory, PersistentCachePack::kFileName);
+  return mapping ? mapping->GetSize() : 0;
+}
+
+TEST(PersistentCachePackTest, StoredEntriesCanBeLoadedAfterReopening) {
+  fml::ScopedTemporaryDirectory dir;
+  auto pack = PersistentCachePack::Open(OpenPackDirectory(dir), false);
+  ASSERT_TRUE(pack);
+  ASSERT_EQ(pack->GetEntryCount(), 0u);
+
+  ASSERT_TRUE(pack->Store(*MakeData("a"), MakeData("apple")));
+  ASSERT_FALSE(pack->Store(*MakeData("b"), MakeData("banana")));
+  // Entries can be loaded before they are written.
+  ASSERT_TRUE(pack->Load(*MakeData("a"))->equals(MakeData("apple").get()));
+  ASSERT_TRUE(pack->HasPendingWrites());
+  ASSERT_TRUE(pack->Flush());
+  ASSERT_FALSE(pack->HasPendingWrites());
+  ASSERT_TRUE(pack->Load(*MakeData("b"))->equals(MakeData("banana").get()));
+
+  // Later flushes append to the file.
+  ASSERT_TRUE(pack->Store(*MakeData("c"), MakeData("cherry")));
+  ASSERT_TRUE(pack->Flush());
+
+  auto loaded = pack->Load(*MakeData("a"));
+  pack.reset();
+  // Loaded data stays valid after the pack is gone.
+  ASSERT_TRUE(loaded->equals(MakeData("apple").get()));
+
+  auto reopened = PersistentCachePack::Open(OpenPackDirectory(dir), false);
+  ASSERT_EQ(reopened->GetEntryCount(), 3u);
+  ASSERT_TRUE(reopened->Load(*MakeData("a"))->equals(MakeData("apple").get()));
+  ASSERT_TRUE(
+      reopened->Load(*MakeData("b"))->equals(MakeData("banana").get()));
+  ASSERT_TRUE(
+      reopened->Load(*MakeData("c"))->equals(MakeData("cherry").get()));
+  ASSERT_FALSE(reopened->Load(*MakeData("d")));
+  ASSERT_EQ(reopened->GetEntries().size(), 3u);
+  RemovePackFile(dir);
+}
+
+TEST(PersistentCachePackTest, ReplacedEntriesAreCompactedAway) {
+  fml::ScopedTemporaryDirectory dir;
+  auto pack = PersistentCachePack::Open(OpenPackDirectory(dir), false);
+  const size_t value_size = PersistentCachePack::kMinCompactionBytes / 2;
+  ASSERT_TRUE(pack->Store(*MakeData("kept"), MakeData(value_size, 'k')));
+  for (char fill = 'a'; fill <= 'e'; fill++) {
+    pack->Store(*MakeData("replaced"), MakeData(value_size, fill));
+    ASSERT_TRUE(pack->Flush());
+  }
+  ASSERT_TRUE(pack->NeedsCompaction());
+  const size_t size_before = PackFileSize(dir);
+
+  auto loaded = pack->Load(*MakeData("replaced"));
+  ASSERT_TRUE(pack->Compact());
+  ASSERT_FALSE(pack->NeedsCompaction());
+  ASSERT_LT(PackFileSize(dir), size_before / 2);
+  ASSERT_TRUE(loaded->equals(MakeData(value_size, 'e').get()));
+
+  // The compacted pack can still be appended to.
+  ASSERT_TRUE(pack->Store(*MakeData("new"), MakeData("value")));
+  ASSERT_TRUE(pack->Flush());
+
+  auto reopened = PersistentCachePack::Open(OpenPackDirectory(dir), false);
+  ASSERT_EQ(reopened->GetEntryCount(), 3u);
+  ASSERT_TRUE(reopened->Load(*MakeData("replaced"))
+                  ->equals(MakeData(value_size, 'e').get()));
+  ASSERT_TRUE(reopened->Load(*MakeData("kept"))
+                  ->equals(MakeData(value_size, 'k').get()));
+  ASSERT_TRUE(
+      reopened->Load(*MakeData("new"))->equals(MakeData("value").get()));
+  RemovePackFile(dir);
+}
+
+TEST(PersistentCachePackTest, StoresAfterAFailedFlushAreWritten) {
+  fml::ScopedTemporaryDirectory dir;
+  auto pack = PersistentCachePack::Open(OpenPackDirectory(dir), false);
+  // A directory in place of the pack makes writing it fail.
+  ASSERT_TRUE(fml::CreateDirectory(dir.fd(), {PersistentCachePack::kFileName},
+                                   fml::FilePermission::kReadWrite)
+                  .is_valid());
+  ASSERT_TRUE(pack->Store(*MakeData("a"), MakeData("apple")));
+  ASSERT_FALSE(pack->Flush());
+  ASSERT_TRUE(pack->HasPendingWrites());
+
+  // The next store asks for another flush, which writes both entries.
+  ASSERT_TRUE(fml::UnlinkDirectory(dir.fd(), PersistentCachePack::kFileName));
+  ASSERT_TRUE(pack->Store(*MakeData("b"), MakeData("banana")));
+  ASSERT_TRUE(pack->Flush());
+  ASSERT_FALSE(pack->HasPendingWrites());
+
+  auto reopened = PersistentCachePack::Open(OpenPackDirectory(dir), false);
+  ASSERT_EQ(reopened->GetEntryCount(), 2u);
+  ASSERT_TRUE(reopened->Load(*MakeData("a"))->equals(MakeData("apple").get()));
+  ASSERT_TRUE(
+      reopened->Load(*MakeData("b"))->equals(MakeData("banana").get()));
+  RemovePackFile(dir);
+}
+
+TEST(PersistentCachePackTest, TruncatedRecordsAreIgnoredAndOverwritten) {
+  fml::ScopedTemporaryDirectory dir;
+  {
+    auto pack = PersistentCachePack::Open(OpenPackDirectory(dir), false);
+    pack->Store(*MakeData("whole"), MakeData("record"));
+    ASSERT_TRUE(pack->Flush());
+    pack->Store(*MakeData("torn"), MakeData("record"));
+    ASSERT_TRUE(pack->Flush());
+  }
+
+  {
+    auto directory = OpenPackDirectory(dir);
+    auto file = fml::OpenFile(*directory, PersistentCachePack::kFileName,
+                              false, fml::FilePermission::kReadWrite);
+    ASSERT_TRUE(fml::TruncateFile(file, PackFileSize(dir) - 2));
+  }
+
+  auto pack = PersistentCachePack::Open(OpenPackDirectory(dir), false);
+  ASSERT_EQ(pack->GetEntryCount(), 1u);
+  ASSERT_TRUE(pack->Load(*MakeData("whole")));
+  ASSERT_FALSE(pack->Load(*MakeData("torn")));
+
+  pack->Store(*MakeData("next"), MakeData("record"));
+  ASSERT_TRUE(pack->Flush());
+  pack = PersistentCachePack::Open(OpenPackDirectory(dir), false);
+  ASSERT_EQ(pack->GetEntryCount(), 2u);
+  ASSERT_TRUE(pack->Load(*MakeData("next"))->equals(MakeData("record").get()));
+  RemovePackFile(dir);
+}
+
+TEST(PersistentCachePackTest, ImportsOneFilePerEntryLayout) {
+  fml::ScopedTemporaryDirectory dir;
+  auto directory = OpenPackDirectory(dir);
+  const std::string file_name = fml::Base32Encode("legacy").second;
+  ASSERT_TRUE(fml::WriteAtomically(
+      *directory, file_name.c_str(),
+      fml::NonOwnedMapping(reinterpret_cast<const uint8_t*>("old"), 3)));
+  // Files that are not cache entries are left alone.
+  ASSERT_TRUE(fml::WriteAtomically(
+      *directory, "shader_dump_1.skp",
+      fml::NonOwnedMapping(reinterpret_cast<const uint8_t*>("skp"), 3)));
+
+  // Read-only packs only import the entries into memory.
+  auto read_only = PersistentCachePack::Open(directory, true);
+  ASSERT_TRUE(
+      read_only->Load(*MakeData("legacy"))->equals(MakeData("old").get()));
+  ASSERT_FALSE(read_only->HasPendingWrites());
+  ASSERT_FALSE(read_only->Flush());
+  ASSERT_TRUE(fml::FileExists(*directory, file_name.c_str()));
+
+  auto pack = PersistentCachePack::Open(directory, false);
+  ASSERT_TRUE(pack->Load(*MakeData("legacy"))->equals(MakeData("old").get()));
+  ASSERT_TRUE(pack->HasPendingWrites());
+  ASSERT_TRUE(pack->Flush());
+  ASSERT_FALSE(fml::FileExists(*directory, file_name.c_str()));
+  ASSERT_TRUE(fml::FileExists(*directory, "shader_dump_1.skp"));
+
+  auto reopened = PersistentCachePack::Open(directory, false);
+  ASSERT_EQ(reopened->GetEntryCount(), 1u);
+  ASSERT_TRUE(
+      reopened->Load(*MakeData("legacy"))->equals(MakeData("old").get()));
+  fml::UnlinkFile(*directory, "shader_dump_1.skp");
+  RemovePackFile(dir);
+}
+
 }  // namespace testing
 }  // namespace flutter
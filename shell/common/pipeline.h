@@ -5,14 +5,15 @@
 #ifndef FLUTTER_SHELL_COMMON_PIPELINE_H_
 #define FLUTTER_SHELL_COMMON_PIPELINE_H_
 
+#include "flutter/fml/compiler_specific.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_counted.h"
-#include "flutter/fml/synchronization/semaphore.h"
 #include "flutter/fml/trace_event.h"
 
+#include <algorithm>
+#include <atomic>
 #include <deque>
 #include <memory>
-#include <mutex>
 
 namespace flutter {
 
@@ -25,7 +26,7 @@ enum class PipelineConsumeResult {
 size_t GetNextPipelineTraceID();
 
 /// A thread-safe queue of resources for a single consumer and a single
-/// producer.
+/// producer. Producing and consuming never take a lock.
 template <class R>
 class Pipeline : public fml::RefCountedThreadSafe<Pipeline<R>> {
  public:
@@ -88,17 +89,48 @@ class Pipeline : public fml::RefCountedThreadSafe<Pipeline<R>> {
     FML_DISALLOW_COPY_AND_ASSIGN(ProducerContinuation);
   };
 
-  explicit Pipeline(uint32_t depth)
-      : depth_(depth), empty_(depth), available_(0), inflight_(0) {}
+  /// Creates a pipeline that holds at most |depth| resources at a time,
+  /// including the one being consumed. The depth can later be changed with
+  /// |SetDepth| to anything between one and |max_depth|, which defaults to
+  /// |depth|.
+  explicit Pipeline(uint32_t depth, uint32_t max_depth = 0)
+      : capacity_(std::max({depth, max_depth, 1u})),
+        slots_(new Slot[capacity_]),
+        depth_(depth),
+        free_(depth) {}
 
   ~Pipeline() = default;
 
-  bool IsValid() const { return empty_.IsValid() && available_.IsValid(); }
+  bool IsValid() const { return slots_ != nullptr; }
+
+  /// The number of resources the producer may have in flight.
+  uint32_t GetDepth() const { return depth_.load(std::memory_order_relaxed); }
+
+  uint32_t GetMaxDepth() const { return capacity_; }
+
+  /// Changes the depth of the pipeline, clamped to [1, max depth]. Lowering
+  /// the depth does not drop resources already in flight. Instead,
+  /// |Produce| fails until enough of them have been consumed.
+  ///
+  /// Must be called on the producer thread.
+  void SetDepth(uint32_t depth) {
+    depth = std::clamp(depth, 1u, capacity_);
+    const uint32_t old_depth = depth_.exchange(depth);
+    free_.fetch_add(static_cast<int>(depth) - static_cast<int>(old_depth));
+  }
+
+  /// The number of resources that are reserved, queued or being consumed.
+  int GetInFlightCount() const { return inflight_.load(); }
 
   ProducerContinuation Produce() {
-    if (!empty_.TryWait()) {
-      return {};
-    }
+    int free = free_.load(std::memory_order_relaxed);
+    do {
+      if (free <= 0) {
+        return {};
+      }
+    } while (!free_.compare_exchange_weak(free, free - 1,
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed));
     ++inflight_;
     FML_TRACE_COUNTER("flutter", "Pipeline Depth",
                       reinterpret_cast<int64_t>(this),      //
@@ -114,10 +146,12 @@ class Pipeline : public fml::RefCountedThreadSafe<Pipeline<R>> {
   // Pushes task to the front of the pipeline.
   //
   // If we exceed the depth completing this continuation, we drop the
-  // last frame to preserve the depth of the pipeline.
+  // last frame to preserve the depth of the pipeline. Dropped resources are
+  // handed to the |discarded| callback of the next |Consume| call.
   //
   // Note: Use |Pipeline::Produce| where possible. This should only be
-  // used to en-queue high-priority resources.
+  // used to en-queue high-priority resources. Unlike |Produce|, the
+  // continuation must be completed on the consumer thread.
   ProducerContinuation ProduceToFront() {
     return ProducerContinuation{
         std::bind(&Pipeline::ProducerCommitFront, this, std::placeholders::_1,
@@ -129,24 +163,30 @@ class Pipeline : public fml::RefCountedThreadSafe<Pipeline<R>> {
 
   /// @note Procedure doesn't copy all closures.
   FML_WARN_UNUSED_RESULT
-  PipelineConsumeResult Consume(const Consumer& consumer) {
+  PipelineConsumeResult Consume(const Consumer& consumer,
+                                const Consumer& discarded = nullptr) {
     if (consumer == nullptr) {
       return PipelineConsumeResult::NoneAvailable;
     }
 
-    if (!available_.TryWait()) {
-      return PipelineConsumeResult::NoneAvailable;
-    }
-
     ResourcePtr resource;
     size_t trace_id = 0;
-    size_t items_count = 0;
-
-    {
-      std::scoped_lock lock(queue_mutex_);
-      std::tie(resource, trace_id) = std::move(queue_.front());
-      queue_.pop_front();
-      items_count = queue_.size();
+    bool reserved = false;
+
+    if (!front_.empty()) {
+      std::tie(resource, trace_id) = std::move(front_.front());
+      front_.pop_front();
+    } else {
+      ReleaseDiscarded(discarded);
+      const size_t tail = tail_.load(std::memory_order_acquire);
+      if (head_ == tail) {
+        return PipelineConsumeResult::NoneAvailable;
+      }
+      Slot& slot = slots_[head_ % capacity_];
+      resource = std::move(slot.resource);
+      trace_id = slot.trace_id;
+      ++head_;
+      reserved = true;
     }
 
     {
@@ -154,45 +194,102 @@ class Pipeline : public fml::RefCountedThreadSafe<Pipeline<R>> {
       consumer(std::move(resource));
     }
 
-    empty_.Signal();
+    // Resources pushed to the front never took a reservation from the
+    // producer, so they must not give one back.
+    if (reserved) {
+      ReleaseSlot(trace_id);
+    } else {
+      TRACE_FLOW_END("flutter", "PipelineItem", trace_id);
+      TRACE_EVENT_ASYNC_END0("flutter", "PipelineItem", trace_id);
+    }
+    ReleaseDiscarded(discarded);
+
+    return (!front_.empty() || QueuedCount() > 0)
+               ? PipelineConsumeResult::MoreAvailable
+               : PipelineConsumeResult::Done;
+  }
+
+ private:
+  struct Slot {
+    ResourcePtr resource;
+    size_t trace_id = 0;
+    bool discarded = false;
+  };
+
+  // Resources produced with |Produce| live in a ring of |capacity_| slots.
+  // The producer only writes the slot at |tail_| and the consumer only reads
+  // the slot at |head_|. |free_| hands out reservations, so the producer
+  // never overwrites a slot the consumer has not released yet.
+  const uint32_t capacity_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint32_t> depth_;
+  // May go negative after |SetDepth| lowered the depth.
+  std::atomic<int> free_;
+  std::atomic<int> inflight_ = {0};
+  std::atomic<size_t> tail_ = {0};
+  // Only accessed on the consumer thread.
+  size_t head_ = 0;
+  size_t discarded_count_ = 0;
+  std::deque<std::pair<ResourcePtr, size_t>> front_;
+
+  size_t QueuedCount() const {
+    return tail_.load(std::memory_order_acquire) - head_ - discarded_count_;
+  }
+
+  void ReleaseSlot(size_t trace_id) {
+    free_.fetch_add(1, std::memory_order_release);
     --inflight_;
 
     TRACE_FLOW_END("flutter", "PipelineItem", trace_id);
     TRACE_EVENT_ASYNC_END0("flutter", "PipelineItem", trace_id);
-
-    return items_count > 0 ? PipelineConsumeResult::MoreAvailable
-                           : PipelineConsumeResult::Done;
   }
 
- private:
-  const uint32_t depth_;
-  fml::Semaphore empty_;
-  fml::Semaphore available_;
-  std::atomic<int> inflight_;
-  std::mutex queue_mutex_;
-  std::deque<std::pair<ResourcePtr, size_t>> queue_;
-
-  void ProducerCommit(ResourcePtr resource, size_t trace_id) {
-    {
-      std::scoped_lock lock(queue_mutex_);
-      queue_.emplace_back(std::move(resource), trace_id);
+  // Resources dropped by |ProducerCommitFront| stay in the ring until the
+  // consumer reaches them.
+  void ReleaseDiscarded(const Consumer& discarded) {
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    while (head_ != tail && slots_[head_ % capacity_].discarded) {
+      Slot& slot = slots_[head_ % capacity_];
+      ResourcePtr resource = std::move(slot.resource);
+      const size_t trace_id = slot.trace_id;
+      ++head_;
+      --discarded_count_;
+      if (discarded) {
+        discarded(std::move(resource));
+      }
+      ReleaseSlot(trace_id);
     }
+  }
 
-    // Ensure the queue mutex is not held as that would be a pessimization.
-    available_.Signal();
+  void ProducerCommit(ResourcePtr resource, size_t trace_id) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[tail % capacity_];
+    slot.resource = std::move(resource);
+    slot.trace_id = trace_id;
+    slot.discarded = false;
+    tail_.store(tail + 1, std::memory_order_release);
   }
 
   void ProducerCommitFront(ResourcePtr resource, size_t trace_id) {
-    {
-      std::scoped_lock lock(queue_mutex_);
-      queue_.emplace_front(std::move(resource), trace_id);
-      while (queue_.size() > depth_) {
-        queue_.pop_back();
+    front_.emplace_front(std::move(resource), trace_id);
+
+    // Drop the newest queued resources until the depth is respected again.
+    // Committed slots are never written by the producer again, so marking
+    // them here does not race with it.
+    const size_t depth = GetDepth();
+    size_t index = tail_.load(std::memory_order_acquire);
+    while (front_.size() + QueuedCount() > depth && index != head_) {
+      Slot& slot = slots_[--index % capacity_];
+      if (!slot.discarded) {
+        slot.discarded = true;
+        ++discarded_count_;
       }
     }
-
-    // Ensure the queue mutex is not held as that would be a pessimization.
-    available_.Signal();
+    while (front_.size() > depth) {
+      TRACE_FLOW_END("flutter", "PipelineItem", front_.back().second);
+      TRACE_EVENT_ASYNC_END0("flutter", "PipelineItem", front_.back().second);
+      front_.pop_back();
+    }
   }
 
   FML_DISALLOW_COPY_AND_ASSIGN(Pipeline);
@@ -7,6 +7,8 @@
 #include <functional>
 #include <future>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "flutter/shell/common/pipeline.h"
 #include "gtest/gtest.h"
@@ -131,5 +133,125 @@ TEST(PipelineTest, PushingToFrontDropsLastResource) {
   ASSERT_EQ(consume_result_2, PipelineConsumeResult::Done);
 }
 
+TEST(PipelineTest, DroppedResourcesAreReportedAsDiscarded) {
+  const int depth = 2;
+  fml::RefPtr<IntPipeline> pipeline = fml::MakeRefCounted<IntPipeline>(depth);
+
+  Continuation continuation_1 = pipeline->Produce();
+  Continuation continuation_2 = pipeline->Produce();
+  Continuation continuation_3 = pipeline->ProduceToFront();
+
+  continuation_1.Complete(std::make_unique<int>(1));
+  continuation_2.Complete(std::make_unique<int>(2));
+  continuation_3.Complete(std::make_unique<int>(3));
+
+  std::vector<int> consumed;
+  std::vector<int> discarded;
+  auto consume = [&consumed](std::unique_ptr<int> v) {
+    consumed.push_back(*v);
+  };
+  auto discard = [&discarded](std::unique_ptr<int> v) {
+    discarded.push_back(*v);
+  };
+
+  ASSERT_EQ(pipeline->Consume(consume, discard),
+            PipelineConsumeResult::MoreAvailable);
+  ASSERT_EQ(pipeline->Consume(consume, discard), PipelineConsumeResult::Done);
+  ASSERT_EQ(pipeline->Consume(consume, discard),
+            PipelineConsumeResult::NoneAvailable);
+
+  ASSERT_EQ(consumed, std::vector<int>({3, 1}));
+  ASSERT_EQ(discarded, std::vector<int>({2}));
+
+  // The slot of the dropped resource is available to the producer again.
+  ASSERT_EQ(pipeline->GetInFlightCount(), 0);
+  ASSERT_TRUE(pipeline->Produce());
+  ASSERT_TRUE(pipeline->Produce());
+}
+
+TEST(PipelineTest, IncreasingDepthAllowsMoreInFlight) {
+  fml::RefPtr<IntPipeline> pipeline = fml::MakeRefCounted<IntPipeline>(1, 3);
+  ASSERT_EQ(pipeline->GetDepth(), 1u);
+  ASSERT_EQ(pipeline->GetMaxDepth(), 3u);
+
+  Continuation continuation_1 = pipeline->Produce();
+  ASSERT_TRUE(continuation_1);
+  ASSERT_FALSE(pipeline->Produce());
+
+  pipeline->SetDepth(3);
+  Continuation continuation_2 = pipeline->Produce();
+  Continuation continuation_3 = pipeline->Produce();
+  ASSERT_TRUE(continuation_2);
+  ASSERT_TRUE(continuation_3);
+  ASSERT_FALSE(pipeline->Produce());
+
+  continuation_1.Complete(std::make_unique<int>(1));
+  continuation_2.Complete(std::make_unique<int>(2));
+  continuation_3.Complete(std::make_unique<int>(3));
+
+  std::vector<int> consumed;
+  auto consume = [&consumed](std::unique_ptr<int> v) {
+    consumed.push_back(*v);
+  };
+  ASSERT_EQ(pipeline->Consume(consume), PipelineConsumeResult::MoreAvailable);
+  ASSERT_EQ(pipeline->Consume(consume), PipelineConsumeResult::MoreAvailable);
+  ASSERT_EQ(pipeline->Consume(consume), PipelineConsumeResult::Done);
+  ASSERT_EQ(consumed, std::vector<int>({1, 2, 3}));
+}
+
+TEST(PipelineTest, DecreasingDepthWaitsForInFlightResources) {
+  fml::RefPtr<IntPipeline> pipeline = fml::MakeRefCounted<IntPipeline>(3);
+
+  Continuation continuation_1 = pipeline->Produce();
+  Continuation continuation_2 = pipeline->Produce();
+  continuation_1.Complete(std::make_unique<int>(1));
+  continuation_2.Complete(std::make_unique<int>(2));
+
+  pipeline->SetDepth(1);
+  ASSERT_EQ(pipeline->GetDepth(), 1u);
+  ASSERT_FALSE(pipeline->Produce());
+
+  auto consume = [](std::unique_ptr<int> v) {};
+  ASSERT_EQ(pipeline->Consume(consume), PipelineConsumeResult::MoreAvailable);
+  ASSERT_FALSE(pipeline->Produce());
+  ASSERT_EQ(pipeline->Consume(consume), PipelineConsumeResult::Done);
+
+  Continuation continuation_3 = pipeline->Produce();
+  ASSERT_TRUE(continuation_3);
+  ASSERT_FALSE(pipeline->Produce());
+}
+
+TEST(PipelineTest, ProducerAndConsumerOnDifferentThreads) {
+  const int count = 10000;
+  fml::RefPtr<IntPipeline> pipeline = fml::MakeRefCounted<IntPipeline>(2, 3);
+
+  std::thread producer([pipeline, count]() {
+    for (int i = 0; i < count;) {
+      if (Continuation continuation = pipeline->Produce()) {
+        continuation.Complete(std::make_unique<int>(i++));
+        // Exercise depth changes while the consumer is running.
+        pipeline->SetDepth(1 + i % 3);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  int expected = 0;
+  while (expected < count) {
+    PipelineConsumeResult result =
+        pipeline->Consume([&expected](std::unique_ptr<int> v) {
+          ASSERT_EQ(*v, expected);
+          expected++;
+        });
+    if (result == PipelineConsumeResult::NoneAvailable) {
+      std::this_thread::yield();
+    }
+  }
+
+  producer.join();
+  ASSERT_EQ(pipeline->GetInFlightCount(), 0);
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -102,6 +102,10 @@ fml::WeakPtr<PlatformView> PlatformView::GetWeakPtr() const {
 void PlatformView::UpdateSemantics(SemanticsNodeUpdates update,
                                    CustomAccessibilityActionUpdates actions) {}
 
+void PlatformView::UpdateEncodedSemantics(
+    EncodedSemanticsUpdate update,
+    CustomAccessibilityActionUpdates actions) {}
+
 void PlatformView::HandlePlatformMessage(fml::RefPtr<PlatformMessage> message) {
   if (auto response = message->response())
     response->CompleteEmpty();
@@ -13,6 +13,7 @@
 #include "flutter/fml/memory/weak_ptr.h"
 #include "flutter/lib/ui/semantics/custom_accessibility_action.h"
 #include "flutter/lib/ui/semantics/semantics_node.h"
+#include "flutter/lib/ui/semantics/semantics_update_encoder.h"
 #include "flutter/lib/ui/window/platform_message.h"
 #include "flutter/lib/ui/window/pointer_data_packet.h"
 #include "flutter/lib/ui/window/pointer_data_packet_converter.h"
@@ -350,6 +351,24 @@ class PlatformView {
   virtual void UpdateSemantics(SemanticsNodeUpdates updates,
                                CustomAccessibilityActionUpdates actions);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Used by the framework to tell the embedder to apply the
+  ///             specified changes to the semantics tree. Only called instead
+  ///             of `UpdateSemantics` when `Settings::encode_semantics_updates`
+  ///             is set. The default implementation of this method does
+  ///             nothing.
+  ///
+  /// @see        SemanticsUpdateEncoder
+  ///
+  /// @param[in]  update   The nodes that changed since the last update, with
+  ///                      only the fields that changed, and the nodes that
+  ///                      were removed.
+  /// @param[in]  actions  A map with the stable semantics node identifier as
+  ///                      key and the custom node action as the value.
+  ///
+  virtual void UpdateEncodedSemantics(EncodedSemanticsUpdate update,
+                                      CustomAccessibilityActionUpdates actions);
+
   //----------------------------------------------------------------------------
   /// @brief      Used by embedders to specify the updated viewport metrics. In
   ///             response to this call, on the GPU thread, the rasterizer may
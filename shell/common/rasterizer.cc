@@ -35,7 +35,9 @@ Rasterizer::Rasterizer(Delegate& delegate, TaskRunners task_runners)
     : Rasterizer(delegate,
                  std::move(task_runners),
                  std::make_unique<flutter::CompositorContext>(
-                     delegate.GetFrameBudget())) {}
+                     delegate.GetFrameBudget(),
+                     delegate.GetSettings().raster_cache_max_bytes,
+                     delegate.GetSettings().raster_cache_max_unused_frames)) {}
 
 Rasterizer::Rasterizer(
     Delegate& delegate,
@@ -122,8 +124,20 @@ void Rasterizer::Draw(fml::RefPtr<Pipeline<flutter::LayerTree>> pipeline) {
       [&](std::unique_ptr<LayerTree> layer_tree) {
         raster_status = DoDraw(std::move(layer_tree));
       };
+  Pipeline<flutter::LayerTree>::Consumer discarded =
+      [&](std::unique_ptr<LayerTree> layer_tree) {
+        if (!layer_tree) {
+          return;
+        }
+        FrameTiming timing;
+        timing.SetVsyncTarget(layer_tree->target_time());
+        timing.Set(FrameTiming::kBuildStart, layer_tree->build_start());
+        timing.Set(FrameTiming::kBuildFinish, layer_tree->build_finish());
+        delegate_.OnFrameCoalesced(timing);
+      };
 
-  PipelineConsumeResult consume_result = pipeline->Consume(consumer);
+  PipelineConsumeResult consume_result =
+      pipeline->Consume(consumer, discarded);
   // if the raster status is to resubmit the frame, we push the frame to the
   // front of the queue and also change the consume status to more available.
   if (raster_status == RasterStatus::kResubmit) {
@@ -240,6 +254,7 @@ RasterStatus Rasterizer::DoDraw(
   }
 
   FrameTiming timing;
+  timing.SetVsyncTarget(layer_tree->target_time());
   timing.Set(FrameTiming::kBuildStart, layer_tree->build_start());
   timing.Set(FrameTiming::kBuildFinish, layer_tree->build_finish());
   timing.Set(FrameTiming::kRasterStart, fml::TimePoint::Now());
@@ -338,6 +353,11 @@ RasterStatus Rasterizer::DrawToSurface(flutter::LayerTree& layer_tree) {
   );
 
   if (compositor_frame) {
+    // Overlays of an external view embedder are not retained across frames.
+    if (frame->retains_previous_contents() &&
+        external_view_embedder == nullptr) {
+      compositor_frame->EnablePartialRepaint(last_layer_tree_.get());
+    }
     RasterStatus raster_status = compositor_frame->Raster(layer_tree, false);
     if (raster_status == RasterStatus::kFailed) {
       return raster_status;
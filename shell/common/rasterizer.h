@@ -65,16 +65,27 @@ class Rasterizer final : public SnapshotDelegate {
     ///
     virtual void OnFrameRasterized(const FrameTiming& frame_timing) = 0;
 
+    /// Notifies the delegate that a frame was built but was replaced by a
+    /// newer frame before it could be rasterized. Only the build phases of
+    /// the `frame_timing` are set.
+    virtual void OnFrameCoalesced(const FrameTiming& frame_timing) = 0;
+
     /// Time limit for a smooth frame. See `Engine::GetDisplayRefreshRate`.
     virtual fml::Milliseconds GetFrameBudget() = 0;
+
+    /// The settings the caches of the rasterizer are configured from.
+    virtual const Settings& GetSettings() const = 0;
   };
 
   // TODO(dnfield): remove once embedders have caught up.
   class DummyDelegate : public Delegate {
     void OnFrameRasterized(const FrameTiming&) override {}
+    void OnFrameCoalesced(const FrameTiming&) override {}
     fml::Milliseconds GetFrameBudget() override {
       return fml::kDefaultFrameBudget;
     }
+    const Settings& GetSettings() const override { return settings_; }
+    Settings settings_;
   };
 
   //----------------------------------------------------------------------------
@@ -7,6 +7,7 @@
 #include <sstream>
 
 #include "flutter/assets/directory_asset_bundle.h"
+#include "flutter/assets/packed_asset_bundle.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/unique_fd.h"
 #include "flutter/runtime/dart_vm.h"
@@ -18,14 +19,20 @@ RunConfiguration RunConfiguration::InferFromSettings(
     fml::RefPtr<fml::TaskRunner> io_worker) {
   auto asset_manager = std::make_shared<AssetManager>();
 
+  // Assets in a pack are found before those in the directory around it, so
+  // that most lookups never open a file.
   if (fml::UniqueFD::traits_type::IsValid(settings.assets_dir)) {
-    asset_manager->PushBack(std::make_unique<DirectoryAssetBundle>(
-        fml::Duplicate(settings.assets_dir)));
+    fml::UniqueFD assets_dir = fml::Duplicate(settings.assets_dir);
+    asset_manager->PushBack(PackedAssetBundle::Open(assets_dir));
+    asset_manager->PushBack(
+        std::make_unique<DirectoryAssetBundle>(std::move(assets_dir)));
   }
 
+  fml::UniqueFD assets_path = fml::OpenDirectory(
+      settings.assets_path.c_str(), false, fml::FilePermission::kRead);
+  asset_manager->PushBack(PackedAssetBundle::Open(assets_path));
   asset_manager->PushBack(
-      std::make_unique<DirectoryAssetBundle>(fml::OpenDirectory(
-          settings.assets_path.c_str(), false, fml::FilePermission::kRead)));
+      std::make_unique<DirectoryAssetBundle>(std::move(assets_path)));
 
   return {IsolateConfiguration::InferFromSettings(settings, asset_manager,
                                                   io_worker),
@@ -5,6 +5,7 @@
 #define RAPIDJSON_HAS_STDSTRING 1
 #include "flutter/shell/common/shell.h"
 
+#include <cstdlib>
 #include <memory>
 #include <sstream>
 #include <vector>
@@ -17,6 +18,7 @@
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/paths.h"
+#include "flutter/fml/trace_buffer.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/fml/unique_fd.h"
 #include "flutter/runtime/dart_vm.h"
@@ -30,6 +32,7 @@
 #include "rapidjson/writer.h"
 #include "third_party/dart/runtime/include/dart_tools_api.h"
 #include "third_party/skia/include/core/SkGraphics.h"
+#include "third_party/skia/include/utils/SkBase64.h"
 #include "third_party/tonic/common/log.h"
 
 namespace flutter {
@@ -39,6 +42,32 @@ constexpr char kSystemChannel[] = "flutter/system";
 constexpr char kTypeKey[] = "type";
 constexpr char kFontChange[] = "fontsChange";
 
+static std::unique_ptr<Engine> CreateEngine(
+    Engine::Delegate& delegate,
+    const PointerDataDispatcherMaker& dispatcher_maker,
+    DartVM& vm,
+    fml::RefPtr<const DartSnapshot> isolate_snapshot,
+    TaskRunners task_runners,
+    const WindowData window_data,
+    Settings settings,
+    std::unique_ptr<Animator> animator,
+    fml::WeakPtr<IOManager> io_manager,
+    fml::RefPtr<SkiaUnrefQueue> unref_queue,
+    fml::WeakPtr<SnapshotDelegate> snapshot_delegate) {
+  return std::make_unique<Engine>(delegate,                     //
+                                  dispatcher_maker,             //
+                                  vm,                           //
+                                  std::move(isolate_snapshot),  //
+                                  std::move(task_runners),      //
+                                  window_data,                  //
+                                  std::move(settings),          //
+                                  std::move(animator),          //
+                                  std::move(io_manager),        //
+                                  std::move(unref_queue),       //
+                                  std::move(snapshot_delegate)  //
+  );
+}
+
 std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
     DartVMRef vm,
     TaskRunners task_runners,
@@ -46,14 +75,19 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
     Settings settings,
     fml::RefPtr<const DartSnapshot> isolate_snapshot,
     const Shell::CreateCallback<PlatformView>& on_create_platform_view,
-    const Shell::CreateCallback<Rasterizer>& on_create_rasterizer) {
+    const Shell::CreateCallback<Rasterizer>& on_create_rasterizer,
+    const Shell::EngineCreateCallback& on_create_engine,
+    std::shared_ptr<ShellIOManager> parent_io_manager,
+    std::shared_ptr<fml::SyncSwitch> is_gpu_disabled_sync_switch) {
   if (!task_runners.IsValid()) {
     FML_LOG(ERROR) << "Task runners to run the shell were invalid.";
     return nullptr;
   }
 
-  auto shell =
-      std::unique_ptr<Shell>(new Shell(std::move(vm), task_runners, settings));
+  auto shell = std::unique_ptr<Shell>(
+      new Shell(std::move(vm), task_runners, settings,
+                std::move(is_gpu_disabled_sync_switch)));
+  shell->shares_io_manager_ = parent_io_manager != nullptr;
 
   // Create the rasterizer on the GPU thread.
   std::promise<std::unique_ptr<Rasterizer>> rasterizer_promise;
@@ -68,6 +102,10 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
   ]() {
         TRACE_EVENT0("flutter", "ShellSetupGPUSubsystem");
         std::unique_ptr<Rasterizer> rasterizer(on_create_rasterizer(*shell));
+        if (shell->GetSettings().enable_async_raster_cache) {
+          rasterizer->compositor_context()->raster_cache().SetWorkerTaskRunner(
+              shell->GetConcurrentWorkerTaskRunner());
+        }
         snapshot_delegate_promise.set_value(rasterizer->GetSnapshotDelegate());
         rasterizer_promise.set_value(std::move(rasterizer));
       });
@@ -88,8 +126,8 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
   // Create the IO manager on the IO thread. The IO manager must be initialized
   // first because it has state that the other subsystems depend on. It must
   // first be booted and the necessary references obtained to initialize the
-  // other subsystems.
-  std::promise<std::unique_ptr<ShellIOManager>> io_manager_promise;
+  // other subsystems. Spawned shells share the IO manager of their parent.
+  std::promise<std::shared_ptr<ShellIOManager>> io_manager_promise;
   auto io_manager_future = io_manager_promise.get_future();
   std::promise<fml::WeakPtr<ShellIOManager>> weak_io_manager_promise;
   auto weak_io_manager_future = weak_io_manager_promise.get_future();
@@ -105,17 +143,22 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
   // https://github.com/flutter/flutter/issues/42948
   fml::TaskRunner::RunNowOrPostTask(
       io_task_runner,
-      [&io_manager_promise,                                               //
-       &weak_io_manager_promise,                                          //
-       &unref_queue_promise,                                              //
-       platform_view = platform_view->GetWeakPtr(),                       //
-       io_task_runner,                                                    //
-       is_backgrounded_sync_switch = shell->GetIsGpuDisabledSyncSwitch()  //
-  ]() {
+      [&io_manager_promise,                                                //
+       &weak_io_manager_promise,                                           //
+       &unref_queue_promise,                                               //
+       platform_view = platform_view->GetWeakPtr(),                        //
+       io_task_runner,                                                     //
+       is_backgrounded_sync_switch = shell->GetIsGpuDisabledSyncSwitch(),  //
+       parent_io_manager = std::move(parent_io_manager)                    //
+  ]() mutable {
         TRACE_EVENT0("flutter", "ShellSetupIOSubsystem");
-        auto io_manager = std::make_unique<ShellIOManager>(
-            platform_view.getUnsafe()->CreateResourceContext(),
-            is_backgrounded_sync_switch, io_task_runner);
+        std::shared_ptr<ShellIOManager> io_manager =
+            std::move(parent_io_manager);
+        if (!io_manager) {
+          io_manager = std::make_shared<ShellIOManager>(
+              platform_view.getUnsafe()->CreateResourceContext(),
+              is_backgrounded_sync_switch, io_task_runner);
+        }
         weak_io_manager_promise.set_value(io_manager->GetWeakPtr());
         unref_queue_promise.set_value(io_manager->GetSkiaUnrefQueue());
         io_manager_promise.set_value(std::move(io_manager));
@@ -131,6 +174,7 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
   fml::TaskRunner::RunNowOrPostTask(
       shell->GetTaskRunners().GetUITaskRunner(),
       fml::MakeCopyable([&engine_promise,                                 //
+                         &on_create_engine,                               //
                          shell = shell.get(),                             //
                          &dispatcher_maker,                               //
                          &window_data,                                    //
@@ -145,22 +189,23 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
 
         // The animator is owned by the UI thread but it gets its vsync pulses
         // from the platform.
-        auto animator = std::make_unique<Animator>(*shell, task_runners,
-                                                   std::move(vsync_waiter));
-
-        engine_promise.set_value(std::make_unique<Engine>(
-            *shell,                         //
-            dispatcher_maker,               //
-            *shell->GetDartVM(),            //
-            std::move(isolate_snapshot),    //
-            task_runners,                   //
-            window_data,                    //
-            shell->GetSettings(),           //
-            std::move(animator),            //
-            weak_io_manager_future.get(),   //
-            unref_queue_future.get(),       //
-            snapshot_delegate_future.get()  //
-            ));
+        auto animator = std::make_unique<Animator>(
+            *shell, task_runners, std::move(vsync_waiter),
+            shell->GetSettings().adaptive_pipeline_depth);
+
+        engine_promise.set_value(
+            on_create_engine(*shell,                         //
+                             dispatcher_maker,               //
+                             *shell->GetDartVM(),            //
+                             std::move(isolate_snapshot),    //
+                             task_runners,                   //
+                             window_data,                    //
+                             shell->GetSettings(),           //
+                             std::move(animator),            //
+                             weak_io_manager_future.get(),   //
+                             unref_queue_future.get(),       //
+                             snapshot_delegate_future.get()  //
+                             ));
       }));
 
   if (!shell->Setup(std::move(platform_view),  //
@@ -205,6 +250,15 @@ static void PerformInitializationTasks(const Settings& settings) {
       InitSkiaEventTracer(settings.trace_skia);
     }
 
+    if (!settings.trace_categories.empty()) {
+      fml::tracing::SetEnabledTraceCategories(
+          fml::tracing::TraceCategoriesFromNames(settings.trace_categories));
+    }
+
+    if (settings.trace_to_buffer) {
+      fml::tracing::StartTraceBuffer();
+    }
+
     if (!settings.skia_deterministic_rendering_on_cpu) {
       SkGraphics::Init();
     } else {
@@ -244,6 +298,7 @@ std::unique_ptr<Shell> Shell::Create(
     Shell::CreateCallback<Rasterizer> on_create_rasterizer) {
   PerformInitializationTasks(settings);
   PersistentCache::SetCacheSkSL(settings.cache_sksl);
+  PersistentCache::SetCacheShapedRuns(settings.cache_shaped_runs);
 
   TRACE_EVENT0("flutter", "Shell::Create");
 
@@ -272,6 +327,7 @@ std::unique_ptr<Shell> Shell::Create(
     DartVMRef vm) {
   PerformInitializationTasks(settings);
   PersistentCache::SetCacheSkSL(settings.cache_sksl);
+  PersistentCache::SetCacheShapedRuns(settings.cache_shaped_runs);
 
   TRACE_EVENT0("flutter", "Shell::CreateWithSnapshots");
 
@@ -294,25 +350,79 @@ std::unique_ptr<Shell> Shell::Create(
                          on_create_platform_view,                         //
                          on_create_rasterizer                             //
   ]() mutable {
-        shell = CreateShellOnPlatformThread(std::move(vm),
-                                            std::move(task_runners),      //
-                                            window_data,                  //
-                                            settings,                     //
-                                            std::move(isolate_snapshot),  //
-                                            on_create_platform_view,      //
-                                            on_create_rasterizer          //
-        );
+        shell = CreateShellOnPlatformThread(
+            std::move(vm), std::move(task_runners), window_data, settings,
+            std::move(isolate_snapshot), on_create_platform_view,
+            on_create_rasterizer, CreateEngine,
+            nullptr,  // parent io manager
+            std::make_shared<fml::SyncSwitch>());
         latch.Signal();
       }));
   latch.Wait();
   return shell;
 }
 
-Shell::Shell(DartVMRef vm, TaskRunners task_runners, Settings settings)
+std::unique_ptr<Shell> Shell::Spawn(
+    RunConfiguration run_configuration,
+    const WindowData window_data,
+    const CreateCallback<PlatformView>& on_create_platform_view,
+    const CreateCallback<Rasterizer>& on_create_rasterizer) const {
+  FML_DCHECK(is_setup_);
+  FML_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
+  TRACE_EVENT0("flutter", "Shell::Spawn");
+
+  if (!on_create_platform_view || !on_create_rasterizer) {
+    return nullptr;
+  }
+
+  // The engine is spawned from the engine of this shell on the UI task runner,
+  // which both shells share.
+  auto on_create_engine =
+      [parent_engine = weak_engine_](
+          Engine::Delegate& delegate,
+          const PointerDataDispatcherMaker& dispatcher_maker,
+          DartVM& vm,
+          fml::RefPtr<const DartSnapshot> isolate_snapshot,
+          TaskRunners task_runners,
+          const WindowData window_data,
+          Settings settings,
+          std::unique_ptr<Animator> animator,
+          fml::WeakPtr<IOManager> io_manager,
+          fml::RefPtr<SkiaUnrefQueue> unref_queue,
+          fml::WeakPtr<SnapshotDelegate> snapshot_delegate)
+      -> std::unique_ptr<Engine> {
+    if (!parent_engine) {
+      return nullptr;
+    }
+    return parent_engine->Spawn(delegate, dispatcher_maker, window_data,
+                                std::move(settings), std::move(animator),
+                                std::move(snapshot_delegate));
+  };
+
+  auto shell = CreateShellOnPlatformThread(
+      vm_, task_runners_, window_data, settings_,
+      nullptr,  // isolate snapshot, shared through the parent engine
+      on_create_platform_view, on_create_rasterizer, on_create_engine,
+      io_manager_, is_gpu_disabled_sync_switch_);
+  if (!shell) {
+    return nullptr;
+  }
+
+  shell->RunEngine(std::move(run_configuration));
+  return shell;
+}
+
+Shell::Shell(DartVMRef vm,
+             TaskRunners task_runners,
+             Settings settings,
+             std::shared_ptr<fml::SyncSwitch> is_gpu_disabled_sync_switch)
     : task_runners_(std::move(task_runners)),
       settings_(std::move(settings)),
       vm_(std::move(vm)),
-      is_gpu_disabled_sync_switch_(new fml::SyncSwitch()),
+      is_gpu_disabled_sync_switch_(std::move(is_gpu_disabled_sync_switch)),
+      semantics_encoder_(settings_.encode_semantics_updates
+                             ? std::make_shared<SemanticsUpdateEncoder>()
+                             : nullptr),
       weak_factory_(this),
       weak_factory_gpu_(nullptr) {
   FML_CHECK(vm_) << "Must have access to VM to create a shell.";
@@ -357,6 +467,14 @@ Shell::Shell(DartVMRef vm, TaskRunners task_runners, Settings settings)
           task_runners_.GetUITaskRunner(),
           std::bind(&Shell::OnServiceProtocolGetDisplayRefreshRate, this,
                     std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_[ServiceProtocol::kGetFrameRecordsExtensionName] =
+      {task_runners_.GetUITaskRunner(),
+       std::bind(&Shell::OnServiceProtocolGetFrameRecords, this,
+                 std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_[ServiceProtocol::kGetTraceBufferExtensionName] =
+      {task_runners_.GetIOTaskRunner(),
+       std::bind(&Shell::OnServiceProtocolGetTraceBuffer, this,
+                 std::placeholders::_1, std::placeholders::_2)};
 }
 
 Shell::~Shell() {
@@ -389,7 +507,9 @@ Shell::~Shell() {
   fml::TaskRunner::RunNowOrPostTask(
       task_runners_.GetIOTaskRunner(),
       fml::MakeCopyable([io_manager = std::move(io_manager_),
-                         platform_view = platform_view_.get(),
+                         platform_view = shares_io_manager_
+                                             ? nullptr
+                                             : platform_view_.get(),
                          &io_latch]() mutable {
         io_manager.reset();
         if (platform_view) {
@@ -426,6 +546,13 @@ void Shell::NotifyLowMemoryWarning() const {
           rasterizer->NotifyLowMemoryWarning();
         }
       });
+  // Decoded images are cached by the engine's image decoder.
+  task_runners_.GetUITaskRunner()->PostTask(
+      [engine = weak_engine_]() {
+        if (engine) {
+          engine->NotifyLowMemoryWarning();
+        }
+      });
   // The IO Manager uses resource cache limits of 0, so it is not necessary
   // to purge them.
 }
@@ -505,7 +632,7 @@ bool Shell::IsSetup() const {
 bool Shell::Setup(std::unique_ptr<PlatformView> platform_view,
                   std::unique_ptr<Engine> engine,
                   std::unique_ptr<Rasterizer> rasterizer,
-                  std::unique_ptr<ShellIOManager> io_manager) {
+                  std::shared_ptr<ShellIOManager> io_manager) {
   if (is_setup_) {
     return false;
   }
@@ -550,6 +677,11 @@ const Settings& Shell::GetSettings() const {
   return settings_;
 }
 
+std::shared_ptr<fml::ConcurrentTaskRunner>
+Shell::GetConcurrentWorkerTaskRunner() {
+  return vm_->GetConcurrentWorkerTaskRunner();
+}
+
 const TaskRunners& Shell::GetTaskRunners() const {
   return task_runners_;
 }
@@ -812,7 +944,12 @@ void Shell::OnPlatformViewSetSemanticsEnabled(bool enabled) {
   FML_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
 
   task_runners_.GetUITaskRunner()->PostTask(
-      [engine = engine_->GetWeakPtr(), enabled] {
+      [engine = engine_->GetWeakPtr(), encoder = semantics_encoder_, enabled] {
+        // The framework sends a whole new tree once semantics are enabled
+        // again.
+        if (encoder && !enabled) {
+          encoder->Reset();
+        }
         if (engine) {
           engine->SetSemanticsEnabled(enabled);
         }
@@ -959,12 +1096,44 @@ void Shell::OnAnimatorDrawLastLayerTree() {
       });
 }
 
+// |Animator::Delegate|
+void Shell::OnAnimatorFrameDropped(fml::TimePoint frame_target_time) {
+  FML_DCHECK(is_setup_);
+  FML_DCHECK(task_runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+
+  FrameRecord record;
+  record.status = FrameRecord::Status::kDropped;
+  record.timing.SetVsyncTarget(frame_target_time);
+  RecordFrame(record);
+}
+
 // |Engine::Delegate|
 void Shell::OnEngineUpdateSemantics(SemanticsNodeUpdates update,
                                     CustomAccessibilityActionUpdates actions) {
   FML_DCHECK(is_setup_);
   FML_DCHECK(task_runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
 
+  if (semantics_encoder_) {
+    // Encoding on the UI thread leaves the platform thread with only the
+    // changes to apply.
+    EncodedSemanticsUpdate encoded =
+        semantics_encoder_->Encode(std::move(update));
+    if (encoded.nodes.empty() && encoded.removedNodes.empty() &&
+        actions.empty()) {
+      return;
+    }
+    task_runners_.GetPlatformTaskRunner()->PostTask(
+        fml::MakeCopyable([view = platform_view_->GetWeakPtr(),
+                           encoded = std::move(encoded),
+                           actions = std::move(actions)]() mutable {
+          if (view) {
+            view->UpdateEncodedSemantics(std::move(encoded),
+                                         std::move(actions));
+          }
+        }));
+    return;
+  }
+
   task_runners_.GetPlatformTaskRunner()->PostTask(
       [view = platform_view_->GetWeakPtr(), update = std::move(update),
        actions = std::move(actions)] {
@@ -997,7 +1166,8 @@ void Shell::HandleEngineSkiaMessage(fml::RefPtr<PlatformMessage> message) {
   const auto& data = message->data();
 
   rapidjson::Document document;
-  document.Parse(reinterpret_cast<const char*>(data.data()), data.size());
+  document.Parse(reinterpret_cast<const char*>(data.GetMapping()),
+                 data.GetSize());
   if (document.HasParseError() || !document.IsObject())
     return;
   auto root = document.GetObject();
@@ -1085,6 +1255,8 @@ void Shell::OnFrameRasterized(const FrameTiming& timing) {
     settings_.frame_rasterized_callback(timing);
   }
 
+  RecordFrame({FrameRecord::Status::kRasterized, timing});
+
   if (!needs_report_timings_) {
     return;
   }
@@ -1142,6 +1314,30 @@ fml::Milliseconds Shell::GetFrameBudget() {
   }
 }
 
+// |Rasterizer::Delegate|
+void Shell::OnFrameCoalesced(const FrameTiming& timing) {
+  FML_DCHECK(is_setup_);
+  FML_DCHECK(task_runners_.GetGPUTaskRunner()->RunsTasksOnCurrentThread());
+
+  RecordFrame({FrameRecord::Status::kCoalesced, timing});
+}
+
+void Shell::RecordFrame(const FrameRecord& record) {
+  if (settings_.frame_record_callback) {
+    settings_.frame_record_callback(record);
+  }
+
+  // About ten seconds worth of frames at 60hz.
+  constexpr size_t kMaxFrameRecords = 600;
+
+  std::scoped_lock lock(frame_records_mutex_);
+  frame_records_.push_back(record);
+  if (frame_records_.size() > kMaxFrameRecords) {
+    frame_records_.pop_front();
+    evicted_frame_records_++;
+  }
+}
+
 // |ServiceProtocol::Handler|
 fml::RefPtr<fml::TaskRunner> Shell::GetServiceProtocolHandlerTaskRunner(
     std::string_view method) const {
@@ -1337,6 +1533,136 @@ bool Shell::OnServiceProtocolGetDisplayRefreshRate(
   return true;
 }
 
+static const char* FrameRecordStatusName(FrameRecord::Status status) {
+  switch (status) {
+    case FrameRecord::Status::kRasterized:
+      return "rasterized";
+    case FrameRecord::Status::kDropped:
+      return "dropped";
+    case FrameRecord::Status::kCoalesced:
+      return "coalesced";
+  }
+  return "unknown";
+}
+
+static void AddFrameRecordTime(rapidjson::Value& record,
+                               const char* name,
+                               fml::TimePoint time,
+                               rapidjson::Document::AllocatorType& allocator) {
+  if (time == fml::TimePoint()) {
+    return;
+  }
+  rapidjson::Value key(name, allocator);
+  record.AddMember(key, time.ToEpochDelta().ToMicroseconds(), allocator);
+}
+
+// Service protocol handler
+//
+// Returns the records of the most recent frames. Times are in microseconds
+// since the epoch and missing when the frame never reached that phase. Pass
+// the returned `nextIndex` as `since` to only get the frames that were
+// recorded after this call.
+bool Shell::OnServiceProtocolGetFrameRecords(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document& response) {
+  FML_DCHECK(task_runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+
+  size_t since = 0;
+  auto since_param = params.find("since");
+  if (since_param != params.end()) {
+    const std::string since_string(since_param->second);
+    char* end = nullptr;
+    since = std::strtoull(since_string.c_str(), &end, 10);
+    if (since_string.empty() || *end != '\0') {
+      ServiceProtocolParameterError(response,
+                                    "'since' must be a non-negative integer.");
+      return false;
+    }
+  }
+
+  auto& allocator = response.GetAllocator();
+  response.SetObject();
+  response.AddMember("type", "FrameRecords", allocator);
+
+  rapidjson::Value records(rapidjson::kArrayType);
+  size_t next_index = 0;
+  {
+    std::scoped_lock lock(frame_records_mutex_);
+    next_index = evicted_frame_records_ + frame_records_.size();
+    const size_t first =
+        since > evicted_frame_records_ ? since - evicted_frame_records_ : 0;
+    for (size_t i = first; i < frame_records_.size(); i++) {
+      const FrameRecord& frame = frame_records_[i];
+      rapidjson::Value record(rapidjson::kObjectType);
+      record.AddMember("index",
+                       static_cast<uint64_t>(evicted_frame_records_ + i),
+                       allocator);
+      record.AddMember(
+          "status", rapidjson::StringRef(FrameRecordStatusName(frame.status)),
+          allocator);
+      AddFrameRecordTime(record, "vsyncTarget", frame.timing.GetVsyncTarget(),
+                         allocator);
+      AddFrameRecordTime(record, "buildStart",
+                         frame.timing.Get(FrameTiming::kBuildStart), allocator);
+      AddFrameRecordTime(record, "buildFinish",
+                         frame.timing.Get(FrameTiming::kBuildFinish),
+                         allocator);
+      AddFrameRecordTime(record, "rasterStart",
+                         frame.timing.Get(FrameTiming::kRasterStart),
+                         allocator);
+      AddFrameRecordTime(record, "rasterFinish",
+                         frame.timing.Get(FrameTiming::kRasterFinish),
+                         allocator);
+      records.PushBack(record, allocator);
+    }
+  }
+  response.AddMember("records", records, allocator);
+  response.AddMember("nextIndex", static_cast<uint64_t>(next_index),
+                     allocator);
+  return true;
+}
+
+// Service protocol handler
+//
+// Exports the events in the trace buffer that --trace-to-buffer records. The
+// `format` is `json` for a Chrome JSON trace, which is the default, or
+// `perfetto` for a base64 encoded Perfetto trace.
+bool Shell::OnServiceProtocolGetTraceBuffer(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document& response) {
+  FML_DCHECK(task_runners_.GetIOTaskRunner()->RunsTasksOnCurrentThread());
+
+  std::string format = "json";
+  auto format_param = params.find("format");
+  if (format_param != params.end()) {
+    format = std::string(format_param->second);
+  }
+
+  std::string trace;
+  if (format == "json") {
+    trace = fml::tracing::ExportTraceBufferAsChromeJSON();
+  } else if (format == "perfetto") {
+    const std::string proto = fml::tracing::ExportTraceBufferAsPerfetto();
+    trace.resize(SkBase64::Encode(proto.data(), proto.size(), nullptr));
+    SkBase64::Encode(proto.data(), proto.size(), trace.data());
+  } else {
+    ServiceProtocolParameterError(response,
+                                  "'format' must be 'json' or 'perfetto'.");
+    return false;
+  }
+
+  auto& allocator = response.GetAllocator();
+  response.SetObject();
+  response.AddMember("type", "TraceBuffer", allocator);
+  response.AddMember("recording", fml::tracing::IsTraceBufferRecording(),
+                     allocator);
+  rapidjson::Value format_value(format.c_str(), allocator);
+  response.AddMember("format", format_value, allocator);
+  rapidjson::Value trace_value(trace.c_str(), trace.size(), allocator);
+  response.AddMember("trace", trace_value, allocator);
+  return true;
+}
+
 // Service protocol handler
 bool Shell::OnServiceProtocolSetAssetBundlePath(
     const ServiceProtocol::Handler::ServiceProtocolMap& params,
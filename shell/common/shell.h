@@ -5,6 +5,7 @@
 #ifndef SHELL_COMMON_SHELL_H_
 #define SHELL_COMMON_SHELL_H_
 
+#include <deque>
 #include <functional>
 #include <string_view>
 #include <unordered_map>
@@ -23,6 +24,7 @@
 #include "flutter/fml/thread.h"
 #include "flutter/lib/ui/semantics/custom_accessibility_action.h"
 #include "flutter/lib/ui/semantics/semantics_node.h"
+#include "flutter/lib/ui/semantics/semantics_update_encoder.h"
 #include "flutter/lib/ui/window/platform_message.h"
 #include "flutter/runtime/dart_vm_lifecycle.h"
 #include "flutter/runtime/service_protocol.h"
@@ -208,6 +210,39 @@ class Shell final : public PlatformView::Delegate,
       const CreateCallback<Rasterizer>& on_create_rasterizer,
       DartVMRef vm);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Creates a shell for another view of the same application and
+  ///             runs it. The spawned shell shares the task runners, the VM,
+  ///             the isolate snapshot, the IO manager and its resource context,
+  ///             the font collection and the image decoder of this shell. It
+  ///             only creates its own platform view, rasterizer, engine and
+  ///             root isolate, which makes it much faster to set up than a
+  ///             shell created from scratch.
+  ///
+  ///             This shell must outlive the shells spawned from it, as they
+  ///             use the resource context of its platform view. Must be called
+  ///             on the platform task runner.
+  ///
+  /// @param[in]  run_configuration        The configuration to run the spawned
+  ///                                      engine with. When it uses the asset
+  ///                                      manager this shell was run with, the
+  ///                                      fonts in the assets are not
+  ///                                      registered again.
+  /// @param[in]  window_data              The default data for setting up
+  ///                                      ui.Window of the new view.
+  /// @param[in]  on_create_platform_view  The callback that must return a
+  ///                                      platform view for the new view.
+  /// @param[in]  on_create_rasterizer     The callback that must return a
+  ///                                      rasterizer for the new view.
+  ///
+  /// @return     The spawned shell, or nullptr if it could not be set up.
+  ///
+  std::unique_ptr<Shell> Spawn(
+      RunConfiguration run_configuration,
+      const WindowData window_data,
+      const CreateCallback<PlatformView>& on_create_platform_view,
+      const CreateCallback<Rasterizer>& on_create_rasterizer) const;
+
   //----------------------------------------------------------------------------
   /// @brief      Destroys the shell. This is a synchronous operation and
   ///             synchronous barrier blocks are introduced on the various
@@ -232,7 +267,7 @@ class Shell final : public PlatformView::Delegate,
   //------------------------------------------------------------------------------
   /// @return     The settings used to launch this shell.
   ///
-  const Settings& GetSettings() const;
+  const Settings& GetSettings() const override;
 
   //------------------------------------------------------------------------------
   /// @brief      If callers wish to interact directly with any shell
@@ -248,6 +283,15 @@ class Shell final : public PlatformView::Delegate,
   ///
   const TaskRunners& GetTaskRunners() const;
 
+  //----------------------------------------------------------------------------
+  /// @brief      The workers of the VM are shared by all shells in the process.
+  ///             Shell subcomponents may use them for work that is split up
+  ///             to run in parallel.
+  ///
+  /// @return     The task runner of the concurrent workers.
+  ///
+  std::shared_ptr<fml::ConcurrentTaskRunner> GetConcurrentWorkerTaskRunner();
+
   //----------------------------------------------------------------------------
   /// @brief      Rasterizers may only be accessed on the GPU task runner.
   ///
@@ -363,8 +407,14 @@ class Shell final : public PlatformView::Delegate,
   std::unique_ptr<PlatformView> platform_view_;  // on platform task runner
   std::unique_ptr<Engine> engine_;               // on UI task runner
   std::unique_ptr<Rasterizer> rasterizer_;       // on GPU task runner
-  std::unique_ptr<ShellIOManager> io_manager_;   // on IO task runner
+  std::shared_ptr<ShellIOManager> io_manager_;   // on IO task runner
+  // Spawned shells use the resource context of the shell they were spawned
+  // from, so it is not theirs to release.
+  bool shares_io_manager_ = false;
   std::shared_ptr<fml::SyncSwitch> is_gpu_disabled_sync_switch_;
+  // Only set if |Settings::encode_semantics_updates| is. Shared with the tasks
+  // that use it on the UI task runner.
+  std::shared_ptr<SemanticsUpdateEncoder> semantics_encoder_;
 
   fml::WeakPtr<Engine> weak_engine_;          // to be shared across threads
   fml::WeakPtr<Rasterizer> weak_rasterizer_;  // to be shared across threads
@@ -398,6 +448,15 @@ class Shell final : public PlatformView::Delegate,
   // here for easier conversions to Dart objects.
   std::vector<int64_t> unreported_timings_;
 
+  // The records of the most recent frames, oldest first, served by the
+  // `_flutter.getFrameRecords` service protocol extension. Dropped frames are
+  // recorded on the UI thread and all others on the GPU thread.
+  std::mutex frame_records_mutex_;
+  std::deque<FrameRecord> frame_records_;
+  // The number of records evicted from the front of |frame_records_|, which
+  // is the index of its first record among all frames ever recorded.
+  size_t evicted_frame_records_ = 0;
+
   // A cache of `Engine::GetDisplayRefreshRate` (only callable in the UI thread)
   // so we can access it from `Rasterizer` (in the GPU thread).
   //
@@ -408,8 +467,29 @@ class Shell final : public PlatformView::Delegate,
   // How many frames have been timed since last report.
   size_t UnreportedFramesCount() const;
 
-  Shell(DartVMRef vm, TaskRunners task_runners, Settings settings);
+  // Hands the record to |Settings::frame_record_callback| and keeps it for
+  // the service protocol.
+  void RecordFrame(const FrameRecord& record);
 
+  using EngineCreateCallback = std::function<std::unique_ptr<Engine>(
+      Engine::Delegate& delegate,
+      const PointerDataDispatcherMaker& dispatcher_maker,
+      DartVM& vm,
+      fml::RefPtr<const DartSnapshot> isolate_snapshot,
+      TaskRunners task_runners,
+      const WindowData window_data,
+      Settings settings,
+      std::unique_ptr<Animator> animator,
+      fml::WeakPtr<IOManager> io_manager,
+      fml::RefPtr<SkiaUnrefQueue> unref_queue,
+      fml::WeakPtr<SnapshotDelegate> snapshot_delegate)>;
+
+  Shell(DartVMRef vm,
+        TaskRunners task_runners,
+        Settings settings,
+        std::shared_ptr<fml::SyncSwitch> is_gpu_disabled_sync_switch);
+
+  // Creates the IO manager unless a |parent_io_manager| is given to share.
   static std::unique_ptr<Shell> CreateShellOnPlatformThread(
       DartVMRef vm,
       TaskRunners task_runners,
@@ -417,12 +497,15 @@ class Shell final : public PlatformView::Delegate,
       Settings settings,
       fml::RefPtr<const DartSnapshot> isolate_snapshot,
       const Shell::CreateCallback<PlatformView>& on_create_platform_view,
-      const Shell::CreateCallback<Rasterizer>& on_create_rasterizer);
+      const Shell::CreateCallback<Rasterizer>& on_create_rasterizer,
+      const EngineCreateCallback& on_create_engine,
+      std::shared_ptr<ShellIOManager> parent_io_manager,
+      std::shared_ptr<fml::SyncSwitch> is_gpu_disabled_sync_switch);
 
   bool Setup(std::unique_ptr<PlatformView> platform_view,
              std::unique_ptr<Engine> engine,
              std::unique_ptr<Rasterizer> rasterizer,
-             std::unique_ptr<ShellIOManager> io_manager);
+             std::shared_ptr<ShellIOManager> io_manager);
 
   DartVM* GetDartVM();
 
@@ -484,6 +567,9 @@ class Shell final : public PlatformView::Delegate,
   // |Animator::Delegate|
   void OnAnimatorDrawLastLayerTree() override;
 
+  // |Animator::Delegate|
+  void OnAnimatorFrameDropped(fml::TimePoint frame_target_time) override;
+
   // |Engine::Delegate|
   void OnEngineUpdateSemantics(
       SemanticsNodeUpdates update,
@@ -508,6 +594,9 @@ class Shell final : public PlatformView::Delegate,
   // |Rasterizer::Delegate|
   void OnFrameRasterized(const FrameTiming&) override;
 
+  // |Rasterizer::Delegate|
+  void OnFrameCoalesced(const FrameTiming&) override;
+
   // |Rasterizer::Delegate|
   fml::Milliseconds GetFrameBudget() override;
 
@@ -555,6 +644,16 @@ class Shell final : public PlatformView::Delegate,
       const ServiceProtocol::Handler::ServiceProtocolMap& params,
       rapidjson::Document& response);
 
+  // Service protocol handler
+  bool OnServiceProtocolGetFrameRecords(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document& response);
+
+  // Service protocol handler
+  bool OnServiceProtocolGetTraceBuffer(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document& response);
+
   fml::WeakPtrFactory<Shell> weak_factory_;
 
   // For accessing the Shell via the GPU thread, necessary for various
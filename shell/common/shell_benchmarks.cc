@@ -2,15 +2,68 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <inttypes.h>
+#include <stdio.h>
+
 #include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/build_config.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/runtime/dart_vm.h"
+#include "flutter/runtime/dart_vm_lifecycle.h"
+#include "flutter/shell/common/run_configuration.h"
 #include "flutter/shell/common/shell.h"
 #include "flutter/shell/common/thread_host.h"
+#include "flutter/shell/gpu/tiled_software_rasterizer.h"
 #include "flutter/testing/testing.h"
+#include "third_party/skia/include/core/SkBBHFactory.h"
+#include "third_party/skia/include/core/SkMaskFilter.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/effects/SkGradientShader.h"
+
+#if OS_LINUX
+#include <unistd.h>
+#endif  // OS_LINUX
 
 namespace flutter {
 
+static Settings CreateSettings(const fml::UniqueFD& assets_dir) {
+  Settings settings = {};
+  settings.task_observer_add = [](intptr_t, fml::closure) {};
+  settings.task_observer_remove = [](intptr_t) {};
+
+  if (DartVM::IsRunningPrecompiledCode()) {
+    settings.vm_snapshot_data = [&]() {
+      return fml::FileMapping::CreateReadOnly(assets_dir, "vm_snapshot_data");
+    };
+
+    settings.isolate_snapshot_data = [&]() {
+      return fml::FileMapping::CreateReadOnly(assets_dir,
+                                              "isolate_snapshot_data");
+    };
+
+    settings.vm_snapshot_instr = [&]() {
+      return fml::FileMapping::CreateReadExecute(assets_dir,
+                                                 "vm_snapshot_instr");
+    };
+
+    settings.isolate_snapshot_instr = [&]() {
+      return fml::FileMapping::CreateReadExecute(assets_dir,
+                                                 "isolate_snapshot_instr");
+    };
+
+  } else {
+    settings.application_kernels = [&]() {
+      std::vector<std::unique_ptr<const fml::Mapping>> kernel_mappings;
+      kernel_mappings.emplace_back(
+          fml::FileMapping::CreateReadOnly(assets_dir, "kernel_blob.bin"));
+      return kernel_mappings;
+    };
+  }
+  return settings;
+}
+
 static void StartupAndShutdownShell(benchmark::State& state,
                                     bool measure_startup,
                                     bool measure_shutdown) {
@@ -20,38 +73,7 @@ static void StartupAndShutdownShell(benchmark::State& state,
   std::unique_ptr<ThreadHost> thread_host;
   {
     benchmarking::ScopedPauseTiming pause(state, !measure_startup);
-    Settings settings = {};
-    settings.task_observer_add = [](intptr_t, fml::closure) {};
-    settings.task_observer_remove = [](intptr_t) {};
-
-    if (DartVM::IsRunningPrecompiledCode()) {
-      settings.vm_snapshot_data = [&]() {
-        return fml::FileMapping::CreateReadOnly(assets_dir, "vm_snapshot_data");
-      };
-
-      settings.isolate_snapshot_data = [&]() {
-        return fml::FileMapping::CreateReadOnly(assets_dir,
-                                                "isolate_snapshot_data");
-      };
-
-      settings.vm_snapshot_instr = [&]() {
-        return fml::FileMapping::CreateReadExecute(assets_dir,
-                                                   "vm_snapshot_instr");
-      };
-
-      settings.isolate_snapshot_instr = [&]() {
-        return fml::FileMapping::CreateReadExecute(assets_dir,
-                                                   "isolate_snapshot_instr");
-      };
-
-    } else {
-      settings.application_kernels = [&]() {
-        std::vector<std::unique_ptr<const fml::Mapping>> kernel_mappings;
-        kernel_mappings.emplace_back(
-            fml::FileMapping::CreateReadOnly(assets_dir, "kernel_blob.bin"));
-        return kernel_mappings;
-      };
-    }
+    Settings settings = CreateSettings(assets_dir);
 
     thread_host = std::make_unique<ThreadHost>(
         "io.flutter.bench.", ThreadHost::Type::Platform |
@@ -117,4 +139,245 @@ static void BM_ShellInitializationAndShutdown(benchmark::State& state) {
 
 BENCHMARK(BM_ShellInitializationAndShutdown);
 
+// The resident set size of the process in kilobytes, or zero where it is not
+// known.
+static int64_t GetResidentSetSizeKB() {
+#if OS_LINUX
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if (!statm) {
+    return 0;
+  }
+  int64_t total_pages = 0;
+  int64_t resident_pages = 0;
+  const int fields = fscanf(statm, "%" SCNd64 " %" SCNd64, &total_pages,
+                            &resident_pages);
+  fclose(statm);
+  if (fields != 2) {
+    return 0;
+  }
+  return resident_pages * (sysconf(_SC_PAGESIZE) / 1024);
+#else
+  return 0;
+#endif  // OS_LINUX
+}
+
+static std::unique_ptr<PlatformView> CreatePlatformView(Shell& shell) {
+  return std::make_unique<PlatformView>(shell, shell.GetTaskRunners());
+}
+
+static std::unique_ptr<Rasterizer> CreateRasterizer(Shell& shell) {
+  return std::make_unique<Rasterizer>(shell, shell.GetTaskRunners());
+}
+
+static void RunOnPlatformThread(const TaskRunners& task_runners,
+                                const fml::closure& task) {
+  fml::AutoResetWaitableEvent latch;
+  fml::TaskRunner::RunNowOrPostTask(task_runners.GetPlatformTaskRunner(),
+                                    [&task, &latch]() {
+                                      task();
+                                      latch.Signal();
+                                    });
+  latch.Wait();
+}
+
+// Waits for the tasks posted to the UI task runner of the shell so far, like
+// the one that launches its root isolate.
+static void FlushUITasks(const Shell& shell) {
+  fml::AutoResetWaitableEvent latch;
+  fml::TaskRunner::RunNowOrPostTask(shell.GetTaskRunners().GetUITaskRunner(),
+                                    [&latch]() { latch.Signal(); });
+  latch.Wait();
+}
+
+// Starts and runs |state.range(0)| views, as a process hosting that many views
+// does. Either each view gets a shell of its own, with its own threads, or the
+// shells of the other views are spawned from the shell of the first one.
+static void StartViews(benchmark::State& state, bool spawn) {
+  const int64_t view_count = state.range(0);
+  auto assets_dir = fml::OpenDirectory(testing::GetFixturesPath(), false,
+                                       fml::FilePermission::kRead);
+  const Settings settings = CreateSettings(assets_dir);
+  // Keeps the VM running between iterations, so that its startup is not
+  // measured.
+  auto vm = DartVMRef::Create(settings);
+  int64_t resident_kb = 0;
+
+  while (state.KeepRunning()) {
+    std::vector<std::unique_ptr<ThreadHost>> thread_hosts;
+    std::vector<std::unique_ptr<Shell>> shells;
+    std::shared_ptr<AssetManager> asset_manager;
+    const int64_t resident_kb_before = GetResidentSetSizeKB();
+
+    for (int64_t i = 0; i < view_count; i++) {
+      std::unique_ptr<Shell> shell;
+      if (spawn && !shells.empty()) {
+        const Shell& parent = *shells.front();
+        RunOnPlatformThread(parent.GetTaskRunners(), [&]() {
+          RunConfiguration configuration(
+              IsolateConfiguration::InferFromSettings(settings, asset_manager,
+                                                      nullptr),
+              asset_manager);
+          shell = parent.Spawn(std::move(configuration), WindowData{},
+                               CreatePlatformView, CreateRasterizer);
+        });
+      } else {
+        thread_hosts.push_back(std::make_unique<ThreadHost>(
+            "io.flutter.bench.", ThreadHost::Type::Platform |
+                                     ThreadHost::Type::GPU |
+                                     ThreadHost::Type::IO |
+                                     ThreadHost::Type::UI));
+        const ThreadHost& thread_host = *thread_hosts.back();
+        shell = Shell::Create(
+            TaskRunners("test", thread_host.platform_thread->GetTaskRunner(),
+                        thread_host.gpu_thread->GetTaskRunner(),
+                        thread_host.ui_thread->GetTaskRunner(),
+                        thread_host.io_thread->GetTaskRunner()),
+            settings, CreatePlatformView, CreateRasterizer);
+        FML_CHECK(shell);
+        RunOnPlatformThread(shell->GetTaskRunners(), [&]() {
+          auto configuration = RunConfiguration::InferFromSettings(settings);
+          asset_manager = configuration.GetAssetManager();
+          shell->RunEngine(std::move(configuration));
+        });
+      }
+      FML_CHECK(shell);
+      shells.push_back(std::move(shell));
+    }
+    for (const auto& shell : shells) {
+      FlushUITasks(*shell);
+    }
+    resident_kb += GetResidentSetSizeKB() - resident_kb_before;
+
+    benchmarking::ScopedPauseTiming pause(state);
+    // Spawned shells must be destroyed before the shell they were spawned
+    // from.
+    while (!shells.empty()) {
+      std::unique_ptr<Shell> shell = std::move(shells.back());
+      shells.pop_back();
+      const TaskRunners task_runners = shell->GetTaskRunners();
+      RunOnPlatformThread(task_runners, [&shell]() { shell.reset(); });
+    }
+    thread_hosts.clear();
+  }
+
+  state.SetItemsProcessed(state.iterations() * view_count);
+  state.counters["rss_kb_per_view"] =
+      static_cast<double>(resident_kb) / (state.iterations() * view_count);
+}
+
+static void BM_ShellCreateViews(benchmark::State& state) {
+  StartViews(state, false);
+}
+
+BENCHMARK(BM_ShellCreateViews)
+    ->Arg(1)
+    ->Arg(6)
+    ->Arg(12)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_ShellSpawnViews(benchmark::State& state) {
+  StartViews(state, true);
+}
+
+BENCHMARK(BM_ShellSpawnViews)
+    ->Arg(1)
+    ->Arg(6)
+    ->Arg(12)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// A frame of a scrolling list of cards, each with a blurred shadow, a gradient
+// header and some antialiased shapes.
+static sk_sp<SkPicture> MakeListFrame(const SkISize& size) {
+  SkPictureRecorder recorder;
+  SkRTreeFactory rtree_factory;
+  SkCanvas* canvas = recorder.beginRecording(
+      SkRect::MakeIWH(size.width(), size.height()), &rtree_factory);
+  canvas->drawColor(SK_ColorWHITE);
+
+  SkPaint shadow;
+  shadow.setColor(0x40000000);
+  shadow.setMaskFilter(SkMaskFilter::MakeBlur(kNormal_SkBlurStyle, 6));
+  SkPaint card;
+  card.setAntiAlias(true);
+  card.setColor(0xFFFAFAFA);
+  SkPaint shape;
+  shape.setAntiAlias(true);
+  SkPaint outline;
+  outline.setAntiAlias(true);
+  outline.setStyle(SkPaint::kStroke_Style);
+  outline.setStrokeWidth(3);
+
+  const SkScalar card_width = size.width() / 4.0f;
+  const SkScalar card_height = 180;
+  for (SkScalar y = 10; y < size.height(); y += card_height + 20) {
+    for (SkScalar x = 10; x < size.width(); x += card_width) {
+      const SkRect bounds =
+          SkRect::MakeXYWH(x, y, card_width - 20, card_height);
+      const SkRRect rrect = SkRRect::MakeRectXY(bounds, 12, 12);
+      canvas->drawRRect(rrect.makeOffset(0, 4), shadow);
+      canvas->drawRRect(rrect, card);
+
+      const SkPoint points[] = {{bounds.left(), bounds.top()},
+                                {bounds.right(), bounds.top() + 60}};
+      const SkColor colors[] = {0xFF2196F3, 0xFF9C27B0};
+      SkPaint header;
+      header.setAntiAlias(true);
+      header.setShader(SkGradientShader::MakeLinear(points, colors, nullptr, 2,
+                                                    SkTileMode::kClamp));
+      canvas->save();
+      canvas->clipRRect(rrect, true);
+      canvas->drawRect(SkRect::MakeLTRB(bounds.left(), bounds.top(),
+                                        bounds.right(), bounds.top() + 60),
+                       header);
+      canvas->restore();
+
+      for (int i = 0; i < 8; i++) {
+        shape.setColor(SkColorSetARGB(0xFF, 30 * i, 200 - 20 * i, 120));
+        const SkPoint center = {bounds.left() + 30 + i * 40,
+                                bounds.top() + 110};
+        canvas->drawCircle(center, 16, shape);
+        canvas->drawCircle(center, 18, outline);
+      }
+    }
+  }
+  return recorder.finishRecordingAsPicture();
+}
+
+// Rasterizes a frame in tiles on a number of workers, in addition to the
+// calling thread. Without workers, the frame is rasterized in one piece.
+static void BM_TiledSoftwareRasterization(benchmark::State& state) {
+  const SkISize size = SkISize::Make(state.range(0), state.range(1));
+  const size_t worker_count = state.range(2);
+  const sk_sp<SkPicture> picture = MakeListFrame(size);
+  const auto surface = SkSurface::MakeRaster(
+      SkImageInfo::MakeN32Premul(size.width(), size.height()));
+  SkPixmap pixels;
+  FML_CHECK(surface->peekPixels(&pixels));
+
+  std::shared_ptr<fml::ConcurrentMessageLoop> loop;
+  if (worker_count > 0) {
+    loop = fml::ConcurrentMessageLoop::Create(worker_count);
+  }
+  TiledSoftwareRasterizer rasterizer(loop ? loop->GetTaskRunner() : nullptr);
+
+  while (state.KeepRunning()) {
+    rasterizer.Rasterize(picture, pixels);
+  }
+}
+
+BENCHMARK(BM_TiledSoftwareRasterization)
+    ->ArgNames({"width", "height", "workers"})
+    ->Args({1920, 1080, 0})
+    ->Args({1920, 1080, 1})
+    ->Args({1920, 1080, 3})
+    ->Args({1920, 1080, 7})
+    ->Args({3840, 2160, 0})
+    ->Args({3840, 2160, 1})
+    ->Args({3840, 2160, 3})
+    ->Args({3840, 2160, 7})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
 }  // namespace flutter
@@ -219,9 +219,89 @@ bool ShellTest::GetNeedsReportTimings(Shell* shell) {
   return shell->needs_report_timings_;
 }
 
+bool ShellTest::GetFrameRecords(
+    Shell* shell,
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document& response) {
+  bool result = false;
+  fml::AutoResetWaitableEvent latch;
+  fml::TaskRunner::RunNowOrPostTask(
+      shell->GetTaskRunners().GetUITaskRunner(),
+      [shell, &params, &response, &result, &latch]() {
+        result = shell->OnServiceProtocolGetFrameRecords(params, response);
+        latch.Signal();
+      });
+  latch.Wait();
+  return result;
+}
+
+uint32_t ShellTest::GetLayerTreePipelineMaxDepth(Shell* shell) {
+  uint32_t max_depth = 0;
+  fml::AutoResetWaitableEvent latch;
+  fml::TaskRunner::RunNowOrPostTask(
+      shell->GetTaskRunners().GetUITaskRunner(),
+      [engine = shell->weak_engine_, &max_depth, &latch]() {
+        max_depth = engine->animator_->layer_tree_pipeline_->GetMaxDepth();
+        latch.Signal();
+      });
+  latch.Wait();
+  return max_depth;
+}
+
+size_t ShellTest::GetDecodedImageCacheMaxBytes(Shell* shell) {
+  size_t max_bytes = 0;
+  fml::AutoResetWaitableEvent latch;
+  fml::TaskRunner::RunNowOrPostTask(
+      shell->GetTaskRunners().GetUITaskRunner(),
+      [engine = shell->weak_engine_, &max_bytes, &latch]() {
+        max_bytes = engine->image_decoder_->GetCache().GetMaxBytes();
+        latch.Signal();
+      });
+  latch.Wait();
+  return max_bytes;
+}
+
 std::shared_ptr<txt::FontCollection> ShellTest::GetFontCollection(
     Shell* shell) {
-  return shell->weak_engine_->GetFontCollection().GetFontCollection();
+  std::shared_ptr<txt::FontCollection> font_collection;
+  fml::AutoResetWaitableEvent latch;
+  fml::TaskRunner::RunNowOrPostTask(
+      shell->GetTaskRunners().GetUITaskRunner(),
+      [engine = shell->weak_engine_, &font_collection, &latch]() {
+        font_collection = engine->GetFontCollection().GetFontCollection();
+        latch.Signal();
+      });
+  latch.Wait();
+  return font_collection;
+}
+
+std::unique_ptr<Shell> ShellTest::SpawnShell(Shell* parent,
+                                             RunConfiguration configuration) {
+  std::unique_ptr<Shell> shell;
+  fml::AutoResetWaitableEvent latch;
+  fml::TaskRunner::RunNowOrPostTask(
+      parent->GetTaskRunners().GetPlatformTaskRunner(),
+      fml::MakeCopyable([parent, &shell, &latch,
+                         configuration = std::move(configuration)]() mutable {
+        shell = parent->Spawn(
+            std::move(configuration), WindowData{},
+            [](Shell& spawned) {
+              auto task_runners = spawned.GetTaskRunners();
+              return std::make_unique<ShellTestPlatformView>(
+                  spawned, task_runners, std::make_shared<ShellTestVsyncClock>(),
+                  [task_runners]() {
+                    return static_cast<std::unique_ptr<VsyncWaiter>>(
+                        std::make_unique<VsyncWaiterFallback>(task_runners));
+                  });
+            },
+            [](Shell& spawned) {
+              return std::make_unique<Rasterizer>(spawned,
+                                                  spawned.GetTaskRunners());
+            });
+        latch.Signal();
+      }));
+  latch.Wait();
+  return shell;
 }
 
 Settings ShellTest::CreateSettingsForFixture() {
@@ -74,11 +74,29 @@ class ShellTest : public ThreadTest {
 
   std::shared_ptr<txt::FontCollection> GetFontCollection(Shell* shell);
 
+  // Spawns a shell from |parent| on its platform task runner and runs it with
+  // |configuration|.
+  static std::unique_ptr<Shell> SpawnShell(Shell* parent,
+                                           RunConfiguration configuration);
+
   // Do not assert |UnreportedTimingsCount| to be positive in any tests.
   // Otherwise those tests will be flaky as the clearing of unreported timings
   // is unpredictive.
   static int UnreportedTimingsCount(Shell* shell);
 
+  // Calls the `_flutter.getFrameRecords` service protocol handler on the UI
+  // thread.
+  static bool GetFrameRecords(
+      Shell* shell,
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document& response);
+
+  // The deepest the layer tree pipeline of the animator may get.
+  static uint32_t GetLayerTreePipelineMaxDepth(Shell* shell);
+
+  // The budget of the cache of decoded images of the engine.
+  static size_t GetDecodedImageCacheMaxBytes(Shell* shell);
+
  private:
   void SetSnapshotsAndAssets(Settings& settings);
 
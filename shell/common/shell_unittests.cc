@@ -5,6 +5,7 @@
 #define FML_USED_ON_EMBEDDER
 
 #include <algorithm>
+#include <cstdlib>
 #include <functional>
 #include <future>
 #include <memory>
@@ -13,6 +14,7 @@
 #include "flutter/flow/layers/picture_layer.h"
 #include "flutter/flow/layers/transform_layer.h"
 #include "flutter/fml/command_line.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/dart/dart_converter.h"
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/message_loop.h"
@@ -25,7 +27,10 @@
 #include "flutter/shell/common/switches.h"
 #include "flutter/shell/common/thread_host.h"
 #include "flutter/shell/common/vsync_waiter_fallback.h"
+#include "flutter/shell/gpu/tiled_software_rasterizer.h"
 #include "flutter/testing/testing.h"
+#include "third_party/skia/include/effects/SkGradientShader.h"
+#include "third_party/skia/include/effects/SkImageFilters.h"
 #include "third_party/tonic/converter/dart_converter.h"
 
 namespace flutter {
@@ -165,6 +170,44 @@ TEST_F(ShellTest, InitializeWithGPUAndPlatformThreadsTheSame) {
   ASSERT_FALSE(DartVMRef::IsInstanceRunning());
 }
 
+TEST_F(ShellTest, AdaptivePipelineGrowsWithSeparateGPUThread) {
+  Settings settings = CreateSettingsForFixture();
+  settings.adaptive_pipeline_depth = true;
+  ThreadHost thread_host("io.flutter.test." + GetCurrentTestName() + ".",
+                         ThreadHost::Type::Platform | ThreadHost::Type::GPU |
+                             ThreadHost::Type::IO | ThreadHost::Type::UI);
+  TaskRunners task_runners("test", thread_host.platform_thread->GetTaskRunner(),
+                           thread_host.gpu_thread->GetTaskRunner(),
+                           thread_host.ui_thread->GetTaskRunner(),
+                           thread_host.io_thread->GetTaskRunner());
+  auto shell = CreateShell(std::move(settings), task_runners);
+  ASSERT_TRUE(ValidateShell(shell.get()));
+  ASSERT_EQ(GetLayerTreePipelineMaxDepth(shell.get()), 3u);
+  DestroyShell(std::move(shell), std::move(task_runners));
+}
+
+#if !FLUTTER_SHELL_ENABLE_METAL
+TEST_F(ShellTest, AdaptivePipelineStaysShallowWithGPUOnPlatformThread) {
+  Settings settings = CreateSettingsForFixture();
+  settings.adaptive_pipeline_depth = true;
+  ThreadHost thread_host(
+      "io.flutter.test." + GetCurrentTestName() + ".",
+      ThreadHost::Type::Platform | ThreadHost::Type::IO | ThreadHost::Type::UI);
+  TaskRunners task_runners(
+      "test",
+      thread_host.platform_thread->GetTaskRunner(),  // platform
+      thread_host.platform_thread->GetTaskRunner(),  // gpu
+      thread_host.ui_thread->GetTaskRunner(),        // ui
+      thread_host.io_thread->GetTaskRunner()         // io
+  );
+  auto shell = CreateShell(std::move(settings), task_runners);
+  ASSERT_TRUE(ValidateShell(shell.get()));
+  // See the TODO(dnfield) in the constructor of |Animator|.
+  ASSERT_EQ(GetLayerTreePipelineMaxDepth(shell.get()), 1u);
+  DestroyShell(std::move(shell), std::move(task_runners));
+}
+#endif  // !FLUTTER_SHELL_ENABLE_METAL
+
 TEST_F(ShellTest, FixturesAreFunctional) {
   ASSERT_FALSE(DartVMRef::IsInstanceRunning());
   auto settings = CreateSettingsForFixture();
@@ -292,6 +335,76 @@ TEST_F(ShellTest, WhitelistedDartVMFlag) {
 #endif
 }
 
+TEST_F(ShellTest, RasterCacheBudgetIsReadFromCommandLine) {
+  const std::vector<fml::CommandLine::Option> options = {
+      fml::CommandLine::Option("raster-cache-max-bytes", "1048576"),
+      fml::CommandLine::Option("raster-cache-max-unused-frames", "5")};
+  fml::CommandLine command_line("", options, std::vector<std::string>());
+  flutter::Settings settings = flutter::SettingsFromCommandLine(command_line);
+  EXPECT_EQ(settings.raster_cache_max_bytes, 1048576u);
+  EXPECT_EQ(settings.raster_cache_max_unused_frames, 5u);
+
+  settings = flutter::SettingsFromCommandLine(fml::CommandLine());
+  EXPECT_EQ(settings.raster_cache_max_bytes, 0u);
+  EXPECT_EQ(settings.raster_cache_max_unused_frames, 0u);
+}
+
+TEST_F(ShellTest, RasterCacheBudgetIsTakenFromSettings) {
+  Settings settings = CreateSettingsForFixture();
+  settings.raster_cache_max_bytes = 1 << 20;
+  settings.raster_cache_max_unused_frames = 5;
+  auto task_runner = CreateNewThread();
+  TaskRunners task_runners("test", task_runner, task_runner, task_runner,
+                           task_runner);
+  std::unique_ptr<Shell> shell =
+      CreateShell(std::move(settings), std::move(task_runners));
+  ASSERT_TRUE(shell);
+
+  size_t max_bytes = 0;
+  size_t max_unused_frames = 0;
+  fml::AutoResetWaitableEvent latch;
+  fml::TaskRunner::RunNowOrPostTask(
+      shell->GetTaskRunners().GetGPUTaskRunner(), [&]() {
+        if (auto rasterizer = shell->GetRasterizer()) {
+          auto& raster_cache = rasterizer->compositor_context()->raster_cache();
+          max_bytes = raster_cache.max_bytes();
+          max_unused_frames = raster_cache.max_unused_frames();
+        }
+        latch.Signal();
+      });
+  latch.Wait();
+  EXPECT_EQ(max_bytes, static_cast<size_t>(1 << 20));
+  EXPECT_EQ(max_unused_frames, 5u);
+
+  DestroyShell(std::move(shell), std::move(task_runners));
+}
+
+TEST_F(ShellTest, DecodedImageCacheBudgetIsReadFromCommandLine) {
+  const std::vector<fml::CommandLine::Option> options = {
+      fml::CommandLine::Option("decoded-image-cache-max-bytes", "1048576")};
+  fml::CommandLine command_line("", options, std::vector<std::string>());
+  flutter::Settings settings = flutter::SettingsFromCommandLine(command_line);
+  EXPECT_EQ(settings.decoded_image_cache_max_bytes, 1048576u);
+
+  settings = flutter::SettingsFromCommandLine(fml::CommandLine());
+  EXPECT_EQ(settings.decoded_image_cache_max_bytes,
+            static_cast<size_t>(16 * 1024 * 1024));
+}
+
+TEST_F(ShellTest, DecodedImageCacheBudgetIsTakenFromSettings) {
+  Settings settings = CreateSettingsForFixture();
+  settings.decoded_image_cache_max_bytes = 1 << 20;
+  auto task_runner = CreateNewThread();
+  TaskRunners task_runners("test", task_runner, task_runner, task_runner,
+                           task_runner);
+  std::unique_ptr<Shell> shell =
+      CreateShell(std::move(settings), std::move(task_runners));
+  ASSERT_TRUE(shell);
+  EXPECT_EQ(GetDecodedImageCacheMaxBytes(shell.get()),
+            static_cast<size_t>(1 << 20));
+  DestroyShell(std::move(shell), std::move(task_runners));
+}
+
 TEST_F(ShellTest, NoNeedToReportTimingsByDefault) {
   auto settings = CreateSettingsForFixture();
   std::unique_ptr<Shell> shell = CreateShell(settings);
@@ -463,6 +576,68 @@ TEST_F(ShellTest, FrameRasterizedCallbackIsCalled) {
   DestroyShell(std::move(shell));
 }
 
+TEST_F(ShellTest, FrameRecordsAreReported) {
+  fml::TimePoint start = fml::TimePoint::Now();
+
+  auto settings = CreateSettingsForFixture();
+  fml::AutoResetWaitableEvent recordLatch;
+  FrameRecord record;
+  record.status = FrameRecord::Status::kDropped;
+  settings.frame_record_callback = [&record,
+                                    &recordLatch](const FrameRecord& r) {
+    if (r.status == FrameRecord::Status::kRasterized) {
+      record = r;
+      recordLatch.Signal();
+    }
+  };
+
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+  PlatformViewNotifyCreated(shell.get());
+
+  auto configuration = RunConfiguration::InferFromSettings(settings);
+  configuration.SetEntrypoint("emptyMain");
+  RunEngine(shell.get(), std::move(configuration));
+
+  PumpOneFrame(shell.get());
+  recordLatch.Wait();
+
+  ASSERT_EQ(record.status, FrameRecord::Status::kRasterized);
+  std::vector<FrameTiming> timings = {record.timing};
+  CheckFrameTimings(timings, start, fml::TimePoint::Now());
+  ASSERT_TRUE(record.timing.GetVsyncTarget() >
+              record.timing.Get(FrameTiming::kBuildStart));
+
+  rapidjson::Document response;
+  ASSERT_TRUE(GetFrameRecords(shell.get(), {}, response));
+  ASSERT_STREQ(response["type"].GetString(), "FrameRecords");
+  const auto& records = response["records"];
+  ASSERT_GE(records.Size(), 1u);
+  const uint64_t next_index = response["nextIndex"].GetUint64();
+  ASSERT_EQ(next_index, records.Size());
+
+  bool found_rasterized = false;
+  for (const auto& entry : records.GetArray()) {
+    if (std::string(entry["status"].GetString()) == "rasterized") {
+      found_rasterized = true;
+      ASSERT_TRUE(entry.HasMember("vsyncTarget"));
+      ASSERT_TRUE(entry.HasMember("rasterFinish"));
+    }
+  }
+  ASSERT_TRUE(found_rasterized);
+
+  // Asking for the records after the last one returns nothing new.
+  const std::string since = std::to_string(next_index);
+  rapidjson::Document later;
+  ASSERT_TRUE(GetFrameRecords(shell.get(), {{"since", since}}, later));
+  ASSERT_EQ(later["nextIndex"].GetUint64() - next_index,
+            later["records"].Size());
+
+  rapidjson::Document invalid;
+  ASSERT_FALSE(GetFrameRecords(shell.get(), {{"since", "x"}}, invalid));
+
+  DestroyShell(std::move(shell));
+}
+
 TEST(SettingsTest, FrameTimingSetsAndGetsProperly) {
   // Ensure that all phases are in kPhases.
   ASSERT_EQ(sizeof(FrameTiming::kPhases),
@@ -596,6 +771,48 @@ TEST_F(ShellTest, ReloadSystemFonts) {
   shell.reset();
 }
 
+TEST_F(ShellTest, SpawnedShellsOnlyShareFontsOfTheSameAssets) {
+  auto settings = CreateSettingsForFixture();
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+  ASSERT_TRUE(shell);
+
+  auto configuration = RunConfiguration::InferFromSettings(settings);
+  configuration.SetEntrypoint("emptyMain");
+  auto asset_manager = configuration.GetAssetManager();
+  RunEngine(shell.get(), std::move(configuration));
+
+  RunConfiguration same_assets(
+      IsolateConfiguration::InferFromSettings(settings, asset_manager, nullptr),
+      asset_manager);
+  same_assets.SetEntrypoint("emptyMain");
+  auto same_assets_shell = SpawnShell(shell.get(), std::move(same_assets));
+  ASSERT_TRUE(same_assets_shell);
+  ASSERT_EQ(GetFontCollection(same_assets_shell.get()),
+            GetFontCollection(shell.get()));
+
+  // Restarting does not register the fonts of the spawner again, so the
+  // collection is still shared.
+  RunConfiguration restart_assets(
+      IsolateConfiguration::InferFromSettings(settings, asset_manager, nullptr),
+      asset_manager);
+  restart_assets.SetEntrypoint("emptyMain");
+  RestartEngine(same_assets_shell.get(), std::move(restart_assets));
+  ASSERT_EQ(GetFontCollection(same_assets_shell.get()),
+            GetFontCollection(shell.get()));
+
+  // Fonts of other assets must not show up in the views of the spawner.
+  auto other_assets = RunConfiguration::InferFromSettings(settings);
+  other_assets.SetEntrypoint("emptyMain");
+  auto other_assets_shell = SpawnShell(shell.get(), std::move(other_assets));
+  ASSERT_TRUE(other_assets_shell);
+  ASSERT_NE(GetFontCollection(other_assets_shell.get()),
+            GetFontCollection(shell.get()));
+
+  DestroyShell(std::move(other_assets_shell));
+  DestroyShell(std::move(same_assets_shell));
+  DestroyShell(std::move(shell));
+}
+
 TEST_F(ShellTest, WaitForFirstFrame) {
   auto settings = CreateSettingsForFixture();
   std::unique_ptr<Shell> shell = CreateShell(settings);
@@ -1127,5 +1344,75 @@ TEST_F(ShellTest, CanDecompressImageFromAsset) {
   DestroyShell(std::move(shell));
 }
 
+// Draws the same frame with and without tiles and returns the largest
+// difference of any channel of any pixel.
+static int MaxTiledRasterizationDifference(
+    const std::function<void(SkCanvas*)>& draw) {
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  TiledSoftwareRasterizer rasterizer(loop->GetTaskRunner(), 16);
+  const auto info = SkImageInfo::MakeN32Premul(300, 1000);
+
+  auto tiled = SkSurface::MakeRaster(info);
+  draw(rasterizer.BeginRecording(info));
+  EXPECT_TRUE(rasterizer.RasterizeRecording(tiled.get()));
+
+  auto untiled = SkSurface::MakeRaster(info);
+  draw(untiled->getCanvas());
+
+  SkPixmap tiled_pixels, untiled_pixels;
+  EXPECT_TRUE(tiled->peekPixels(&tiled_pixels));
+  EXPECT_TRUE(untiled->peekPixels(&untiled_pixels));
+  int max_difference = 0;
+  for (int y = 0; y < info.height(); y++) {
+    const auto* tiled_row =
+        static_cast<const uint8_t*>(tiled_pixels.addr(0, y));
+    const auto* untiled_row =
+        static_cast<const uint8_t*>(untiled_pixels.addr(0, y));
+    for (size_t i = 0; i < info.minRowBytes(); i++) {
+      max_difference =
+          std::max(max_difference, std::abs(tiled_row[i] - untiled_row[i]));
+    }
+  }
+  return max_difference;
+}
+
+TEST(TiledSoftwareRasterizerTest, TilesMatchUntiledRasterization) {
+  const int difference = MaxTiledRasterizationDifference([](SkCanvas* canvas) {
+    canvas->drawColor(SK_ColorWHITE);
+    const SkPoint points[] = {{0, 0}, {300, 1000}};
+    const SkColor colors[] = {SK_ColorRED, SK_ColorBLUE};
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setShader(SkGradientShader::MakeLinear(points, colors, nullptr, 2,
+                                                 SkTileMode::kClamp));
+    canvas->drawRect(SkRect::MakeXYWH(10, 10, 280, 980), paint);
+    paint.setShader(nullptr);
+    for (int i = 0; i < 20; i++) {
+      paint.setColor(SkColorSetARGB(0x80, 12 * i, 255 - 12 * i, 0));
+      // Circles that cross tile edges.
+      canvas->drawCircle(150, 30 + i * 50, 40.5, paint);
+    }
+  });
+  // Edges that cross tiles are offset in floating point for every tile and
+  // may round differently by a tiny fraction.
+  EXPECT_LE(difference, 1);
+}
+
+TEST(TiledSoftwareRasterizerTest, BackdropFiltersAreNotTiled) {
+  const int difference = MaxTiledRasterizationDifference([](SkCanvas* canvas) {
+    canvas->drawColor(SK_ColorWHITE);
+    SkPaint paint;
+    for (int i = 0; i < 10; i++) {
+      paint.setColor(i % 2 ? SK_ColorBLACK : SK_ColorGREEN);
+      canvas->drawRect(SkRect::MakeXYWH(0, i * 100, 300, 50), paint);
+    }
+    // A blur of the whole frame would see the edges of tiles.
+    auto blur = SkImageFilters::Blur(20, 20, nullptr);
+    canvas->saveLayer(SkCanvas::SaveLayerRec(nullptr, nullptr, blur.get(), 0));
+    canvas->restore();
+  });
+  EXPECT_EQ(difference, 0);
+}
+
 }  // namespace testing
 }  // namespace flutter
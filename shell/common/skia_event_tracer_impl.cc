@@ -62,7 +62,7 @@ class FlutterEventTracer : public SkEventTracer {
         fml::tracing::TraceEvent0(kSkiaTag, name);
         break;
       case TRACE_EVENT_PHASE_END:
-        fml::tracing::TraceEventEnd(name);
+        fml::tracing::TraceEventEnd(kSkiaTag, name);
         break;
       case TRACE_EVENT_PHASE_INSTANT:
         fml::tracing::TraceEventInstant0(kSkiaTag, name);
@@ -88,7 +88,7 @@ class FlutterEventTracer : public SkEventTracer {
 #if defined(OS_FUCHSIA)
     TRACE_DURATION_END(kSkiaTag, name);
 #else
-    fml::tracing::TraceEventEnd(name);
+    fml::tracing::TraceEventEnd(kSkiaTag, name);
 #endif
   }
 
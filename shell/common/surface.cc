@@ -11,9 +11,11 @@ namespace flutter {
 
 SurfaceFrame::SurfaceFrame(sk_sp<SkSurface> surface,
                            bool supports_readback,
-                           const SubmitCallback& submit_callback)
+                           const SubmitCallback& submit_callback,
+                           SkCanvas* canvas)
     : submitted_(false),
       surface_(surface),
+      canvas_(canvas),
       supports_readback_(supports_readback),
       submit_callback_(submit_callback) {
   FML_DCHECK(submit_callback_);
@@ -37,6 +39,9 @@ bool SurfaceFrame::Submit() {
 }
 
 SkCanvas* SurfaceFrame::SkiaCanvas() {
+  if (canvas_ != nullptr) {
+    return canvas_;
+  }
   return surface_ != nullptr ? surface_->getCanvas() : nullptr;
 }
 
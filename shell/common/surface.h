@@ -21,9 +21,13 @@ class SurfaceFrame {
   using SubmitCallback =
       std::function<bool(const SurfaceFrame& surface_frame, SkCanvas* canvas)>;
 
+  // The frame is drawn into |canvas| instead of the canvas of |surface| if
+  // one is given. The canvas must stay valid until the frame is submitted or
+  // dropped.
   SurfaceFrame(sk_sp<SkSurface> surface,
                bool supports_readback,
-               const SubmitCallback& submit_callback);
+               const SubmitCallback& submit_callback,
+               SkCanvas* canvas = nullptr);
 
   ~SurfaceFrame();
 
@@ -35,10 +39,20 @@ class SurfaceFrame {
 
   bool supports_readback() { return supports_readback_; }
 
+  // Whether the surface still holds the contents of the last frame submitted
+  // to it. If so, the rasterizer only repaints the area that changed.
+  bool retains_previous_contents() const { return retains_previous_contents_; }
+
+  void set_retains_previous_contents(bool retains) {
+    retains_previous_contents_ = retains;
+  }
+
  private:
   bool submitted_;
   sk_sp<SkSurface> surface_;
+  SkCanvas* canvas_;
   bool supports_readback_;
+  bool retains_previous_contents_ = false;
   SubmitCallback submit_callback_;
 
   bool PerformSubmit();
@@ -257,6 +257,12 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
   settings.enable_software_rendering =
       command_line.HasOption(FlagForSwitch(Switch::EnableSoftwareRendering));
 
+  settings.enable_tiled_software_rendering = command_line.HasOption(
+      FlagForSwitch(Switch::EnableTiledSoftwareRendering));
+
+  settings.enable_async_raster_cache =
+      command_line.HasOption(FlagForSwitch(Switch::EnableAsyncRasterCache));
+
   settings.endless_trace_buffer =
       command_line.HasOption(FlagForSwitch(Switch::EndlessTraceBuffer));
 
@@ -269,6 +275,12 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
   settings.trace_systrace =
       command_line.HasOption(FlagForSwitch(Switch::TraceSystrace));
 
+  settings.trace_to_buffer =
+      command_line.HasOption(FlagForSwitch(Switch::TraceToBuffer));
+
+  command_line.GetOptionValue(FlagForSwitch(Switch::TraceCategories),
+                              &settings.trace_categories);
+
   settings.skia_deterministic_rendering_on_cpu =
       command_line.HasOption(FlagForSwitch(Switch::SkiaDeterministicRendering));
 
@@ -368,6 +380,36 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
   settings.cache_sksl =
       command_line.HasOption(FlagForSwitch(Switch::CacheSkSL));
 
+  settings.cache_shaped_runs =
+      command_line.HasOption(FlagForSwitch(Switch::CacheShapedRuns));
+
+  settings.adaptive_pipeline_depth =
+      command_line.HasOption(FlagForSwitch(Switch::AdaptivePipelineDepth));
+
+  if (command_line.HasOption(FlagForSwitch(Switch::RasterCacheMaxBytes)) &&
+      !GetSwitchValue(command_line, Switch::RasterCacheMaxBytes,
+                      &settings.raster_cache_max_bytes)) {
+    FML_LOG(INFO) << "Raster cache byte budget specified was malformed. The "
+                     "raster cache will be unbounded.";
+  }
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::RasterCacheMaxUnusedFrames)) &&
+      !GetSwitchValue(command_line, Switch::RasterCacheMaxUnusedFrames,
+                      &settings.raster_cache_max_unused_frames)) {
+    FML_LOG(INFO) << "Raster cache unused frame count specified was "
+                     "malformed. Will default to "
+                  << settings.raster_cache_max_unused_frames;
+  }
+
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::DecodedImageCacheMaxBytes)) &&
+      !GetSwitchValue(command_line, Switch::DecodedImageCacheMaxBytes,
+                      &settings.decoded_image_cache_max_bytes)) {
+    FML_LOG(INFO) << "Decoded image cache byte budget specified was "
+                     "malformed. Will default to "
+                  << settings.decoded_image_cache_max_bytes;
+  }
+
   return settings;
 }
 
@@ -98,6 +98,17 @@ DEF_SWITCH(EnableSoftwareRendering,
            "Enable rendering using the Skia software backend. This is useful"
            "when testing Flutter on emulators. By default, Flutter will"
            "attempt to either use OpenGL or Vulkan.")
+DEF_SWITCH(EnableTiledSoftwareRendering,
+           "enable-tiled-software-rendering",
+           "Rasterize frames rendered by the Skia software backend in "
+           "horizontal tiles on multiple threads. This speeds up software "
+           "rendering of large surfaces on devices with many cores.")
+DEF_SWITCH(EnableAsyncRasterCache,
+           "enable-async-raster-cache",
+           "Rasterize pictures into the raster cache on multiple threads "
+           "instead of on the GPU thread. Pictures are drawn directly until "
+           "their cached images are ready, which keeps the frames that cache "
+           "many pictures at once from janking.")
 DEF_SWITCH(SkiaDeterministicRendering,
            "skia-deterministic-rendering",
            "Skips the call to SkGraphics::Init(), thus avoiding swapping out"
@@ -136,12 +147,48 @@ DEF_SWITCH(CacheSkSL,
            "should only be used during development phases. The generated SkSLs "
            "can later be used in the release build for shader precompilation "
            "at launch in order to eliminate the shader-compile jank.")
+DEF_SWITCH(CacheShapedRuns,
+           "cache-shaped-runs",
+           "Store the words shaped by the text layout in the persistent cache "
+           "so that later launches do not need to shape them again. The "
+           "cache holds the text of those words, so this is not enabled by "
+           "default.")
+DEF_SWITCH(AdaptivePipelineDepth,
+           "adaptive-pipeline-depth",
+           "Start with a frame pipeline that is one frame deep for the lowest "
+           "latency and only let it grow to up to three frames while frames "
+           "are being dropped. By default, the pipeline depth is fixed.")
+DEF_SWITCH(RasterCacheMaxBytes,
+           "raster-cache-max-bytes",
+           "The most bytes the images of the raster cache may take up. Past "
+           "that, the entries that are cheapest to raster again are evicted "
+           "first. By default, the raster cache is unbounded.")
+DEF_SWITCH(RasterCacheMaxUnusedFrames,
+           "raster-cache-max-unused-frames",
+           "The number of consecutive frames an entry of the raster cache may "
+           "go unused before it is evicted. Defaults to 0.")
+DEF_SWITCH(DecodedImageCacheMaxBytes,
+           "decoded-image-cache-max-bytes",
+           "The most bytes the decoded images kept for reuse by later decodes "
+           "of the same content may take up. Zero disables the cache. "
+           "Defaults to 16MB.")
 DEF_SWITCH(
     TraceSystrace,
     "trace-systrace",
     "Trace to the system tracer (instead of the timeline) on platforms where "
     "such a tracer is available. Currently only supported on Android and "
     "Fuchsia.")
+DEF_SWITCH(TraceToBuffer,
+           "trace-to-buffer",
+           "Record the most recent trace events of every thread in memory, "
+           "from where the _flutter.getTraceBuffer service protocol extension "
+           "exports them in the Chrome JSON or Perfetto trace formats.")
+DEF_SWITCH(TraceCategories,
+           "trace-categories",
+           "Only record trace events of the given comma separated categories, "
+           "for example --trace-categories=flutter,skia. The categories are "
+           "flutter, skia, dart, gfx, input, fml and other. By default, all "
+           "categories are recorded.")
 DEF_SWITCH(UseTestFonts,
            "use-test-fonts",
            "Running tests that layout and measure text will not yield "
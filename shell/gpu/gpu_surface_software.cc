@@ -13,7 +13,15 @@ GPUSurfaceSoftware::GPUSurfaceSoftware(GPUSurfaceSoftwareDelegate* delegate,
                                        bool render_to_surface)
     : delegate_(delegate),
       render_to_surface_(render_to_surface),
-      weak_factory_(this) {}
+      weak_factory_(this) {
+  if (delegate_ == nullptr) {
+    return;
+  }
+  if (auto worker_task_runner = delegate_->GetTileWorkerTaskRunner()) {
+    tiled_rasterizer_ =
+        std::make_unique<TiledSoftwareRasterizer>(worker_task_runner);
+  }
+}
 
 GPUSurfaceSoftware::~GPUSurfaceSoftware() = default;
 
@@ -56,20 +64,52 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireFrame(
   SkCanvas* canvas = backing_store->getCanvas();
   canvas->resetMatrix();
 
+  // The frame is recorded and only drawn into the backing store on submit.
+  if (tiled_rasterizer_) {
+    canvas = tiled_rasterizer_->BeginRecording(backing_store->imageInfo());
+  }
+
   SurfaceFrame::SubmitCallback on_submit =
       [self = weak_factory_.GetWeakPtr()](const SurfaceFrame& surface_frame,
                                           SkCanvas* canvas) -> bool {
     // If the surface itself went away, there is nothing more to do.
-    if (!self || !self->IsValid() || canvas == nullptr) {
+    if (!self || !self->IsValid()) {
       return false;
     }
 
-    canvas->flush();
+    // A dropped frame may have left the backing store partially drawn.
+    self->last_presented_backing_store_ = nullptr;
+
+    if (canvas == nullptr) {
+      if (self->tiled_rasterizer_) {
+        self->tiled_rasterizer_->DiscardRecording();
+      }
+      return false;
+    }
+
+    if (self->tiled_rasterizer_) {
+      if (!self->tiled_rasterizer_->RasterizeRecording(
+              surface_frame.SkiaSurface().get())) {
+        return false;
+      }
+    } else {
+      canvas->flush();
+    }
+
+    if (!self->delegate_->PresentBackingStore(surface_frame.SkiaSurface())) {
+      return false;
+    }
 
-    return self->delegate_->PresentBackingStore(surface_frame.SkiaSurface());
+    self->last_presented_backing_store_ = surface_frame.SkiaSurface();
+    return true;
   };
 
-  return std::make_unique<SurfaceFrame>(backing_store, true, on_submit);
+  auto frame =
+      std::make_unique<SurfaceFrame>(backing_store, true, on_submit, canvas);
+  frame->set_retains_previous_contents(
+      delegate_->PreservesBackingStoreContents() &&
+      backing_store == last_presented_backing_store_);
+  return frame;
 }
 
 // |Surface|
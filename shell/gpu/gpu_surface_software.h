@@ -9,6 +9,7 @@
 #include "flutter/fml/memory/weak_ptr.h"
 #include "flutter/shell/common/surface.h"
 #include "flutter/shell/gpu/gpu_surface_software_delegate.h"
+#include "flutter/shell/gpu/tiled_software_rasterizer.h"
 
 namespace flutter {
 
@@ -41,6 +42,11 @@ class GPUSurfaceSoftware : public Surface {
   // hack to make avoid allocating resources for the root surface when an
   // external view embedder is present.
   const bool render_to_surface_;
+  // The backing store of the last presented frame, if its contents are known
+  // to be intact.
+  sk_sp<SkSurface> last_presented_backing_store_;
+  // Set if the delegate provides workers to rasterize frames on.
+  std::unique_ptr<TiledSoftwareRasterizer> tiled_rasterizer_;
   fml::WeakPtrFactory<GPUSurfaceSoftware> weak_factory_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(GPUSurfaceSoftware);
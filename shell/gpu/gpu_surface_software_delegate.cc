@@ -12,4 +12,13 @@ ExternalViewEmbedder* GPUSurfaceSoftwareDelegate::GetExternalViewEmbedder() {
   return nullptr;
 }
 
+bool GPUSurfaceSoftwareDelegate::PreservesBackingStoreContents() const {
+  return false;
+}
+
+std::shared_ptr<fml::ConcurrentTaskRunner>
+GPUSurfaceSoftwareDelegate::GetTileWorkerTaskRunner() const {
+  return nullptr;
+}
+
 }  // namespace flutter
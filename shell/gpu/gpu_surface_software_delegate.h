@@ -5,7 +5,10 @@
 #ifndef FLUTTER_SHELL_GPU_GPU_SURFACE_SOFTWARE_DELEGATE_H_
 #define FLUTTER_SHELL_GPU_GPU_SURFACE_SOFTWARE_DELEGATE_H_
 
+#include <memory>
+
 #include "flutter/flow/embedded_views.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "third_party/skia/include/core/SkSurface.h"
 
@@ -60,6 +63,30 @@ class GPUSurfaceSoftwareDelegate {
   ///             into a single on-screen surface.
   ///
   virtual ExternalViewEmbedder* GetExternalViewEmbedder() = 0;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Whether a backing store returned by |AcquireBackingStore|
+  ///             still holds the contents of the last frame presented from it.
+  ///             When it does, the rasterizer only repaints the area of the
+  ///             frame that changed.
+  ///
+  /// @return     Returns if backing stores are not modified after being
+  ///             presented.
+  ///
+  virtual bool PreservesBackingStoreContents() const;
+
+  //----------------------------------------------------------------------------
+  /// @brief      Gets the workers that frames are rasterized on in parallel.
+  ///             This is optional. If a task runner is returned, the GPU
+  ///             surface records each frame and rasterizes horizontal tiles
+  ///             of it into the backing store concurrently. Otherwise frames
+  ///             are rasterized on the GPU thread.
+  ///
+  /// @return     The task runner of the workers, or, null if frames are
+  ///             rasterized on the GPU thread.
+  ///
+  virtual std::shared_ptr<fml::ConcurrentTaskRunner> GetTileWorkerTaskRunner()
+      const;
 };
 
 }  // namespace flutter
@@ -0,0 +1,188 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/gpu/tiled_software_rasterizer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkBBHFactory.h"
+#include "third_party/skia/include/utils/SkNWayCanvas.h"
+
+namespace flutter {
+
+// Forwards the frame to the picture recorder and notes whether it needs to
+// read back from the surface, which tiles cannot do.
+class TiledSoftwareRasterizer::RecordingCanvas : public SkNWayCanvas {
+ public:
+  RecordingCanvas(const SkImageInfo& info, SkCanvas* recording_canvas)
+      : SkNWayCanvas(info.width(), info.height()), info_(info) {
+    addCanvas(recording_canvas);
+  }
+
+  bool reads_back() const { return reads_back_; }
+
+ protected:
+  // The layer tree sizes its raster cache entries after this.
+  SkImageInfo onImageInfo() const override { return info_; }
+
+  SaveLayerStrategy getSaveLayerStrategy(const SaveLayerRec& rec) override {
+    reads_back_ |= rec.fBackdrop != nullptr;
+    return SkNWayCanvas::getSaveLayerStrategy(rec);
+  }
+
+ private:
+  const SkImageInfo info_;
+  bool reads_back_ = false;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(RecordingCanvas);
+};
+
+namespace {
+
+// The tiles of a frame, taken in order by whichever thread gets to them
+// first.
+class TiledFrame {
+ public:
+  TiledFrame(sk_sp<SkPicture> picture,
+             const SkPixmap& pixels,
+             int tile_height,
+             size_t tile_count)
+      : picture_(std::move(picture)),
+        pixels_(pixels),
+        tile_height_(tile_height),
+        tile_count_(tile_count),
+        latch_(tile_count) {}
+
+  // Rasterizes tiles until there are none left.
+  void RasterizeTiles() {
+    for (size_t tile = next_tile_++; tile < tile_count_; tile = next_tile_++) {
+      RasterizeTile(tile);
+      latch_.CountDown();
+    }
+  }
+
+  void Wait() { latch_.Wait(); }
+
+ private:
+  const sk_sp<SkPicture> picture_;
+  const SkPixmap pixels_;
+  const int tile_height_;
+  const size_t tile_count_;
+  std::atomic_size_t next_tile_ = {0};
+  fml::CountDownLatch latch_;
+
+  void RasterizeTile(size_t tile) {
+    TRACE_EVENT0("flutter", "TiledSoftwareRasterizer::RasterizeTile");
+    const int top = static_cast<int>(tile) * tile_height_;
+    const int bottom = std::min(top + tile_height_, pixels_.height());
+
+    // The tile shares the pixels and row bytes of the frame, so the tiles
+    // together fill in the frame without any copies.
+    SkPixmap tile_pixels;
+    if (!pixels_.extractSubset(
+            &tile_pixels,
+            SkIRect::MakeLTRB(0, top, pixels_.width(), bottom))) {
+      return;
+    }
+    auto surface = SkSurface::MakeRasterDirect(tile_pixels);
+    if (surface == nullptr) {
+      FML_LOG(ERROR) << "Could not wrap the pixels of a tile.";
+      return;
+    }
+    SkCanvas* canvas = surface->getCanvas();
+    canvas->translate(0, -top);
+    canvas->drawPicture(picture_);
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(TiledFrame);
+};
+
+}  // namespace
+
+TiledSoftwareRasterizer::TiledSoftwareRasterizer(
+    std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+    size_t max_tile_count)
+    : worker_task_runner_(std::move(worker_task_runner)),
+      max_tile_count_(std::max<size_t>(max_tile_count, 1)) {}
+
+TiledSoftwareRasterizer::~TiledSoftwareRasterizer() = default;
+
+size_t TiledSoftwareRasterizer::DefaultMaxTileCount() {
+  return std::max(std::thread::hardware_concurrency(), 1u) * 4;
+}
+
+SkCanvas* TiledSoftwareRasterizer::BeginRecording(const SkImageInfo& info) {
+  SkRTreeFactory rtree_factory;
+  SkCanvas* recording_canvas = recorder_.beginRecording(
+      SkRect::MakeIWH(info.width(), info.height()), &rtree_factory);
+  recording_canvas_ = std::make_unique<RecordingCanvas>(info, recording_canvas);
+  return recording_canvas_.get();
+}
+
+bool TiledSoftwareRasterizer::RasterizeRecording(SkSurface* surface) {
+  if (recording_canvas_ == nullptr) {
+    return false;
+  }
+  const bool reads_back = recording_canvas_->reads_back();
+  recording_canvas_.reset();
+  sk_sp<SkPicture> picture = recorder_.finishRecordingAsPicture();
+
+  SkPixmap pixels;
+  if (picture == nullptr || surface == nullptr ||
+      !surface->peekPixels(&pixels)) {
+    return false;
+  }
+
+  if (reads_back) {
+    TRACE_EVENT0("flutter", "TiledSoftwareRasterizer::RasterizeUntiled");
+    surface->getCanvas()->drawPicture(picture);
+    return true;
+  }
+
+  Rasterize(std::move(picture), pixels);
+  return true;
+}
+
+void TiledSoftwareRasterizer::DiscardRecording() {
+  if (recording_canvas_ == nullptr) {
+    return;
+  }
+  recording_canvas_.reset();
+  recorder_.finishRecordingAsPicture();
+}
+
+void TiledSoftwareRasterizer::Rasterize(sk_sp<SkPicture> picture,
+                                        const SkPixmap& pixels) const {
+  TRACE_EVENT0("flutter", "TiledSoftwareRasterizer::Rasterize");
+  const int height = pixels.height();
+  const int tile_count =
+      worker_task_runner_ == nullptr
+          ? 1
+          : std::clamp(height / kMinTileHeight, 1,
+                       static_cast<int>(max_tile_count_));
+  const int tile_height = (height + tile_count - 1) / tile_count;
+
+  auto frame = std::make_shared<TiledFrame>(std::move(picture), pixels,
+                                            tile_height, tile_count);
+
+  if (tile_count > 1) {
+    // This thread rasterizes tiles as well, so one task fewer than there are
+    // tiles is enough to keep every tile busy.
+    std::vector<fml::closure> tasks(tile_count - 1,
+                                    [frame]() { frame->RasterizeTiles(); });
+    worker_task_runner_->PostTasks(std::move(tasks),
+                                   fml::ConcurrentTaskPriority::kHigh);
+  }
+
+  frame->RasterizeTiles();
+  frame->Wait();
+}
+
+}  // namespace flutter
@@ -0,0 +1,93 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_GPU_TILED_SOFTWARE_RASTERIZER_H_
+#define FLUTTER_SHELL_GPU_TILED_SOFTWARE_RASTERIZER_H_
+
+#include <memory>
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkPixmap.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      Rasterizes software frames on a pool of workers. A frame is
+///             recorded once and then replayed into horizontal tiles of the
+///             backing store concurrently. The tiles draw straight into the
+///             pixels of the backing store, so the result is the same
+///             contiguous buffer a single threaded rasterization produces.
+///
+///             Frames that read back from the surface they are drawn into,
+///             like those with backdrop filters, are rasterized in one piece
+///             since tiles cannot see the pixels of their neighbors.
+///
+class TiledSoftwareRasterizer {
+ public:
+  // Tiles are at least this many rows tall, so that replaying the frame once
+  // per tile stays cheap compared to rasterizing it.
+  static constexpr int kMinTileHeight = 64;
+
+  //----------------------------------------------------------------------------
+  /// @param[in]  worker_task_runner  The pool the tiles are rasterized on. The
+  ///                                 thread that rasterizes a frame
+  ///                                 rasterizes tiles as well, so frames
+  ///                                 still make progress if the pool is busy.
+  /// @param[in]  max_tile_count      The number of tiles frames are split
+  ///                                 into at most. By default, this is a few
+  ///                                 tiles per core for load balancing.
+  ///
+  explicit TiledSoftwareRasterizer(
+      std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner,
+      size_t max_tile_count = DefaultMaxTileCount());
+
+  ~TiledSoftwareRasterizer();
+
+  static size_t DefaultMaxTileCount();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Begins recording a frame that will be rasterized into a
+  ///             surface described by |info|.
+  ///
+  /// @return     The canvas to draw the frame into. It is valid until the
+  ///             frame is rasterized or discarded.
+  ///
+  SkCanvas* BeginRecording(const SkImageInfo& info);
+
+  //----------------------------------------------------------------------------
+  /// @brief      Finishes recording the frame and rasterizes it into the
+  ///             pixels of |surface|, blocking until all tiles are done.
+  ///
+  /// @return     Returns false if there was no recording or the pixels of
+  ///             |surface| are not accessible.
+  ///
+  bool RasterizeRecording(SkSurface* surface);
+
+  void DiscardRecording();
+
+  //----------------------------------------------------------------------------
+  /// @brief      Rasterizes |picture| into |pixels| in tiles, blocking until
+  ///             all tiles are done.
+  ///
+  void Rasterize(sk_sp<SkPicture> picture, const SkPixmap& pixels) const;
+
+ private:
+  class RecordingCanvas;
+
+  const std::shared_ptr<fml::ConcurrentTaskRunner> worker_task_runner_;
+  const size_t max_tile_count_;
+  SkPictureRecorder recorder_;
+  std::unique_ptr<RecordingCanvas> recording_canvas_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(TiledSoftwareRasterizer);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_GPU_TILED_SOFTWARE_RASTERIZER_H_
@@ -44,6 +44,19 @@ class ByteBufferStreamReader {
     location_ += length;
   }
 
+  // Returns a pointer to the next |length| bytes of the stream and advances
+  // past them, without copying. Returns nullptr if fewer than |length| bytes
+  // are left. The pointer is valid as long as the wrapped buffer is.
+  const uint8_t* ReadView(size_t length) {
+    if (location_ > size_ || length > size_ - location_) {
+      std::cerr << "Invalid read in StandardCodecByteStreamReader" << std::endl;
+      return nullptr;
+    }
+    const uint8_t* view = bytes_ + location_;
+    location_ += length;
+    return view;
+  }
+
   // Advances the read cursor to the next multiple of |alignment| relative to
   // the start of the wrapped byte buffer, unless it is already aligned.
   void ReadAlignment(uint8_t alignment) {
@@ -73,6 +86,10 @@ class ByteBufferStreamWriter {
     assert(buffer);
   }
 
+  // Makes room for |length| more bytes in the wrapped buffer, so that writing
+  // them does not reallocate it.
+  void Reserve(size_t length) { bytes_->reserve(bytes_->size() + length); }
+
   // Writes |byte| to the wrapped buffer.
   void WriteByte(uint8_t byte) { bytes_->push_back(byte); }
 
@@ -89,9 +106,7 @@ class ByteBufferStreamWriter {
   void WriteAlignment(uint8_t alignment) {
     uint8_t mod = bytes_->size() % alignment;
     if (mod) {
-      for (int i = 0; i < alignment - mod; ++i) {
-        WriteByte(0);
-      }
+      bytes_->insert(bytes_->end(), alignment - mod, 0);
     }
   }
 
@@ -82,8 +82,8 @@ class EncodableValue {
       : string_(new std::string(value)), type_(Type::kString) {}
 
   // Creates an instance representing a string value.
-  explicit EncodableValue(const std::string& value)
-      : string_(new std::string(value)), type_(Type::kString) {}
+  explicit EncodableValue(std::string value)
+      : string_(new std::string(std::move(value))), type_(Type::kString) {}
 
   // Creates an instance representing a list of bytes.
   explicit EncodableValue(std::vector<uint8_t> list)
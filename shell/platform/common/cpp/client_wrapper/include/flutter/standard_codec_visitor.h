@@ -0,0 +1,83 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_PLATFORM_COMMON_CPP_CLIENT_WRAPPER_INCLUDE_FLUTTER_STANDARD_CODEC_VISITOR_H_
+#define FLUTTER_SHELL_PLATFORM_COMMON_CPP_CLIENT_WRAPPER_INCLUDE_FLUTTER_STANDARD_CODEC_VISITOR_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace flutter {
+
+// Receives the values of a message in the standard codec binary
+// representation as they are read, in the order they appear in the message.
+// This allows handling large messages without building an EncodableValue for
+// them.
+//
+// Strings and typed lists are passed as views into the message being read.
+// They are only valid for the duration of the call, so any data that is needed
+// afterwards must be copied out.
+//
+// All methods do nothing by default, so subclasses only need to override the
+// ones for the values they are interested in.
+class StandardCodecVisitor {
+ public:
+  StandardCodecVisitor() = default;
+
+  virtual ~StandardCodecVisitor() = default;
+
+  // Prevent copying.
+  StandardCodecVisitor(StandardCodecVisitor const&) = delete;
+  StandardCodecVisitor& operator=(StandardCodecVisitor const&) = delete;
+
+  // Called for a null value.
+  virtual void VisitNull() {}
+
+  // Called for a bool value.
+  virtual void VisitBool(bool value) {}
+
+  // Called for a 32-bit integer value.
+  virtual void VisitInt(int32_t value) {}
+
+  // Called for a 64-bit integer value.
+  virtual void VisitLong(int64_t value) {}
+
+  // Called for a 64-bit floating point value.
+  virtual void VisitDouble(double value) {}
+
+  // Called for a string value. |value| is UTF-8 encoded, and is not
+  // null-terminated.
+  virtual void VisitString(const char* value, size_t length) {}
+
+  // Called for a list of bytes. |values| may be null if |count| is 0.
+  virtual void VisitByteList(const uint8_t* values, size_t count) {}
+
+  // Called for a list of 32-bit integers. |values| may be null if |count| is 0.
+  virtual void VisitIntList(const int32_t* values, size_t count) {}
+
+  // Called for a list of 64-bit integers. |values| may be null if |count| is 0.
+  virtual void VisitLongList(const int64_t* values, size_t count) {}
+
+  // Called for a list of 64-bit floating point values. |values| may be null if
+  // |count| is 0.
+  virtual void VisitDoubleList(const double* values, size_t count) {}
+
+  // Called at the start of a list of EncodableValues. The |count| elements of
+  // the list are visited next, followed by a call to EndList.
+  virtual void BeginList(size_t count) {}
+
+  // Called once all the elements of a list have been visited.
+  virtual void EndList() {}
+
+  // Called at the start of a map. The |count| entries of the map are visited
+  // next, each key followed by its value, and then EndMap is called.
+  virtual void BeginMap(size_t count) {}
+
+  // Called once all the entries of a map have been visited.
+  virtual void EndMap() {}
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_COMMON_CPP_CLIENT_WRAPPER_INCLUDE_FLUTTER_STANDARD_CODEC_VISITOR_H_
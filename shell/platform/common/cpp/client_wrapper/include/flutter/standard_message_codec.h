@@ -7,6 +7,7 @@
 
 #include "encodable_value.h"
 #include "message_codec.h"
+#include "standard_codec_visitor.h"
 
 namespace flutter {
 
@@ -23,6 +24,17 @@ class StandardMessageCodec : public MessageCodec<EncodableValue> {
   StandardMessageCodec(StandardMessageCodec const&) = delete;
   StandardMessageCodec& operator=(StandardMessageCodec const&) = delete;
 
+  // Reads the message encoded in |binary_message|, reporting its values to
+  // |visitor| instead of decoding it into an EncodableValue. Strings and
+  // typed lists are passed to |visitor| without copying them out of
+  // |binary_message|, unless a typed list is not suitably aligned in memory.
+  //
+  // Returns false if |binary_message| is malformed, in which case |visitor|
+  // may have seen only part of the message.
+  bool VisitMessage(const uint8_t* binary_message,
+                    const size_t message_size,
+                    StandardCodecVisitor* visitor) const;
+
  protected:
   // Instances should be obtained via GetInstance.
   StandardMessageCodec();
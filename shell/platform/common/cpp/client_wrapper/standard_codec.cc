@@ -14,6 +14,7 @@
 #include <assert.h>
 #include <cstring>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <string>
 #include <vector>
@@ -74,6 +75,12 @@ EncodedType EncodedTypeForValue(const EncodableValue& value) {
   return EncodedType::kNull;
 }
 
+// Returns |offset| rounded up to the next multiple of |alignment|.
+size_t AlignedOffset(size_t offset, size_t alignment) {
+  size_t mod = offset % alignment;
+  return mod ? offset + alignment - mod : offset;
+}
+
 }  // namespace
 
 StandardCodecSerializer::StandardCodecSerializer() = default;
@@ -83,7 +90,6 @@ StandardCodecSerializer::~StandardCodecSerializer() = default;
 EncodableValue StandardCodecSerializer::ReadValue(
     ByteBufferStreamReader* stream) const {
   EncodedType type = static_cast<EncodedType>(stream->ReadByte());
-  ;
   switch (type) {
     case EncodedType::kNull:
       return EncodableValue();
@@ -110,10 +116,15 @@ EncodableValue StandardCodecSerializer::ReadValue(
     case EncodedType::kLargeInt:
     case EncodedType::kString: {
       size_t size = ReadSize(stream);
-      std::string string_value;
-      string_value.resize(size);
-      stream->ReadBytes(reinterpret_cast<uint8_t*>(&string_value[0]), size);
-      return EncodableValue(string_value);
+      if (size == 0) {
+        return EncodableValue(EncodableValue::Type::kString);
+      }
+      const uint8_t* bytes = stream->ReadView(size);
+      if (!bytes) {
+        return EncodableValue(EncodableValue::Type::kString);
+      }
+      return EncodableValue(
+          std::string(reinterpret_cast<const char*>(bytes), size));
     }
     case EncodedType::kUInt8List:
       return ReadVector<uint8_t>(stream);
@@ -130,7 +141,7 @@ EncodableValue StandardCodecSerializer::ReadValue(
       for (size_t i = 0; i < length; ++i) {
         list_value.push_back(ReadValue(stream));
       }
-      return EncodableValue(list_value);
+      return EncodableValue(std::move(list_value));
     }
     case EncodedType::kMap: {
       size_t length = ReadSize(stream);
@@ -140,7 +151,7 @@ EncodableValue StandardCodecSerializer::ReadValue(
         EncodableValue value = ReadValue(stream);
         map_value.emplace(std::move(key), std::move(value));
       }
-      return EncodableValue(map_value);
+      return EncodableValue(std::move(map_value));
     }
   }
   std::cerr << "Unknown type in StandardCodecSerializer::ReadValue: "
@@ -148,6 +159,120 @@ EncodableValue StandardCodecSerializer::ReadValue(
   return EncodableValue();
 }
 
+bool StandardCodecSerializer::VisitValue(ByteBufferStreamReader* stream,
+                                         StandardCodecVisitor* visitor) const {
+  EncodedType type = static_cast<EncodedType>(stream->ReadByte());
+  switch (type) {
+    case EncodedType::kNull:
+      visitor->VisitNull();
+      return true;
+    case EncodedType::kTrue:
+      visitor->VisitBool(true);
+      return true;
+    case EncodedType::kFalse:
+      visitor->VisitBool(false);
+      return true;
+    case EncodedType::kInt32: {
+      int32_t int_value = 0;
+      stream->ReadBytes(reinterpret_cast<uint8_t*>(&int_value), 4);
+      visitor->VisitInt(int_value);
+      return true;
+    }
+    case EncodedType::kInt64: {
+      int64_t long_value = 0;
+      stream->ReadBytes(reinterpret_cast<uint8_t*>(&long_value), 8);
+      visitor->VisitLong(long_value);
+      return true;
+    }
+    case EncodedType::kFloat64: {
+      double double_value = 0;
+      stream->ReadAlignment(8);
+      stream->ReadBytes(reinterpret_cast<uint8_t*>(&double_value), 8);
+      visitor->VisitDouble(double_value);
+      return true;
+    }
+    case EncodedType::kLargeInt:
+    case EncodedType::kString: {
+      size_t size = ReadSize(stream);
+      if (size == 0) {
+        visitor->VisitString("", 0);
+        return true;
+      }
+      const uint8_t* bytes = stream->ReadView(size);
+      if (!bytes) {
+        return false;
+      }
+      visitor->VisitString(reinterpret_cast<const char*>(bytes), size);
+      return true;
+    }
+    case EncodedType::kUInt8List: {
+      const uint8_t* values;
+      size_t count;
+      std::vector<uint8_t> unaligned_copy;
+      if (!ReadVectorView(stream, &values, &count, &unaligned_copy)) {
+        return false;
+      }
+      visitor->VisitByteList(values, count);
+      return true;
+    }
+    case EncodedType::kInt32List: {
+      const int32_t* values;
+      size_t count;
+      std::vector<int32_t> unaligned_copy;
+      if (!ReadVectorView(stream, &values, &count, &unaligned_copy)) {
+        return false;
+      }
+      visitor->VisitIntList(values, count);
+      return true;
+    }
+    case EncodedType::kInt64List: {
+      const int64_t* values;
+      size_t count;
+      std::vector<int64_t> unaligned_copy;
+      if (!ReadVectorView(stream, &values, &count, &unaligned_copy)) {
+        return false;
+      }
+      visitor->VisitLongList(values, count);
+      return true;
+    }
+    case EncodedType::kFloat64List: {
+      const double* values;
+      size_t count;
+      std::vector<double> unaligned_copy;
+      if (!ReadVectorView(stream, &values, &count, &unaligned_copy)) {
+        return false;
+      }
+      visitor->VisitDoubleList(values, count);
+      return true;
+    }
+    case EncodedType::kList: {
+      size_t length = ReadSize(stream);
+      visitor->BeginList(length);
+      for (size_t i = 0; i < length; ++i) {
+        if (!VisitValue(stream, visitor)) {
+          return false;
+        }
+      }
+      visitor->EndList();
+      return true;
+    }
+    case EncodedType::kMap: {
+      size_t length = ReadSize(stream);
+      visitor->BeginMap(length);
+      for (size_t i = 0; i < length; ++i) {
+        if (!VisitValue(stream, visitor) || !VisitValue(stream, visitor)) {
+          return false;
+        }
+      }
+      visitor->EndMap();
+      return true;
+    }
+  }
+  std::cerr << "Unknown type in StandardCodecSerializer::VisitValue: "
+            << static_cast<int>(type) << std::endl;
+  return false;
+}
+
 void StandardCodecSerializer::WriteValue(const EncodableValue& value,
                                          ByteBufferStreamWriter* stream) const {
   stream->WriteByte(static_cast<uint8_t>(EncodedTypeForValue(value)));
@@ -210,6 +335,57 @@ void StandardCodecSerializer::WriteValue(const EncodableValue& value,
   }
 }
 
+size_t StandardCodecSerializer::GetEncodedSize(const EncodableValue& value,
+                                               size_t offset) const {
+  // The type byte.
+  size_t end = offset + 1;
+  switch (value.type()) {
+    case EncodableValue::Type::kNull:
+    case EncodableValue::Type::kBool:
+      break;
+    case EncodableValue::Type::kInt:
+      end += 4;
+      break;
+    case EncodableValue::Type::kLong:
+      end += 8;
+      break;
+    case EncodableValue::Type::kDouble:
+      end = AlignedOffset(end, 8) + 8;
+      break;
+    case EncodableValue::Type::kString: {
+      size_t size = value.StringValue().size();
+      end += GetSizeEncodedSize(size) + size;
+      break;
+    }
+    case EncodableValue::Type::kByteList:
+      end += GetVectorEncodedSize(value.ByteListValue(), end);
+      break;
+    case EncodableValue::Type::kIntList:
+      end += GetVectorEncodedSize(value.IntListValue(), end);
+      break;
+    case EncodableValue::Type::kLongList:
+      end += GetVectorEncodedSize(value.LongListValue(), end);
+      break;
+    case EncodableValue::Type::kDoubleList:
+      end += GetVectorEncodedSize(value.DoubleListValue(), end);
+      break;
+    case EncodableValue::Type::kList:
+      end += GetSizeEncodedSize(value.ListValue().size());
+      for (const auto& item : value.ListValue()) {
+        end += GetEncodedSize(item, end);
+      }
+      break;
+    case EncodableValue::Type::kMap:
+      end += GetSizeEncodedSize(value.MapValue().size());
+      for (const auto& pair : value.MapValue()) {
+        end += GetEncodedSize(pair.first, end);
+        end += GetEncodedSize(pair.second, end);
+      }
+      break;
+  }
+  return end - offset;
+}
+
 size_t StandardCodecSerializer::ReadSize(ByteBufferStreamReader* stream) const {
   uint8_t byte = stream->ReadByte();
   if (byte < 254) {
@@ -240,24 +416,81 @@ void StandardCodecSerializer::WriteSize(size_t size,
   }
 }
 
+size_t StandardCodecSerializer::GetSizeEncodedSize(size_t size) const {
+  if (size < 254) {
+    return 1;
+  } else if (size <= 0xffff) {
+    return 3;
+  } else {
+    return 5;
+  }
+}
+
 template <typename T>
 EncodableValue StandardCodecSerializer::ReadVector(
     ByteBufferStreamReader* stream) const {
-  size_t count = ReadSize(stream);
-  std::vector<T> vector;
-  vector.resize(count);
+  const T* values;
+  size_t count;
+  std::vector<T> unaligned_copy;
+  if (!ReadVectorView(stream, &values, &count, &unaligned_copy)) {
+    return EncodableValue(std::vector<T>());
+  }
+  if (values == unaligned_copy.data()) {
+    return EncodableValue(std::move(unaligned_copy));
+  }
+  return EncodableValue(std::vector<T>(values, values + count));
+}
+
+template <typename T>
+bool StandardCodecSerializer::ReadVectorView(
+    ByteBufferStreamReader* stream,
+    const T** values,
+    size_t* count,
+    std::vector<T>* unaligned_copy) const {
+  *values = nullptr;
+  *count = ReadSize(stream);
   uint8_t type_size = static_cast<uint8_t>(sizeof(T));
   if (type_size > 1) {
     stream->ReadAlignment(type_size);
   }
-  stream->ReadBytes(reinterpret_cast<uint8_t*>(vector.data()),
-                    count * type_size);
-  return EncodableValue(vector);
+  if (*count == 0) {
+    return true;
+  }
+  if (*count > std::numeric_limits<size_t>::max() / type_size) {
+    return false;
+  }
+  const uint8_t* bytes = stream->ReadView(*count * type_size);
+  if (!bytes) {
+    *count = 0;
+    return false;
+  }
+  // The elements are aligned relative to the start of the message, which only
+  // makes them aligned in memory if the message itself is.
+  if (reinterpret_cast<uintptr_t>(bytes) % alignof(T) != 0) {
+    unaligned_copy->resize(*count);
+    std::memcpy(unaligned_copy->data(), bytes, *count * type_size);
+    *values = unaligned_copy->data();
+    return true;
+  }
+  *values = reinterpret_cast<const T*>(bytes);
+  return true;
+}
+
+template <typename T>
+size_t StandardCodecSerializer::GetVectorEncodedSize(
+    const std::vector<T>& vector,
+    size_t offset) const {
+  size_t count = vector.size();
+  size_t end = offset + GetSizeEncodedSize(count);
+  if (count == 0) {
+    return end - offset;
+  }
+  return AlignedOffset(end, sizeof(T)) + count * sizeof(T) - offset;
 }
 
 template <typename T>
 void StandardCodecSerializer::WriteVector(
-    const std::vector<T> vector,
+    const std::vector<T>& vector,
     ByteBufferStreamWriter* stream) const {
   size_t count = vector.size();
   WriteSize(count, stream);
@@ -292,12 +525,21 @@ std::unique_ptr<EncodableValue> StandardMessageCodec::DecodeMessageInternal(
   return std::make_unique<EncodableValue>(serializer.ReadValue(&stream));
 }
 
+bool StandardMessageCodec::VisitMessage(const uint8_t* binary_message,
+                                        const size_t message_size,
+                                        StandardCodecVisitor* visitor) const {
+  StandardCodecSerializer serializer;
+  ByteBufferStreamReader stream(binary_message, message_size);
+  return serializer.VisitValue(&stream, visitor);
+}
+
 std::unique_ptr<std::vector<uint8_t>>
 StandardMessageCodec::EncodeMessageInternal(
     const EncodableValue& message) const {
   StandardCodecSerializer serializer;
   auto encoded = std::make_unique<std::vector<uint8_t>>();
   ByteBufferStreamWriter stream(encoded.get());
+  stream.Reserve(serializer.GetEncodedSize(message));
   serializer.WriteValue(message, &stream);
   return encoded;
 }
@@ -331,14 +573,17 @@ std::unique_ptr<std::vector<uint8_t>>
 StandardMethodCodec::EncodeMethodCallInternal(
     const MethodCall<EncodableValue>& method_call) const {
   StandardCodecSerializer serializer;
+  EncodableValue method_name(method_call.method_name());
+  EncodableValue null_arguments;
+  const EncodableValue& arguments =
+      method_call.arguments() ? *method_call.arguments() : null_arguments;
   auto encoded = std::make_unique<std::vector<uint8_t>>();
   ByteBufferStreamWriter stream(encoded.get());
-  serializer.WriteValue(EncodableValue(method_call.method_name()), &stream);
-  if (method_call.arguments()) {
-    serializer.WriteValue(*method_call.arguments(), &stream);
-  } else {
-    serializer.WriteValue(EncodableValue(), &stream);
-  }
+  size_t method_name_size = serializer.GetEncodedSize(method_name);
+  stream.Reserve(method_name_size +
+                 serializer.GetEncodedSize(arguments, method_name_size));
+  serializer.WriteValue(method_name, &stream);
+  serializer.WriteValue(arguments, &stream);
   return encoded;
 }
 
@@ -348,6 +593,10 @@ StandardMethodCodec::EncodeSuccessEnvelopeInternal(
   StandardCodecSerializer serializer;
   auto encoded = std::make_unique<std::vector<uint8_t>>();
   ByteBufferStreamWriter stream(encoded.get());
+  if (result) {
+    // The envelope starts with a byte for the success code.
+    stream.Reserve(1 + serializer.GetEncodedSize(*result, 1));
+  }
   stream.WriteByte(0);
   if (result) {
     serializer.WriteValue(*result, &stream);
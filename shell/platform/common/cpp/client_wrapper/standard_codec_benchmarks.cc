@@ -0,0 +1,105 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/shell/platform/common/cpp/client_wrapper/include/flutter/standard_message_codec.h"
+
+namespace flutter {
+
+// Builds a list of |state.range(0)| copies of the values the codec unit tests
+// round trip, so that the cost of every encoded type shows up.
+static EncodableValue MakeMessage(benchmark::State& state) {
+  EncodableList list;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    list.push_back(EncodableValue(EncodableMap{
+        {EncodableValue("null"), EncodableValue()},
+        {EncodableValue("bool"), EncodableValue(true)},
+        {EncodableValue("int32"), EncodableValue(0x12345678)},
+        {EncodableValue("int64"), EncodableValue(INT64_C(0x1234567890abcdef))},
+        {EncodableValue("float64"), EncodableValue(3.14)},
+        {EncodableValue("string"), EncodableValue(u8"hello world h☺w")},
+        {EncodableValue("uint8[]"),
+         EncodableValue(std::vector<uint8_t>(256, 0xba))},
+        {EncodableValue("int32[]"),
+         EncodableValue(std::vector<int32_t>(64, 0x12345678))},
+        {EncodableValue("float64[]"),
+         EncodableValue(std::vector<double>(32, 3.14))},
+        {EncodableValue("list"), EncodableValue(EncodableList{
+                                     EncodableValue(42),
+                                     EncodableValue("nested"),
+                                 })},
+    }));
+  }
+  return EncodableValue(std::move(list));
+}
+
+// Touches every value without keeping any of them, the way a handler that
+// only needs a few fields of a large message would.
+class CountingVisitor : public StandardCodecVisitor {
+ public:
+  size_t count() const { return count_; }
+
+  void VisitNull() override { ++count_; }
+  void VisitBool(bool value) override { ++count_; }
+  void VisitInt(int32_t value) override { ++count_; }
+  void VisitLong(int64_t value) override { ++count_; }
+  void VisitDouble(double value) override { ++count_; }
+  void VisitString(const char* value, size_t length) override { ++count_; }
+  void VisitByteList(const uint8_t* values, size_t count) override {
+    ++count_;
+  }
+  void VisitIntList(const int32_t* values, size_t count) override {
+    ++count_;
+  }
+  void VisitDoubleList(const double* values, size_t count) override {
+    ++count_;
+  }
+
+ private:
+  size_t count_ = 0;
+};
+
+static void BM_StandardMessageCodecEncode(benchmark::State& state) {
+  const StandardMessageCodec& codec = StandardMessageCodec::GetInstance();
+  const EncodableValue message = MakeMessage(state);
+  size_t encoded_size = codec.EncodeMessage(message)->size();
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(codec.EncodeMessage(message));
+  }
+
+  state.SetBytesProcessed(state.iterations() * encoded_size);
+}
+BENCHMARK(BM_StandardMessageCodecEncode)->RangeMultiplier(8)->Range(1, 4096);
+
+static void BM_StandardMessageCodecDecode(benchmark::State& state) {
+  const StandardMessageCodec& codec = StandardMessageCodec::GetInstance();
+  auto encoded = codec.EncodeMessage(MakeMessage(state));
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(codec.DecodeMessage(*encoded));
+  }
+
+  state.SetBytesProcessed(state.iterations() * encoded->size());
+}
+BENCHMARK(BM_StandardMessageCodecDecode)->RangeMultiplier(8)->Range(1, 4096);
+
+static void BM_StandardMessageCodecVisit(benchmark::State& state) {
+  const StandardMessageCodec& codec = StandardMessageCodec::GetInstance();
+  auto encoded = codec.EncodeMessage(MakeMessage(state));
+
+  while (state.KeepRunning()) {
+    CountingVisitor visitor;
+    codec.VisitMessage(encoded->data(), encoded->size(), &visitor);
+    benchmark::DoNotOptimize(visitor.count());
+  }
+
+  state.SetBytesProcessed(state.iterations() * encoded->size());
+}
+BENCHMARK(BM_StandardMessageCodecVisit)->RangeMultiplier(8)->Range(1, 4096);
+
+}  // namespace flutter
@@ -7,6 +7,7 @@
 
 #include "byte_stream_wrappers.h"
 #include "include/flutter/encodable_value.h"
+#include "include/flutter/standard_codec_visitor.h"
 
 namespace flutter {
 
@@ -24,10 +25,20 @@ class StandardCodecSerializer {
   // Reads and returns the next value from |stream|.
   EncodableValue ReadValue(ByteBufferStreamReader* stream) const;
 
+  // Reads the next value from |stream| and reports it to |visitor|, without
+  // building an EncodableValue. Returns false if the value is malformed.
+  bool VisitValue(ByteBufferStreamReader* stream,
+                  StandardCodecVisitor* visitor) const;
+
   // Writes the encoding of |value| to |stream|.
   void WriteValue(const EncodableValue& value,
                   ByteBufferStreamWriter* stream) const;
 
+  // Returns the number of bytes WriteValue writes for |value| when the stream
+  // has |offset| bytes written already. The offset matters because of the
+  // padding that aligns doubles and typed lists.
+  size_t GetEncodedSize(const EncodableValue& value, size_t offset = 0) const;
+
  protected:
   // Reads the variable-length size from the current position in |stream|.
   size_t ReadSize(ByteBufferStreamReader* stream) const;
@@ -35,6 +46,9 @@ class StandardCodecSerializer {
   // Writes the variable-length size encoding to |stream|.
   void WriteSize(size_t size, ByteBufferStreamWriter* stream) const;
 
+  // Returns the number of bytes WriteSize writes for |size|.
+  size_t GetSizeEncodedSize(size_t size) const;
+
   // Reads a fixed-type list whose values are of type T from the current
   // position in |stream|, and returns it as the corresponding EncodableValue.
   // |T| must correspond to one of the support list value types of
@@ -42,11 +56,30 @@ class StandardCodecSerializer {
   template <typename T>
   EncodableValue ReadVector(ByteBufferStreamReader* stream) const;
 
+  // Reads a fixed-type list whose values are of type T from the current
+  // position in |stream| without copying it, setting |values| to point at its
+  // first element in the stream and |count| to its length. If the elements are
+  // not aligned in memory for T, they are copied into |unaligned_copy| and
+  // |values| points there instead.
+  //
+  // Returns false if the stream is too short to contain the list.
+  template <typename T>
+  bool ReadVectorView(ByteBufferStreamReader* stream,
+                      const T** values,
+                      size_t* count,
+                      std::vector<T>* unaligned_copy) const;
+
   // Writes |vector| to |stream| as a fixed-type list. |T| must correspond to
   // one of the support list value types of EncodableValue.
   template <typename T>
-  void WriteVector(const std::vector<T> vector,
+  void WriteVector(const std::vector<T>& vector,
                    ByteBufferStreamWriter* stream) const;
+
+  // Returns the number of bytes WriteVector writes for |vector| when the
+  // stream has |offset| bytes written already.
+  template <typename T>
+  size_t GetVectorEncodedSize(const std::vector<T>& vector,
+                              size_t offset) const;
 };
 
 }  // namespace flutter
@@ -5,8 +5,10 @@
 #include "flutter/shell/platform/common/cpp/client_wrapper/include/flutter/standard_message_codec.h"
 
 #include <map>
+#include <sstream>
 #include <vector>
 
+#include "flutter/shell/platform/common/cpp/client_wrapper/standard_codec_serializer.h"
 #include "flutter/shell/platform/common/cpp/client_wrapper/testing/encodable_value_utils.h"
 #include "gtest/gtest.h"
 
@@ -20,6 +22,8 @@ static void CheckEncodeDecode(const EncodableValue& value,
   auto encoded = codec.EncodeMessage(value);
   ASSERT_TRUE(encoded);
   EXPECT_EQ(*encoded, expected_encoding);
+  EXPECT_EQ(StandardCodecSerializer().GetEncodedSize(value),
+            expected_encoding.size());
 
   auto decoded = codec.DecodeMessage(*encoded);
   EXPECT_TRUE(testing::EncodableValuesAreEqual(value, *decoded));
@@ -40,6 +44,8 @@ static void CheckEncodeDecodeWithEncodePrefix(
   ASSERT_TRUE(encoded);
 
   EXPECT_EQ(encoded->size(), expected_encoding_length);
+  EXPECT_EQ(StandardCodecSerializer().GetEncodedSize(value),
+            expected_encoding_length);
   ASSERT_GT(encoded->size(), expected_encoding_prefix.size());
   EXPECT_TRUE(std::equal(
       encoded->begin(), encoded->begin() + expected_encoding_prefix.size(),
@@ -49,6 +55,62 @@ static void CheckEncodeDecodeWithEncodePrefix(
   EXPECT_TRUE(testing::EncodableValuesAreEqual(value, *decoded));
 }
 
+// Describes the values it visits, and where the strings and lists it was
+// given live.
+class RecordingVisitor : public StandardCodecVisitor {
+ public:
+  std::string events() const { return events_.str(); }
+
+  const void* last_view() const { return last_view_; }
+
+  void VisitNull() override { events_ << "null "; }
+
+  void VisitBool(bool value) override {
+    events_ << (value ? "true " : "false ");
+  }
+
+  void VisitInt(int32_t value) override { events_ << value << " "; }
+
+  void VisitLong(int64_t value) override { events_ << value << "L "; }
+
+  void VisitDouble(double value) override { events_ << value << "d "; }
+
+  void VisitString(const char* value, size_t length) override {
+    events_ << "\"" << std::string(value, length) << "\" ";
+    last_view_ = value;
+  }
+
+  void VisitIntList(const int32_t* values, size_t count) override {
+    events_ << "int32[";
+    for (size_t i = 0; i < count; ++i) {
+      events_ << values[i] << (i + 1 < count ? "," : "");
+    }
+    events_ << "] ";
+    last_view_ = values;
+  }
+
+  void VisitDoubleList(const double* values, size_t count) override {
+    events_ << "float64[";
+    for (size_t i = 0; i < count; ++i) {
+      events_ << values[i] << (i + 1 < count ? "," : "");
+    }
+    events_ << "] ";
+    last_view_ = values;
+  }
+
+  void BeginList(size_t count) override { events_ << "[" << count << " "; }
+
+  void EndList() override { events_ << "] "; }
+
+  void BeginMap(size_t count) override { events_ << "{" << count << " "; }
+
+  void EndMap() override { events_ << "} "; }
+
+ private:
+  std::ostringstream events_;
+  const void* last_view_ = nullptr;
+};
+
 TEST(StandardMessageCodec, CanEncodeAndDecodeNull) {
   std::vector<uint8_t> bytes = {0x00};
   CheckEncodeDecode(EncodableValue(), bytes);
@@ -170,4 +232,67 @@ TEST(StandardMessageCodec, CanEncodeAndDecodeFloat64Array) {
   CheckEncodeDecode(value, bytes);
 }
 
+TEST(StandardMessageCodec, CanVisitNestedValues) {
+  EncodableValue value(EncodableList{
+      EncodableValue(),
+      EncodableValue("hello"),
+      EncodableValue(3.14),
+      EncodableValue(INT64_C(0x1234567890abcdef)),
+      EncodableValue(EncodableMap{
+          {EncodableValue(42), EncodableValue(true)},
+      }),
+  });
+  const StandardMessageCodec& codec = StandardMessageCodec::GetInstance();
+  auto encoded = codec.EncodeMessage(value);
+  ASSERT_TRUE(encoded);
+
+  RecordingVisitor visitor;
+  EXPECT_TRUE(
+      codec.VisitMessage(encoded->data(), encoded->size(), &visitor));
+  EXPECT_EQ(visitor.events(),
+            "[5 null \"hello\" 3.14d 1311768467294899695L {1 42 true } ] ");
+}
+
+TEST(StandardMessageCodec, VisitedStringsPointIntoTheMessage) {
+  std::vector<uint8_t> bytes = {0x07, 0x0b, 0x68, 0x65, 0x6c, 0x6c, 0x6f,
+                                0x20, 0x77, 0x6f, 0x72, 0x6c, 0x64};
+  RecordingVisitor visitor;
+  EXPECT_TRUE(StandardMessageCodec::GetInstance().VisitMessage(
+      bytes.data(), bytes.size(), &visitor));
+  EXPECT_EQ(visitor.events(), "\"hello world\" ");
+  EXPECT_EQ(visitor.last_view(), &bytes[2]);
+}
+
+TEST(StandardMessageCodec, VisitedTypedListsPointIntoTheMessage) {
+  std::vector<uint8_t> bytes = {0x09, 0x03, 0x00, 0x00, 0x78, 0x56, 0x34, 0x12,
+                                0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00};
+  RecordingVisitor visitor;
+  EXPECT_TRUE(StandardMessageCodec::GetInstance().VisitMessage(
+      bytes.data(), bytes.size(), &visitor));
+  EXPECT_EQ(visitor.events(), "int32[305419896,-1,0] ");
+  EXPECT_EQ(visitor.last_view(), &bytes[4]);
+}
+
+TEST(StandardMessageCodec, CanVisitUnalignedTypedLists) {
+  std::vector<uint8_t> bytes = {0x0b, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                0x18, 0x2d, 0x44, 0x54, 0xfb, 0x21, 0x09, 0x40,
+                                0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x8f, 0x40};
+  // Padding is relative to the start of the message, so a message that does
+  // not start on an aligned address has unaligned elements.
+  std::vector<uint8_t> buffer(bytes.size() + 1);
+  std::copy(bytes.begin(), bytes.end(), buffer.begin() + 1);
+  RecordingVisitor visitor;
+  EXPECT_TRUE(StandardMessageCodec::GetInstance().VisitMessage(
+      buffer.data() + 1, bytes.size(), &visitor));
+  EXPECT_EQ(visitor.events(), "float64[3.14159,1000] ");
+}
+
+TEST(StandardMessageCodec, VisitingTruncatedMessagesFails) {
+  // A string that claims to be longer than the message.
+  std::vector<uint8_t> bytes = {0x0c, 0x01, 0x07, 0x0b, 0x68, 0x65, 0x6c};
+  RecordingVisitor visitor;
+  EXPECT_FALSE(StandardMessageCodec::GetInstance().VisitMessage(
+      bytes.data(), bytes.size(), &visitor));
+}
+
 }  // namespace flutter
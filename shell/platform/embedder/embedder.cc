@@ -32,6 +32,7 @@ extern const intptr_t kPlatformStrongDillSize;
 #include "flutter/fml/command_line.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/make_copyable.h"
+#include "flutter/fml/mapping.h"
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/paths.h"
 #include "flutter/fml/trace_event.h"
@@ -264,12 +265,17 @@ InferSoftwarePlatformViewCreationCallback(
       [software_dispatch_table, platform_dispatch_table,
        external_view_embedder =
            std::move(external_view_embedder)](flutter::Shell& shell) mutable {
+        auto tile_worker_task_runner =
+            shell.GetSettings().enable_tiled_software_rendering
+                ? shell.GetConcurrentWorkerTaskRunner()
+                : nullptr;
         return std::make_unique<flutter::PlatformViewEmbedder>(
-            shell,                             // delegate
-            shell.GetTaskRunners(),            // task runners
-            software_dispatch_table,           // software dispatch table
-            platform_dispatch_table,           // platform dispatch table
-            std::move(external_view_embedder)  // external view embedder
+            shell,                              // delegate
+            shell.GetTaskRunners(),             // task runners
+            software_dispatch_table,            // software dispatch table
+            platform_dispatch_table,            // platform dispatch table
+            std::move(external_view_embedder),  // external view embedder
+            std::move(tile_worker_task_runner)  // tile worker task runner
         );
       });
 }
@@ -589,12 +595,15 @@ FlutterEngineResult FlutterEngineRun(size_t version,
   return FlutterEngineRunInitialized(*engine_out);
 }
 
-FlutterEngineResult FlutterEngineInitialize(size_t version,
-                                            const FlutterRendererConfig* config,
-                                            const FlutterProjectArgs* args,
-                                            void* user_data,
-                                            FLUTTER_API_SYMBOL(FlutterEngine) *
-                                                engine_out) {
+// Initializes an engine, which is spawned from |spawner| unless that is
+// nullptr.
+static FlutterEngineResult InitializeEngine(
+    size_t version,
+    const FlutterRendererConfig* config,
+    const FlutterProjectArgs* args,
+    void* user_data,
+    flutter::EmbedderEngine* spawner,
+    FLUTTER_API_SYMBOL(FlutterEngine) * engine_out) {
   // Step 0: Figure out arguments for shell creation.
   if (version != FLUTTER_ENGINE_VERSION) {
     return LOG_EMBEDDER_ERROR(
@@ -693,6 +702,46 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
     };
   }
 
+  if (SAFE_ACCESS(args, frame_record_callback, nullptr) != nullptr) {
+    FlutterFrameRecordCallback callback =
+        SAFE_ACCESS(args, frame_record_callback, nullptr);
+    settings.frame_record_callback =
+        [callback, user_data](const flutter::FrameRecord& record) {
+          auto to_nanos = [](fml::TimePoint time) -> uint64_t {
+            return time == fml::TimePoint()
+                       ? 0
+                       : time.ToEpochDelta().ToNanoseconds();
+          };
+          FlutterFrameRecord embedder_record = {};
+          embedder_record.struct_size = sizeof(FlutterFrameRecord);
+          switch (record.status) {
+            case flutter::FrameRecord::Status::kRasterized:
+              embedder_record.status = kFlutterFrameStatusRasterized;
+              break;
+            case flutter::FrameRecord::Status::kDropped:
+              embedder_record.status = kFlutterFrameStatusDropped;
+              break;
+            case flutter::FrameRecord::Status::kCoalesced:
+              embedder_record.status = kFlutterFrameStatusCoalesced;
+              break;
+          }
+          const flutter::FrameTiming& timing = record.timing;
+          embedder_record.vsync_target_nanos =
+              to_nanos(timing.GetVsyncTarget());
+          embedder_record.build_start_nanos =
+              to_nanos(timing.Get(flutter::FrameTiming::kBuildStart));
+          embedder_record.build_finish_nanos =
+              to_nanos(timing.Get(flutter::FrameTiming::kBuildFinish));
+          embedder_record.raster_start_nanos =
+              to_nanos(timing.Get(flutter::FrameTiming::kRasterStart));
+          embedder_record.raster_finish_nanos =
+              to_nanos(timing.Get(flutter::FrameTiming::kRasterFinish));
+          callback(&embedder_record, user_data);
+        };
+  }
+  settings.adaptive_pipeline_depth =
+      SAFE_ACCESS(args, adaptive_pipeline_depth, false);
+
   flutter::PlatformViewEmbedder::UpdateSemanticsNodesCallback
       update_semantics_nodes_callback = nullptr;
   if (SAFE_ACCESS(args, update_semantics_node_callback, nullptr) != nullptr) {
@@ -778,6 +827,118 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
         };
   }
 
+  flutter::PlatformViewEmbedder::UpdateEncodedSemanticsCallback
+      update_encoded_semantics_callback = nullptr;
+  if (SAFE_ACCESS(args, update_semantics_callback, nullptr) != nullptr) {
+    settings.encode_semantics_updates = true;
+    update_encoded_semantics_callback =
+        [ptr = args->update_semantics_callback, user_data](
+            const flutter::EncodedSemanticsUpdate& update,
+            const flutter::CustomAccessibilityActionUpdates& actions) {
+          // The embedder API does not have the value lengths.
+          constexpr uint32_t kEmbedderFields =
+              flutter::kAllSemanticsNodeFields &
+              ~static_cast<uint32_t>(flutter::SemanticsNodeField::kValueLength);
+          auto get_string = [&update](const flutter::SemanticsNodeDelta& delta,
+                                      flutter::SemanticsNodeField field,
+                                      uint32_t index) -> const char* {
+            return delta.HasField(field) ? update.strings[index].c_str()
+                                         : nullptr;
+          };
+
+          std::vector<FlutterSemanticsNodeDelta> nodes;
+          nodes.reserve(update.nodes.size());
+          for (const auto& delta : update.nodes) {
+            const uint32_t changed_fields =
+                delta.changedFields & kEmbedderFields;
+            if (changed_fields == 0) {
+              continue;
+            }
+            SkMatrix transform = static_cast<SkMatrix>(delta.transform);
+            const bool has_children =
+                delta.HasField(flutter::SemanticsNodeField::kChildren);
+            const bool has_custom_actions = delta.HasField(
+                flutter::SemanticsNodeField::kCustomAccessibilityActions);
+            const int32_t* children = update.ids.data() + delta.childrenOffset;
+            const FlutterSemanticsNodeDelta embedder_delta = {
+                sizeof(FlutterSemanticsNodeDelta),
+                delta.id,
+                changed_fields,
+                static_cast<FlutterSemanticsFlag>(delta.flags),
+                static_cast<FlutterSemanticsAction>(delta.actions),
+                delta.textSelectionBase,
+                delta.textSelectionExtent,
+                delta.scrollChildren,
+                delta.scrollIndex,
+                delta.scrollPosition,
+                delta.scrollExtentMax,
+                delta.scrollExtentMin,
+                delta.elevation,
+                delta.thickness,
+                get_string(delta, flutter::SemanticsNodeField::kLabel,
+                           delta.label),
+                get_string(delta, flutter::SemanticsNodeField::kHint,
+                           delta.hint),
+                get_string(delta, flutter::SemanticsNodeField::kValue,
+                           delta.value),
+                get_string(delta, flutter::SemanticsNodeField::kIncreasedValue,
+                           delta.increasedValue),
+                get_string(delta, flutter::SemanticsNodeField::kDecreasedValue,
+                           delta.decreasedValue),
+                static_cast<FlutterTextDirection>(delta.textDirection),
+                FlutterRect{delta.rect.fLeft, delta.rect.fTop,
+                            delta.rect.fRight, delta.rect.fBottom},
+                FlutterTransformation{transform.get(SkMatrix::kMScaleX),
+                                      transform.get(SkMatrix::kMSkewX),
+                                      transform.get(SkMatrix::kMTransX),
+                                      transform.get(SkMatrix::kMSkewY),
+                                      transform.get(SkMatrix::kMScaleY),
+                                      transform.get(SkMatrix::kMTransY),
+                                      transform.get(SkMatrix::kMPersp0),
+                                      transform.get(SkMatrix::kMPersp1),
+                                      transform.get(SkMatrix::kMPersp2)},
+                delta.childCount,
+                has_children ? children : nullptr,
+                has_children ? children + delta.childCount : nullptr,
+                delta.customAccessibilityActionCount,
+                has_custom_actions ? update.ids.data() +
+                                         delta.customAccessibilityActionsOffset
+                                   : nullptr,
+                delta.platformViewId,
+            };
+            nodes.push_back(embedder_delta);
+          }
+
+          std::vector<FlutterSemanticsCustomAction> custom_actions;
+          custom_actions.reserve(actions.size());
+          for (const auto& value : actions) {
+            const auto& action = value.second;
+            custom_actions.push_back({
+                sizeof(FlutterSemanticsCustomAction),
+                action.id,
+                static_cast<FlutterSemanticsAction>(action.overrideId),
+                action.label.c_str(),
+                action.hint.c_str(),
+            });
+          }
+
+          if (nodes.empty() && update.removedNodes.empty() &&
+              custom_actions.empty()) {
+            return;
+          }
+          const FlutterSemanticsUpdate embedder_update = {
+              sizeof(FlutterSemanticsUpdate),
+              nodes.size(),
+              nodes.data(),
+              update.removedNodes.size(),
+              update.removedNodes.data(),
+              custom_actions.size(),
+              custom_actions.data(),
+          };
+          ptr(&embedder_update, user_data);
+        };
+  }
+
   flutter::PlatformViewEmbedder::PlatformMessageResponseCallback
       platform_message_response_callback = nullptr;
   if (SAFE_ACCESS(args, platform_message_callback, nullptr) != nullptr) {
@@ -788,9 +949,11 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
           const FlutterPlatformMessage incoming_message = {
               sizeof(FlutterPlatformMessage),  // struct_size
               message->channel().c_str(),      // channel
-              message->data().data(),          // message
-              message->data().size(),          // message_size
+              message->data().GetMapping(),    // message
+              message->data().GetSize(),       // message_size
               handle,                          // response_handle
+              nullptr,                         // release_callback
+              nullptr,                         // release_user_data
           };
           handle->message = std::move(message);
           return ptr(&incoming_message, user_data);
@@ -815,6 +978,7 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
       {
           update_semantics_nodes_callback,           //
           update_semantics_custom_actions_callback,  //
+          update_encoded_semantics_callback,         //
           platform_message_response_callback,        //
           vsync_callback,                            //
       };
@@ -894,9 +1058,15 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
     }
   }
 
-  auto thread_host =
-      flutter::EmbedderThreadHost::CreateEmbedderOrEngineManagedThreadHost(
-          SAFE_ACCESS(args, custom_task_runners, nullptr));
+  std::shared_ptr<flutter::EmbedderThreadHost> thread_host;
+  if (spawner) {
+    // Spawned engines run on the threads of the engine they are spawned from.
+    thread_host = spawner->GetThreadHost();
+  } else {
+    thread_host =
+        flutter::EmbedderThreadHost::CreateEmbedderOrEngineManagedThreadHost(
+            SAFE_ACCESS(args, custom_task_runners, nullptr));
+  }
 
   if (!thread_host || !thread_host->IsValid()) {
     return LOG_EMBEDDER_ERROR(kInvalidArguments,
@@ -912,7 +1082,11 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
   }
 
   auto run_configuration =
-      flutter::RunConfiguration::InferFromSettings(settings);
+      spawner ? flutter::RunConfiguration(
+                    flutter::IsolateConfiguration::InferFromSettings(
+                        settings, spawner->GetAssetManager(), nullptr),
+                    spawner->GetAssetManager())
+              : flutter::RunConfiguration::InferFromSettings(settings);
 
   if (SAFE_ACCESS(args, custom_dart_entrypoint, nullptr) != nullptr) {
     auto dart_entrypoint = std::string{args->custom_dart_entrypoint};
@@ -935,7 +1109,8 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
       std::move(run_configuration),  //
       on_create_platform_view,       //
       on_create_rasterizer,          //
-      external_texture_callback      //
+      external_texture_callback,     //
+      spawner                        //
   );
 
   // Release the ownership of the embedder engine to the caller.
@@ -944,6 +1119,17 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
   return kSuccess;
 }
 
+FlutterEngineResult FlutterEngineInitialize(size_t version,
+                                            const FlutterRendererConfig* config,
+                                            const FlutterProjectArgs* args,
+                                            void* user_data,
+                                            FLUTTER_API_SYMBOL(FlutterEngine) *
+                                                engine_out) {
+  return InitializeEngine(version, config, args, user_data,
+                          nullptr,  // spawner
+                          engine_out);
+}
+
 FlutterEngineResult FlutterEngineRunInitialized(
     FLUTTER_API_SYMBOL(FlutterEngine) engine) {
   if (!engine) {
@@ -982,6 +1168,59 @@ FlutterEngineResult FlutterEngineRunInitialized(
   return kSuccess;
 }
 
+FlutterEngineResult FlutterEngineSpawn(FLUTTER_API_SYMBOL(FlutterEngine)
+                                           spawner,
+                                       size_t version,
+                                       const FlutterRendererConfig* config,
+                                       const FlutterProjectArgs* args,
+                                       void* user_data,
+                                       FLUTTER_API_SYMBOL(FlutterEngine) *
+                                           engine_out) {
+  if (spawner == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "The engine to spawn from was missing.");
+  }
+
+  auto embedder_spawner = reinterpret_cast<flutter::EmbedderEngine*>(spawner);
+  if (!embedder_spawner->IsValid()) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "The engine to spawn from was not running.");
+  }
+
+  if (!embedder_spawner->GetTaskRunners()
+           .GetPlatformTaskRunner()
+           ->RunsTasksOnCurrentThread()) {
+    return LOG_EMBEDDER_ERROR(
+        kInvalidArguments,
+        "Engines may only be spawned on the platform thread of the engine "
+        "they are spawned from.");
+  }
+
+  const bool encode_semantics_updates =
+      SAFE_ACCESS(args, update_semantics_callback, nullptr) != nullptr;
+  if (encode_semantics_updates !=
+      embedder_spawner->GetShell().GetSettings().encode_semantics_updates) {
+    return LOG_EMBEDDER_ERROR(
+        kInvalidArguments,
+        "The semantics callbacks were not of the kind the engine to spawn "
+        "from uses.");
+  }
+
+  auto result = InitializeEngine(version, config, args, user_data,
+                                 embedder_spawner, engine_out);
+
+  if (result != kSuccess) {
+    return result;
+  }
+
+  result = FlutterEngineRunInitialized(*engine_out);
+  if (result != kSuccess) {
+    FlutterEngineShutdown(*engine_out);
+    *engine_out = nullptr;
+  }
+  return result;
+}
+
 FLUTTER_EXPORT
 FlutterEngineResult FlutterEngineDeinitialize(FLUTTER_API_SYMBOL(FlutterEngine)
                                                   engine) {
@@ -990,6 +1229,11 @@ FlutterEngineResult FlutterEngineDeinitialize(FLUTTER_API_SYMBOL(FlutterEngine)
   }
 
   auto embedder_engine = reinterpret_cast<flutter::EmbedderEngine*>(engine);
+  if (embedder_engine->HasSpawnedEngines()) {
+    return LOG_EMBEDDER_ERROR(
+        kInvalidArguments,
+        "The engines spawned from this engine must be shut down first.");
+  }
   embedder_engine->NotifyDestroyed();
   embedder_engine->CollectShell();
   return kSuccess;
@@ -1170,25 +1414,75 @@ FlutterEngineResult FlutterEngineSendPointerEvent(
                                   "running Flutter application.");
 }
 
+namespace {
+
+// A buffer the embedder handed over to the engine. The embedder is told to
+// release it once the engine is done with it.
+class EmbedderMessageMapping final : public fml::Mapping {
+ public:
+  EmbedderMessageMapping(uint8_t* data,
+                         size_t size,
+                         VoidCallback release_callback,
+                         void* release_user_data)
+      : data_(data),
+        size_(size),
+        release_callback_(release_callback),
+        release_user_data_(release_user_data) {}
+
+  ~EmbedderMessageMapping() override {
+    if (release_callback_ != nullptr) {
+      release_callback_(release_user_data_);
+    }
+  }
+
+  // |fml::Mapping|
+  size_t GetSize() const override { return size_; }
+
+  // |fml::Mapping|
+  const uint8_t* GetMapping() const override { return data_; }
+
+  // |fml::Mapping|
+  uint8_t* GetMutableMapping() override { return data_; }
+
+ private:
+  uint8_t* const data_;
+  const size_t size_;
+  const VoidCallback release_callback_;
+  void* const release_user_data_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(EmbedderMessageMapping);
+};
+
+}  // namespace
+
 FlutterEngineResult FlutterEngineSendPlatformMessage(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
     const FlutterPlatformMessage* flutter_message) {
-  if (engine == nullptr) {
-    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Invalid engine handle.");
-  }
-
   if (flutter_message == nullptr) {
     return LOG_EMBEDDER_ERROR(kInvalidArguments, "Invalid message argument.");
   }
 
+  size_t message_size = SAFE_ACCESS(flutter_message, message_size, 0);
+  const uint8_t* message_data = SAFE_ACCESS(flutter_message, message, nullptr);
+
+  // Take over the buffer first so that it is released on every path.
+  std::unique_ptr<fml::Mapping> message_buffer;
+  if (auto release_callback =
+          SAFE_ACCESS(flutter_message, release_callback, nullptr)) {
+    message_buffer = std::make_unique<EmbedderMessageMapping>(
+        const_cast<uint8_t*>(message_data), message_size, release_callback,
+        SAFE_ACCESS(flutter_message, release_user_data, nullptr));
+  }
+
+  if (engine == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Invalid engine handle.");
+  }
+
   if (SAFE_ACCESS(flutter_message, channel, nullptr) == nullptr) {
     return LOG_EMBEDDER_ERROR(
         kInvalidArguments, "Message argument did not specify a valid channel.");
   }
 
-  size_t message_size = SAFE_ACCESS(flutter_message, message_size, 0);
-  const uint8_t* message_data = SAFE_ACCESS(flutter_message, message, nullptr);
-
   if (message_size != 0 && message_data == nullptr) {
     return LOG_EMBEDDER_ERROR(
         kInvalidArguments,
@@ -1207,6 +1501,9 @@ FlutterEngineResult FlutterEngineSendPlatformMessage(
   if (message_size == 0) {
     message = fml::MakeRefCounted<flutter::PlatformMessage>(
         flutter_message->channel, response);
+  } else if (message_buffer) {
+    message = fml::MakeRefCounted<flutter::PlatformMessage>(
+        flutter_message->channel, std::move(message_buffer), response);
   } else {
     message = fml::MakeRefCounted<flutter::PlatformMessage>(
         flutter_message->channel,
@@ -1298,6 +1595,37 @@ FlutterEngineResult FlutterEngineSendPlatformMessageResponse(
   return kSuccess;
 }
 
+FlutterEngineResult FlutterEngineSendPlatformMessageResponseNoCopy(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterPlatformMessageResponseHandle* handle,
+    uint8_t* data,
+    size_t data_length,
+    VoidCallback release_callback,
+    void* release_user_data) {
+  auto buffer = std::make_unique<EmbedderMessageMapping>(
+      data, data_length, release_callback, release_user_data);
+
+  if (data_length != 0 && data == nullptr) {
+    return LOG_EMBEDDER_ERROR(
+        kInvalidArguments,
+        "Data size was non zero but the pointer to the data was null.");
+  }
+
+  auto response = handle->message->response();
+
+  if (response) {
+    if (data_length == 0) {
+      response->CompleteEmpty();
+    } else {
+      response->Complete(std::move(buffer));
+    }
+  }
+
+  delete handle;
+
+  return kSuccess;
+}
+
 FlutterEngineResult __FlutterEngineFlushPendingTasksNow() {
   fml::MessageLoop::GetCurrent().RunExpiredTasksNow();
   return kSuccess;
@@ -1458,7 +1786,7 @@ void FlutterEngineTraceEventDurationBegin(const char* name) {
 }
 
 void FlutterEngineTraceEventDurationEnd(const char* name) {
-  fml::tracing::TraceEventEnd(name);
+  fml::tracing::TraceEventEnd("flutter", name);
 }
 
 void FlutterEngineTraceEventInstant(const char* name) {
@@ -1504,6 +1832,35 @@ FlutterEngineResult FlutterEngineRunTask(FLUTTER_API_SYMBOL(FlutterEngine)
                                   "Could not run the specified task.");
 }
 
+FlutterEngineResult FlutterEngineRunExpiredTasks(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterTaskRunner task_runner,
+    uint64_t* next_target_time_nanos) {
+  if (engine == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Invalid engine handle.");
+  }
+
+  if (next_target_time_nanos == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "The next target time out parameter was "
+                              "missing.");
+  }
+
+  fml::TimePoint next_target_time;
+  if (!reinterpret_cast<flutter::EmbedderEngine*>(engine)->RunExpiredTasks(
+          task_runner, &next_target_time)) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Could not run the tasks of the specified task "
+                              "runner.");
+  }
+
+  *next_target_time_nanos =
+      next_target_time == fml::TimePoint::Max()
+          ? UINT64_MAX
+          : next_target_time.ToEpochDelta().ToNanoseconds();
+  return kSuccess;
+}
+
 static bool DispatchJSONPlatformMessage(FLUTTER_API_SYMBOL(FlutterEngine)
                                             engine,
                                         rapidjson::Document document,
@@ -447,6 +447,15 @@ typedef struct {
   /// `FlutterEngineSendPlatformMessageResponse` will cause a memory leak. It is
   /// not safe to send multiple responses on a single response object.
   const FlutterPlatformMessageResponseHandle* response_handle;
+  /// Optional. If set on a message sent with
+  /// `FlutterEngineSendPlatformMessage`, the engine takes over the `message`
+  /// buffer instead of copying it. The callback is invoked with
+  /// `release_user_data` exactly once when the engine is done with the buffer,
+  /// on an arbitrary thread, and also if the message could not be sent. The
+  /// buffer may be handed to the Dart application as is and must be writable.
+  /// Messages sent by the engine never set this.
+  VoidCallback release_callback;
+  void* release_user_data;
 } FlutterPlatformMessage;
 
 typedef void (*FlutterPlatformMessageCallback)(
@@ -599,6 +608,97 @@ typedef void (*FlutterUpdateSemanticsCustomActionCallback)(
     const FlutterSemanticsCustomAction* /* semantics custom action */,
     void* /* user data */);
 
+/// The groups of fields a `FlutterSemanticsNodeDelta` can carry.
+typedef enum {
+  kFlutterSemanticsNodeFieldFlags = 1 << 0,
+  kFlutterSemanticsNodeFieldActions = 1 << 1,
+  /// `text_selection_base` and `text_selection_extent`.
+  kFlutterSemanticsNodeFieldTextSelection = 1 << 2,
+  /// `scroll_child_count`, `scroll_index`, `scroll_position`,
+  /// `scroll_extent_max` and `scroll_extent_min`.
+  kFlutterSemanticsNodeFieldScroll = 1 << 3,
+  /// `elevation` and `thickness`.
+  kFlutterSemanticsNodeFieldElevation = 1 << 4,
+  kFlutterSemanticsNodeFieldLabel = 1 << 5,
+  kFlutterSemanticsNodeFieldHint = 1 << 6,
+  kFlutterSemanticsNodeFieldValue = 1 << 7,
+  kFlutterSemanticsNodeFieldIncreasedValue = 1 << 8,
+  kFlutterSemanticsNodeFieldDecreasedValue = 1 << 9,
+  kFlutterSemanticsNodeFieldTextDirection = 1 << 10,
+  kFlutterSemanticsNodeFieldRect = 1 << 11,
+  kFlutterSemanticsNodeFieldTransform = 1 << 12,
+  /// `child_count`, `children_in_traversal_order` and
+  /// `children_in_hit_test_order`.
+  kFlutterSemanticsNodeFieldChildren = 1 << 13,
+  /// `custom_accessibility_actions_count` and `custom_accessibility_actions`.
+  kFlutterSemanticsNodeFieldCustomAccessibilityActions = 1 << 14,
+  kFlutterSemanticsNodeFieldPlatformViewId = 1 << 15,
+} FlutterSemanticsNodeField;
+
+/// The changes to a node of the semantics tree since the last update it was
+/// in. Only the fields in `changed_fields` are set. Nodes the embedder was not
+/// sent before, or since semantics were last disabled, have them all set.
+typedef struct {
+  /// The size of this struct. Must be sizeof(FlutterSemanticsNodeDelta).
+  size_t struct_size;
+  /// The unique identifier for this node.
+  int32_t id;
+  /// A mask of the `FlutterSemanticsNodeField`s that changed.
+  uint32_t changed_fields;
+  /// The other fields are the same as in `FlutterSemanticsNode`. The strings
+  /// are stored once per update, so equal strings have the same address.
+  FlutterSemanticsFlag flags;
+  FlutterSemanticsAction actions;
+  int32_t text_selection_base;
+  int32_t text_selection_extent;
+  int32_t scroll_child_count;
+  int32_t scroll_index;
+  double scroll_position;
+  double scroll_extent_max;
+  double scroll_extent_min;
+  double elevation;
+  double thickness;
+  const char* label;
+  const char* hint;
+  const char* value;
+  const char* increased_value;
+  const char* decreased_value;
+  FlutterTextDirection text_direction;
+  FlutterRect rect;
+  FlutterTransformation transform;
+  size_t child_count;
+  const int32_t* children_in_traversal_order;
+  const int32_t* children_in_hit_test_order;
+  size_t custom_accessibility_actions_count;
+  const int32_t* custom_accessibility_actions;
+  FlutterPlatformViewIdentifier platform_view_id;
+} FlutterSemanticsNodeDelta;
+
+/// A batch of changes to the semantics tree and its custom actions.
+typedef struct {
+  /// The size of this struct. Must be sizeof(FlutterSemanticsUpdate).
+  size_t struct_size;
+  /// The number of nodes that changed.
+  size_t node_count;
+  /// Array of the nodes that changed. Has length `node_count`.
+  const FlutterSemanticsNodeDelta* nodes;
+  /// The number of nodes that are no longer in the tree.
+  size_t removed_node_count;
+  /// Array of the IDs of the nodes that are no longer in the tree, to be
+  /// removed after the changes in `nodes` are applied. Has length
+  /// `removed_node_count`.
+  const int32_t* removed_node_ids;
+  /// The number of custom actions that were added or changed.
+  size_t custom_action_count;
+  /// Array of the custom actions that were added or changed. Has length
+  /// `custom_action_count`.
+  const FlutterSemanticsCustomAction* custom_actions;
+} FlutterSemanticsUpdate;
+
+typedef void (*FlutterUpdateSemanticsCallback)(
+    const FlutterSemanticsUpdate* /* semantics update */,
+    void* /* user data */);
+
 typedef struct _FlutterTaskRunner* FlutterTaskRunner;
 
 typedef struct {
@@ -611,6 +711,11 @@ typedef void (*FlutterTaskRunnerPostTaskCallback)(
     uint64_t /* target time nanos */,
     void* /* user data */);
 
+typedef void (*FlutterTaskRunnerWakeCallback)(
+    FlutterTaskRunner /* task runner */,
+    uint64_t /* target time nanos */,
+    void* /* user data */);
+
 /// An interface used by the Flutter engine to execute tasks at the target time
 /// on a specified thread. There should be a 1-1 relationship between a thread
 /// and a task runner. It is undefined behavior to run a task on a thread that
@@ -638,6 +743,22 @@ typedef struct {
   /// A unique identifier for the task runner. If multiple task runners service
   /// tasks on the same thread, their identifiers must match.
   size_t identifier;
+  /// May be called from any thread. When specified, the engine keeps its tasks
+  /// instead of handing them to `post_task_callback` one at a time, which is
+  /// then not required. The engine only calls this when the earliest target
+  /// time of its pending tasks moves earlier than the one the embedder was
+  /// last asked to wake up at. Calls are made one at a time and stale ones are
+  /// dropped, so the target time of the last call (or the next target time
+  /// returned by `FlutterEngineRunExpiredTasks`, whichever came later) is
+  /// always the earliest one pending. The engine holds no locks during the
+  /// call, so the callback may post tasks or wait for other threads that do.
+  /// A wake decided during the call is made by the same thread once the call
+  /// returns, so the callback must not wait for that wake itself. At the
+  /// earliest target time, the embedder must call
+  /// `FlutterEngineRunExpiredTasks` with the given task runner on the thread
+  /// associated with it. The target time is the same kind of time as the one
+  /// given to `post_task_callback`.
+  FlutterTaskRunnerWakeCallback wake_callback;
 } FlutterTaskRunnerDescription;
 
 typedef struct {
@@ -934,6 +1055,36 @@ typedef struct {
   };
 } FlutterEngineDartObject;
 
+typedef enum {
+  /// The frame was built and rasterized.
+  kFlutterFrameStatusRasterized,
+  /// The frame was never built because the engine was still busy with earlier
+  /// frames when the vsync arrived.
+  kFlutterFrameStatusDropped,
+  /// The frame was built but a newer frame replaced it before it could be
+  /// rasterized.
+  kFlutterFrameStatusCoalesced,
+} FlutterFrameStatus;
+
+/// The timings of a frame scheduled by a vsync. All times are in nanoseconds
+/// on the clock used by `FlutterEngineGetCurrentTime`. Phases the frame never
+/// reached are zero.
+typedef struct {
+  /// The size of this struct. Must be sizeof(FlutterFrameRecord).
+  size_t struct_size;
+  FlutterFrameStatus status;
+  /// The vsync deadline the frame was scheduled for.
+  uint64_t vsync_target_nanos;
+  uint64_t build_start_nanos;
+  uint64_t build_finish_nanos;
+  uint64_t raster_start_nanos;
+  uint64_t raster_finish_nanos;
+} FlutterFrameRecord;
+
+typedef void (*FlutterFrameRecordCallback)(
+    const FlutterFrameRecord* /* frame record */,
+    void* /* user data */);
+
 typedef struct {
   /// The size of this struct. Must be sizeof(FlutterProjectArgs).
   size_t struct_size;
@@ -1121,6 +1272,34 @@ typedef struct {
   /// See also:
   /// https://github.com/dart-lang/sdk/blob/ca64509108b3e7219c50d6c52877c85ab6a35ff2/runtime/vm/flag_list.h#L150
   int64_t dart_old_gen_heap_size;
+
+  /// A callback that gets invoked by the engine for every frame scheduled by a
+  /// vsync, including the ones that were dropped or coalesced. This is
+  /// optional. The record is only valid for the duration of the call.
+  ///
+  /// The engine makes this callback on internal engine-managed threads. If the
+  /// components accessed on the embedder are not thread safe, the appropriate
+  /// re-threading must be done.
+  FlutterFrameRecordCallback frame_record_callback;
+
+  /// Lets the engine adapt how many frames it buffers between building and
+  /// rasterizing them. It starts with one frame for the lowest latency and
+  /// buffers up to three while frames would otherwise be dropped.
+  bool adaptive_pipeline_depth;
+
+  /// The callback invoked by the engine in order to give the embedder the
+  /// chance to respond to semantics updates from the Dart application. Each
+  /// update is sent in a single call, with only the nodes and fields that
+  /// changed since the previous one. The update is only valid for the duration
+  /// of the call. The changes are worked out on the UI thread, so that the
+  /// platform thread is not busy with nodes that did not change.
+  ///
+  /// If set, `update_semantics_node_callback` and
+  /// `update_semantics_custom_action_callback` are not called.
+  ///
+  /// The callback will be invoked on the thread on which the `FlutterEngineRun`
+  /// call is made.
+  FlutterUpdateSemanticsCallback update_semantics_callback;
 } FlutterProjectArgs;
 
 //------------------------------------------------------------------------------
@@ -1165,6 +1344,10 @@ FlutterEngineResult FlutterEngineRun(size_t version,
 /// @note       This de-initializes the Flutter engine instance (via an implicit
 ///             call to `FlutterEngineDeinitialize`) if necessary.
 ///
+/// @attention  Instances spawned from this instance with `FlutterEngineSpawn`
+///             must be shut down first. Until they are, this call fails with
+///             `kInvalidArguments` and the handle stays valid.
+///
 /// @param[in]  engine  The Flutter engine instance to collect.
 ///
 /// @return     The result of the call to shutdown the Flutter engine instance.
@@ -1207,6 +1390,10 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
 ///             Flutter engine handle still needs to be collected via a call to
 ///             `FlutterEngineShutdown`.
 ///
+/// @attention  Like `FlutterEngineShutdown`, this call fails with
+///             `kInvalidArguments` while instances spawned from this instance
+///             are alive.
+///
 /// @param[in]  engine    The running engine instance to de-initialize.
 ///
 /// @return     The result of the call to de-initialize the Flutter engine.
@@ -1232,6 +1419,51 @@ FLUTTER_EXPORT
 FlutterEngineResult FlutterEngineRunInitialized(
     FLUTTER_API_SYMBOL(FlutterEngine) engine);
 
+//------------------------------------------------------------------------------
+/// @brief      Spawns and runs a Flutter engine instance for another view of
+///             the application a running engine instance runs. The spawned
+///             instance shares the threads, the Dart VM and isolate snapshot,
+///             the resource context, the fonts, the image decoder and the
+///             assets of the instance it is spawned from, which makes it much
+///             cheaper to start and to keep running than an instance started
+///             with `FlutterEngineRun`. It still runs the Dart application in a
+///             root isolate of its own.
+///
+///             The settings of the spawned instance, like the command line
+///             arguments, the snapshots and the root isolate create and frame
+///             record callbacks, are those of the instance it is spawned from.
+///             The renderer configuration, the platform message, semantics and
+///             vsync callbacks and the custom Dart entrypoint are taken from
+///             the arguments given here. The custom task runners in them are
+///             ignored. Semantics updates must be asked for with the same
+///             kind of callback the instance spawned from uses.
+///
+/// @attention  This call must be made on the platform thread of the instance
+///             to spawn from. All the instances spawned from an instance must
+///             be shut down before it is. Until they are, shutting it down
+///             fails with `kInvalidArguments`.
+///
+/// @param[in]  spawner    The running engine instance to spawn from.
+/// @param[in]  version    The Flutter embedder API version. Must be
+///                        FLUTTER_ENGINE_VERSION.
+/// @param[in]  config     The renderer configuration.
+/// @param[in]  args       The Flutter project arguments.
+/// @param      user_data  A user data baton passed back to embedders in
+///                        callbacks.
+/// @param[out] engine_out The engine handle on successful engine creation.
+///
+/// @return     The result of the call to spawn the Flutter engine.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineSpawn(FLUTTER_API_SYMBOL(FlutterEngine)
+                                           spawner,
+                                       size_t version,
+                                       const FlutterRendererConfig* config,
+                                       const FlutterProjectArgs* args,
+                                       void* user_data,
+                                       FLUTTER_API_SYMBOL(FlutterEngine) *
+                                           engine_out);
+
 FLUTTER_EXPORT
 FlutterEngineResult FlutterEngineSendWindowMetricsEvent(
     FLUTTER_API_SYMBOL(FlutterEngine) engine,
@@ -1321,6 +1553,37 @@ FlutterEngineResult FlutterEngineSendPlatformMessageResponse(
     const uint8_t* data,
     size_t data_length);
 
+//------------------------------------------------------------------------------
+/// @brief      Send a response from the native side to a platform message from
+///             the Dart Flutter application without copying the response
+///             data. This is otherwise the same as
+///             `FlutterEngineSendPlatformMessageResponse`.
+///
+/// @param[in]  engine             The running engine instance.
+/// @param[in]  handle             The platform message response handle.
+/// @param[in]  data               The data to associate with the platform
+///                                message response. It may be handed to the
+///                                Dart application as is and must be
+///                                writable.
+/// @param[in]  data_length        The length of the platform message response
+///                                data.
+/// @param[in]  release_callback   Invoked with `release_user_data` exactly
+///                                once when the engine is done with `data`,
+///                                on an arbitrary thread. It is also invoked
+///                                if the call fails.
+/// @param[in]  release_user_data  The user data passed to `release_callback`.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineSendPlatformMessageResponseNoCopy(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    const FlutterPlatformMessageResponseHandle* handle,
+    uint8_t* data,
+    size_t data_length,
+    VoidCallback release_callback,
+    void* release_user_data);
+
 //------------------------------------------------------------------------------
 /// @brief      This API is only meant to be used by platforms that need to
 ///             flush tasks on a message loop not controlled by the Flutter
@@ -1577,6 +1840,31 @@ FlutterEngineResult FlutterEngineRunTask(FLUTTER_API_SYMBOL(FlutterEngine)
                                              engine,
                                          const FlutterTask* task);
 
+//------------------------------------------------------------------------------
+/// @brief      Runs all the tasks of a task runner with a
+///             `FlutterTaskRunnerDescription.wake_callback` whose target time
+///             has expired. This call must be made on the thread associated
+///             with the task runner, at the target time given to that
+///             callback or the one returned by the previous call, whichever
+///             is earlier.
+///
+/// @param[in]  engine                   A running engine instance.
+/// @param[in]  task_runner              The task runner given to the wake
+///                                      callback.
+/// @param[out] next_target_time_nanos   The target time of the earliest task
+///                                      still pending, at which this call must
+///                                      be made again, or `UINT64_MAX` if there
+///                                      are none. The wake callback is not
+///                                      called for this time.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineRunExpiredTasks(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterTaskRunner task_runner,
+    uint64_t* next_target_time_nanos);
+
 //------------------------------------------------------------------------------
 /// @brief      Notify a running engine instance that the locale has been
 ///             updated. The preferred locale must be the first item in the list
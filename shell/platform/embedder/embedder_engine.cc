@@ -5,6 +5,7 @@
 #include "flutter/shell/platform/embedder/embedder_engine.h"
 
 #include "flutter/fml/make_copyable.h"
+#include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/shell/platform/embedder/vsync_waiter_embedder.h"
 
 namespace flutter {
@@ -22,23 +23,34 @@ struct ShellArgs {
 };
 
 EmbedderEngine::EmbedderEngine(
-    std::unique_ptr<EmbedderThreadHost> thread_host,
+    std::shared_ptr<EmbedderThreadHost> thread_host,
     flutter::TaskRunners task_runners,
     flutter::Settings settings,
     RunConfiguration run_configuration,
     Shell::CreateCallback<PlatformView> on_create_platform_view,
     Shell::CreateCallback<Rasterizer> on_create_rasterizer,
     EmbedderExternalTextureGL::ExternalTextureCallback
-        external_texture_callback)
+        external_texture_callback,
+    EmbedderEngine* spawner)
     : thread_host_(std::move(thread_host)),
       task_runners_(task_runners),
       run_configuration_(std::move(run_configuration)),
+      asset_manager_(run_configuration_.GetAssetManager()),
+      spawner_(spawner),
       shell_args_(std::make_unique<ShellArgs>(std::move(settings),
                                               on_create_platform_view,
                                               on_create_rasterizer)),
-      external_texture_callback_(external_texture_callback) {}
+      external_texture_callback_(external_texture_callback) {
+  if (spawner_) {
+    spawner_->spawned_engine_count_++;
+  }
+}
 
-EmbedderEngine::~EmbedderEngine() = default;
+EmbedderEngine::~EmbedderEngine() {
+  if (spawner_) {
+    spawner_->spawned_engine_count_--;
+  }
+}
 
 bool EmbedderEngine::LaunchShell() {
   if (!shell_args_) {
@@ -50,9 +62,28 @@ bool EmbedderEngine::LaunchShell() {
     FML_DLOG(ERROR) << "Shell already initialized";
   }
 
-  shell_ = Shell::Create(task_runners_, shell_args_->settings,
-                         shell_args_->on_create_platform_view,
-                         shell_args_->on_create_rasterizer);
+  if (spawner_) {
+    if (!spawner_->IsValid()) {
+      FML_DLOG(ERROR) << "The engine to spawn from is not running.";
+      shell_args_.reset();
+      return false;
+    }
+    // The spawned shell runs its root isolate right away.
+    fml::AutoResetWaitableEvent latch;
+    fml::TaskRunner::RunNowOrPostTask(
+        task_runners_.GetPlatformTaskRunner(), [this, &latch]() {
+          shell_ = spawner_->shell_->Spawn(std::move(run_configuration_),
+                                           WindowData{},
+                                           shell_args_->on_create_platform_view,
+                                           shell_args_->on_create_rasterizer);
+          latch.Signal();
+        });
+    latch.Wait();
+  } else {
+    shell_ = Shell::Create(task_runners_, shell_args_->settings,
+                           shell_args_->on_create_platform_view,
+                           shell_args_->on_create_rasterizer);
+  }
 
   // Reset the args no matter what. They will never be used to initialize a
   // shell again.
@@ -67,6 +98,10 @@ bool EmbedderEngine::CollectShell() {
 }
 
 bool EmbedderEngine::RunRootIsolate() {
+  if (spawner_) {
+    // Spawning the shell ran the root isolate.
+    return IsValid();
+  }
   if (!IsValid() || !run_configuration_.IsValid()) {
     return false;
   }
@@ -247,9 +282,32 @@ bool EmbedderEngine::RunTask(const FlutterTask* task) {
                                 task->task);
 }
 
+bool EmbedderEngine::RunExpiredTasks(FlutterTaskRunner runner,
+                                     fml::TimePoint* next_target_time) {
+  // Like |RunTask|, this does not need the shell to be running.
+  if (runner == nullptr || next_target_time == nullptr) {
+    return false;
+  }
+  return thread_host_->RunExpiredTasks(reinterpret_cast<int64_t>(runner),
+                                       next_target_time);
+}
+
 const Shell& EmbedderEngine::GetShell() const {
   FML_DCHECK(shell_);
   return *shell_.get();
 }
 
+const std::shared_ptr<EmbedderThreadHost>& EmbedderEngine::GetThreadHost()
+    const {
+  return thread_host_;
+}
+
+const std::shared_ptr<AssetManager>& EmbedderEngine::GetAssetManager() const {
+  return asset_manager_;
+}
+
+bool EmbedderEngine::HasSpawnedEngines() const {
+  return spawned_engine_count_ > 0;
+}
+
 }  // namespace flutter
@@ -5,6 +5,7 @@
 #ifndef FLUTTER_SHELL_PLATFORM_EMBEDDER_EMBEDDER_ENGINE_H_
 #define FLUTTER_SHELL_PLATFORM_EMBEDDER_EMBEDDER_ENGINE_H_
 
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 
@@ -24,14 +25,18 @@ struct ShellArgs;
 // instance of the Flutter engine.
 class EmbedderEngine {
  public:
-  EmbedderEngine(std::unique_ptr<EmbedderThreadHost> thread_host,
+  // The shell of an engine with a |spawner| is spawned from the shell of
+  // that engine, which must outlive it. The spawner keeps count of the engines
+  // spawned from it until they are destroyed.
+  EmbedderEngine(std::shared_ptr<EmbedderThreadHost> thread_host,
                  TaskRunners task_runners,
                  Settings settings,
                  RunConfiguration run_configuration,
                  Shell::CreateCallback<PlatformView> on_create_platform_view,
                  Shell::CreateCallback<Rasterizer> on_create_rasterizer,
                  EmbedderExternalTextureGL::ExternalTextureCallback
-                     external_texture_callback);
+                     external_texture_callback,
+                 EmbedderEngine* spawner = nullptr);
 
   ~EmbedderEngine();
 
@@ -80,12 +85,26 @@ class EmbedderEngine {
 
   bool RunTask(const FlutterTask* task);
 
+  bool RunExpiredTasks(FlutterTaskRunner runner,
+                       fml::TimePoint* next_target_time);
+
   const Shell& GetShell() const;
 
+  const std::shared_ptr<EmbedderThreadHost>& GetThreadHost() const;
+
+  const std::shared_ptr<AssetManager>& GetAssetManager() const;
+
+  // Whether engines spawned from this one still exist, in which case this
+  // engine must not be shut down.
+  bool HasSpawnedEngines() const;
+
  private:
-  const std::unique_ptr<EmbedderThreadHost> thread_host_;
+  const std::shared_ptr<EmbedderThreadHost> thread_host_;
   TaskRunners task_runners_;
   RunConfiguration run_configuration_;
+  const std::shared_ptr<AssetManager> asset_manager_;
+  EmbedderEngine* const spawner_;
+  std::atomic_size_t spawned_engine_count_ = {};
   std::unique_ptr<ShellArgs> shell_args_;
   std::unique_ptr<Shell> shell_;
   const EmbedderExternalTextureGL::ExternalTextureCallback
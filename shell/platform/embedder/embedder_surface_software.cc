@@ -11,9 +11,11 @@ namespace flutter {
 
 EmbedderSurfaceSoftware::EmbedderSurfaceSoftware(
     SoftwareDispatchTable software_dispatch_table,
-    std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder)
+    std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder,
+    std::shared_ptr<fml::ConcurrentTaskRunner> tile_worker_task_runner)
     : software_dispatch_table_(software_dispatch_table),
-      external_view_embedder_(std::move(external_view_embedder)) {
+      external_view_embedder_(std::move(external_view_embedder)),
+      tile_worker_task_runner_(std::move(tile_worker_task_runner)) {
   if (!software_dispatch_table_.software_present_backing_store) {
     return;
   }
@@ -111,4 +113,17 @@ ExternalViewEmbedder* EmbedderSurfaceSoftware::GetExternalViewEmbedder() {
   return external_view_embedder_.get();
 }
 
+// |GPUSurfaceSoftwareDelegate|
+bool EmbedderSurfaceSoftware::PreservesBackingStoreContents() const {
+  // The backing store is reused as long as the frame size does not change and
+  // the embedder is only handed a read-only view of it when presenting.
+  return true;
+}
+
+// |GPUSurfaceSoftwareDelegate|
+std::shared_ptr<fml::ConcurrentTaskRunner>
+EmbedderSurfaceSoftware::GetTileWorkerTaskRunner() const {
+  return tile_worker_task_runner_;
+}
+
 }  // namespace flutter
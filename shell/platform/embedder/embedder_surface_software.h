@@ -20,9 +20,13 @@ class EmbedderSurfaceSoftware final : public EmbedderSurface,
         software_present_backing_store;  // required
   };
 
+  // Frames are rasterized in tiles on |tile_worker_task_runner| if one is
+  // given.
   EmbedderSurfaceSoftware(
       SoftwareDispatchTable software_dispatch_table,
-      std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder);
+      std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder,
+      std::shared_ptr<fml::ConcurrentTaskRunner> tile_worker_task_runner =
+          nullptr);
 
   ~EmbedderSurfaceSoftware() override;
 
@@ -31,6 +35,7 @@ class EmbedderSurfaceSoftware final : public EmbedderSurface,
   SoftwareDispatchTable software_dispatch_table_;
   sk_sp<SkSurface> sk_surface_;
   std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> tile_worker_task_runner_;
 
   // |EmbedderSurface|
   bool IsValid() const override;
@@ -50,6 +55,13 @@ class EmbedderSurfaceSoftware final : public EmbedderSurface,
   // |GPUSurfaceSoftwareDelegate|
   ExternalViewEmbedder* GetExternalViewEmbedder() override;
 
+  // |GPUSurfaceSoftwareDelegate|
+  bool PreservesBackingStoreContents() const override;
+
+  // |GPUSurfaceSoftwareDelegate|
+  std::shared_ptr<fml::ConcurrentTaskRunner> GetTileWorkerTaskRunner()
+      const override;
+
   FML_DISALLOW_COPY_AND_ASSIGN(EmbedderSurfaceSoftware);
 };
 
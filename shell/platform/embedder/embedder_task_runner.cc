@@ -4,6 +4,8 @@
 
 #include "flutter/shell/platform/embedder/embedder_task_runner.h"
 
+#include <vector>
+
 #include "flutter/fml/message_loop_impl.h"
 #include "flutter/fml/message_loop_task_queues.h"
 
@@ -16,7 +18,8 @@ EmbedderTaskRunner::EmbedderTaskRunner(DispatchTable table,
       dispatch_table_(std::move(table)),
       placeholder_id_(
           fml::MessageLoopTaskQueues::GetInstance()->CreateTaskQueue()) {
-  FML_DCHECK(dispatch_table_.post_task_callback);
+  FML_DCHECK(dispatch_table_.post_task_callback ||
+             dispatch_table_.wake_callback);
   FML_DCHECK(dispatch_table_.runs_task_on_current_thread_callback);
 }
 
@@ -36,6 +39,47 @@ void EmbedderTaskRunner::PostTaskForTime(const fml::closure& task,
     return;
   }
 
+  if (dispatch_table_.wake_callback) {
+    uint64_t wake_sequence = 0;
+    {
+      std::scoped_lock lock(tasks_mutex_);
+      delayed_tasks_.push({++task_order_, task, target_time});
+      if (target_time < wake_time_) {
+        wake_time_ = target_time;
+        wake_sequence = ++wake_sequence_;
+      }
+    }
+    if (wake_sequence == 0) {
+      return;
+    }
+    // Wakes decided on different threads may get here in any order. Only the
+    // latest one decided is queued, and one thread at a time delivers the
+    // queued wakes in turn, so the last target time the embedder was given is
+    // always the earliest one pending. No lock is held during the callback,
+    // which may post tasks or wait for other threads that do.
+    std::unique_lock wake_lock(wake_mutex_);
+    if (wake_sequence <= queued_wake_sequence_) {
+      return;
+    }
+    queued_wake_sequence_ = wake_sequence;
+    queued_wake_time_ = target_time;
+    has_queued_wake_ = true;
+    if (delivering_wakes_) {
+      // The thread delivering wakes delivers this one once its call returns.
+      return;
+    }
+    delivering_wakes_ = true;
+    while (has_queued_wake_) {
+      has_queued_wake_ = false;
+      const fml::TimePoint wake_time = queued_wake_time_;
+      wake_lock.unlock();
+      dispatch_table_.wake_callback(this, wake_time);
+      wake_lock.lock();
+    }
+    delivering_wakes_ = false;
+    return;
+  }
+
   uint64_t baton = 0;
 
   {
@@ -78,6 +122,32 @@ bool EmbedderTaskRunner::PostTask(uint64_t baton) {
   return true;
 }
 
+fml::TimePoint EmbedderTaskRunner::RunExpiredTasks() {
+  std::vector<fml::closure> expired_tasks;
+
+  {
+    std::scoped_lock lock(tasks_mutex_);
+    const auto now = fml::TimePoint::Now();
+    while (!delayed_tasks_.empty() &&
+           delayed_tasks_.top().GetTargetTime() <= now) {
+      expired_tasks.push_back(delayed_tasks_.pop().ReleaseTask());
+    }
+    // Tasks posted while the expired ones run wake the embedder if they are
+    // due before the remaining ones.
+    wake_time_ = delayed_tasks_.empty() ? fml::TimePoint::Max()
+                                        : delayed_tasks_.top().GetTargetTime();
+  }
+
+  for (const auto& task : expired_tasks) {
+    task();
+  }
+
+  std::scoped_lock lock(tasks_mutex_);
+  wake_time_ = delayed_tasks_.empty() ? fml::TimePoint::Max()
+                                      : delayed_tasks_.top().GetTargetTime();
+  return wake_time_;
+}
+
 // |fml::TaskRunner|
 fml::TaskQueueId EmbedderTaskRunner::GetTaskQueueId() {
   return placeholder_id_;
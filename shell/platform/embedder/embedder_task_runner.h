@@ -8,6 +8,7 @@
 #include <mutex>
 #include <unordered_map>
 
+#include "flutter/fml/delayed_task.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_runner.h"
 
@@ -27,13 +28,26 @@ class EmbedderTaskRunner final : public fml::TaskRunner {
     /// Delegates responsibility of deferred task execution to the embedder.
     /// Once the embedder gets the task, it must call
     /// `EmbedderTaskRunner::PostTask` with the supplied `task_baton` on the
-    /// correct thread after the tasks `target_time` point expires.
+    /// correct thread after the tasks `target_time` point expires. Not used
+    /// when there is a `wake_callback`.
     ///
     std::function<void(EmbedderTaskRunner* task_runner,
                        uint64_t task_baton,
                        fml::TimePoint target_time)>
         post_task_callback;
     //--------------------------------------------------------------------------
+    /// Optional. When specified, tasks are kept by the task runner instead of
+    /// being handed to the embedder one at a time. The embedder is only asked
+    /// to wake up when the earliest target time of the pending tasks moves
+    /// earlier than the time it was last asked to wake up at. Calls are made
+    /// one at a time, without holding any locks, and stale ones are dropped,
+    /// so the last target time given is always the earliest one pending. Once that time expires, it must
+    /// call `EmbedderTaskRunner::RunExpiredTasks` on the correct thread.
+    ///
+    std::function<void(EmbedderTaskRunner* task_runner,
+                       fml::TimePoint target_time)>
+        wake_callback;
+    //--------------------------------------------------------------------------
     /// Asks the embedder if tasks posted to it on this task task runner via the
     /// `post_task_callback` will be executed (after task expiry) on the calling
     /// thread.
@@ -71,12 +85,38 @@ class EmbedderTaskRunner final : public fml::TaskRunner {
 
   bool PostTask(uint64_t baton);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Runs all the tasks whose target time has expired, in the
+  ///             order of their target times. Only used by task runners with
+  ///             a `wake_callback`. Tasks posted while these tasks run are
+  ///             left for the next call.
+  ///
+  /// @return     The target time of the earliest task still pending, at which
+  ///             the embedder must call again, or `fml::TimePoint::Max()` if
+  ///             no tasks are pending.
+  ///
+  fml::TimePoint RunExpiredTasks();
+
  private:
   const size_t embedder_identifier_;
   DispatchTable dispatch_table_;
   std::mutex tasks_mutex_;
   uint64_t last_baton_;
   std::unordered_map<uint64_t, fml::closure> pending_tasks_;
+  // The pending tasks of task runners with a |wake_callback|.
+  fml::DelayedTaskQueue delayed_tasks_;
+  size_t task_order_ = 0;
+  // The time the embedder is going to run expired tasks at.
+  fml::TimePoint wake_time_ = fml::TimePoint::Max();
+  // Orders the calls to the |wake_callback| by when they were decided on.
+  uint64_t wake_sequence_ = 0;
+  // Guards the wake waiting to be delivered and whether a thread is
+  // delivering wakes. Never held during the |wake_callback|.
+  std::mutex wake_mutex_;
+  uint64_t queued_wake_sequence_ = 0;
+  fml::TimePoint queued_wake_time_;
+  bool has_queued_wake_ = false;
+  bool delivering_wakes_ = false;
   fml::TaskQueueId placeholder_id_;
 
   // |fml::TaskRunner|
@@ -0,0 +1,86 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/shell/platform/embedder/embedder_task_runner.h"
+
+namespace flutter {
+
+// Every task is handed to the embedder, which queues its baton on its own loop
+// and hands each one back to the engine once it is due.
+static void BM_EmbedderTaskRunnerPostTask(benchmark::State& state) {
+  const int64_t task_count = state.range(0);
+  std::vector<uint64_t> batons;
+  EmbedderTaskRunner::DispatchTable table = {};
+  table.post_task_callback = [&batons](EmbedderTaskRunner* task_runner,
+                                       uint64_t task_baton,
+                                       fml::TimePoint target_time) {
+    batons.push_back(task_baton);
+  };
+  table.runs_task_on_current_thread_callback = []() { return true; };
+  auto embedder_task_runner =
+      fml::MakeRefCounted<EmbedderTaskRunner>(std::move(table), 1u);
+  fml::RefPtr<fml::TaskRunner> task_runner = embedder_task_runner;
+
+  int64_t tasks_run = 0;
+  int64_t embedder_calls = 0;
+  while (state.KeepRunning()) {
+    for (int64_t i = 0; i < task_count; i++) {
+      task_runner->PostTask([&tasks_run]() { tasks_run++; });
+    }
+    for (uint64_t baton : batons) {
+      embedder_task_runner->PostTask(baton);
+    }
+    embedder_calls += batons.size() * 2;
+    batons.clear();
+  }
+  FML_CHECK(tasks_run == state.iterations() * task_count);
+  state.SetItemsProcessed(tasks_run);
+  state.counters["embedder_calls"] =
+      static_cast<double>(embedder_calls) / state.iterations();
+}
+
+BENCHMARK(BM_EmbedderTaskRunnerPostTask)
+    ->Arg(1)
+    ->Arg(16)
+    ->Arg(256)
+    ->Unit(benchmark::kMicrosecond);
+
+// The embedder is only woken for the first task and runs them all in one call.
+static void BM_EmbedderTaskRunnerRunExpiredTasks(benchmark::State& state) {
+  const int64_t task_count = state.range(0);
+  int64_t wakes = 0;
+  EmbedderTaskRunner::DispatchTable table = {};
+  table.wake_callback = [&wakes](EmbedderTaskRunner* task_runner,
+                                 fml::TimePoint target_time) { wakes++; };
+  table.runs_task_on_current_thread_callback = []() { return true; };
+  auto embedder_task_runner =
+      fml::MakeRefCounted<EmbedderTaskRunner>(std::move(table), 1u);
+  fml::RefPtr<fml::TaskRunner> task_runner = embedder_task_runner;
+
+  int64_t tasks_run = 0;
+  int64_t embedder_calls = 0;
+  while (state.KeepRunning()) {
+    const int64_t wakes_before = wakes;
+    for (int64_t i = 0; i < task_count; i++) {
+      task_runner->PostTask([&tasks_run]() { tasks_run++; });
+    }
+    embedder_task_runner->RunExpiredTasks();
+    embedder_calls += wakes - wakes_before + 1;
+  }
+  FML_CHECK(tasks_run == state.iterations() * task_count);
+  state.SetItemsProcessed(tasks_run);
+  state.counters["embedder_calls"] =
+      static_cast<double>(embedder_calls) / state.iterations();
+}
+
+BENCHMARK(BM_EmbedderTaskRunnerRunExpiredTasks)
+    ->Arg(1)
+    ->Arg(16)
+    ->Arg(256)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace flutter
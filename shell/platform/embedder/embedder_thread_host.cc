@@ -42,9 +42,13 @@ CreateEmbedderTaskRunner(const FlutterTaskRunnerDescription* description) {
     return {false, {}};
   }
 
-  if (SAFE_ACCESS(description, post_task_callback, nullptr) == nullptr) {
-    FML_LOG(ERROR)
-        << "FlutterTaskRunnerDescription.post_task_callback was nullptr.";
+  auto wake_callback_c = SAFE_ACCESS(description, wake_callback, nullptr);
+
+  if (SAFE_ACCESS(description, post_task_callback, nullptr) == nullptr &&
+      wake_callback_c == nullptr) {
+    FML_LOG(ERROR) << "FlutterTaskRunnerDescription.post_task_callback and "
+                      "FlutterTaskRunnerDescription.wake_callback were both "
+                      "nullptr.";
     return {false, {}};
   }
 
@@ -69,11 +73,23 @@ CreateEmbedderTaskRunner(const FlutterTaskRunnerDescription* description) {
         post_task_callback_c(task, target_time.ToEpochDelta().ToNanoseconds(),
                              user_data);
       },
+      // .wake_callback
+      nullptr,
       // runs_task_on_current_thread_callback
       [runs_task_on_current_thread_callback_c, user_data]() -> bool {
         return runs_task_on_current_thread_callback_c(user_data);
       }};
 
+  if (wake_callback_c != nullptr) {
+    task_runner_dispatch_table.post_task_callback = nullptr;
+    task_runner_dispatch_table.wake_callback =
+        [wake_callback_c, user_data](EmbedderTaskRunner* task_runner,
+                                     fml::TimePoint target_time) -> void {
+      wake_callback_c(reinterpret_cast<FlutterTaskRunner>(task_runner),
+                      target_time.ToEpochDelta().ToNanoseconds(), user_data);
+    };
+  }
+
   return {true, fml::MakeRefCounted<EmbedderTaskRunner>(
                     task_runner_dispatch_table,
                     SAFE_ACCESS(description, identifier, 0u))};
@@ -270,4 +286,15 @@ bool EmbedderThreadHost::PostTask(int64_t runner, uint64_t task) const {
   return found->second->PostTask(task);
 }
 
+bool EmbedderThreadHost::RunExpiredTasks(
+    int64_t runner,
+    fml::TimePoint* next_target_time) const {
+  auto found = runners_map_.find(runner);
+  if (found == runners_map_.end()) {
+    return false;
+  }
+  *next_target_time = found->second->RunExpiredTasks();
+  return true;
+}
+
 }  // namespace flutter
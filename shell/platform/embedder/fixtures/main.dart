@@ -161,6 +161,17 @@ void platform_messages_response() {
   signalNativeTest();
 }
 
+@pragma('vm:entry-point')
+void platform_message_responses_without_copies() {
+  window.sendPlatformMessage('test/no_copy_response', null, (ByteData response) {
+    bool matches = response.lengthInBytes == 1 << 20;
+    for (int i = 0; matches && i < response.lengthInBytes; i++) {
+      matches = response.getUint8(i) == (i & 0xff);
+    }
+    signalNativeMessage(matches.toString());
+  });
+}
+
 @pragma('vm:entry-point')
 void platform_messages_no_response() {
   window.onPlatformMessage = (String name, ByteData data, PlatformMessageResponseCallback callback) {
@@ -25,11 +25,13 @@ PlatformViewEmbedder::PlatformViewEmbedder(
     flutter::TaskRunners task_runners,
     EmbedderSurfaceSoftware::SoftwareDispatchTable software_dispatch_table,
     PlatformDispatchTable platform_dispatch_table,
-    std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder)
+    std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder,
+    std::shared_ptr<fml::ConcurrentTaskRunner> tile_worker_task_runner)
     : PlatformView(delegate, std::move(task_runners)),
       embedder_surface_(std::make_unique<EmbedderSurfaceSoftware>(
           software_dispatch_table,
-          std::move(external_view_embedder))),
+          std::move(external_view_embedder),
+          std::move(tile_worker_task_runner))),
       platform_dispatch_table_(platform_dispatch_table) {}
 
 PlatformViewEmbedder::~PlatformViewEmbedder() = default;
@@ -47,6 +49,14 @@ void PlatformViewEmbedder::UpdateSemantics(
   }
 }
 
+void PlatformViewEmbedder::UpdateEncodedSemantics(
+    flutter::EncodedSemanticsUpdate update,
+    flutter::CustomAccessibilityActionUpdates actions) {
+  if (platform_dispatch_table_.update_encoded_semantics_callback != nullptr) {
+    platform_dispatch_table_.update_encoded_semantics_callback(update, actions);
+  }
+}
+
 void PlatformViewEmbedder::HandlePlatformMessage(
     fml::RefPtr<flutter::PlatformMessage> message) {
   if (!message) {
@@ -23,6 +23,10 @@ class PlatformViewEmbedder final : public PlatformView {
       std::function<void(flutter::SemanticsNodeUpdates update)>;
   using UpdateSemanticsCustomActionsCallback =
       std::function<void(flutter::CustomAccessibilityActionUpdates actions)>;
+  using UpdateEncodedSemanticsCallback =
+      std::function<void(const flutter::EncodedSemanticsUpdate& update,
+                         const flutter::CustomAccessibilityActionUpdates&
+                             actions)>;
   using PlatformMessageResponseCallback =
       std::function<void(fml::RefPtr<flutter::PlatformMessage>)>;
 
@@ -30,6 +34,8 @@ class PlatformViewEmbedder final : public PlatformView {
     UpdateSemanticsNodesCallback update_semantics_nodes_callback;  // optional
     UpdateSemanticsCustomActionsCallback
         update_semantics_custom_actions_callback;  // optional
+    UpdateEncodedSemanticsCallback
+        update_encoded_semantics_callback;  // optional
     PlatformMessageResponseCallback
         platform_message_response_callback;             // optional
     VsyncWaiterEmbedder::VsyncCallback vsync_callback;  // optional
@@ -50,7 +56,9 @@ class PlatformViewEmbedder final : public PlatformView {
       flutter::TaskRunners task_runners,
       EmbedderSurfaceSoftware::SoftwareDispatchTable software_dispatch_table,
       PlatformDispatchTable platform_dispatch_table,
-      std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder);
+      std::unique_ptr<EmbedderExternalViewEmbedder> external_view_embedder,
+      std::shared_ptr<fml::ConcurrentTaskRunner> tile_worker_task_runner =
+          nullptr);
 
   ~PlatformViewEmbedder() override;
 
@@ -59,6 +67,11 @@ class PlatformViewEmbedder final : public PlatformView {
       flutter::SemanticsNodeUpdates update,
       flutter::CustomAccessibilityActionUpdates actions) override;
 
+  // |PlatformView|
+  void UpdateEncodedSemantics(
+      flutter::EncodedSemanticsUpdate update,
+      flutter::CustomAccessibilityActionUpdates actions) override;
+
   // |PlatformView|
   void HandlePlatformMessage(
       fml::RefPtr<flutter::PlatformMessage> message) override;
@@ -201,5 +201,100 @@ TEST_F(Embedder11yTest, A11yTreeIsConsistent) {
   latch.Wait();
 }
 
+
+TEST_F(Embedder11yTest, A11yTreeIsSentAsOneUpdate) {
+  auto& context = GetEmbedderContext();
+
+  fml::AutoResetWaitableEvent latch;
+  fml::AutoResetWaitableEvent semantics_enabled_latch;
+  fml::AutoResetWaitableEvent features_latch;
+  context.AddNativeCallback(
+      "SignalNativeTest", CREATE_NATIVE_ENTRY(([&latch](Dart_NativeArguments) {
+        latch.Signal();
+      })));
+  context.AddNativeCallback(
+      "NotifySemanticsEnabled",
+      CREATE_NATIVE_ENTRY(([&semantics_enabled_latch](Dart_NativeArguments) {
+        semantics_enabled_latch.Signal();
+      })));
+  context.AddNativeCallback(
+      "NotifyAccessibilityFeatures",
+      CREATE_NATIVE_ENTRY(([&features_latch](Dart_NativeArguments) {
+        features_latch.Signal();
+      })));
+  context.AddNativeCallback("NotifySemanticsAction",
+                            CREATE_NATIVE_ENTRY(([](Dart_NativeArguments) {})));
+
+  // The nodes must not be sent one at a time as well.
+  context.SetSemanticsNodeCallback(
+      [](const FlutterSemanticsNode* node) { FAIL(); });
+  context.SetSemanticsCustomActionCallback(
+      [](const FlutterSemanticsCustomAction* action) { FAIL(); });
+
+  int update_count = 0;
+  context.SetSemanticsUpdateCallback([&update_count](
+                                         const FlutterSemanticsUpdate* update) {
+    ++update_count;
+    ASSERT_EQ(update->node_count, 4u);
+    ASSERT_EQ(update->removed_node_count, 0u);
+    ASSERT_EQ(update->custom_action_count, 1u);
+    ASSERT_EQ(update->custom_actions[0].id, 21);
+    ASSERT_STREQ(update->custom_actions[0].label, "Archive");
+
+    const char* empty_hint = nullptr;
+    for (size_t i = 0; i < update->node_count; ++i) {
+      const FlutterSemanticsNodeDelta& node = update->nodes[i];
+      // Every field of a new node is set.
+      ASSERT_TRUE(node.changed_fields & kFlutterSemanticsNodeFieldLabel);
+      ASSERT_TRUE(node.changed_fields & kFlutterSemanticsNodeFieldTransform);
+      ASSERT_TRUE(node.changed_fields & kFlutterSemanticsNodeFieldChildren);
+      ASSERT_EQ(2.0, node.transform.skewX);
+      ASSERT_EQ(9.0, node.transform.pers2);
+      // The empty hint of every node is the same string.
+      ASSERT_STREQ(node.hint, "");
+      if (empty_hint == nullptr) {
+        empty_hint = node.hint;
+      }
+      ASSERT_EQ(node.hint, empty_hint);
+
+      if (node.id == 42) {
+        ASSERT_STREQ(node.label, "A: root");
+        ASSERT_EQ(node.child_count, 2u);
+        ASSERT_EQ(node.children_in_traversal_order[0], 84);
+        ASSERT_EQ(node.children_in_hit_test_order[0], 96);
+      } else if (node.id == 128) {
+        ASSERT_EQ(0x3f3, node.platform_view_id);
+        ASSERT_EQ(node.custom_accessibility_actions_count, 1u);
+        ASSERT_EQ(node.custom_accessibility_actions[0], 21);
+      }
+    }
+  });
+
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  builder.SetSemanticsUpdateCallbackHook();
+  builder.SetDartEntrypoint("a11y_main");
+
+  auto engine = builder.LaunchEngine();
+  ASSERT_TRUE(engine.is_valid());
+
+  // Wait for the initial NotifySemanticsEnabled(false), then enable semantics
+  // and the accessibility features the fixture waits for.
+  semantics_enabled_latch.Wait();
+  auto result = FlutterEngineUpdateSemanticsEnabled(engine.get(), true);
+  ASSERT_EQ(result, FlutterEngineResult::kSuccess);
+  semantics_enabled_latch.Wait();
+  features_latch.Wait();
+  result = FlutterEngineUpdateAccessibilityFeatures(
+      engine.get(), kFlutterAccessibilityFeatureReduceMotion);
+  ASSERT_EQ(result, FlutterEngineResult::kSuccess);
+  features_latch.Wait();
+
+  // Wait for the update on the platform (current) thread.
+  latch.Wait();
+  fml::MessageLoop::GetCurrent().RunExpiredTasksNow();
+  ASSERT_EQ(update_count, 1);
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -144,6 +144,11 @@ void EmbedderConfigBuilder::SetSemanticsCallbackHooks() {
       EmbedderTestContext::GetUpdateSemanticsCustomActionCallbackHook();
 }
 
+void EmbedderConfigBuilder::SetSemanticsUpdateCallbackHook() {
+  project_args_.update_semantics_callback =
+      EmbedderTestContext::GetUpdateSemanticsCallbackHook();
+}
+
 void EmbedderConfigBuilder::SetDartEntrypoint(std::string entrypoint) {
   if (entrypoint.size() == 0) {
     return;
@@ -230,7 +235,12 @@ UniqueEngine EmbedderConfigBuilder::InitializeEngine() const {
   return SetupEngine(false);
 }
 
-UniqueEngine EmbedderConfigBuilder::SetupEngine(bool run) const {
+UniqueEngine EmbedderConfigBuilder::SpawnEngine(FlutterEngine spawner) const {
+  return SetupEngine(true, spawner);
+}
+
+UniqueEngine EmbedderConfigBuilder::SetupEngine(bool run,
+                                                FlutterEngine spawner) const {
   FlutterEngine engine = nullptr;
   FlutterProjectArgs project_args = project_args_;
 
@@ -251,11 +261,18 @@ UniqueEngine EmbedderConfigBuilder::SetupEngine(bool run) const {
     project_args.command_line_argc = 0;
   }
 
-  auto result =
-      run ? FlutterEngineRun(FLUTTER_ENGINE_VERSION, &renderer_config_,
-                             &project_args, &context_, &engine)
-          : FlutterEngineInitialize(FLUTTER_ENGINE_VERSION, &renderer_config_,
-                                    &project_args, &context_, &engine);
+  FlutterEngineResult result;
+  if (spawner) {
+    result = FlutterEngineSpawn(spawner, FLUTTER_ENGINE_VERSION,
+                                &renderer_config_, &project_args, &context_,
+                                &engine);
+  } else {
+    result =
+        run ? FlutterEngineRun(FLUTTER_ENGINE_VERSION, &renderer_config_,
+                               &project_args, &context_, &engine)
+            : FlutterEngineInitialize(FLUTTER_ENGINE_VERSION, &renderer_config_,
+                                      &project_args, &context_, &engine);
+  }
 
   if (result != kSuccess) {
     return {};
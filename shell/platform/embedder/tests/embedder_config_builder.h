@@ -55,6 +55,8 @@ class EmbedderConfigBuilder {
 
   void SetSemanticsCallbackHooks();
 
+  void SetSemanticsUpdateCallbackHook();
+
   void SetDartEntrypoint(std::string entrypoint);
 
   void AddCommandLineArgument(std::string arg);
@@ -74,6 +76,8 @@ class EmbedderConfigBuilder {
 
   UniqueEngine InitializeEngine() const;
 
+  UniqueEngine SpawnEngine(FlutterEngine spawner) const;
+
  private:
   EmbedderTestContext& context_;
   FlutterProjectArgs project_args_ = {};
@@ -85,7 +89,7 @@ class EmbedderConfigBuilder {
   FlutterCompositor compositor_ = {};
   std::vector<std::string> command_line_arguments_;
 
-  UniqueEngine SetupEngine(bool run) const;
+  UniqueEngine SetupEngine(bool run, FlutterEngine spawner = nullptr) const;
 
   FML_DISALLOW_COPY_AND_ASSIGN(EmbedderConfigBuilder);
 };
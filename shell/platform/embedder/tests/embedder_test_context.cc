@@ -122,6 +122,11 @@ void EmbedderTestContext::SetSemanticsCustomActionCallback(
       update_semantics_custom_action_callback;
 }
 
+void EmbedderTestContext::SetSemanticsUpdateCallback(
+    const SemanticsUpdateCallback& update_semantics_callback) {
+  update_semantics_callback_ = update_semantics_callback;
+}
+
 void EmbedderTestContext::SetPlatformMessageCallback(
     const std::function<void(const FlutterPlatformMessage*)>& callback) {
   platform_message_callback_ = callback;
@@ -154,6 +159,16 @@ EmbedderTestContext::GetUpdateSemanticsCustomActionCallbackHook() {
   };
 }
 
+FlutterUpdateSemanticsCallback
+EmbedderTestContext::GetUpdateSemanticsCallbackHook() {
+  return [](const FlutterSemanticsUpdate* update, void* user_data) {
+    auto context = reinterpret_cast<EmbedderTestContext*>(user_data);
+    if (auto callback = context->update_semantics_callback_) {
+      callback(update);
+    }
+  };
+}
+
 void EmbedderTestContext::SetupOpenGLSurface(SkISize surface_size) {
   FML_CHECK(!gl_surface_);
   gl_surface_ = std::make_unique<TestGLSurface>(surface_size);
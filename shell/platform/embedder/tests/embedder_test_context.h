@@ -27,6 +27,8 @@ namespace testing {
 using SemanticsNodeCallback = std::function<void(const FlutterSemanticsNode*)>;
 using SemanticsActionCallback =
     std::function<void(const FlutterSemanticsCustomAction*)>;
+using SemanticsUpdateCallback =
+    std::function<void(const FlutterSemanticsUpdate*)>;
 
 class EmbedderTestContext {
  public:
@@ -56,6 +58,9 @@ class EmbedderTestContext {
   void SetSemanticsCustomActionCallback(
       const SemanticsActionCallback& semantics_custom_action);
 
+  void SetSemanticsUpdateCallback(
+      const SemanticsUpdateCallback& update_semantics);
+
   void SetPlatformMessageCallback(
       const std::function<void(const FlutterPlatformMessage*)>& callback);
 
@@ -86,6 +91,7 @@ class EmbedderTestContext {
   std::shared_ptr<TestDartNativeResolver> native_resolver_;
   SemanticsNodeCallback update_semantics_node_callback_;
   SemanticsActionCallback update_semantics_custom_action_callback_;
+  SemanticsUpdateCallback update_semantics_callback_;
   std::function<void(const FlutterPlatformMessage*)> platform_message_callback_;
   std::unique_ptr<TestGLSurface> gl_surface_;
   std::unique_ptr<EmbedderTestCompositor> compositor_;
@@ -102,6 +108,8 @@ class EmbedderTestContext {
   static FlutterUpdateSemanticsCustomActionCallback
   GetUpdateSemanticsCustomActionCallbackHook();
 
+  static FlutterUpdateSemanticsCallback GetUpdateSemanticsCallbackHook();
+
   void SetupCompositor();
 
   void FireIsolateCreateCallbacks();
@@ -4,7 +4,10 @@
 
 #define FML_USED_ON_EMBEDDER
 
+#include <atomic>
+#include <memory>
 #include <string>
+#include <thread>
 
 #include "embedder.h"
 #include "embedder_engine.h"
@@ -18,6 +21,7 @@
 #include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/fml/thread.h"
 #include "flutter/runtime/dart_vm.h"
+#include "flutter/shell/platform/embedder/embedder_task_runner.h"
 #include "flutter/shell/platform/embedder/tests/embedder_assertions.h"
 #include "flutter/shell/platform/embedder/tests/embedder_config_builder.h"
 #include "flutter/shell/platform/embedder/tests/embedder_test.h"
@@ -78,6 +82,62 @@ TEST_F(EmbedderTest, CanInvokeCustomEntrypoint) {
   ASSERT_TRUE(engine.is_valid());
 }
 
+TEST_F(EmbedderTest, CanSpawnEngineFromRunningEngine) {
+  auto& context = GetEmbedderContext();
+  static fml::AutoResetWaitableEvent latch;
+  Dart_NativeFunction entrypoint = [](Dart_NativeArguments args) {
+    latch.Signal();
+  };
+  context.AddNativeCallback("SayHiFromCustomEntrypoint", entrypoint);
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  auto spawner = builder.LaunchEngine();
+  ASSERT_TRUE(spawner.is_valid());
+
+  builder.SetDartEntrypoint("customEntrypoint");
+  auto engine = builder.SpawnEngine(spawner.get());
+  ASSERT_TRUE(engine.is_valid());
+  latch.Wait();
+}
+
+TEST_F(EmbedderTest, MustNotShutDownEngineWithSpawnedEngines) {
+  auto& context = GetEmbedderContext();
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  auto spawner = builder.LaunchEngine();
+  ASSERT_TRUE(spawner.is_valid());
+  auto engine = builder.SpawnEngine(spawner.get());
+  ASSERT_TRUE(engine.is_valid());
+
+  // The spawned engine uses the resources of the spawner.
+  ASSERT_EQ(FlutterEngineShutdown(spawner.get()), kInvalidArguments);
+  ASSERT_EQ(FlutterEngineDeinitialize(spawner.get()), kInvalidArguments);
+
+  FlutterWindowMetricsEvent event = {};
+  event.struct_size = sizeof(event);
+  event.width = 800;
+  event.height = 600;
+  event.pixel_ratio = 1.0;
+  ASSERT_EQ(FlutterEngineSendWindowMetricsEvent(spawner.get(), &event),
+            kSuccess);
+  ASSERT_EQ(FlutterEngineSendWindowMetricsEvent(engine.get(), &event),
+            kSuccess);
+
+  engine.reset();
+  ASSERT_EQ(FlutterEngineShutdown(spawner.release()), kSuccess);
+}
+
+TEST_F(EmbedderTest, MustNotSpawnFromInvalidEngine) {
+  auto& context = GetEmbedderContext();
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  auto spawner = builder.InitializeEngine();
+  ASSERT_TRUE(spawner.is_valid());
+  // The engine to spawn from has not been run yet.
+  auto engine = builder.SpawnEngine(spawner.get());
+  ASSERT_FALSE(engine.is_valid());
+}
+
 TEST_F(EmbedderTest, CanInvokeCustomEntrypointMacro) {
   auto& context = GetEmbedderContext();
 
@@ -237,6 +297,203 @@ TEST_F(EmbedderTest, CanSpecifyCustomPlatformTaskRunner) {
   signaled_once = false;
 }
 
+TEST(EmbedderTestNoFixture, BatchedTaskRunnerWakesOnlyForEarlierTasks) {
+  std::vector<fml::TimePoint> wake_times;
+  EmbedderTaskRunner::DispatchTable table = {};
+  table.wake_callback = [&wake_times](EmbedderTaskRunner* task_runner,
+                                      fml::TimePoint target_time) {
+    wake_times.push_back(target_time);
+  };
+  table.runs_task_on_current_thread_callback = []() { return true; };
+  auto embedder_task_runner =
+      fml::MakeRefCounted<EmbedderTaskRunner>(std::move(table), 1u);
+  fml::RefPtr<fml::TaskRunner> task_runner = embedder_task_runner;
+
+  std::vector<int> order;
+  const auto later = fml::TimePoint::Now() + fml::TimeDelta::FromSeconds(60);
+  task_runner->PostTaskForTime([&order]() { order.push_back(-1); }, later);
+  for (int i = 0; i < 100; i++) {
+    task_runner->PostTask([&order, i]() { order.push_back(i); });
+  }
+  // Once for the delayed task and once for the first of the others.
+  ASSERT_EQ(wake_times.size(), 2u);
+  ASSERT_EQ(wake_times[0], later);
+
+  ASSERT_EQ(embedder_task_runner->RunExpiredTasks(), later);
+  ASSERT_EQ(order.size(), 100u);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(order[i], i);
+  }
+
+  // The embedder already knows to call again when the delayed task expires.
+  task_runner->PostTaskForTime([]() {}, later + fml::TimeDelta::FromSeconds(1));
+  ASSERT_EQ(wake_times.size(), 2u);
+}
+
+TEST(EmbedderTestNoFixture, BatchedTaskRunnerLeavesTasksPostedByTasks) {
+  size_t wake_count = 0;
+  EmbedderTaskRunner::DispatchTable table = {};
+  table.wake_callback = [&wake_count](EmbedderTaskRunner* task_runner,
+                                      fml::TimePoint target_time) {
+    wake_count++;
+  };
+  table.runs_task_on_current_thread_callback = []() { return true; };
+  auto embedder_task_runner =
+      fml::MakeRefCounted<EmbedderTaskRunner>(std::move(table), 1u);
+  fml::RefPtr<fml::TaskRunner> task_runner = embedder_task_runner;
+
+  bool reposted_task_ran = false;
+  task_runner->PostTask([&]() {
+    task_runner->PostTask([&]() { reposted_task_ran = true; });
+  });
+  ASSERT_EQ(wake_count, 1u);
+
+  const auto next_target_time = embedder_task_runner->RunExpiredTasks();
+  ASSERT_FALSE(reposted_task_ran);
+  ASSERT_EQ(wake_count, 2u);
+  ASSERT_LE(next_target_time, fml::TimePoint::Now());
+
+  ASSERT_EQ(embedder_task_runner->RunExpiredTasks(), fml::TimePoint::Max());
+  ASSERT_TRUE(reposted_task_ran);
+}
+
+namespace {
+
+//------------------------------------------------------------------------------
+/// @brief      Runs the tasks of a platform task runner with a wake callback on
+///             a real FML task runner, the way an embedder with its own event
+///             loop would.
+///
+struct WakingPlatformTaskRunner
+    : public std::enable_shared_from_this<WakingPlatformTaskRunner> {
+  fml::RefPtr<fml::TaskRunner> real_task_runner;
+  std::mutex engine_mutex;
+  UniqueEngine engine;
+  bool message_received = false;
+  bool ran_out_of_tasks = false;
+  fml::AutoResetWaitableEvent idle_latch;
+
+  void RunExpiredTasksAt(FlutterTaskRunner runner, uint64_t target_time_nanos) {
+    real_task_runner->PostTaskForTime(
+        // Tasks for later times may outlive the test.
+        [this, self = shared_from_this(), runner]() {
+          std::scoped_lock lock(engine_mutex);
+          if (!engine.is_valid()) {
+            return;
+          }
+          uint64_t next_target_time_nanos = 0;
+          ASSERT_EQ(FlutterEngineRunExpiredTasks(engine.get(), runner,
+                                                 &next_target_time_nanos),
+                    kSuccess);
+          if (next_target_time_nanos != UINT64_MAX) {
+            RunExpiredTasksAt(runner, next_target_time_nanos);
+          } else if (message_received && !ran_out_of_tasks) {
+            ran_out_of_tasks = true;
+            idle_latch.Signal();
+          }
+        },
+        fml::TimePoint::FromEpochDelta(
+            fml::TimeDelta::FromNanoseconds(target_time_nanos)));
+  }
+};
+
+}  // namespace
+
+TEST_F(EmbedderTest, CanRunCustomPlatformTaskRunnerWithWakeCallback) {
+  auto& context = GetEmbedderContext();
+  auto waking_runner = std::make_shared<WakingPlatformTaskRunner>();
+  auto& waking = *waking_runner;
+  waking.real_task_runner = CreateNewThread("test_platform_thread");
+
+  FlutterTaskRunnerDescription task_runner_description = {};
+  task_runner_description.struct_size = sizeof(FlutterTaskRunnerDescription);
+  task_runner_description.user_data = &waking;
+  task_runner_description.runs_task_on_current_thread_callback =
+      [](void* user_data) -> bool {
+    return reinterpret_cast<WakingPlatformTaskRunner*>(user_data)
+        ->real_task_runner->RunsTasksOnCurrentThread();
+  };
+  // Only the wake callback is given, tasks are never handed out one at a time.
+  task_runner_description.post_task_callback = nullptr;
+  task_runner_description.wake_callback =
+      [](FlutterTaskRunner runner, uint64_t target_time_nanos,
+         void* user_data) -> void {
+    reinterpret_cast<WakingPlatformTaskRunner*>(user_data)->RunExpiredTasksAt(
+        runner, target_time_nanos);
+  };
+  task_runner_description.identifier = 1;
+
+  // Platform messages are delivered from within the expired tasks.
+  context.SetPlatformMessageCallback(
+      [&waking](const FlutterPlatformMessage* message) {
+        ASSERT_TRUE(waking.real_task_runner->RunsTasksOnCurrentThread());
+        if (strcmp(message->channel, "OhHi") == 0) {
+          waking.message_received = true;
+        }
+      });
+
+  waking.real_task_runner->PostTask([&]() {
+    EmbedderConfigBuilder builder(context);
+    builder.SetSoftwareRendererConfig();
+    builder.SetPlatformTaskRunner(&task_runner_description);
+    builder.SetDartEntrypoint("invokePlatformTaskRunner");
+    std::scoped_lock lock(waking.engine_mutex);
+    waking.engine = builder.LaunchEngine();
+    ASSERT_TRUE(waking.engine.is_valid());
+  });
+
+  // Signaled once the message was received and no tasks are pending anymore.
+  waking.idle_latch.Wait();
+
+  fml::AutoResetWaitableEvent kill_latch;
+  waking.real_task_runner->PostTask([&]() {
+    std::scoped_lock lock(waking.engine_mutex);
+    // Only the runners of the engine can be run.
+    uint64_t next_target_time_nanos = 0;
+    int other_runner = 0;
+    ASSERT_EQ(FlutterEngineRunExpiredTasks(
+                  waking.engine.get(),
+                  reinterpret_cast<FlutterTaskRunner>(&other_runner),
+                  &next_target_time_nanos),
+              kInvalidArguments);
+    ASSERT_EQ(FlutterEngineRunExpiredTasks(waking.engine.get(), nullptr,
+                                           &next_target_time_nanos),
+              kInvalidArguments);
+
+    // Since the engine was started on its own thread, it must be killed there
+    // as well.
+    waking.engine.reset();
+    waking.real_task_runner->PostTask([&kill_latch] { kill_latch.Signal(); });
+  });
+  kill_latch.Wait();
+  ASSERT_TRUE(waking.message_received);
+}
+
+TEST(EmbedderTestNoFixture, BatchedTaskRunnerWakeMayWaitForOtherThreads) {
+  std::vector<fml::TimePoint> wake_times;
+  fml::RefPtr<fml::TaskRunner> task_runner;
+  const auto later = fml::TimePoint::Now() + fml::TimeDelta::FromSeconds(60);
+  EmbedderTaskRunner::DispatchTable table = {};
+  table.wake_callback = [&](EmbedderTaskRunner* embedder_task_runner,
+                            fml::TimePoint target_time) {
+    wake_times.push_back(target_time);
+    if (wake_times.size() == 1) {
+      // The wake of the task posted by the other thread is made once this
+      // call returns.
+      std::thread thread([&]() { task_runner->PostTask([]() {}); });
+      thread.join();
+      ASSERT_EQ(wake_times.size(), 1u);
+    }
+  };
+  table.runs_task_on_current_thread_callback = []() { return true; };
+  task_runner = fml::MakeRefCounted<EmbedderTaskRunner>(std::move(table), 1u);
+
+  task_runner->PostTaskForTime([]() {}, later);
+  ASSERT_EQ(wake_times.size(), 2u);
+  ASSERT_EQ(wake_times[0], later);
+  ASSERT_LT(wake_times[1], later);
+}
+
 TEST(EmbedderTestNoFixture, CanGetCurrentTimeInNanoseconds) {
   auto point1 = fml::TimePoint::FromEpochDelta(
       fml::TimeDelta::FromNanoseconds(FlutterEngineGetCurrentTime()));
@@ -507,6 +764,170 @@ TEST_F(EmbedderTest, InvalidPlatformMessages) {
   ASSERT_EQ(result, kInvalidArguments);
 }
 
+//------------------------------------------------------------------------------
+/// Tests that a message buffer handed over to the engine round trips through
+/// the Dart application and is released by the engine.
+///
+TEST_F(EmbedderTest, PlatformMessagesCanBeSentWithoutCopies) {
+  auto& context = GetEmbedderContext();
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  builder.SetDartEntrypoint("platform_messages_response");
+
+  fml::AutoResetWaitableEvent ready, response;
+  context.AddNativeCallback(
+      "SignalNativeTest",
+      CREATE_NATIVE_ENTRY(
+          [&ready](Dart_NativeArguments args) { ready.Signal(); }));
+
+  auto engine = builder.LaunchEngine();
+  ASSERT_TRUE(engine.is_valid());
+  ready.Wait();
+
+  // Large enough to be handed to Dart as external typed data.
+  auto buffer = new std::vector<uint8_t>(1 << 20);
+  for (size_t i = 0; i < buffer->size(); i++) {
+    (*buffer)[i] = static_cast<uint8_t>(i);
+  }
+
+  FlutterPlatformMessageResponseHandle* response_handle = nullptr;
+  auto callback = [](const uint8_t* data, size_t size, void* user_data) {
+    EXPECT_EQ(size, 1u << 20);
+    for (size_t i = 0; i < size; i++) {
+      if (data[i] != static_cast<uint8_t>(i)) {
+        ADD_FAILURE() << "Response differs at " << i;
+        break;
+      }
+    }
+    reinterpret_cast<fml::AutoResetWaitableEvent*>(user_data)->Signal();
+  };
+  ASSERT_EQ(FlutterPlatformMessageCreateResponseHandle(
+                engine.get(), callback, &response, &response_handle),
+            kSuccess);
+
+  FlutterPlatformMessage platform_message = {};
+  platform_message.struct_size = sizeof(FlutterPlatformMessage);
+  platform_message.channel = "test_channel";
+  platform_message.message = buffer->data();
+  platform_message.message_size = buffer->size();
+  platform_message.response_handle = response_handle;
+  platform_message.release_callback = [](void* user_data) {
+    delete reinterpret_cast<std::vector<uint8_t>*>(user_data);
+  };
+  platform_message.release_user_data = buffer;
+
+  ASSERT_EQ(FlutterEngineSendPlatformMessage(engine.get(), &platform_message),
+            kSuccess);
+  ASSERT_EQ(FlutterPlatformMessageReleaseResponseHandle(engine.get(),
+                                                        response_handle),
+            kSuccess);
+  response.Wait();
+}
+
+//------------------------------------------------------------------------------
+/// Tests that a message buffer handed over to the engine is released even if
+/// the message could not be sent.
+///
+TEST_F(EmbedderTest, UnsentPlatformMessagesAreReleased) {
+  size_t releases = 0;
+  const uint8_t data[] = {1, 2, 3};
+
+  FlutterPlatformMessage platform_message = {};
+  platform_message.struct_size = sizeof(FlutterPlatformMessage);
+  platform_message.channel = "test_channel";
+  platform_message.message = data;
+  platform_message.message_size = sizeof(data);
+  platform_message.release_callback = [](void* user_data) {
+    (*reinterpret_cast<size_t*>(user_data))++;
+  };
+  platform_message.release_user_data = &releases;
+
+  ASSERT_EQ(FlutterEngineSendPlatformMessage(nullptr, &platform_message),
+            kInvalidArguments);
+  ASSERT_EQ(releases, 1u);
+}
+
+//------------------------------------------------------------------------------
+/// Tests that a response buffer handed over to the engine reaches the Dart
+/// application intact and is released exactly once.
+///
+TEST_F(EmbedderTest, PlatformMessageResponsesCanBeSentWithoutCopies) {
+  auto& context = GetEmbedderContext();
+  fml::AutoResetWaitableEvent message_received, response_received;
+  const FlutterPlatformMessageResponseHandle* response_handle = nullptr;
+  context.AddNativeCallback(
+      "SignalNativeMessage",
+      CREATE_NATIVE_ENTRY(([&response_received](Dart_NativeArguments args) {
+        auto received_message = tonic::DartConverter<std::string>::FromDart(
+            Dart_GetNativeArgument(args, 0));
+        ASSERT_EQ("true", received_message);
+        response_received.Signal();
+      })));
+
+  // Platform messages are delivered on the thread the engine is launched on,
+  // which must not be blocked waiting for them.
+  fml::Thread thread;
+  UniqueEngine engine;
+  thread.GetTaskRunner()->PostTask([&]() {
+    EmbedderConfigBuilder builder(context);
+    builder.SetSoftwareRendererConfig();
+    builder.SetDartEntrypoint("platform_message_responses_without_copies");
+    builder.SetPlatformMessageCallback(
+        [&](const FlutterPlatformMessage* message) {
+          if (strcmp(message->channel, "test/no_copy_response") == 0) {
+            response_handle = message->response_handle;
+            message_received.Signal();
+          }
+        });
+    engine = builder.LaunchEngine();
+    ASSERT_TRUE(engine.is_valid());
+  });
+  message_received.Wait();
+  ASSERT_NE(response_handle, nullptr);
+
+  // Large enough to be handed to Dart as external typed data.
+  std::vector<uint8_t> buffer(1 << 20);
+  for (size_t i = 0; i < buffer.size(); i++) {
+    buffer[i] = static_cast<uint8_t>(i);
+  }
+  std::atomic_size_t releases = {};
+  ASSERT_EQ(FlutterEngineSendPlatformMessageResponseNoCopy(
+                engine.get(), response_handle, buffer.data(), buffer.size(),
+                [](void* user_data) {
+                  (*reinterpret_cast<std::atomic_size_t*>(user_data))++;
+                },
+                &releases),
+            kSuccess);
+  response_received.Wait();
+
+  // The typed data Dart was given owns the buffer until the isolate is gone.
+  // Since the engine was started on its own thread, it must be killed there
+  // as well.
+  fml::AutoResetWaitableEvent kill_latch;
+  thread.GetTaskRunner()->PostTask([&engine, &kill_latch]() {
+    engine.reset();
+    kill_latch.Signal();
+  });
+  kill_latch.Wait();
+  ASSERT_EQ(releases, 1u);
+}
+
+//------------------------------------------------------------------------------
+/// Tests that a response buffer handed over to the engine is released even if
+/// the response could not be sent.
+///
+TEST_F(EmbedderTest, UnsentPlatformMessageResponsesAreReleased) {
+  size_t releases = 0;
+  ASSERT_EQ(FlutterEngineSendPlatformMessageResponseNoCopy(
+                nullptr, nullptr, nullptr, 1,
+                [](void* user_data) {
+                  (*reinterpret_cast<size_t*>(user_data))++;
+                },
+                &releases),
+            kInvalidArguments);
+  ASSERT_EQ(releases, 1u);
+}
+
 //------------------------------------------------------------------------------
 /// Asserts behavior of FlutterProjectArgs::shutdown_dart_vm_when_done (which is
 /// set to true by default in these unit-tests).
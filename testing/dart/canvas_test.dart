@@ -197,4 +197,91 @@ void main() {
         await fuzzyGoldenImageCompare(image, 'canvas_test_dithered_gradient.png');
     expect(areEqual, true);
   });
+
+  Future<int> readPixel(Picture picture, int x, int y) async {
+    final Image image = await picture.toImage(100, 100);
+    final ByteData data = await image.toByteData();
+    return data.getUint32((x + y * image.width) * 4);
+  }
+
+  const int red = 0xFF0000FF;
+  const int blue = 0x0000FFFF;
+
+  test('Changing a paint does not change what was drawn with it', () async {
+    final PictureRecorder recorder = PictureRecorder();
+    final Canvas canvas = Canvas(recorder);
+    final Paint paint = Paint()..color = const Color(0xFFFF0000);
+    canvas.drawRect(const Rect.fromLTRB(0, 0, 50, 100), paint);
+    paint.color = const Color(0xFF0000FF);
+    canvas.drawRect(const Rect.fromLTRB(50, 0, 100, 100), paint);
+    final Picture picture = recorder.endRecording();
+
+    expect(await readPixel(picture, 25, 50), red);
+    expect(await readPixel(picture, 75, 50), blue);
+  });
+
+  test('Canvases recording at the same time keep their own operations', () async {
+    final PictureRecorder redRecorder = PictureRecorder();
+    final Canvas redCanvas = Canvas(redRecorder);
+    final PictureRecorder blueRecorder = PictureRecorder();
+    final Canvas blueCanvas = Canvas(blueRecorder);
+    final Paint redPaint = Paint()..color = const Color(0xFFFF0000);
+    final Paint bluePaint = Paint()..color = const Color(0xFF0000FF);
+
+    redCanvas.translate(50, 0);
+    blueCanvas.drawRect(const Rect.fromLTRB(0, 0, 50, 100), bluePaint);
+    redCanvas.drawRect(const Rect.fromLTRB(0, 0, 50, 100), redPaint);
+    final Picture bluePicture = blueRecorder.endRecording();
+    final Picture redPicture = redRecorder.endRecording();
+
+    expect(await readPixel(redPicture, 25, 50), 0);
+    expect(await readPixel(redPicture, 75, 50), red);
+    expect(await readPixel(bluePicture, 25, 50), blue);
+    expect(await readPixel(bluePicture, 75, 50), 0);
+  });
+
+  test('Abandoned recordings do not break the canvases recorded after them', () async {
+    final Paint paint = Paint()..color = const Color(0xFF0000FF);
+    for (int i = 0; i < 1000; i += 1) {
+      // The operations of this canvas are replayed when the next one draws,
+      // after its recorder became unreachable.
+      Canvas(PictureRecorder()).drawRect(const Rect.fromLTRB(0, 0, 1, 1), paint);
+      // Allocate to give the garbage collector a reason to run.
+      final List<Uint8List> garbage = List<Uint8List>.generate(16, (int index) => Uint8List(64 * 1024));
+      expect(garbage, hasLength(16));
+    }
+    final PictureRecorder recorder = PictureRecorder();
+    final Canvas canvas = Canvas(recorder);
+    canvas.drawRect(const Rect.fromLTRB(0, 0, 100, 100), Paint()..color = const Color(0xFFFF0000));
+    final Picture picture = recorder.endRecording();
+
+    expect(await readPixel(picture, 50, 50), red);
+  });
+
+  test('Operations stay in order across many draws and direct calls', () async {
+    final PictureRecorder recorder = PictureRecorder();
+    final Canvas canvas = Canvas(recorder);
+    final Paint paint = Paint();
+    for (int i = 0; i < 5000; i += 1) {
+      canvas.save();
+      canvas.translate(i % 100.0, 0);
+      paint.color = Color(0xFF000000 | i);
+      canvas.drawRect(const Rect.fromLTRB(0, 0, 1, 1), paint);
+      if (i % 1000 == 0)
+        expect(canvas.getSaveCount(), 2);
+      canvas.restore();
+    }
+    canvas.drawPath(
+      Path()..addRect(const Rect.fromLTRB(0, 50, 100, 100)),
+      Paint()..color = const Color(0xFFFF0000),
+    );
+    canvas.drawRect(const Rect.fromLTRB(50, 50, 100, 100),
+        Paint()..color = const Color(0xFF0000FF));
+    final Picture picture = recorder.endRecording();
+
+    // The last of the 5000 rects drawn at x = 99 has i = 4999.
+    expect(await readPixel(picture, 99, 0), 0x001387FF);
+    expect(await readPixel(picture, 25, 75), red);
+    expect(await readPixel(picture, 75, 75), blue);
+  });
 }
@@ -57,8 +57,72 @@ void main() {
         final List<int> expected = await readFile('square.png');
         expect(Uint8List.view(data.buffer), expected);
       });
+
+      test('decodes to the same pixels with fast compression', () async {
+        final Image image = await Square4x4Image.image;
+        final ByteData data = await image.toByteData(
+            format: ImageByteFormat.png, fastCompression: true);
+        final Image decoded = await decodeImage(data.buffer.asUint8List());
+        final ByteData pixels = await decoded.toByteData();
+        expect(Uint8List.view(pixels.buffer), Square4x4Image.bytes);
+      });
+
+      test('decodes to the same pixels when encoded in stripes', () async {
+        // Large enough to be encoded in several stripes.
+        final Image image = await GradientImage.image;
+        final ByteData data = await image.toByteData(format: ImageByteFormat.png);
+        final Image decoded = await decodeImage(data.buffer.asUint8List());
+        final ByteData pixels = await decoded.toByteData();
+        final ByteData expected = await image.toByteData();
+        expect(Uint8List.view(pixels.buffer), Uint8List.view(expected.buffer));
+      });
     });
   });
+
+  group('Image.toByteDataChunks', () {
+    for (final ImageByteFormat format in ImageByteFormat.values) {
+      test('adds up to toByteData for $format', () async {
+        final Image image = await GradientImage.image;
+        final ByteData expected = await image.toByteData(format: format);
+        final List<Uint8List> chunks =
+            await image.toByteDataChunks(format: format).toList();
+        expect(chunks.length, greaterThan(1));
+        final BytesBuilder builder = BytesBuilder();
+        chunks.forEach(builder.add);
+        expect(builder.takeBytes(), Uint8List.view(expected.buffer));
+      });
+    }
+  });
+}
+
+Future<Image> decodeImage(Uint8List bytes) {
+  final Completer<Image> completer = Completer<Image>();
+  decodeImageFromList(bytes, (Image image) => completer.complete(image));
+  return completer.future;
+}
+
+class GradientImage {
+  GradientImage._();
+
+  static const int width = 1024;
+  static const int height = 768;
+
+  static Future<Image> get image async {
+    final Rect bounds =
+        Rect.fromLTWH(0.0, 0.0, width.toDouble(), height.toDouble());
+    final PictureRecorder recorder = PictureRecorder();
+    final Canvas canvas = Canvas(recorder, bounds);
+    canvas.drawRect(
+      bounds,
+      Paint()
+        ..shader = Gradient.linear(
+          bounds.topLeft,
+          bounds.bottomRight,
+          const <Color>[_kBlack, _kGreen],
+        ),
+    );
+    return await recorder.endRecording().toImage(width, height);
+  }
 }
 
 class Square4x4Image {
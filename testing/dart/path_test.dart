@@ -2,7 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-import 'dart:typed_data' show Float64List;
+import 'dart:typed_data' show Float32List, Float64List, Uint8List;
 import 'dart:ui';
 
 import 'package:test/test.dart';
@@ -218,4 +218,53 @@ void main() {
     expect(newFirstMetric.getTangentForOffset(4.0).vector, const Offset(0.0, 1.0));
     expect(newFirstMetric.extractPath(4.0, 10.0).computeMetrics().first.length, 6.0);
   });
+  test('path containsPoints', () {
+    final Path path = Path();
+    // More squares than it takes for the path to be indexed.
+    for (int i = 0; i < 40; i++) {
+      path.addRect(Rect.fromLTWH(i * 20.0, 0.0, 10.0, 10.0));
+    }
+    final Float32List points = Float32List.fromList(<double>[
+      5.0, 5.0, // In the first square.
+      15.0, 5.0, // Between the first two squares.
+      785.0, 5.0, // In the last square.
+      5.0, 15.0, // Below the first square.
+      -5.0, 5.0, // Left of the path.
+    ]);
+    final Uint8List expected = Uint8List.fromList(<int>[1, 0, 1, 0, 0]);
+    // The path is indexed after enough points are tested.
+    for (int i = 0; i < 100; i++) {
+      expect(path.containsPoints(points), expected);
+    }
+    expect(path.contains(const Offset(785.0, 5.0)), true);
+
+    // Changing the path drops the index.
+    path
+      ..addRect(const Rect.fromLTWH(10.0, 0.0, 10.0, 10.0))
+      ..addRect(const Rect.fromLTWH(0.0, 0.0, 10.0, 10.0));
+    for (int i = 0; i < 100; i++) {
+      expect(path.containsPoints(points), Uint8List.fromList(<int>[1, 1, 1, 0, 0]));
+    }
+    // So does changing its fill type.
+    path.fillType = PathFillType.evenOdd;
+    expect(path.containsPoints(points), Uint8List.fromList(<int>[0, 1, 1, 0, 0]));
+    expect(path.containsPoints(Float32List(0)), isEmpty);
+  });
+
+  test('PathMetric getTangentsForOffsets', () {
+    final Path path = Path()..lineTo(0, 10)..lineTo(10, 10);
+    final PathMetric metric = path.computeMetrics().first;
+    final Float32List distances = Float32List.fromList(<double>[4.0, 15.0, 30.0]);
+    final Float32List posTans = metric.getTangentsForOffsets(distances);
+    expect(posTans.length, 12);
+    for (int i = 0; i < distances.length; i++) {
+      final Tangent tangent = metric.getTangentForOffset(distances[i]);
+      expect(posTans[i * 4], tangent.position.dx);
+      expect(posTans[i * 4 + 1], tangent.position.dy);
+      expect(posTans[i * 4 + 2], tangent.vector.dx);
+      expect(posTans[i * 4 + 3], tangent.vector.dy);
+    }
+    // Distances past the end are clamped to the length.
+    expect(posTans.sublist(8), <double>[10.0, 10.0, 1.0, 0.0]);
+  });
 }
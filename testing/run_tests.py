@@ -83,6 +83,8 @@ def RunCCTests(build_dir, filter):
     "--gtest_repeat=2",
   ]
 
+  RunEngineExecutable(build_dir, 'assets_unittests', filter, shuffle_flags)
+
   RunEngineExecutable(build_dir, 'client_wrapper_glfw_unittests', filter, shuffle_flags)
 
   RunEngineExecutable(build_dir, 'client_wrapper_unittests', filter, shuffle_flags)
@@ -132,6 +134,14 @@ def RunEngineBenchmarks(build_dir, filter):
 
   RunEngineExecutable(build_dir, 'fml_benchmarks', filter)
 
+  RunEngineExecutable(build_dir, 'flow_benchmarks', filter)
+
+  RunEngineExecutable(build_dir, 'ui_benchmarks', filter)
+
+  RunEngineExecutable(build_dir, 'client_wrapper_benchmarks', filter)
+
+  RunEngineExecutable(build_dir, 'embedder_benchmarks', filter)
+
   if IsLinux():
     RunEngineExecutable(build_dir, 'txt_benchmarks', filter)
 
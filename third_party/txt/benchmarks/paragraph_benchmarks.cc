@@ -17,8 +17,10 @@
 #include <minikin/Layout.h>
 
 #include "flutter/fml/command_line.h"
+#include "flutter/fml/file.h"
 #include "flutter/fml/logging.h"
 #include "flutter/third_party/txt/tests/txt_test_utils.h"
+#include "minikin/FontCollection.h"
 #include "minikin/LayoutUtils.h"
 #include "third_party/benchmark/include/benchmark/benchmark_api.h"
 #include "third_party/icu/source/common/unicode/unistr.h"
@@ -31,6 +33,8 @@
 #include "txt/font_weight.h"
 #include "txt/paragraph.h"
 #include "txt/paragraph_builder_txt.h"
+#include "txt/paragraph_txt.h"
+#include "txt/shaped_run_cache.h"
 
 namespace txt {
 
@@ -100,6 +104,117 @@ static void BM_ParagraphLongLayout(benchmark::State& state) {
 }
 BENCHMARK(BM_ParagraphLongLayout);
 
+// Every thread lays out its own paragraph, sharing one font collection, like
+// the UI threads of several engines in a process would. Minikin's caches are
+// shared between them, so this measures how well layout scales with threads.
+static void BM_ParagraphLongLayoutMultiThreaded(benchmark::State& state) {
+  const char* text =
+      "This is a very long sentence to test if the text will properly wrap "
+      "around and go to the next line. Sometimes, short sentence. Longer "
+      "sentences are okay too because they are necessary. Very short. "
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+      "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+      "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+      "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate "
+      "velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint "
+      "occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
+      "mollit anim id est laborum.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  static std::shared_ptr<FontCollection> font_collection =
+      GetTestFontCollection();
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, font_collection);
+
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  while (state.KeepRunning()) {
+    paragraph->SetDirty();
+    paragraph->Layout(300);
+  }
+}
+BENCHMARK(BM_ParagraphLongLayoutMultiThreaded)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+// Lays out a paragraph the way the first frame of a process does, with none of
+// its words in minikin's caches. With |shaped_runs|, the words are read from
+// the file an earlier process wrote instead of being shaped.
+static void LayoutCold(benchmark::State& state, bool shaped_runs) {
+  const char* text =
+      "This is a very long sentence to test if the text will properly wrap "
+      "around and go to the next line. Sometimes, short sentence. Longer "
+      "sentences are okay too because they are necessary. Very short. "
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+      "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim "
+      "veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+      "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate "
+      "velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint "
+      "occaecat cupidatat non proident, sunt in culpa qui officia deserunt "
+      "mollit anim id est laborum.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+
+  fml::ScopedTemporaryDirectory temp_dir;
+  auto directory = std::make_shared<fml::UniqueFD>(fml::OpenDirectory(
+      temp_dir.path().c_str(), false, fml::FilePermission::kReadWrite));
+  if (shaped_runs) {
+    // The earlier process.
+    auto cache = ShapedRunCache::Open(directory, 1024 * 1024, false);
+    minikin::Layout::setLayoutStore(cache);
+    minikin::Layout::purgeCaches();
+    paragraph->Layout(300);
+    cache->Flush();
+  }
+
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    minikin::Layout::purgeCaches();
+    paragraph->SetDirty();
+    state.ResumeTiming();
+    // Mapping the file is part of the cost of a cold start.
+    minikin::Layout::setLayoutStore(
+        shaped_runs ? ShapedRunCache::Open(directory, 1024 * 1024, true)
+                    : nullptr);
+    paragraph->Layout(300);
+  }
+  minikin::Layout::setLayoutStore(nullptr);
+}
+
+static void BM_ParagraphColdLayout(benchmark::State& state) {
+  LayoutCold(state, false);
+}
+BENCHMARK(BM_ParagraphColdLayout);
+
+static void BM_ParagraphColdLayoutWithShapedRunCache(benchmark::State& state) {
+  LayoutCold(state, true);
+}
+BENCHMARK(BM_ParagraphColdLayoutWithShapedRunCache);
+
 static void BM_ParagraphJustifyLayout(benchmark::State& state) {
   const char* text =
       "This is a very long sentence to test if the text will properly wrap "
@@ -228,6 +343,122 @@ BENCHMARK(BM_ParagraphStylesBigO)
     ->Range(1 << 3, 1 << 12)
     ->Complexity(benchmark::oN);
 
+// Returns |length| code units of text resembling a log, made of short lines
+// that each wrap once or twice at a width of 300.
+static std::u16string BuildLogText(size_t length) {
+  std::u16string text;
+  for (size_t line = 0; text.size() < length; ++line) {
+    std::string log_line = "[" + std::to_string(line) +
+                           "] The quick brown fox jumps over the lazy dog, "
+                           "then naps in the afternoon sun.\n";
+    text.append(log_line.begin(), log_line.end());
+  }
+  text.resize(length);
+  return text;
+}
+
+static std::unique_ptr<ParagraphTxt> BuildLogParagraph(
+    const std::u16string& text) {
+  txt::ParagraphStyle paragraph_style;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+  builder.PushStyle(text_style);
+  builder.AddText(text);
+  builder.Pop();
+  return BuildParagraph(builder);
+}
+
+// Lays out the same text at alternating widths. Only the line breaks are
+// computed again.
+static void BM_ParagraphResizeLayout(benchmark::State& state) {
+  auto paragraph = BuildLogParagraph(BuildLogText(state.range(0)));
+  paragraph->Layout(300);
+  double width = 300;
+  while (state.KeepRunning()) {
+    width = width == 300 ? 400 : 300;
+    paragraph->Layout(width);
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_ParagraphResizeLayout)
+    ->RangeMultiplier(4)
+    ->Range(10000, 100000)
+    ->Complexity(benchmark::oN);
+
+// Same as BM_ParagraphResizeLayout, but measures the text again on every
+// layout for comparison.
+static void BM_ParagraphResizeFullLayout(benchmark::State& state) {
+  auto paragraph = BuildLogParagraph(BuildLogText(state.range(0)));
+  double width = 300;
+  while (state.KeepRunning()) {
+    width = width == 300 ? 400 : 300;
+    paragraph->SetDirty();
+    paragraph->Layout(width);
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_ParagraphResizeFullLayout)
+    ->RangeMultiplier(4)
+    ->Range(10000, 100000)
+    ->Complexity(benchmark::oN);
+
+// Appends a line to laid out text and lays it out again. Only the appended
+// line is measured and laid out.
+static void BM_ParagraphAppendLayout(benchmark::State& state) {
+  std::u16string text = BuildLogText(state.range(0));
+  std::string line = "One more line appended at the end of the log.\n";
+  std::u16string appended_text(line.begin(), line.end());
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    auto paragraph = BuildLogParagraph(text);
+    paragraph->Layout(300);
+    state.ResumeTiming();
+
+    paragraph->AppendText(appended_text, text_style);
+    paragraph->Layout(300);
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_ParagraphAppendLayout)
+    ->RangeMultiplier(4)
+    ->Range(10000, 100000)
+    ->Complexity(benchmark::oN);
+
+// Same as BM_ParagraphAppendLayout, but lays out all of the text again for
+// comparison.
+static void BM_ParagraphAppendFullLayout(benchmark::State& state) {
+  std::u16string text = BuildLogText(state.range(0));
+  std::string line = "One more line appended at the end of the log.\n";
+  std::u16string appended_text(line.begin(), line.end());
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.color = SK_ColorBLACK;
+
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    auto paragraph = BuildLogParagraph(text);
+    paragraph->Layout(300);
+    state.ResumeTiming();
+
+    paragraph->AppendText(appended_text, text_style);
+    paragraph->SetDirty();
+    paragraph->Layout(300);
+  }
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_ParagraphAppendFullLayout)
+    ->RangeMultiplier(4)
+    ->Range(10000, 100000)
+    ->Complexity(benchmark::oN);
+
 static void BM_ParagraphPaintSimple(benchmark::State& state) {
   const char* text = "Hello world! This is a simple sentence to test drawing.";
   auto icu_text = icu::UnicodeString::fromUTF8(text);
@@ -427,6 +658,59 @@ BENCHMARK(BM_ParagraphMinikinAddStyleRun)
     ->Range(1 << 7, 1 << 14)
     ->Complexity(benchmark::oN);
 
+// Itemizes text of Latin words, CJK words or both, separated by spaces, with a
+// collection that covers Latin text with its first family and CJK text with
+// its second.
+static void ItemizeText(benchmark::State& state, bool latin, bool cjk) {
+  std::vector<uint16_t> text;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    const bool use_cjk = cjk && (!latin || (i / 8) % 2 == 1);
+    if (i % 8 == 7) {
+      text.push_back(' ');
+    } else if (use_cjk) {
+      text.push_back(0x4E00 + i * 31 % 0x5000);
+    } else {
+      text.push_back('a' + i % 26);
+    }
+  }
+  minikin::FontStyle font(minikin::FontStyle::registerLanguageList("ja-JP"),
+                          0, 4, false);
+
+  auto collection =
+      GetTestFontCollection()->GetMinikinFontCollectionForFamilies(
+          {"Roboto", "Noto Sans CJK JP"}, "ja-JP");
+
+  while (state.KeepRunning()) {
+    std::vector<minikin::FontCollection::Run> runs;
+    collection->itemize(text.data(), text.size(), font, &runs);
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+static void BM_ParagraphMinikinItemizeLatin(benchmark::State& state) {
+  ItemizeText(state, true, false);
+}
+BENCHMARK(BM_ParagraphMinikinItemizeLatin)
+    ->RangeMultiplier(4)
+    ->Range(1 << 7, 1 << 14)
+    ->Complexity(benchmark::oN);
+
+static void BM_ParagraphMinikinItemizeCJK(benchmark::State& state) {
+  ItemizeText(state, false, true);
+}
+BENCHMARK(BM_ParagraphMinikinItemizeCJK)
+    ->RangeMultiplier(4)
+    ->Range(1 << 7, 1 << 14)
+    ->Complexity(benchmark::oN);
+
+static void BM_ParagraphMinikinItemizeMixed(benchmark::State& state) {
+  ItemizeText(state, true, true);
+}
+BENCHMARK(BM_ParagraphMinikinItemizeMixed)
+    ->RangeMultiplier(4)
+    ->Range(1 << 7, 1 << 14)
+    ->Complexity(benchmark::oN);
+
 static void BM_ParagraphSkTextBlobAlloc(benchmark::State& state) {
   SkFont font;
   font.setEdging(SkFont::Edging::kAntiAlias);
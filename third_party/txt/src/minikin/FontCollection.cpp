@@ -43,7 +43,7 @@ static inline T max(T a, T b) {
 const uint32_t EMOJI_STYLE_VS = 0xFE0F;
 const uint32_t TEXT_STYLE_VS = 0xFE0E;
 
-uint32_t FontCollection::sNextId = 0;
+std::atomic<uint32_t> FontCollection::sNextId = {0};
 
 // libtxt: return a locale string for a language list ID
 std::string GetFontLocale(uint32_t langListId) {
@@ -66,7 +66,6 @@ FontCollection::FontCollection(
 
 void FontCollection::init(
     const vector<std::shared_ptr<FontFamily>>& typefaces) {
-  std::scoped_lock _l(gMinikinLock);
   mId = sNextId++;
   vector<uint32_t> lastChar;
   size_t nTypefaces = typefaces.size();
@@ -310,29 +309,35 @@ const std::shared_ptr<FontFamily>& FontCollection::getFamilyForChar(
     return mFamilies[0];
   }
 
-  Range range = mRanges[ch >> kLogCharsPerPage];
-
-  if (vs != 0) {
-    range = {0, static_cast<uint16_t>(mFamilies.size())};
-  }
-
-#ifdef VERBOSE_DEBUG
-  ALOGD("querying range %zd:%zd\n", range.start, range.end);
-#endif
   int bestFamilyIndex = -1;
-  uint32_t bestScore = kUnsupportedFontScore;
-  for (size_t i = range.start; i < range.end; i++) {
-    const std::shared_ptr<FontFamily>& family =
-        vs == 0 ? mFamilies[mFamilyVec[i]] : mFamilies[i];
-    const uint32_t score = calcFamilyScore(ch, vs, variant, langListId, family);
-    if (score == kFirstFontScore) {
-      // If the first font family supports the given character or variation
-      // sequence, always use it.
-      return family;
+  if (vs == 0) {
+    // libtxt: without a variation selector, the families covering the code
+    // point only differ in scores that do not depend on it, so the best is
+    // the first one to cover it in their ranking for the page.
+    for (uint8_t index :
+         getRankedFamilies(ch >> kLogCharsPerPage, langListId, variant)) {
+      if (mFamilies[index]->getCoverage().get(ch)) {
+        return mFamilies[index];
+      }
     }
-    if (score > bestScore) {
-      bestScore = score;
-      bestFamilyIndex = i;
+  } else {
+#ifdef VERBOSE_DEBUG
+    ALOGD("querying all %zu families\n", mFamilies.size());
+#endif
+    uint32_t bestScore = kUnsupportedFontScore;
+    for (size_t i = 0; i < mFamilies.size(); i++) {
+      const std::shared_ptr<FontFamily>& family = mFamilies[i];
+      const uint32_t score =
+          calcFamilyScore(ch, vs, variant, langListId, family);
+      if (score == kFirstFontScore) {
+        // If the first font family supports the given character or variation
+        // sequence, always use it.
+        return family;
+      }
+      if (score > bestScore) {
+        bestScore = score;
+        bestFamilyIndex = i;
+      }
     }
   }
   if (bestFamilyIndex == -1) {
@@ -359,8 +364,44 @@ const std::shared_ptr<FontFamily>& FontCollection::getFamilyForChar(
     }
     return mFamilies[0];
   }
-  return vs == 0 ? mFamilies[mFamilyVec[bestFamilyIndex]]
-                 : mFamilies[bestFamilyIndex];
+  return mFamilies[bestFamilyIndex];
+}
+
+const std::vector<uint8_t>& FontCollection::getRankedFamilies(
+    uint32_t page,
+    uint32_t langListId,
+    int variant) const {
+  const uint64_t key = static_cast<uint64_t>(langListId) << 32 |
+                       static_cast<uint64_t>(variant & 0xFFFF) << 16 | page;
+  std::scoped_lock _l(mRankedFamiliesMutex);
+  auto found = mRankedFamilies.find(key);
+  if (found != mRankedFamilies.end()) {
+    return found->second;
+  }
+
+  // The scores calcFamilyScore gives the families for any code point they
+  // cover, when there is no variation selector.
+  const Range& range = mRanges[page];
+  std::vector<std::pair<uint32_t, uint8_t>> scores;
+  for (size_t i = range.start; i < range.end; i++) {
+    const std::shared_ptr<FontFamily>& family = mFamilies[mFamilyVec[i]];
+    uint32_t score = kFirstFontScore;
+    if (mFamilies[0] != family) {
+      score = 1 << 29 | calcLanguageMatchingScore(langListId, *family) << 1 |
+              calcVariantMatchingScore(variant, *family);
+    }
+    scores.emplace_back(score, mFamilyVec[i]);
+  }
+  // Ties are resolved to the first font, as in getFamilyForChar.
+  std::stable_sort(
+      scores.begin(), scores.end(),
+      [](const auto& a, const auto& b) { return a.first > b.first; });
+
+  std::vector<uint8_t>& ranked = mRankedFamilies[key];
+  for (const auto& score : scores) {
+    ranked.push_back(score.second);
+  }
+  return ranked;
 }
 
 const std::shared_ptr<FontFamily>& FontCollection::findFallbackFont(
@@ -369,11 +410,14 @@ const std::shared_ptr<FontFamily>& FontCollection::findFallbackFont(
     uint32_t langListId) const {
   std::string locale = GetFontLocale(langListId);
 
-  const auto it = mCachedFallbackFamilies.find(locale);
-  if (it != mCachedFallbackFamilies.end()) {
-    for (const auto& fallbackFamily : it->second) {
-      if (calcCoverageScore(ch, vs, fallbackFamily)) {
-        return fallbackFamily;
+  {
+    std::scoped_lock _l(mFallbackMutex);
+    const auto it = mCachedFallbackFamilies.find(locale);
+    if (it != mCachedFallbackFamilies.end()) {
+      for (const auto& fallbackFamily : it->second) {
+        if (calcCoverageScore(ch, vs, fallbackFamily)) {
+          return fallbackFamily;
+        }
       }
     }
   }
@@ -382,6 +426,7 @@ const std::shared_ptr<FontFamily>& FontCollection::findFallbackFont(
       mFallbackFontProvider->matchFallbackFont(ch, GetFontLocale(langListId));
 
   if (fallback) {
+    std::scoped_lock _l(mFallbackMutex);
     mCachedFallbackFamilies[locale].push_back(fallback);
   }
   return fallback;
@@ -428,8 +473,6 @@ bool FontCollection::hasVariationSelector(uint32_t baseCodepoint,
     return false;
   }
 
-  std::scoped_lock _l(gMinikinLock);
-
   // Currently mRanges can not be used here since it isn't aware of the
   // variation sequence.
   for (size_t i = 0; i < mVSFamilyVec.size(); i++) {
@@ -470,6 +513,21 @@ void FontCollection::itemize(const uint16_t* string,
   }
 
   const uint32_t kEndOfString = 0xFFFFFFFF;
+  const uint32_t kLatin1End = 0x100;
+
+  // libtxt: The family every Latin-1 code point it covers is given to, if any.
+  const FontFamily* latin1Family = nullptr;
+  if (mMaxChar > 0) {
+    const std::vector<uint8_t>& ranked =
+        getRankedFamilies(0, langListId, variant);
+    if (!ranked.empty()) {
+      latin1Family = mFamilies[ranked[0]].get();
+    }
+  }
+  // libtxt: The ranking of the families for the page of the last code point
+  // looked up.
+  const std::vector<uint8_t>* rankedFamilies = nullptr;
+  uint32_t rankedPage = 0;
 
   uint32_t nextCh = 0;
   uint32_t prevCh = 0;
@@ -478,6 +536,25 @@ void FontCollection::itemize(const uint16_t* string,
   U16_NEXT(string, readLength, string_size, nextCh);
 
   do {
+    // libtxt: Skip over the Latin-1 text the run's family covers, which stays
+    // in the run. The last code unit before other text is left for the loop
+    // below, in case a variation selector follows it.
+    if (lastFamily != nullptr && lastFamily == latin1Family) {
+      size_t end = nextUtf16Pos;
+      while (end + 1 < string_size && string[end] < kLatin1End &&
+             string[end + 1] < kLatin1End &&
+             lastFamily->getCoverage().get(string[end])) {
+        end++;
+      }
+      if (end > nextUtf16Pos) {
+        prevCh = string[end - 1];
+        run->end = end;
+        nextUtf16Pos = end;
+        readLength = end;
+        U16_NEXT(string, readLength, string_size, nextCh);
+      }
+    }
+
     const uint32_t ch = nextCh;
     const size_t utf16Pos = nextUtf16Pos;
     nextUtf16Pos = readLength;
@@ -497,6 +574,22 @@ void FontCollection::itemize(const uint16_t* string,
         // Always continue if the character is the soft hyphen or a variation
         // selector.
         shouldContinueRun = true;
+      } else if (ch < mMaxChar && !isVariationSelector(nextCh)) {
+        // libtxt: Continue if the run's family is still the one chosen for the
+        // code point, which only takes a look at the coverage of the families
+        // ranked for its page.
+        const uint32_t page = ch >> kLogCharsPerPage;
+        if (rankedFamilies == nullptr || page != rankedPage) {
+          rankedFamilies = &getRankedFamilies(page, langListId, variant);
+          rankedPage = page;
+        }
+        for (uint8_t index : *rankedFamilies) {
+          const FontFamily* family = mFamilies[index].get();
+          if (family->getCoverage().get(ch)) {
+            shouldContinueRun = family == lastFamily;
+            break;
+          }
+        }
       }
     }
 
@@ -573,4 +666,77 @@ uint32_t FontCollection::getId() const {
   return mId;
 }
 
+// 64-bit FNV-1a, which unlike std::hash is the same in every process.
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+template <typename T>
+static uint64_t hashValue(uint64_t hash, const T& value) {
+  return hashBytes(hash, &value, sizeof(value));
+}
+
+// libtxt: The fonts are identified by their 'head' table, whose checksum
+// covers the whole font file, along with the style and variation axes they
+// were added with.
+uint64_t FontCollection::getFingerprint() const {
+  std::call_once(mFingerprintFlag, [this]() {
+    const uint32_t headTag = MinikinFont::MakeTag('h', 'e', 'a', 'd');
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const std::shared_ptr<FontFamily>& family : mFamilies) {
+      const std::string languages = GetFontLocale(family->langId());
+      hash = hashBytes(hash, languages.data(), languages.size());
+      hash = hashValue(hash, family->variant());
+      hash = hashValue(hash, family->getNumFonts());
+      for (size_t i = 0; i < family->getNumFonts(); i++) {
+        const MinikinFont* font = family->getFont(i).get();
+        HbBlob head(getFontTable(font, headTag));
+        if (head.get() == nullptr || head.size() == 0) {
+          return;
+        }
+        hash = hashBytes(hash, head.get(), head.size());
+        const FontStyle style = family->getStyle(i);
+        hash = hashValue(hash, style.getWeight());
+        hash = hashValue(hash, style.getItalic());
+        for (const FontVariation& axis : font->GetAxes()) {
+          hash = hashValue(hash, axis.axisTag);
+          hash = hashValue(hash, axis.value);
+        }
+      }
+    }
+    // Zero means the fonts could not be identified.
+    mFingerprint = hash == 0 ? 1 : hash;
+  });
+  return mFingerprint;
+}
+
+int FontCollection::getFontIndex(const MinikinFont* font) const {
+  int index = 0;
+  for (const std::shared_ptr<FontFamily>& family : mFamilies) {
+    for (size_t i = 0; i < family->getNumFonts(); i++, index++) {
+      if (family->getFont(i).get() == font) {
+        return index;
+      }
+    }
+  }
+  return -1;
+}
+
+MinikinFont* FontCollection::getFontAt(int index) const {
+  if (index < 0) {
+    return nullptr;
+  }
+  for (const std::shared_ptr<FontFamily>& family : mFamilies) {
+    if (static_cast<size_t>(index) < family->getNumFonts()) {
+      return family->getFont(index).get();
+    }
+    index -= family->getNumFonts();
+  }
+  return nullptr;
+}
+
 }  // namespace minikin
@@ -17,8 +17,12 @@
 #ifndef MINIKIN_FONT_COLLECTION_H
 #define MINIKIN_FONT_COLLECTION_H
 
+#include <atomic>
+#include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -74,11 +78,28 @@ class FontCollection {
 
   uint32_t getId() const;
 
+  // libtxt extension: A hash of the fonts of this collection that is the same
+  // in every process that loads the same fonts, for keying data kept across
+  // processes. Zero if the fonts could not be identified.
+  uint64_t getFingerprint() const;
+
+  // libtxt extension: The position of |font| among the fonts of the families
+  // of this collection, or -1 if it is not one of them, like fallback fonts.
+  int getFontIndex(const MinikinFont* font) const;
+
+  // libtxt extension: The font at |index| among the fonts of the families of
+  // this collection, or nullptr if there is none.
+  MinikinFont* getFontAt(int index) const;
+
   void set_fallback_font_provider(std::unique_ptr<FallbackFontProvider> ffp) {
     mFallbackFontProvider = std::move(ffp);
   }
 
  private:
+  // libtxt extension: Itemizes the way itemize did before it used
+  // getRankedFamilies, to compare the two in tests.
+  friend class FontCollectionItemizeReference;
+
   static const int kLogCharsPerPage = 8;
   static const int kPageMask = (1 << kLogCharsPerPage) - 1;
 
@@ -101,6 +122,13 @@ class FontCollection {
                                                       uint32_t langListId,
                                                       int variant) const;
 
+  // libtxt extension: Returns the indices into mFamilies of the families that
+  // cover some code point of the page, in the order getFamilyForChar prefers
+  // them for a code point without a variation selector.
+  const std::vector<uint8_t>& getRankedFamilies(uint32_t page,
+                                                uint32_t langListId,
+                                                int variant) const;
+
   const std::shared_ptr<FontFamily>&
   findFallbackFont(uint32_t ch, uint32_t vs, uint32_t langListId) const;
 
@@ -122,11 +150,15 @@ class FontCollection {
                                            const FontFamily& fontFamily);
 
   // static for allocating unique id's
-  static uint32_t sNextId;
+  static std::atomic<uint32_t> sNextId;
 
   // unique id for this font collection (suitable for cache key)
   uint32_t mId;
 
+  // libtxt extension: Computed by getFingerprint the first time it is called.
+  mutable std::once_flag mFingerprintFlag;
+  mutable uint64_t mFingerprint = 0;
+
   // Highest UTF-32 code point that can be mapped
   uint32_t mMaxChar;
 
@@ -154,9 +186,18 @@ class FontCollection {
   std::unique_ptr<FallbackFontProvider> mFallbackFontProvider;
 
   // libtxt extension: Fallback fonts discovered after this font collection
-  // was constructed.
-  mutable std::map<std::string, std::vector<std::shared_ptr<FontFamily>>>
+  // was constructed. Guarded by |mFallbackMutex|. Callers keep references to
+  // the families, so they are kept in a deque, which never moves its elements.
+  mutable std::mutex mFallbackMutex;
+  mutable std::map<std::string, std::deque<std::shared_ptr<FontFamily>>>
       mCachedFallbackFamilies;
+
+  // libtxt extension: The families of each page ranked by getRankedFamilies,
+  // keyed by the page, language list and variant. Guarded by
+  // |mRankedFamiliesMutex|. Entries are never removed, so references to them
+  // stay valid.
+  mutable std::mutex mRankedFamiliesMutex;
+  mutable std::unordered_map<uint64_t, std::vector<uint8_t>> mRankedFamilies;
 };
 
 }  // namespace minikin
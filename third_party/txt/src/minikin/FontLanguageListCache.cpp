@@ -121,19 +121,29 @@ static std::vector<FontLanguage> parseLanguageList(const std::string& input) {
 // static
 uint32_t FontLanguageListCache::getId(const std::string& languages) {
   FontLanguageListCache* inst = FontLanguageListCache::getInstance();
-  std::unordered_map<std::string, uint32_t>::const_iterator it =
-      inst->mLanguageListLookupTable.find(languages);
-  if (it != inst->mLanguageListLookupTable.end()) {
-    return it->second;
+  {
+    std::scoped_lock _l(inst->mMutex);
+    std::unordered_map<std::string, uint32_t>::const_iterator it =
+        inst->mLanguageListLookupTable.find(languages);
+    if (it != inst->mLanguageListLookupTable.end()) {
+      return it->second;
+    }
   }
 
-  // Given language list is not in cache. Insert it and return newly assigned
-  // ID.
-  const uint32_t nextId = inst->mLanguageLists.size();
+  // Given language list is not in cache. Parse it without holding the lock,
+  // then insert it and return newly assigned ID.
   FontLanguages fontLanguages(parseLanguageList(languages));
   if (fontLanguages.empty()) {
     return kEmptyListId;
   }
+  std::scoped_lock _l(inst->mMutex);
+  std::unordered_map<std::string, uint32_t>::const_iterator it =
+      inst->mLanguageListLookupTable.find(languages);
+  if (it != inst->mLanguageListLookupTable.end()) {
+    // Another thread registered the same list in the meantime.
+    return it->second;
+  }
+  const uint32_t nextId = inst->mLanguageLists.size();
   inst->mLanguageLists.push_back(std::move(fontLanguages));
   inst->mLanguageListLookupTable.insert(std::make_pair(languages, nextId));
   return nextId;
@@ -142,6 +152,7 @@ uint32_t FontLanguageListCache::getId(const std::string& languages) {
 // static
 const FontLanguages& FontLanguageListCache::getById(uint32_t id) {
   FontLanguageListCache* inst = FontLanguageListCache::getInstance();
+  std::scoped_lock _l(inst->mMutex);
   LOG_ALWAYS_FATAL_IF(id >= inst->mLanguageLists.size(),
                       "Lookup by unknown language list ID.");
   return inst->mLanguageLists[id];
@@ -149,17 +160,16 @@ const FontLanguages& FontLanguageListCache::getById(uint32_t id) {
 
 // static
 FontLanguageListCache* FontLanguageListCache::getInstance() {
-  assertMinikinLocked();
-  static FontLanguageListCache* instance = nullptr;
-  if (instance == nullptr) {
-    instance = new FontLanguageListCache();
+  static FontLanguageListCache* instance = [] {
+    FontLanguageListCache* cache = new FontLanguageListCache();
 
     // Insert an empty language list for mapping default language list to
     // kEmptyListId. The default language list has only one FontLanguage and it
     // is the unsupported language.
-    instance->mLanguageLists.push_back(FontLanguages());
-    instance->mLanguageListLookupTable.insert(std::make_pair("", kEmptyListId));
-  }
+    cache->mLanguageLists.push_back(FontLanguages());
+    cache->mLanguageListLookupTable.insert(std::make_pair("", kEmptyListId));
+    return cache;
+  }();
   return instance;
 }
 
@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>  // for debugging
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -48,15 +49,26 @@ const int kDirection_Mask = 0x1;
 struct LayoutContext {
   MinikinPaint paint;
   FontStyle style;
-  std::vector<hb_font_t*> hbFonts;  // parallel to mFaces
+  // Sub-fonts of the shared cached fonts, private to this layout call, that
+  // read their advances from |paint|. Parallel to mFaces.
+  std::vector<hb_font_t*> hbFonts;
+
+  LayoutContext() = default;
+
+  ~LayoutContext();
 
   void clearHbFonts() {
     for (size_t i = 0; i < hbFonts.size(); i++) {
-      hb_font_set_funcs(hbFonts[i], nullptr, nullptr, nullptr);
       hb_font_destroy(hbFonts[i]);
     }
     hbFonts.clear();
   }
+
+  // Returns a buffer that is only used by this layout call.
+  hb_buffer_t* getHbBuffer();
+
+ private:
+  hb_buffer_t* hbBuffer = nullptr;
 };
 
 // Layout cache datatypes
@@ -108,6 +120,19 @@ class LayoutCacheKey {
                         collection);
   }
 
+  // libtxt: Writes the key of the word in a LayoutStore, which identifies the
+  // fonts and languages by their contents rather than by IDs that only hold
+  // in this process. Returns false if the fonts could not be identified.
+  bool serialize(const FontCollection& collection, std::string* out) const;
+
+  // libtxt: The number of characters of the word.
+  size_t getCount() const { return mCount; }
+
+  // libtxt: The bytes taken up by the key once its text has been copied.
+  size_t getMemoryUsage() const {
+    return sizeof(*this) + mNchars * sizeof(uint16_t);
+  }
+
  private:
   const uint16_t* mChars;
   size_t mNchars;
@@ -129,62 +154,188 @@ class LayoutCacheKey {
   android::hash_t computeHash() const;
 };
 
-class LayoutCache : private android::OnEntryRemoved<LayoutCacheKey, Layout*> {
+// The cache is split into shards picked by the key hash, each with its own
+// lock, so that threads laying out text at the same time rarely contend. Words
+// are laid out without holding any lock.
+class LayoutCache {
  public:
-  LayoutCache() : mCache(kMaxEntries) {
-    mCache.setOnEntryRemovedListener(this);
+  void clear() {
+    for (Shard& shard : mShards) {
+      shard.clear();
+    }
   }
 
-  void clear() { mCache.clear(); }
+  // The returned layout is shared with the cache and other threads, and stays
+  // valid even if it is evicted while in use.
+  std::shared_ptr<Layout> get(
+      LayoutCacheKey& key,
+      LayoutContext* ctx,
+      const std::shared_ptr<FontCollection>& collection) {
+    return mShards[key.hash() % kShardCount].get(key, ctx, collection,
+                                                 getStore().get());
+  }
 
-  Layout* get(LayoutCacheKey& key,
-              LayoutContext* ctx,
-              const std::shared_ptr<FontCollection>& collection) {
-    Layout* layout = mCache.get(key);
-    if (layout == NULL) {
-      key.copyText();
-      layout = new Layout();
-      key.doLayout(layout, ctx, collection);
-      mCache.put(key, layout);
-    }
-    return layout;
+  void setStore(std::shared_ptr<LayoutStore> store) {
+    std::scoped_lock _l(mStoreMutex);
+    mStore = std::move(store);
   }
 
  private:
-  // callback for OnEntryRemoved
-  void operator()(LayoutCacheKey& key, Layout*& value) {
-    key.freeText();
-    delete value;
-  }
+  class Shard : private android::OnEntryRemoved<LayoutCacheKey,
+                                                std::shared_ptr<Layout>> {
+   public:
+    Shard() : mCache(decltype(mCache)::kUnlimitedCapacity) {
+      mCache.setOnEntryRemovedListener(this);
+    }
+
+    void clear() {
+      std::scoped_lock _l(mMutex);
+      mCache.clear();
+      mBytes = 0;
+    }
+
+    std::shared_ptr<Layout> get(
+        LayoutCacheKey& key,
+        LayoutContext* ctx,
+        const std::shared_ptr<FontCollection>& collection,
+        LayoutStore* store) {
+      {
+        std::scoped_lock _l(mMutex);
+        std::shared_ptr<Layout> layout = mCache.get(key);
+        if (layout != nullptr) {
+          return layout;
+        }
+      }
 
-  android::LruCache<LayoutCacheKey, Layout*> mCache;
+      std::shared_ptr<Layout> layout = load(key, *collection, store);
+      if (layout == nullptr) {
+        layout = std::make_shared<Layout>();
+        key.doLayout(layout.get(), ctx, collection);
+        save(key, *collection, *layout, store);
+      }
 
-  // static const size_t kMaxEntries = LruCache<LayoutCacheKey,
-  // Layout*>::kUnlimitedCapacity;
+      key.copyText();
+      std::scoped_lock _l(mMutex);
+      if (!mCache.put(key, layout)) {
+        // Another thread laid out the same word in the meantime.
+        key.freeText();
+        return layout;
+      }
+      mBytes += getMemoryUsage(key, *layout);
+      while (mBytes > kMaxBytes / kShardCount && mCache.size() > 1) {
+        mCache.removeOldest();
+      }
+      return layout;
+    }
 
-  // TODO: eviction based on memory footprint; for now, we just use a constant
-  // number of strings
-  static const size_t kMaxEntries = 5000;
+   private:
+    // callback for OnEntryRemoved
+    void operator()(LayoutCacheKey& key,
+                    std::shared_ptr<Layout>& value) override {
+      mBytes -= getMemoryUsage(key, *value);
+      key.freeText();
+      value.reset();
+    }
+
+    std::mutex mMutex;
+    android::LruCache<LayoutCacheKey, std::shared_ptr<Layout>> mCache;
+    // The bytes taken up by the entries of |mCache|.
+    size_t mBytes = 0;
+  };
+
+  static const size_t kShardCount = 16;
+
+  // The most bytes the keys and layouts of the cached words take up, about as
+  // much as the 5000 words of a few characters the cache used to hold.
+  static const size_t kMaxBytes = 2 * 1024 * 1024;
+
+  Shard mShards[kShardCount];
+
+  std::mutex mStoreMutex;
+  std::shared_ptr<LayoutStore> mStore;
+
+  std::shared_ptr<LayoutStore> getStore() {
+    std::scoped_lock _l(mStoreMutex);
+    return mStore;
+  }
+
+  static size_t getMemoryUsage(const LayoutCacheKey& key,
+                               const Layout& layout) {
+    return key.getMemoryUsage() + sizeof(layout) +
+           layout.mGlyphs.capacity() * sizeof(LayoutGlyph) +
+           layout.mAdvances.capacity() * sizeof(float) +
+           layout.mFaces.capacity() * sizeof(FakedFont);
+  }
+
+  // Returns the layout of the word read from |store|, or nullptr if it has no
+  // valid record of it.
+  static std::shared_ptr<Layout> load(const LayoutCacheKey& key,
+                                      const FontCollection& collection,
+                                      LayoutStore* store);
+
+  // Offers the layout of the word to |store|, unless it uses fonts that are
+  // not part of |collection|.
+  static void save(const LayoutCacheKey& key,
+                   const FontCollection& collection,
+                   const Layout& layout,
+                   LayoutStore* store);
 };
 
 class LayoutEngine {
  public:
   LayoutEngine() {
     unicodeFunctions = hb_unicode_funcs_create(hb_icu_get_unicode_funcs());
-    hbBuffer = hb_buffer_create();
-    hb_buffer_set_unicode_funcs(hbBuffer, unicodeFunctions);
   }
 
-  hb_buffer_t* hbBuffer;
   hb_unicode_funcs_t* unicodeFunctions;
   LayoutCache layoutCache;
 
+  // HarfBuzz buffers can't be shared between threads, so each layout call
+  // borrows one from this pool and returns it when done.
+  hb_buffer_t* acquireHbBuffer() {
+    {
+      std::scoped_lock _l(mHbBuffersMutex);
+      if (!mHbBuffers.empty()) {
+        hb_buffer_t* buffer = mHbBuffers.back();
+        mHbBuffers.pop_back();
+        return buffer;
+      }
+    }
+    hb_buffer_t* buffer = hb_buffer_create();
+    hb_buffer_set_unicode_funcs(buffer, unicodeFunctions);
+    return buffer;
+  }
+
+  void releaseHbBuffer(hb_buffer_t* buffer) {
+    hb_buffer_clear_contents(buffer);
+    std::scoped_lock _l(mHbBuffersMutex);
+    mHbBuffers.push_back(buffer);
+  }
+
   static LayoutEngine& getInstance() {
     static LayoutEngine* instance = new LayoutEngine();
     return *instance;
   }
+
+ private:
+  std::mutex mHbBuffersMutex;
+  std::vector<hb_buffer_t*> mHbBuffers;
 };
 
+LayoutContext::~LayoutContext() {
+  clearHbFonts();
+  if (hbBuffer != nullptr) {
+    LayoutEngine::getInstance().releaseHbBuffer(hbBuffer);
+  }
+}
+
+hb_buffer_t* LayoutContext::getHbBuffer() {
+  if (hbBuffer == nullptr) {
+    hbBuffer = LayoutEngine::getInstance().acquireHbBuffer();
+  }
+  return hbBuffer;
+}
+
 bool LayoutCacheKey::operator==(const LayoutCacheKey& other) const {
   return mId == other.mId && mStart == other.mStart && mCount == other.mCount &&
          mStyle == other.mStyle && mSize == other.mSize &&
@@ -215,6 +366,184 @@ android::hash_t hash_type(const LayoutCacheKey& key) {
   return key.hash();
 }
 
+// libtxt: Keys and records of a LayoutStore are written in the byte order of
+// the device, since they are only read back on it.
+template <typename T>
+static void appendValue(std::string* out, const T& value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+namespace {
+
+// Reads the values written by appendValue, failing once it runs out of data.
+class RecordReader {
+ public:
+  RecordReader(const uint8_t* data, size_t size) : mData(data), mSize(size) {}
+
+  template <typename T>
+  bool read(T* value) {
+    if (mSize - mOffset < sizeof(T)) {
+      return false;
+    }
+    memcpy(value, mData + mOffset, sizeof(T));
+    mOffset += sizeof(T);
+    return true;
+  }
+
+  template <typename T>
+  bool readVector(std::vector<T>* values) {
+    uint32_t count = 0;
+    if (!read(&count) || (mSize - mOffset) / sizeof(T) < count) {
+      return false;
+    }
+    values->resize(count);
+    for (T& value : *values) {
+      read(&value);
+    }
+    return true;
+  }
+
+  bool atEnd() const { return mOffset == mSize; }
+
+ private:
+  const uint8_t* mData;
+  size_t mSize;
+  size_t mOffset = 0;
+};
+
+// The fields of a glyph written to a record.
+struct StoredGlyph {
+  uint32_t font_ix;
+  uint32_t glyph_id;
+  float x;
+  float y;
+  uint32_t cluster;
+};
+
+// The fields of a face written to a record.
+struct StoredFace {
+  int32_t font_index;
+  uint32_t fakery;
+};
+
+const uint32_t kStoredFakeBold = 1 << 0;
+const uint32_t kStoredFakeItalic = 1 << 1;
+
+}  // namespace
+
+// The version of the keys and records, for stores that outlive the layout
+// code that wrote them.
+static const uint32_t kStoreFormatVersion = 1;
+
+bool LayoutCacheKey::serialize(const FontCollection& collection,
+                               std::string* out) const {
+  const uint64_t fingerprint = collection.getFingerprint();
+  if (fingerprint == 0) {
+    return false;
+  }
+  appendValue(out, kStoreFormatVersion);
+  appendValue(out, fingerprint);
+  const FontLanguages& languages =
+      FontLanguageListCache::getById(mStyle.getLanguageListId());
+  for (size_t i = 0; i < languages.size(); i++) {
+    out->append(languages[i].getString());
+    out->push_back(',');
+  }
+  out->push_back('\0');
+  appendValue(out, static_cast<int32_t>(mStyle.getVariant()));
+  appendValue(out, static_cast<int32_t>(mStyle.getWeight()));
+  appendValue(out, static_cast<uint8_t>(mStyle.getItalic()));
+  appendValue(out, mSize);
+  appendValue(out, mScaleX);
+  appendValue(out, mSkewX);
+  appendValue(out, mLetterSpacing);
+  appendValue(out, mPaintFlags);
+  appendValue(out, mHyphenEdit.getHyphen());
+  appendValue(out, static_cast<uint8_t>(mIsRtl));
+  appendValue(out, static_cast<uint32_t>(mStart));
+  appendValue(out, static_cast<uint32_t>(mCount));
+  out->append(reinterpret_cast<const char*>(mChars),
+              mNchars * sizeof(uint16_t));
+  return true;
+}
+
+std::shared_ptr<Layout> LayoutCache::load(const LayoutCacheKey& key,
+                                          const FontCollection& collection,
+                                          LayoutStore* store) {
+  std::string storeKey;
+  if (store == nullptr || !key.serialize(collection, &storeKey)) {
+    return nullptr;
+  }
+  std::shared_ptr<Layout> layout;
+  store->load(storeKey, [&](const uint8_t* data, size_t size) {
+    auto result = std::make_shared<Layout>();
+    RecordReader reader(data, size);
+    std::vector<StoredFace> faces;
+    std::vector<StoredGlyph> glyphs;
+    if (!reader.read(&result->mAdvance) || !reader.read(&result->mBounds) ||
+        !reader.readVector(&result->mAdvances) || !reader.readVector(&faces) ||
+        !reader.readVector(&glyphs) || !reader.atEnd() ||
+        result->mAdvances.size() != key.getCount()) {
+      return;
+    }
+    for (const StoredFace& face : faces) {
+      MinikinFont* font = collection.getFontAt(face.font_index);
+      if (font == nullptr) {
+        return;
+      }
+      result->mFaces.push_back(
+          {font, FontFakery((face.fakery & kStoredFakeBold) != 0,
+                            (face.fakery & kStoredFakeItalic) != 0)});
+    }
+    for (const StoredGlyph& glyph : glyphs) {
+      if (glyph.font_ix >= faces.size() || glyph.cluster >= key.getCount()) {
+        return;
+      }
+      result->mGlyphs.push_back({static_cast<int>(glyph.font_ix),
+                                 glyph.glyph_id, glyph.x, glyph.y,
+                                 glyph.cluster});
+    }
+    layout = std::move(result);
+  });
+  return layout;
+}
+
+void LayoutCache::save(const LayoutCacheKey& key,
+                       const FontCollection& collection,
+                       const Layout& layout,
+                       LayoutStore* store) {
+  std::string storeKey;
+  if (store == nullptr || !key.serialize(collection, &storeKey)) {
+    return;
+  }
+  std::string record;
+  appendValue(&record, layout.mAdvance);
+  appendValue(&record, layout.mBounds);
+  appendValue(&record, static_cast<uint32_t>(layout.mAdvances.size()));
+  for (float advance : layout.mAdvances) {
+    appendValue(&record, advance);
+  }
+  appendValue(&record, static_cast<uint32_t>(layout.mFaces.size()));
+  for (FakedFont face : layout.mFaces) {
+    const int fontIndex = collection.getFontIndex(face.font);
+    if (fontIndex < 0) {
+      return;
+    }
+    const StoredFace stored = {
+        fontIndex, (face.fakery.isFakeBold() ? kStoredFakeBold : 0) |
+                       (face.fakery.isFakeItalic() ? kStoredFakeItalic : 0)};
+    appendValue(&record, stored);
+  }
+  appendValue(&record, static_cast<uint32_t>(layout.mGlyphs.size()));
+  for (const LayoutGlyph& glyph : layout.mGlyphs) {
+    const StoredGlyph stored = {static_cast<uint32_t>(glyph.font_ix),
+                                glyph.glyph_id, glyph.x, glyph.y,
+                                glyph.cluster};
+    appendValue(&record, stored);
+  }
+  store->store(std::move(storeKey), std::move(record));
+}
+
 void MinikinRect::join(const MinikinRect& r) {
   if (isEmpty()) {
     set(r);
@@ -254,34 +583,31 @@ static hb_bool_t harfbuzzGetGlyphHorizontalOrigin(hb_font_t* /* hbFont */,
   return true;
 }
 
-hb_font_funcs_t* getHbFontFuncs(bool forColorBitmapFont) {
-  assertMinikinLocked();
-
-  static hb_font_funcs_t* hbFuncs = nullptr;
-  static hb_font_funcs_t* hbFuncsForColorBitmap = nullptr;
-
-  hb_font_funcs_t** funcs =
-      forColorBitmapFont ? &hbFuncs : &hbFuncsForColorBitmap;
-  if (*funcs == nullptr) {
-    *funcs = hb_font_funcs_create();
-    if (forColorBitmapFont) {
-      // Don't override the h_advance function since we use HarfBuzz's
-      // implementation for emoji for performance reasons. Note that it is
-      // technically possible for a TrueType font to have outline and embedded
-      // bitmap at the same time. We ignore modified advances of hinted outline
-      // glyphs in that case.
-    } else {
-      // Override the h_advance function since we can't use HarfBuzz's
-      // implemenation. It may return the wrong value if the font uses hinting
-      // aggressively.
-      hb_font_funcs_set_glyph_h_advance_func(
-          *funcs, harfbuzzGetGlyphHorizontalAdvance, 0, 0);
-    }
-    hb_font_funcs_set_glyph_h_origin_func(
-        *funcs, harfbuzzGetGlyphHorizontalOrigin, 0, 0);
-    hb_font_funcs_make_immutable(*funcs);
+static hb_font_funcs_t* createHbFontFuncs(bool forColorBitmapFont) {
+  hb_font_funcs_t* funcs = hb_font_funcs_create();
+  if (forColorBitmapFont) {
+    // Don't override the h_advance function since we use HarfBuzz's
+    // implementation for emoji for performance reasons. Note that it is
+    // technically possible for a TrueType font to have outline and embedded
+    // bitmap at the same time. We ignore modified advances of hinted outline
+    // glyphs in that case.
+  } else {
+    // Override the h_advance function since we can't use HarfBuzz's
+    // implemenation. It may return the wrong value if the font uses hinting
+    // aggressively.
+    hb_font_funcs_set_glyph_h_advance_func(
+        funcs, harfbuzzGetGlyphHorizontalAdvance, 0, 0);
   }
-  return *funcs;
+  hb_font_funcs_set_glyph_h_origin_func(funcs, harfbuzzGetGlyphHorizontalOrigin,
+                                        0, 0);
+  hb_font_funcs_make_immutable(funcs);
+  return funcs;
+}
+
+hb_font_funcs_t* getHbFontFuncs(bool forColorBitmapFont) {
+  static hb_font_funcs_t* hbFuncs = createHbFontFuncs(false);
+  static hb_font_funcs_t* hbFuncsForColorBitmap = createHbFontFuncs(true);
+  return forColorBitmapFont ? hbFuncsForColorBitmap : hbFuncs;
 }
 
 static bool isColorBitmapFont(hb_font_t* font) {
@@ -316,7 +642,11 @@ int Layout::findFace(const FakedFont& face, LayoutContext* ctx) {
   // Note: ctx == NULL means we're copying from the cache, no need to create
   // corresponding hb_font object.
   if (ctx != NULL) {
-    hb_font_t* font = getHbFontLocked(face.font);
+    // The cached font is shared with other threads, so the paint dependent
+    // functions are installed on a private sub-font.
+    hb_font_t* parent = getHbFont(face.font);
+    hb_font_t* font = hb_font_create_sub_font(parent);
+    hb_font_destroy(parent);
     hb_font_set_funcs(font, getHbFontFuncs(isColorBitmapFont(font)),
                       &ctx->paint, 0);
     ctx->hbFonts.push_back(font);
@@ -325,10 +655,7 @@ int Layout::findFace(const FakedFont& face, LayoutContext* ctx) {
 }
 
 static hb_script_t codePointToScript(hb_codepoint_t codepoint) {
-  static hb_unicode_funcs_t* u = 0;
-  if (!u) {
-    u = LayoutEngine::getInstance().unicodeFunctions;
-  }
+  static hb_unicode_funcs_t* u = LayoutEngine::getInstance().unicodeFunctions;
   return hb_unicode_script(u, codepoint);
 }
 
@@ -588,8 +915,6 @@ void Layout::doLayout(const uint16_t* buf,
                       const FontStyle& style,
                       const MinikinPaint& paint,
                       const std::shared_ptr<FontCollection>& collection) {
-  std::scoped_lock _l(gMinikinLock);
-
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
@@ -612,8 +937,6 @@ float Layout::measureText(const uint16_t* buf,
                           const MinikinPaint& paint,
                           const std::shared_ptr<FontCollection>& collection,
                           float* advances) {
-  std::scoped_lock _l(gMinikinLock);
-
   LayoutContext ctx;
   ctx.style = style;
   ctx.paint = paint;
@@ -720,9 +1043,9 @@ float Layout::doLayoutWord(const uint16_t* buf,
     }
     advance = layoutForWord.getAdvance();
   } else {
-    Layout* layoutForWord = cache.get(key, ctx, collection);
+    std::shared_ptr<Layout> layoutForWord = cache.get(key, ctx, collection);
     if (layout) {
-      layout->appendLayout(layoutForWord, bufStart, wordSpacing);
+      layout->appendLayout(layoutForWord.get(), bufStart, wordSpacing);
     }
     if (advances) {
       layoutForWord->getAdvances(advances);
@@ -748,7 +1071,7 @@ static void addFeatures(const std::string& str,
   const char* end = start + str.size();
 
   while (start < end) {
-    static hb_feature_t feature;
+    hb_feature_t feature;
     const char* p = strchr(start, ',');
     if (!p)
       p = end;
@@ -919,7 +1242,7 @@ void Layout::doLayoutRun(const uint16_t* buf,
                          bool isRtl,
                          LayoutContext* ctx,
                          const std::shared_ptr<FontCollection>& collection) {
-  hb_buffer_t* buffer = LayoutEngine::getInstance().hbBuffer;
+  hb_buffer_t* buffer = ctx->getHbBuffer();
   std::vector<FontCollection::Run> items;
   collection->itemize(buf + start, count, ctx->style, &items);
 
@@ -1193,10 +1516,14 @@ void Layout::getBounds(MinikinRect* bounds) const {
 }
 
 void Layout::purgeCaches() {
-  std::scoped_lock _l(gMinikinLock);
   LayoutCache& layoutCache = LayoutEngine::getInstance().layoutCache;
   layoutCache.clear();
-  purgeHbFontCacheLocked();
+  purgeHbFontCache();
+}
+
+void Layout::setLayoutStore(std::shared_ptr<LayoutStore> store) {
+  LayoutCache& layoutCache = LayoutEngine::getInstance().layoutCache;
+  layoutCache.setStore(std::move(store));
 }
 
 }  // namespace minikin
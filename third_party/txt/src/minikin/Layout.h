@@ -19,7 +19,10 @@
 
 #include <hb.h>
 
+#include <functional>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include <minikin/FontCollection.h>
@@ -57,6 +60,23 @@ enum {
   kBidi_Mask = 0x7
 };
 
+// libtxt extension: Shaped words kept outside of the layout cache, like in a
+// file written by an earlier process. The cache looks words up here before
+// shaping them, and offers the words it shapes. Both keys and records are
+// opaque to the store. It may be called from any thread.
+class LayoutStore {
+ public:
+  using RecordReader = std::function<void(const uint8_t* data, size_t size)>;
+
+  virtual ~LayoutStore() = default;
+
+  // Calls |reader| with the record stored for |key| and returns true, or
+  // returns false if there is none. The record is only valid during the call.
+  virtual bool load(std::string_view key, const RecordReader& reader) = 0;
+
+  virtual void store(std::string key, std::string record) = 0;
+};
+
 // Lifecycle and threading assumptions for Layout:
 // The object is assumed to be owned by a single thread; multiple threads
 // may not mutate it at the same time.
@@ -117,8 +137,13 @@ class Layout {
   // Purge all caches, useful in low memory conditions
   static void purgeCaches();
 
+  // libtxt extension: Sets the store the layout cache consults, or none if
+  // |store| is null. The store is not purged with the caches.
+  static void setLayoutStore(std::shared_ptr<LayoutStore> store);
+
  private:
   friend class LayoutCacheKey;
+  friend class LayoutCache;
 
   // Find a face in the mFaces vector, or create a new entry
   int findFace(const FakedFont& face, LayoutContext* ctx);
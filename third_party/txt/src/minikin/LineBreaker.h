@@ -145,6 +145,18 @@ class LineBreaker {
                     size_t end,
                     bool isRtl);
 
+  // libtxt: Add ability to recompute breaks without measuring the text again.
+  // The widths of the run must already be in the width buffer, for example
+  // copied there from an earlier addStyleRun call on the same text. Unlike
+  // passing a nullptr paint to addStyleRun, the breaks are weighted exactly as
+  // if the run had just been measured.
+  void addMeasuredStyleRun(MinikinPaint* paint,
+                           const std::shared_ptr<FontCollection>& typeface,
+                           FontStyle style,
+                           size_t start,
+                           size_t end,
+                           bool isRtl);
+
   void addReplacement(size_t start, size_t end, float width);
 
   size_t computeBreaks();
@@ -190,6 +202,13 @@ class LineBreaker {
 
   float currentLineWidth() const;
 
+  void addRunCandidates(MinikinPaint* paint,
+                        const std::shared_ptr<FontCollection>& typeface,
+                        FontStyle style,
+                        size_t start,
+                        size_t end,
+                        bool isRtl);
+
   void addWordBreak(size_t offset,
                     ParaWidth preBreak,
                     ParaWidth postBreak,
@@ -19,8 +19,6 @@
 #ifndef MINIKIN_INTERNAL_H
 #define MINIKIN_INTERNAL_H
 
-#include <mutex>
-
 #include <hb.h>
 
 #include <minikin/MinikinFont.h>
@@ -28,13 +26,9 @@
 namespace minikin {
 
 // All external Minikin interfaces are designed to be thread-safe.
-// Presently, that's implemented by through a global lock, and having
-// all external interfaces take that lock.
-
-extern std::recursive_mutex gMinikinLock;
-
-// Aborts if gMinikinLock is not acquired. Do nothing on the release build.
-void assertMinikinLocked();
+// There is no global lock: the shared caches (layouts, HarfBuzz fonts and
+// language lists) each synchronize their own state, and everything else is
+// either immutable once constructed or local to a layout call.
 
 hb_blob_t* getFontTable(const MinikinFont* minikinFont, uint32_t tag);
 
@@ -243,142 +243,237 @@ void ParagraphTxt::SetText(std::vector<uint16_t> text, StyledRuns runs) {
   runs_ = std::move(runs);
 }
 
+void ParagraphTxt::AppendText(const std::u16string& text,
+                              const TextStyle& style) {
+  if (text.empty())
+    return;
+  size_t start = text_.size();
+  text_.insert(text_.end(), text.begin(), text.end());
+  if (runs_.size() == 0 || !runs_.GetRun(runs_.size() - 1).style.equals(style))
+    runs_.StartRun(runs_.AddStyle(style), start);
+  runs_.EndRunIfNeeded(text_.size());
+
+  // Only the blocks that the text was appended to have to be measured again.
+  while (measured_block_count_ > 0 &&
+         blocks_[measured_block_count_ - 1].end >= start) {
+    measured_block_count_--;
+  }
+  needs_layout_ = true;
+}
+
 void ParagraphTxt::SetInlinePlaceholders(
     std::vector<PlaceholderRun> inline_placeholders,
     std::unordered_set<size_t> obj_replacement_char_indexes) {
-  needs_layout_ = true;
+  SetDirty(true);
   inline_placeholders_ = std::move(inline_placeholders);
   obj_replacement_char_indexes_ = std::move(obj_replacement_char_indexes);
 }
 
-bool ParagraphTxt::ComputeLineBreaks() {
-  line_metrics_.clear();
-  line_widths_.clear();
+bool ParagraphTxt::ComputeLineBreaks(size_t* reused_line_count) {
+  // The leading blocks that were already broken at this width keep the lines
+  // of the previous layout. Ellipsizing depends on the lines that follow, so
+  // ellipsized paragraphs always lay out all of their lines again.
+  size_t block_index = 0;
+  size_t line_count = 0;
   max_intrinsic_width_ = 0;
-
-  std::vector<size_t> newline_positions;
-  // Discover and add all hard breaks.
-  for (size_t i = 0; i < text_.size(); ++i) {
-    ULineBreak ulb = static_cast<ULineBreak>(
-        u_getIntPropertyValue(text_[i], UCHAR_LINE_BREAK));
-    if (ulb == U_LB_LINE_FEED || ulb == U_LB_MANDATORY_BREAK)
-      newline_positions.push_back(i);
+  if (paragraph_style_.ellipsis.empty()) {
+    while (block_index < measured_block_count_ &&
+           blocks_[block_index].break_width == width_) {
+      max_intrinsic_width_ =
+          std::max(max_intrinsic_width_, blocks_[block_index].width);
+      line_count += blocks_[block_index].lines.size();
+      block_index++;
+    }
   }
-  // Break at the end of the paragraph.
-  newline_positions.push_back(text_.size());
+  *reused_line_count = line_count;
+  line_metrics_.resize(line_count);
+  line_widths_.resize(line_count);
+  blocks_.resize(measured_block_count_);
 
-  // Calculate and add any breaks due to a line being too long.
+  size_t block_start = 0;
   size_t run_index = 0;
   size_t inline_placeholder_index = 0;
-  for (size_t newline_index = 0; newline_index < newline_positions.size();
-       ++newline_index) {
-    size_t block_start =
-        (newline_index > 0) ? newline_positions[newline_index - 1] + 1 : 0;
-    size_t block_end = newline_positions[newline_index];
-    size_t block_size = block_end - block_start;
-
-    if (block_size == 0) {
-      line_metrics_.emplace_back(block_start, block_end, block_end,
-                                 block_end + 1, true);
-      line_widths_.push_back(0);
-      continue;
-    }
+  if (block_index > 0) {
+    const Block& previous = blocks_[block_index - 1];
+    block_start = previous.end + 1;
+    run_index = previous.next_run_index;
+    inline_placeholder_index = previous.next_inline_placeholder_index;
+  }
 
-    // Setup breaker. We wait to set the line width in order to account for the
-    // widths of the inline placeholders, which are calcualted in the loop over
-    // the runs.
-    breaker_.setLineWidths(0.0f, 0, width_);
-    breaker_.setJustified(paragraph_style_.text_align == TextAlign::justify);
-    breaker_.setStrategy(paragraph_style_.break_strategy);
-    breaker_.resize(block_size);
-    memcpy(breaker_.buffer(), text_.data() + block_start,
-           block_size * sizeof(text_[0]));
-    breaker_.setText();
-
-    // Add the runs that include this line to the LineBreaker.
-    double block_total_width = 0;
-    while (run_index < runs_.size()) {
-      StyledRuns::Run run = runs_.GetRun(run_index);
-      if (run.start >= block_end)
-        break;
-      if (run.end < block_start) {
-        run_index++;
-        continue;
+  // Blocks end at a hard break or at the end of the paragraph.
+  while (true) {
+    bool measured = block_index < measured_block_count_;
+    if (!measured) {
+      size_t block_end = block_start;
+      while (block_end < text_.size()) {
+        ULineBreak ulb = static_cast<ULineBreak>(
+            u_getIntPropertyValue(text_[block_end], UCHAR_LINE_BREAK));
+        if (ulb == U_LB_LINE_FEED || ulb == U_LB_MANDATORY_BREAK)
+          break;
+        block_end++;
       }
+      Block block;
+      block.start = block_start;
+      block.end = block_end;
+      block.run_index = run_index;
+      block.inline_placeholder_index = inline_placeholder_index;
+      blocks_.push_back(std::move(block));
+    }
 
-      minikin::FontStyle font;
-      minikin::MinikinPaint paint;
-      GetFontAndMinikinPaint(run.style, &font, &paint);
-      std::shared_ptr<minikin::FontCollection> collection =
-          GetMinikinFontCollectionForStyle(run.style);
-      if (collection == nullptr) {
-        FML_LOG(INFO) << "Could not find font collection for families \""
-                      << (run.style.font_families.empty()
-                              ? ""
-                              : run.style.font_families[0])
-                      << "\".";
+    Block& block = blocks_[block_index];
+    if (!measured || block.break_width != width_) {
+      if (!ComputeBlockLineBreaks(&block, measured)) {
+        measured_block_count_ = 0;
         return false;
       }
-      size_t run_start = std::max(run.start, block_start) - block_start;
-      size_t run_end = std::min(run.end, block_end) - block_start;
-      bool isRtl = (paragraph_style_.text_direction == TextDirection::rtl);
-
-      // Check if the run is an object replacement character-only run. We should
-      // leave space for inline placeholder and break around it if appropriate.
-      if (run.end - run.start == 1 &&
-          obj_replacement_char_indexes_.count(run.start) != 0 &&
-          text_[run.start] == objReplacementChar &&
-          inline_placeholder_index < inline_placeholders_.size()) {
-        // Is a inline placeholder run.
-        PlaceholderRun placeholder_run =
-            inline_placeholders_[inline_placeholder_index];
-        block_total_width += placeholder_run.width;
-
-        // Inject custom width into minikin breaker. (Uses LibTxt-minikin
-        // patch).
-        breaker_.setCustomCharWidth(run_start, placeholder_run.width);
-
-        // Called with nullptr as paint in order to use the custom widths passed
-        // above.
-        breaker_.addStyleRun(nullptr, collection, font, run_start, run_end,
-                             isRtl);
-        inline_placeholder_index++;
-      } else {
-        // Is a regular text run.
-        double run_width = breaker_.addStyleRun(&paint, collection, font,
-                                                run_start, run_end, isRtl);
-        block_total_width += run_width;
-      }
+    }
+    max_intrinsic_width_ = std::max(max_intrinsic_width_, block.width);
+    line_metrics_.insert(line_metrics_.end(), block.lines.begin(),
+                         block.lines.end());
+    line_widths_.insert(line_widths_.end(), block.line_widths.begin(),
+                        block.line_widths.end());
+
+    run_index = block.next_run_index;
+    inline_placeholder_index = block.next_inline_placeholder_index;
+    block_index++;
+    if (block.end >= text_.size())
+      break;
+    block_start = block.end + 1;
+  }
+  measured_block_count_ = blocks_.size();
 
-      if (run.end > block_end)
-        break;
+  return true;
+}
+
+bool ParagraphTxt::ComputeBlockLineBreaks(Block* block, bool measured) {
+  size_t block_start = block->start;
+  size_t block_end = block->end;
+  size_t block_size = block_end - block_start;
+
+  block->break_width = width_;
+  block->lines.clear();
+  block->line_widths.clear();
+
+  if (block_size == 0) {
+    block->next_run_index = block->run_index;
+    block->next_inline_placeholder_index = block->inline_placeholder_index;
+    block->width = 0;
+    block->lines.emplace_back(block_start, block_end, block_end, block_end + 1,
+                              true);
+    block->line_widths.push_back(0);
+    return true;
+  }
+
+  // Setup breaker. We wait to set the line width in order to account for the
+  // widths of the inline placeholders, which are calcualted in the loop over
+  // the runs.
+  breaker_.setLineWidths(0.0f, 0, width_);
+  breaker_.setJustified(paragraph_style_.text_align == TextAlign::justify);
+  breaker_.setStrategy(paragraph_style_.break_strategy);
+  breaker_.resize(block_size);
+  memcpy(breaker_.buffer(), text_.data() + block_start,
+         block_size * sizeof(text_[0]));
+  breaker_.setText();
+  if (measured) {
+    memcpy(breaker_.charWidths(), block->char_widths.data(),
+           block_size * sizeof(block->char_widths[0]));
+  }
+
+  // Add the runs that include this line to the LineBreaker.
+  size_t run_index = block->run_index;
+  size_t inline_placeholder_index = block->inline_placeholder_index;
+  double block_total_width = 0;
+  while (run_index < runs_.size()) {
+    StyledRuns::Run run = runs_.GetRun(run_index);
+    if (run.start >= block_end)
+      break;
+    if (run.end < block_start) {
       run_index++;
+      continue;
     }
-    max_intrinsic_width_ = std::max(max_intrinsic_width_, block_total_width);
-
-    size_t breaks_count = breaker_.computeBreaks();
-    const int* breaks = breaker_.getBreaks();
-    for (size_t i = 0; i < breaks_count; ++i) {
-      size_t break_start = (i > 0) ? breaks[i - 1] : 0;
-      size_t line_start = break_start + block_start;
-      size_t line_end = breaks[i] + block_start;
-      bool hard_break = i == breaks_count - 1;
-      size_t line_end_including_newline =
-          (hard_break && line_end < text_.size()) ? line_end + 1 : line_end;
-      size_t line_end_excluding_whitespace = line_end;
-      while (
-          line_end_excluding_whitespace > line_start &&
-          minikin::isLineEndSpace(text_[line_end_excluding_whitespace - 1])) {
-        line_end_excluding_whitespace--;
-      }
-      line_metrics_.emplace_back(line_start, line_end,
-                                 line_end_excluding_whitespace,
-                                 line_end_including_newline, hard_break);
-      line_widths_.push_back(breaker_.getWidths()[i]);
+
+    minikin::FontStyle font;
+    minikin::MinikinPaint paint;
+    GetFontAndMinikinPaint(run.style, &font, &paint);
+    std::shared_ptr<minikin::FontCollection> collection =
+        GetMinikinFontCollectionForStyle(run.style);
+    if (collection == nullptr) {
+      FML_LOG(INFO) << "Could not find font collection for families \""
+                    << (run.style.font_families.empty()
+                            ? ""
+                            : run.style.font_families[0])
+                    << "\".";
+      return false;
+    }
+    size_t run_start = std::max(run.start, block_start) - block_start;
+    size_t run_end = std::min(run.end, block_end) - block_start;
+    bool isRtl = (paragraph_style_.text_direction == TextDirection::rtl);
+
+    // Check if the run is an object replacement character-only run. We should
+    // leave space for inline placeholder and break around it if appropriate.
+    if (run.end - run.start == 1 &&
+        obj_replacement_char_indexes_.count(run.start) != 0 &&
+        text_[run.start] == objReplacementChar &&
+        inline_placeholder_index < inline_placeholders_.size()) {
+      // Is a inline placeholder run.
+      PlaceholderRun placeholder_run =
+          inline_placeholders_[inline_placeholder_index];
+      block_total_width += placeholder_run.width;
+
+      // Inject custom width into minikin breaker. (Uses LibTxt-minikin
+      // patch).
+      breaker_.setCustomCharWidth(run_start, placeholder_run.width);
+
+      // Called with nullptr as paint in order to use the custom widths passed
+      // above.
+      breaker_.addStyleRun(nullptr, collection, font, run_start, run_end,
+                           isRtl);
+      inline_placeholder_index++;
+    } else if (measured) {
+      // Is a regular text run whose widths were copied into the breaker
+      // above.
+      breaker_.addMeasuredStyleRun(&paint, collection, font, run_start,
+                                   run_end, isRtl);
+    } else {
+      // Is a regular text run.
+      double run_width = breaker_.addStyleRun(&paint, collection, font,
+                                              run_start, run_end, isRtl);
+      block_total_width += run_width;
     }
 
-    breaker_.finish();
+    if (run.end > block_end)
+      break;
+    run_index++;
   }
+  block->next_run_index = run_index;
+  block->next_inline_placeholder_index = inline_placeholder_index;
+  if (!measured) {
+    block->width = block_total_width;
+    block->char_widths.assign(breaker_.charWidths(),
+                              breaker_.charWidths() + block_size);
+  }
+
+  size_t breaks_count = breaker_.computeBreaks();
+  const int* breaks = breaker_.getBreaks();
+  for (size_t i = 0; i < breaks_count; ++i) {
+    size_t break_start = (i > 0) ? breaks[i - 1] : 0;
+    size_t line_start = break_start + block_start;
+    size_t line_end = breaks[i] + block_start;
+    bool hard_break = i == breaks_count - 1;
+    size_t line_end_including_newline =
+        (hard_break && line_end < text_.size()) ? line_end + 1 : line_end;
+    size_t line_end_excluding_whitespace = line_end;
+    while (line_end_excluding_whitespace > line_start &&
+           minikin::isLineEndSpace(text_[line_end_excluding_whitespace - 1])) {
+      line_end_excluding_whitespace--;
+    }
+    block->lines.emplace_back(line_start, line_end,
+                              line_end_excluding_whitespace,
+                              line_end_including_newline, hard_break);
+    block->line_widths.push_back(breaker_.getWidths()[i]);
+  }
+
+  breaker_.finish();
 
   return true;
 }
@@ -668,20 +763,53 @@ void ParagraphTxt::Layout(double width) {
 
   needs_layout_ = false;
 
-  records_.clear();
-  glyph_lines_.clear();
-  code_unit_runs_.clear();
-  inline_placeholder_code_unit_runs_.clear();
-  max_right_ = FLT_MIN;
-  min_left_ = FLT_MAX;
-  final_line_count_ = 0;
+  size_t reused_line_count = 0;
+  bool did_compute_line_breaks = ComputeLineBreaks(&reused_line_count);
 
-  if (!ComputeLineBreaks())
+  // Keep the layout of the lines that did not change. The containers below
+  // are filled in line order, so the lines to lay out again are at the end.
+  size_t first_line = 0;
+  if (did_compute_line_breaks && !line_layout_states_.empty()) {
+    first_line = std::min(reused_line_count, line_layout_states_.size() - 1);
+  }
+  while (!records_.empty() && records_.back().line() >= first_line) {
+    records_.pop_back();
+  }
+  while (glyph_lines_.size() > first_line) {
+    glyph_lines_.pop_back();
+  }
+  while (!code_unit_runs_.empty() &&
+         code_unit_runs_.back().line_number >= first_line) {
+    code_unit_runs_.pop_back();
+  }
+  while (!inline_placeholder_code_unit_runs_.empty() &&
+         inline_placeholder_code_unit_runs_.back().line_number >= first_line) {
+    inline_placeholder_code_unit_runs_.pop_back();
+  }
+  LineLayoutState state = {};
+  if (first_line > 0) {
+    state = line_layout_states_[first_line];
+  } else {
+    state.max_right = FLT_MIN;
+    state.min_left = FLT_MAX;
+  }
+  line_layout_states_.resize(first_line);
+  for (size_t i = first_line; i < reused_line_count; ++i) {
+    line_metrics_[i].run_metrics.clear();
+  }
+  max_right_ = state.max_right;
+  min_left_ = state.min_left;
+  final_line_count_ = first_line;
+  size_t first_new_code_unit_run = code_unit_runs_.size();
+
+  if (!did_compute_line_breaks)
     return;
 
   std::vector<BidiRun> bidi_runs;
-  if (!ComputeBidiRuns(&bidi_runs))
+  if (!ComputeBidiRuns(&bidi_runs)) {
+    line_layout_states_.clear();
     return;
+  }
 
   SkFont font;
   font.setEdging(SkFont::Edging::kAntiAlias);
@@ -690,9 +818,9 @@ void ParagraphTxt::Layout(double width) {
 
   minikin::Layout layout;
   SkTextBlobBuilder builder;
-  double y_offset = 0;
-  double prev_max_descent = 0;
-  double max_word_width = 0;
+  double y_offset = state.y_offset;
+  double prev_max_descent = state.prev_max_descent;
+  double max_word_width = state.max_word_width;
 
   // Compute strut minimums according to paragraph_style_.
   ComputeStrut(&strut_, font);
@@ -702,8 +830,12 @@ void ParagraphTxt::Layout(double width) {
       std::min(paragraph_style_.max_lines, line_metrics_.size());
   did_exceed_max_lines_ = (line_metrics_.size() > paragraph_style_.max_lines);
 
-  size_t placeholder_run_index = 0;
-  for (size_t line_number = 0; line_number < line_limit; ++line_number) {
+  size_t placeholder_run_index = state.placeholder_run_index;
+  for (size_t line_number = first_line; line_number < line_limit;
+       ++line_number) {
+    line_layout_states_.push_back({y_offset, prev_max_descent, max_word_width,
+                                   max_right_, min_left_,
+                                   placeholder_run_index});
     LineMetrics& line_metrics = line_metrics_[line_number];
 
     // Break the line into words if justification should be applied.
@@ -1158,6 +1290,8 @@ void ParagraphTxt::Layout(double width) {
       records_.emplace_back(std::move(paint_record));
     }
   }  // for each line_number
+  line_layout_states_.push_back({y_offset, prev_max_descent, max_word_width,
+                                 max_right_, min_left_, placeholder_run_index});
 
   if (paragraph_style_.max_lines == 1 ||
       (paragraph_style_.unlimited_lines() && paragraph_style_.ellipsized())) {
@@ -1166,7 +1300,8 @@ void ParagraphTxt::Layout(double width) {
     min_intrinsic_width_ = std::min(max_word_width, max_intrinsic_width_);
   }
 
-  std::sort(code_unit_runs_.begin(), code_unit_runs_.end(),
+  std::sort(code_unit_runs_.begin() + first_new_code_unit_run,
+            code_unit_runs_.end(),
             [](const CodeUnitRun& a, const CodeUnitRun& b) {
               return a.code_units.start < b.code_units.start;
             });
@@ -1320,7 +1455,7 @@ double ParagraphTxt::GetLongestLine() {
 }
 
 void ParagraphTxt::SetParagraphStyle(const ParagraphStyle& style) {
-  needs_layout_ = true;
+  SetDirty(true);
   paragraph_style_ = style;
 }
 
@@ -1982,6 +2117,10 @@ bool ParagraphTxt::DidExceedMaxLines() {
 
 void ParagraphTxt::SetDirty(bool dirty) {
   needs_layout_ = dirty;
+  if (dirty) {
+    measured_block_count_ = 0;
+    line_layout_states_.clear();
+  }
 }
 
 std::vector<LineMetrics>& ParagraphTxt::GetLineMetrics() {
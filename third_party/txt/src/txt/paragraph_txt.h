@@ -71,8 +71,18 @@ class ParagraphTxt : public Paragraph {
   // number of characters. However, this is not significant for reasonably sized
   // paragraphs. It is currently recommended to break up very long paragraphs
   // (10k+ characters) to ensure speedy layout.
+  //
+  // The measurements of the text are kept across calls. Laying out again with
+  // only a new width does not measure the text again, and after AppendText()
+  // only the text following the last hard break before the appended text is
+  // measured and laid out again.
   virtual void Layout(double width) override;
 
+  // Appends |text| in |style| to the end of the paragraph. Use this rather
+  // than building a new paragraph to grow long text, such as a log, so that
+  // the next Layout() can reuse the existing lines.
+  void AppendText(const std::u16string& text, const TextStyle& style);
+
   virtual void Paint(SkCanvas* canvas, double x, double y) override;
 
   // Getter for paragraph_style_.
@@ -123,7 +133,8 @@ class ParagraphTxt : public Paragraph {
 
   // Sets the needs_layout_ to dirty. When Layout() is called, a new Layout will
   // be performed when this is set to true. Can also be used to prevent a new
-  // Layout from being calculated by setting to false.
+  // Layout from being calculated by setting to false. Setting it to true also
+  // discards the measurements kept from previous layouts.
   void SetDirty(bool dirty = true);
 
  private:
@@ -162,6 +173,8 @@ class ParagraphTxt : public Paragraph {
   FRIEND_TEST(ParagraphTest, FontFeaturesParagraph);
   FRIEND_TEST(ParagraphTest, GetGlyphPositionAtCoordinateSegfault);
   FRIEND_TEST(ParagraphTest, KhmerLineBreaker);
+  FRIEND_TEST(ParagraphTest, RelayoutWithNewWidthKeepsMeasurements);
+  FRIEND_TEST(ParagraphTest, AppendTextRelayoutMatchesFullLayout);
 
   // Starting data to layout.
   std::vector<uint16_t> text_;
@@ -323,6 +336,45 @@ class ParagraphTxt : public Paragraph {
 
   bool needs_layout_ = true;
 
+  // The text between two hard breaks. Measuring the text shapes all of it, so
+  // the measurements are kept across calls to Layout() until the text of the
+  // block changes.
+  struct Block {
+    size_t start;
+    size_t end;
+    // The first styled run and inline placeholder of this block and of the
+    // next one.
+    size_t run_index;
+    size_t inline_placeholder_index;
+    size_t next_run_index;
+    size_t next_inline_placeholder_index;
+    // The widths of each code unit, as measured by the line breaker.
+    std::vector<float> char_widths;
+    double width;
+    // The lines of the block when broken at |break_width|.
+    double break_width;
+    std::vector<LineMetrics> lines;
+    std::vector<double> line_widths;
+  };
+
+  std::vector<Block> blocks_;
+  // The number of leading blocks whose measurements match text_.
+  size_t measured_block_count_ = 0;
+
+  // The state of the line loop in Layout() before each laid out line, and
+  // after the last one. Allows resuming the layout at the first line that
+  // changed.
+  struct LineLayoutState {
+    double y_offset;
+    double prev_max_descent;
+    double max_word_width;
+    double max_right;
+    double min_left;
+    size_t placeholder_run_index;
+  };
+
+  std::vector<LineLayoutState> line_layout_states_;
+
   struct WaveCoordinates {
     double x_start;
     double y_start;
@@ -345,8 +397,15 @@ class ParagraphTxt : public Paragraph {
       std::vector<PlaceholderRun> inline_placeholders,
       std::unordered_set<size_t> obj_replacement_char_indexes);
 
-  // Break the text into lines.
-  bool ComputeLineBreaks();
+  // Break the text into lines. Lines of the previous layout that are still
+  // valid are kept in line_metrics_, and their count is stored in
+  // |reused_line_count|.
+  bool ComputeLineBreaks(size_t* reused_line_count);
+
+  // Breaks |block| into lines at the current width. Its text is measured
+  // first unless |measured| is true, in which case the widths kept in the
+  // block are used.
+  bool ComputeBlockLineBreaks(Block* block, bool measured);
 
   // Break the text into runs based on LTR/RTL text direction.
   bool ComputeBidiRuns(std::vector<BidiRun>* result);
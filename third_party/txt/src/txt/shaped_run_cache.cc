@@ -0,0 +1,315 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "txt/shaped_run_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "flutter/fml/file.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+namespace txt {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x53525543;  // "SRUC"
+constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entry_count;
+  uint32_t reserved;
+};
+
+// 64-bit FNV-1a, which unlike std::hash is the same in every process.
+uint64_t HashKey(std::string_view key) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (char c : key) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+}  // namespace
+
+struct ShapedRunCache::IndexEntry {
+  uint64_t hash;
+  // Offsets are from the start of the file.
+  uint32_t key_offset;
+  uint32_t key_size;
+  uint32_t record_offset;
+  uint32_t record_size;
+};
+
+// static
+std::shared_ptr<ShapedRunCache> ShapedRunCache::Open(
+    std::shared_ptr<fml::UniqueFD> directory,
+    size_t max_bytes,
+    bool read_only,
+    FlushScheduler flush_scheduler) {
+  TRACE_EVENT0("flutter", "ShapedRunCache::Open");
+  if (!directory || !directory->is_valid()) {
+    return nullptr;
+  }
+  std::shared_ptr<ShapedRunCache> cache(new ShapedRunCache(
+      std::move(directory), max_bytes, read_only, std::move(flush_scheduler)));
+  auto mapping = cache->MapFile();
+  std::scoped_lock lock(cache->mutex_);
+  cache->SetMappingLocked(std::move(mapping));
+  return cache;
+}
+
+ShapedRunCache::ShapedRunCache(std::shared_ptr<fml::UniqueFD> directory,
+                               size_t max_bytes,
+                               bool read_only,
+                               FlushScheduler flush_scheduler)
+    : directory_(std::move(directory)),
+      max_bytes_(max_bytes),
+      read_only_(read_only),
+      flush_scheduler_(std::move(flush_scheduler)) {}
+
+ShapedRunCache::~ShapedRunCache() = default;
+
+std::shared_ptr<fml::FileMapping> ShapedRunCache::MapFile() const {
+  auto file = fml::OpenFile(*directory_, kFileName, false,
+                            fml::FilePermission::kRead);
+  if (!file.is_valid()) {
+    return nullptr;
+  }
+  auto mapping = std::make_shared<fml::FileMapping>(file);
+  const uint8_t* data = mapping->GetMapping();
+  const size_t size = mapping->GetSize();
+  if (data == nullptr || size < sizeof(FileHeader)) {
+    return nullptr;
+  }
+
+  FileHeader header;
+  memcpy(&header, data, sizeof(header));
+  if (header.magic != kMagic || header.version != kVersion ||
+      (size - sizeof(header)) / sizeof(IndexEntry) < header.entry_count) {
+    FML_DLOG(WARNING) << "Ignoring invalid shaped run cache.";
+    return nullptr;
+  }
+  const auto* index =
+      reinterpret_cast<const IndexEntry*>(data + sizeof(header));
+  for (size_t i = 0; i < header.entry_count; i++) {
+    const IndexEntry& entry = index[i];
+    if ((i > 0 && index[i - 1].hash > entry.hash) ||
+        entry.key_offset > size || size - entry.key_offset < entry.key_size ||
+        entry.record_offset > size ||
+        size - entry.record_offset < entry.record_size) {
+      FML_DLOG(WARNING) << "Ignoring invalid shaped run cache.";
+      return nullptr;
+    }
+  }
+  return mapping;
+}
+
+void ShapedRunCache::SetMappingLocked(
+    std::shared_ptr<fml::FileMapping> mapping) {
+  mapping_ = std::move(mapping);
+  index_ = nullptr;
+  index_size_ = 0;
+  if (mapping_) {
+    FileHeader header;
+    memcpy(&header, mapping_->GetMapping(), sizeof(header));
+    index_ = reinterpret_cast<const IndexEntry*>(mapping_->GetMapping() +
+                                                 sizeof(header));
+    index_size_ = header.entry_count;
+  }
+  used_.assign(index_size_, false);
+}
+
+const ShapedRunCache::IndexEntry* ShapedRunCache::FindLocked(
+    std::string_view key) const {
+  const uint64_t hash = HashKey(key);
+  const IndexEntry* end = index_ + index_size_;
+  const IndexEntry* entry = std::lower_bound(
+      index_, end, hash,
+      [](const IndexEntry& entry, uint64_t hash) { return entry.hash < hash; });
+  const uint8_t* data = mapping_ ? mapping_->GetMapping() : nullptr;
+  for (; entry != end && entry->hash == hash; entry++) {
+    if (std::string_view(reinterpret_cast<const char*>(data) +
+                             entry->key_offset,
+                         entry->key_size) == key) {
+      return entry;
+    }
+  }
+  return nullptr;
+}
+
+// |minikin::LayoutStore|
+bool ShapedRunCache::load(std::string_view key, const RecordReader& reader) {
+  // The reader deserializes the record, which must not hold up the other
+  // threads laying out text. Pending records are copied and the mapping of
+  // the file is kept alive so that a flush can replace it meanwhile.
+  std::string pending_record;
+  std::shared_ptr<fml::FileMapping> mapping;
+  const uint8_t* record = nullptr;
+  size_t record_size = 0;
+  {
+    std::scoped_lock lock(mutex_);
+    auto found = pending_.find(std::string(key));
+    if (found != pending_.end()) {
+      pending_record = found->second;
+      record = reinterpret_cast<const uint8_t*>(pending_record.data());
+      record_size = pending_record.size();
+    } else if (const IndexEntry* entry = FindLocked(key)) {
+      used_[entry - index_] = true;
+      mapping = mapping_;
+      record = mapping->GetMapping() + entry->record_offset;
+      record_size = entry->record_size;
+    } else {
+      return false;
+    }
+  }
+  reader(record, record_size);
+  return true;
+}
+
+// |minikin::LayoutStore|
+void ShapedRunCache::store(std::string key, std::string record) {
+  if (read_only_) {
+    return;
+  }
+  bool schedule_flush = false;
+  {
+    std::scoped_lock lock(mutex_);
+    // A word of the file that could not be read is shaped again, but storing
+    // it would only write the same key a second time.
+    if (FindLocked(key)) {
+      return;
+    }
+    const size_t bytes = sizeof(IndexEntry) + key.size() + record.size();
+    if (pending_bytes_ + bytes > max_bytes_) {
+      return;
+    }
+    if (!pending_.emplace(std::move(key), std::move(record)).second) {
+      return;
+    }
+    pending_bytes_ += bytes;
+    schedule_flush = !flush_scheduled_ && flush_scheduler_;
+    flush_scheduled_ = true;
+  }
+  if (schedule_flush && !flush_scheduler_()) {
+    std::scoped_lock lock(mutex_);
+    flush_scheduled_ = false;
+  }
+}
+
+size_t ShapedRunCache::GetEntryCount() const {
+  std::scoped_lock lock(mutex_);
+  return index_size_ + pending_.size();
+}
+
+bool ShapedRunCache::HasPendingWrites() const {
+  std::scoped_lock lock(mutex_);
+  return !pending_.empty();
+}
+
+bool ShapedRunCache::Flush() {
+  TRACE_EVENT0("flutter", "ShapedRunCache::Flush");
+  if (read_only_) {
+    return false;
+  }
+  std::scoped_lock flush_lock(flush_mutex_);
+
+  struct Entry {
+    uint64_t hash;
+    std::string_view key;
+    std::string_view record;
+  };
+  std::shared_ptr<fml::FileMapping> mapping;
+  std::vector<std::pair<std::string, std::string>> written;
+  std::vector<Entry> used_entries;
+  std::vector<Entry> unused_entries;
+  {
+    std::scoped_lock lock(mutex_);
+    flush_scheduled_ = false;
+    if (pending_.empty()) {
+      return true;
+    }
+    mapping = mapping_;
+    const char* data =
+        mapping ? reinterpret_cast<const char*>(mapping->GetMapping())
+                : nullptr;
+    for (size_t i = 0; i < index_size_; i++) {
+      const IndexEntry& entry = index_[i];
+      Entry kept = {
+          entry.hash,
+          std::string_view(data + entry.key_offset, entry.key_size),
+          std::string_view(data + entry.record_offset, entry.record_size)};
+      (used_[i] ? used_entries : unused_entries).push_back(kept);
+    }
+    written.assign(pending_.begin(), pending_.end());
+  }
+
+  // The words stored since the last flush and those of the file that were
+  // used come first, the others fill up what is left of the budget.
+  std::vector<Entry> entries;
+  size_t bytes = sizeof(FileHeader);
+  auto add = [&](const Entry& entry) {
+    const size_t entry_bytes =
+        sizeof(IndexEntry) + entry.key.size() + entry.record.size();
+    if (bytes + entry_bytes <= max_bytes_) {
+      entries.push_back(entry);
+      bytes += entry_bytes;
+    }
+  };
+  for (const auto& word : written) {
+    add({HashKey(word.first), word.first, word.second});
+  }
+  for (const Entry& entry : used_entries) {
+    add(entry);
+  }
+  for (const Entry& entry : unused_entries) {
+    add(entry);
+  }
+  std::stable_sort(
+      entries.begin(), entries.end(),
+      [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+
+  std::vector<uint8_t> file(bytes);
+  const FileHeader header = {kMagic, kVersion,
+                             static_cast<uint32_t>(entries.size()), 0};
+  memcpy(file.data(), &header, sizeof(header));
+  size_t offset = sizeof(header) + entries.size() * sizeof(IndexEntry);
+  for (size_t i = 0; i < entries.size(); i++) {
+    const Entry& entry = entries[i];
+    IndexEntry index_entry = {entry.hash, static_cast<uint32_t>(offset),
+                              static_cast<uint32_t>(entry.key.size()), 0,
+                              static_cast<uint32_t>(entry.record.size())};
+    memcpy(file.data() + offset, entry.key.data(), entry.key.size());
+    offset += entry.key.size();
+    index_entry.record_offset = static_cast<uint32_t>(offset);
+    memcpy(file.data() + offset, entry.record.data(), entry.record.size());
+    offset += entry.record.size();
+    memcpy(file.data() + sizeof(header) + i * sizeof(IndexEntry),
+           &index_entry, sizeof(index_entry));
+  }
+
+  const bool success = fml::WriteAtomically(*directory_, kFileName,
+                                            fml::DataMapping(std::move(file)));
+  auto new_mapping = success ? MapFile() : nullptr;
+
+  std::scoped_lock lock(mutex_);
+  if (new_mapping) {
+    SetMappingLocked(std::move(new_mapping));
+  }
+  // Words that did not fit are dropped rather than written again.
+  for (const auto& word : written) {
+    auto found = pending_.find(word.first);
+    if (found != pending_.end()) {
+      pending_bytes_ -= sizeof(IndexEntry) + found->first.size() +
+                        found->second.size();
+      pending_.erase(found);
+    }
+  }
+  return success;
+}
+
+}  // namespace txt
@@ -0,0 +1,109 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TXT_SHAPED_RUN_CACHE_H_
+#define TXT_SHAPED_RUN_CACHE_H_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "flutter/fml/unique_fd.h"
+#include "minikin/Layout.h"
+
+namespace txt {
+
+// Words shaped by minikin, kept in a file so that later processes do not have
+// to shape them again.
+//
+// The file is an index of the keys sorted by their hash, followed by the keys
+// and records. Opening the cache maps the file, so a lookup only touches the
+// index entries and the record of the word. Words stored afterwards are kept
+// in memory until |Flush| rewrites the file with them. If the file would grow
+// past its budget, the words this process did not use are dropped first.
+//
+// The cache is thread-safe. |Flush| does file IO and is meant to be called on
+// worker threads.
+class ShapedRunCache : public minikin::LayoutStore {
+ public:
+  static constexpr char kFileName[] = "shaped_runs.cache";
+
+  // Called when a word is stored while none are waiting to be flushed. It
+  // should arrange for |Flush| to be called, or return false if it cannot,
+  // in which case it is called again for the next word.
+  using FlushScheduler = std::function<bool()>;
+
+  // Opens the cache in |directory|, whose file need not exist yet. Returns
+  // null if the directory is not valid. The file and the words waiting to be
+  // written to it each take up at most |max_bytes|.
+  static std::shared_ptr<ShapedRunCache> Open(
+      std::shared_ptr<fml::UniqueFD> directory,
+      size_t max_bytes,
+      bool read_only,
+      FlushScheduler flush_scheduler = nullptr);
+
+  ~ShapedRunCache() override;
+
+  // |minikin::LayoutStore|
+  bool load(std::string_view key, const RecordReader& reader) override;
+
+  // |minikin::LayoutStore|
+  void store(std::string key, std::string record) override;
+
+  // The number of words in the file and waiting to be written to it.
+  size_t GetEntryCount() const;
+
+  // Whether there are stored words that |Flush| would write.
+  bool HasPendingWrites() const;
+
+  // Rewrites the file with the words stored since the last flush.
+  bool Flush();
+
+ private:
+  struct IndexEntry;
+
+  const std::shared_ptr<fml::UniqueFD> directory_;
+  const size_t max_bytes_;
+  const bool read_only_;
+  const FlushScheduler flush_scheduler_;
+
+  // Serializes |Flush|. Always acquired before |mutex_|.
+  std::mutex flush_mutex_;
+
+  mutable std::mutex mutex_;
+  std::shared_ptr<fml::FileMapping> mapping_;
+  const IndexEntry* index_ = nullptr;
+  size_t index_size_ = 0;
+  // Whether each word of the file was looked up by this process.
+  std::vector<bool> used_;
+  // Words that have not been written to the file yet.
+  std::unordered_map<std::string, std::string> pending_;
+  size_t pending_bytes_ = 0;
+  bool flush_scheduled_ = false;
+
+  ShapedRunCache(std::shared_ptr<fml::UniqueFD> directory,
+                 size_t max_bytes,
+                 bool read_only,
+                 FlushScheduler flush_scheduler);
+
+  // Maps the file, or returns null if there is none or it is not valid.
+  std::shared_ptr<fml::FileMapping> MapFile() const;
+
+  void SetMappingLocked(std::shared_ptr<fml::FileMapping> mapping);
+
+  // Returns the entry of the file for |key|, or null if it has none.
+  const IndexEntry* FindLocked(std::string_view key) const;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(ShapedRunCache);
+};
+
+}  // namespace txt
+
+#endif  // TXT_SHAPED_RUN_CACHE_H_
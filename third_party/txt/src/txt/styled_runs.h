@@ -17,6 +17,7 @@
 #ifndef LIB_TXT_SRC_STYLED_RUNS_H_
 #define LIB_TXT_SRC_STYLED_RUNS_H_
 
+#include <deque>
 #include <list>
 #include <vector>
 
@@ -93,7 +94,9 @@ class StyledRuns {
         : style_index(style_index), start(start), end(end) {}
   };
 
-  std::vector<TextStyle> styles_;
+  // A deque so that styles added to the runs of a laid out paragraph do not
+  // move the styles referenced by its layout.
+  std::deque<TextStyle> styles_;
   std::vector<IndexedRun> runs_;
 };
 
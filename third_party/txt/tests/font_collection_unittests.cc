@@ -14,14 +14,270 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "flutter/fml/command_line.h"
 #include "flutter/fml/logging.h"
 #include "gtest/gtest.h"
+#include "minikin/Emoji.h"
+#include "minikin/FontCollection.h"
+#include "minikin/FontFamily.h"
 #include "txt/font_collection.h"
 #include "txt_test_utils.h"
+#include "unicode/uchar.h"
+#include "unicode/unorm2.h"
+#include "unicode/utf16.h"
+
+namespace minikin {
+
+// Itemizes text the way FontCollection::itemize did before it kept runs going
+// with the ranked families of each page: every family covering the page of a
+// code point is scored for it.
+class FontCollectionItemizeReference {
+ public:
+  static std::vector<FontCollection::Run> Itemize(
+      const FontCollection& collection,
+      const std::u16string& text,
+      FontStyle style) {
+    const uint16_t* string = reinterpret_cast<const uint16_t*>(text.data());
+    const size_t string_size = text.size();
+    const uint32_t langListId = style.getLanguageListId();
+    const int variant = style.getVariant();
+    std::vector<FontCollection::Run> result;
+    const FontFamily* lastFamily = nullptr;
+    FontCollection::Run* run = nullptr;
+    if (string_size == 0) {
+      return result;
+    }
+
+    const uint32_t kEndOfString = 0xFFFFFFFF;
+    uint32_t nextCh = 0;
+    uint32_t prevCh = 0;
+    size_t nextUtf16Pos = 0;
+    size_t readLength = 0;
+    U16_NEXT(string, readLength, string_size, nextCh);
+    do {
+      const uint32_t ch = nextCh;
+      const size_t utf16Pos = nextUtf16Pos;
+      nextUtf16Pos = readLength;
+      if (readLength < string_size) {
+        U16_NEXT(string, readLength, string_size, nextCh);
+      } else {
+        nextCh = kEndOfString;
+      }
+
+      bool shouldContinueRun = false;
+      if (lastFamily != nullptr) {
+        if (IsStickyWhitelisted(ch)) {
+          shouldContinueRun = lastFamily->getCoverage().get(ch);
+        } else if (ch == 0x00AD || IsVariationSelector(ch)) {
+          shouldContinueRun = true;
+        }
+      }
+
+      if (!shouldContinueRun) {
+        const std::shared_ptr<FontFamily>& family = GetFamilyForChar(
+            collection, ch, IsVariationSelector(nextCh) ? nextCh : 0,
+            langListId, variant);
+        if (utf16Pos == 0 || family.get() != lastFamily) {
+          size_t start = utf16Pos;
+          if (utf16Pos != 0 &&
+              ((U_GET_GC_MASK(ch) & U_GC_M_MASK) != 0 ||
+               (isEmojiModifier(ch) && isEmojiBase(prevCh))) &&
+              family != nullptr && family->getCoverage().get(prevCh)) {
+            const size_t prevChLength = U16_LENGTH(prevCh);
+            run->end -= prevChLength;
+            if (run->start == run->end) {
+              result.pop_back();
+            }
+            start -= prevChLength;
+          }
+          result.push_back(
+              {family->getClosestMatch(style), static_cast<int>(start), 0});
+          run = &result.back();
+          lastFamily = family.get();
+        }
+      }
+      prevCh = ch;
+      run->end = nextUtf16Pos;
+    } while (nextCh != kEndOfString);
+    return result;
+  }
+
+ private:
+  static bool IsStickyWhitelisted(uint32_t c) {
+    static const uint32_t kStickyWhitelist[] = {
+        '!',    ',',    '-',    '.',    ':',    ';',    '?',    0x00A0,
+        0x200C, 0x200D, 0x2010, 0x2011, 0x202F, 0x2640, 0x2642, 0x2695};
+    for (uint32_t sticky : kStickyWhitelist) {
+      if (sticky == c) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static bool IsVariationSelector(uint32_t c) {
+    return (0xFE00 <= c && c <= 0xFE0F) || (0xE0100 <= c && c <= 0xE01EF);
+  }
+
+  static const std::shared_ptr<FontFamily>& GetFamilyForChar(
+      const FontCollection& collection,
+      uint32_t ch,
+      uint32_t vs,
+      uint32_t langListId,
+      int variant) {
+    const uint32_t kUnsupportedFontScore = 0;
+    const uint32_t kFirstFontScore = UINT32_MAX;
+    const auto& families = collection.mFamilies;
+    if (ch >= collection.mMaxChar) {
+      if (collection.mFallbackFontProvider) {
+        const std::shared_ptr<FontFamily>& fallback =
+            collection.findFallbackFont(ch, vs, langListId);
+        if (fallback) {
+          return fallback;
+        }
+      }
+      return families[0];
+    }
+
+    FontCollection::Range range =
+        collection.mRanges[ch >> FontCollection::kLogCharsPerPage];
+    if (vs != 0) {
+      range = {0, static_cast<uint16_t>(families.size())};
+    }
+    int bestFamilyIndex = -1;
+    uint32_t bestScore = kUnsupportedFontScore;
+    for (size_t i = range.start; i < range.end; i++) {
+      const std::shared_ptr<FontFamily>& family =
+          vs == 0 ? families[collection.mFamilyVec[i]] : families[i];
+      const uint32_t score =
+          collection.calcFamilyScore(ch, vs, variant, langListId, family);
+      if (score == kFirstFontScore) {
+        return family;
+      }
+      if (score > bestScore) {
+        bestScore = score;
+        bestFamilyIndex = i;
+      }
+    }
+    if (bestFamilyIndex == -1) {
+      if (collection.mFallbackFontProvider) {
+        const std::shared_ptr<FontFamily>& fallback =
+            collection.findFallbackFont(ch, vs, langListId);
+        if (fallback) {
+          return fallback;
+        }
+      }
+      UErrorCode errorCode = U_ZERO_ERROR;
+      const UNormalizer2* normalizer = unorm2_getNFDInstance(&errorCode);
+      if (U_SUCCESS(errorCode)) {
+        UChar decomposed[4];
+        int len = unorm2_getRawDecomposition(normalizer, ch, decomposed, 4,
+                                             &errorCode);
+        if (U_SUCCESS(errorCode) && len > 0) {
+          int off = 0;
+          U16_NEXT_UNSAFE(decomposed, off, ch);
+          return GetFamilyForChar(collection, ch, vs, langListId, variant);
+        }
+      }
+      return families[0];
+    }
+    return vs == 0 ? families[collection.mFamilyVec[bestFamilyIndex]]
+                   : families[bestFamilyIndex];
+  }
+};
+
+}  // namespace minikin
 
 namespace txt {
 
+namespace {
+
+std::shared_ptr<minikin::FontCollection> GetItemizeFontCollection() {
+  return GetTestFontCollection()->GetMinikinFontCollectionForFamilies(
+      {"Roboto", "Noto Sans CJK JP", "VariationSelector Test",
+       "Noto Color Emoji"},
+      "ja-JP");
+}
+
+// Itemizes |text| and checks that the runs are those of the reference.
+std::vector<minikin::FontCollection::Run> ExpectSameRunsAsReference(
+    const std::u16string& text) {
+  auto collection = GetItemizeFontCollection();
+  minikin::FontStyle style(
+      minikin::FontStyle::registerLanguageList("ja-JP"), 0, 4, false);
+  std::vector<minikin::FontCollection::Run> runs;
+  collection->itemize(reinterpret_cast<const uint16_t*>(text.data()),
+                      text.size(), style, &runs);
+  const auto expected =
+      minikin::FontCollectionItemizeReference::Itemize(*collection, text,
+                                                       style);
+  EXPECT_EQ(runs.size(), expected.size());
+  for (size_t i = 0; i < std::min(runs.size(), expected.size()); i++) {
+    EXPECT_EQ(runs[i].start, expected[i].start) << "run " << i;
+    EXPECT_EQ(runs[i].end, expected[i].end) << "run " << i;
+    EXPECT_EQ(runs[i].fakedFont.font, expected[i].fakedFont.font)
+        << "run " << i;
+  }
+  return runs;
+}
+
+}  // namespace
+
+TEST(FontCollectionItemize, LatinText) {
+  const std::u16string text = u"The quick brown fox jumps over the lazy dog";
+  auto runs = ExpectSameRunsAsReference(text);
+  ASSERT_EQ(runs.size(), 1u);
+  ASSERT_EQ(runs[0].start, 0);
+  ASSERT_EQ(runs[0].end, static_cast<int>(text.size()));
+}
+
+TEST(FontCollectionItemize, CJKText) {
+  // "Nihongo no bunshou desu."
+  const std::u16string text =
+      u"\u65E5\u672C\u8A9E\u306E\u6587\u7AE0\u3067\u3059\u3002";
+  auto runs = ExpectSameRunsAsReference(text);
+  ASSERT_EQ(runs.size(), 1u);
+  ASSERT_EQ(runs[0].end, static_cast<int>(text.size()));
+}
+
+TEST(FontCollectionItemize, MixedText) {
+  auto runs = ExpectSameRunsAsReference(
+      u"Hello \u4E16\u754C, this is \u65E5\u672C\u8A9E text "
+      u"\u00E9t\u00E9 \u00FCber \u3053\u3093\u306B\u3061\u306F!");
+  ASSERT_GT(runs.size(), 1u);
+}
+
+TEST(FontCollectionItemize, StickyPunctuation) {
+  ExpectSameRunsAsReference(u"\u65E5\u672C!?.,:;- next");
+  ExpectSameRunsAsReference(u"word \u65E5\u00A0\u2010\u2011\u202F word");
+  ExpectSameRunsAsReference(u"\u2640\u2642\u2695 a\u2640 \u65E5\u2642");
+}
+
+TEST(FontCollectionItemize, SoftHyphen) {
+  ExpectSameRunsAsReference(u"hy\u00ADphen\u00AD\u65E5\u00AD\u672C\u00AD");
+  ExpectSameRunsAsReference(u"\u00AD\u00ADleading");
+}
+
+TEST(FontCollectionItemize, VariationSelectors) {
+  // Sequences the VariationSelector Test font has, some only through its
+  // default glyph, and emoji and text presentation selectors.
+  ExpectSameRunsAsReference(
+      u"a\u82A6\uFE00\u82A6\u845B\uFE01 \u845B\U000E0101 text");
+  ExpectSameRunsAsReference(u"\u717D\uFE02\u717D\U000E0102abc\uFE0E");
+  ExpectSameRunsAsReference(u"\u2614\uFE0F\u2614\uFE0E \u263A\uFE0F!");
+}
+
+TEST(FontCollectionItemize, CombiningMarks) {
+  ExpectSameRunsAsReference(u"e\u0301a\u0308 o\u0323\u0302 text");
+  ExpectSameRunsAsReference(u"\u65E5\u0301\u672C\u3099 \u304B\u3099");
+  ExpectSameRunsAsReference(
+      u"1\u20E3 #\uFE0F\u20E3 \U0001F44D\U0001F3FD ok");
+}
+
 #if 0
 
 TEST(FontCollection, HasDefaultRegistrations) {
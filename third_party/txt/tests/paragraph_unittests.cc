@@ -5846,4 +5846,151 @@ TEST_F(ParagraphTest, KhmerLineBreaker) {
   ASSERT_TRUE(Snapshot());
 }
 
+TEST_F(ParagraphTest, RelayoutWithNewWidthKeepsMeasurements) {
+  const char* text =
+      "Sentence to layout at diff widths to get diff line counts.\n"
+      "short words short words short words short words short words\n"
+      "short words short words short words short words short words end";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  paragraph_style.break_strategy = minikin::kBreakStrategy_HighQuality;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.font_size = 31;
+  text_style.color = SK_ColorBLACK;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(300);
+  ASSERT_EQ(paragraph->measured_block_count_, 3ull);
+  std::vector<float> char_widths = paragraph->blocks_[1].char_widths;
+
+  paragraph->Layout(600);
+  ASSERT_EQ(paragraph->measured_block_count_, 3ull);
+  EXPECT_EQ(paragraph->blocks_[1].char_widths, char_widths);
+  EXPECT_EQ(paragraph->blocks_[1].break_width, 600);
+
+  txt::ParagraphBuilderTxt expected_builder(paragraph_style,
+                                            GetTestFontCollection());
+  expected_builder.PushStyle(text_style);
+  expected_builder.AddText(u16_text);
+  expected_builder.Pop();
+  auto expected = BuildParagraph(expected_builder);
+  expected->Layout(600);
+
+  ASSERT_EQ(paragraph->GetLineCount(), expected->GetLineCount());
+  for (size_t i = 0; i < expected->GetLineCount(); ++i) {
+    EXPECT_EQ(paragraph->line_metrics_[i].start_index,
+              expected->line_metrics_[i].start_index);
+    EXPECT_EQ(paragraph->line_metrics_[i].end_index,
+              expected->line_metrics_[i].end_index);
+    EXPECT_DOUBLE_EQ(paragraph->line_widths_[i], expected->line_widths_[i]);
+  }
+  EXPECT_DOUBLE_EQ(paragraph->GetHeight(), expected->GetHeight());
+  EXPECT_DOUBLE_EQ(paragraph->GetMaxIntrinsicWidth(),
+                   expected->GetMaxIntrinsicWidth());
+  EXPECT_DOUBLE_EQ(paragraph->GetMinIntrinsicWidth(),
+                   expected->GetMinIntrinsicWidth());
+}
+
+TEST_F(ParagraphTest, AppendTextRelayoutMatchesFullLayout) {
+  const char* text =
+      "This is a very long sentence to test if the text will properly wrap "
+      "around and go to the next line.\nSometimes, short sentence.\n";
+  const char* appended_text =
+      "Longer sentences are okay too because they are necessary. Very short.";
+  auto icu_text = icu::UnicodeString::fromUTF8(text);
+  std::u16string u16_text(icu_text.getBuffer(),
+                          icu_text.getBuffer() + icu_text.length());
+  auto icu_appended_text = icu::UnicodeString::fromUTF8(appended_text);
+  std::u16string u16_appended_text(
+      icu_appended_text.getBuffer(),
+      icu_appended_text.getBuffer() + icu_appended_text.length());
+
+  txt::ParagraphStyle paragraph_style;
+  paragraph_style.text_align = TextAlign::center;
+
+  txt::TextStyle text_style;
+  text_style.font_families = std::vector<std::string>(1, "Roboto");
+  text_style.font_size = 26;
+  text_style.color = SK_ColorBLACK;
+  txt::TextStyle appended_style = text_style;
+  appended_style.color = SK_ColorRED;
+
+  txt::ParagraphBuilderTxt builder(paragraph_style, GetTestFontCollection());
+  builder.PushStyle(text_style);
+  builder.AddText(u16_text);
+  builder.Pop();
+  auto paragraph = BuildParagraph(builder);
+  paragraph->Layout(300);
+  size_t line_count = paragraph->GetLineCount();
+  std::vector<float> char_widths = paragraph->blocks_[0].char_widths;
+
+  paragraph->AppendText(u16_appended_text, appended_style);
+  // Only the empty block at the end needs to be measured again.
+  EXPECT_EQ(paragraph->measured_block_count_, 2ull);
+  paragraph->Layout(300);
+  paragraph->Paint(GetCanvas(), 0, 0);
+  EXPECT_GT(paragraph->GetLineCount(), line_count);
+  EXPECT_EQ(paragraph->blocks_[0].char_widths, char_widths);
+
+  txt::ParagraphBuilderTxt expected_builder(paragraph_style,
+                                            GetTestFontCollection());
+  expected_builder.PushStyle(text_style);
+  expected_builder.AddText(u16_text);
+  expected_builder.Pop();
+  expected_builder.PushStyle(appended_style);
+  expected_builder.AddText(u16_appended_text);
+  expected_builder.Pop();
+  auto expected = BuildParagraph(expected_builder);
+  expected->Layout(300);
+
+  ASSERT_EQ(paragraph->text_, expected->text_);
+  ASSERT_EQ(paragraph->GetLineCount(), expected->GetLineCount());
+  for (size_t i = 0; i < expected->GetLineCount(); ++i) {
+    const LineMetrics& line = paragraph->GetLineMetrics()[i];
+    const LineMetrics& expected_line = expected->GetLineMetrics()[i];
+    EXPECT_EQ(line.start_index, expected_line.start_index);
+    EXPECT_EQ(line.end_index, expected_line.end_index);
+    EXPECT_EQ(line.end_including_newline, expected_line.end_including_newline);
+    EXPECT_DOUBLE_EQ(line.height, expected_line.height);
+    EXPECT_DOUBLE_EQ(line.baseline, expected_line.baseline);
+    EXPECT_DOUBLE_EQ(line.left, expected_line.left);
+    EXPECT_DOUBLE_EQ(line.width, expected_line.width);
+    EXPECT_EQ(line.run_metrics.size(), expected_line.run_metrics.size());
+  }
+  ASSERT_EQ(paragraph->records_.size(), expected->records_.size());
+  for (size_t i = 0; i < expected->records_.size(); ++i) {
+    EXPECT_EQ(paragraph->records_[i].line(), expected->records_[i].line());
+    EXPECT_EQ(paragraph->records_[i].offset(), expected->records_[i].offset());
+    EXPECT_EQ(paragraph->records_[i].style().color,
+              expected->records_[i].style().color);
+  }
+  EXPECT_DOUBLE_EQ(paragraph->GetHeight(), expected->GetHeight());
+  EXPECT_DOUBLE_EQ(paragraph->GetLongestLine(), expected->GetLongestLine());
+  EXPECT_DOUBLE_EQ(paragraph->GetMaxIntrinsicWidth(),
+                   expected->GetMaxIntrinsicWidth());
+  EXPECT_DOUBLE_EQ(paragraph->GetMinIntrinsicWidth(),
+                   expected->GetMinIntrinsicWidth());
+
+  std::vector<txt::Paragraph::TextBox> boxes = paragraph->GetRectsForRange(
+      0, paragraph->text_.size(), Paragraph::RectHeightStyle::kMax,
+      Paragraph::RectWidthStyle::kTight);
+  std::vector<txt::Paragraph::TextBox> expected_boxes =
+      expected->GetRectsForRange(0, expected->text_.size(),
+                                 Paragraph::RectHeightStyle::kMax,
+                                 Paragraph::RectWidthStyle::kTight);
+  ASSERT_EQ(boxes.size(), expected_boxes.size());
+  for (size_t i = 0; i < expected_boxes.size(); ++i) {
+    EXPECT_EQ(boxes[i].rect, expected_boxes[i].rect);
+  }
+}
+
 }  // namespace txt
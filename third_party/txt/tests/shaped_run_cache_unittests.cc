@@ -0,0 +1,265 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "txt/shaped_run_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flutter/fml/file.h"
+#include "gtest/gtest.h"
+#include "minikin/Layout.h"
+#include "txt/font_collection.h"
+#include "txt_test_utils.h"
+
+namespace txt {
+namespace testing {
+
+static std::shared_ptr<fml::UniqueFD> OpenDirectory(
+    const fml::ScopedTemporaryDirectory& temp_dir) {
+  return std::make_shared<fml::UniqueFD>(fml::OpenDirectory(
+      temp_dir.path().c_str(), false, fml::FilePermission::kReadWrite));
+}
+
+// Returns the record stored for |key|, or "<none>".
+static std::string Load(minikin::LayoutStore& store, const std::string& key) {
+  std::string result = "<none>";
+  store.load(key, [&result](const uint8_t* data, size_t size) {
+    result.assign(reinterpret_cast<const char*>(data), size);
+  });
+  return result;
+}
+
+TEST(ShapedRunCacheTest, StoresWordsAcrossProcesses) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  int scheduled_flushes = 0;
+  auto cache = ShapedRunCache::Open(OpenDirectory(temp_dir), 1024, false,
+                                    [&scheduled_flushes]() {
+                                      scheduled_flushes++;
+                                      return true;
+                                    });
+  ASSERT_NE(cache, nullptr);
+  ASSERT_EQ(Load(*cache, "hello"), "<none>");
+
+  cache->store("hello", "world");
+  cache->store("foo", "bar");
+  ASSERT_EQ(scheduled_flushes, 1);
+  ASSERT_TRUE(cache->HasPendingWrites());
+  ASSERT_EQ(Load(*cache, "hello"), "world");
+
+  ASSERT_TRUE(cache->Flush());
+  ASSERT_FALSE(cache->HasPendingWrites());
+  ASSERT_EQ(cache->GetEntryCount(), 2u);
+  ASSERT_EQ(Load(*cache, "hello"), "world");
+
+  cache->store("empty", "");
+  ASSERT_EQ(scheduled_flushes, 2);
+  ASSERT_TRUE(cache->Flush());
+
+  auto reopened = ShapedRunCache::Open(OpenDirectory(temp_dir), 1024, true);
+  ASSERT_NE(reopened, nullptr);
+  ASSERT_EQ(reopened->GetEntryCount(), 3u);
+  ASSERT_EQ(Load(*reopened, "hello"), "world");
+  ASSERT_EQ(Load(*reopened, "foo"), "bar");
+  ASSERT_EQ(Load(*reopened, "empty"), "");
+  ASSERT_EQ(Load(*reopened, "fo"), "<none>");
+
+  // Read-only caches ignore the words they are offered.
+  reopened->store("new", "word");
+  ASSERT_FALSE(reopened->HasPendingWrites());
+  ASSERT_EQ(Load(*reopened, "new"), "<none>");
+}
+
+TEST(ShapedRunCacheTest, KeepsUsedWordsWithinBudget) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  const std::string record(100, 'r');
+  auto cache = ShapedRunCache::Open(OpenDirectory(temp_dir), 1024, false);
+  for (int i = 0; i < 20; i++) {
+    cache->store("word" + std::to_string(i), record);
+  }
+  // Words past the budget are not even kept in memory.
+  ASSERT_LT(cache->GetEntryCount(), 20u);
+  ASSERT_TRUE(cache->Flush());
+  const size_t file_entries = cache->GetEntryCount();
+  ASSERT_GT(file_entries, 0u);
+
+  // The next process uses the first word and shapes a new one, which pushes
+  // out a word it did not use.
+  cache = ShapedRunCache::Open(OpenDirectory(temp_dir), 1024, false);
+  ASSERT_EQ(cache->GetEntryCount(), file_entries);
+  ASSERT_EQ(Load(*cache, "word0"), record);
+  cache->store("new", record);
+  ASSERT_TRUE(cache->Flush());
+  ASSERT_EQ(cache->GetEntryCount(), file_entries);
+  ASSERT_EQ(Load(*cache, "word0"), record);
+  ASSERT_EQ(Load(*cache, "new"), record);
+
+  auto file = fml::OpenFile(temp_dir.fd(), ShapedRunCache::kFileName, false,
+                            fml::FilePermission::kRead);
+  ASSERT_LE(fml::FileMapping(file).GetSize(), 1024u);
+}
+
+TEST(ShapedRunCacheTest, IgnoresInvalidFiles) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  auto cache = ShapedRunCache::Open(OpenDirectory(temp_dir), 1024, false);
+  cache->store("hello", "world");
+  ASSERT_TRUE(cache->Flush());
+
+  auto file = fml::OpenFile(temp_dir.fd(), ShapedRunCache::kFileName, false,
+                            fml::FilePermission::kRead);
+  fml::FileMapping mapping(file);
+  std::vector<uint8_t> contents(mapping.GetMapping(),
+                                mapping.GetMapping() + mapping.GetSize());
+
+  // A truncated file.
+  std::vector<uint8_t> truncated(contents.begin(), contents.end() - 1);
+  ASSERT_TRUE(fml::WriteAtomically(temp_dir.fd(), ShapedRunCache::kFileName,
+                                   fml::DataMapping(truncated)));
+  cache = ShapedRunCache::Open(OpenDirectory(temp_dir), 1024, true);
+  ASSERT_NE(cache, nullptr);
+  ASSERT_EQ(cache->GetEntryCount(), 0u);
+  ASSERT_EQ(Load(*cache, "hello"), "<none>");
+
+  // A file of another format.
+  std::vector<uint8_t> other_format = contents;
+  other_format[0] ^= 0xff;
+  ASSERT_TRUE(fml::WriteAtomically(temp_dir.fd(), ShapedRunCache::kFileName,
+                                   fml::DataMapping(other_format)));
+  cache = ShapedRunCache::Open(OpenDirectory(temp_dir), 1024, true);
+  ASSERT_EQ(cache->GetEntryCount(), 0u);
+}
+
+TEST(ShapedRunCacheTest, DoesNotStoreWordsOfTheFileAgain) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  auto cache = ShapedRunCache::Open(OpenDirectory(temp_dir), 1024, false);
+  cache->store("hello", "world");
+  ASSERT_TRUE(cache->Flush());
+
+  // A word of the file that the layout could not read is shaped and offered
+  // again on every launch.
+  cache = ShapedRunCache::Open(OpenDirectory(temp_dir), 1024, false);
+  cache->store("hello", "again");
+  ASSERT_FALSE(cache->HasPendingWrites());
+  cache->store("foo", "bar");
+  ASSERT_TRUE(cache->Flush());
+  ASSERT_EQ(cache->GetEntryCount(), 2u);
+  ASSERT_EQ(Load(*cache, "hello"), "world");
+}
+
+TEST(ShapedRunCacheTest, ReadersMayUseTheCache) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  auto cache = ShapedRunCache::Open(OpenDirectory(temp_dir), 1024, false);
+  cache->store("hello", "world");
+  ASSERT_TRUE(cache->Flush());
+  cache->store("foo", "bar");
+
+  // Records are read without holding the lock of the cache.
+  for (const char* key : {"hello", "foo"}) {
+    std::string nested;
+    ASSERT_TRUE(cache->load(key, [&](const uint8_t*, size_t) {
+      nested = Load(*cache, key);
+      cache->store("nested", "word");
+    }));
+    ASSERT_EQ(nested, Load(*cache, key));
+  }
+  ASSERT_EQ(Load(*cache, "nested"), "word");
+}
+
+namespace {
+
+// Counts the words the layout cache looks up and offers.
+class CountingStore : public minikin::LayoutStore {
+ public:
+  explicit CountingStore(std::shared_ptr<ShapedRunCache> cache)
+      : cache_(std::move(cache)) {}
+
+  bool load(std::string_view key, const RecordReader& reader) override {
+    bool found = cache_->load(key, reader);
+    (found ? hits : misses)++;
+    return found;
+  }
+
+  void store(std::string key, std::string record) override {
+    stores++;
+    cache_->store(std::move(key), std::move(record));
+  }
+
+  int hits = 0;
+  int misses = 0;
+  int stores = 0;
+
+ private:
+  std::shared_ptr<ShapedRunCache> cache_;
+};
+
+struct LayoutResult {
+  std::vector<unsigned int> glyphs;
+  std::vector<float> positions;
+  std::vector<uint32_t> clusters;
+  std::vector<float> advances;
+  float advance;
+};
+
+LayoutResult DoLayout(const std::u16string& text) {
+  auto collection =
+      GetTestFontCollection()->GetMinikinFontCollectionForFamilies({"Roboto"},
+                                                                   "en-US");
+  minikin::FontStyle style;
+  minikin::MinikinPaint paint;
+  paint.size = 14;
+  paint.scaleX = 1;
+  minikin::Layout layout;
+  layout.doLayout(reinterpret_cast<const uint16_t*>(text.data()), 0,
+                  text.size(), text.size(), false, style, paint, collection);
+  LayoutResult result;
+  for (size_t i = 0; i < layout.nGlyphs(); i++) {
+    result.glyphs.push_back(layout.getGlyphId(i));
+    result.positions.push_back(layout.getX(i));
+    result.positions.push_back(layout.getY(i));
+    result.clusters.push_back(layout.getGlyphCluster(i));
+  }
+  result.advances.resize(text.size());
+  layout.getAdvances(result.advances.data());
+  result.advance = layout.getAdvance();
+  return result;
+}
+
+}  // namespace
+
+TEST(ShapedRunCacheTest, LaysOutStoredWords) {
+  fml::ScopedTemporaryDirectory temp_dir;
+  const std::u16string text = u"Hello world, lay out these words";
+
+  minikin::Layout::purgeCaches();
+  auto store = std::make_shared<CountingStore>(
+      ShapedRunCache::Open(OpenDirectory(temp_dir), 1024 * 1024, false));
+  minikin::Layout::setLayoutStore(store);
+  const LayoutResult shaped = DoLayout(text);
+  ASSERT_GT(store->misses, 0);
+  ASSERT_EQ(store->hits, 0);
+  ASSERT_EQ(store->stores, store->misses);
+
+  // The words are now in the layout cache.
+  const int misses = store->misses;
+  DoLayout(text);
+  ASSERT_EQ(store->misses, misses);
+  ASSERT_EQ(store->hits, 0);
+
+  // They are read back from the store once the layout cache is purged.
+  minikin::Layout::purgeCaches();
+  const LayoutResult loaded = DoLayout(text);
+  ASSERT_EQ(store->hits, misses);
+  ASSERT_EQ(loaded.glyphs, shaped.glyphs);
+  ASSERT_EQ(loaded.positions, shaped.positions);
+  ASSERT_EQ(loaded.clusters, shaped.clusters);
+  ASSERT_EQ(loaded.advances, shaped.advances);
+  ASSERT_EQ(loaded.advance, shaped.advance);
+
+  minikin::Layout::setLayoutStore(nullptr);
+  minikin::Layout::purgeCaches();
+}
+
+}  // namespace testing
+}  // namespace txt
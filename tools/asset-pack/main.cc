@@ -0,0 +1,154 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "flutter/assets/asset_pack.h"
+#include "flutter/assets/asset_pack_writer.h"
+#include "flutter/fml/command_line.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/mapping.h"
+
+void Usage() {
+  std::cout << "Usage:" << std::endl;
+  std::cout << "asset-pack [--compress=<ext>,...] [--prefetch=<list.txt>] "
+               "<output.pack> <assets directory>"
+            << std::endl;
+  std::cout << std::endl;
+  std::cout << "Packs every file in the assets directory into a single file "
+               "that the engine maps once, instead of opening every asset on "
+               "its own. Name the pack '"
+            << flutter::asset_pack::kFileName
+            << "' and place it in the assets directory for the engine to find "
+               "it."
+            << std::endl;
+  std::cout << "--compress lists the extensions of the assets to compress, "
+               "for example 'json,txt,ttf'. Formats that are already "
+               "compressed, like PNG, gain nothing from it."
+            << std::endl;
+  std::cout << "--prefetch names a file that lists the assets needed at "
+               "startup, one per line. They are read ahead as soon as the "
+               "pack is opened."
+            << std::endl;
+}
+
+std::set<std::string> Split(const std::string& list, char separator) {
+  std::set<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, separator)) {
+    if (!item.empty()) {
+      items.insert(item);
+    }
+  }
+  return items;
+}
+
+std::string GetExtension(const std::string& name) {
+  const size_t dot = name.find_last_of('.');
+  const size_t slash = name.find_last_of('/');
+  if (dot == std::string::npos ||
+      (slash != std::string::npos && dot < slash)) {
+    return "";
+  }
+  return name.substr(dot + 1);
+}
+
+// Adds every file in |directory| to |writer|, named by its path from the
+// assets directory.
+bool AddDirectory(const fml::UniqueFD& directory,
+                  const std::string& prefix,
+                  const std::set<std::string>& compressed_extensions,
+                  const std::set<std::string>& prefetched_assets,
+                  flutter::AssetPackWriter& writer) {
+  return fml::VisitFiles(directory, [&](const fml::UniqueFD& directory,
+                                        const std::string& filename) {
+    const std::string name = prefix + filename;
+    if (fml::IsDirectory(directory, filename.c_str())) {
+      return AddDirectory(fml::OpenDirectoryReadOnly(directory,
+                                                     filename.c_str()),
+                          name + "/", compressed_extensions,
+                          prefetched_assets, writer);
+    }
+    if (name == flutter::asset_pack::kFileName) {
+      // An earlier pack.
+      return true;
+    }
+    auto mapping = fml::FileMapping::CreateReadOnly(directory, filename);
+    if (!mapping) {
+      std::cerr << "Failed to read asset " << name << "; aborting."
+                << std::endl;
+      return false;
+    }
+    std::vector<uint8_t> contents(mapping->GetMapping(),
+                                  mapping->GetMapping() + mapping->GetSize());
+    writer.AddAsset(name, std::move(contents),
+                    compressed_extensions.count(GetExtension(name)) > 0,
+                    prefetched_assets.count(name) > 0);
+    return true;
+  });
+}
+
+int main(int argc, char** argv) {
+  const auto command_line = fml::CommandLineFromArgcArgv(argc, argv);
+  if (command_line.positional_args().size() != 2) {
+    Usage();
+    return -1;
+  }
+  const std::string& output_file_path = command_line.positional_args()[0];
+  const std::string& assets_directory_path = command_line.positional_args()[1];
+
+  std::string compress;
+  command_line.GetOptionValue("compress", &compress);
+  const std::set<std::string> compressed_extensions = Split(compress, ',');
+
+  std::set<std::string> prefetched_assets;
+  std::string prefetch_list_path;
+  if (command_line.GetOptionValue("prefetch", &prefetch_list_path)) {
+    std::ifstream prefetch_list(prefetch_list_path);
+    if (!prefetch_list) {
+      std::cerr << "Failed to read the prefetch list " << prefetch_list_path
+                << "; aborting." << std::endl;
+      return -1;
+    }
+    std::stringstream contents;
+    contents << prefetch_list.rdbuf();
+    prefetched_assets = Split(contents.str(), '\n');
+  }
+
+  const auto assets_directory =
+      fml::OpenDirectory(assets_directory_path.c_str(), false,
+                         fml::FilePermission::kRead);
+  if (!assets_directory.is_valid()) {
+    std::cerr << "Failed to open the assets directory "
+              << assets_directory_path << "; aborting." << std::endl;
+    return -1;
+  }
+
+  flutter::AssetPackWriter writer;
+  if (!AddDirectory(assets_directory, "", compressed_extensions,
+                    prefetched_assets, writer)) {
+    return -1;
+  }
+
+  const std::vector<uint8_t> pack = writer.Build();
+  std::ofstream output(output_file_path, std::ios::binary | std::ios::trunc);
+  output.write(reinterpret_cast<const char*>(pack.data()), pack.size());
+  output.close();
+  if (!output) {
+    std::cerr << "Failed to write " << output_file_path << "; aborting."
+              << std::endl;
+    return -1;
+  }
+
+  std::cout << "Packed " << writer.GetAssetCount() << " assets into "
+            << output_file_path << " (" << pack.size() << " bytes)."
+            << std::endl;
+  return 0;
+}